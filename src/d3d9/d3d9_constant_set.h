@@ -1,6 +1,9 @@
 #pragma once
 
 #include "d3d9_caps.h"
+// NV-DXVK start: constant upload deduplication
+#include "d3d9_constant_upload_cache.h"
+// NV-DXVK end
 
 #include "../dxvk/dxvk_buffer.h"
 
@@ -47,6 +50,11 @@ namespace dxvk {
   struct D3D9ConstantSets {
     D3D9SwvpConstantBuffers   swvpBuffers;
     Rc<DxvkBuffer>            buffer;
+    // NV-DXVK start: constant upload deduplication
+    // Buffers of the upload cache entries, created on first use. One of them is always the bound buffer.
+    std::array<Rc<DxvkBuffer>, D3D9ConstantUploadCache::NumEntries> uploadBuffers;
+    D3D9ConstantUploadCache   uploadCache;
+    // NV-DXVK end
     DxsoShaderMetaInfo        meta  = {};
     bool                      dirty = true;
   };
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "../util/xxHash/xxhash.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Constant upload cache
+   *
+   * Remembers the content hashes of the last few constant uploads of one shader stage, so that
+   * an upload matching one of them can rebind the buffer that already holds its data rather than
+   * allocating, filling and invalidating a new slice. Games tend to cycle through a handful of
+   * constant sets (per-material parameters, shadow and main passes), which a check against only
+   * the previous upload would miss.
+   *
+   * Each entry stands for one buffer owned by the caller, which always holds the data of the hash
+   * stored in that entry. Only the replacement policy lives here; the device owns the buffers.
+   */
+  class D3D9ConstantUploadCache {
+
+  public:
+
+    constexpr static uint32_t NumEntries = 4;
+
+    struct Lookup {
+      uint32_t entry;
+      bool     hit;
+    };
+
+    /**
+     * \brief Hashes the constant data of an upload
+     *
+     * The sizes are part of the hash, so uploads of the same
+     * data with a different layout never match each other.
+     * \param [in] intData Integer constants
+     * \param [in] intSize Size of the integer constants, in bytes
+     * \param [in] floatData Float constants
+     * \param [in] floatSize Size of the float constants, in bytes
+     * \returns Content hash
+     */
+    static XXH64_hash_t hashData(
+      const void*     intData,
+            uint32_t  intSize,
+      const void*     floatData,
+            uint32_t  floatSize) {
+      XXH64_hash_t hash = XXH3_64bits_withSeed(intData, intSize, (uint64_t(intSize) << 32) | floatSize);
+      return XXH3_64bits_withSeed(floatData, floatSize, hash);
+    }
+
+    /**
+     * \brief Adds a shader-defined constant to a content hash
+     *
+     * \param [in] hash Hash of the data the constant is written over
+     * \param [in] index Float constant index the value is written to
+     * \param [in] value Constant value
+     * \returns Updated hash
+     */
+    static XXH64_hash_t hashConstantCopy(
+            XXH64_hash_t  hash,
+            uint32_t      index,
+      const float         (&value)[4]) {
+      return XXH3_64bits_withSeed(value, sizeof(value), hash ^ index);
+    }
+
+    /**
+     * \brief Looks up the entry holding data with the given hash
+     *
+     * On a miss, the least recently used entry is assigned the hash
+     * and the caller must write the data to that entry's buffer.
+     * \param [in] hash Content hash
+     * \returns Entry index, and whether it already holds the data
+     */
+    Lookup lookup(XXH64_hash_t hash) {
+      uint32_t victim = 0;
+
+      for (uint32_t i = 0; i < NumEntries; i++) {
+        if (m_lastUse[i] != 0 && m_hashes[i] == hash) {
+          m_lastUse[i] = ++m_useCounter;
+          m_hitCount += 1;
+          return { i, true };
+        }
+
+        if (m_lastUse[i] < m_lastUse[victim])
+          victim = i;
+      }
+
+      m_hashes[victim] = hash;
+      m_lastUse[victim] = ++m_useCounter;
+      m_missCount += 1;
+      return { victim, false };
+    }
+
+    /**
+     * \brief Forgets all entries
+     *
+     * Must be called whenever the content of
+     * the entries' buffers can no longer be trusted.
+     */
+    void reset() {
+      m_lastUse = { };
+    }
+
+    uint64_t hitCount() const {
+      return m_hitCount;
+    }
+
+    uint64_t missCount() const {
+      return m_missCount;
+    }
+
+  private:
+
+    std::array<XXH64_hash_t, NumEntries> m_hashes  = { };
+    std::array<uint64_t, NumEntries>     m_lastUse = { };
+
+    uint64_t m_useCounter = 0;
+    uint64_t m_hitCount   = 0;
+    uint64_t m_missCount  = 0;
+
+  };
+
+}
@@ -160,6 +160,10 @@ namespace dxvk {
 
 
   D3D9DeviceEx::~D3D9DeviceEx() {
+    // NV-DXVK start: async shader compilation
+    m_shaderModules->FinishCompileJobs();
+    // NV-DXVK end
+
     Flush();
     SynchronizeCsThread();
 
@@ -3102,6 +3106,12 @@ namespace dxvk {
     if (shader == m_state.vertexShader.ptr())
       return D3D_OK;
 
+    // NV-DXVK start: async shader compilation
+    // Creation succeeded before compiling finished, so a failed compile is reported here
+    if (unlikely(shader != nullptr && !shader->GetCommonShader()->WaitForCompile()))
+      return D3DERR_INVALIDCALL;
+    // NV-DXVK end
+
     auto* oldShader = GetCommonShader(m_state.vertexShader);
     auto* newShader = GetCommonShader(shader);
 
@@ -3446,6 +3456,12 @@ namespace dxvk {
     if (shader == m_state.pixelShader.ptr())
       return D3D_OK;
 
+    // NV-DXVK start: async shader compilation
+    // Creation succeeded before compiling finished, so a failed compile is reported here
+    if (unlikely(shader != nullptr && !shader->GetCommonShader()->WaitForCompile()))
+      return D3DERR_INVALIDCALL;
+    // NV-DXVK end
+
     auto* oldShader = GetCommonShader(m_state.pixelShader);
     auto* newShader = GetCommonShader(shader);
 
@@ -5303,21 +5319,9 @@ namespace dxvk {
           DxsoProgramType     ShaderStage,
           DxsoConstantBuffers BufferType) {
     ScopedCpuProfileZone();
-    DxvkBufferCreateInfo info = { };
-    info.usage  = SSBO ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    info.access = SSBO ? VK_ACCESS_SHADER_READ_BIT          : VK_ACCESS_UNIFORM_READ_BIT;
-    info.size   = Size;
-    info.stages = ShaderStage == DxsoProgramType::VertexShader
-      ? VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
-      : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-
-    VkMemoryPropertyFlags memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                                      | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
-
-    if (m_d3d9Options.deviceLocalConstantBuffers)
-      memoryFlags |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-
-    Rc<DxvkBuffer> buffer = m_dxvkDevice->createBuffer(info, memoryFlags, DxvkMemoryStats::Category::AppBuffer, "D3D9 Constant Buffer");
+    // NV-DXVK start: constant upload deduplication
+    Rc<DxvkBuffer> buffer = AllocConstantBuffer(SSBO, Size, ShaderStage);
+    // NV-DXVK end
 
     const uint32_t slotId = computeResourceSlotId(
       ShaderStage, DxsoBindingType::ConstantBuffer,
@@ -5340,6 +5344,30 @@ namespace dxvk {
   }
 
 
+  // NV-DXVK start: constant upload deduplication
+  Rc<DxvkBuffer> D3D9DeviceEx::AllocConstantBuffer(
+          bool                SSBO,
+          VkDeviceSize        Size,
+          DxsoProgramType     ShaderStage) {
+    DxvkBufferCreateInfo info = { };
+    info.usage  = SSBO ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    info.access = SSBO ? VK_ACCESS_SHADER_READ_BIT          : VK_ACCESS_UNIFORM_READ_BIT;
+    info.size   = Size;
+    info.stages = ShaderStage == DxsoProgramType::VertexShader
+      ? VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+      : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+    VkMemoryPropertyFlags memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                      | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+    if (m_d3d9Options.deviceLocalConstantBuffers)
+      memoryFlags |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    return m_dxvkDevice->createBuffer(info, memoryFlags, DxvkMemoryStats::Category::AppBuffer, "D3D9 Constant Buffer");
+  }
+  // NV-DXVK end
+
+
   void D3D9DeviceEx::CreateConstantBuffers() {
     ScopedCpuProfileZone();
     if (!m_isSWVP) {
@@ -5356,6 +5384,14 @@ namespace dxvk {
                           DxsoProgramType::PixelShader,
                           DxsoConstantBuffers::PSConstantBuffer);
 
+    // NV-DXVK start: constant upload deduplication
+    for (auto& constSet : m_consts) {
+      constSet.uploadBuffers = { };
+      constSet.uploadBuffers[0] = constSet.buffer;
+      constSet.uploadCache.reset();
+    }
+    // NV-DXVK end
+
     m_vsClipPlanes =
       CreateConstantBuffer(false,
                            caps::MaxClipPlanes * sizeof(D3D9ClipPlane),
@@ -5503,20 +5539,52 @@ namespace dxvk {
     const uint32_t bufferSize = align(std::max(floatDataSize + intRange, alignment), alignment);
     floatDataSize = bufferSize - intRange; // Read additional floats for padding so we don't end up with garbage data
 
+    // NV-DXVK start: constant upload deduplication
+    // Hash exactly what gets written below. The buffer of each upload cache entry keeps the data it was last
+    // filled with, so a hit only needs that buffer bound. Older slices of a single buffer can't be rebound
+    // instead, since invalidateBuffer hands them back to the buffer's free list once the GPU is done with them.
+    D3D9ConstantUploadCache::Lookup upload = { 0, false };
+
+    if (m_d3d9Options.deduplicateConstantUploads) {
+      XXH64_hash_t hash = D3D9ConstantUploadCache::hashData(
+        Src.iConsts, intDataSize,
+        Src.fConsts, constSet.meta.maxConstIndexF != 0 ? floatDataSize : 0);
+
+      if (constSet.meta.needsConstantCopies) {
+        for (const auto& constant : GetCommonShader(Shader)->GetConstants()) {
+          if (constant.uboIdx < constSet.meta.maxConstIndexF)
+            hash = D3D9ConstantUploadCache::hashConstantCopy(hash, constant.uboIdx, constant.float32);
+        }
+      }
+
+      upload = constSet.uploadCache.lookup(hash);
+    }
+
+    Rc<DxvkBuffer>& uploadBuffer = constSet.uploadBuffers[upload.entry];
+
+    if (uploadBuffer == nullptr)
+      uploadBuffer = AllocConstantBuffer(false, constSet.buffer->info().size, ShaderStage);
+
     VkDeviceSize& boundConstantBufferSize = ShaderStage == DxsoProgramType::VertexShader ? m_boundVSConstantsBufferSize : m_boundPSConstantsBufferSize;
-    if (boundConstantBufferSize < bufferSize) {
+    if (boundConstantBufferSize < bufferSize || uploadBuffer != constSet.buffer) {
+      boundConstantBufferSize = std::max<VkDeviceSize>(boundConstantBufferSize, bufferSize);
+      constSet.buffer = uploadBuffer;
+
       constexpr uint32_t slotId = computeResourceSlotId(ShaderStage, DxsoBindingType::ConstantBuffer, 0);
       EmitCs([
         cBuffer = constSet.buffer,
         cSlotId = slotId,
-        cSize   = bufferSize
+        cSize   = boundConstantBufferSize
       ] (DxvkContext* ctx) {
         ctx->bindResourceBuffer(cSlotId,
           DxvkBufferSlice(cBuffer, 0, cSize));
       });
-      boundConstantBufferSize = bufferSize;
     }
 
+    if (upload.hit)
+      return;
+    // NV-DXVK end
+
     DxvkBufferSliceHandle slice = constSet.buffer->allocSlice();
 
     EmitCs([
@@ -746,6 +746,13 @@ namespace dxvk {
             DxsoProgramType     ShaderStage,
             DxsoConstantBuffers BufferType);
 
+    // NV-DXVK start: constant upload deduplication
+    Rc<DxvkBuffer> AllocConstantBuffer(
+            bool                SSBO,
+            VkDeviceSize        Size,
+            DxsoProgramType     ShaderStage);
+    // NV-DXVK end
+
     void CreateConstantBuffers();
 
     void SynchronizeCsThread();
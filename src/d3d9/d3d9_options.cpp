@@ -106,6 +106,16 @@ namespace dxvk {
     // NV-DXVK start: adapter override conf
     this->adapterOverride = config.getOption<int32_t>("d3d9.adapterOverride", -1);
     // NV-DXVK end
+    // NV-DXVK start: persistent shader cache
+    this->shaderDiskCache               = config.getOption<bool>        ("d3d9.shaderDiskCache",               true);
+    // NV-DXVK end
+    // NV-DXVK start: async shader compilation
+    this->asyncShaderCompile            = config.getOption<bool>        ("d3d9.asyncShaderCompile",            false);
+    this->shaderCompileThreads          = config.getOption<int32_t>     ("d3d9.shaderCompileThreads",          0);
+    // NV-DXVK end
+    // NV-DXVK start: constant upload deduplication
+    this->deduplicateConstantUploads    = config.getOption<bool>        ("d3d9.deduplicateConstantUploads",    true);
+    // NV-DXVK end
 
     // If we are not Nvidia, enable general hazards.
     this->generalHazards = adapter != nullptr
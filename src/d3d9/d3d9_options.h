@@ -197,6 +197,25 @@ namespace dxvk {
     /// Override the adapter/GPU used for D3D9 (-1 = use application defined)
     int adapterOverride;
     // NV-DXVK end
+
+    // NV-DXVK start: persistent shader cache
+    /// Store compiled shaders on disk, so that later runs can skip compiling them
+    bool shaderDiskCache;
+    // NV-DXVK end
+
+    // NV-DXVK start: async shader compilation
+    /// Compile shaders on worker threads, binding waits for unfinished ones
+    bool asyncShaderCompile;
+
+    /// Number of shader compiler threads, 0 to pick automatically
+    int32_t shaderCompileThreads;
+    // NV-DXVK end
+
+    // NV-DXVK start: constant upload deduplication
+    /// Rebind recently uploaded constant buffers whose content matches
+    /// instead of uploading the same constants again
+    bool deduplicateConstantUploads;
+    // NV-DXVK end
   };
 
 }
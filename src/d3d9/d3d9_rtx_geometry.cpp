@@ -6,6 +6,7 @@
 #include "../dxvk/dxvk_buffer.h"
 #include "../dxvk/rtx_render/rtx_hashing.h"
 #include "../util/util_fastops.h"
+#include "../util/log/metrics_registry.h"
 
 namespace dxvk {
   // Geometry indices should never be signed.  Using this to handle the non-indexed case for templates.
@@ -189,6 +190,9 @@ namespace dxvk {
                                  vertexLayoutHash]() -> GeometryHashes {
       ScopedCpuProfileZone();
 
+      static const MetricHistogramRecorder s_hashTime = MetricsRegistry::get().registerHistogram("rtx_geometry_hash_time_us");
+      const auto hashStart = std::chrono::high_resolution_clock::now();
+
       GeometryHashes hashes;
 
       // Finalize the descriptor hash
@@ -213,6 +217,8 @@ namespace dxvk {
 
       hashes.precombine();
 
+      s_hashTime.record(std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - hashStart).count());
+
       return hashes;
     });
   }
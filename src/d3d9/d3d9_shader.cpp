@@ -4,6 +4,10 @@
 #include "d3d9_device.h"
 #include "d3d9_util.h"
 #include "../dxvk/dxvk_scoped_annotation.h"
+// NV-DXVK start: persistent shader cache
+#include "../dxvk/rtx_render/rtx_terrain_baker.h"
+#include <version.h>
+// NV-DXVK end
 
 
 namespace dxvk {
@@ -78,13 +82,6 @@ namespace dxvk {
     m_constants = pModule->constants();
     m_maxDefinedConst = pModule->maxDefinedConstant();
 
-    m_shaders[0]->setShaderKey(Key);
-
-    if (m_shaders[1] != nullptr) {
-      // Lets lie about the shader key type for the state cache.
-      m_shaders[1]->setShaderKey({ VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, Key.sha1() });
-    }
-    
     if (dumpPath.size() != 0) {
       std::ofstream dumpStream(
         str::tows(str::format(dumpPath, "/", name, ".spv").c_str()).c_str(),
@@ -93,6 +90,56 @@ namespace dxvk {
       m_shaders[0]->dump(dumpStream);
     }
 
+    // NV-DXVK start: persistent shader cache
+    RegisterShaders(pDevice, Key);
+    // NV-DXVK end
+  }
+
+
+  // NV-DXVK start: persistent shader cache
+  D3D9CommonShader::D3D9CommonShader(
+            D3D9DeviceEx*         pDevice,
+            VkShaderStageFlagBits ShaderStage,
+      const DxvkShaderKey&        Key,
+      const void*                 pShaderBytecode,
+      const DxsoProgramInfo&      ProgramInfo,
+      const DxsoCachedShader&     CachedShader) {
+    const uint32_t bytecodeLength = CachedShader.bytecodeByteLength;
+    m_bytecode.resize(bytecodeLength);
+    std::memcpy(m_bytecode.data(), pShaderBytecode, bytecodeLength);
+
+    Logger::debug(str::format("Loading cached shader ", Key.toString()));
+
+    m_shaders      = CachedShader.createPermutations();
+    m_isgn         = CachedShader.isgn;
+    m_osgn         = CachedShader.osgn;
+    m_usedSamplers = CachedShader.usedSamplers;
+
+    // Same shift as for compiled shaders
+    if (ShaderStage == VK_SHADER_STAGE_VERTEX_BIT)
+      m_usedSamplers <<= caps::MaxTexturesPS + 1;
+
+    m_usedRTs      = CachedShader.usedRTs;
+
+    m_info      = ProgramInfo;
+    m_meta      = CachedShader.meta;
+    m_constants = CachedShader.constants;
+    m_maxDefinedConst = CachedShader.maxDefinedConst;
+
+    RegisterShaders(pDevice, Key);
+  }
+
+
+  void D3D9CommonShader::RegisterShaders(
+          D3D9DeviceEx*         pDevice,
+    const DxvkShaderKey&        Key) {
+    m_shaders[0]->setShaderKey(Key);
+
+    if (m_shaders[1] != nullptr) {
+      // Lets lie about the shader key type for the state cache.
+      m_shaders[1]->setShaderKey({ VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, Key.sha1() });
+    }
+
     pDevice->GetDXVKDevice()->registerShader(m_shaders[0]);
 
     if (m_shaders[1] != nullptr)
@@ -100,6 +147,138 @@ namespace dxvk {
   }
 
 
+  DxsoShaderCache* D3D9ShaderModuleSet::GetDiskCache(
+          D3D9DeviceEx*         pDevice) {
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    if (std::exchange(m_diskCacheInitialized, true))
+      return m_diskCache.get();
+
+    if (!pDevice->GetOptions()->shaderDiskCache || env::getEnvVar("DXVK_SHADER_DISK_CACHE") == "0")
+      return nullptr;
+
+    static dxvk::mutex s_mutex;
+    static std::weak_ptr<DxsoShaderCache> s_cache;
+
+    std::lock_guard<dxvk::mutex> cacheLock(s_mutex);
+    m_diskCache = s_cache.lock();
+
+    if (m_diskCache == nullptr) {
+      // Lives next to the pipeline state cache
+      std::string path = env::getEnvVar("DXVK_STATE_CACHE_PATH");
+
+      if (!path.empty() && *path.rbegin() != '/')
+        path += '/';
+
+      path += env::getExeBaseName() + ".dxso-cache";
+
+      m_diskCache = std::make_shared<DxsoShaderCache>(path, DXVK_VERSION);
+      s_cache = m_diskCache;
+    }
+
+    return m_diskCache.get();
+  }
+  // NV-DXVK end
+
+
+  // NV-DXVK start: async shader compilation
+  D3D9CommonShader::D3D9CommonShader(
+      const void*                 pShaderBytecode,
+            uint32_t              BytecodeLength,
+      const DxsoProgramInfo&      ProgramInfo,
+      const std::shared_ptr<D3D9PendingShader>& Pending)
+  : m_info(ProgramInfo), m_pending(Pending) {
+    m_bytecode.resize(BytecodeLength);
+    std::memcpy(m_bytecode.data(), pShaderBytecode, BytecodeLength);
+  }
+
+
+  bool D3D9CommonShader::WaitForCompile() const {
+    if (likely(m_pending == nullptr))
+      return true;
+
+    m_pending->job->wait();
+
+    if (likely(m_pending->error.empty()))
+      return true;
+
+    if (!m_pending->errorReported.exchange(true))
+      Logger::err(str::format("D3D9: ", m_pending->error, ", refusing to bind it"));
+
+    return false;
+  }
+
+
+  const D3D9CommonShader& D3D9CommonShader::ResolvePending() const {
+    m_pending->job->wait();
+
+    // A failed compile leaves the result empty. The device never binds such
+    // a shader (see WaitForCompile), and nothing here may throw into the app.
+    return m_pending->result;
+  }
+
+
+  void D3D9ShaderModuleSet::FinishCompileJobs() {
+    std::unique_ptr<DxsoCompileWorkers> compileWorkers;
+
+    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+      compileWorkers = std::move(m_compileWorkers);
+    }
+
+    // Destroying the workers runs whatever is still queued
+    compileWorkers = nullptr;
+  }
+
+
+  DxsoCompileWorkers* D3D9ShaderModuleSet::GetCompileWorkers(
+          D3D9DeviceEx*         pDevice) {
+    if (!pDevice->GetOptions()->asyncShaderCompile)
+      return nullptr;
+
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    if (m_compileWorkers == nullptr) {
+      uint32_t numWorkers = DxsoCompileWorkers::getDefaultWorkerCount();
+
+      if (pDevice->GetOptions()->shaderCompileThreads > 0)
+        numWorkers = uint32_t(pDevice->GetOptions()->shaderCompileThreads);
+
+      Logger::info(str::format("D3D9: Using ", numWorkers, " shader compiler threads"));
+      m_compileWorkers = std::make_unique<DxsoCompileWorkers>(numWorkers);
+    }
+
+    return m_compileWorkers.get();
+  }
+
+
+  static void StoreInDiskCache(
+          DxsoShaderCache*      pDiskCache,
+    const Sha1Hash&             DiskCacheKey,
+    const DxsoAnalysisInfo&     AnalysisInfo,
+          DxsoModule&           Module,
+    const D3D9CommonShader&     Shader) {
+    DxsoCachedShader cached;
+    cached.bytecodeByteLength = AnalysisInfo.bytecodeByteLength;
+    cached.usesDerivatives    = AnalysisInfo.usesDerivatives;
+    cached.usesKill           = AnalysisInfo.usesKill;
+    cached.isgn               = Module.isgn();
+    cached.osgn               = Module.osgn();
+    cached.usedSamplers       = Module.usedSamplers();
+    cached.usedRTs            = Module.usedRTs();
+    cached.meta               = Module.meta();
+    cached.constants          = Module.constants();
+    cached.maxDefinedConst    = Module.maxDefinedConstant();
+
+    DxsoPermutations shaders;
+    for (uint32_t i = 0; i < D3D9ShaderPermutations::Count; i++)
+      shaders[i] = Shader.GetShader(D3D9ShaderPermutation(i));
+
+    cached.setPermutations(shaders);
+    pDiskCache->store(DiskCacheKey, cached);
+  }
+  // NV-DXVK end
+
+
   void D3D9ShaderModuleSet::GetShaderModule(
             D3D9DeviceEx*         pDevice,
             D3D9CommonShader*     pShaderModule,
@@ -134,12 +313,90 @@ namespace dxvk {
       }
     }
     
-    // This shader has not been compiled yet, so we have to create a
-    // new module. This takes a while, so we won't lock the structure.
-    *pShaderModule = D3D9CommonShader(
-      pDevice, ShaderStage, lookupKey,
-      pDxbcModuleInfo, pShaderBytecode,
-      info, &module);
+    // NV-DXVK start: persistent shader cache
+    DxsoShaderCache* diskCache = GetDiskCache(pDevice);
+    Sha1Hash diskCacheKey;
+    bool loaded = false;
+
+    if (diskCache != nullptr) {
+      const D3D9ConstantLayout& constantLayout = ShaderStage == VK_SHADER_STAGE_VERTEX_BIT
+        ? pDevice->GetVertexConstantLayout()
+        : pDevice->GetPixelConstantLayout();
+
+      // The compiler injects terrain baking code depending on this option
+      const uint32_t compilerFlags = TerrainBaker::Material::replacementSupportInPS_programmableShaders() ? 1u : 0u;
+
+      diskCacheKey = DxsoShaderCache::computeKey(ShaderStage, lookupKey.sha1(),
+        *pDxbcModuleInfo, constantLayout, compilerFlags);
+
+      DxsoCachedShader cached;
+
+      // The analysis is cheap and already done, use it to reject stale entries
+      if (diskCache->lookup(diskCacheKey, cached)
+       && cached.bytecodeByteLength == info.bytecodeByteLength
+       && cached.usesDerivatives    == info.usesDerivatives
+       && cached.usesKill           == info.usesKill) {
+        *pShaderModule = D3D9CommonShader(
+          pDevice, ShaderStage, lookupKey,
+          pShaderBytecode, module.info(), cached);
+        loaded = true;
+      }
+    }
+    // NV-DXVK end
+
+    // NV-DXVK start: async shader compilation
+    DxsoCompileWorkers* compileWorkers = loaded ? nullptr : GetCompileWorkers(pDevice);
+    std::shared_ptr<D3D9PendingShader> pending;
+
+    if (compileWorkers != nullptr) {
+      // Only decode and hash on the calling thread. The job decodes
+      // its own copy of the bytecode, since the application may free
+      // the original as soon as the create call returns.
+      pending = std::make_shared<D3D9PendingShader>();
+
+      *pShaderModule = D3D9CommonShader(
+        pShaderBytecode, info.bytecodeByteLength,
+        module.info(), pending);
+
+      pending->job = new DxsoCompileJob([
+        pDevice, ShaderStage, lookupKey, pending, diskCache, diskCacheKey,
+        moduleInfo = *pDxbcModuleInfo,
+        bytecode   = pShaderModule->GetBytecode()
+      ] () {
+        try {
+          DxsoReader jobReader(
+            reinterpret_cast<const char*>(bytecode.data()));
+
+          DxsoModule jobModule(jobReader);
+          DxsoAnalysisInfo jobInfo = jobModule.analyze();
+
+          pending->result = D3D9CommonShader(
+            pDevice, ShaderStage, lookupKey,
+            &moduleInfo, bytecode.data(),
+            jobInfo, &jobModule);
+
+          if (diskCache != nullptr)
+            StoreInDiskCache(diskCache, diskCacheKey, jobInfo, jobModule, pending->result);
+        }
+        catch (const DxvkError& e) {
+          Logger::err(e.message());
+          pending->error = str::format("Failed to compile shader ", lookupKey.toString());
+        }
+      });
+    } else if (!loaded) {
+    // NV-DXVK end
+      // This shader has not been compiled yet, so we have to create a
+      // new module. This takes a while, so we won't lock the structure.
+      *pShaderModule = D3D9CommonShader(
+        pDevice, ShaderStage, lookupKey,
+        pDxbcModuleInfo, pShaderBytecode,
+        info, &module);
+
+      // NV-DXVK start: persistent shader cache
+      if (diskCache != nullptr)
+        StoreInDiskCache(diskCache, diskCacheKey, info, module, *pShaderModule);
+    }
+    // NV-DXVK end
     
     // Insert the new module into the lookup table. If another thread
     // has compiled the same shader in the meantime, we should return
@@ -148,10 +405,21 @@ namespace dxvk {
       
       auto status = m_modules.insert({ lookupKey, *pShaderModule });
       if (!status.second) {
+        // NV-DXVK start: async shader compilation
+        // The job was never submitted, drop it along with what it captured
+        if (pending != nullptr)
+          pending->job = nullptr;
+        // NV-DXVK end
+
         *pShaderModule = status.first->second;
         return;
       }
     }
+
+    // NV-DXVK start: async shader compilation
+    if (pending != nullptr)
+      compileWorkers->submit(pending->job);
+    // NV-DXVK end
   }
 
 }
@@ -2,13 +2,20 @@
 
 #include "d3d9_resource.h"
 #include "../dxso/dxso_module.h"
+#include "../dxso/dxso_shader_cache.h"
+#include "../dxso/dxso_compile_workers.h"
 #include "d3d9_shader_permutations.h"
 #include "d3d9_util.h"
 
 #include <array>
+#include <atomic>
+#include <memory>
 
 namespace dxvk {
 
+  // NV-DXVK start: async shader compilation
+  struct D3D9PendingShader;
+  // NV-DXVK end
 
   /**
    * \brief Common shader object
@@ -32,13 +39,41 @@ namespace dxvk {
       const DxsoAnalysisInfo&     AnalysisInfo,
             DxsoModule*           pModule);
 
+    // NV-DXVK start: persistent shader cache
+    D3D9CommonShader(
+            D3D9DeviceEx*         pDevice,
+            VkShaderStageFlagBits ShaderStage,
+      const DxvkShaderKey&        Key,
+      const void*                 pShaderBytecode,
+      const DxsoProgramInfo&      ProgramInfo,
+      const DxsoCachedShader&     CachedShader);
+    // NV-DXVK end
+
+    // NV-DXVK start: async shader compilation
+    /**
+     * \brief Creates a shader that is compiled by a job
+     *
+     * Only the bytecode and program info are available right
+     * away. Everything else waits for the job to finish.
+     */
+    D3D9CommonShader(
+      const void*                 pShaderBytecode,
+            uint32_t              BytecodeLength,
+      const DxsoProgramInfo&      ProgramInfo,
+      const std::shared_ptr<D3D9PendingShader>& Pending);
+    // NV-DXVK end
+
 
     Rc<DxvkShader> GetShader(D3D9ShaderPermutation Permutation) const {
-      return m_shaders[Permutation];
+      // NV-DXVK start: async shader compilation
+      return Resolve().m_shaders[Permutation];
+      // NV-DXVK end
     }
 
     std::string GetName() const {
-      return m_shaders[D3D9ShaderPermutations::None]->debugName();
+      // NV-DXVK start: async shader compilation
+      return Resolve().m_shaders[D3D9ShaderPermutations::None]->debugName();
+      // NV-DXVK end
     }
 
     const std::vector<uint8_t>& GetBytecode() const {
@@ -46,26 +81,54 @@ namespace dxvk {
     }
 
     const DxsoIsgn& GetIsgn() const {
-      return m_isgn;
+      // NV-DXVK start: async shader compilation
+      return Resolve().m_isgn;
+      // NV-DXVK end
     }
 
     // NV-DXVK start: expose shader outputs for vertex capture
     const DxsoIsgn& GetOsgn() const {
-      return m_osgn;
+      return Resolve().m_osgn;
     }
     // NV-DXVK end
 
-    const DxsoShaderMetaInfo& GetMeta() const { return m_meta; }
-    const DxsoDefinedConstants& GetConstants() const { return m_constants; }
+    // NV-DXVK start: async shader compilation
+    const DxsoShaderMetaInfo& GetMeta() const { return Resolve().m_meta; }
+    const DxsoDefinedConstants& GetConstants() const { return Resolve().m_constants; }
 
-    D3D9ShaderMasks GetShaderMask() const { return D3D9ShaderMasks{ m_usedSamplers, m_usedRTs }; }
+    D3D9ShaderMasks GetShaderMask() const { return D3D9ShaderMasks{ Resolve().m_usedSamplers, Resolve().m_usedRTs }; }
+    // NV-DXVK end
 
     const DxsoProgramInfo& GetInfo() const { return m_info; }
 
-    uint32_t GetMaxDefinedConstant() const { return m_maxDefinedConst; }
+    // NV-DXVK start: async shader compilation
+    uint32_t GetMaxDefinedConstant() const { return Resolve().m_maxDefinedConst; }
+
+    /**
+     * \brief Waits for a deferred compile to finish
+     *
+     * Shaders whose compilation failed must not be bound.
+     * \returns \c false if compilation failed
+     */
+    bool WaitForCompile() const;
+    // NV-DXVK end
 
   private:
 
+    // NV-DXVK start: async shader compilation
+    const D3D9CommonShader& Resolve() const {
+      return likely(m_pending == nullptr) ? *this : ResolvePending();
+    }
+
+    const D3D9CommonShader& ResolvePending() const;
+    // NV-DXVK end
+
+    // NV-DXVK start: persistent shader cache
+    void RegisterShaders(
+            D3D9DeviceEx*         pDevice,
+      const DxvkShaderKey&        Key);
+    // NV-DXVK end
+
     DxsoIsgn              m_isgn;
     // NV-DXVK start: expose shader outputs for vertex capture
     DxsoIsgn              m_osgn;
@@ -82,7 +145,27 @@ namespace dxvk {
 
     std::vector<uint8_t>  m_bytecode;
 
+    // NV-DXVK start: async shader compilation
+    std::shared_ptr<D3D9PendingShader> m_pending;
+    // NV-DXVK end
+
+  };
+
+  // NV-DXVK start: async shader compilation
+  /**
+   * \brief Shader that is being compiled
+   *
+   * Shared by every copy of a D3D9CommonShader created
+   * for asynchronous compilation. The job fills in the
+   * result, or the error if compilation failed.
+   */
+  struct D3D9PendingShader {
+    Rc<DxsoCompileJob> job;
+    D3D9CommonShader   result;
+    std::string        error;
+    std::atomic<bool>  errorReported = { false };
   };
+  // NV-DXVK end
 
   /**
    * \brief Common shader interface
@@ -188,6 +271,16 @@ namespace dxvk {
             VkShaderStageFlagBits ShaderStage,
       const DxsoModuleInfo*       pDxbcModuleInfo,
       const void*                 pShaderBytecode);
+
+    // NV-DXVK start: async shader compilation
+    /**
+     * \brief Finishes all queued compile jobs
+     *
+     * The jobs use the device, so this must be
+     * called before the device is torn down.
+     */
+    void FinishCompileJobs();
+    // NV-DXVK end
     
   private:
     
@@ -197,6 +290,22 @@ namespace dxvk {
       DxvkShaderKey,
       D3D9CommonShader,
       DxvkHash, DxvkEq> m_modules;
+
+    // NV-DXVK start: persistent shader cache
+    // Shared by all devices of the process, since they append to the same file.
+    std::shared_ptr<DxsoShaderCache> m_diskCache;
+    bool                             m_diskCacheInitialized = false;
+
+    DxsoShaderCache* GetDiskCache(
+            D3D9DeviceEx*         pDevice);
+    // NV-DXVK end
+
+    // NV-DXVK start: async shader compilation
+    std::unique_ptr<DxsoCompileWorkers> m_compileWorkers;
+
+    DxsoCompileWorkers* GetCompileWorkers(
+            D3D9DeviceEx*         pDevice);
+    // NV-DXVK end
     
   };
 
@@ -0,0 +1,128 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "dxso_compile_workers.h"
+
+#include <algorithm>
+
+#include "../util/util_env.h"
+
+namespace dxvk {
+
+  DxsoCompileJob::DxsoCompileJob(std::function<void ()>&& task)
+  : m_task(std::move(task)) { }
+
+
+  bool DxsoCompileJob::tryRun() {
+    State expected = State::Pending;
+
+    if (!m_state.compare_exchange_strong(expected, State::Running, std::memory_order_acquire))
+      return false;
+
+    m_task();
+
+    // Drop everything the task captured as soon as it is done
+    m_task = nullptr;
+
+    { std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_state.store(State::Done, std::memory_order_release);
+    }
+
+    m_cond.notify_all();
+    return true;
+  }
+
+
+  void DxsoCompileJob::wait() {
+    if (isDone() || tryRun())
+      return;
+
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    m_cond.wait(lock, [this] () {
+      return isDone();
+    });
+  }
+
+
+  uint32_t DxsoCompileWorkers::getDefaultWorkerCount() {
+    // Leave a core to the application thread that submits the work
+    const uint32_t numCpuCores = dxvk::thread::hardware_concurrency();
+    return std::clamp(std::max(1u, numCpuCores) - 1, 1u, 8u);
+  }
+
+
+  DxsoCompileWorkers::DxsoCompileWorkers(uint32_t numWorkers) {
+    numWorkers = std::max(numWorkers, 1u);
+
+    for (uint32_t i = 0; i < numWorkers; i++)
+      m_workers.emplace_back([this] () { workerFunc(); });
+  }
+
+
+  DxsoCompileWorkers::~DxsoCompileWorkers() {
+    { std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_stopped = true;
+    }
+
+    m_cond.notify_all();
+
+    for (auto& worker : m_workers)
+      worker.join();
+  }
+
+
+  void DxsoCompileWorkers::submit(const Rc<DxsoCompileJob>& job) {
+    { std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_queue.push(job);
+    }
+
+    m_cond.notify_one();
+  }
+
+
+  void DxsoCompileWorkers::workerFunc() {
+    env::setThreadName("dxvk-dxso-compiler");
+
+    while (true) {
+      Rc<DxsoCompileJob> job;
+
+      { std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+        m_cond.wait(lock, [this] () {
+          return m_queue.size()
+              || m_stopped;
+        });
+
+        // Drain the queue before stopping
+        if (m_queue.empty())
+          break;
+
+        job = std::move(m_queue.front());
+        m_queue.pop();
+      }
+
+      // Jobs that a waiting thread already ran are skipped
+      job->tryRun();
+    }
+  }
+
+}
@@ -0,0 +1,138 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "../util/thread.h"
+
+#include "../util/rc/util_rc.h"
+#include "../util/rc/util_rc_ptr.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Shader compile job
+   *
+   * Runs its task exactly once, either on a compile worker or on
+   * the first thread that needs the result before any worker got
+   * to it, so that waiting never queues behind unrelated shaders.
+   * The task must not throw.
+   */
+  class DxsoCompileJob : public RcObject {
+
+  public:
+
+    DxsoCompileJob(std::function<void ()>&& task);
+
+    /**
+     * \brief Checks whether the task has finished
+     */
+    bool isDone() const {
+      return m_state.load(std::memory_order_acquire) == State::Done;
+    }
+
+    /**
+     * \brief Runs the task if nobody has started it yet
+     * \returns \c true if the task ran on this thread
+     */
+    bool tryRun();
+
+    /**
+     * \brief Waits for the task to finish
+     *
+     * Runs the task on the calling thread if
+     * no worker has picked it up yet.
+     */
+    void wait();
+
+  private:
+
+    enum class State : uint32_t {
+      Pending,
+      Running,
+      Done,
+    };
+
+    std::atomic<State>        m_state = { State::Pending };
+    std::function<void ()>    m_task;
+
+    dxvk::mutex               m_mutex;
+    dxvk::condition_variable  m_cond;
+
+  };
+
+
+  /**
+   * \brief Shader compile workers
+   *
+   * Runs compile jobs on a fixed set of threads. Jobs that are
+   * still queued when the workers are destroyed are run before
+   * the destructor returns, so that no task outlives the object
+   * that owns the workers.
+   */
+  class DxsoCompileWorkers {
+
+  public:
+
+    /**
+     * \brief Default worker count for this machine
+     */
+    static uint32_t getDefaultWorkerCount();
+
+    DxsoCompileWorkers(uint32_t numWorkers);
+
+    ~DxsoCompileWorkers();
+
+    DxsoCompileWorkers(const DxsoCompileWorkers&) = delete;
+    DxsoCompileWorkers& operator = (const DxsoCompileWorkers&) = delete;
+
+    /**
+     * \brief Number of worker threads
+     */
+    uint32_t workerCount() const {
+      return uint32_t(m_workers.size());
+    }
+
+    /**
+     * \brief Queues a job
+     * \param [in] job The job to run
+     */
+    void submit(const Rc<DxsoCompileJob>& job);
+
+  private:
+
+    dxvk::mutex                     m_mutex;
+    dxvk::condition_variable        m_cond;
+    std::queue<Rc<DxsoCompileJob>>  m_queue;
+    bool                            m_stopped = false;
+
+    std::vector<dxvk::thread>       m_workers;
+
+    void workerFunc();
+
+  };
+
+}
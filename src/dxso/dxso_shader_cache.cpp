@@ -0,0 +1,566 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "dxso_shader_cache.h"
+
+#include <type_traits>
+
+#include "../util/log/log.h"
+#include "../util/util_env.h"
+#include "../util/util_string.h"
+
+namespace dxvk {
+
+  namespace {
+
+    // Entries larger than this are treated as corruption
+    constexpr uint32_t MaxEntrySize = 64u << 20;
+
+    struct DxsoShaderCacheHeader {
+      char     magic[4] = { 'D', 'X', 'S', 'C' };
+      uint32_t version  = DxsoShaderCache::Version;
+      Sha1Hash buildHash;
+    };
+
+    struct DxsoShaderCacheEntryHeader {
+      Sha1Hash key;
+      Sha1Hash checksum;
+      uint32_t size = 0;
+    };
+
+    // Types that are written as raw memory. The build hash covers
+    // their sizes, the cache version covers their layout.
+    static_assert(std::is_trivially_copyable_v<DxsoIsgn>);
+    static_assert(std::is_trivially_copyable_v<DxsoShaderMetaInfo>);
+    static_assert(std::is_trivially_copyable_v<DxsoDefinedConstant>);
+    static_assert(std::is_trivially_copyable_v<DxvkResourceSlot>);
+    static_assert(std::is_trivially_copyable_v<DxvkInterfaceSlots>);
+
+    class DxsoCacheWriter {
+
+    public:
+
+      template<typename T>
+      void write(const T& data) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&data);
+        m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+      }
+
+      template<typename T>
+      void writeArray(const std::vector<T>& data) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(uint32_t(data.size()));
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+        m_data.insert(m_data.end(), bytes, bytes + sizeof(T) * data.size());
+      }
+
+      std::vector<uint8_t> finish() {
+        return std::move(m_data);
+      }
+
+    private:
+
+      std::vector<uint8_t> m_data;
+
+    };
+
+    class DxsoCacheReader {
+
+    public:
+
+      DxsoCacheReader(const uint8_t* data, size_t size)
+      : m_data(data), m_size(size) { }
+
+      template<typename T>
+      bool read(T& data) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (m_size - m_read < sizeof(T))
+          return false;
+
+        std::memcpy(&data, m_data + m_read, sizeof(T));
+        m_read += sizeof(T);
+        return true;
+      }
+
+      template<typename T>
+      bool readArray(std::vector<T>& data, uint32_t maxCount) {
+        uint32_t count = 0;
+        if (!read(count) || count > maxCount || (m_size - m_read) / sizeof(T) < count)
+          return false;
+
+        data.resize(count);
+        std::memcpy(data.data(), m_data + m_read, sizeof(T) * count);
+        m_read += sizeof(T) * count;
+        return true;
+      }
+
+      bool eof() const {
+        return m_read == m_size;
+      }
+
+    private:
+
+      const uint8_t* m_data;
+      size_t         m_size;
+      size_t         m_read = 0;
+
+    };
+
+    bool readBool(DxsoCacheReader& reader, bool& value) {
+      uint8_t byte = 0;
+      if (!reader.read(byte) || byte > 1)
+        return false;
+
+      value = byte != 0;
+      return true;
+    }
+
+    std::string getDirectory(const std::string& filePath) {
+      size_t pos = filePath.find_last_of("/\\");
+      return pos != std::string::npos ? filePath.substr(0, pos) : std::string();
+    }
+
+  }
+
+
+  void DxsoCachedShader::setPermutations(const DxsoPermutations& shaders) {
+    for (uint32_t i = 0; i < D3D9ShaderPermutations::Count; i++) {
+      hasPermutation[i] = shaders[i] != nullptr;
+
+      if (!hasPermutation[i]) {
+        permutations[i] = DxsoCachedPermutation();
+        continue;
+      }
+
+      permutations[i].stage = shaders[i]->stage();
+      permutations[i].slots = shaders[i]->resourceSlots();
+      permutations[i].iface = shaders[i]->interfaceSlots();
+      // Entries are written once and read rarely, so trade some
+      // decoding speed for a smaller file
+      permutations[i].code  = SpirvCompressedBuffer(
+        shaders[i]->compressedCode().decompress(),
+        SpirvCompressionMode::Dictionary);
+    }
+  }
+
+
+  DxsoPermutations DxsoCachedShader::createPermutations() const {
+    DxsoPermutations shaders = { };
+
+    for (uint32_t i = 0; i < D3D9ShaderPermutations::Count; i++) {
+      if (!hasPermutation[i])
+        continue;
+
+      // Matches DxsoCompiler::compileShader, which uses
+      // default options and no constant data
+      const DxsoCachedPermutation& permutation = permutations[i];
+
+      shaders[i] = new DxvkShader(
+        permutation.stage,
+        permutation.slots.size(),
+        permutation.slots.data(),
+        permutation.iface,
+        permutation.code.decompress(),
+        DxvkShaderOptions { },
+        DxvkShaderConstData());
+    }
+
+    return shaders;
+  }
+
+
+  DxsoShaderCache::DxsoShaderCache(
+    const std::string&          filePath,
+    const std::string&          buildId)
+  : m_filePath(filePath) {
+    // Raw-copied types change size when their layout changes
+    const uint32_t typeSizes[] = {
+      uint32_t(sizeof(DxsoIsgn)),
+      uint32_t(sizeof(DxsoShaderMetaInfo)),
+      uint32_t(sizeof(DxsoDefinedConstant)),
+      uint32_t(sizeof(DxvkResourceSlot)),
+      uint32_t(sizeof(DxvkInterfaceSlots)),
+    };
+
+    const Sha1Data buildData[] = {
+      { buildId.data(), buildId.size() },
+      { typeSizes,      sizeof(typeSizes) },
+    };
+
+    m_buildHash = Sha1Hash::compute(std::size(buildData), buildData);
+
+    if (!readCacheFile())
+      writeCacheFile();
+
+    Logger::info(str::format("DXSO: Loaded ", m_loadedEntryCount, " shaders from ", m_filePath));
+
+    m_writerThread = dxvk::thread([this] () { writerFunc(); });
+  }
+
+
+  DxsoShaderCache::~DxsoShaderCache() {
+    { std::lock_guard<dxvk::mutex> lock(m_writerLock);
+      m_stopWriter = true;
+      m_writerCond.notify_one();
+    }
+
+    m_writerThread.join();
+  }
+
+
+  Sha1Hash DxsoShaderCache::computeKey(
+          VkShaderStageFlagBits stage,
+    const Sha1Hash&             bytecodeHash,
+    const DxsoModuleInfo&       moduleInfo,
+    const D3D9ConstantLayout&   layout,
+          uint32_t              compilerFlags) {
+    // Options are packed explicitly rather than hashed
+    // as raw memory, which would include padding bytes
+    const DxsoOptions& options = moduleInfo.options;
+
+    const uint32_t state[] = {
+      Version,
+      uint32_t(stage),
+      uint32_t(options.useDemoteToHelperInvocation),
+      uint32_t(options.useSubgroupOpsForEarlyDiscard),
+      uint32_t(options.strictConstantCopies),
+      uint32_t(options.d3d9FloatEmulation),
+      uint32_t(options.strictPow),
+      options.shaderModel,
+      uint32_t(options.invariantPosition),
+      uint32_t(options.forceSamplerTypeSpecConstants),
+      uint32_t(options.vertexFloatConstantBufferAsSSBO),
+      uint32_t(options.longMad),
+      uint32_t(options.alphaTestWiggleRoom),
+      uint32_t(options.robustness2Supported),
+      layout.floatCount,
+      layout.intCount,
+      layout.boolCount,
+      layout.bitmaskCount,
+      compilerFlags,
+    };
+
+    const Sha1Data keyData[] = {
+      { &bytecodeHash, sizeof(bytecodeHash) },
+      { state,         sizeof(state) },
+    };
+
+    return Sha1Hash::compute(std::size(keyData), keyData);
+  }
+
+
+  bool DxsoShaderCache::lookup(
+    const Sha1Hash&             key,
+          DxsoCachedShader&     shader) {
+    std::vector<uint8_t> payload;
+
+    { std::lock_guard<dxvk::mutex> lock(m_entryLock);
+
+      auto entry = m_entries.find(key);
+
+      // Entries without a payload were already handed
+      // out, or were stored during this session
+      if (entry == m_entries.end() || entry->second.empty())
+        return false;
+
+      payload = std::move(entry->second);
+      entry->second.clear();
+    }
+
+    if (!deserialize(payload.data(), payload.size(), shader)) {
+      Logger::warn(str::format("DXSO: Discarding invalid cache entry ", key.toString()));
+
+      std::lock_guard<dxvk::mutex> lock(m_entryLock);
+      m_entries.erase(key);
+      return false;
+    }
+
+    return true;
+  }
+
+
+  void DxsoShaderCache::store(
+    const Sha1Hash&             key,
+    const DxsoCachedShader&     shader) {
+    { std::lock_guard<dxvk::mutex> lock(m_entryLock);
+
+      if (!m_entries.emplace(key, std::vector<uint8_t>()).second)
+        return;
+    }
+
+    WriterItem item = { key, serialize(shader) };
+
+    std::lock_guard<dxvk::mutex> lock(m_writerLock);
+    m_writerQueue.push(std::move(item));
+    m_writerCond.notify_one();
+  }
+
+
+  void DxsoShaderCache::flush() {
+    std::unique_lock<dxvk::mutex> lock(m_writerLock);
+
+    m_writerIdleCond.wait(lock, [this] () {
+      return m_writerQueue.empty() && !m_writerBusy;
+    });
+  }
+
+
+  std::vector<uint8_t> DxsoShaderCache::serialize(
+    const DxsoCachedShader&     shader) {
+    DxsoCacheWriter writer;
+    writer.write(shader.bytecodeByteLength);
+    writer.write(uint8_t(shader.usesDerivatives));
+    writer.write(uint8_t(shader.usesKill));
+
+    writer.write(shader.isgn);
+    writer.write(shader.osgn);
+    writer.write(shader.usedSamplers);
+    writer.write(shader.usedRTs);
+    writer.write(shader.meta);
+    writer.writeArray(shader.constants);
+    writer.write(shader.maxDefinedConst);
+
+    for (uint32_t i = 0; i < D3D9ShaderPermutations::Count; i++) {
+      writer.write(uint8_t(shader.hasPermutation[i]));
+
+      if (!shader.hasPermutation[i])
+        continue;
+
+      const DxsoCachedPermutation& permutation = shader.permutations[i];
+      writer.write(uint32_t(permutation.stage));
+      writer.writeArray(permutation.slots);
+      writer.write(permutation.iface);
+      writer.write(uint32_t(permutation.code.mode()));
+      writer.write(permutation.code.dwords());
+      writer.writeArray(permutation.code.getMask());
+      writer.writeArray(permutation.code.getCode());
+    }
+
+    return writer.finish();
+  }
+
+
+  bool DxsoShaderCache::deserialize(
+    const uint8_t*              data,
+          size_t                size,
+          DxsoCachedShader&     shader) {
+    DxsoCacheReader reader(data, size);
+
+    if (!reader.read(shader.bytecodeByteLength)
+     || !readBool(reader, shader.usesDerivatives)
+     || !readBool(reader, shader.usesKill)
+     || !reader.read(shader.isgn)
+     || !reader.read(shader.osgn)
+     || !reader.read(shader.usedSamplers)
+     || !reader.read(shader.usedRTs)
+     || !reader.read(shader.meta)
+     || !reader.readArray(shader.constants, MaxEntrySize)
+     || !reader.read(shader.maxDefinedConst))
+      return false;
+
+    if (shader.isgn.elemCount > shader.isgn.elems.size()
+     || shader.osgn.elemCount > shader.osgn.elems.size())
+      return false;
+
+    for (uint32_t i = 0; i < D3D9ShaderPermutations::Count; i++) {
+      if (!readBool(reader, shader.hasPermutation[i]))
+        return false;
+
+      if (!shader.hasPermutation[i]) {
+        shader.permutations[i] = DxsoCachedPermutation();
+        continue;
+      }
+
+      DxsoCachedPermutation& permutation = shader.permutations[i];
+      uint32_t stage = 0;
+      uint32_t mode = 0;
+      uint32_t dwords = 0;
+      std::vector<uint64_t> mask;
+      std::vector<uint64_t> code;
+
+      if (!reader.read(stage)
+       || !reader.readArray(permutation.slots, MaxNumResourceSlots)
+       || !reader.read(permutation.iface)
+       || !reader.read(mode)
+       || !reader.read(dwords)
+       || !reader.readArray(mask, MaxEntrySize)
+       || !reader.readArray(code, MaxEntrySize))
+        return false;
+
+      if (stage != VK_SHADER_STAGE_VERTEX_BIT && stage != VK_SHADER_STAGE_FRAGMENT_BIT)
+        return false;
+
+      if (mode != uint32_t(SpirvCompressionMode::Fast) && mode != uint32_t(SpirvCompressionMode::Dictionary))
+        return false;
+
+      permutation.stage = VkShaderStageFlagBits(stage);
+      permutation.code = SpirvCompressedBuffer(dwords,
+        std::move(mask), std::move(code), SpirvCompressionMode(mode));
+
+      if (!permutation.code.isValid())
+        return false;
+    }
+
+    return reader.eof() && shader.hasPermutation[D3D9ShaderPermutations::None];
+  }
+
+
+  bool DxsoShaderCache::readCacheFile() {
+    std::ifstream file(str::tows(m_filePath.c_str()).c_str(), std::ios_base::binary);
+
+    if (!file)
+      return false;
+
+    DxsoShaderCacheHeader expected;
+    expected.buildHash = m_buildHash;
+
+    DxsoShaderCacheHeader header;
+
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+     || std::memcmp(header.magic, expected.magic, sizeof(header.magic))
+     || header.version != expected.version
+     || header.buildHash != expected.buildHash) {
+      Logger::warn("DXSO: Shader cache was written by a different build, discarding");
+      return false;
+    }
+
+    while (true) {
+      DxsoShaderCacheEntryHeader entry;
+
+      if (!file.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+        // A partially written header means the last write was cut short
+        if (file.gcount() != 0)
+          m_rejectedEntryCount += 1;
+        break;
+      }
+
+      // A bad size makes the rest of the file unreadable
+      if (entry.size > MaxEntrySize) {
+        m_rejectedEntryCount += 1;
+        break;
+      }
+
+      std::vector<uint8_t> payload(entry.size);
+
+      if (!file.read(reinterpret_cast<char*>(payload.data()), payload.size())) {
+        m_rejectedEntryCount += 1;
+        break;
+      }
+
+      if (Sha1Hash::compute(payload.data(), payload.size()) != entry.checksum) {
+        m_rejectedEntryCount += 1;
+        continue;
+      }
+
+      // Later entries replace earlier ones with the same key
+      m_entries.insert_or_assign(entry.key, std::move(payload));
+    }
+
+    m_loadedEntryCount = m_entries.size();
+
+    if (m_rejectedEntryCount) {
+      Logger::warn(str::format("DXSO: Dropped ", m_rejectedEntryCount, " corrupted shader cache entries"));
+      return false;
+    }
+
+    return true;
+  }
+
+
+  void DxsoShaderCache::writeCacheFile() {
+    // Start over with the header and the entries that are still
+    // valid, so that corrupted data isn't read again next time
+    std::ofstream file(str::tows(m_filePath.c_str()).c_str(),
+      std::ios_base::binary | std::ios_base::trunc);
+
+    if (!file && env::createDirectory(getDirectory(m_filePath))) {
+      file = std::ofstream(str::tows(m_filePath.c_str()).c_str(),
+        std::ios_base::binary | std::ios_base::trunc);
+    }
+
+    if (!file) {
+      Logger::warn(str::format("DXSO: Failed to create shader cache ", m_filePath));
+      return;
+    }
+
+    DxsoShaderCacheHeader header;
+    header.buildHash = m_buildHash;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const auto& entry : m_entries)
+      writeCacheEntry(file, entry.first, entry.second);
+  }
+
+
+  void DxsoShaderCache::writeCacheEntry(
+          std::ostream&         stream,
+    const Sha1Hash&             key,
+    const std::vector<uint8_t>& payload) const {
+    DxsoShaderCacheEntryHeader entry;
+    entry.key      = key;
+    entry.checksum = Sha1Hash::compute(payload.data(), payload.size());
+    entry.size     = uint32_t(payload.size());
+
+    stream.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    stream.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+  }
+
+
+  void DxsoShaderCache::writerFunc() {
+    env::setThreadName("dxvk-dxso-writer");
+
+    std::ofstream file;
+
+    while (true) {
+      WriterItem item;
+
+      { std::unique_lock<dxvk::mutex> lock(m_writerLock);
+
+        m_writerBusy = false;
+        m_writerIdleCond.notify_all();
+
+        m_writerCond.wait(lock, [this] () {
+          return m_writerQueue.size()
+              || m_stopWriter;
+        });
+
+        // Drain the queue before stopping
+        if (m_writerQueue.empty())
+          break;
+
+        item = std::move(m_writerQueue.front());
+        m_writerQueue.pop();
+        m_writerBusy = true;
+      }
+
+      if (!file.is_open()) {
+        file = std::ofstream(str::tows(m_filePath.c_str()).c_str(),
+          std::ios_base::binary |
+          std::ios_base::app);
+      }
+
+      writeCacheEntry(file, item.key, item.payload);
+      file.flush();
+    }
+  }
+
+}
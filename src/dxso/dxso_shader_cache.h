@@ -0,0 +1,245 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <array>
+#include <fstream>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dxso_isgn.h"
+#include "dxso_modinfo.h"
+
+#include "../d3d9/d3d9_constant_layout.h"
+#include "../d3d9/d3d9_shader_permutations.h"
+
+#include "../dxvk/dxvk_shader.h"
+
+#include "../util/sha1/sha1_util.h"
+#include "../util/thread.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Cached shader permutation
+   *
+   * Everything needed to recreate one of the
+   * DxvkShader objects produced by the compiler.
+   */
+  struct DxsoCachedPermutation {
+    VkShaderStageFlagBits         stage = VK_SHADER_STAGE_VERTEX_BIT;
+    std::vector<DxvkResourceSlot> slots;
+    DxvkInterfaceSlots            iface;
+    SpirvCompressedBuffer         code;
+  };
+
+  /**
+   * \brief Cached shader
+   *
+   * Compiler output for one DXSO shader: the SPIR-V of each
+   * permutation, plus the analysis, interface and constant
+   * metadata that D3D9CommonShader keeps next to it.
+   */
+  struct DxsoCachedShader {
+    uint32_t              bytecodeByteLength = 0;
+    bool                  usesDerivatives    = false;
+    bool                  usesKill           = false;
+
+    DxsoIsgn              isgn;
+    DxsoIsgn              osgn;
+    uint32_t              usedSamplers       = 0;
+    uint32_t              usedRTs            = 0;
+    DxsoShaderMetaInfo    meta;
+    DxsoDefinedConstants  constants;
+    uint32_t              maxDefinedConst    = 0;
+
+    std::array<bool, D3D9ShaderPermutations::Count>                  hasPermutation = { };
+    std::array<DxsoCachedPermutation, D3D9ShaderPermutations::Count> permutations;
+
+    /**
+     * \brief Stores compiled shader objects
+     * \param [in] shaders Compiler output
+     */
+    void setPermutations(const DxsoPermutations& shaders);
+
+    /**
+     * \brief Recreates the shader objects
+     * \returns One shader per stored permutation
+     */
+    DxsoPermutations createPermutations() const;
+  };
+
+  /**
+   * \brief DXSO shader disk cache
+   *
+   * Persists compiled shaders across runs, so that shaders the
+   * application created before don't have to go through the
+   * DXSO compiler again.
+   *
+   * Entries are keyed by the SHA-1 of the bytecode and of every
+   * input that affects compilation, see \ref computeKey. The file
+   * is append-only: new entries are written by a background
+   * thread, and every entry carries a checksum of its payload, so
+   * that corrupted entries are dropped when the file is read. A
+   * file written by a different build is discarded as a whole.
+   */
+  class DxsoShaderCache {
+
+  public:
+
+    /// Bump when the file layout or the serialized types change
+    static constexpr uint32_t Version = 2;
+
+    /**
+     * \brief Opens or creates a cache file
+     *
+     * \param [in] filePath Cache file, created if missing
+     * \param [in] buildId Identifies the compiler build. Files
+     *        written by a different build are discarded.
+     */
+    DxsoShaderCache(
+      const std::string&          filePath,
+      const std::string&          buildId);
+
+    ~DxsoShaderCache();
+
+    DxsoShaderCache(const DxsoShaderCache&) = delete;
+    DxsoShaderCache& operator = (const DxsoShaderCache&) = delete;
+
+    /**
+     * \brief Computes the cache key of a shader
+     *
+     * \param [in] stage Shader stage
+     * \param [in] bytecodeHash SHA-1 of the DXSO bytecode
+     * \param [in] moduleInfo Compiler options
+     * \param [in] layout Constant buffer layout of the stage
+     * \param [in] compilerFlags Any other state the compiler
+     *        reads, packed by the caller
+     * \returns Cache key
+     */
+    static Sha1Hash computeKey(
+            VkShaderStageFlagBits stage,
+      const Sha1Hash&             bytecodeHash,
+      const DxsoModuleInfo&       moduleInfo,
+      const D3D9ConstantLayout&   layout,
+            uint32_t              compilerFlags);
+
+    /**
+     * \brief Looks up a shader
+     *
+     * Entries that fail to deserialize are removed. The payload
+     * is released on a hit, since the caller keeps its own copy.
+     * \param [in] key Cache key
+     * \param [out] shader Cached shader
+     * \returns \c true on a hit
+     */
+    bool lookup(
+      const Sha1Hash&             key,
+            DxsoCachedShader&     shader);
+
+    /**
+     * \brief Adds a shader
+     *
+     * Queues the entry for the writer thread. Does
+     * nothing if the key is already in the cache.
+     * \param [in] key Cache key
+     * \param [in] shader Compiled shader
+     */
+    void store(
+      const Sha1Hash&             key,
+      const DxsoCachedShader&     shader);
+
+    /**
+     * \brief Waits for queued entries to be written
+     */
+    void flush();
+
+    /**
+     * \brief Number of valid entries read from the file
+     */
+    size_t loadedEntryCount() const {
+      return m_loadedEntryCount;
+    }
+
+    /**
+     * \brief Number of entries dropped when reading the file
+     */
+    size_t rejectedEntryCount() const {
+      return m_rejectedEntryCount;
+    }
+
+    static std::vector<uint8_t> serialize(
+      const DxsoCachedShader&     shader);
+
+    static bool deserialize(
+      const uint8_t*              data,
+            size_t                size,
+            DxsoCachedShader&     shader);
+
+  private:
+
+    struct Sha1HashFn {
+      size_t operator () (const Sha1Hash& hash) const {
+        return hash.dword(0);
+      }
+    };
+
+    struct WriterItem {
+      Sha1Hash             key;
+      std::vector<uint8_t> payload;
+    };
+
+    std::string                   m_filePath;
+    Sha1Hash                      m_buildHash;
+
+    dxvk::mutex                   m_entryLock;
+    std::unordered_map<
+      Sha1Hash, std::vector<uint8_t>,
+      Sha1HashFn>                 m_entries;
+
+    size_t                        m_loadedEntryCount   = 0;
+    size_t                        m_rejectedEntryCount = 0;
+
+    dxvk::mutex                   m_writerLock;
+    dxvk::condition_variable      m_writerCond;
+    dxvk::condition_variable      m_writerIdleCond;
+    std::queue<WriterItem>        m_writerQueue;
+    bool                          m_writerBusy  = false;
+    bool                          m_stopWriter  = false;
+    dxvk::thread                  m_writerThread;
+
+    bool readCacheFile();
+
+    void writeCacheFile();
+
+    void writeCacheEntry(
+            std::ostream&         stream,
+      const Sha1Hash&             key,
+      const std::vector<uint8_t>& payload) const;
+
+    void writerFunc();
+
+  };
+
+}
@@ -105,6 +105,147 @@ namespace dxvk {
   }
   
   
+  // NV-DXVK start: lock-free chunk handoff
+  DxvkCsQueue::DxvkCsQueue() {
+
+  }
+
+
+  DxvkCsQueue::~DxvkCsQueue() {
+
+  }
+
+
+  uint64_t DxvkCsQueue::push(DxvkCsChunkRef&& chunk) {
+    uint64_t seq;
+
+    { std::lock_guard<sync::Spinlock> lock(m_pushLock);
+      seq = m_chunksDispatched.load(std::memory_order_relaxed) + 1;
+
+      // Chunks must enter the ring in order, so once the ring
+      // has overflowed, the overflow list has to drain first
+      if (unlikely(!m_chunksOverflowed.empty()))
+        flushOverflow();
+
+      if (likely(m_chunksOverflowed.empty() && isSlotFree(seq)))
+        publish(seq, std::move(chunk));
+      else
+        m_chunksOverflowed.push(std::move(chunk));
+
+      // Both this store and the load of the parked flag are
+      // sequentially consistent, so that either the consumer
+      // sees the new chunk before parking, or we see it parked
+      m_chunksDispatched.store(seq);
+    }
+
+    if (unlikely(m_consumerParked.load())) {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_condOnAdd.notify_one();
+    }
+
+    return seq;
+  }
+
+
+  bool DxvkCsQueue::pop(DxvkCsChunkRef& chunk) {
+    uint64_t seq = m_chunksPopped + 1;
+
+    if (!isReady(seq)) {
+      // Spin for a while before parking the thread, and adapt
+      // the spin count depending on whether spinning paid off
+      uint32_t spins = 0;
+
+      while (spins < m_spinCount && !isReady(seq) && !m_stopped.load(std::memory_order_relaxed)) {
+        _mm_pause();
+        spins += 1;
+      }
+
+      if (spins < m_spinCount) {
+        m_spinCount = std::min(m_spinCount * 2, MaxSpinCount);
+      } else {
+        m_spinCount = std::max(m_spinCount / 2, MinSpinCount);
+
+        ScopedCpuProfileZoneN("waiting for work");
+        std::unique_lock<dxvk::mutex> lock(m_mutex);
+        m_consumerParked.store(true);
+
+        m_condOnAdd.wait(lock, [this, seq] {
+          return isReady(seq) || m_stopped.load();
+        });
+
+        m_consumerParked.store(false, std::memory_order_relaxed);
+      }
+    }
+
+    if (m_stopped.load())
+      return false;
+
+    // The chunk was dispatched while the ring was full. All previous
+    // chunks have been retired, so this frees up the slot it needs.
+    if (unlikely(m_chunksPublished.load(std::memory_order_acquire) < seq)) {
+      std::lock_guard<sync::Spinlock> lock(m_pushLock);
+      flushOverflow();
+    }
+
+    chunk = std::move(m_chunks[(seq - 1) % Capacity]);
+    m_chunksPopped = seq;
+    return true;
+  }
+
+
+  void DxvkCsQueue::retire() {
+    m_chunksExecuted.store(m_chunksPopped);
+
+    if (unlikely(m_waitersParked.load())) {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_condOnSync.notify_all();
+    }
+  }
+
+
+  void DxvkCsQueue::wait(uint64_t seq) {
+    for (uint32_t i = 0; i < WaitSpinCount; i++) {
+      if (isExecuted(seq))
+        return;
+
+      _mm_pause();
+    }
+
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+    m_waitersParked += 1;
+
+    m_condOnSync.wait(lock, [this, seq] {
+      return isExecuted(seq);
+    });
+
+    m_waitersParked -= 1;
+  }
+
+
+  void DxvkCsQueue::publish(uint64_t seq, DxvkCsChunkRef&& chunk) {
+    m_chunks[(seq - 1) % Capacity] = std::move(chunk);
+    m_chunksPublished.store(seq, std::memory_order_release);
+  }
+
+
+  void DxvkCsQueue::flushOverflow() {
+    uint64_t seq = m_chunksPublished.load(std::memory_order_relaxed) + 1;
+
+    while (!m_chunksOverflowed.empty() && isSlotFree(seq)) {
+      publish(seq++, std::move(m_chunksOverflowed.front()));
+      m_chunksOverflowed.pop();
+    }
+  }
+
+
+  void DxvkCsQueue::stop() {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    m_stopped.store(true);
+    m_condOnAdd.notify_one();
+  }
+  // NV-DXVK end
+
+
   DxvkCsThread::DxvkCsThread(
     const Rc<DxvkDevice>&   device,
     const Rc<DxvkContext>&  context)
@@ -115,11 +256,9 @@ namespace dxvk {
   
   
   DxvkCsThread::~DxvkCsThread() {
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      m_stopped.store(true);
-    }
-    
-    m_condOnAdd.notify_one();
+    // NV-DXVK start: lock-free chunk handoff
+    m_queue.stop();
+    // NV-DXVK end
     m_thread.join();
   }
   
@@ -127,15 +266,9 @@ namespace dxvk {
   uint64_t DxvkCsThread::dispatchChunk(DxvkCsChunkRef&& chunk) {
     ScopedCpuProfileZone();
 
-    uint64_t seq;
-
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      seq = ++m_chunksDispatched;
-      m_chunksQueued.push(std::move(chunk));
-    }
-    
-    m_condOnAdd.notify_one();
-    return seq;
+    // NV-DXVK start: lock-free chunk handoff
+    return m_queue.push(std::move(chunk));
+    // NV-DXVK end
   }
   
   
@@ -144,22 +277,20 @@ namespace dxvk {
 
     // Avoid locking if we know the sync is a no-op, may
     // reduce overhead if this is being called frequently
-    if (seq > m_chunksExecuted.load(std::memory_order_acquire)) {
-      std::unique_lock<dxvk::mutex> lock(m_mutex);
-
+    // NV-DXVK start: lock-free chunk handoff
+    if (seq > m_queue.executed()) {
       if (seq == SynchronizeAll)
-        seq = m_chunksDispatched.load();
+        seq = m_queue.dispatched();
 
       auto t0 = dxvk::high_resolution_clock::now();
-      m_condOnSync.wait(lock, [this, seq] {
-        return m_chunksExecuted.load() >= seq;
-      });
+      m_queue.wait(seq);
       auto t1 = dxvk::high_resolution_clock::now();
       auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
 
       m_device->addStatCtr(DxvkStatCounter::CsSyncCount, 1);
       m_device->addStatCtr(DxvkStatCounter::CsSyncTicks, ticks.count());
     }
+    // NV-DXVK end
   }
   
   
@@ -171,35 +302,15 @@ namespace dxvk {
     DxvkCsChunkRef chunk;
 
     try {
-      while (!m_stopped.load()) {
-        { 
-          ScopedCpuProfileZoneN("waiting for work");
-          std::unique_lock<dxvk::mutex> lock(m_mutex);
-          if (chunk) {
-            m_chunksExecuted++;
-            m_condOnSync.notify_one();
-            
-            chunk = DxvkCsChunkRef();
-          }
-          
-          if (m_chunksQueued.size() == 0) {
-            m_condOnAdd.wait(lock, [this] {
-              return (m_chunksQueued.size() != 0)
-                  || (m_stopped.load());
-            });
-          }
-          
-          if (m_chunksQueued.size() != 0) {
-            chunk = std::move(m_chunksQueued.front());
-            m_chunksQueued.pop();
-          }
-        }
-        
-        if (chunk) {
-          m_context->addStatCtr(DxvkStatCounter::CsChunkCount, 1);
-          chunk->executeAll(m_context.ptr());
-        }
+      // NV-DXVK start: lock-free chunk handoff
+      while (m_queue.pop(chunk)) {
+        m_context->addStatCtr(DxvkStatCounter::CsChunkCount, 1);
+        chunk->executeAll(m_context.ptr());
+
+        chunk = DxvkCsChunkRef();
+        m_queue.retire();
       }
+      // NV-DXVK end
     } catch (const DxvkError& e) {
       Logger::err("Exception on CS thread!");
       Logger::err(e.message());
@@ -4,6 +4,9 @@
 #include <condition_variable>
 #include <mutex>
 #include <queue>
+// NV-DXVK start: lock-free chunk handoff
+#include <array>
+// NV-DXVK end
 
 #include "../util/thread.h"
 
@@ -374,6 +377,132 @@ namespace dxvk {
   };
 
 
+  // NV-DXVK start: lock-free chunk handoff
+  /**
+   * \brief Chunk queue
+   *
+   * Ring of chunks ordered by sequence number, with a single
+   * consumer. Chunks are small and frequent, so the consumer
+   * does not take a lock unless it has to park: it spins for
+   * a while before waiting on a condition variable, waiters
+   * do the same, and either side only notifies the other one
+   * if it is actually parked.
+   *
+   * Producers are serialized by a lock of their own, since
+   * D3D9 devices created without D3DCREATE_MULTITHREADED do
+   * not serialize application threads. When the ring is full,
+   * chunks are appended to an unbounded overflow list instead
+   * of blocking the producer on the consumer, and are moved
+   * into the ring as slots become free.
+   *
+   * Only one thread may call \ref pop and \ref retire.
+   */
+  class DxvkCsQueue {
+
+  public:
+
+    constexpr static uint32_t Capacity = 1024;
+
+    DxvkCsQueue();
+    ~DxvkCsQueue();
+
+    DxvkCsQueue             (const DxvkCsQueue&) = delete;
+    DxvkCsQueue& operator = (const DxvkCsQueue&) = delete;
+
+    /**
+     * \brief Adds a chunk to the queue
+     *
+     * Never waits for the consumer.
+     * \param [in] chunk The chunk to add
+     * \returns Sequence number of the chunk
+     */
+    uint64_t push(DxvkCsChunkRef&& chunk);
+
+    /**
+     * \brief Takes the next chunk from the queue
+     *
+     * Blocks until a chunk is available. The chunk must
+     * be passed to \ref retire once it has been executed.
+     * \param [out] chunk The chunk
+     * \returns \c false if the queue was stopped
+     */
+    bool pop(DxvkCsChunkRef& chunk);
+
+    /**
+     * \brief Marks the last popped chunk as executed
+     */
+    void retire();
+
+    /**
+     * \brief Waits for a chunk to be executed
+     * \param [in] seq Sequence number to wait for
+     */
+    void wait(uint64_t seq);
+
+    /**
+     * \brief Stops the queue
+     *
+     * Makes \ref pop return \c false. Chunks
+     * that are still queued are not executed.
+     */
+    void stop();
+
+    uint64_t dispatched() const {
+      return m_chunksDispatched.load(std::memory_order_acquire);
+    }
+
+    uint64_t executed() const {
+      return m_chunksExecuted.load(std::memory_order_acquire);
+    }
+
+  private:
+
+    constexpr static uint32_t MinSpinCount  = 16;
+    constexpr static uint32_t MaxSpinCount  = 1024;
+    constexpr static uint32_t WaitSpinCount = 256;
+
+    alignas(CACHE_LINE_SIZE)
+    std::atomic<uint64_t>       m_chunksDispatched = { 0ull };
+    std::atomic<uint64_t>       m_chunksPublished  = { 0ull };
+    sync::Spinlock              m_pushLock;
+    std::queue<DxvkCsChunkRef>  m_chunksOverflowed;
+
+    alignas(CACHE_LINE_SIZE)
+    std::atomic<uint64_t>       m_chunksExecuted   = { 0ull };
+    uint64_t                    m_chunksPopped     = 0ull;
+    uint32_t                    m_spinCount        = MinSpinCount;
+
+    alignas(CACHE_LINE_SIZE)
+    std::atomic<bool>           m_stopped          = { false };
+    std::atomic<bool>           m_consumerParked   = { false };
+    std::atomic<uint32_t>       m_waitersParked    = { 0u };
+
+    dxvk::mutex                 m_mutex;
+    dxvk::condition_variable    m_condOnAdd;
+    dxvk::condition_variable    m_condOnSync;
+
+    std::array<DxvkCsChunkRef, Capacity> m_chunks;
+
+    bool isReady(uint64_t seq) const {
+      return m_chunksDispatched.load() >= seq;
+    }
+
+    bool isExecuted(uint64_t seq) const {
+      return m_chunksExecuted.load() >= seq;
+    }
+
+    bool isSlotFree(uint64_t seq) const {
+      return seq <= m_chunksExecuted.load(std::memory_order_acquire) + Capacity;
+    }
+
+    void publish(uint64_t seq, DxvkCsChunkRef&& chunk);
+
+    void flushOverflow();
+
+  };
+  // NV-DXVK end
+
+
   /**
    * \brief Command stream thread
    * 
@@ -419,7 +548,9 @@ namespace dxvk {
      * \returns Sequence number of last executed chunk
      */
     uint64_t lastSequenceNumber() const {
-      return m_chunksExecuted.load();
+      // NV-DXVK start: lock-free chunk handoff
+      return m_queue.executed();
+      // NV-DXVK end
     }
 
   private:
@@ -427,14 +558,9 @@ namespace dxvk {
     Rc<DxvkDevice>              m_device;
     Rc<DxvkContext>             m_context;
 
-    std::atomic<uint64_t>       m_chunksDispatched = { 0ull };
-    std::atomic<uint64_t>       m_chunksExecuted   = { 0ull };
-    
-    std::atomic<bool>           m_stopped = { false };
-    dxvk::mutex                 m_mutex;
-    dxvk::condition_variable    m_condOnAdd;
-    dxvk::condition_variable    m_condOnSync;
-    std::queue<DxvkCsChunkRef>  m_chunksQueued;
+    // NV-DXVK start: lock-free chunk handoff
+    DxvkCsQueue                 m_queue;
+    // NV-DXVK end
     dxvk::thread                m_thread;
     
     void threadFunc();
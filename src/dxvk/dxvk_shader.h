@@ -177,6 +177,14 @@ namespace dxvk {
       DxvkDescriptorSlotMapping& mapping,
       VkShaderStageFlagBits stage = VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM) const;
 
+    /**
+     * \brief Resource slot definitions
+     * \returns Resource slots used by the shader
+     */
+    const std::vector<DxvkResourceSlot>& resourceSlots() const {
+      return m_slots;
+    }
+
     /**
      * \brief Tells if the shader has any resource bindings
      */
@@ -229,6 +237,17 @@ namespace dxvk {
       return m_constData;
     }
     
+    /**
+     * \brief Compressed SPIR-V code
+     *
+     * The code as passed to the constructor,
+     * before any binding IDs are remapped.
+     * \returns Compressed code
+     */
+    const SpirvCompressedBuffer& compressedCode() const {
+      return m_code;
+    }
+    
     /**
      * \brief Dumps SPIR-V shader
      * 
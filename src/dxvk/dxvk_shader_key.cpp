@@ -2,9 +2,16 @@
 
 namespace dxvk {
 
+  // NV-DXVK start: hash the empty key once, every state cache entry default-constructs six of them
+  static const Sha1Hash& getNullHash() {
+    static const Sha1Hash s_nullHash = Sha1Hash::compute(nullptr, 0);
+    return s_nullHash;
+  }
+
   DxvkShaderKey::DxvkShaderKey()
   : m_type(0),
-    m_sha1(Sha1Hash::compute(nullptr, 0)) { }
+    m_sha1(getNullHash()) { }
+  // NV-DXVK end
 
 
   std::string DxvkShaderKey::toString() const {
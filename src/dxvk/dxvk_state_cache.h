@@ -30,6 +30,9 @@
 #include <vector>
 
 #include "dxvk_state_cache_types.h"
+// NV-DXVK start: indexed state cache
+#include "dxvk_state_cache_file.h"
+// NV-DXVK end
 // NV-DXVK start: compile rt shaders on shader compilation threads
 #include "dxvk_raytracing.h"
 // NV-DXVK end
@@ -144,6 +147,19 @@ namespace dxvk {
       // NV-DXVK start
       bool isRemixShader = false;
       // NV-DXVK end
+      // NV-DXVK start: indexed state cache
+      uint32_t pipeline = DxvkStateCacheFile::InvalidPipeline;
+      uint64_t sequence = 0;
+
+      // Remix shaders come first, then cached pipelines in the order
+      // the game first used them, anything else in submission order
+      uint64_t priority() const {
+        if (isRemixShader || pipeline == DxvkStateCacheFile::InvalidPipeline)
+          return 0;
+
+        return uint64_t(pipeline) + 1;
+      }
+      // NV-DXVK end
 
       // NV-DXVK start: do not compile same shader multiple times
       size_t hash() const {
@@ -157,21 +173,32 @@ namespace dxvk {
       // NV-DXVK end
     };
 
+    // NV-DXVK start: indexed state cache
+    struct WorkerItemOrder {
+      bool operator () (const WorkerItem& a, const WorkerItem& b) const {
+        // Priority queues pop the greatest item first
+        return a.priority() != b.priority()
+          ? a.priority() > b.priority()
+          : a.sequence > b.sequence;
+      }
+    };
+    // NV-DXVK end
+
     DxvkPipelineManager*              m_pipeManager;
     DxvkRenderPassPool*               m_passManager;
 
-    std::vector<DxvkStateCacheEntry>  m_entries;
+    // NV-DXVK start: indexed state cache
+    DxvkStateCacheFile                m_file;
+    // NV-DXVK end
     std::atomic<bool>                 m_stopThreads = { false };
 
     dxvk::mutex                       m_entryLock;
 
+    // NV-DXVK start: indexed state cache
     std::unordered_multimap<
-      DxvkStateCacheKey, size_t,
-      DxvkHash, DxvkEq> m_entryMap;
-
-    std::unordered_multimap<
-      DxvkShaderKey, DxvkStateCacheKey,
+      DxvkShaderKey, uint32_t,
       DxvkHash, DxvkEq> m_pipelineMap;
+    // NV-DXVK end
     
     std::unordered_map<
       DxvkShaderKey, Rc<DxvkShader>,
@@ -179,7 +206,12 @@ namespace dxvk {
 
     dxvk::mutex                       m_workerLock;
     dxvk::condition_variable          m_workerCond;
-    std::queue<WorkerItem>            m_workerQueue;
+    // NV-DXVK start: indexed state cache
+    std::priority_queue<
+      WorkerItem, std::vector<WorkerItem>,
+      WorkerItemOrder>                m_workerQueue;
+    uint64_t                          m_workerSequence = 0;
+    // NV-DXVK end
     // NV-DXVK start: do not compile same shader multiple times
     std::unordered_set<size_t>        m_workerItemsInFlight;  // stores hashes for work items in the queue
     // NV-DXVK end
@@ -194,59 +226,19 @@ namespace dxvk {
     std::queue<WriterItem>            m_writerQueue;
     dxvk::thread                      m_writerThread;
 
-    DxvkShaderKey getShaderKey(
-      const Rc<DxvkShader>&           shader) const;
-
     bool getShaderByKey(
       const DxvkShaderKey&            key,
             Rc<DxvkShader>&           shader) const;
     
-    void mapPipelineToEntry(
-      const DxvkStateCacheKey&        key,
-            size_t                    entryId);
-    
+    // NV-DXVK start: indexed state cache
     void mapShaderToPipeline(
       const DxvkShaderKey&            shader,
-      const DxvkStateCacheKey&        key);
+            uint32_t                  pipeline);
+    // NV-DXVK end
 
     void compilePipelines(
       const WorkerItem&               item);
 
-    bool readCacheFile();
-
-    bool readCacheHeader(
-            std::istream&             stream,
-            DxvkStateCacheHeader&     header) const;
-
-    bool readCacheEntryV7(
-            uint32_t                  version,
-            std::istream&             stream, 
-            DxvkStateCacheEntry&      entry) const;
-    
-    bool readCacheEntry(
-            uint32_t                  version,
-            std::istream&             stream, 
-            DxvkStateCacheEntry&      entry) const;
-    
-    void writeCacheEntry(
-            std::ostream&             stream, 
-            DxvkStateCacheEntry&      entry) const;
-    
-    bool convertEntryV2(
-            DxvkStateCacheEntryV4&    entry) const;
-    
-    bool convertEntryV4(
-      const DxvkStateCacheEntryV4&    in,
-            DxvkStateCacheEntryV6&    out) const;
-    
-    bool convertEntryV5(
-      const DxvkStateCacheEntryV5&    in,
-            DxvkStateCacheEntryV6&    out) const;
-    
-    bool convertEntryV6(
-      const DxvkStateCacheEntryV6&    in,
-            DxvkStateCacheEntry&      out) const;
-    
     void workerFunc();
 
     void writerFunc();
@@ -255,15 +247,6 @@ namespace dxvk {
     
     std::string getCacheDir() const;
 
-    static uint8_t packImageLayout(
-            VkImageLayout             layout);
-
-    static VkImageLayout unpackImageLayout(
-            uint8_t                   layout);
-
-    static bool validateRenderPassFormat(
-      const DxvkRenderPassFormat&     format);
-
   };
 
 }
@@ -0,0 +1,1146 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "dxvk_state_cache_file.h"
+
+namespace dxvk {
+
+  static const Sha1Hash       g_nullHash      = Sha1Hash::compute(nullptr, 0);
+  static const DxvkShaderKey  g_nullShaderKey = DxvkShaderKey();
+
+  // An unindexed tail larger than this, or than an eighth of the
+  // indexed entries, gets folded into the index on the next launch
+  constexpr size_t MinTailEntriesToReindex = 256;
+
+
+  /**
+   * \brief Packed entry header
+   */
+  struct DxvkStateCacheEntryHeader {
+    uint32_t stageMask : 8;
+    uint32_t entrySize : 24;
+  };
+
+  
+  /**
+   * \brief State cache entry data
+   *
+   * Stores data for a single cache entry and
+   * provides convenience methods to access it.
+   */
+  class DxvkStateCacheEntryData {
+    constexpr static size_t MaxSize = 1024;
+  public:
+
+    size_t size() const {
+      return m_size;
+    }
+
+    const char* data() const {
+      return m_data;
+    }
+
+    Sha1Hash computeHash() const {
+      return Sha1Hash::compute(m_data, m_size);
+    }
+
+    template<typename T>
+    bool read(T& data, uint32_t version) {
+      return read(data);
+    }
+
+    bool read(DxvkBindingMask& data, uint32_t version) {
+      if (version < 9) {
+        DxvkBindingMaskV8 v8;
+
+        if (!read(v8))
+          return false;
+
+        data = v8.convert();
+        return true;
+      }
+
+      return read(data);
+    }
+
+    bool read(DxvkIlBinding& data, uint32_t version) {
+      if (version < 10) {
+        DxvkIlBindingV9 v9;
+
+        if (!read(v9))
+          return false;
+
+        data = v9.convert();
+        return true;
+      }
+
+      return read(data);
+    }
+
+    template<typename T>
+    bool write(const T& data) {
+      if (m_size + sizeof(T) > MaxSize)
+        return false;
+      
+      std::memcpy(&m_data[m_size], &data, sizeof(T));
+      m_size += sizeof(T);
+      return true;
+    }
+
+    bool readFromMemory(const char* data, size_t size) {
+      if (size > MaxSize)
+        return false;
+
+      std::memcpy(m_data, data, size);
+
+      m_size = size;
+      m_read = 0;
+      return true;
+    }
+
+  private:
+
+    size_t m_size = 0;
+    size_t m_read = 0;
+    char   m_data[MaxSize];
+
+    template<typename T>
+    bool read(T& data) {
+      if (m_read + sizeof(T) > m_size)
+        return false;
+
+      std::memcpy(&data, &m_data[m_read], sizeof(T));
+      m_read += sizeof(T);
+      return true;
+    }
+
+  };
+
+
+  template<typename T>
+  bool readCacheEntryTyped(const char* data, size_t size, T& entry) {
+    if (size != sizeof(entry))
+      return false;
+
+    std::memcpy(reinterpret_cast<char*>(&entry), data, size);
+
+    Sha1Hash expectedHash = std::exchange(entry.hash, g_nullHash);
+    Sha1Hash computedHash = Sha1Hash::compute(entry);
+    return expectedHash == computedHash;
+  }
+
+
+  static uint8_t packImageLayout(
+          VkImageLayout             layout) {
+    switch (layout) {
+      case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_STENCIL_ATTACHMENT_OPTIMAL: return 0x80;
+      case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_STENCIL_READ_ONLY_OPTIMAL: return 0x81;
+      default: return uint8_t(layout);
+    }
+  }
+
+
+  static VkImageLayout unpackImageLayout(
+          uint8_t                   layout) {
+    switch (layout) {
+      case 0x80: return VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_STENCIL_ATTACHMENT_OPTIMAL;
+      case 0x81: return VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_STENCIL_READ_ONLY_OPTIMAL;
+      default: return VkImageLayout(layout);
+    }
+  }
+
+
+  static bool validateRenderPassFormat(
+    const DxvkRenderPassFormat&     format) {
+    bool valid = true;
+
+    if (format.depth.format) {
+      valid &= format.depth.layout == VK_IMAGE_LAYOUT_GENERAL
+            || format.depth.layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+            || format.depth.layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+            || format.depth.layout == VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_STENCIL_ATTACHMENT_OPTIMAL
+            || format.depth.layout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_STENCIL_READ_ONLY_OPTIMAL;
+    }
+
+    for (uint32_t i = 0; i < MaxNumRenderTargets && valid; i++) {
+      if (format.color[i].format) {
+        valid &= format.color[i].layout == VK_IMAGE_LAYOUT_GENERAL
+              || format.color[i].layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+      }
+    }
+
+    return valid;
+  }
+
+
+  static bool convertEntryV2(
+          DxvkStateCacheEntryV4&    entry) {
+    // Semantics changed:
+    // v2: rsDepthClampEnable
+    // v3: rsDepthClipEnable
+    entry.gpState.rsDepthClipEnable = !entry.gpState.rsDepthClipEnable;
+
+    // Frontend changed: Depth bias
+    // will typically be disabled
+    entry.gpState.rsDepthBiasEnable = VK_FALSE;
+    return true;
+  }
+
+
+  static bool convertEntryV4(
+    const DxvkStateCacheEntryV4&    in,
+          DxvkStateCacheEntryV6&    out) {
+    out.shaders = in.shaders;
+    out.format  = in.format;
+    out.hash    = in.hash;
+
+    out.cpState.bsBindingMask           = in.cpState.bsBindingMask;
+    out.gpState.bsBindingMask           = in.gpState.bsBindingMask;
+    
+    out.gpState.iaPrimitiveTopology     = in.gpState.iaPrimitiveTopology;
+    out.gpState.iaPrimitiveRestart      = in.gpState.iaPrimitiveRestart;
+    out.gpState.iaPatchVertexCount      = in.gpState.iaPatchVertexCount;
+    
+    out.gpState.ilAttributeCount        = in.gpState.ilAttributeCount;
+    out.gpState.ilBindingCount          = in.gpState.ilBindingCount;
+
+    for (uint32_t i = 0; i < in.gpState.ilAttributeCount; i++)
+      out.gpState.ilAttributes[i]       = in.gpState.ilAttributes[i];
+
+    for (uint32_t i = 0; i < in.gpState.ilBindingCount; i++) {
+      out.gpState.ilBindings[i]         = in.gpState.ilBindings[i];
+      out.gpState.ilDivisors[i]         = in.gpState.ilDivisors[i];
+    }
+    
+    out.gpState.rsDepthClipEnable       = in.gpState.rsDepthClipEnable;
+    out.gpState.rsDepthBiasEnable       = in.gpState.rsDepthBiasEnable;
+    out.gpState.rsPolygonMode           = in.gpState.rsPolygonMode;
+    out.gpState.rsCullMode              = in.gpState.rsCullMode;
+    out.gpState.rsFrontFace             = in.gpState.rsFrontFace;
+    out.gpState.rsViewportCount         = in.gpState.rsViewportCount;
+    out.gpState.rsSampleCount           = in.gpState.rsSampleCount;
+    
+    out.gpState.msSampleCount           = in.gpState.msSampleCount;
+    out.gpState.msSampleMask            = in.gpState.msSampleMask;
+    out.gpState.msEnableAlphaToCoverage = in.gpState.msEnableAlphaToCoverage;
+    
+    out.gpState.dsEnableDepthTest       = in.gpState.dsEnableDepthTest;
+    out.gpState.dsEnableDepthWrite      = in.gpState.dsEnableDepthWrite;
+    out.gpState.dsEnableStencilTest     = in.gpState.dsEnableStencilTest;
+    out.gpState.dsDepthCompareOp        = in.gpState.dsDepthCompareOp;
+    out.gpState.dsStencilOpFront        = in.gpState.dsStencilOpFront;
+    out.gpState.dsStencilOpBack         = in.gpState.dsStencilOpBack;
+    
+    out.gpState.omEnableLogicOp         = in.gpState.omEnableLogicOp;
+    out.gpState.omLogicOp               = in.gpState.omLogicOp;
+
+    for (uint32_t i = 0; i < 8; i++) {
+      out.gpState.omBlendAttachments[i] = in.gpState.omBlendAttachments[i];
+      out.gpState.omComponentMapping[i] = in.gpState.omComponentMapping[i];
+    }
+
+    return true;
+  }
+
+
+  static bool convertEntryV5(
+    const DxvkStateCacheEntryV5&    in,
+          DxvkStateCacheEntryV6&    out) {
+    out.shaders = in.shaders;
+    out.gpState = in.gpState;
+    out.format  = in.format;
+    out.hash    = in.hash;
+
+    out.cpState.bsBindingMask = in.cpState.bsBindingMask;
+    return true;
+  }
+
+
+  static bool convertEntryV6(
+    const DxvkStateCacheEntryV6&    in,
+          DxvkStateCacheEntry&      out) {
+    out.shaders = in.shaders;
+    out.format  = in.format;
+    out.hash    = in.hash;
+
+    if (in.shaders.cs.eq(g_nullShaderKey)) {
+      // Binding mask
+      out.gpState.bsBindingMask = in.gpState.bsBindingMask.convert();
+
+      // Graphics state
+      out.gpState.ia = DxvkIaInfo(
+        in.gpState.iaPrimitiveTopology,
+        in.gpState.iaPrimitiveRestart,
+        in.gpState.iaPatchVertexCount);
+      
+      out.gpState.il = DxvkIlInfo(
+        in.gpState.ilAttributeCount,
+        in.gpState.ilBindingCount);
+      
+      for (uint32_t i = 0; i < in.gpState.ilAttributeCount; i++) {
+        out.gpState.ilAttributes[i] = DxvkIlAttribute(
+          in.gpState.ilAttributes[i].location,
+          in.gpState.ilAttributes[i].binding,
+          in.gpState.ilAttributes[i].format,
+          in.gpState.ilAttributes[i].offset);
+      }
+      
+      for (uint32_t i = 0; i < in.gpState.ilBindingCount; i++) {
+        out.gpState.ilBindings[i] = DxvkIlBinding(
+          in.gpState.ilBindings[i].binding,
+          in.gpState.ilBindings[i].stride,
+          in.gpState.ilBindings[i].inputRate,
+          in.gpState.ilDivisors[i]);
+      }
+      
+      out.gpState.rs = DxvkRsInfo(
+        in.gpState.rsDepthClipEnable,
+        in.gpState.rsDepthBiasEnable,
+        in.gpState.rsPolygonMode,
+        in.gpState.rsCullMode,
+        in.gpState.rsFrontFace,
+        in.gpState.rsViewportCount,
+        in.gpState.rsSampleCount,
+        VK_CONSERVATIVE_RASTERIZATION_MODE_DISABLED_EXT);
+
+      out.gpState.ms = DxvkMsInfo(
+        in.gpState.msSampleCount,
+        in.gpState.msSampleMask,
+        in.gpState.msEnableAlphaToCoverage);
+      
+      out.gpState.ds = DxvkDsInfo(
+        in.gpState.dsEnableDepthTest,
+        in.gpState.dsEnableDepthWrite,
+        in.gpState.dsEnableDepthBoundsTest,
+        in.gpState.dsEnableStencilTest,
+        in.gpState.dsDepthCompareOp);
+      
+      out.gpState.dsFront = DxvkDsStencilOp(in.gpState.dsStencilOpFront);
+      out.gpState.dsBack  = DxvkDsStencilOp(in.gpState.dsStencilOpBack);
+
+      out.gpState.om = DxvkOmInfo(
+        in.gpState.omEnableLogicOp,
+        in.gpState.omLogicOp);
+      
+      for (uint32_t i = 0; i < 8 && i < MaxNumRenderTargets; i++) {
+        out.gpState.omBlend[i] = DxvkOmAttachmentBlend(
+          in.gpState.omBlendAttachments[i].blendEnable,
+          in.gpState.omBlendAttachments[i].srcColorBlendFactor,
+          in.gpState.omBlendAttachments[i].dstColorBlendFactor,
+          in.gpState.omBlendAttachments[i].colorBlendOp,
+          in.gpState.omBlendAttachments[i].srcAlphaBlendFactor,
+          in.gpState.omBlendAttachments[i].dstAlphaBlendFactor,
+          in.gpState.omBlendAttachments[i].alphaBlendOp,
+          in.gpState.omBlendAttachments[i].colorWriteMask);
+        
+        out.gpState.omSwizzle[i] = DxvkOmAttachmentSwizzle(
+          in.gpState.omComponentMapping[i]);
+      }
+
+      // Specialization constants
+      for (uint32_t i = 0; i < 8 && i < MaxNumSpecConstants; i++)
+        out.gpState.sc.specConstants[i] = in.gpState.scSpecConstants[i];
+    } else {
+      // Binding mask
+      out.cpState.bsBindingMask = in.cpState.bsBindingMask.convert();
+
+      for (uint32_t i = 0; i < 8 && i < MaxNumSpecConstants; i++)
+        out.cpState.sc.specConstants[i] = in.cpState.scSpecConstants[i];
+    }
+
+    return true;
+  }
+
+
+  static bool readCacheEntryV7(
+          uint32_t                  version,
+    const char*                     data,
+          size_t                    size,
+          DxvkStateCacheEntry&      entry) {
+    if (version <= 6) {
+      DxvkStateCacheEntryV6 v6;
+
+      if (version <= 4) {
+        DxvkStateCacheEntryV4 v4;
+
+        if (!readCacheEntryTyped(data, size, v4))
+          return false;
+
+        if (version == 2)
+          convertEntryV2(v4);
+
+        if (!convertEntryV4(v4, v6))
+          return false;
+      } else if (version <= 5) {
+        DxvkStateCacheEntryV5 v5;
+
+        if (!readCacheEntryTyped(data, size, v5))
+          return false;
+
+        if (!convertEntryV5(v5, v6))
+          return false;
+      } else {
+        if (!readCacheEntryTyped(data, size, v6))
+          return false;
+      }
+
+      return convertEntryV6(v6, entry);
+    } else {
+      return readCacheEntryTyped(data, size, entry);
+    }
+  }
+
+
+  static bool readCacheEntry(
+          uint32_t                  version,
+    const char*                     entryData,
+          size_t                    entrySize,
+          DxvkStateCacheEntry&      entry) {
+    if (version < 8)
+      return readCacheEntryV7(version, entryData, entrySize, entry);
+
+    // Read entry metadata and actual data
+    DxvkStateCacheEntryHeader header;
+    DxvkStateCacheEntryData data;
+    Sha1Hash hash;
+
+    if (entrySize < sizeof(header) + sizeof(hash))
+      return false;
+
+    std::memcpy(&header, entryData, sizeof(header));
+    std::memcpy(&hash, entryData + sizeof(header), sizeof(hash));
+
+    if (entrySize != sizeof(header) + sizeof(hash) + header.entrySize
+     || !data.readFromMemory(entryData + sizeof(header) + sizeof(hash), header.entrySize))
+      return false;
+
+    // Validate hash, skip entry if invalid
+    if (hash != data.computeHash())
+      return false;
+
+    // Read shader hashes
+    VkShaderStageFlags stageMask = VkShaderStageFlags(header.stageMask);
+    auto keys = &entry.shaders.vs;
+
+    for (uint32_t i = 0; i < 6; i++) {
+      if (stageMask & VkShaderStageFlagBits(1 << i))
+        data.read(keys[i], version);
+      else
+        keys[i] = g_nullShaderKey;
+    }
+
+    if (stageMask & VK_SHADER_STAGE_COMPUTE_BIT) {
+      if (!data.read(entry.cpState.bsBindingMask, version))
+        return false;
+    } else {
+      // Read packed render pass format
+      uint8_t sampleCount = 0;
+      uint8_t imageFormat = 0;
+      uint8_t imageLayout = 0;
+
+      if (!data.read(sampleCount, version)
+       || !data.read(imageFormat, version)
+       || !data.read(imageLayout, version))
+        return false;
+
+      entry.format.sampleCount = VkSampleCountFlagBits(sampleCount);
+      entry.format.depth.format = VkFormat(imageFormat);
+      entry.format.depth.layout = unpackImageLayout(imageLayout);
+
+      for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
+        if (!data.read(imageFormat, version)
+         || !data.read(imageLayout, version))
+          return false;
+
+        entry.format.color[i].format = VkFormat(imageFormat);
+        entry.format.color[i].layout = unpackImageLayout(imageLayout);
+      }
+
+      if (!validateRenderPassFormat(entry.format))
+        return false;
+
+      // Read common pipeline state
+      if (!data.read(entry.gpState.bsBindingMask, version)
+       || !data.read(entry.gpState.ia, version)
+       || !data.read(entry.gpState.il, version)
+       || !data.read(entry.gpState.rs, version)
+       || !data.read(entry.gpState.ms, version)
+       || !data.read(entry.gpState.ds, version)
+       || !data.read(entry.gpState.om, version)
+       || !data.read(entry.gpState.dsFront, version)
+       || !data.read(entry.gpState.dsBack, version))
+        return false;
+
+      if (entry.gpState.il.attributeCount() > MaxNumVertexAttributes
+       || entry.gpState.il.bindingCount() > MaxNumVertexBindings)
+        return false;
+
+      // Read render target swizzles
+      for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
+        if (!data.read(entry.gpState.omSwizzle[i], version))
+          return false;
+      }
+
+      // Read render target blend info
+      for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
+        if (!data.read(entry.gpState.omBlend[i], version))
+          return false;
+      }
+
+      // Read defined vertex attributes
+      for (uint32_t i = 0; i < entry.gpState.il.attributeCount(); i++) {
+        if (!data.read(entry.gpState.ilAttributes[i], version))
+          return false;
+      }
+
+      // Read defined vertex bindings
+      for (uint32_t i = 0; i < entry.gpState.il.bindingCount(); i++) {
+        if (!data.read(entry.gpState.ilBindings[i], version))
+          return false;
+      }
+    }
+
+    // Read non-zero spec constants
+    auto& sc = (stageMask & VK_SHADER_STAGE_COMPUTE_BIT)
+      ? entry.cpState.sc
+      : entry.gpState.sc;
+
+    uint32_t specConstantMask = 0;
+
+    if (!data.read(specConstantMask, version))
+      return false;
+
+    for (uint32_t i = 0; i < MaxNumSpecConstants; i++) {
+      if (specConstantMask & (1 << i)) {
+        if (!data.read(sc.specConstants[i], version))
+          return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  static size_t getCacheEntrySize(
+          uint32_t                  version,
+    const char*                     data,
+          size_t                    size) {
+    size_t entrySize = 0;
+
+    // Struct size hasn't changed between v2 and v4
+    if (version <= 4)
+      entrySize = sizeof(DxvkStateCacheEntryV4);
+    else if (version <= 5)
+      entrySize = sizeof(DxvkStateCacheEntryV5);
+    else if (version <= 6)
+      entrySize = sizeof(DxvkStateCacheEntryV6);
+    else if (version <= 7)
+      entrySize = sizeof(DxvkStateCacheEntry);
+    else {
+      DxvkStateCacheEntryHeader header;
+
+      if (size < sizeof(header) + sizeof(Sha1Hash))
+        return 0;
+
+      std::memcpy(&header, data, sizeof(header));
+      entrySize = sizeof(header) + sizeof(Sha1Hash) + header.entrySize;
+    }
+
+    // Zero means the entry is truncated
+    return entrySize <= size ? entrySize : 0;
+  }
+
+
+  template<typename Fn>
+  static void parallelFor(uint32_t numThreads, size_t count, const Fn& fn) {
+    constexpr size_t BatchSize = 64;
+
+    const size_t numBatches = (count + BatchSize - 1) / BatchSize;
+    numThreads = uint32_t(std::min<size_t>(numThreads, numBatches));
+
+    std::atomic<size_t> nextBatch = { 0u };
+
+    auto work = [&] () {
+      for (size_t batch = nextBatch++; batch < numBatches; batch = nextBatch++) {
+        const size_t end = std::min(count, (batch + 1) * BatchSize);
+
+        for (size_t i = batch * BatchSize; i < end; i++)
+          fn(i);
+      }
+    };
+
+    std::vector<dxvk::thread> threads;
+
+    for (uint32_t i = 1; i < numThreads; i++)
+      threads.emplace_back([&work] () { work(); });
+
+    work();
+
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+
+  DxvkStateCacheFile::DxvkStateCacheFile() {
+
+  }
+
+
+  DxvkStateCacheFile::~DxvkStateCacheFile() {
+    this->unmap();
+  }
+
+
+  bool DxvkStateCacheFile::open(
+    const std::filesystem::path&    path,
+          uint32_t                  numThreads) {
+    this->close();
+
+    m_numThreads = std::max(numThreads, 1u);
+
+    if (!this->map(path)) {
+      Logger::warn("DXVK: No state cache file found");
+      return false;
+    }
+
+    // The header stores the state cache version,
+    // we need to regenerate it if it's outdated
+    DxvkStateCacheHeader newHeader;
+    DxvkStateCacheHeader curHeader;
+
+    if (m_mappedSize < sizeof(curHeader)
+     || std::memcmp(m_mappedData, newHeader.magic, sizeof(newHeader.magic))) {
+      Logger::warn("DXVK: Failed to read state cache header");
+      this->close();
+      return false;
+    }
+
+    std::memcpy(&curHeader, m_mappedData, sizeof(curHeader));
+
+    // Struct size hasn't changed between v2 and v4
+    size_t expectedSize = newHeader.entrySize;
+
+    if (curHeader.version <= 4)
+      expectedSize = sizeof(DxvkStateCacheEntryV4);
+    else if (curHeader.version <= 5)
+      expectedSize = sizeof(DxvkStateCacheEntryV5);
+    else if (curHeader.version <= 6)
+      expectedSize = sizeof(DxvkStateCacheEntryV6);
+    else if (curHeader.version <= 7)
+      expectedSize = sizeof(DxvkStateCacheEntry);
+
+    if (curHeader.entrySize != expectedSize) {
+      Logger::warn("DXVK: State cache entry size changed");
+      this->close();
+      return false;
+    }
+
+    // Discard caches of unsupported versions
+    if (curHeader.version < 2 || curHeader.version > newHeader.version) {
+      Logger::warn("DXVK: State cache version not supported");
+      this->close();
+      return false;
+    }
+
+    bool upToDate = curHeader.version == newHeader.version;
+
+    if (!upToDate) {
+      // Older files have no index, parse and convert
+      // all entries up front so they can be rewritten
+      Logger::warn(str::format("DXVK: Updating state cache version to v", newHeader.version));
+
+      this->readEntries(curHeader.version, sizeof(curHeader));
+
+      Logger::info(str::format(
+        "DXVK: Read ", m_entryCount,
+        " valid state cache entries"));
+    } else if (!this->readIndex(curHeader.version)) {
+      Logger::warn("DXVK: Failed to read state cache index");
+      this->close();
+      return false;
+    }
+
+    if (m_invalidEntryCount.load()) {
+      Logger::warn(str::format(
+        "DXVK: Skipped ", m_invalidEntryCount.load(),
+        " invalid state cache entries"));
+      return false;
+    }
+
+    // Fold the unindexed tail into the index once it grows large
+    return upToDate && m_tailEntryCount <= std::max(MinTailEntriesToReindex, m_entryCount / 8);
+  }
+
+
+  bool DxvkStateCacheFile::write(
+    const std::filesystem::path&    path) {
+    // Everything that is still only mapped must be read
+    // before the file underneath the mapping is replaced
+    parallelFor(m_numThreads, m_pipelines.size(), [this] (size_t i) {
+      if (!m_pipelines[i].parsed)
+        this->parsePipeline(m_pipelines[i]);
+    });
+
+    this->unmap();
+
+    // Lay out entries grouped by pipeline, in first-use order
+    std::vector<DxvkStateCacheIndexEntry> index(m_pipelines.size());
+    std::ostringstream data;
+
+    DxvkStateCacheIndexHeader indexHeader;
+    indexHeader.pipelineCount = uint32_t(m_pipelines.size());
+
+    const uint64_t dataOffset = sizeof(DxvkStateCacheHeader)
+      + sizeof(DxvkStateCacheIndexHeader)
+      + sizeof(DxvkStateCacheIndexEntry) * index.size();
+
+    m_entryCount = 0;
+
+    for (size_t i = 0; i < m_pipelines.size(); i++) {
+      Pipeline& pipeline = m_pipelines[i];
+
+      const uint64_t begin = uint64_t(data.tellp());
+
+      for (const auto& entry : pipeline.entries)
+        writeEntry(data, entry);
+
+      pipeline.entryCount = uint32_t(pipeline.entries.size());
+
+      index[i].shaders    = pipeline.shaders;
+      index[i].offset     = dataOffset + begin;
+      index[i].size       = uint32_t(uint64_t(data.tellp()) - begin);
+      index[i].entryCount = pipeline.entryCount;
+
+      m_entryCount += pipeline.entryCount;
+    }
+
+    const std::string dataString = data.str();
+
+    indexHeader.entryCount = uint32_t(m_entryCount);
+    indexHeader.dataSize   = dataString.size();
+    indexHeader.indexHash  = Sha1Hash::compute(index.data(), sizeof(DxvkStateCacheIndexEntry) * index.size());
+
+    m_tailEntryCount = 0;
+
+    std::ofstream file(path, std::ios_base::binary | std::ios_base::trunc);
+
+    if (!file)
+      return false;
+
+    DxvkStateCacheHeader header;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&indexHeader), sizeof(indexHeader));
+    file.write(reinterpret_cast<const char*>(index.data()), sizeof(DxvkStateCacheIndexEntry) * index.size());
+    file.write(dataString.data(), dataString.size());
+    file.flush();
+    return bool(file);
+  }
+
+
+  void DxvkStateCacheFile::close() {
+    this->unmap();
+
+    m_pipelines.clear();
+    m_pipelineLookup.clear();
+
+    m_entryCount = 0;
+    m_tailEntryCount = 0;
+    m_invalidEntryCount.store(0);
+  }
+
+
+  uint32_t DxvkStateCacheFile::findPipeline(
+    const DxvkStateCacheKey&        key) const {
+    auto entry = m_pipelineLookup.find(key);
+
+    return entry != m_pipelineLookup.end()
+      ? entry->second
+      : InvalidPipeline;
+  }
+
+
+  const std::vector<DxvkStateCacheEntry>& DxvkStateCacheFile::getEntries(
+          uint32_t                  pipeline) {
+    std::lock_guard<dxvk::mutex> lock(m_parseLock);
+
+    Pipeline& entry = m_pipelines[pipeline];
+
+    if (!entry.parsed)
+      this->parsePipeline(entry);
+
+    return entry.entries;
+  }
+
+
+  bool DxvkStateCacheFile::map(
+    const std::filesystem::path&    path) {
+#ifdef _WIN32
+    // Share write access so that the state cache writer
+    // can keep appending to the file while it is mapped
+    HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+      nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (hFile == INVALID_HANDLE_VALUE)
+      return false;
+
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(hFile, &fileSize)) {
+      CloseHandle(hFile);
+      return false;
+    }
+
+    // Empty files can't be mapped, they just fail header validation
+    if (fileSize.QuadPart == 0) {
+      CloseHandle(hFile);
+      return true;
+    }
+
+    HANDLE hMapping = CreateFileMapping(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (!hMapping) {
+      CloseHandle(hFile);
+      return false;
+    }
+
+    LPVOID lpBaseAddress = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!lpBaseAddress) {
+      CloseHandle(hMapping);
+      CloseHandle(hFile);
+      return false;
+    }
+
+    m_hFile = hFile;
+    m_hMapping = hMapping;
+    m_mappedData = reinterpret_cast<const char*>(lpBaseAddress);
+    m_mappedSize = size_t(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+      return false;
+
+    struct stat fileStat;
+
+    if (fstat(fd, &fileStat)) {
+      ::close(fd);
+      return false;
+    }
+
+    // Empty files can't be mapped, they just fail header validation
+    if (fileStat.st_size == 0) {
+      ::close(fd);
+      return true;
+    }
+
+    void* data = mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+      return false;
+
+    m_mappedData = reinterpret_cast<const char*>(data);
+    m_mappedSize = size_t(fileStat.st_size);
+#endif
+    return true;
+  }
+
+
+  void DxvkStateCacheFile::unmap() {
+    if (m_mappedData) {
+#ifdef _WIN32
+      UnmapViewOfFile(m_mappedData);
+      CloseHandle(m_hMapping);
+      CloseHandle(m_hFile);
+#else
+      munmap(const_cast<char*>(m_mappedData), m_mappedSize);
+#endif
+    }
+
+    m_hFile = nullptr;
+    m_hMapping = nullptr;
+    m_mappedData = nullptr;
+    m_mappedSize = 0;
+  }
+
+
+  bool DxvkStateCacheFile::readIndex(
+          uint32_t                  version) {
+    DxvkStateCacheIndexHeader indexHeader;
+    size_t offset = sizeof(DxvkStateCacheHeader);
+
+    if (m_mappedSize - offset < sizeof(indexHeader))
+      return false;
+
+    std::memcpy(&indexHeader, m_mappedData + offset, sizeof(indexHeader));
+    offset += sizeof(indexHeader);
+
+    const size_t indexSize = sizeof(DxvkStateCacheIndexEntry) * indexHeader.pipelineCount;
+
+    if (m_mappedSize - offset < indexSize
+     || indexHeader.indexHash != Sha1Hash::compute(m_mappedData + offset, indexSize))
+      return false;
+
+    const char* indexData = m_mappedData + offset;
+    offset += indexSize;
+
+    if (m_mappedSize - offset < indexHeader.dataSize)
+      return false;
+
+    const uint64_t dataBegin = offset;
+    const uint64_t dataEnd = offset + indexHeader.dataSize;
+
+    m_pipelines.reserve(indexHeader.pipelineCount);
+
+    for (uint32_t i = 0; i < indexHeader.pipelineCount; i++) {
+      DxvkStateCacheIndexEntry indexEntry;
+      std::memcpy(&indexEntry, indexData + sizeof(indexEntry) * i, sizeof(indexEntry));
+
+      if (indexEntry.offset < dataBegin
+       || indexEntry.offset > dataEnd
+       || indexEntry.size > dataEnd - indexEntry.offset
+       || this->findPipeline(indexEntry.shaders) != InvalidPipeline)
+        return false;
+
+      Pipeline& pipeline = m_pipelines[this->addPipeline(indexEntry.shaders)];
+      pipeline.offset     = indexEntry.offset;
+      pipeline.size       = indexEntry.size;
+      pipeline.entryCount = indexEntry.entryCount;
+      pipeline.parsed     = false;
+
+      m_entryCount += indexEntry.entryCount;
+    }
+
+    Logger::info(str::format(
+      "DXVK: Indexed ", m_entryCount,
+      " state cache entries for ", m_pipelines.size(), " pipelines"));
+
+    // Entries appended by the writer since the file was written
+    m_tailEntryCount = this->readEntries(version, dataEnd);
+
+    if (m_tailEntryCount) {
+      Logger::info(str::format(
+        "DXVK: Read ", m_tailEntryCount,
+        " unindexed state cache entries"));
+    }
+
+    return true;
+  }
+
+
+  size_t DxvkStateCacheFile::readEntries(
+          uint32_t                  version,
+          size_t                    offset) {
+    // Finding entry boundaries is cheap, so do that first
+    // and validate and convert the entries in parallel
+    std::vector<std::pair<size_t, size_t>> ranges;
+
+    while (offset < m_mappedSize) {
+      size_t size = getCacheEntrySize(version, m_mappedData + offset, m_mappedSize - offset);
+
+      if (!size)
+        break;
+
+      ranges.push_back({ offset, size });
+      offset += size;
+    }
+
+    std::vector<DxvkStateCacheEntry> entries(ranges.size());
+    std::vector<uint8_t> valid(ranges.size());
+
+    parallelFor(m_numThreads, ranges.size(), [&] (size_t i) {
+      valid[i] = readCacheEntry(version, m_mappedData + ranges[i].first, ranges[i].second, entries[i]);
+    });
+
+    // Add entries in file order to preserve the first-use order of pipelines
+    for (size_t i = 0; i < entries.size(); i++) {
+      if (valid[i])
+        this->addEntry(entries[i]);
+      else
+        m_invalidEntryCount += 1;
+    }
+
+    return ranges.size();
+  }
+
+
+  void DxvkStateCacheFile::parsePipeline(
+          Pipeline&                 pipeline) {
+    const uint32_t version = DxvkStateCacheHeader().version;
+    const char* data = m_mappedData + pipeline.offset;
+
+    pipeline.entries.reserve(pipeline.entryCount);
+
+    size_t offset = 0;
+
+    while (offset < pipeline.size) {
+      size_t size = getCacheEntrySize(version, data + offset, pipeline.size - offset);
+
+      if (!size) {
+        m_invalidEntryCount += 1;
+        break;
+      }
+
+      DxvkStateCacheEntry entry;
+
+      if (readCacheEntry(version, data + offset, size, entry) && entry.shaders.eq(pipeline.shaders))
+        pipeline.entries.push_back(entry);
+      else
+        m_invalidEntryCount += 1;
+
+      offset += size;
+    }
+
+    pipeline.parsed = true;
+  }
+
+
+  uint32_t DxvkStateCacheFile::addPipeline(
+    const DxvkStateCacheKey&        key) {
+    auto result = m_pipelineLookup.insert({ key, uint32_t(m_pipelines.size()) });
+
+    if (result.second) {
+      Pipeline& pipeline = m_pipelines.emplace_back();
+      pipeline.shaders = key;
+      pipeline.parsed = true;
+    }
+
+    return result.first->second;
+  }
+
+
+  void DxvkStateCacheFile::addEntry(
+    const DxvkStateCacheEntry&      entry) {
+    Pipeline& pipeline = m_pipelines[this->addPipeline(entry.shaders)];
+
+    if (!pipeline.parsed)
+      this->parsePipeline(pipeline);
+
+    pipeline.entries.push_back(entry);
+    pipeline.entryCount += 1;
+
+    m_entryCount += 1;
+  }
+
+
+  void DxvkStateCacheFile::writeEntry(
+          std::ostream&             stream,
+    const DxvkStateCacheEntry&      entry) {
+    DxvkStateCacheEntryData data;
+    VkShaderStageFlags stageMask = 0;
+
+    // Write shader hashes
+    auto keys = &entry.shaders.vs;
+
+    for (uint32_t i = 0; i < 6; i++) {
+      if (!keys[i].eq(g_nullShaderKey)) {
+        stageMask |= VkShaderStageFlagBits(1 << i);
+        data.write(keys[i]);
+      }
+    }
+
+    if (stageMask & VK_SHADER_STAGE_COMPUTE_BIT) {
+      // Nothing else here to write out
+      data.write(entry.cpState.bsBindingMask);
+    } else {
+      // Pack render pass format
+      data.write(uint8_t(entry.format.sampleCount));
+      data.write(uint8_t(entry.format.depth.format));
+      data.write(packImageLayout(entry.format.depth.layout));
+
+      for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
+        data.write(uint8_t(entry.format.color[i].format));
+        data.write(packImageLayout(entry.format.color[i].layout));
+      }
+
+      // Write out common pipeline state
+      data.write(entry.gpState.bsBindingMask);
+      data.write(entry.gpState.ia);
+      data.write(entry.gpState.il);
+      data.write(entry.gpState.rs);
+      data.write(entry.gpState.ms);
+      data.write(entry.gpState.ds);
+      data.write(entry.gpState.om);
+      data.write(entry.gpState.dsFront);
+      data.write(entry.gpState.dsBack);
+
+      // Write out render target swizzles and blend info
+      for (uint32_t i = 0; i < MaxNumRenderTargets; i++)
+        data.write(entry.gpState.omSwizzle[i]);
+
+      for (uint32_t i = 0; i < MaxNumRenderTargets; i++)
+        data.write(entry.gpState.omBlend[i]);
+
+      // Write out input layout for defined attributes
+      for (uint32_t i = 0; i < entry.gpState.il.attributeCount(); i++)
+        data.write(entry.gpState.ilAttributes[i]);
+
+      for (uint32_t i = 0; i < entry.gpState.il.bindingCount(); i++)
+        data.write(entry.gpState.ilBindings[i]);
+    }
+
+    // Write out all non-zero spec constants
+    auto& sc = (stageMask & VK_SHADER_STAGE_COMPUTE_BIT)
+      ? entry.cpState.sc
+      : entry.gpState.sc;
+
+    uint32_t specConstantMask = 0;
+
+    for (uint32_t i = 0; i < MaxNumSpecConstants; i++)
+      specConstantMask |= sc.specConstants[i] ? (1 << i) : 0;
+
+    data.write(specConstantMask);
+
+    for (uint32_t i = 0; i < MaxNumSpecConstants; i++) {
+      if (specConstantMask & (1 << i))
+        data.write(sc.specConstants[i]);
+    }
+
+    // General layout: header -> hash -> data
+    DxvkStateCacheEntryHeader header;
+    header.stageMask = uint8_t(stageMask);
+    header.entrySize = data.size();
+
+    Sha1Hash hash = data.computeHash();
+
+    stream.write(reinterpret_cast<char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<char*>(&hash), sizeof(hash));
+    stream.write(data.data(), data.size());
+    stream.flush();
+  }
+
+}
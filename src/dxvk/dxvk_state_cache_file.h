@@ -0,0 +1,215 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "dxvk_state_cache_types.h"
+
+namespace dxvk {
+
+  /**
+   * \brief State cache file
+   *
+   * Reads and writes the on-disk state cache. Current files start with an index
+   * of every pipeline (set of shader keys) in the order the game first used them,
+   * followed by the entries of each pipeline stored contiguously. The file is mapped
+   * read-only and a pipeline's entries are only parsed when they are first requested,
+   * so opening a large cache costs little more than reading its index.
+   *
+   * Entries appended by the state cache writer after the indexed data form an unindexed
+   * tail, which is parsed on open. Older cache versions are parsed and converted in parallel,
+   * after which \ref open reports that the file has to be rewritten in the current format.
+   */
+  class DxvkStateCacheFile {
+
+  public:
+
+    constexpr static uint32_t InvalidPipeline = ~0u;
+
+    DxvkStateCacheFile();
+    ~DxvkStateCacheFile();
+
+    DxvkStateCacheFile(const DxvkStateCacheFile&) = delete;
+    DxvkStateCacheFile& operator = (const DxvkStateCacheFile&) = delete;
+
+    /**
+     * \brief Opens a cache file
+     *
+     * Loads the index of a current file, or all valid entries of an older,
+     * corrupted or fragmented one. Whatever could be loaded stays available
+     * even if this fails.
+     * \param [in] path Cache file path
+     * \param [in] numThreads Threads to use for bulk parsing
+     * \returns \c false if the file is missing or needs to be rewritten
+     */
+    bool open(
+      const std::filesystem::path&    path,
+            uint32_t                  numThreads);
+
+    /**
+     * \brief Writes all loaded entries to a new cache file
+     *
+     * Parses any remaining pipelines, releases the mapping and replaces
+     * the file at the given path with an indexed file in the current format.
+     * \param [in] path Cache file path
+     * \returns \c true on success
+     */
+    bool write(
+      const std::filesystem::path&    path);
+
+    /**
+     * \brief Releases the file mapping and all loaded pipelines
+     */
+    void close();
+
+    /**
+     * \brief Number of pipelines
+     * \returns Pipeline count, in first-use order
+     */
+    uint32_t pipelineCount() const {
+      return uint32_t(m_pipelines.size());
+    }
+
+    /**
+     * \brief Number of entries across all pipelines
+     * \returns Entry count
+     */
+    size_t entryCount() const {
+      return m_entryCount;
+    }
+
+    /**
+     * \brief Number of entries in the unindexed tail
+     * \returns Entry count
+     */
+    size_t tailEntryCount() const {
+      return m_tailEntryCount;
+    }
+
+    /**
+     * \brief Number of entries that failed validation
+     *
+     * Includes entries skipped while parsing pipelines on demand.
+     * \returns Invalid entry count
+     */
+    size_t invalidEntryCount() const {
+      return m_invalidEntryCount.load();
+    }
+
+    /**
+     * \brief Shader keys of a pipeline
+     * \param [in] pipeline Pipeline index
+     * \returns Shader keys
+     */
+    const DxvkStateCacheKey& getPipelineKey(uint32_t pipeline) const {
+      return m_pipelines[pipeline].shaders;
+    }
+
+    /**
+     * \brief Looks up a pipeline by its shader keys
+     * \param [in] key Shader keys
+     * \returns Pipeline index, or \c InvalidPipeline
+     */
+    uint32_t findPipeline(
+      const DxvkStateCacheKey&        key) const;
+
+    /**
+     * \brief Retrieves the entries of a pipeline
+     *
+     * Parses the entries on first use. Safe to call from multiple
+     * threads; the returned list does not change afterwards.
+     * \param [in] pipeline Pipeline index
+     * \returns Entries of the pipeline
+     */
+    const std::vector<DxvkStateCacheEntry>& getEntries(
+            uint32_t                  pipeline);
+
+    /**
+     * \brief Appends an entry to a cache file
+     *
+     * Entries are appended to the unindexed tail, and are
+     * moved into the index the next time the file is rewritten.
+     * \param [in] stream Output stream
+     * \param [in] entry The entry to write
+     */
+    static void writeEntry(
+            std::ostream&             stream,
+      const DxvkStateCacheEntry&      entry);
+
+  private:
+
+    struct Pipeline {
+      DxvkStateCacheKey                 shaders;
+      uint64_t                          offset      = 0;
+      uint32_t                          size        = 0;
+      uint32_t                          entryCount  = 0;
+      bool                              parsed      = false;
+      std::vector<DxvkStateCacheEntry>  entries;
+    };
+
+    std::vector<Pipeline>             m_pipelines;
+
+    std::unordered_map<
+      DxvkStateCacheKey, uint32_t,
+      DxvkHash, DxvkEq>               m_pipelineLookup;
+
+    dxvk::mutex                       m_parseLock;
+
+    size_t                            m_entryCount = 0;
+    size_t                            m_tailEntryCount = 0;
+    std::atomic<size_t>               m_invalidEntryCount = { 0u };
+    uint32_t                          m_numThreads = 1;
+
+    void*                             m_hFile = nullptr;
+    void*                             m_hMapping = nullptr;
+    const char*                       m_mappedData = nullptr;
+    size_t                            m_mappedSize = 0;
+
+    bool map(
+      const std::filesystem::path&    path);
+
+    void unmap();
+
+    bool readIndex(
+            uint32_t                  version);
+
+    size_t readEntries(
+            uint32_t                  version,
+            size_t                    offset);
+
+    void parsePipeline(
+            Pipeline&                 pipeline);
+
+    uint32_t addPipeline(
+      const DxvkStateCacheKey&        key);
+
+    void addEntry(
+      const DxvkStateCacheEntry&      entry);
+
+  };
+
+}
@@ -52,12 +52,49 @@ namespace dxvk {
    */
   struct DxvkStateCacheHeader {
     char     magic[4]   = { 'D', 'X', 'V', 'K' };
-    uint32_t version    = 12;
+    // NV-DXVK start: indexed state cache
+    uint32_t version    = 13;
+    // NV-DXVK end
     uint32_t entrySize  = 0; /* no longer meaningful */
   };
 
   static_assert(sizeof(DxvkStateCacheHeader) == 12);
 
+  // NV-DXVK start: indexed state cache
+  /**
+   * \brief State cache index header
+   *
+   * Follows the file header since version 13. The index
+   * entries come next, then the entry data, grouped by
+   * pipeline. Anything past the data is an unindexed
+   * tail of entries appended after the file was written.
+   */
+  struct DxvkStateCacheIndexHeader {
+    uint32_t pipelineCount  = 0;
+    uint32_t entryCount     = 0;
+    uint64_t dataSize       = 0;
+    Sha1Hash indexHash;     /* hash of all index entries */
+    uint32_t reserved       = 0;
+  };
+
+  static_assert(sizeof(DxvkStateCacheIndexHeader) == 40);
+
+  /**
+   * \brief State cache index entry
+   *
+   * Locates the entries of one pipeline. Offsets are
+   * relative to the start of the file.
+   */
+  struct DxvkStateCacheIndexEntry {
+    DxvkStateCacheKey shaders;
+    uint64_t          offset      = 0;
+    uint32_t          size        = 0;
+    uint32_t          entryCount  = 0;
+  };
+
+  static_assert(sizeof(DxvkStateCacheIndexEntry) == 160);
+  // NV-DXVK end
+
 
   class DxvkBindingMaskV8 : DxvkBindingSet<128> {
 
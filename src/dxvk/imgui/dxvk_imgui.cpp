@@ -57,6 +57,7 @@
 #include "../util/util_math.h"
 #include "../util/util_globaltime.h"
 #include "rtx_render/rtx_opacity_micromap_manager.h"
+#include "rtx_render/rtx_asset_mip_cache.h"
 #include "rtx_render/rtx_bridge_message_channel.h"
 #include "dxvk_imgui_about.h"
 #include "dxvk_imgui_splash.h"
@@ -4347,6 +4348,17 @@ namespace dxvk {
       if (RemixGui::CollapsingHeader("Advanced##texstream", collapsingHeaderClosedFlags)) {
         ImGui::Indent();
         ImGui::Text("Streamed Texture VRAM usage: %.1f GB", float(g_streamedTextures_usedBytes) / 1024.F / 1024.F / 1024.F);
+        {
+          const AssetMipCache::Stats mipCacheStats = AssetMipCache::get().getStats();
+          const uint64_t lookups = mipCacheStats.hits + mipCacheStats.misses;
+          ImGui::Text("Mip Cache: %.1f / %.1f MB, %.1f%% hits (%llu lookups), %llu prefetched, %llu evicted",
+                      float(mipCacheStats.residentBytes) / 1024.F / 1024.F,
+                      float(mipCacheStats.budgetBytes) / 1024.F / 1024.F,
+                      lookups > 0 ? 100.F * float(mipCacheStats.hits) / float(lookups) : 0.F,
+                      (unsigned long long) lookups,
+                      (unsigned long long) mipCacheStats.prefetches,
+                      (unsigned long long) mipCacheStats.evictions);
+        }
         ImGui::Dummy({ 0, 2 });
         RemixGui::Separator();
         ImGui::Dummy({ 0, 2 });
@@ -53,11 +53,8 @@ void FogHashChecker::updateRange(const Rc<DxvkContext>& context, const size_t st
   // Get the scene manager from context
   RtxContext* rtxContext = dynamic_cast<RtxContext*>(context.ptr());
   assert(rtxContext != nullptr && "Components must be run within a valid RtxContext.");
-  const SceneManager& sceneManager = rtxContext->getSceneManager();
-  
   // Get the current fog state hash
-  const FogState& currentFogState = sceneManager.getFogState();
-  const XXH64_hash_t currentFogHash = currentFogState.getHash();
+  const XXH64_hash_t currentFogHash = rtxContext->getSceneManager().getFrameHashUsage().fog;
   
   for (size_t i = start; i < end; i++) {
     const uint64_t targetHash = m_fogHash[i];
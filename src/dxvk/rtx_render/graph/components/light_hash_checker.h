@@ -54,17 +54,13 @@ void LightHashChecker::updateRange(const Rc<DxvkContext>& context, const size_t
   // Get the scene manager from context
   RtxContext* rtxContext = dynamic_cast<RtxContext*>(context.ptr());
   assert(rtxContext != nullptr && "Components must be run within a valid RtxContext.");
-  const SceneManager& sceneManager = rtxContext->getSceneManager();
-  const LightManager& lightManager = sceneManager.getLightManager();
-  
-  // Get the light table
-  const std::unordered_map<XXH64_hash_t, RtLight>& lightTable = lightManager.getLightTable();
+  const HashUsageSnapshot& lightUsage = rtxContext->getSceneManager().getFrameHashUsage().lights;
   
   for (size_t i = start; i < end; i++) {
     const uint64_t targetHash = m_lightHash[i];
     
-    // Check if the light hash exists in the light table
-    bool isUsed = lightTable.find(targetHash) != lightTable.end();
+    // Check if the light hash exists in the current frame's light table
+    bool isUsed = lightUsage.isUsed(targetHash);
     
     m_isUsed[i] = isUsed;
   }
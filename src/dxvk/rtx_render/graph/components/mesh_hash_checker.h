@@ -54,13 +54,13 @@ void MeshHashChecker::updateRange(const Rc<DxvkContext>& context, const size_t s
   // Get the scene manager from context
   RtxContext* rtxContext = dynamic_cast<RtxContext*>(context.ptr());
   assert(rtxContext != nullptr && "Components must be run within a valid RtxContext.");
-  const SceneManager& sceneManager = rtxContext->getSceneManager();
+  const HashUsageSnapshot& meshUsage = rtxContext->getSceneManager().getFrameHashUsage().meshes;
   
   for (size_t i = start; i < end; i++) {
     const uint64_t targetHash = m_meshHash[i];
     
     // Check if the mesh hash was used in the current frame
-    uint32_t count = sceneManager.getMeshHashUsageCount(targetHash);
+    uint32_t count = meshUsage.getUsageCount(targetHash);
     bool isUsed = count > 0;
     
     m_isUsed[i] = isUsed;
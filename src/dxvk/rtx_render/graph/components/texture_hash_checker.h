@@ -53,13 +53,13 @@ REMIX_COMPONENT( \
 void TextureHashChecker::updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
   // Get the scene manager from context
   RtxContext* rtxContext = static_cast<RtxContext*>(context.ptr());
-  const SceneManager& sceneManager = rtxContext->getSceneManager();
+  const HashUsageSnapshot& materialUsage = rtxContext->getSceneManager().getFrameHashUsage().replacementMaterials;
   
   for (size_t i = start; i < end; i++) {
     const uint64_t targetHash = m_textureHash[i];
     
     // Check if the texture hash was used for material replacement this frame
-    uint32_t count = sceneManager.getReplacementMaterialHashUsageCount(targetHash);
+    uint32_t count = materialUsage.getUsageCount(targetHash);
     bool isUsed = count > 0;
     
     m_isUsed[i] = isUsed;
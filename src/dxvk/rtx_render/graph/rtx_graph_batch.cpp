@@ -31,6 +31,9 @@
 
 #include "rtx_component_list.h"
 
+#include <array>
+#include <mutex>
+
 namespace dxvk {
 
 // Force instantiation of all flexible components at static initialization time
@@ -93,18 +96,94 @@ namespace {
     // during instance creation.
     std::get<std::vector<T>>(properties).push_back(value);
   }
+
+  struct PropertyPoolStorage {
+    std::mutex mutex;
+    std::array<std::vector<RtComponentPropertyVector>, std::variant_size_v<RtComponentPropertyVector>> vectors;
+  };
+
+  PropertyPoolStorage& getPropertyPoolStorage() {
+    static PropertyPoolStorage s_storage;
+    return s_storage;
+  }
+
+  size_t alignToChunk(size_t numInstances) {
+    return (numInstances + RtGraphBatch::kInstanceChunkSize - 1) / RtGraphBatch::kInstanceChunkSize * RtGraphBatch::kInstanceChunkSize;
+  }
+}
+
+RtComponentPropertyVector RtGraphPropertyPool::acquire(RtComponentPropertyType type) {
+  // Constructing an empty vector doesn't allocate, so this is only used to find the variant index.
+  RtComponentPropertyVector properties = propertyVectorFromType(type);
+
+  PropertyPoolStorage& storage = getPropertyPoolStorage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  std::vector<RtComponentPropertyVector>& pooled = storage.vectors[properties.index()];
+  if (!pooled.empty()) {
+    properties = std::move(pooled.back());
+    pooled.pop_back();
+  }
+  return properties;
+}
+
+void RtGraphPropertyPool::release(RtComponentPropertyVector&& properties) {
+  const size_t capacity = std::visit([](auto& vec) {
+    vec.clear();
+    return vec.capacity();
+  }, properties);
+  if (capacity == 0 || capacity > kMaxPooledCapacity) {
+    return;
+  }
+
+  PropertyPoolStorage& storage = getPropertyPoolStorage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  std::vector<RtComponentPropertyVector>& pooled = storage.vectors[properties.index()];
+  if (pooled.size() < kMaxPooledVectorsPerType) {
+    pooled.push_back(std::move(properties));
+  }
 }
 
-void RtGraphBatch::Initialize(const RtGraphTopology& topology) {
+void RtGraphPropertyPool::clear() {
+  PropertyPoolStorage& storage = getPropertyPoolStorage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  for (auto& pooled : storage.vectors) {
+    pooled.clear();
+    pooled.shrink_to_fit();
+  }
+}
+
+size_t RtGraphPropertyPool::getNumPooledVectors() {
+  PropertyPoolStorage& storage = getPropertyPoolStorage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  size_t count = 0;
+  for (const auto& pooled : storage.vectors) {
+    count += pooled.size();
+  }
+  return count;
+}
+
+RtGraphBatch::~RtGraphBatch() {
+  // Component batches hold references into m_properties, so they need to go first.
+  m_componentBatches.clear();
+  for (auto& prop : m_properties) {
+    RtGraphPropertyPool::release(std::move(prop));
+  }
+}
+
+void RtGraphBatch::Initialize(const RtGraphTopology& topology, size_t expectedInstances) {
   // NOTE: need to do this separate from the constructor, because the address of `this` changes when it's moved.
   ScopedCpuProfileZone();
 
   // Store pointer to topology for GUI access (safe because topology lives in stable asset storage)
   m_topology = &topology;
 
+  m_properties.reserve(topology.propertyTypes.size());
   for (size_t i = 0; i < topology.propertyTypes.size(); i++) {
-    m_properties.push_back(propertyVectorFromType(topology.propertyTypes[i]));
+    m_properties.push_back(RtGraphPropertyPool::acquire(topology.propertyTypes[i]));
   }
+  // Pooled vectors may come with different capacities, so bring them all up to the same chunk-aligned size.
+  m_instanceCapacity = 0;
+  reserveInstances(std::max(expectedInstances, kInstanceChunkSize));
   // Create a RtComponentBatch for each component in the topology, which will keep references to the 
   // property vectors it cares about.
   for (size_t i = 0; i < topology.componentSpecs.size(); i++) {
@@ -134,6 +213,12 @@ bool RtGraphBatch::addInstance(Rc<DxvkContext> context, const RtGraphState& init
     return false;
   }
 
+  if (m_graphInstances.size() >= m_instanceCapacity) {
+    // Only reached when the batch outgrows the size it was created with.  Grow geometrically, but always by
+    // whole chunks, so that the property vectors are reallocated together rather than each one independently.
+    reserveInstances(std::max(m_instanceCapacity * 2, m_graphInstances.size() + 1));
+  }
+
   graphInstance->setBatchIndex(m_graphInstances.size());
   m_graphInstances.push_back(graphInstance);
 
@@ -158,6 +243,8 @@ bool RtGraphBatch::addInstance(Rc<DxvkContext> context, const RtGraphState& init
   }
 
   // Update the new graph once, to fill in the initial values.
+  // Note: this runs mid-frame, before the frame's hash usage snapshot is built, so hash checkers report nothing as
+  // used here.  The graph update at the end of the frame evaluates the new instance against the complete snapshot.
   // for components with an initialize function, update the earlier components first to ensure the inputs are accurate, then initialize.
   const size_t newInstanceIndex = m_graphInstances.size() - 1;
   for (auto& batch : m_componentBatches) {
@@ -209,13 +296,21 @@ void RtGraphBatch::removeInstance(GraphInstance* graphInstance) {
 }
 
 void RtGraphBatch::increaseReserve(size_t numInstances) {
-  size_t newSize = m_graphInstances.size() + numInstances;
-  m_graphInstances.reserve(newSize);
+  reserveInstances(m_graphInstances.size() + numInstances);
+}
+
+void RtGraphBatch::reserveInstances(size_t numInstances) {
+  if (numInstances <= m_instanceCapacity) {
+    return;
+  }
+  const size_t newCapacity = alignToChunk(numInstances);
+  m_graphInstances.reserve(newCapacity);
   for (auto& prop : m_properties) {
     // std::visit is needed because m_properties are variants.  
     // This simply resolves them to an std::vector<T>.
-    std::visit([newSize](auto& vec) { vec.reserve(newSize); }, prop);
+    std::visit([newCapacity](auto& vec) { vec.reserve(newCapacity); }, prop);
   }
+  m_instanceCapacity = newCapacity;
 }
 
 void RtGraphBatch::update(Rc<DxvkContext> context) {
@@ -224,8 +319,14 @@ void RtGraphBatch::update(Rc<DxvkContext> context) {
 
 void RtGraphBatch::updateRange(Rc<DxvkContext> context, size_t start, size_t end) {
   ScopedCpuProfileZone();
-  for (auto& componentBatch : m_componentBatches) {
-    componentBatch->updateRange(context, start, end);
+  // Run the whole graph over one chunk of instances at a time.  Components only read properties of the same
+  // instance, so this gives the same results as running each component over the full range, but the outputs
+  // of earlier components are still in cache when later components read them.
+  for (size_t chunkStart = start; chunkStart < end; chunkStart += kInstanceChunkSize) {
+    const size_t chunkEnd = std::min(chunkStart + kInstanceChunkSize, end);
+    for (auto& componentBatch : m_componentBatches) {
+      componentBatch->updateRange(context, chunkStart, chunkEnd);
+    }
   }
 }
 
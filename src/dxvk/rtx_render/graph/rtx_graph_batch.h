@@ -29,10 +29,35 @@
 
 namespace dxvk {
 
+// Recycles property vectors (and their allocations) between graph batches.  Batches are destroyed when
+// their last instance is removed, so replacements streaming in and out as the camera moves would otherwise
+// reallocate every property vector of the graph each time.
+class RtGraphPropertyPool {
+public:
+  // Upper bounds on how much memory the pool can hold on to.
+  static constexpr size_t kMaxPooledVectorsPerType = 256;
+  static constexpr size_t kMaxPooledCapacity = 4096;
+
+  // Returns an empty property vector of the given type, reusing a pooled allocation when possible.
+  static RtComponentPropertyVector acquire(RtComponentPropertyType type);
+
+  // Returns a property vector to the pool.  The contents are cleared, but the capacity is retained.
+  static void release(RtComponentPropertyVector&& properties);
+
+  static void clear();
+
+  static size_t getNumPooledVectors();
+};
+
 class RtGraphBatch {
 public:
+  // Instances are allocated and updated in chunks of this many instances.  Property storage grows one
+  // chunk-aligned step at a time for all properties together, and `update` runs every component over one
+  // chunk before moving on to the next, so a chunk's properties stay in cache while the graph is evaluated.
+  static constexpr size_t kInstanceChunkSize = 64;
+
   RtGraphBatch() = default;
-  ~RtGraphBatch() = default;
+  ~RtGraphBatch();
 
   // Prevent copying to avoid resource management issues
   RtGraphBatch(const RtGraphBatch&) = delete;
@@ -42,7 +67,9 @@ public:
   RtGraphBatch(RtGraphBatch&&) = default;
   RtGraphBatch& operator=(RtGraphBatch&&) = default;
 
-  void Initialize(const RtGraphTopology& topology);
+  // expectedInstances pre-sizes the property storage, so that a batch whose size is known up front
+  // (e.g. one being recreated) doesn't have to grow as its instances are added.
+  void Initialize(const RtGraphTopology& topology, size_t expectedInstances = 0);
   
   bool addInstance(Rc<DxvkContext> context, const RtGraphState& graphState, GraphInstance* replacementInstance);
 
@@ -62,6 +89,10 @@ public:
     return m_graphInstances.size();
   }
 
+  size_t getInstanceCapacity() const {
+    return m_instanceCapacity;
+  }
+
   const std::vector<GraphInstance*>& getInstances() const {
     return m_graphInstances;
   }
@@ -128,6 +159,10 @@ private:
   std::vector<RtComponentPropertyVector> m_properties;
 
   std::vector<GraphInstance*> m_graphInstances;
+  // Number of instances the property vectors currently have room for.  Always a multiple of kInstanceChunkSize.
+  size_t m_instanceCapacity = 0;
+
+  void reserveInstances(size_t numInstances);
 
   void updateRange(Rc<DxvkContext> context, size_t start, size_t end);
 
@@ -67,8 +67,10 @@ public:
     }
     auto iter = m_batches.find(graphState.topology.graphHash);
     if (iter == m_batches.end()) {
+      auto lastCapacity = m_lastBatchCapacities.find(graphState.topology.graphHash);
+      const size_t expectedInstances = lastCapacity != m_lastBatchCapacities.end() ? lastCapacity->second : 0;
       iter = m_batches.emplace(graphState.topology.graphHash, RtGraphBatch()).first;
-      iter->second.Initialize(graphState.topology);
+      iter->second.Initialize(graphState.topology, expectedInstances);
     }
     uint64_t instanceId = m_nextInstanceId++;
     auto pair = m_graphInstances.try_emplace(instanceId, this, graphState.topology.graphHash, 0, instanceId, graphState);
@@ -95,6 +97,7 @@ public:
     }
     batchIter->second.removeInstance(&iter->second);
     if (batchIter->second.getNumInstances() == 0) {
+      m_lastBatchCapacities[batchIter->first] = batchIter->second.getInstanceCapacity();
       m_batches.erase(batchIter);
     }
     m_graphInstances.erase(instanceId);
@@ -113,6 +116,9 @@ public:
   }
 
   void clear() {
+    for (const auto& [graphHash, batch] : m_batches) {
+      m_lastBatchCapacities[graphHash] = batch.getInstanceCapacity();
+    }
     m_batches.clear();
     m_graphInstances.clear();
   }
@@ -172,6 +178,10 @@ private:
 
   fast_unordered_cache<RtGraphBatch> m_batches;
 
+  // Instance capacity of each graph's batch when it was last destroyed.  Batches are destroyed and recreated
+  // whenever replacements are reloaded, so this lets the new batch start out at its final size.
+  fast_unordered_cache<size_t> m_lastBatchCapacities;
+
   std::unordered_map<uint64_t, GraphInstance> m_graphInstances;
 
   uint64_t m_nextInstanceId = 1;
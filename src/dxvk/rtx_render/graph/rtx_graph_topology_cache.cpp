@@ -0,0 +1,496 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "rtx_graph_topology_cache.h"
+#include "dxvk_scoped_annotation.h"
+#include "../util/log/log.h"
+#include "../util/util_string.h"
+#include "../util/util_filesys.h"
+
+#include <fstream>
+
+namespace dxvk {
+
+namespace {
+  constexpr uint32_t kCacheMagic = 0x43544752; // 'RGTC'
+  // Bump this whenever the layout below, or the meaning of any serialized value, changes.
+  constexpr uint32_t kCacheVersion = 1;
+
+  // Sanity limit for any serialized count, to reject corrupted files before allocating.
+  constexpr uint32_t kMaxSerializedCount = 1 << 24;
+
+  template<typename T>
+  void write(std::ostream& stream, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template<typename T>
+  bool read(std::istream& stream, T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return !!stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+  }
+
+  void writeString(std::ostream& stream, const std::string& value) {
+    write(stream, static_cast<uint32_t>(value.size()));
+    stream.write(value.data(), value.size());
+  }
+
+  bool readString(std::istream& stream, std::string& value) {
+    uint32_t size;
+    if (!read(stream, size) || size > kMaxSerializedCount) {
+      return false;
+    }
+    value.resize(size);
+    return !!stream.read(value.data(), size);
+  }
+
+  bool readCount(std::istream& stream, uint32_t& count) {
+    return read(stream, count) && count <= kMaxSerializedCount;
+  }
+
+  template<typename VectorType, size_t N>
+  void writeVector(std::ostream& stream, const VectorType& value) {
+    for (size_t i = 0; i < N; i++) {
+      write(stream, value[i]);
+    }
+  }
+
+  template<typename VectorType, size_t N>
+  bool readVector(std::istream& stream, VectorType& value) {
+    for (size_t i = 0; i < N; i++) {
+      if (!read(stream, value[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void writeValue(std::ostream& stream, const RtComponentPropertyValue& value) {
+    write(stream, static_cast<uint8_t>(value.index()));
+    std::visit([&stream](auto&& arg) {
+      using T = std::decay_t<decltype(arg)>;
+      if constexpr (std::is_same_v<T, Vector2>) {
+        writeVector<Vector2, 2>(stream, arg);
+      } else if constexpr (std::is_same_v<T, Vector3>) {
+        writeVector<Vector3, 3>(stream, arg);
+      } else if constexpr (std::is_same_v<T, Vector4>) {
+        writeVector<Vector4, 4>(stream, arg);
+      } else if constexpr (std::is_same_v<T, PrimTarget>) {
+        write(stream, arg.replacementIndex);
+        write(stream, arg.instanceId);
+      } else if constexpr (std::is_same_v<T, std::string>) {
+        writeString(stream, arg);
+      } else {
+        write(stream, arg);
+      }
+    }, value);
+  }
+
+  template<size_t I = 0>
+  bool readValueAlternative(std::istream& stream, size_t index, RtComponentPropertyValue& value) {
+    if constexpr (I < std::variant_size_v<RtComponentPropertyValue>) {
+      if (index != I) {
+        return readValueAlternative<I + 1>(stream, index, value);
+      }
+      using T = std::variant_alternative_t<I, RtComponentPropertyValue>;
+      T result {};
+      bool success;
+      if constexpr (std::is_same_v<T, Vector2>) {
+        success = readVector<Vector2, 2>(stream, result);
+      } else if constexpr (std::is_same_v<T, Vector3>) {
+        success = readVector<Vector3, 3>(stream, result);
+      } else if constexpr (std::is_same_v<T, Vector4>) {
+        success = readVector<Vector4, 4>(stream, result);
+      } else if constexpr (std::is_same_v<T, PrimTarget>) {
+        success = read(stream, result.replacementIndex) && read(stream, result.instanceId);
+      } else if constexpr (std::is_same_v<T, std::string>) {
+        success = readString(stream, result);
+      } else {
+        success = read(stream, result);
+      }
+      value = RtComponentPropertyValue(std::in_place_index<I>, std::move(result));
+      return success;
+    } else {
+      return false;
+    }
+  }
+
+  bool readValue(std::istream& stream, RtComponentPropertyValue& value) {
+    uint8_t index;
+    if (!read(stream, index)) {
+      return false;
+    }
+    return readValueAlternative(stream, index, value);
+  }
+
+  bool readPropertyType(std::istream& stream, RtComponentPropertyType& type) {
+    uint32_t raw;
+    if (!read(stream, raw) || raw > static_cast<uint32_t>(RtComponentPropertyType::NumberOrVector)) {
+      return false;
+    }
+    type = static_cast<RtComponentPropertyType>(raw);
+    return true;
+  }
+
+  void writeTopology(std::ostream& stream, const RtCompiledGraphTopology& topology) {
+    write(stream, topology.graphHash);
+    write(stream, static_cast<uint32_t>(topology.propertyTypes.size()));
+    for (const RtComponentPropertyType type : topology.propertyTypes) {
+      write(stream, static_cast<uint32_t>(type));
+    }
+    write(stream, static_cast<uint32_t>(topology.components.size()));
+    for (const RtCompiledGraphComponent& component : topology.components) {
+      write(stream, component.componentType);
+      write(stream, static_cast<int32_t>(component.version));
+      write(stream, static_cast<uint32_t>(component.variantPropertyTypes.size()));
+      for (const RtComponentPropertyType type : component.variantPropertyTypes) {
+        write(stream, static_cast<uint32_t>(type));
+      }
+      write(stream, static_cast<uint32_t>(component.propertyIndices.size()));
+      for (const uint32_t index : component.propertyIndices) {
+        write(stream, index);
+      }
+    }
+    write(stream, static_cast<uint32_t>(topology.propertyPaths.size()));
+    for (const auto& [path, index] : topology.propertyPaths) {
+      writeString(stream, path);
+      write(stream, index);
+    }
+  }
+
+  bool readTopology(std::istream& stream, RtCompiledGraphTopology& topology) {
+    uint32_t count;
+    if (!read(stream, topology.graphHash) || !readCount(stream, count)) {
+      return false;
+    }
+    topology.propertyTypes.resize(count);
+    for (RtComponentPropertyType& type : topology.propertyTypes) {
+      if (!readPropertyType(stream, type)) {
+        return false;
+      }
+    }
+    if (!readCount(stream, count)) {
+      return false;
+    }
+    topology.components.resize(count);
+    for (RtCompiledGraphComponent& component : topology.components) {
+      int32_t version;
+      if (!read(stream, component.componentType) || !read(stream, version) || !readCount(stream, count)) {
+        return false;
+      }
+      component.version = version;
+      component.variantPropertyTypes.resize(count);
+      for (RtComponentPropertyType& type : component.variantPropertyTypes) {
+        if (!readPropertyType(stream, type)) {
+          return false;
+        }
+      }
+      if (!readCount(stream, count)) {
+        return false;
+      }
+      component.propertyIndices.resize(count);
+      for (uint32_t& index : component.propertyIndices) {
+        if (!read(stream, index) || index >= topology.propertyTypes.size()) {
+          return false;
+        }
+      }
+    }
+    if (!readCount(stream, count)) {
+      return false;
+    }
+    topology.propertyPaths.resize(count);
+    for (auto& [path, index] : topology.propertyPaths) {
+      if (!readString(stream, path) || !read(stream, index) || index >= topology.propertyTypes.size()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void writeTemplate(std::ostream& stream, const RtCompiledGraphTemplate& graphTemplate) {
+    write(stream, graphTemplate.graphHash);
+    write(stream, static_cast<uint32_t>(graphTemplate.initialValues.size()));
+    for (const RtComponentPropertyValue& value : graphTemplate.initialValues) {
+      writeValue(stream, value);
+    }
+    write(stream, static_cast<uint32_t>(graphTemplate.primTargetPaths.size()));
+    for (const auto& [index, path] : graphTemplate.primTargetPaths) {
+      write(stream, index);
+      writeString(stream, path);
+    }
+  }
+
+  bool readTemplate(std::istream& stream, RtCompiledGraphTemplate& graphTemplate) {
+    uint32_t count;
+    if (!read(stream, graphTemplate.graphHash) || !readCount(stream, count)) {
+      return false;
+    }
+    graphTemplate.initialValues.resize(count);
+    for (RtComponentPropertyValue& value : graphTemplate.initialValues) {
+      if (!readValue(stream, value)) {
+        return false;
+      }
+    }
+    if (!readCount(stream, count)) {
+      return false;
+    }
+    graphTemplate.primTargetPaths.resize(count);
+    for (auto& [index, path] : graphTemplate.primTargetPaths) {
+      if (!read(stream, index) || index >= graphTemplate.initialValues.size() || !readString(stream, path)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const RtComponentSpec* findSpecVariant(const RtCompiledGraphComponent& component) {
+    for (const RtComponentSpec* spec : getAllComponentSpecVariants(component.componentType)) {
+      if (spec->version != component.version || spec->properties.size() != component.variantPropertyTypes.size()) {
+        continue;
+      }
+      bool allMatch = true;
+      for (size_t i = 0; i < spec->properties.size(); i++) {
+        if (spec->properties[i].type != component.variantPropertyTypes[i]) {
+          allMatch = false;
+          break;
+        }
+      }
+      if (allMatch) {
+        return spec;
+      }
+    }
+    return nullptr;
+  }
+} // anonymous namespace
+
+std::optional<RtCompiledGraphTemplate> GraphTopologyCache::findTemplate(XXH64_hash_t templateKey) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto iter = m_templates.find(templateKey);
+  if (iter == m_templates.end()) {
+    return std::nullopt;
+  }
+  return iter->second;
+}
+
+const RtCompiledGraphTopology* GraphTopologyCache::findTopology(XXH64_hash_t graphHash) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto iter = m_topologies.find(graphHash);
+  if (iter == m_topologies.end()) {
+    return nullptr;
+  }
+  // Note: entries are never erased outside of `clear()`/`deserialize()`, so the pointer remains valid for the duration of a load.
+  return &iter->second;
+}
+
+void GraphTopologyCache::store(XXH64_hash_t templateKey, RtCompiledGraphTemplate&& graphTemplate, RtCompiledGraphTopology&& topology) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_topologies.try_emplace(topology.graphHash, std::move(topology));
+  m_templates.insert_or_assign(templateKey, std::move(graphTemplate));
+  m_usedTemplateKeys.insert(templateKey);
+  m_dirty = true;
+}
+
+void GraphTopologyCache::recordHit(XXH64_hash_t templateKey) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_usedTemplateKeys.insert(templateKey);
+  ++m_hits;
+}
+
+bool GraphTopologyCache::isDirty() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_dirty || m_usedTemplateKeys.size() != m_templates.size();
+}
+
+bool GraphTopologyCache::instantiateTopology(const RtCompiledGraphTopology& compiled, const std::string& graphPrimPath, RtGraphTopology& topology) {
+  topology.graphHash = compiled.graphHash;
+  topology.propertyTypes = compiled.propertyTypes;
+  topology.componentSpecs.reserve(compiled.components.size());
+  topology.propertyIndices.reserve(compiled.components.size());
+  for (const RtCompiledGraphComponent& component : compiled.components) {
+    const RtComponentSpec* spec = findSpecVariant(component);
+    if (spec == nullptr) {
+      return false;
+    }
+    topology.componentSpecs.push_back(spec);
+    topology.propertyIndices.emplace_back(component.propertyIndices.begin(), component.propertyIndices.end());
+  }
+  topology.propertyPathHashToIndexMap.reserve(compiled.propertyPaths.size());
+  for (const auto& [path, index] : compiled.propertyPaths) {
+    topology.propertyPathHashToIndexMap.emplace(graphPrimPath + "/" + path, index);
+  }
+  return true;
+}
+
+RtCompiledGraphTopology GraphTopologyCache::compileTopology(const RtGraphTopology& topology, const std::string& graphPrimPath) {
+  RtCompiledGraphTopology compiled;
+  compiled.graphHash = topology.graphHash;
+  compiled.propertyTypes = topology.propertyTypes;
+  compiled.components.reserve(topology.componentSpecs.size());
+  for (size_t i = 0; i < topology.componentSpecs.size(); i++) {
+    const RtComponentSpec& spec = *topology.componentSpecs[i];
+    RtCompiledGraphComponent& component = compiled.components.emplace_back();
+    component.componentType = spec.componentType;
+    component.version = spec.version;
+    component.variantPropertyTypes.reserve(spec.properties.size());
+    for (const RtComponentPropertySpec& property : spec.properties) {
+      component.variantPropertyTypes.push_back(property.type);
+    }
+    component.propertyIndices.reserve(topology.propertyIndices[i].size());
+    for (const size_t index : topology.propertyIndices[i]) {
+      component.propertyIndices.push_back(static_cast<uint32_t>(index));
+    }
+  }
+  // Property paths are stored relative to the graph prim, so that the GUI names remain meaningful for other instances.
+  const std::string prefix = graphPrimPath + "/";
+  compiled.propertyPaths.reserve(topology.propertyPathHashToIndexMap.size());
+  for (const auto& [path, index] : topology.propertyPathHashToIndexMap) {
+    if (path.compare(0, prefix.size(), prefix) == 0) {
+      compiled.propertyPaths.emplace_back(path.substr(prefix.size()), static_cast<uint32_t>(index));
+    }
+  }
+  return compiled;
+}
+
+std::filesystem::path GraphTopologyCache::getCachePath(const std::filesystem::path& modFilePath) {
+  const std::string modPath = std::filesystem::absolute(modFilePath).lexically_normal().generic_string();
+  const XXH64_hash_t modHash = XXH3_64bits(modPath.c_str(), modPath.size());
+  return util::RtxFileSys::path(util::RtxFileSys::Logs) / "graph_cache" / str::format(std::hex, modHash, std::dec, "_", kCacheFileName);
+}
+
+bool GraphTopologyCache::serialize(const std::filesystem::path& filePath) const {
+  ScopedCpuProfileZone();
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (!util::createDirectories(filePath.parent_path())) {
+    return false;
+  }
+
+  // Write to a temporary file first, so that a partially written cache is never picked up by the next load.
+  std::filesystem::path tempPath = filePath;
+  tempPath += ".tmp";
+  {
+    std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+    if (!stream.is_open()) {
+      Logger::warn(str::format("[GraphTopologyCache] Unable to open ", tempPath.string(), " for writing."));
+      return false;
+    }
+
+    write(stream, kCacheMagic);
+    write(stream, kCacheVersion);
+
+    // Topologies are shared between templates, so collect the ones referenced by used templates first.
+    fast_unordered_set usedGraphHashes;
+    for (const XXH64_hash_t templateKey : m_usedTemplateKeys) {
+      usedGraphHashes.insert(m_templates.at(templateKey).graphHash);
+    }
+
+    write(stream, static_cast<uint32_t>(usedGraphHashes.size()));
+    for (const XXH64_hash_t graphHash : usedGraphHashes) {
+      writeTopology(stream, m_topologies.at(graphHash));
+    }
+
+    write(stream, static_cast<uint32_t>(m_usedTemplateKeys.size()));
+    for (const XXH64_hash_t templateKey : m_usedTemplateKeys) {
+      write(stream, templateKey);
+      writeTemplate(stream, m_templates.at(templateKey));
+    }
+
+    if (!stream.good()) {
+      Logger::warn(str::format("[GraphTopologyCache] Failed to write ", tempPath.string()));
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tempPath, filePath, ec);
+  if (ec) {
+    Logger::warn(str::format("[GraphTopologyCache] Failed to replace ", filePath.string(), ": ", ec.message()));
+    std::filesystem::remove(tempPath, ec);
+    return false;
+  }
+  return true;
+}
+
+bool GraphTopologyCache::deserialize(const std::filesystem::path& filePath) {
+  ScopedCpuProfileZone();
+  std::ifstream stream(filePath, std::ios::binary);
+  if (!stream.is_open()) {
+    return false;
+  }
+
+  uint32_t magic, version;
+  if (!read(stream, magic) || !read(stream, version) || magic != kCacheMagic || version != kCacheVersion) {
+    Logger::info(str::format("[GraphTopologyCache] Ignoring ", filePath.string(), ": unknown format or version."));
+    return false;
+  }
+
+  fast_unordered_cache<RtCompiledGraphTopology> topologies;
+  fast_unordered_cache<RtCompiledGraphTemplate> templates;
+
+  uint32_t count;
+  bool success = readCount(stream, count);
+  for (uint32_t i = 0; success && i < count; i++) {
+    RtCompiledGraphTopology topology;
+    success = readTopology(stream, topology);
+    if (success) {
+      const XXH64_hash_t graphHash = topology.graphHash;
+      topologies.emplace(graphHash, std::move(topology));
+    }
+  }
+
+  success = success && readCount(stream, count);
+  for (uint32_t i = 0; success && i < count; i++) {
+    XXH64_hash_t templateKey;
+    RtCompiledGraphTemplate graphTemplate;
+    success = read(stream, templateKey) && readTemplate(stream, graphTemplate);
+    // Templates must always reference a topology stored in the same file.
+    success = success && topologies.find(graphTemplate.graphHash) != topologies.end();
+    if (success) {
+      templates.emplace(templateKey, std::move(graphTemplate));
+    }
+  }
+
+  if (!success) {
+    Logger::warn(str::format("[GraphTopologyCache] ", filePath.string(), " is corrupted and will be rebuilt."));
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_topologies = std::move(topologies);
+  m_templates = std::move(templates);
+  m_usedTemplateKeys.clear();
+  m_dirty = false;
+  m_hits = 0;
+  return true;
+}
+
+void GraphTopologyCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_topologies.clear();
+  m_templates.clear();
+  m_usedTemplateKeys.clear();
+  m_dirty = false;
+  m_hits = 0;
+}
+
+} // namespace dxvk
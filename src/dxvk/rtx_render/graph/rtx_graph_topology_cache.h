@@ -0,0 +1,117 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+
+#include "rtx_graph_types.h"
+#include "../rtx_option.h"
+
+namespace dxvk {
+
+// A single component of a compiled graph.  The component spec is stored by type and resolved property types
+// rather than by pointer, so that it can be persisted and re-resolved against the registry on load.
+struct RtCompiledGraphComponent {
+  RtComponentType componentType = kInvalidComponentType;
+  int version = 0;
+  // The concrete property types of the spec variant that was selected when the graph was parsed.
+  std::vector<RtComponentPropertyType> variantPropertyTypes;
+  std::vector<uint32_t> propertyIndices;
+};
+
+// Compact form of an RtGraphTopology, keyed by the graph hash.
+struct RtCompiledGraphTopology {
+  XXH64_hash_t graphHash = 0;
+  std::vector<RtComponentPropertyType> propertyTypes;
+  std::vector<RtCompiledGraphComponent> components;
+  // Property paths relative to the graph prim, used to rebuild `propertyPathHashToIndexMap` for the GUI.
+  std::vector<std::pair<std::string, uint32_t>> propertyPaths;
+};
+
+// The per-template part of a parsed graph: which topology it uses and the initial values of its properties.
+struct RtCompiledGraphTemplate {
+  XXH64_hash_t graphHash = 0;
+  std::vector<RtComponentPropertyValue> initialValues;
+  // Prim target values depend on where the graph is instanced, so they are stored as
+  // (index into initialValues, target path relative to the graph prim) and resolved per instance.
+  std::vector<std::pair<uint32_t, std::string>> primTargetPaths;
+};
+
+// Cache of compiled graph topologies, used to skip re-parsing graphs that come from the same USD source.
+//
+// Templates are keyed by a hash of the prim stacks of the graph prim and all of its descendants (see
+// `GraphUsdParser::getGraphTemplateKey`), so two graphs share a key only when they are composed from the
+// exact same layer specs, i.e. they are the same graph referenced in multiple places without local overrides.
+class GraphTopologyCache {
+public:
+  RTX_OPTION("rtx.graph", bool, enableTopologyCache, true, "Reuse the parsed topology and initial values of graphs that are composed from the same USD source, instead of re-parsing the graph for every replacement that references it.");
+  RTX_OPTION("rtx.graph", bool, persistTopologyCache, true, "Write the compiled graph topologies to a per-mod cache file in the Remix logs directory, so that later loads can skip parsing graphs whose source layers have not changed.");
+
+  static constexpr const char* kCacheFileName = "graph_topology.cache";
+
+  // Returns the location of the persisted cache for the given mod. This lives outside of the mod directory,
+  // which may be read-only or shipped to users, and is distinguished per mod by a hash of the mod file path.
+  static std::filesystem::path getCachePath(const std::filesystem::path& modFilePath);
+
+  std::optional<RtCompiledGraphTemplate> findTemplate(XXH64_hash_t templateKey) const;
+  const RtCompiledGraphTopology* findTopology(XXH64_hash_t graphHash) const;
+
+  void store(XXH64_hash_t templateKey, RtCompiledGraphTemplate&& graphTemplate, RtCompiledGraphTopology&& topology);
+
+  // Marks the template as used by the current load, so that it is kept when the cache is serialized.
+  void recordHit(XXH64_hash_t templateKey);
+
+  // Rebuilds a runtime topology from its compiled form.  Returns false if any of the component specs can
+  // no longer be resolved (i.e. the cache was written by a runtime with a different set of components).
+  static bool instantiateTopology(const RtCompiledGraphTopology& compiled, const std::string& graphPrimPath, RtGraphTopology& topology);
+
+  // Builds the compiled form of a runtime topology.
+  static RtCompiledGraphTopology compileTopology(const RtGraphTopology& topology, const std::string& graphPrimPath);
+
+  // Only the templates that were hit or stored since the last `deserialize()`/`clear()` are written, along with
+  // the topologies they reference, so entries of graphs that were removed from the mod don't accumulate.
+  bool serialize(const std::filesystem::path& filePath) const;
+  bool deserialize(const std::filesystem::path& filePath);
+
+  void clear();
+
+  // Also true when some of the loaded templates were not used, so that the next serialize prunes them.
+  bool isDirty() const;
+
+  size_t getHitCount() const {
+    return m_hits;
+  }
+
+private:
+  mutable std::mutex m_mutex;
+  fast_unordered_cache<RtCompiledGraphTemplate> m_templates;
+  fast_unordered_cache<RtCompiledGraphTopology> m_topologies;
+  fast_unordered_set m_usedTemplateKeys;
+  bool m_dirty = false;
+  std::atomic<size_t> m_hits = 0;
+};
+
+} // namespace dxvk
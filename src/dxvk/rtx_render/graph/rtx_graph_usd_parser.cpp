@@ -34,6 +34,8 @@
 #include <pxr/usd/sdf/layer.h>
 #include <pxr/usd/ar/resolver.h>
 #include <pxr/usd/ar/resolvedPath.h>
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/base/arch/fileSystem.h>
 #include "../../../lssusd/usd_include_end.h"
 
 namespace dxvk {
@@ -110,10 +112,108 @@ bool getLastValidConnection(
 
 } // anonymous namespace
 
-RtGraphState GraphUsdParser::parseGraph(AssetReplacements& replacements, const pxr::UsdPrim& graphPrim, PathToOffsetMap& pathToOffsetMap) {
+RtGraphState GraphUsdParser::parseGraph(AssetReplacements& replacements, const pxr::UsdPrim& graphPrim, PathToOffsetMap& pathToOffsetMap, GraphTopologyCache* topologyCache) {
   ScopedCpuProfileZone();
+  const std::string graphPrimPath = graphPrim.GetPath().GetString();
+
+  XXH64_hash_t templateKey = kEmptyHash;
+  if (topologyCache != nullptr && GraphTopologyCache::enableTopologyCache()) {
+    templateKey = getGraphTemplateKey(graphPrim);
+    if (templateKey != kEmptyHash) {
+      std::optional<RtCompiledGraphTemplate> graphTemplate = topologyCache->findTemplate(templateKey);
+      if (graphTemplate.has_value()) {
+        const RtCompiledGraphTopology* compiledTopology = topologyCache->findTopology(graphTemplate->graphHash);
+        RtGraphTopology topology;
+        if (compiledTopology != nullptr && GraphTopologyCache::instantiateTopology(*compiledTopology, graphPrimPath, topology)) {
+          resolveCachedPrimTargets(graphPrim, graphTemplate->primTargetPaths, pathToOffsetMap, graphTemplate->initialValues);
+          topologyCache->recordHit(templateKey);
+          const XXH64_hash_t graphHash = topology.graphHash;
+          return { replacements.storeObject(graphHash, std::move(topology)), std::move(graphTemplate->initialValues), graphPrimPath };
+        }
+        // The cached entry refers to components this runtime can't resolve, so fall back to a full parse which will replace it.
+      }
+    }
+  }
+
   RtGraphTopology topology;
   std::vector<RtComponentPropertyValue> initialValues;
+  std::vector<std::pair<uint32_t, std::string>> primTargetPaths;
+  parseGraphFromUsd(graphPrim, pathToOffsetMap, topology, initialValues, primTargetPaths);
+
+  if (templateKey != kEmptyHash) {
+    topologyCache->store(templateKey,
+                         RtCompiledGraphTemplate { topology.graphHash, initialValues, std::move(primTargetPaths) },
+                         GraphTopologyCache::compileTopology(topology, graphPrimPath));
+  }
+
+  const XXH64_hash_t graphHash = topology.graphHash;
+  return { replacements.storeObject(graphHash, std::move(topology)), std::move(initialValues), graphPrimPath };
+}
+
+XXH64_hash_t GraphUsdParser::getGraphTemplateKey(const pxr::UsdPrim& graphPrim) {
+  ScopedCpuProfileZone();
+  const pxr::SdfPath& graphPath = graphPrim.GetPath();
+  XXH64_hash_t key = kEmptyHash;
+  std::vector<pxr::SdfLayerHandle> layers;
+  for (const pxr::UsdPrim& prim : pxr::UsdPrimRange(graphPrim)) {
+    // Use paths relative to the graph, so that the same graph referenced in different places produces the same key.
+    const std::string relativePath = prim.GetPath().MakeRelativePath(graphPath).GetString();
+    key = XXH3_64bits_withSeed(relativePath.c_str(), relativePath.size(), key);
+    for (const pxr::SdfPrimSpecHandle& spec : prim.GetPrimStack()) {
+      const pxr::SdfLayerHandle layer = spec->GetLayer();
+      if (std::find(layers.begin(), layers.end(), layer) == layers.end()) {
+        // Anonymous layers have no file on disk, and layers with unsaved edits don't match theirs,
+        // so the identifier doesn't describe their content and the graph can't be safely cached.
+        if (layer->IsDirty() || layer->IsAnonymous()) {
+          return kEmptyHash;
+        }
+        layers.push_back(layer);
+      }
+      const std::string& identifier = layer->GetIdentifier();
+      const std::string specPath = spec->GetPath().GetString();
+      key = XXH3_64bits_withSeed(identifier.c_str(), identifier.size(), key);
+      key = XXH3_64bits_withSeed(specPath.c_str(), specPath.size(), key);
+    }
+  }
+
+  // Include the modification time of every contributing layer, so that persisted entries are invalidated when the source changes.
+  for (const pxr::SdfLayerHandle& layer : layers) {
+    double modificationTime = 0.0;
+    const std::string& realPath = layer->GetRealPath();
+    if (!realPath.empty()) {
+      pxr::ArchGetModificationTime(realPath.c_str(), &modificationTime);
+    }
+    key = XXH3_64bits_withSeed(&modificationTime, sizeof(modificationTime), key);
+  }
+
+  return key;
+}
+
+void GraphUsdParser::resolveCachedPrimTargets(
+    const pxr::UsdPrim& graphPrim,
+    const std::vector<std::pair<uint32_t, std::string>>& primTargetPaths,
+    PathToOffsetMap& pathToOffsetMap,
+    std::vector<RtComponentPropertyValue>& values) {
+  for (const auto& [valueIndex, relativePath] : primTargetPaths) {
+    const std::string path = pxr::SdfPath(relativePath).MakeAbsolutePath(graphPrim.GetPath()).GetString();
+    const XXH64_hash_t pathHash = XXH3_64bits(path.c_str(), path.size());
+    auto iter = pathToOffsetMap.find(pathHash);
+    if (iter == pathToOffsetMap.end()) {
+      Logger::err(str::format("Relationship path ", path, " not found in replacement hierarchy."));
+      values[valueIndex] = PrimTarget { ReplacementInstance::kInvalidReplacementIndex, kInvalidInstanceId };
+    } else {
+      values[valueIndex] = PrimTarget { iter->second, kInvalidInstanceId };
+    }
+  }
+}
+
+void GraphUsdParser::parseGraphFromUsd(
+    const pxr::UsdPrim& graphPrim,
+    PathToOffsetMap& pathToOffsetMap,
+    RtGraphTopology& topology,
+    std::vector<RtComponentPropertyValue>& initialValues,
+    std::vector<std::pair<uint32_t, std::string>>& primTargetPaths) {
+  ScopedCpuProfileZone();
 
   // Iterate over all active nodes in the graph
   std::vector<DAGNode> sortedNodes = getDAGSortedNodes(graphPrim);
@@ -226,6 +326,14 @@ RtGraphState GraphUsdParser::parseGraph(AssetReplacements& replacements, const p
         }
         if (!hasConnection) {
           propertyIndices.push_back(getPropertyIndex(topology, propertyPath, property));
+          // Record the target relative to the graph, so cached copies of this graph can resolve it for their own instance.
+          if (rel && rel.IsValid()) {
+            pxr::SdfPathVector targets;
+            rel.GetTargets(&targets);
+            if (targets.size() == 1) {
+              primTargetPaths.emplace_back(static_cast<uint32_t>(initialValues.size()), targets[0].MakeRelativePath(graphPrim.GetPath()).GetString());
+            }
+          }
           initialValues.push_back(getPropertyValue(rel, property, pathToOffsetMap));
         }
       } else {
@@ -275,8 +383,6 @@ RtGraphState GraphUsdParser::parseGraph(AssetReplacements& replacements, const p
     }
     topology.graphHash = XXH3_64bits_withSeed(propertyTypes.data(), sizeof(RtComponentPropertyType) * propertyTypes.size(), topology.graphHash);
   }
-
-  return { replacements.storeObject(topology.graphHash, RtGraphTopology{topology}), initialValues, graphPrim.GetPath().GetString() };
 }
 
 std::vector<GraphUsdParser::DAGNode> GraphUsdParser::getDAGSortedNodes(const pxr::UsdPrim& graphPrim) {
@@ -28,6 +28,7 @@
 #include "../../../lssusd/usd_include_end.h"
 
 #include "rtx_graph_types.h"
+#include "rtx_graph_topology_cache.h"
 #include "../rtx_asset_replacer.h"
 #include "../util/log/log.h"
 #include "../util/util_string.h"
@@ -38,12 +39,30 @@ public:
   using PathToOffsetMap = fast_unordered_cache<uint32_t>;
 
   // Make a RtGraphTopology object from a USD graph prim.
-  static RtGraphState parseGraph(AssetReplacements& replacements, const pxr::UsdPrim& graphPrim, PathToOffsetMap& pathToOffsetMap);
+  // If a `topologyCache` is provided, graphs composed from the same USD source are only parsed once.
+  static RtGraphState parseGraph(AssetReplacements& replacements, const pxr::UsdPrim& graphPrim, PathToOffsetMap& pathToOffsetMap, GraphTopologyCache* topologyCache = nullptr);
 
   // Friend class for testing
   friend class GraphUsdParserTestApp;
 
 private:
+  // Does the actual USD traversal for `parseGraph`.  Also records the graph-relative paths of any prim targets in `primTargetPaths`.
+  static void parseGraphFromUsd(
+      const pxr::UsdPrim& graphPrim,
+      PathToOffsetMap& pathToOffsetMap,
+      RtGraphTopology& topology,
+      std::vector<RtComponentPropertyValue>& initialValues,
+      std::vector<std::pair<uint32_t, std::string>>& primTargetPaths);
+
+  // Hash of the layer specs that the graph prim and its descendants are composed from.  Returns kEmptyHash if the graph can't be cached.
+  static XXH64_hash_t getGraphTemplateKey(const pxr::UsdPrim& graphPrim);
+
+  // Converts the graph-relative prim target paths of a cached graph to offsets within the current replacement.
+  static void resolveCachedPrimTargets(
+      const pxr::UsdPrim& graphPrim,
+      const std::vector<std::pair<uint32_t, std::string>>& primTargetPaths,
+      PathToOffsetMap& pathToOffsetMap,
+      std::vector<RtComponentPropertyValue>& values);
 
   struct DAGNode {
     pxr::SdfPath path;
@@ -34,6 +34,7 @@
 
 #include "dxvk_scoped_annotation.h"
 #include "rtx_options.h"
+#include "../util/log/metrics_registry.h"
 
 #include "rtx/pass/instance_definitions.h"
 #include "rtx/concept/billboard.h"
@@ -1254,6 +1255,9 @@ namespace dxvk {
 
     // Build the BLASes
     if (!blasToBuild.empty()) {
+      static const MetricCounter s_blasBuilds = MetricsRegistry::get().registerCounter("rtx_blas_builds");
+      s_blasBuilds.add(blasToBuild.size());
+
       // Now apply the buffer offset to the scratch address we calculated earlier
       for (auto& desc : blasToBuild) {
         desc.scratchData.deviceAddress += m_scratchBuffer->getDeviceAddress();
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <filesystem>
+#include <vector>
 #include <vulkan/vulkan.h>
 #include "../../util/util_error.h"
 #include "../../util/rc/util_rc.h"
@@ -143,6 +144,23 @@ namespace dxvk {
      */
     virtual void releaseSource() = 0;
 
+    /**
+     * \brief Read subresource data into memory
+     *
+     * Reads the data of a subresource from the source media into
+     * the provided vector, without going through the internal cache
+     * and without keeping the source media open. Unlike data(),
+     * this method is safe to call concurrently with other methods,
+     * and is used to populate the global mip cache.
+     * \param [in] layer Image layer, ignored if asset is not an image
+     * \param [in] level Image level, ignored if asset is not an image
+     * \param [out] data Subresource data
+     * \returns False if the asset doesn't support this or the read failed
+     */
+    virtual bool readSubresource(int layer, int level, std::vector<uint8_t>& data) const {
+      return false;
+    }
+
   protected:
     AssetData() = default;
 
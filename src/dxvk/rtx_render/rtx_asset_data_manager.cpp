@@ -20,6 +20,7 @@
 * DEALINGS IN THE SOFTWARE.
 */
 #include "rtx_asset_data_manager.h"
+#include "rtx_asset_mip_cache.h"
 #include "rtx_utils.h"
 #include "rtx_options.h"
 #include "rtx_asset_package.h"
@@ -251,8 +252,14 @@ namespace dxvk {
     HANDLE m_hFile{};
     HANDLE m_hMapping{};
     const uint8_t* m_lpBaseAddress{};
+    // Subresources handed out from the global mip cache, until evictCache() is called for them
+    std::unordered_map<uint32_t, AssetMipCache::Blob> m_cachedData;
 
   private:
+    uint32_t subresourceIndex(int layer, int level) const {
+      return uint32_t(layer) * uint32_t(m_levelSizes.size()) + uint32_t(level);
+    }
+
     AssetType type() const {
       if (m_width > 1 && m_height == 1 && m_depth == 1) {
         return AssetType::Image1D;
@@ -278,6 +285,13 @@ namespace dxvk {
         Logger::warn(str::format("Corrupted DDS file discovered: ", m_filename));
         return nullptr;
       }
+      if (AssetMipCache::get().enabled()) {
+        if (AssetMipCache::Blob blob = AssetMipCache::get().load(*this, layer, level)) {
+          // Keep the data alive until the caller evicts it, even if the cache drops it meanwhile
+          m_cachedData[subresourceIndex(layer, level)] = blob;
+          return blob->data();
+        }
+      }
       if (!m_hFile) {
         // NOTE: relaxing the share mode from 0 (no sharing) to FILE_SHARE_READ,
         //       so that other CreateFile calls in this process and other processes can still open it for reading;
@@ -317,6 +331,28 @@ namespace dxvk {
     }
 
     void evictCache(int layer, int level) override {
+      m_cachedData.erase(subresourceIndex(layer, level));
+    }
+
+    bool readSubresource(int layer, int level, std::vector<uint8_t>& data) const override {
+      long dataOffset;
+      size_t dataSize;
+      getDataPlacement(layer, 0, level, dataOffset, dataSize);
+
+      if (m_fileSize < dataOffset + dataSize) {
+        return false;
+      }
+
+      // NOTE: use a separate handle, as this can be called from other threads
+      FILE* file = std::fopen(m_filename.c_str(), "rb");
+      if (file == nullptr) {
+        return false;
+      }
+      data.resize(dataSize);
+      const bool success = std::fseek(file, dataOffset, SEEK_SET) == 0 &&
+                           std::fread(data.data(), 1, dataSize, file) == dataSize;
+      std::fclose(file);
+      return success;
     }
 
     void releaseSource() override {
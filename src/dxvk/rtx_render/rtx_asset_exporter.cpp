@@ -32,6 +32,7 @@
 #include <gli/save.hpp>
 #include <string>
 #include <charconv>
+#include <fstream>
 #include <functional>
 
 namespace {
@@ -69,20 +70,96 @@ namespace {
 
 namespace dxvk {
 
-  void AssetExporter::waitForAllExportsToComplete(const float numSecsToWait) {
+  struct AssetExporter::ImageExportJob {
+    std::string filename;
+    gli::format outFormat;
+    gli::swizzles swizzle;
+    DxvkImageCreateInfo dstDesc;
+    uint64_t syncValue;
+    // Staging images, released as soon as the conversion stage has packed them
+    std::vector<Rc<DxvkImage>> blitTemps;
+    std::vector<Rc<DxvkImage>> blitDests;
+    // Serialized file, produced by the conversion stage
+    std::vector<char> fileData;
+  };
+
+  AssetExporter::~AssetExporter() {
+    // Stop the stages in pipeline order, so that no stage schedules work on a stage that is already gone
+    m_exporterThread = nullptr;
+    m_conversionThreads = nullptr;
+    m_writerThread = nullptr;
+  }
 
-    if (m_numExportsInFlight > 0) {
-      Logger::info(str::format("RTX: Waiting for ", m_numExportsInFlight, " asset exports to complete"));
+  void AssetExporter::waitForAllExportsToComplete(const float numSecsWithoutProgress) {
+    if (m_numExportsInFlight == 0) {
+      return;
+    }
 
-      auto startTime = std::chrono::system_clock::now();
-      while (m_numExportsInFlight > 0 &&
-             std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now() - startTime).count() < numSecsToWait) {
-        Sleep(1);
+    const ImageExportProgress progress = getImageExportProgress();
+    Logger::info(str::format("RTX: Waiting for ", m_numExportsInFlight, " asset exports to complete (images: ",
+                             progress.queued - progress.readBack, " awaiting readback, ",
+                             progress.readBack - progress.converted, " converting, ",
+                             progress.converted - progress.written, " writing)"));
+
+    // No fixed deadline: exports are bounded and each one is known to be in some stage, so keep waiting
+    // as long as they keep completing, and only give up if the pipeline stalls.
+    const auto stallTimeout = std::chrono::duration<float>(numSecsWithoutProgress);
+    auto lastProgressTime = std::chrono::steady_clock::now();
+    uint64_t lastCompleted = m_numExportsCompleted;
+
+    std::unique_lock<dxvk::mutex> lock(m_progressMutex);
+    while (m_numExportsInFlight > 0) {
+      m_progressCond.wait_for(lock, std::chrono::milliseconds(100));
+
+      const auto now = std::chrono::steady_clock::now();
+      if (m_numExportsCompleted != lastCompleted) {
+        lastCompleted = m_numExportsCompleted;
+        lastProgressTime = now;
+      } else if (now - lastProgressTime > stallTimeout) {
+        Logger::err(str::format("RTX: Timed-out waiting on all asset exports to complete, no export completed for ",
+                                numSecsWithoutProgress, " seconds (", m_numExportsInFlight, " still in flight)"));
+        return;
       }
+    }
+  }
+
+  AssetExporter::ImageExportProgress AssetExporter::getImageExportProgress() const {
+    ImageExportProgress progress;
+    // Read in reverse pipeline order, so that a later stage never appears ahead of an earlier one
+    progress.failed = m_imagesFailed;
+    progress.written = m_imagesWritten;
+    progress.converted = m_imagesConverted;
+    progress.readBack = m_imagesReadBack;
+    progress.queued = m_imagesQueued;
+    return progress;
+  }
 
-      if (m_numExportsInFlight > 0)
-        Logger::err(str::format("RTX: Timed-out waiting on all asset exports to complete"));
+  void AssetExporter::completeExport(bool isImage) {
+    {
+      std::lock_guard<dxvk::mutex> lock(m_progressMutex);
+      if (isImage) {
+        m_numImagesInFlight--;
+      }
+      m_numExportsInFlight--;
+      m_numExportsCompleted++;
     }
+    m_progressCond.notify_all();
+  }
+
+  void AssetExporter::waitForImageSlot(Rc<DxvkContext>& ctx) {
+    const uint32_t maxImagesInFlight = std::clamp(AssetExporter::maxImagesInFlight(), 1u, uint32_t(kMaxImagesInFlight));
+    if (m_numImagesInFlight < maxImagesInFlight) {
+      return;
+    }
+
+    ScopedCpuProfileZoneN("Export Image Back-pressure");
+    // The images in flight may still be waiting on copies recorded into this context, submit them first
+    ctx->flushCommandList();
+
+    std::unique_lock<dxvk::mutex> lock(m_progressMutex);
+    m_progressCond.wait(lock, [this, maxImagesInFlight] {
+      return m_numImagesInFlight < maxImagesInFlight;
+    });
   }
 
   std::unique_ptr<AssetExporter::ThreadPool>& AssetExporter::getExporterThread() {
@@ -92,6 +169,23 @@ namespace dxvk {
     return m_exporterThread;
   }
 
+  std::unique_ptr<AssetExporter::ImageThreadPool>& AssetExporter::getConversionThreads() {
+    // NOTE: only called from the exporter thread
+    if (m_conversionThreads == nullptr) {
+      const uint8_t numThreads = uint8_t(std::clamp(numConversionThreads(), 1u, 16u));
+      m_conversionThreads = std::make_unique<ImageThreadPool>(numThreads, "rtx-asset-export-convert");
+    }
+    return m_conversionThreads;
+  }
+
+  std::unique_ptr<AssetExporter::ImageThreadPool>& AssetExporter::getWriterThread() {
+    // NOTE: called with 'm_writerScheduleMutex' held
+    if (m_writerThread == nullptr) {
+      m_writerThread = std::make_unique<ImageThreadPool>(1, "rtx-asset-export-write");
+    }
+    return m_writerThread;
+  }
+
   void AssetExporter::exportImage(Rc<DxvkContext> ctx, const std::string& filename, Rc<DxvkImage> image, bool thumbnail/* = false*/) {
     ScopedCpuProfileZone();
     // NOTE: Should use a mutex here...
@@ -102,7 +196,12 @@ namespace dxvk {
       }
     }
 
+    // Back-pressure: bound the staging memory held by images that haven't been written yet
+    waitForImageSlot(ctx);
+
     m_numExportsInFlight++;
+    m_numImagesInFlight++;
+    m_imagesQueued++;
 
     // We want to retain most of the src image state
     DxvkImageCreateInfo srcDesc = image->info();
@@ -147,8 +246,12 @@ namespace dxvk {
 
     const uint32_t numMipLevels = dstDesc.mipLevels;
 
-    Rc<DxvkImage>* pBlitTemps = useBlit ? new Rc<DxvkImage>[numMipLevels] : nullptr;
-    Rc<DxvkImage>* pBlitDests = new Rc<DxvkImage>[numMipLevels];
+    auto job = std::make_shared<ImageExportJob>();
+    job->blitTemps.resize(useBlit ? numMipLevels : 0);
+    job->blitDests.resize(numMipLevels);
+
+    Rc<DxvkImage>* pBlitTemps = useBlit ? job->blitTemps.data() : nullptr;
+    Rc<DxvkImage>* pBlitDests = job->blitDests.data();
 
     // Push a copy operation to the GPU; get that GPU data in CPU addressable space!
     for (uint32_t level = 0; level < numMipLevels; ++level) {
@@ -240,60 +343,118 @@ namespace dxvk {
     const uint64_t syncValue = ++m_signalValue;
     ctx->signal(m_readbackSignal, syncValue);
 
-    // Spawn a thread so we dont sync with the GPU here...(remember, GPU runs async with CPU!).  
-    Future<void> result = getExporterThread()->Schedule([this, device = ctx->getDevice(), pBlitDests, pBlitTemps, syncValue, filename, outFormat, dstDesc, swizzle] {
-      ScopedCpuProfileZoneN("Export Image Finalize");
+    job->filename = filename;
+    job->outFormat = outFormat;
+    job->swizzle = swizzle;
+    job->dstDesc = dstDesc;
+    job->syncValue = syncValue;
+
+    // Spawn a thread so we dont sync with the GPU here...(remember, GPU runs async with CPU!).
+    // The exporter thread only waits for the readback, in submission order, and hands the image over to the
+    // conversion threads, so that packing and writing large images doesn't hold back the readbacks behind them.
+    Future<void> result = getExporterThread()->Schedule([this, job] {
+      ScopedCpuProfileZoneN("Export Image Readback");
       // Stall until the GPU has completed its copy to system memory (GPU->CPU)
-      this->m_readbackSignal->wait(syncValue);
-    
-      // Push texture header to the GLI container
-      const gli::extent3d outExtent = { dstDesc.extent.width, dstDesc.extent.height, 1 };
-      gli::texture2d exportTex(outFormat, outExtent, dstDesc.mipLevels, swizzle);
+      this->m_readbackSignal->wait(job->syncValue);
+      m_imagesReadBack++;
+
+      Future<void> converted = getConversionThreads()->Schedule([this, job] {
+        convertImage(job);
+      });
+      if (!converted.valid()) {
+        Logger::err(str::format("RTX: Failed to convert texture \"", job->filename, "\".  Coding error, kMaxImagesInFlight, may be too low (currently: ", kMaxImagesInFlight, ")."));
+        m_imagesFailed++;
+        completeExport(true);
+      }
+    });
 
-      const DxvkFormatInfo* formatInfo = imageFormatInfo(gliFormatToVk(exportTex.format()));
+    if (!result.valid()) {
+      Logger::err(str::format("RTX: Failed to write texture \"", filename, "\".  Coding error, kMaxConcurrentExports, may be too low (currently: ", kMaxConcurrentExports, ")."));
+      m_imagesFailed++;
+      completeExport(true);
+    }
+  }
 
-      for (uint32_t level = 0; level < exportTex.levels(); ++level) {
-        const Rc<DxvkImage>& image = pBlitDests[level];
+  void AssetExporter::convertImage(std::shared_ptr<ImageExportJob> job) {
+    ScopedCpuProfileZoneN("Export Image Convert");
+    const DxvkImageCreateInfo& dstDesc = job->dstDesc;
 
-        // Calculate the Subresource Layout for the Image
+    // Push texture header to the GLI container
+    const gli::extent3d outExtent = { dstDesc.extent.width, dstDesc.extent.height, 1 };
+    gli::texture2d exportTex(job->outFormat, outExtent, dstDesc.mipLevels, job->swizzle);
 
-        VkImageSubresource subresource;
-        subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        subresource.mipLevel = 0; // pBlitDests is an array implicitly separated by mip levels, indexing into it selects the level
-        subresource.arrayLayer = 0;
-        const VkSubresourceLayout subresourceLayout = image->querySubresourceLayout(subresource);
+    const DxvkFormatInfo* formatInfo = imageFormatInfo(gliFormatToVk(exportTex.format()));
 
-        // Get destination and source pointers for writing/reading
+    for (uint32_t level = 0; level < exportTex.levels(); ++level) {
+      const Rc<DxvkImage>& image = job->blitDests[level];
 
-        void* pDst = (void*)exportTex.data(exportTex.base_layer(), exportTex.base_face(), level);
-        const void* pSrc = image->mapPtr(0);
+      // Calculate the Subresource Layout for the Image
 
-        const VkExtent3D levelExtent = gliExtentToVk(exportTex.extent(level));
-        const VkExtent3D elementCount = util::computeBlockCount(levelExtent, formatInfo->blockSize);
-        const uint32_t rowPitch = elementCount.width * formatInfo->elementSize;
-        const uint32_t layerPitch = rowPitch * elementCount.height;
+      VkImageSubresource subresource;
+      subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      subresource.mipLevel = 0; // blitDests is an array implicitly separated by mip levels, indexing into it selects the level
+      subresource.arrayLayer = 0;
+      const VkSubresourceLayout subresourceLayout = image->querySubresourceLayout(subresource);
 
-        util::packImageData(pDst, pSrc, subresourceLayout.rowPitch, subresourceLayout.arrayPitch,
-                            rowPitch, layerPitch, VK_IMAGE_TYPE_2D, levelExtent, 1, formatInfo,
-                            subresource.aspectMask);
-      }
+      // Get destination and source pointers for writing/reading
 
-      // Write our file, converting its format first if nessecary
-      const bool success = gli::save(exportTex, filename);
-      if (!success) {
-        Logger::err(str::format("RTX: Failed to write texture \"", filename, "\""));
-      }
+      void* pDst = (void*)exportTex.data(exportTex.base_layer(), exportTex.base_face(), level);
+      const void* pSrc = image->mapPtr(0);
 
-      delete[] pBlitTemps;
-      delete[] pBlitDests;
-      m_numExportsInFlight--;
-    });
+      const VkExtent3D levelExtent = gliExtentToVk(exportTex.extent(level));
+      const VkExtent3D elementCount = util::computeBlockCount(levelExtent, formatInfo->blockSize);
+      const uint32_t rowPitch = elementCount.width * formatInfo->elementSize;
+      const uint32_t layerPitch = rowPitch * elementCount.height;
 
+      util::packImageData(pDst, pSrc, subresourceLayout.rowPitch, subresourceLayout.arrayPitch,
+                          rowPitch, layerPitch, VK_IMAGE_TYPE_2D, levelExtent, 1, formatInfo,
+                          subresource.aspectMask);
+    }
+
+    // The staging images are no longer needed, release them before the file is written
+    job->blitTemps.clear();
+    job->blitDests.clear();
+
+    // Serialize the container in the format matching the file extension
+    const bool isKtx = job->filename.size() >= 4 && job->filename.compare(job->filename.size() - 4, 4, ".ktx") == 0;
+    const bool success = isKtx ? gli::save_ktx(exportTex, job->fileData) : gli::save_dds(exportTex, job->fileData);
+    if (!success) {
+      Logger::err(str::format("RTX: Failed to encode texture \"", job->filename, "\""));
+      m_imagesFailed++;
+      completeExport(true);
+      return;
+    }
+    m_imagesConverted++;
+
+    Future<void> result;
+    {
+      std::lock_guard<dxvk::mutex> lock(m_writerScheduleMutex);
+      result = getWriterThread()->Schedule([this, job] {
+        writeImage(job);
+      });
+    }
     if (!result.valid()) {
-      Logger::err(str::format("RTX: Failed to write texture \"", filename, "\".  Coding error, kMaxConcurrentExports, may be too low (currently: ", kMaxConcurrentExports, ")."));
+      Logger::err(str::format("RTX: Failed to write texture \"", job->filename, "\".  Coding error, kMaxImagesInFlight, may be too low (currently: ", kMaxImagesInFlight, ")."));
+      m_imagesFailed++;
+      completeExport(true);
     }
   }
 
+  void AssetExporter::writeImage(std::shared_ptr<ImageExportJob> job) {
+    ScopedCpuProfileZoneN("Export Image Write");
+    std::ofstream file(job->filename, std::ios::binary | std::ios::trunc);
+    file.write(job->fileData.data(), std::streamsize(job->fileData.size()));
+    file.close();
+
+    if (file.fail()) {
+      Logger::err(str::format("RTX: Failed to write texture \"", job->filename, "\""));
+      m_imagesFailed++;
+    } else {
+      m_imagesWritten++;
+    }
+    completeExport(true);
+  }
+
   void AssetExporter::exportBuffer(Rc<DxvkContext> ctx, const DxvkBufferSlice& buffer, BufferCallback bufferCallback) {
     ScopedCpuProfileZone();
     // NOTE: Should use a mutex here...
@@ -336,7 +497,7 @@ namespace dxvk {
       // Stall until the GPU has completed its copy to system memory (GPU->CPU)
       this->m_readbackSignal->wait(syncValue);
       bufferCallback(cDestBuffer);
-      m_numExportsInFlight--;
+      completeExport(false);
     });
     
     if (!result.valid()) {
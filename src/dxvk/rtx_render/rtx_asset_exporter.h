@@ -25,10 +25,14 @@
 #include "../util/rc/util_rc_ptr.h"
 #include <atomic>
 #include <future>
+#include <memory>
 #include <mutex>
+#include <vector>
 #include "../util/util_env.h"
 #include "../util/util_string.h"
+#include "../util/thread.h"
 #include "rtx_constants.h"
+#include "rtx_option.h"
 
 
 namespace dxvk {
@@ -40,11 +44,39 @@ namespace dxvk {
   class DxvkBufferSlice;
   template<size_t NumTasksPerThread, bool WorkStealing, bool LowLatency> class WorkerThreadPool;
 
+  /**
+   * \brief Asset exporter
+   *
+   * Reads images and buffers back from the GPU, and writes them out on background threads.
+   *
+   * Image exports go through a bounded pipeline of three stages: a readback thread waits for the GPU copies
+   * in submission order, a pool of conversion threads packs the mips into a texture container and serializes
+   * it, and a writer thread writes the serialized file.  The number of images between the GPU copy and the
+   * file write is bounded by 'maxImagesInFlight': once reached, 'exportImage' flushes the command list and
+   * blocks until an image has been written, so that staging memory can't grow without bound.
+   *
+   * Buffer readbacks are delivered on the readback thread, in submission order.
+   */
   class AssetExporter {
   public:
+    RTX_OPTION("rtx.assetExporter", uint32_t, maxImagesInFlight, 256, "Maximum number of exported images held in staging memory between their GPU readback and their file write. Exporting more images blocks the render thread until earlier images have been written.");
+    RTX_OPTION("rtx.assetExporter", uint32_t, numConversionThreads, 4, "Number of threads used to pack and serialize exported images, once their GPU readback has completed.");
+
     using BufferCallback = std::function<void(Rc<DxvkBuffer>)>;
 
-    void waitForAllExportsToComplete(const float numSecsToWait = 10);
+    // Progress of the image export pipeline, as totals since the exporter was created
+    struct ImageExportProgress {
+      uint64_t queued = 0;
+      uint64_t readBack = 0;
+      uint64_t converted = 0;
+      uint64_t written = 0;
+      uint64_t failed = 0;
+    };
+
+    ~AssetExporter();
+
+    // Blocks until all exports have completed.  Gives up only if no export completes for 'numSecsWithoutProgress'.
+    void waitForAllExportsToComplete(const float numSecsWithoutProgress = 10);
 
     void dumpImageToFile(Rc<DxvkContext> ctx, const std::string& dir, const std::string& filename, Rc<DxvkImage> image) {
       env::createDirectory(dir);
@@ -63,20 +95,52 @@ namespace dxvk {
       return m_numExportsInFlight.load();
     }
 
+    ImageExportProgress getImageExportProgress() const;
+
   private:
+    struct ImageExportJob;
+
     Rc<sync::Fence> m_readbackSignal = nullptr;
     std::atomic<uint64_t> m_signalValue = 1;
     dxvk::mutex m_readbackSignalMutex;
     std::atomic<uint64_t> m_numExportsInFlight = 0;
+    std::atomic<uint64_t> m_numExportsCompleted = 0;
     inline static const size_t kMaxConcurrentExports = 64*1024 - 11; // Sized to match the buffer cache size in scene manager
     static_assert(kMaxConcurrentExports == kBufferCacheLimit, "When changing the maximum number of unique buffers, we also must consider that this limit may need changing also, since the number of buffers is proportional to the number of concurrent exports.");
+    // Upper bound for 'maxImagesInFlight', every image in flight may be queued on a single conversion or writer thread
+    inline static const size_t kMaxImagesInFlight = 1024;
     using ThreadPool = WorkerThreadPool<kMaxConcurrentExports, false, false>;
+    using ImageThreadPool = WorkerThreadPool<kMaxImagesInFlight, true, false>;
+
+    // Image pipeline progress, 'm_progressCond' is signaled whenever an export completes
+    std::atomic<uint64_t> m_imagesQueued = 0;
+    std::atomic<uint64_t> m_imagesReadBack = 0;
+    std::atomic<uint64_t> m_imagesConverted = 0;
+    std::atomic<uint64_t> m_imagesWritten = 0;
+    std::atomic<uint64_t> m_imagesFailed = 0;
+    std::atomic<uint32_t> m_numImagesInFlight = 0;
+    dxvk::mutex m_progressMutex;
+    dxvk::condition_variable m_progressCond;
+
+    // NOTE: the worker pools are scheduled from a single thread each, except for the writer, which is
+    //       scheduled from all conversion threads and so needs 'm_writerScheduleMutex'.
+    //       Declared in pipeline order, so that downstream stages outlive the stages feeding them.
+    dxvk::mutex m_writerScheduleMutex;
+    std::unique_ptr<ImageThreadPool> m_writerThread;
+    std::unique_ptr<ImageThreadPool> m_conversionThreads;
     std::unique_ptr<ThreadPool> m_exporterThread;
 
     void exportImage(Rc<DxvkContext> ctx, const std::string& filename, Rc<DxvkImage> image, bool thumbnail = false);
 
     void exportBuffer(Rc<DxvkContext> ctx, const DxvkBufferSlice& buffer, BufferCallback bufferCallback);
 
+    void waitForImageSlot(Rc<DxvkContext>& ctx);
+    void convertImage(std::shared_ptr<ImageExportJob> job);
+    void writeImage(std::shared_ptr<ImageExportJob> job);
+    void completeExport(bool isImage);
+
     std::unique_ptr<ThreadPool>& getExporterThread();
+    std::unique_ptr<ImageThreadPool>& getConversionThreads();
+    std::unique_ptr<ImageThreadPool>& getWriterThread();
   };
 } // namespace dxvk
\ No newline at end of file
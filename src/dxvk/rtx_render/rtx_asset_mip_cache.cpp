@@ -0,0 +1,238 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_asset_mip_cache.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "../../util/log/log.h"
+#include "../../util/util_env.h"
+#include "../../util/util_string.h"
+#include "dxvk_scoped_annotation.h"
+
+namespace dxvk {
+
+  namespace {
+    constexpr size_t kBytesPerMiB = 1024 * 1024;
+    // Upper bound on queued prefetches, older requests are more likely to be stale
+    constexpr size_t kMaxPendingPrefetches = 256;
+  }
+
+  AssetMipCache::AssetMipCache(std::optional<size_t> budgetBytes)
+    : m_budgetOverride { budgetBytes } {
+  }
+
+  AssetMipCache::~AssetMipCache() {
+    if (m_prefetchThread) {
+      {
+        std::lock_guard<dxvk::mutex> lock(m_prefetchMutex);
+        m_stopPrefetch = true;
+      }
+      m_prefetchCond.notify_all();
+      m_prefetchThread->join();
+      m_prefetchThread = nullptr;
+    }
+  }
+
+  XXH64_hash_t AssetMipCache::makeKey(const AssetData& asset, uint32_t layer, uint32_t level) {
+    // Include the write time, so that a modified (e.g. hot-reloaded) file never hits stale data
+    struct {
+      XXH64_hash_t assetHash;
+      int64_t writeTime;
+      uint32_t layer;
+      uint32_t level;
+    } key { asset.hash(), int64_t(asset.info().lastWriteTime.time_since_epoch().count()), layer, level };
+    return XXH3_64bits(&key, sizeof(key));
+  }
+
+  size_t AssetMipCache::getBudgetBytes() const {
+    if (m_budgetOverride.has_value()) {
+      return *m_budgetOverride;
+    }
+    return size_t(mipCacheBudgetMiB()) * kBytesPerMiB;
+  }
+
+  AssetMipCache::Blob AssetMipCache::find(const AssetData& asset, uint32_t layer, uint32_t level) {
+    const XXH64_hash_t key = makeKey(asset, layer, level);
+
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+      ++m_misses;
+      return nullptr;
+    }
+    ++m_hits;
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+    return it->second.blob;
+  }
+
+  AssetMipCache::Blob AssetMipCache::insert(const AssetData& asset, uint32_t layer, uint32_t level, std::vector<uint8_t>&& data) {
+    Blob blob = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+
+    const size_t budgetBytes = getBudgetBytes();
+    // Don't let a single entry flush most of the cache
+    if (blob->size() > budgetBytes / 4) {
+      // The budget may have been lowered since the last insert
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      evictToBudget(budgetBytes);
+      return blob;
+    }
+
+    const XXH64_hash_t key = makeKey(asset, layer, level);
+
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    auto [it, inserted] = m_entries.try_emplace(key);
+    if (!inserted) {
+      // Another thread (e.g. the prefetcher) cached it first, share that copy
+      m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+      return it->second.blob;
+    }
+
+    m_lru.push_front(key);
+    it->second.blob = blob;
+    it->second.lruPosition = m_lru.begin();
+    m_residentBytes += blob->size();
+
+    evictToBudget(budgetBytes);
+    return blob;
+  }
+
+  AssetMipCache::Blob AssetMipCache::load(const AssetData& asset, uint32_t layer, uint32_t level) {
+    if (Blob blob = find(asset, layer, level)) {
+      return blob;
+    }
+    std::vector<uint8_t> data;
+    if (!asset.readSubresource(int(layer), int(level), data)) {
+      return nullptr;
+    }
+    return insert(asset, layer, level, std::move(data));
+  }
+
+  void AssetMipCache::evictToBudget(size_t budgetBytes) {
+    // Evict from the least recently used end
+    while (m_residentBytes > budgetBytes && !m_lru.empty()) {
+      auto entry = m_entries.find(m_lru.back());
+      assert(entry != m_entries.end());
+
+      m_residentBytes -= entry->second.blob->size();
+      m_entries.erase(entry);
+      m_lru.pop_back();
+      ++m_evictions;
+    }
+  }
+
+  void AssetMipCache::prefetch(const Rc<AssetData>& asset, uint32_t mipBegin, uint32_t mipEnd) {
+    if (!enabled() || !enableMipPrefetch() || asset == nullptr) {
+      return;
+    }
+    mipEnd = std::min(mipEnd, asset->info().mipLevels);
+
+    std::vector<PrefetchRequest> requests;
+    {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      for (uint32_t level = mipBegin; level < mipEnd; ++level) {
+        const XXH64_hash_t key = makeKey(*asset, 0, level);
+        if (m_entries.count(key) == 0) {
+          requests.push_back(PrefetchRequest { asset, level, key });
+        }
+      }
+    }
+    if (requests.empty()) {
+      return;
+    }
+
+    {
+      std::lock_guard<dxvk::mutex> lock(m_prefetchMutex);
+      for (PrefetchRequest& request : requests) {
+        if (m_prefetchQueue.size() >= kMaxPendingPrefetches) {
+          break;
+        }
+        if (m_prefetchPending.insert(request.key).second) {
+          m_prefetchQueue.push_back(std::move(request));
+        }
+      }
+      if (!m_prefetchThread) {
+        m_prefetchThread = std::make_unique<dxvk::thread>([this] { prefetchLoop(); });
+        m_prefetchThread->set_priority(ThreadPriority::Lowest);
+      }
+    }
+    m_prefetchCond.notify_one();
+  }
+
+  void AssetMipCache::prefetchLoop() {
+    env::setThreadName("rtx-asset-mip-prefetch");
+
+    while (true) {
+      PrefetchRequest request;
+      {
+        std::unique_lock<dxvk::mutex> lock(m_prefetchMutex);
+        m_prefetchCond.wait(lock, [this] {
+          return m_stopPrefetch || !m_prefetchQueue.empty();
+        });
+        if (m_stopPrefetch) {
+          return;
+        }
+        // Most recent requests first, they reflect what the camera is looking at now
+        request = std::move(m_prefetchQueue.back());
+        m_prefetchQueue.pop_back();
+      }
+
+      ScopedCpuProfileZoneN("Prefetch Asset Mip");
+      std::vector<uint8_t> data;
+      if (request.asset->readSubresource(0, int(request.level), data)) {
+        insert(*request.asset, 0, request.level, std::move(data));
+        std::lock_guard<dxvk::mutex> lock(m_mutex);
+        ++m_prefetches;
+      }
+
+      {
+        std::lock_guard<dxvk::mutex> lock(m_prefetchMutex);
+        m_prefetchPending.erase(request.key);
+      }
+    }
+  }
+
+  void AssetMipCache::clear() {
+    {
+      std::lock_guard<dxvk::mutex> lock(m_prefetchMutex);
+      m_prefetchQueue.clear();
+      m_prefetchPending.clear();
+    }
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_lru.clear();
+    m_residentBytes = 0;
+  }
+
+  AssetMipCache::Stats AssetMipCache::getStats() const {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    Stats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.prefetches = m_prefetches;
+    stats.evictions = m_evictions;
+    stats.residentBytes = m_residentBytes;
+    stats.budgetBytes = getBudgetBytes();
+    return stats;
+  }
+
+} // namespace dxvk
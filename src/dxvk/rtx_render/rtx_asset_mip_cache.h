@@ -0,0 +1,132 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <list>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "rtx_asset_data.h"
+#include "rtx_option.h"
+#include "../../util/thread.h"
+#include "../../util/util_singleton.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Asset mip cache
+   *
+   * Process-wide CPU-side cache of asset subresource data (texture mips), so that textures which are demoted
+   * and promoted again (e.g. when the camera revisits an area) don't re-read the same mips from disk.
+   * Entries are evicted in least-recently-used order once the cache exceeds its memory budget.  Only assets
+   * that support AssetData::readSubresource() are cached.
+   *
+   * Data is handed out as shared blobs, so evicting an entry never invalidates a blob that is still in use.
+   */
+  class AssetMipCache : public Singleton<AssetMipCache> {
+  public:
+    RTX_OPTION("rtx.texturemanager", uint32_t, mipCacheBudgetMiB, 0, "Amount of CPU memory used to keep texture mip data that was read from disk, so that re-promoting a texture doesn't read it again. Least recently used mips are evicted first. While enabled, DDS mips are read with buffered file reads instead of a file mapping. 0 disables the cache. In mebibytes.");
+    RTX_OPTION("rtx.texturemanager", bool, enableMipPrefetch, true, "Read the next higher resolution mip of streamed textures into the mip cache in the background, before sampler feedback requests it.");
+
+    using Blob = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Stats {
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      uint64_t prefetches = 0;
+      uint64_t evictions = 0;
+      size_t residentBytes = 0;
+      size_t budgetBytes = 0;
+    };
+
+    // 'budgetBytes' overrides the budget option, e.g. for tests
+    explicit AssetMipCache(std::optional<size_t> budgetBytes = std::nullopt);
+    ~AssetMipCache();
+
+    AssetMipCache(const AssetMipCache&) = delete;
+    AssetMipCache& operator=(const AssetMipCache&) = delete;
+
+    bool enabled() const {
+      return getBudgetBytes() > 0;
+    }
+
+    // Returns the cached data and marks it as most recently used, or nullptr on a miss.  Counts as a hit or miss.
+    Blob find(const AssetData& asset, uint32_t layer, uint32_t level);
+
+    // Takes ownership of the data, and caches it if it fits into the budget.
+    // Returns the blob in either case, so the caller can use it without a copy.
+    Blob insert(const AssetData& asset, uint32_t layer, uint32_t level, std::vector<uint8_t>&& data);
+
+    // Reads the subresource through the cache: returns the cached blob, or reads and caches it on a miss.
+    Blob load(const AssetData& asset, uint32_t layer, uint32_t level);
+
+    // Asks the background thread to read the given mips (of layer 0) into the cache, if they aren't resident yet.
+    void prefetch(const Rc<AssetData>& asset, uint32_t mipBegin, uint32_t mipEnd);
+
+    void clear();
+
+    Stats getStats() const;
+
+  private:
+    struct Entry {
+      Blob blob;
+      std::list<XXH64_hash_t>::iterator lruPosition;
+    };
+
+    struct PrefetchRequest {
+      Rc<AssetData> asset;
+      uint32_t level;
+      XXH64_hash_t key;
+    };
+
+    static XXH64_hash_t makeKey(const AssetData& asset, uint32_t layer, uint32_t level);
+
+    size_t getBudgetBytes() const;
+    // Must be called with 'm_mutex' held
+    void evictToBudget(size_t budgetBytes);
+    void prefetchLoop();
+
+    std::optional<size_t> m_budgetOverride;
+
+    mutable dxvk::mutex m_mutex;
+    std::unordered_map<XXH64_hash_t, Entry> m_entries;
+    // Most recently used at the front
+    std::list<XXH64_hash_t> m_lru;
+    size_t m_residentBytes = 0;
+
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_prefetches = 0;
+    uint64_t m_evictions = 0;
+
+    dxvk::mutex m_prefetchMutex;
+    dxvk::condition_variable m_prefetchCond;
+    std::vector<PrefetchRequest> m_prefetchQueue;
+    std::unordered_set<XXH64_hash_t> m_prefetchPending;
+    bool m_stopPrefetch = false;
+    std::unique_ptr<dxvk::thread> m_prefetchThread;
+  };
+
+} // namespace dxvk
@@ -28,6 +28,7 @@
 #include "rtx_options.h"
 #include "rtx_utils.h"
 #include "rtx_asset_data_manager.h"
+#include "../util/log/metrics_registry.h"
 
 namespace dxvk {
 
@@ -35,51 +36,142 @@ std::vector<AssetReplacement>* AssetReplacer::getReplacementsForMesh(XXH64_hash_
   if (!RtxOptions::getEnableReplacementMeshes())
     return nullptr;
 
+  static const MetricCounter s_lookups = MetricsRegistry::get().registerCounter("rtx_replacement_mesh_lookups");
+  s_lookups.add();
+
   auto variantInfo = m_variantInfos.find(hash);
 
   if (variantInfo != m_variantInfos.end()) {
     hash += variantInfo->second.selectedVariant;
   }
 
-  for (auto& mod : m_modManager.mods()) {
-    if (auto replacement = mod->replacements().get<AssetReplacement::eMesh>(hash)) {
-      return replacement;
-    }
-  }
-
-  return nullptr;
+  return m_mergedIndex.meshes.find(hash);
 }
 
 std::vector<AssetReplacement>* AssetReplacer::getReplacementsForLight(XXH64_hash_t hash) {
   if (!RtxOptions::getEnableReplacementLights())
     return nullptr;
 
-  for (auto& mod : m_modManager.mods()) {
-    if (auto replacement = mod->replacements().get<AssetReplacement::eLight>(hash)) {
-      return replacement;
-    }
-  }
-
-  return nullptr;
+  return m_mergedIndex.lights.find(hash);
 }
 
 MaterialData* AssetReplacer::getReplacementMaterial(XXH64_hash_t hash) {
   if (!RtxOptions::getEnableReplacementMaterials())
     return nullptr;
 
+  return m_mergedIndex.materials.find(hash);
+}
+
+void AssetReplacer::indexMod(uint32_t modIndex, Mod& mod) {
+  ScopedCpuProfileZone();
+  const AssetReplacements::Counts counts = mod.replacements().getNumReplacements();
+  m_mergedIndex.meshes.reserve(m_mergedIndex.meshes.entries.size() + counts.meshes);
+  m_mergedIndex.lights.reserve(m_mergedIndex.lights.entries.size() + counts.lights);
+  m_mergedIndex.materials.reserve(m_mergedIndex.materials.entries.size() + counts.materials);
+
+  mod.replacements().forEachReplacement(
+    [this, modIndex](XXH64_hash_t hash, std::vector<AssetReplacement>* replacements) {
+      m_mergedIndex.meshes.insert(modIndex, hash, replacements);
+    },
+    [this, modIndex](XXH64_hash_t hash, std::vector<AssetReplacement>* replacements) {
+      m_mergedIndex.lights.insert(modIndex, hash, replacements);
+    },
+    [this, modIndex](XXH64_hash_t hash, MaterialData* material) {
+      m_mergedIndex.materials.insert(modIndex, hash, material);
+    });
+}
+
+void AssetReplacer::unindexMod(uint32_t modIndex) {
+  ScopedCpuProfileZone();
+  std::vector<XXH64_hash_t> meshHashes;
+  std::vector<XXH64_hash_t> lightHashes;
+  std::vector<XXH64_hash_t> materialHashes;
+  m_mergedIndex.meshes.eraseMod(modIndex, meshHashes);
+  m_mergedIndex.lights.eraseMod(modIndex, lightHashes);
+  m_mergedIndex.materials.eraseMod(modIndex, materialHashes);
+
+  reindexHashes(modIndex, meshHashes, lightHashes, materialHashes);
+}
+
+void AssetReplacer::reindexHashes(uint32_t modIndex,
+                                  const std::vector<XXH64_hash_t>& meshHashes,
+                                  const std::vector<XXH64_hash_t>& lightHashes,
+                                  const std::vector<XXH64_hash_t>& materialHashes) {
+  if (meshHashes.empty() && lightHashes.empty() && materialHashes.empty()) {
+    return;
+  }
+
+  // Visiting the remaining mods in priority order and inserting whatever they have is enough, since
+  // the merged index keeps the entry of the highest priority mod.
+  uint32_t otherIndex = 0;
   for (auto& mod : m_modManager.mods()) {
-    MaterialData* material;
-    if (mod->replacements().getObject(hash, material)) {
-      return material;
+    if (otherIndex > modIndex && mod->state().progressState == Mod::ProgressState::Loaded) {
+      for (XXH64_hash_t hash : meshHashes) {
+        if (auto replacements = mod->replacements().get<AssetReplacement::eMesh>(hash)) {
+          m_mergedIndex.meshes.insert(otherIndex, hash, replacements);
+        }
+      }
+      for (XXH64_hash_t hash : lightHashes) {
+        if (auto replacements = mod->replacements().get<AssetReplacement::eLight>(hash)) {
+          m_mergedIndex.lights.insert(otherIndex, hash, replacements);
+        }
+      }
+      for (XXH64_hash_t hash : materialHashes) {
+        MaterialData* material;
+        if (mod->replacements().getObject(hash, material)) {
+          m_mergedIndex.materials.insert(otherIndex, hash, material);
+        }
+      }
     }
+    ++otherIndex;
   }
+}
 
-  return nullptr;
+void AssetReplacer::updateMergedIndex() {
+  uint32_t modIndex = 0;
+  for (auto& mod : m_modManager.mods()) {
+    if (mod->state().progressState == Mod::ProgressState::Loaded) {
+      std::vector<XXH64_hash_t> meshHashes;
+      std::vector<XXH64_hash_t> lightHashes;
+      std::vector<XXH64_hash_t> materialHashes;
+      mod->replacements().forEachChangedReplacement(
+        [&](XXH64_hash_t hash, std::vector<AssetReplacement>* replacements) {
+          if (replacements) {
+            m_mergedIndex.meshes.insert(modIndex, hash, replacements);
+          } else if (m_mergedIndex.meshes.erase(modIndex, hash)) {
+            meshHashes.push_back(hash);
+          }
+        },
+        [&](XXH64_hash_t hash, std::vector<AssetReplacement>* replacements) {
+          if (replacements) {
+            m_mergedIndex.lights.insert(modIndex, hash, replacements);
+          } else if (m_mergedIndex.lights.erase(modIndex, hash)) {
+            lightHashes.push_back(hash);
+          }
+        },
+        [&](XXH64_hash_t hash, MaterialData* material) {
+          if (material) {
+            m_mergedIndex.materials.insert(modIndex, hash, material);
+          } else if (m_mergedIndex.materials.erase(modIndex, hash)) {
+            materialHashes.push_back(hash);
+          }
+        });
+
+      // Falling back to the other mods has to wait until this mod's lock is released
+      reindexHashes(modIndex, meshHashes, lightHashes, materialHashes);
+    }
+    ++modIndex;
+  }
 }
 
 void AssetReplacer::initialize(const Rc<DxvkContext>& context) {
+  uint32_t modIndex = 0;
   for (auto& mod : m_modManager.mods()) {
     mod->load(context);
+    if (mod->state().progressState == Mod::ProgressState::Loaded) {
+      indexMod(modIndex, *mod);
+    }
+    ++modIndex;
   }
   updateSecretReplacements();
 }
@@ -88,9 +180,19 @@ bool AssetReplacer::checkForChanges(const Rc<DxvkContext>& context) {
   ScopedCpuProfileZone();
 
   bool changed = false;
+  uint32_t modIndex = 0;
   for (auto& mod : m_modManager.mods()) {
-    changed |= mod->checkForChanges(context);
+    if (mod->checkForChanges(context)) {
+      // The mod has been reloaded, so its old entries point at destroyed replacements.
+      unindexMod(modIndex);
+      if (mod->state().progressState == Mod::ProgressState::Loaded) {
+        indexMod(modIndex, *mod);
+      }
+      changed = true;
+    }
+    ++modIndex;
   }
+  updateMergedIndex();
   if (changed) {
     updateSecretReplacements();
   }
@@ -27,6 +27,7 @@
 #include "rtx_mod_manager.h"
 #include "rtx_utils.h"
 #include "rtx_lights_data.h"
+#include "../../util/util_bloom_filter.h"
 
 namespace dxvk {
   class DxvkContext;
@@ -151,6 +152,7 @@ namespace dxvk {
       std::lock_guard<sync::Spinlock> lock(m_spinlock);
       auto& map = T == AssetReplacement::eMesh ? m_meshReplacers : m_lightReplacers;
       map.emplace(hash, std::move(v));
+      (T == AssetReplacement::eMesh ? m_changedMeshes : m_changedLights).push_back(hash);
     }
 
     // Returns a pointer to the stored object of type T for a given hash value.
@@ -182,6 +184,7 @@ namespace dxvk {
     T& storeObject(XXH64_hash_t hash, T&& obj) {
       std::lock_guard<sync::Spinlock> lock(m_spinlock);
       if constexpr (std::is_same_v<T, MaterialData>) {
+        m_changedMaterials.push_back(hash);
         return m_materials.try_emplace(hash, std::move(obj)).first->second;
       } else if constexpr (std::is_same_v<T, MeshReplacement>) {
         return m_geometries.try_emplace(hash, std::move(obj)).first->second;
@@ -200,6 +203,7 @@ namespace dxvk {
       std::lock_guard<sync::Spinlock> lock(m_spinlock);
       if constexpr (std::is_same_v<T, MaterialData>) {
         m_materials.erase(hash);
+        m_changedMaterials.push_back(hash);
       } else if constexpr (std::is_same_v<T, MeshReplacement>) {
         m_geometries.erase(hash);
       } else if constexpr (std::is_same_v<T, RtGraphTopology>) {
@@ -220,6 +224,62 @@ namespace dxvk {
       m_geometries.clear();
       m_graphTopologies.clear();
       m_secretReplacements.clear();
+      m_changedMeshes.clear();
+      m_changedLights.clear();
+      m_changedMaterials.clear();
+    }
+
+    struct Counts {
+      size_t meshes;
+      size_t lights;
+      size_t materials;
+    };
+
+    Counts getNumReplacements() const {
+      std::lock_guard<sync::Spinlock> lock(m_spinlock);
+      return Counts { m_meshReplacers.size(), m_lightReplacers.size(), m_materials.size() };
+    }
+
+    // Calls the given functions for every mesh replacement list, light replacement list and material.
+    // Since every entry is visited, the pending changes are dropped as well.
+    // The spinlock is held for the duration, so the callbacks must not call back into this object.
+    template<typename MeshFn, typename LightFn, typename MaterialFn>
+    void forEachReplacement(MeshFn&& onMesh, LightFn&& onLight, MaterialFn&& onMaterial) {
+      std::lock_guard<sync::Spinlock> lock(m_spinlock);
+      for (auto& [hash, replacements] : m_meshReplacers) {
+        onMesh(hash, &replacements);
+      }
+      for (auto& [hash, replacements] : m_lightReplacers) {
+        onLight(hash, &replacements);
+      }
+      for (auto& [hash, material] : m_materials) {
+        onMaterial(hash, &material);
+      }
+      m_changedMeshes.clear();
+      m_changedLights.clear();
+      m_changedMaterials.clear();
+    }
+
+    // Same as forEachReplacement, but only for the entries added or removed since the last call to either
+    // function.  Removed entries are passed as a nullptr.
+    template<typename MeshFn, typename LightFn, typename MaterialFn>
+    void forEachChangedReplacement(MeshFn&& onMesh, LightFn&& onLight, MaterialFn&& onMaterial) {
+      std::lock_guard<sync::Spinlock> lock(m_spinlock);
+      for (XXH64_hash_t hash : m_changedMeshes) {
+        auto it = m_meshReplacers.find(hash);
+        onMesh(hash, it != m_meshReplacers.end() ? &it->second : nullptr);
+      }
+      for (XXH64_hash_t hash : m_changedLights) {
+        auto it = m_lightReplacers.find(hash);
+        onLight(hash, it != m_lightReplacers.end() ? &it->second : nullptr);
+      }
+      for (XXH64_hash_t hash : m_changedMaterials) {
+        auto it = m_materials.find(hash);
+        onMaterial(hash, it != m_materials.end() ? &it->second : nullptr);
+      }
+      m_changedMeshes.clear();
+      m_changedLights.clear();
+      m_changedMaterials.clear();
     }
 
     const SecretReplacements& secretReplacements() const {
@@ -229,6 +289,12 @@ namespace dxvk {
   private:
     mutable sync::Spinlock m_spinlock;
 
+    // Hashes of the replacements and materials added or removed since they were last visited by
+    // forEachReplacement or forEachChangedReplacement.  Used to keep AssetReplacer's merged index up to date.
+    std::vector<XXH64_hash_t> m_changedMeshes;
+    std::vector<XXH64_hash_t> m_changedLights;
+    std::vector<XXH64_hash_t> m_changedMaterials;
+
     // Replacements ready to be fed to the renderer
     fast_unordered_cache<std::vector<AssetReplacement>> m_meshReplacers;
     fast_unordered_cache<std::vector<AssetReplacement>> m_lightReplacers;
@@ -291,6 +357,112 @@ namespace dxvk {
   private:
     void updateSecretReplacements();
 
+    // Adds all replacements of a loaded mod to m_mergedIndex.
+    void indexMod(uint32_t modIndex, Mod& mod);
+    // Removes all replacements of a mod from m_mergedIndex, falling back to lower priority mods where they have
+    // a replacement for the same hash.
+    void unindexMod(uint32_t modIndex);
+    // Applies the replacements added to or removed from loaded mods since they were last indexed.
+    void updateMergedIndex();
+    // Re-resolves hashes whose entries from the given mod were removed, using the loaded mods after it.
+    void reindexHashes(uint32_t modIndex,
+                       const std::vector<XXH64_hash_t>& meshHashes,
+                       const std::vector<XXH64_hash_t>& lightHashes,
+                       const std::vector<XXH64_hash_t>& materialHashes);
+
+    // A hash map from replacement hash to the highest priority mod's entry, behind a bloom filter.
+    // Mod priority is the position of the mod in ModManager::mods(), so a lower index wins.
+    template<typename T>
+    struct MergedIndexMap {
+      struct Entry {
+        uint32_t modIndex;
+        T* value;
+      };
+
+      fast_unordered_cache<Entry> entries;
+      HashBloomFilter filter;
+      size_t filterCapacity = 0;
+
+      T* find(XXH64_hash_t hash) const {
+        if (!filter.mayContain(hash)) {
+          return nullptr;
+        }
+        auto it = entries.find(hash);
+        return it != entries.end() ? it->second.value : nullptr;
+      }
+
+      void reserve(size_t count) {
+        entries.reserve(count);
+        growFilter(count);
+      }
+
+      void insert(uint32_t modIndex, XXH64_hash_t hash, T* value) {
+        auto [it, inserted] = entries.try_emplace(hash, Entry { modIndex, value });
+        if (!inserted) {
+          if (it->second.modIndex < modIndex) {
+            return;
+          }
+          it->second = Entry { modIndex, value };
+        }
+        if (entries.size() > filterCapacity) {
+          growFilter(entries.size());
+        } else {
+          filter.insert(hash);
+        }
+      }
+
+      // Returns true if the entry for the hash belonged to the given mod and was removed.  The filter keeps
+      // the removed hash, which only costs a map lookup on a false positive.
+      bool erase(uint32_t modIndex, XXH64_hash_t hash) {
+        auto it = entries.find(hash);
+        if (it == entries.end() || it->second.modIndex != modIndex) {
+          return false;
+        }
+        entries.erase(it);
+        return true;
+      }
+
+      void eraseMod(uint32_t modIndex, std::vector<XXH64_hash_t>& erasedHashes) {
+        for (auto it = entries.begin(); it != entries.end();) {
+          if (it->second.modIndex == modIndex) {
+            erasedHashes.push_back(it->first);
+            it = entries.erase(it);
+          } else {
+            ++it;
+          }
+        }
+      }
+
+    private:
+      void growFilter(size_t count) {
+        if (count <= filterCapacity) {
+          return;
+        }
+        // Double the capacity so a mod streaming in replacements one at a time only rebuilds the filter
+        // a logarithmic number of times.
+        filterCapacity = std::max(count, filterCapacity * 2);
+        filter.reset(filterCapacity);
+        for (const auto& [hash, entry] : entries) {
+          filter.insert(hash);
+        }
+      }
+    };
+
+    // Replacements of all loaded mods merged into a single set of maps, with mod priority already resolved,
+    // so lookups don't need to visit (and lock) every mod.  Each map sits behind a bloom filter because the
+    // vast majority of lookups are for hashes that have no replacement.
+    // The index is only modified from initialize() and checkForChanges(), which run on the same thread as the
+    // lookups: mods are indexed right after they load and removed when they unload, and replacements a mod
+    // adds afterwards (e.g. meshes waiting on their upload) are picked up once per frame from the mod's list
+    // of changes, which is read under the mod's replacement lock.  Mods that are not loaded are skipped.
+    struct MergedReplacementIndex {
+      MergedIndexMap<std::vector<AssetReplacement>> meshes;
+      MergedIndexMap<std::vector<AssetReplacement>> lights;
+      MergedIndexMap<MaterialData> materials;
+    };
+
+    MergedReplacementIndex m_mergedIndex;
+
     bool m_bSecretReplacementsUpdated = false;
 
     struct VariantInfo {
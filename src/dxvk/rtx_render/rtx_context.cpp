@@ -829,6 +829,14 @@ namespace dxvk {
     Metrics::logRollingAverage(Metric::dxvk_sys_memory_usage_mb, static_cast<float>(sysUsageMib)); // In MB
     Metrics::logFloat(Metric::dxvk_total_time_ms, static_cast<float>(GlobalTime::get().realTimeSinceStartMs()));
     Metrics::logFloat(Metric::dxvk_frame_count, static_cast<float>(m_device->getCurrentFrameId()));
+
+    // Per-frame distributions, merged from all threads once the frame is done
+    static const MetricHistogramRecorder s_frameTime = MetricsRegistry::get().registerHistogram("dxvk_frame_time_ms");
+    static const MetricHistogramRecorder s_gpuIdleTime = MetricsRegistry::get().registerHistogram("dxvk_gpu_idle_time_ms");
+    s_frameTime.record(GlobalTime::get().deltaTimeMs());
+    s_gpuIdleTime.record(gpuIdleTimeMilliseconds);
+
+    MetricsRegistry::get().endFrame();
   }
 
   void RtxContext::setConstantBuffers(const uint32_t vsFixedFunctionConstants, const uint32_t psSharedStateConstants, Rc<DxvkBuffer> vertexCaptureCB) {
@@ -846,6 +854,9 @@ namespace dxvk {
   void RtxContext::commitGeometryToRT(const DrawParameters& params, DrawCallState& drawCallState){
     ScopedCpuProfileZone();
 
+    static const MetricCounter s_drawCallsProcessed = MetricsRegistry::get().registerCounter("rtx_draw_calls_processed");
+    s_drawCallsProcessed.add();
+
     RasterGeometry& geoData = drawCallState.geometryData;
     DrawCallTransforms& transformData = drawCallState.transformData;
 
@@ -20,6 +20,7 @@
 * DEALINGS IN THE SOFTWARE.
 */
 
+
 #include "rtx_file_watch.h"
 
 #include "dxvk_device.h"
@@ -30,6 +31,13 @@
 
 #include "rtx_options.h"
 
+#ifdef __linux__
+#include <limits.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
 
 namespace {
 
@@ -74,24 +82,445 @@ namespace {
   };
 
 
+  // last observed state of a file, to detect changes when OS events are not available (or were lost)
+  struct FileStamp {
+    std::filesystem::file_time_type writeTime{};
+    uintmax_t size{};
+    bool exists{};
+
+    bool operator==(const FileStamp& other) const {
+      return writeTime == other.writeTime && size == other.size && exists == other.exists;
+    }
+    bool operator!=(const FileStamp& other) const {
+      return !(*this == other);
+    }
+  };
+
+
+  FileStamp readFileStamp(const std::filesystem::path& filepath) {
+    // NOTE: using error_code to avoid exceptions
+    std::error_code errorCodeTime{};
+    std::error_code errorCodeSize{};
+    FileStamp stamp{};
+    stamp.writeTime = std::filesystem::last_write_time(filepath, errorCodeTime);
+    stamp.size = std::filesystem::file_size(filepath, errorCodeSize);
+    stamp.exists = !errorCodeTime && !errorCodeSize;
+    if (!stamp.exists) {
+      return FileStamp{};
+    }
+    return stamp;
+  }
+
+
   struct WatchFile {
     // a single file can correspond to N managed textures
     std::vector<dxvk::Rc<dxvk::ManagedTexture>> texturesReferencingFile{};
+    FileStamp stamp{};
   };
 
 
   struct WatchDir {
     std::filesystem::path dirpath{};
-    HANDLE dirHandle{};
-    HANDLE watchEvent{};
     // files in this directory
     std::unordered_map<std::filesystem::path, WatchFile, CanonicalPathHash> files{};
+  };
+
 
-    // stable pointers for async ReadDirectoryChanges calls, as WinAPI can populate them at any moment
-    std::vector<uint8_t> nextChangesBuffer{};
-    // status about IO request
-    std::unique_ptr<OVERLAPPED> nextOverlapped{};
+  // Events reported by a backend after a single wait
+  struct FileWatchEvents {
+    // absolute, lexically normalized paths of the files that were reported as changed
+    std::vector<std::filesystem::path> changedFiles{};
+    // directories which need to be rescanned, because the backend can't report
+    // individual files (polling), or because the OS dropped events (buffer overflow)
+    std::vector<std::filesystem::path> rescanDirs{};
+
+    void clear() {
+      changedFiles.clear();
+      rescanDirs.clear();
+    }
   };
+
+
+  // OS-specific source of directory change notifications.
+  // Only the filewatch thread calls into a backend.
+  class FileWatchBackend {
+  public:
+    virtual ~FileWatchBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    // starts watching a directory and its subtree, returns false if the OS refused the watch
+    virtual bool addDir(const std::filesystem::path& dirpath) = 0;
+    virtual void removeAllDirs() = 0;
+
+    // blocks for at most 'timeoutMs' waiting for changes, and appends them to 'events'
+    virtual void wait(uint32_t timeoutMs, FileWatchEvents& events) = 0;
+  };
+
+
+  // Fallback for platforms / filesystems without change notifications (e.g. network shares):
+  // every wait asks for a rescan of all directories, and changes are detected by comparing file stamps.
+  class PollingFileWatchBackend final : public FileWatchBackend {
+  public:
+    const char* name() const override {
+      return "polling";
+    }
+
+    bool addDir(const std::filesystem::path& dirpath) override {
+      m_dirs.push_back(dirpath);
+      return true;
+    }
+
+    void removeAllDirs() override {
+      m_dirs.clear();
+    }
+
+    void wait(uint32_t timeoutMs, FileWatchEvents& events) override {
+      std::this_thread::sleep_for(std::chrono::milliseconds { timeoutMs });
+      events.rescanDirs.insert(events.rescanDirs.end(), m_dirs.begin(), m_dirs.end());
+    }
+
+  private:
+    std::vector<std::filesystem::path> m_dirs{};
+  };
+
+
+#ifdef _WIN32
+  // large enough to hold a burst of notifications, e.g. an export tool writing hundreds of files at once;
+  // if the buffer still overflows, the directory is rescanned
+  constexpr uint32_t READ_CHANGES_BUF_SIZE = 64 * 1024;
+
+
+  class Win32FileWatchBackend final : public FileWatchBackend {
+  public:
+    ~Win32FileWatchBackend() override {
+      removeAllDirs();
+    }
+
+    const char* name() const override {
+      return "ReadDirectoryChangesW";
+    }
+
+    // open a handle to the directory,
+    // and create a new event to track changes that directory
+    bool addDir(const std::filesystem::path& dirpath) override {
+      HANDLE dirHandle = CreateFileW(
+        dirpath.c_str(),
+        FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL,
+        OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+        NULL
+      );
+      if (dirHandle == INVALID_HANDLE_VALUE) {
+        dxvk::Logger::err(dxvk::str::format("Failed to open directory watch for: ", dirpath.string()));
+        return false;
+      }
+
+      HANDLE watchEvent = CreateEvent(NULL, FALSE, 0, NULL);
+      if (watchEvent == NULL) {
+        CloseHandle(dirHandle);
+        dxvk::Logger::err(dxvk::str::format("Failed to create watch event for: ", dirpath.string()));
+        return false;
+      }
+
+      auto dir = std::make_unique<Dir>();
+      {
+        dir->dirpath = dirpath;
+        dir->dirHandle = dirHandle;
+        dir->watchEvent = watchEvent;
+        dir->changesBuffer.resize(READ_CHANGES_BUF_SIZE);
+      }
+
+      // start-up the first ReadDirectoryChanges call
+      if (!issueRead(*dir)) {
+        dxvk::Logger::err(dxvk::str::format("Initial ReadDirectoryChangesW failed: ", dirpath.string()));
+        closeDir(*dir);
+        return false;
+      }
+
+      m_dirs.push_back(std::move(dir));
+      return true;
+    }
+
+    void removeAllDirs() override {
+      for (auto& dir : m_dirs) {
+        closeDir(*dir);
+      }
+      m_dirs.clear();
+    }
+
+    void wait(uint32_t timeoutMs, FileWatchEvents& events) override {
+      if (m_dirs.empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds { timeoutMs });
+        return;
+      }
+
+      // block until any of the directories has pending changes
+      // NOTE: only the first MAXIMUM_WAIT_OBJECTS directories can wake the thread up,
+      //       the rest are still drained below, at most 'timeoutMs' late
+      {
+        HANDLE waitEvents[MAXIMUM_WAIT_OBJECTS];
+        const DWORD waitCount = DWORD(std::min<size_t>(m_dirs.size(), MAXIMUM_WAIT_OBJECTS));
+        for (DWORD i = 0; i < waitCount; i++) {
+          waitEvents[i] = m_dirs[i]->watchEvent;
+        }
+        WaitForMultipleObjects(waitCount, waitEvents, FALSE, timeoutMs);
+      }
+
+      // drain every directory whose request has completed, not only the one that woke us up
+      for (auto& dir : m_dirs) {
+        if (!HasOverlappedIoCompleted(&dir->overlapped)) {
+          continue;
+        }
+
+        DWORD bytesTransferred = 0;
+        const BOOL resultGetOverlapped = GetOverlappedResult(
+          dir->dirHandle,
+          &dir->overlapped,
+          &bytesTransferred,
+          false // the request has already completed
+        );
+
+        // 'changesBuf' now contains the directory changes, and 'changesBuffer' will be populated by the next
+        // ReadDirectoryChanges; scheduling it immediately after 'GetOverlappedResult' to not lose any events in-between
+        std::swap(dir->changesBuffer, m_parseBuffer);
+        dir->changesBuffer.resize(READ_CHANGES_BUF_SIZE);
+        const bool resultReadDir = issueRead(*dir);
+
+        if (!resultGetOverlapped) {
+          dxvk::Logger::err(dxvk::str::format("GetOverlappedResult failed: ", dir->dirpath.string()));
+          events.rescanDirs.push_back(dir->dirpath);
+        } else if (bytesTransferred == 0) {
+          // the OS couldn't fit all changes into the buffer, and dropped them
+          dxvk::Logger::warn(dxvk::str::format("filewatch: change notifications overflowed, rescanning: ", dir->dirpath.string()));
+          events.rescanDirs.push_back(dir->dirpath);
+        } else {
+          parseNotifications(dir->dirpath, m_parseBuffer, bytesTransferred, events);
+        }
+
+        if (!resultReadDir) {
+          dxvk::Logger::err(dxvk::str::format("ReadDirectoryChangesW failed: ", dir->dirpath.string()));
+        }
+      }
+    }
+
+  private:
+    struct Dir {
+      std::filesystem::path dirpath{};
+      HANDLE dirHandle{};
+      HANDLE watchEvent{};
+      // stable pointers for async ReadDirectoryChanges calls, as WinAPI can populate them at any moment
+      std::vector<uint8_t> changesBuffer{};
+      // status about IO request
+      OVERLAPPED overlapped{};
+    };
+
+    static bool issueRead(Dir& dir) {
+      assert(dir.changesBuffer.size() == READ_CHANGES_BUF_SIZE);
+      // prepare OVERLAPPED structure for the next ReadDirectoryChanges call
+      dir.overlapped = OVERLAPPED{};
+      dir.overlapped.hEvent = dir.watchEvent;
+      return ReadDirectoryChangesW(
+        dir.dirHandle,
+        dir.changesBuffer.data(),
+        DWORD(dir.changesBuffer.size()),
+        TRUE, // check subtrees too
+        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE
+          | FILE_NOTIFY_CHANGE_CREATION,
+        NULL,
+        &dir.overlapped,
+        NULL
+      );
+    }
+
+    static void closeDir(Dir& dir) {
+      if (dir.dirHandle) {
+        // cancel the pending request, and wait for it, as the OS still holds pointers to 'changesBuffer'
+        if (CancelIoEx(dir.dirHandle, &dir.overlapped)) {
+          DWORD ignoredBytesTransferred;
+          GetOverlappedResult(dir.dirHandle, &dir.overlapped, &ignoredBytesTransferred, TRUE);
+        }
+        CloseHandle(dir.dirHandle);
+        dir.dirHandle = NULL;
+      }
+      if (dir.watchEvent != NULL) {
+        CloseHandle(dir.watchEvent);
+        dir.watchEvent = NULL;
+      }
+    }
+
+    static void parseNotifications(
+      const std::filesystem::path& dirpath,
+      const std::vector<uint8_t>& changesBuf,
+      DWORD bytesTransferred,
+      FileWatchEvents& events
+    ) {
+      const uint8_t* entry = changesBuf.data();
+      const uint8_t* end = changesBuf.data() + std::min<size_t>(bytesTransferred, changesBuf.size());
+
+      // loop through entries in fileNotify
+      while (entry + sizeof(FILE_NOTIFY_INFORMATION) <= end) {
+        const auto* fileNotify = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(entry);
+
+        if (fileNotify->Action != FILE_ACTION_REMOVED && fileNotify->Action != FILE_ACTION_RENAMED_OLD_NAME) {
+          // sanitize paths given by FILE_NOTIFY_INFORMATION
+          auto filename = std::filesystem::path {
+            std::wstring { fileNotify->FileName, size_t(fileNotify->FileNameLength / sizeof(wchar_t)) }
+          };
+          if (!filename.empty()) {
+            events.changedFiles.push_back(makeCanonicalPathLexical(dirpath / filename)); // compose absolute path
+          }
+        }
+
+        if (!fileNotify->NextEntryOffset) {
+          break; // no more entries
+        }
+        entry += fileNotify->NextEntryOffset;
+      }
+    }
+
+    std::vector<std::unique_ptr<Dir>> m_dirs{};
+    std::vector<uint8_t> m_parseBuffer{};
+  };
+#endif // _WIN32
+
+
+#ifdef __linux__
+  // inotify watches are not recursive, so each directory of the subtree gets its own watch descriptor
+  class InotifyFileWatchBackend final : public FileWatchBackend {
+  public:
+    InotifyFileWatchBackend() {
+      m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      if (m_fd < 0) {
+        dxvk::Logger::err("filewatch: inotify_init1 failed");
+      }
+      m_readBuffer.resize(64 * 1024);
+    }
+
+    ~InotifyFileWatchBackend() override {
+      removeAllDirs();
+      if (m_fd >= 0) {
+        close(m_fd);
+      }
+    }
+
+    const char* name() const override {
+      return "inotify";
+    }
+
+    bool addDir(const std::filesystem::path& dirpath) override {
+      if (m_fd < 0) {
+        return false;
+      }
+      if (!addSingleDir(dirpath)) {
+        return false;
+      }
+      // NOTE: using error_code to avoid exceptions
+      std::error_code errorCodeIterate{};
+      for (auto it = std::filesystem::recursive_directory_iterator(dirpath, errorCodeIterate);
+           it != std::filesystem::recursive_directory_iterator(); it.increment(errorCodeIterate)) {
+        if (errorCodeIterate) {
+          break;
+        }
+        std::error_code ignoredErrorCode{};
+        if (it->is_directory(ignoredErrorCode)) {
+          if (!addSingleDir(it->path())) {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+    void removeAllDirs() override {
+      for (const auto& [wd, path] : m_watchDescriptors) {
+        inotify_rm_watch(m_fd, wd);
+      }
+      m_watchDescriptors.clear();
+    }
+
+    void wait(uint32_t timeoutMs, FileWatchEvents& events) override {
+      if (m_fd < 0 || m_watchDescriptors.empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds { timeoutMs });
+        return;
+      }
+
+      pollfd pfd { m_fd, POLLIN, 0 };
+      if (poll(&pfd, 1, int(timeoutMs)) <= 0) {
+        return;
+      }
+
+      // drain everything the kernel has queued, as a burst may take more than one read
+      while (true) {
+        const ssize_t bytesRead = read(m_fd, m_readBuffer.data(), m_readBuffer.size());
+        if (bytesRead <= 0) {
+          break;
+        }
+
+        for (size_t offset = 0; offset + sizeof(inotify_event) <= size_t(bytesRead);) {
+          const auto* ev = reinterpret_cast<const inotify_event*>(m_readBuffer.data() + offset);
+          offset += sizeof(inotify_event) + ev->len;
+
+          if (ev->mask & IN_Q_OVERFLOW) {
+            dxvk::Logger::warn("filewatch: inotify queue overflowed, rescanning all directories");
+            for (const auto& [wd, path] : m_watchDescriptors) {
+              events.rescanDirs.push_back(path);
+            }
+            continue;
+          }
+
+          auto dirIt = m_watchDescriptors.find(ev->wd);
+          if (dirIt == m_watchDescriptors.end() || ev->len == 0) {
+            continue;
+          }
+          const std::filesystem::path changedPath = makeCanonicalPathLexical(dirIt->second / ev->name);
+
+          if (ev->mask & IN_ISDIR) {
+            // a new subdirectory appeared: watch it too, and pick up files that were created before the watch
+            if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+              addDir(changedPath);
+              events.rescanDirs.push_back(changedPath);
+            }
+            continue;
+          }
+          events.changedFiles.push_back(changedPath);
+        }
+      }
+    }
+
+  private:
+    bool addSingleDir(const std::filesystem::path& dirpath) {
+      const int wd = inotify_add_watch(m_fd, dirpath.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_MOVED_TO);
+      if (wd < 0) {
+        // usually, the per-user limit of watches (fs.inotify.max_user_watches) has been reached
+        dxvk::Logger::err(dxvk::str::format("filewatch: inotify_add_watch failed (errno=", errno, "): ", dirpath.string()));
+        return false;
+      }
+      m_watchDescriptors[wd] = dirpath;
+      return true;
+    }
+
+    int m_fd = -1;
+    std::unordered_map<int, std::filesystem::path> m_watchDescriptors{};
+    std::vector<uint8_t> m_readBuffer{};
+  };
+#endif // __linux__
+
+
+  std::unique_ptr<FileWatchBackend> createFileWatchBackend() {
+    if (dxvk::RtxOptions::TextureManager::hotReloadPolling()) {
+      return std::make_unique<PollingFileWatchBackend>();
+    }
+#if defined(_WIN32)
+    return std::make_unique<Win32FileWatchBackend>();
+#elif defined(__linux__)
+    return std::make_unique<InotifyFileWatchBackend>();
+#else
+    return std::make_unique<PollingFileWatchBackend>();
+#endif
+  }
 } // namespace
 
 
@@ -110,83 +539,16 @@ namespace dxvk {
     std::mutex m_requestsMutex{};
 
     // NOTE: 'm_dirs' list is modified only by the filewatch thread, other threads use requests
-    //        this is needed to prevent hanging pointers while ReadDirectoryChanges is waiting for the OS
     std::vector<WatchDir> m_dirs{};
 
+    std::unique_ptr<FileWatchBackend> m_backend{};
+
     std::atomic_bool m_stop{};
   };
 } // namespace dxvk
 
 
 namespace {
-  constexpr uint32_t READ_CHANGES_BUF_SIZE = 1024;
-
-
-  BOOL readDirectoryChangesWrapper(
-    HANDLE hDirectory,
-    std::vector<uint8_t>& changesBuffer,
-    const std::unique_ptr<OVERLAPPED>& overlapped // IO status
-  ) {
-    assert(changesBuffer.size() == READ_CHANGES_BUF_SIZE);
-    return ReadDirectoryChangesW(
-      hDirectory,
-      changesBuffer.data(),
-      changesBuffer.size(),
-      TRUE, // check subtrees too
-      FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE
-        | FILE_NOTIFY_CHANGE_CREATION,
-      NULL,
-      overlapped.get(),
-      NULL
-    );
-  }
-
-
-  // open a handle to the directory,
-  // and create a new event to track changes that directory
-  WatchDir openDir(const std::filesystem::path& dirpath) {
-    HANDLE dirHandle = CreateFileW(
-      dirpath.c_str(),
-      FILE_LIST_DIRECTORY,
-      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
-      NULL,
-      OPEN_EXISTING,
-      FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
-      NULL
-    );
-    if (dirHandle == INVALID_HANDLE_VALUE) {
-      dxvk::Logger::err(dxvk::str::format("Failed to open directory watch for: ", dirpath.string()));
-      return {};
-    }
-
-    HANDLE watchEvent = CreateEvent(NULL, FALSE, 0, NULL);
-    if (watchEvent == NULL) {
-      CloseHandle(dirHandle);
-      dxvk::Logger::err(dxvk::str::format("Failed to create watch event for: ", dirpath.string()));
-      return {};
-    }
-
-    WatchDir dir{};
-    {
-      dir.dirpath = dirpath;
-      dir.dirHandle = dirHandle;
-      dir.watchEvent = watchEvent;
-      dir.nextChangesBuffer.resize(READ_CHANGES_BUF_SIZE);
-      dir.nextOverlapped = std::make_unique<OVERLAPPED>();
-    }
-
-    // start-up the first ReadDirectoryChanges call
-    dir.nextOverlapped->hEvent = dir.watchEvent;
-    BOOL resultReadDir = readDirectoryChangesWrapper(dir.dirHandle, dir.nextChangesBuffer, dir.nextOverlapped);
-    if (!resultReadDir) {
-      dxvk::Logger::
-        err(dxvk::str::format("Initial ReadDirectoryChangesW failed (", int(resultReadDir), "): ", dirpath.string()));
-    }
-
-    return dir;
-  }
-
-
   void filewatchInstallDir(dxvk::FileWatchTexturesImpl& watch, std::filesystem::path dirpath) {
     dirpath = makeCanonicalPath(dirpath);
 
@@ -260,22 +622,40 @@ namespace {
       if (texturePathRelativeToDirectory.empty()) {
         continue;
       }
-      // if a texture path does NOT contain '..', then it's a child of the directory
-      bool isTexturePathInSubtreeOfDir = texturePathRelativeToDirectory.native().find(L"..") == std::wstring::npos;
+      // if a texture path does NOT start with '..', then it's a child of the directory
+      bool isTexturePathInSubtreeOfDir = *texturePathRelativeToDirectory.begin() != "..";
       if (!isTexturePathInSubtreeOfDir) {
         continue;
       }
       // found a WatchDir, subtree of which contains the file
       return &potentialParentDir;
     }
+    return nullptr;
+  }
+
 
-    dxvk::Logger::warn(
-      dxvk::str::format("filewatch: can't add file: file is not in any of watched directories: ", filepath.string())
-    );
+  WatchFile* findWatchFile(dxvk::FileWatchTexturesImpl& watch, const std::filesystem::path& filepath) {
+    for (WatchDir& dir : watch.m_dirs) {
+      auto f = dir.files.find(filepath);
+      if (f != dir.files.end()) {
+        return &f->second;
+      }
+    }
     return nullptr;
   }
 
 
+  // the event backend couldn't watch a directory, so continue with polling for all of them
+  void switchToPollingBackend(dxvk::FileWatchTexturesImpl& watch) {
+    dxvk::Logger::warn(dxvk::str::format(
+      "filewatch: '", watch.m_backend->name(), "' backend failed to watch a directory, falling back to polling"));
+    watch.m_backend = std::make_unique<PollingFileWatchBackend>();
+    for (const WatchDir& dir : watch.m_dirs) {
+      watch.m_backend->addDir(dir.dirpath);
+    }
+  }
+
+
   void processRequests(
     dxvk::FileWatchTexturesImpl& watch,
     const std::unique_lock<std::mutex>& lockedRequests // pass for safety
@@ -288,27 +668,19 @@ namespace {
       if (auto* dirpathToAdd = std::get_if<std::filesystem::path>(&req)) {
         // do not install the same directory
         if (!directoryAlreadyInstalled(watch, *dirpathToAdd)) {
-          // open WinAPI handle
-          WatchDir newDir = openDir(*dirpathToAdd);
-          if (newDir.dirHandle && newDir.watchEvent) {
-            watch.m_dirs.push_back(std::move(newDir));
-            dxvk::Logger::info(dxvk::str::format("filewatch: installed directory watch for: ", dirpathToAdd->string()));
+          if (!watch.m_backend->addDir(*dirpathToAdd)) {
+            switchToPollingBackend(watch);
+            watch.m_backend->addDir(*dirpathToAdd);
           }
+          watch.m_dirs.push_back(WatchDir { *dirpathToAdd });
+          dxvk::Logger::info(dxvk::str::format(
+            "filewatch: installed directory watch (", watch.m_backend->name(), ") for: ", dirpathToAdd->string()));
         }
         continue;
       }
 
       if (auto* needToRemoveAllDirs = std::get_if<dxvk::RemoveAllRequest>(&req)) {
-        for (auto& dir : watch.m_dirs) {
-          if (dir.dirHandle) {
-            CloseHandle(dir.dirHandle);
-            dir.dirHandle = NULL;
-          }
-          if (dir.watchEvent != NULL) {
-            CloseHandle(dir.watchEvent);
-            dir.watchEvent = NULL;
-          }
-        }
+        watch.m_backend->removeAllDirs();
         watch.m_dirs.clear();
         dxvk::Logger::info("filewatch: uninstalled all directory watches");
         continue;
@@ -321,7 +693,14 @@ namespace {
             // a single texture file may be referenced by multiple ManagedTexture-s,
             // so keep a list: and if the file changes, reload all ManagedTexture-s that reference it
             // NOTE: creates a new entry if doesn't exists
-            parentDir->files[filepath].texturesReferencingFile.push_back(textureToAdd->tex);
+            WatchFile& watchFile = parentDir->files[filepath];
+            if (watchFile.texturesReferencingFile.empty()) {
+              watchFile.stamp = readFileStamp(filepath);
+            }
+            watchFile.texturesReferencingFile.push_back(textureToAdd->tex);
+          } else {
+            dxvk::Logger::warn(dxvk::str::format(
+              "filewatch: can't add file: file is not in any of watched directories: ", filepath.string()));
           }
         }
         continue;
@@ -333,149 +712,170 @@ namespace {
   }
 
 
+  // compare the stamps of all watched files under 'dirpath', and queue the ones that have changed
+  void rescanDir(
+    dxvk::FileWatchTexturesImpl& watch,
+    const std::filesystem::path& dirpath,
+    dxvk::FileChangeCoalescer& coalescer,
+    dxvk::FileChangeCoalescer::Clock::time_point now
+  ) {
+    for (WatchDir& dir : watch.m_dirs) {
+      for (auto& [filepath, watchFile] : dir.files) {
+        auto relative = filepath.lexically_relative(dirpath);
+        if (relative.empty() || *relative.begin() == "..") {
+          continue;
+        }
+        FileStamp stamp = readFileStamp(filepath);
+        if (stamp != watchFile.stamp) {
+          watchFile.stamp = stamp;
+          coalescer.push(filepath, now);
+        }
+      }
+    }
+  }
+
+
+  // hand a whole batch of changed files to the texture manager at once,
+  // so that they are picked up by a single 'processAllHotReloadRequests' pass
+  void requestReloadBatch(
+    dxvk::FileWatchTexturesImpl& watch,
+    dxvk::RtxTextureManager* texmanager,
+    const std::vector<std::filesystem::path>& changedFiles,
+    size_t notificationCount
+  ) {
+    std::unordered_set<dxvk::Rc<dxvk::ManagedTexture>, RcManagedTextureHash> uniqueTextures{};
+    std::vector<dxvk::Rc<dxvk::ManagedTexture>> texturesToReload{};
+
+    for (const auto& filepath : changedFiles) {
+      WatchFile* watchFile = findWatchFile(watch, filepath);
+      if (!watchFile) {
+        continue;
+      }
+      // remember the state the reload will observe, so that a later rescan doesn't report the same change again
+      watchFile->stamp = readFileStamp(filepath);
+      for (const auto& tex : watchFile->texturesReferencingFile) {
+        if (uniqueTextures.insert(tex).second) {
+          texturesToReload.push_back(tex);
+        }
+      }
+    }
+
+    if (texturesToReload.empty()) {
+      return;
+    }
+
+    dxvk::Logger::info(dxvk::str::format(
+      "filewatch: ",
+      changedFiles.size(),
+      " files changed (",
+      notificationCount,
+      " notifications), reloading ",
+      texturesToReload.size(),
+      " managed textures"
+    ));
+    texmanager->requestHotReload(texturesToReload);
+  }
+
+
   void filewatchThreadFunc(dxvk::FileWatchTexturesImpl& watch, dxvk::RtxTextureManager* texmanager) {
     dxvk::env::setThreadName("rtx-texture-filewatch");
 
-    const DWORD WaitIntervalMS = std::clamp(dxvk::RtxOptions::TextureManager::hotReloadRateMs(), 10U, 10'000U);
+    using namespace std::chrono;
 
-    uint32_t currentdir = 0;
+    const uint32_t WaitIntervalMS = std::clamp(dxvk::RtxOptions::TextureManager::hotReloadRateMs(), 10U, 10'000U);
+    const milliseconds quietPeriod { std::min(dxvk::RtxOptions::TextureManager::hotReloadDebounceMs(), 10'000U) };
 
-    while (!watch.m_stop.load()) {
-      // loop through each directory watcher
-      currentdir++;
+    // if a file keeps changing without a pause, still reload it every few quiet periods
+    dxvk::FileChangeCoalescer coalescer { quietPeriod, std::max(quietPeriod * 8, milliseconds { WaitIntervalMS }) };
+
+    FileWatchEvents events{};
 
-      // NOTE: we can hold a pointer to 'm_dirs' item, since only this thread modifies 'm_dirs' list
-      WatchDir* watchDir = nullptr;
+    while (!watch.m_stop.load()) {
+      // NOTE: 'm_dirs' list is modified only by this thread, so it can be used without the lock afterwards
       {
         auto lockRequests = std::unique_lock(watch.m_requestsMutex);
-
         processRequests(watch, lockRequests);
-
-        if (!watch.m_dirs.empty()) {
-          currentdir %= uint32_t(watch.m_dirs.size());
-          watchDir = &watch.m_dirs[currentdir];
-        }
       }
 
-      if (!watchDir) {
-        std::this_thread::sleep_for(std::chrono::milliseconds{ WaitIntervalMS });
-        continue;
+      // wake up early, if a pending batch becomes ready before the next OS event
+      uint32_t timeoutMs = WaitIntervalMS;
+      if (!coalescer.empty()) {
+        const auto untilFlush = coalescer.timeUntilFlush(dxvk::FileChangeCoalescer::Clock::now());
+        timeoutMs = std::clamp(uint32_t(untilFlush.count()), 1U, WaitIntervalMS);
       }
 
-      std::vector<uint8_t> changesBuf{};
-      {
-        // block this thread by waiting for the request completion
-        // NOTE: timeout is not 'INFINITE', as we may have > 1 directories to watch,
-        //       so we cycle through them each 'WaitIntervalMS' interval
-        if (WaitForSingleObject(watchDir->nextOverlapped->hEvent, WaitIntervalMS) != WAIT_OBJECT_0) {
-          // we can still wait on the same ReadDirectoryChanges request
-          continue;
-        }
-
-        BOOL resultGetOverlapped;
-        {
-          DWORD ignoredBytesTransferred;
-          resultGetOverlapped = GetOverlappedResult(
-            watchDir->dirHandle,
-            watchDir->nextOverlapped.get(),
-            &ignoredBytesTransferred,
-            false // bWait is false, as we use WaitForSingleObject with a timeout
-          );
-        }
-
-        BOOL resultReadDir;
-        {
-          // 'changesBuf' now contains the directory changes,
-          // 'nextChangesBuffer' is reinitialized, as it will be populated by the next ReadDirectoryChanges
-          changesBuf = std::move(watchDir->nextChangesBuffer);
-          watchDir->nextChangesBuffer.resize(READ_CHANGES_BUF_SIZE);
-
-          // prepare OVERLAPPED structure for the next ReadDirectoryChanges call
-          *watchDir->nextOverlapped = OVERLAPPED{};
-          watchDir->nextOverlapped->hEvent = watchDir->watchEvent;
-
-          // an async request to retrieve directory events (mainly file modifications)
-          // we're scheduling next immediately after 'GetOverlappedResult' to not lose any events in-between
-          resultReadDir = readDirectoryChangesWrapper(
-            watchDir->dirHandle, //
-            watchDir->nextChangesBuffer,
-            watchDir->nextOverlapped
-          );
-        }
+      events.clear();
+      watch.m_backend->wait(timeoutMs, events);
 
-        if (!resultGetOverlapped) {
-          dxvk::Logger::err(
-            dxvk::str::format("GetOverlappedResult failed (", int(resultReadDir), "): ", watchDir->dirpath.string())
-          );
-          continue;
-        }
-        if (!resultReadDir) {
-          dxvk::Logger::err(
-            dxvk::str::format("ReadDirectoryChangesW failed (", int(resultReadDir), "): ", watchDir->dirpath.string())
-          );
+      const auto now = dxvk::FileChangeCoalescer::Clock::now();
+      for (const auto& filepath : events.changedFiles) {
+        if (!findWatchFile(watch, filepath)) {
           continue;
         }
+        coalescer.push(filepath, now);
+      }
+      for (const auto& dirpath : events.rescanDirs) {
+        rescanDir(watch, dirpath, coalescer, now);
       }
 
-      if (changesBuf.empty()) {
-        assert(0 && "changes buffer was not reinitialized via ReadDirectoryChangesW");
-        continue;
+      const size_t notificationCount = coalescer.pendingNotificationCount();
+      std::vector<std::filesystem::path> ready = coalescer.flush(now);
+      if (!ready.empty()) {
+        requestReloadBatch(watch, texmanager, ready, notificationCount);
       }
+    }
 
-      FILE_NOTIFY_INFORMATION* fileNotify = nullptr;
+    watch.m_backend->removeAllDirs();
+  }
+} // namespace
 
-      while (true) // loop through entries in fileNotify
-      {
-        // get through notification entries
-        {
-          if (!fileNotify) { // if first entry
-            fileNotify = (FILE_NOTIFY_INFORMATION*)changesBuf.data();
-          } else {
-            if (!fileNotify->NextEntryOffset) {
-              break; // no more entries
-            }
-            fileNotify = (FILE_NOTIFY_INFORMATION*)(reinterpret_cast<uint8_t*>(fileNotify) + fileNotify->NextEntryOffset
-            );
-          }
-        }
 
-        // sanitize paths given by FILE_NOTIFY_INFORMATION
-        auto filename = std::filesystem::path{
-          std::wstring{ fileNotify->FileName, size_t(fileNotify->FileNameLength / sizeof(wchar_t)) }
-        };
-        if (filename.empty()) {
-          continue;
-        }
-        auto absFilepath = makeCanonicalPathLexical(watchDir->dirpath / filename); // compose absolute path
-        if (absFilepath.empty()) {
-          continue;
-        }
+dxvk::FileChangeCoalescer::FileChangeCoalescer(std::chrono::milliseconds quietPeriod, std::chrono::milliseconds maxDelay)
+  : m_quietPeriod { quietPeriod }
+  , m_maxDelay { std::max(maxDelay, quietPeriod) } {
+}
 
-        // ensure that the changed file is being watched
-        auto f = watchDir->files.find(absFilepath);
-        if (f == watchDir->files.end()) {
-          dxvk::Logger::info(
-            dxvk::str::format("filewatch: file changed, but it's not linked to any managed texture: ", filename.string())
-          );
-          continue;
-        }
-        WatchFile& toreload = f->second;
 
-        dxvk::Logger::info(dxvk::str::format(
-          "filewatch: file changed, reloading ",
-          toreload.texturesReferencingFile.size(),
-          " managed textures: ",
-          filename.string()
-        ));
+void dxvk::FileChangeCoalescer::push(const std::filesystem::path& filepath, Clock::time_point now) {
+  if (m_order.empty()) {
+    m_firstChange = now;
+  }
+  m_lastChange = now;
+  m_notificationCount++;
+  if (m_pending.insert(filepath).second) {
+    m_order.push_back(filepath);
+  }
+}
 
-        // file was changed, reload each ManagedTexture that references it
-        for (const auto& mat : toreload.texturesReferencingFile) {
-          texmanager->requestHotReload(mat);
-        }
-      }
-    }
+
+dxvk::FileChangeCoalescer::Clock::time_point dxvk::FileChangeCoalescer::readyTime() const {
+  return std::min(m_lastChange + m_quietPeriod, m_firstChange + m_maxDelay);
+}
+
+
+std::vector<std::filesystem::path> dxvk::FileChangeCoalescer::flush(Clock::time_point now) {
+  if (m_order.empty() || now < readyTime()) {
+    return {};
   }
-} // namespace
+  std::vector<std::filesystem::path> batch = std::move(m_order);
+  m_order = {};
+  m_pending.clear();
+  m_notificationCount = 0;
+  return batch;
+}
+
+
+std::chrono::milliseconds dxvk::FileChangeCoalescer::timeUntilFlush(Clock::time_point now) const {
+  if (m_order.empty()) {
+    return m_quietPeriod;
+  }
+  const auto ready = readyTime();
+  if (now >= ready) {
+    return std::chrono::milliseconds { 0 };
+  }
+  // round up, so that waiting for the returned time is enough for 'flush' to succeed
+  return std::chrono::ceil<std::chrono::milliseconds>(ready - now);
+}
 
 
 dxvk::FileWatch::FileWatch() = default;
@@ -491,6 +891,7 @@ void dxvk::FileWatch::beginThread(RtxTextureManager* textureManager) {
     return;
   }
   m_impl = std::make_unique<FileWatchTexturesImpl>();
+  m_impl->m_backend = createFileWatchBackend();
 
   m_fileCheckingThread = std::make_unique<dxvk::thread>([this, textureManager] {
     filewatchThreadFunc(*m_impl, textureManager);
@@ -22,6 +22,11 @@
 
 #pragma once
 
+#include <chrono>
+#include <filesystem>
+#include <unordered_set>
+#include <vector>
+
 #include "../../util/rc/util_rc_ptr.h"
 #include "../../util/util_singleton.h"
 
@@ -33,6 +38,53 @@ namespace dxvk {
   struct FileWatchTexturesImpl;
 
 
+  // Collects file change notifications and releases them as a single batch once the directory has been quiet
+  // for 'quietPeriod', so that a burst of writes (e.g. an export tool writing hundreds of files, or a single file
+  // written in several chunks) results in one hot-reload pass where each file appears once.
+  // 'maxDelay' bounds the latency if changes keep arriving without a pause.
+  class FileChangeCoalescer {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    FileChangeCoalescer(std::chrono::milliseconds quietPeriod, std::chrono::milliseconds maxDelay);
+
+    void push(const std::filesystem::path& filepath, Clock::time_point now);
+
+    // Returns all pending paths if the batch is ready to be released, otherwise an empty list
+    std::vector<std::filesystem::path> flush(Clock::time_point now);
+
+    // Time until 'flush' may return a non-empty batch, if no more changes arrive
+    std::chrono::milliseconds timeUntilFlush(Clock::time_point now) const;
+
+    bool empty() const {
+      return m_order.empty();
+    }
+
+    // Number of notifications folded into the pending batch, including duplicates
+    size_t pendingNotificationCount() const {
+      return m_notificationCount;
+    }
+
+  private:
+    struct PathHash {
+      size_t operator()(const std::filesystem::path& value) const noexcept {
+        return std::hash<std::filesystem::path::string_type>{}(value.native());
+      }
+    };
+
+    Clock::time_point readyTime() const;
+
+    std::chrono::milliseconds m_quietPeriod;
+    std::chrono::milliseconds m_maxDelay;
+    std::unordered_set<std::filesystem::path, PathHash> m_pending{};
+    // pending paths in the order of their first notification
+    std::vector<std::filesystem::path> m_order{};
+    size_t m_notificationCount = 0;
+    Clock::time_point m_firstChange{};
+    Clock::time_point m_lastChange{};
+  };
+
+
   class FileWatch : public Singleton<FileWatch> {
   public:
     explicit FileWatch();
@@ -178,6 +178,15 @@ namespace dxvk {
     m_pCap->idStr = hashToString(Capture::nextId++).substr(4, 4);
     m_pCap->bCaptureInstances = m_options.bCaptureInstances;
     m_pCap->bSkyProbeBaked = false;
+    if (streamMeshSamples()) {
+      std::error_code ec;
+      const auto spoolPath = std::filesystem::temp_directory_path(ec) / ("remix_capture_" + m_pCap->idStr + ".samples");
+      m_pCap->pSpool = std::make_shared<CaptureSampleSpool>(spoolPath);
+      if (!m_pCap->pSpool->isValid()) {
+        Logger::warn("[GameCapturer][" + m_pCap->idStr + "] Falling back to in-memory mesh samples");
+        m_pCap->pSpool.reset();
+      }
+    }
     if (m_pCap->bCaptureInstances) {
       prepareInstanceStage(ctx);
     }
@@ -470,6 +479,7 @@ namespace dxvk {
         m_pCap->meshes[meshHash] = std::make_shared<Mesh>();
         m_pCap->meshes[meshHash]->instanceCount = 0;
         m_pCap->meshes[meshHash]->matHash = matHash;
+        m_pCap->meshes[meshHash]->pSpool = m_pCap->pSpool;
       }
       instanceNum = m_pCap->meshes[meshHash]->instanceCount++;
     }
@@ -642,7 +652,7 @@ namespace dxvk {
         return (a - b).GetLengthSq() > captureMeshPositionDeltaSq;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.positionBufs, positions, currentFrameNum, positionsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.positionBufs, pMesh->spooledBuffers.positionBufs, positions, currentFrameNum, positionsDifferentEnough);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, inputPositionBuffer, captureMeshPositionsAsync);
@@ -681,7 +691,7 @@ namespace dxvk {
         return (a - b).GetLengthSq() > captureMeshNormalDeltaSq;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.normalBufs, normals, currentFrameNum, normalsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.normalBufs, pMesh->spooledBuffers.normalBufs, normals, currentFrameNum, normalsDifferentEnough);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, inputNormalBuffer, captureMeshNormalsAsync);
@@ -742,7 +752,7 @@ namespace dxvk {
         return a != b;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.idxBufs, indices, currentFrameNum, differentIndices);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.idxBufs, pMesh->spooledBuffers.idxBufs, indices, currentFrameNum, differentIndices);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, geomData.indexBuffer, captureMeshIndicesAsync);
@@ -782,7 +792,7 @@ namespace dxvk {
         return (a - b).GetLengthSq() > captureMeshTexcoordDeltaSq;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.texcoordBufs, texcoords, currentFrameNum, differentIndices);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.texcoordBufs, pMesh->spooledBuffers.texcoordBufs, texcoords, currentFrameNum, differentIndices);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, geomData.texcoordBuffer, captureMeshTexCoordsAsync);
@@ -823,7 +833,7 @@ namespace dxvk {
         return (a - b).GetLengthSq() > captureMeshColorDeltaSq;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.colorBufs, colors, currentFrameNum, colorsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.colorBufs, pMesh->spooledBuffers.colorBufs, colors, currentFrameNum, colorsDifferentEnough);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, geomData.color0Buffer, captureMeshColorAsync);
@@ -873,7 +883,7 @@ namespace dxvk {
         return std::abs(a - b) > delta;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.blendWeightBufs, targetBuffer, currentFrameNum, weightsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.blendWeightBufs, pMesh->spooledBuffers.blendWeightBufs, targetBuffer, currentFrameNum, weightsDifferentEnough);
     };
     AssetExporter::BufferCallback captureMeshBlendIndicesAsync = [ctx, geomData, currentFrameNum, pMesh](Rc<DxvkBuffer> inBuf) {
       assert(geomData.blendIndicesBuffer.vertexFormat() == VK_FORMAT_R8G8B8A8_USCALED);
@@ -902,7 +912,7 @@ namespace dxvk {
         return a != b;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.blendIndicesBufs, targetBuffer, currentFrameNum, weightsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.blendIndicesBufs, pMesh->spooledBuffers.blendIndicesBufs, targetBuffer, currentFrameNum, weightsDifferentEnough);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, geomData.blendWeightBuffer, captureMeshBlendWeightsAsync);
@@ -915,9 +925,19 @@ namespace dxvk {
   template <typename T, typename CompareTReturnBool>
   static void GameCapturer::evalNewBufferAndCache(std::shared_ptr<Mesh> pMesh,
                                                   std::map<float, pxr::VtArray<T>>& bufferCache,
+                                                  CaptureSampleSpool::Stream& spooledBuffer,
                                                   pxr::VtArray<T>& newBuffer,
                                                   const float currentFrameNum,
                                                   CompareTReturnBool compareT) {
+    if (pMesh->pSpool) {
+      // Streaming: the spool stores the buffer iff its hash differs from the previous sample
+      {
+        std::lock_guard lock(pMesh->spooledBuffers.mutex);
+        pMesh->pSpool->append(spooledBuffer, currentFrameNum, newBuffer.cdata(), newBuffer.size() * sizeof(T));
+      }
+      pMesh->meshSync.numOutstandingDec();
+      return;
+    }
     std::lock_guard lock(pMesh->meshSync.mutex);
     // Discover whether the new buffer is worth cacheing
     bool bSufficientlyDifferent = false;
@@ -954,10 +974,8 @@ namespace dxvk {
                                           CompletedCapture* complete,
                                           const float framesPerSecond) {
       Capture& cap = *pCap;
-      const auto numTexExportsInProgress = m_exporter.getNumExportsInFlights();
-      constexpr float kTimePerTexExport = 0.0050f; // Liberally decided by inspection, derived from timed out tests
-      const float texExportTimeout = numTexExportsInProgress * kTimePerTexExport;
-      m_exporter.waitForAllExportsToComplete(texExportTimeout);
+      // Waits as long as the exporter keeps making progress, however many textures are queued
+      m_exporter.waitForAllExportsToComplete();
       assert(pState->has<State::PreppingExport>());
       const auto exportPrep = prepExport(cap, framesPerSecond);
       pState->set<State::PreppingExport, false>();
@@ -1034,6 +1052,7 @@ namespace dxvk {
       }
     }
     exportPrep.meta.bCorrectBakedTransforms = false;
+    exportPrep.meta.bParallelExport = parallelExport();
 
     exportPrep.debugId = cap.idStr;
     exportPrep.baseExportPath = BASE_DIR;
@@ -1065,11 +1084,53 @@ namespace dxvk {
         pMesh->lssData.origin = pMesh->originCalc.calc();
         stageOriginCalc.compareAndSwap(pMesh->lssData.origin);
       }
-      exportPrep.meshes[hash] = pMesh->lssData;
+      lss::Mesh& exportMesh = exportPrep.meshes[hash];
+      exportMesh = pMesh->lssData;
+      if (pMesh->pSpool) {
+        // Decoded while the mesh's layers are authored, so that only the meshes being exported are in memory at once
+        exportMesh.loadBuffers = [pMesh = pMesh](lss::MeshBuffers& buffers) {
+          return unspoolMeshBuffers(*pMesh, buffers);
+        };
+      }
     }
     if(correctBakedTransforms()) {
       exportPrep.stageOrigin = stageOriginCalc.calc();
     }
+    if (cap.pSpool) {
+      const uint64_t rawBytes = cap.pSpool->getRawBytes();
+      const uint64_t encodedBytes = cap.pSpool->getEncodedBytes();
+      Logger::info(str::format("[GameCapturer][", cap.idStr, "] Streamed ", rawBytes / 1024, " KB of mesh samples as ",
+                               encodedBytes / 1024, " KB"));
+    }
+  }
+
+  template <typename T>
+  bool GameCapturer::unspoolBuffer(CaptureSampleSpool& spool,
+                                   const CaptureSampleSpool::Stream& spooledBuffer,
+                                   std::map<float, pxr::VtArray<T>>& bufferCache) {
+    const bool success = spool.readSamples(spooledBuffer, [&bufferCache](float time, const std::vector<uint8_t>& sample) {
+      pxr::VtArray<T> buffer(sample.size() / sizeof(T));
+      memcpy(buffer.data(), sample.data(), buffer.size() * sizeof(T));
+      bufferCache[time] = std::move(buffer);
+    });
+    return success;
+  }
+
+  bool GameCapturer::unspoolMeshBuffers(Mesh& mesh, lss::MeshBuffers& buffers) {
+    CaptureSampleSpool& spool = *mesh.pSpool;
+    SpooledMeshBuffers& spooled = mesh.spooledBuffers;
+    std::lock_guard lock(spooled.mutex);
+    const bool success = unspoolBuffer(spool, spooled.idxBufs, buffers.idxBufs) &&
+                         unspoolBuffer(spool, spooled.positionBufs, buffers.positionBufs) &&
+                         unspoolBuffer(spool, spooled.normalBufs, buffers.normalBufs) &&
+                         unspoolBuffer(spool, spooled.texcoordBufs, buffers.texcoordBufs) &&
+                         unspoolBuffer(spool, spooled.colorBufs, buffers.colorBufs) &&
+                         unspoolBuffer(spool, spooled.blendWeightBufs, buffers.blendWeightBufs) &&
+                         unspoolBuffer(spool, spooled.blendIndicesBufs, buffers.blendIndicesBufs);
+    if (!success) {
+      Logger::err(str::format("[GameCapturer][Mesh:", mesh.lssData.meshName, "] Failed to read back mesh samples"));
+    }
+    return success;
   }
 
   void GameCapturer::prepExportInstances(const Capture& cap, lss::Export& exportPrep) {
@@ -72,6 +72,7 @@
 #pragma once
 
 #include "rtx_game_capturer_utils.h"
+#include "rtx_game_capturer_spool.h"
 #include "rtx_options.h"
 
 #include "../../lssusd/game_exporter_types.h"
@@ -114,6 +115,13 @@ public:
                 "to all have identity xform matrices, enabling will attempt to correct this and\n"
                 "improve stage + mesh viewability in tools.\n"
                 "Hashes are unaffected.");
+  RTX_OPTION("rtx.capture", bool, streamMeshSamples, false,
+                "Stream captured mesh buffer samples to a compressed temporary file instead of keeping them in memory until export.\n"
+                "A new time sample is stored whenever a buffer's hash differs from its previous sample, so the mesh capture\n"
+                "delta thresholds are not applied in this mode. Recommended for long multiframe captures of animated meshes.");
+  RTX_OPTION("rtx.capture", bool, parallelExport, true,
+                "Write the USD layers of captured meshes, materials and skeletons concurrently on worker threads,\n"
+                "before referencing them from the capture stage.");
 
   GameCapturer(DxvkDevice* const pDevice, SceneManager& sceneManager, AssetExporter& exporter);
   ~GameCapturer();
@@ -182,12 +190,28 @@ private:
     void numOutstandingDec() { { std::lock_guard lock(mutex); numOutstanding--; } cond.notify_all(); }
   };
 
+  // Spooled counterparts of lss::MeshBuffers, used when streaming mesh samples.  Guarded by their own mutex
+  // rather than MeshSync's, so that hashing and encoding samples never blocks the render thread.
+  struct SpooledMeshBuffers {
+    dxvk::mutex                mutex;
+    CaptureSampleSpool::Stream idxBufs;
+    CaptureSampleSpool::Stream positionBufs;
+    CaptureSampleSpool::Stream normalBufs;
+    CaptureSampleSpool::Stream texcoordBufs;
+    CaptureSampleSpool::Stream colorBufs;
+    CaptureSampleSpool::Stream blendWeightBufs;
+    CaptureSampleSpool::Stream blendIndicesBufs;
+  };
+
   struct Mesh {
     lss::Mesh        lssData;
     size_t           instanceCount = 0;
     XXH64_hash_t     matHash;
     MeshSync         meshSync;
     AtomicOriginCalc originCalc;
+    // Only set when streaming mesh samples, in which case buffers are spooled until export
+    std::shared_ptr<CaptureSampleSpool> pSpool;
+    SpooledMeshBuffers spooledBuffers;
   };
 
   struct Instance {
@@ -250,6 +274,7 @@ private:
   template <typename T, typename CompareTReturnBool>
   static void evalNewBufferAndCache(std::shared_ptr<Mesh> pMesh,
                                     std::map<float,pxr::VtArray<T>>& bufferCache,
+                                    CaptureSampleSpool::Stream& spooledBuffer,
                                     pxr::VtArray<T>& newBuffer,
                                     const float currentCaptureTime,
                                     CompareTReturnBool compareT);
@@ -264,6 +289,11 @@ private:
                                   lss::Export& exportPrep);
   static void prepExportMeshes(const Capture& cap,
                                lss::Export& exportPrep);
+  static bool unspoolMeshBuffers(Mesh& mesh, lss::MeshBuffers& buffers);
+  template <typename T>
+  static bool unspoolBuffer(CaptureSampleSpool& spool,
+                            const CaptureSampleSpool::Stream& spooledBuffer,
+                            std::map<float, pxr::VtArray<T>>& bufferCache);
   static void prepExportInstances(const Capture& cap,
                                   lss::Export& exportPrep);
   static void prepExportLights(const Capture& cap,
@@ -336,6 +366,7 @@ private:
     std::unordered_map<XXH64_hash_t, Material> materials;
     std::unordered_map<XXH64_hash_t, Instance> instances;
     std::unordered_map<XXH64_hash_t, uint8_t> instanceFlags;
+    std::shared_ptr<CaptureSampleSpool> pSpool;
     HWND hwnd;
   };
   std::unique_ptr<Capture> m_pCap;
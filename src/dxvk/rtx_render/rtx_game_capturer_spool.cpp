@@ -0,0 +1,223 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "rtx_game_capturer_spool.h"
+
+#include <cstring>
+
+#include "../../util/log/log.h"
+#include "../../util/util_string.h"
+
+namespace dxvk {
+
+namespace {
+  // Zero runs shorter than this are cheaper to store as literals than to break the literal run.
+  constexpr size_t kMinZeroRun = 4;
+
+  enum EncodingFlag : uint8_t {
+    Raw = 0,
+    Delta = 1
+  };
+
+  void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+      out.push_back(uint8_t(value) | 0x80);
+      value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+  }
+
+  bool readVarint(const uint8_t*& ptr, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7) {
+      if (ptr >= end) {
+        return false;
+      }
+      const uint8_t byte = *ptr++;
+      value |= uint64_t(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+} // anonymous namespace
+
+CaptureSampleSpool::CaptureSampleSpool(const std::filesystem::path& filePath)
+  : m_filePath(filePath) {
+  m_file.open(filePath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open()) {
+    Logger::err(str::format("[GameCapturer] Failed to create sample spool file: ", filePath.string()));
+  }
+}
+
+CaptureSampleSpool::~CaptureSampleSpool() {
+  if (m_file.is_open()) {
+    m_file.close();
+    std::error_code ec;
+    std::filesystem::remove(m_filePath, ec);
+  }
+}
+
+void CaptureSampleSpool::encode(const uint8_t* data, const size_t size, const std::vector<uint8_t>& previous, std::vector<uint8_t>& encoded) {
+  const bool isDelta = previous.size() == size;
+  encoded.clear();
+  encoded.push_back(isDelta ? EncodingFlag::Delta : EncodingFlag::Raw);
+
+  const auto byteAt = [&](size_t i) -> uint8_t {
+    return isDelta ? (data[i] ^ previous[i]) : data[i];
+  };
+
+  size_t i = 0;
+  while (i < size) {
+    // Leading zeros
+    const size_t zeroStart = i;
+    while (i < size && byteAt(i) == 0) {
+      ++i;
+    }
+    const size_t zeroRun = i - zeroStart;
+
+    // Literals, up to the next zero run worth skipping
+    const size_t literalStart = i;
+    size_t zerosSeen = 0;
+    while (i < size) {
+      if (byteAt(i) == 0) {
+        if (++zerosSeen >= kMinZeroRun) {
+          break;
+        }
+      } else {
+        zerosSeen = 0;
+      }
+      ++i;
+    }
+    // Give back the zeros that start the next run
+    if (zerosSeen >= kMinZeroRun) {
+      i -= zerosSeen - 1;
+    }
+    const size_t literalEnd = i;
+
+    writeVarint(encoded, zeroRun);
+    writeVarint(encoded, literalEnd - literalStart);
+    for (size_t j = literalStart; j < literalEnd; ++j) {
+      encoded.push_back(byteAt(j));
+    }
+  }
+}
+
+bool CaptureSampleSpool::decode(const uint8_t* encoded, const size_t encodedSize, const size_t size, const std::vector<uint8_t>& previous, std::vector<uint8_t>& decoded) {
+  const uint8_t* ptr = encoded;
+  const uint8_t* const end = encoded + encodedSize;
+  if (ptr >= end) {
+    return false;
+  }
+  const uint8_t flag = *ptr++;
+  if (flag != EncodingFlag::Raw && flag != EncodingFlag::Delta) {
+    return false;
+  }
+  if (flag == EncodingFlag::Delta && previous.size() != size) {
+    return false;
+  }
+
+  decoded.assign(size, 0);
+  size_t i = 0;
+  while (ptr < end) {
+    uint64_t zeroRun, literalCount;
+    if (!readVarint(ptr, end, zeroRun) || !readVarint(ptr, end, literalCount)) {
+      return false;
+    }
+    if (zeroRun > size - i || literalCount > size - i - zeroRun || literalCount > uint64_t(end - ptr)) {
+      return false;
+    }
+    i += zeroRun;
+    std::memcpy(&decoded[i], ptr, literalCount);
+    ptr += literalCount;
+    i += literalCount;
+  }
+  if (i != size) {
+    return false;
+  }
+
+  if (flag == EncodingFlag::Delta) {
+    for (size_t j = 0; j < size; ++j) {
+      decoded[j] ^= previous[j];
+    }
+  }
+  return true;
+}
+
+bool CaptureSampleSpool::append(Stream& stream, const float time, const void* data, const size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  const XXH64_hash_t hash = XXH3_64bits(bytes, size);
+  if (!stream.samples.empty() && hash == stream.lastHash && stream.lastSample.size() == size) {
+    return false;
+  }
+
+  std::vector<uint8_t> encoded;
+  encode(bytes, size, stream.lastSample, encoded);
+
+  SampleRef ref;
+  ref.size = static_cast<uint32_t>(size);
+  ref.encodedSize = static_cast<uint32_t>(encoded.size());
+  {
+    std::lock_guard lock(m_fileMutex);
+    ref.offset = m_writeOffset;
+    m_file.seekp(static_cast<std::streamoff>(m_writeOffset));
+    m_file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+    m_writeOffset += encoded.size();
+    m_rawBytes += size;
+    m_encodedBytes += encoded.size();
+  }
+
+  stream.lastHash = hash;
+  stream.lastSample.assign(bytes, bytes + size);
+  stream.samples.emplace_back(time, ref);
+  return true;
+}
+
+bool CaptureSampleSpool::readSamples(const Stream& stream, const std::function<void(float, const std::vector<uint8_t>&)>& onSample) {
+  std::vector<uint8_t> encoded;
+  std::vector<uint8_t> previous;
+  std::vector<uint8_t> decoded;
+  for (const auto& [time, ref] : stream.samples) {
+    encoded.resize(ref.encodedSize);
+    {
+      std::lock_guard lock(m_fileMutex);
+      m_file.flush();
+      m_file.seekg(static_cast<std::streamoff>(ref.offset));
+      m_file.read(reinterpret_cast<char*>(encoded.data()), encoded.size());
+      if (!m_file) {
+        m_file.clear();
+        Logger::err(str::format("[GameCapturer] Failed to read back captured samples from ", m_filePath.string()));
+        return false;
+      }
+    }
+    if (!decode(encoded.data(), encoded.size(), ref.size, previous, decoded)) {
+      Logger::err(str::format("[GameCapturer] Corrupt captured sample in ", m_filePath.string()));
+      return false;
+    }
+    onSample(time, decoded);
+    std::swap(previous, decoded);
+  }
+  return true;
+}
+
+} // namespace dxvk
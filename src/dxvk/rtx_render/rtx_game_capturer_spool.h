@@ -0,0 +1,98 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "rtx_constants.h"
+#include "../../util/thread.h"
+#include "../../util/xxHash/xxhash.h"
+
+namespace dxvk {
+
+// Spills captured mesh buffer samples to a temporary file while a capture is in progress, so that long
+// multiframe captures don't keep every sample of every animated mesh in memory until export.
+//
+// Samples are deduplicated by hash against the previous sample of the same stream, then stored as a delta
+// against that sample (byte-wise XOR) with runs of zero bytes collapsed.  Buffers that only change in a few
+// vertices between frames compress to a small fraction of their size.
+class CaptureSampleSpool {
+public:
+  struct SampleRef {
+    uint64_t offset = 0;
+    uint32_t encodedSize = 0;
+    uint32_t size = 0;
+  };
+
+  // Per-buffer state.  Not thread safe, streams are expected to be guarded by their owner (see GameCapturer::SpooledMeshBuffers).
+  struct Stream {
+    XXH64_hash_t lastHash = kEmptyHash;
+    std::vector<uint8_t> lastSample;
+    std::vector<std::pair<float, SampleRef>> samples;
+  };
+
+  explicit CaptureSampleSpool(const std::filesystem::path& filePath);
+  ~CaptureSampleSpool();
+
+  CaptureSampleSpool(const CaptureSampleSpool&) = delete;
+  CaptureSampleSpool& operator=(const CaptureSampleSpool&) = delete;
+
+  bool isValid() const {
+    return m_file.is_open();
+  }
+
+  // Appends a sample to the stream, unless it is identical to the stream's previous sample.  Returns true if the
+  // sample was stored.
+  bool append(Stream& stream, const float time, const void* data, const size_t size);
+
+  // Decodes every sample of the stream in time order.  Returns false if the file could not be read back.
+  bool readSamples(const Stream& stream, const std::function<void(float, const std::vector<uint8_t>&)>& onSample);
+
+  uint64_t getRawBytes() const {
+    std::lock_guard lock(m_fileMutex);
+    return m_rawBytes;
+  }
+
+  uint64_t getEncodedBytes() const {
+    std::lock_guard lock(m_fileMutex);
+    return m_encodedBytes;
+  }
+
+  static void encode(const uint8_t* data, const size_t size, const std::vector<uint8_t>& previous, std::vector<uint8_t>& encoded);
+  static bool decode(const uint8_t* encoded, const size_t encodedSize, const size_t size, const std::vector<uint8_t>& previous, std::vector<uint8_t>& decoded);
+
+private:
+  std::filesystem::path m_filePath;
+  mutable dxvk::mutex m_fileMutex;
+  std::fstream m_file;
+  uint64_t m_writeOffset = 0;
+  uint64_t m_rawBytes = 0;
+  uint64_t m_encodedBytes = 0;
+};
+
+} // namespace dxvk
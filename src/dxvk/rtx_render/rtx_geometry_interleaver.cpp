@@ -0,0 +1,385 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_geometry_interleaver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <immintrin.h>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "../../util/log/log.h"
+#include "../../util/thread.h"
+#include "../../util/util_string.h"
+#include "../../util/util_threadpool.h"
+#include "dxvk_scoped_annotation.h"
+
+#include "rtx/utility/shader_types.h"
+#include "rtx/pass/interleave_geometry.h"
+
+namespace dxvk {
+
+  namespace {
+    using interleaver::SupportedVkFormats;
+
+    struct Attribute {
+      const float* data;
+      uint32_t stride;
+      uint32_t offset;
+      uint32_t format;
+    };
+
+    bool isPackedFormat(uint32_t format) {
+      return format == SupportedVkFormats::VK_FORMAT_R8G8B8A8_UNORM ||
+             format == SupportedVkFormats::VK_FORMAT_A2B10G10R10_SNORM_PACK32;
+    }
+
+    // Transposes N vertices worth of x/y/z components (N/4 registers each) into one xyz_ register per vertex.
+    template<uint32_t N>
+    void transpose(const __m128* x, const __m128* y, const __m128* z, __m128 (&out)[N]) {
+      for (uint32_t i = 0; i < N / 4; i++) {
+        __m128 r0 = x[i], r1 = y[i], r2 = z[i], r3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        out[i * 4 + 0] = r0;
+        out[i * 4 + 1] = r1;
+        out[i * 4 + 2] = r2;
+        out[i * 4 + 3] = r3;
+      }
+    }
+
+    // Same math as `unorm8ToF32` / `unorm10ToF32` in interleaver::convert: (x & mask) / mask, and for R8G8B8A8 the
+    // result is remapped with * 2 - 1.  Multiplying by 2 is exact, so this is bit-identical to the scalar code even
+    // if the compiler contracts the scalar version into an FMA.
+    template<uint32_t N>
+    void decodePacked(const Attribute& a, uint32_t srcFirst, __m128 (&out)[N]) {
+      const bool isUnorm8 = a.format == SupportedVkFormats::VK_FORMAT_R8G8B8A8_UNORM;
+      const uint32_t bits = isUnorm8 ? 8 : 10;
+      const uint32_t mask = (1u << bits) - 1;
+      const uint32_t* src = reinterpret_cast<const uint32_t*>(a.data);
+
+      __m128 x[N / 4], y[N / 4], z[N / 4];
+
+      if constexpr (N == 8) {
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i index = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(srcFirst * a.stride + a.offset)),
+                                               _mm256_mullo_epi32(lanes, _mm256_set1_epi32(static_cast<int>(a.stride))));
+        const __m256i data = _mm256_i32gather_epi32(reinterpret_cast<const int*>(src), index, 4);
+
+        const __m256i vmask = _mm256_set1_epi32(static_cast<int>(mask));
+        const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(bits));
+        const __m256 scale = _mm256_set1_ps(static_cast<float>(mask));
+
+        const __m256i r = _mm256_and_si256(data, vmask);
+        const __m256i g = _mm256_and_si256(_mm256_srl_epi32(data, shift), vmask);
+        const __m256i b = _mm256_and_si256(_mm256_srl_epi32(_mm256_srl_epi32(data, shift), shift), vmask);
+
+        __m256 fr = _mm256_div_ps(_mm256_cvtepi32_ps(r), scale);
+        __m256 fg = _mm256_div_ps(_mm256_cvtepi32_ps(g), scale);
+        __m256 fb = _mm256_div_ps(_mm256_cvtepi32_ps(b), scale);
+
+        if (isUnorm8) {
+          const __m256 two = _mm256_set1_ps(2.f);
+          const __m256 one = _mm256_set1_ps(1.f);
+          fr = _mm256_sub_ps(_mm256_mul_ps(fr, two), one);
+          fg = _mm256_sub_ps(_mm256_mul_ps(fg, two), one);
+          fb = _mm256_sub_ps(_mm256_mul_ps(fb, two), one);
+        }
+
+        x[0] = _mm256_castps256_ps128(fr);
+        x[1] = _mm256_extractf128_ps(fr, 1);
+        y[0] = _mm256_castps256_ps128(fg);
+        y[1] = _mm256_extractf128_ps(fg, 1);
+        z[0] = _mm256_castps256_ps128(fb);
+        z[1] = _mm256_extractf128_ps(fb, 1);
+      } else {
+        const uint32_t base = srcFirst * a.stride + a.offset;
+        const __m128i data = _mm_setr_epi32(static_cast<int>(src[base]),
+                                            static_cast<int>(src[base + a.stride]),
+                                            static_cast<int>(src[base + a.stride * 2]),
+                                            static_cast<int>(src[base + a.stride * 3]));
+
+        const __m128i vmask = _mm_set1_epi32(static_cast<int>(mask));
+        const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(bits));
+        const __m128 scale = _mm_set1_ps(static_cast<float>(mask));
+
+        const __m128i r = _mm_and_si128(data, vmask);
+        const __m128i g = _mm_and_si128(_mm_srl_epi32(data, shift), vmask);
+        const __m128i b = _mm_and_si128(_mm_srl_epi32(_mm_srl_epi32(data, shift), shift), vmask);
+
+        x[0] = _mm_div_ps(_mm_cvtepi32_ps(r), scale);
+        y[0] = _mm_div_ps(_mm_cvtepi32_ps(g), scale);
+        z[0] = _mm_div_ps(_mm_cvtepi32_ps(b), scale);
+
+        if (isUnorm8) {
+          const __m128 two = _mm_set1_ps(2.f);
+          const __m128 one = _mm_set1_ps(1.f);
+          x[0] = _mm_sub_ps(_mm_mul_ps(x[0], two), one);
+          y[0] = _mm_sub_ps(_mm_mul_ps(y[0], two), one);
+          z[0] = _mm_sub_ps(_mm_mul_ps(z[0], two), one);
+        }
+      }
+
+      transpose<N>(x, y, z, out);
+    }
+
+    // Decodes N consecutive vertices of an attribute into one register per vertex, holding x, y and z in the
+    // first three lanes.  The fourth lane is undefined (it may hold the next float of the source).
+    template<uint32_t N>
+    void decodeAttribute(const Attribute& a, uint32_t srcFirst, __m128 (&out)[N]) {
+      switch (a.format) {
+      case SupportedVkFormats::VK_FORMAT_R32G32_SFLOAT:
+        for (uint32_t i = 0; i < N; i++) {
+          const float* src = a.data + (srcFirst + i) * a.stride + a.offset;
+          out[i] = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(src));
+        }
+        break;
+      case SupportedVkFormats::VK_FORMAT_R32G32B32_SFLOAT:
+      case SupportedVkFormats::VK_FORMAT_R32G32B32A32_SFLOAT:
+        for (uint32_t i = 0; i < N; i++) {
+          out[i] = _mm_loadu_ps(a.data + (srcFirst + i) * a.stride + a.offset);
+        }
+        break;
+      case SupportedVkFormats::VK_FORMAT_R8G8B8A8_UNORM:
+      case SupportedVkFormats::VK_FORMAT_A2B10G10R10_SNORM_PACK32:
+        decodePacked<N>(a, srcFirst, out);
+        break;
+      default:
+        // Matches the fallback of interleaver::convert
+        for (uint32_t i = 0; i < N; i++) {
+          out[i] = _mm_set1_ps(1.f);
+        }
+        break;
+      }
+    }
+
+    // Interleaves N vertices per iteration.  Attributes are decoded attribute-major and written vertex-major: the
+    // full-register stores of 3-component attributes spill one float into the next attribute (or the next vertex),
+    // which is always written afterwards.  Likewise, loading a 3-component float attribute reads one float past it.
+    // Both are only safe while another vertex of the range follows, so the last vertex is left to the scalar path,
+    // which also keeps the writes of one range from touching its neighbours when ranges are processed in parallel.
+    template<uint32_t N>
+    void interleaveRange(uint32_t begin, uint32_t end, float* dst, const CpuGeometryInterleaver::Sources& src, const InterleaveGeometryArgs& args) {
+      const Attribute position { src.position, args.positionStride, args.positionOffset, args.positionFormat };
+      const Attribute normal { src.normal, args.normalStride, args.normalOffset, args.normalFormat };
+      const Attribute texcoord { src.texcoord, args.texcoordStride, args.texcoordOffset, args.texcoordFormat };
+      const bool color0Supported = interleaver::formatConversionUintSupported(args.color0Format);
+
+      uint32_t idx = begin;
+      for (; idx + N < end; idx += N) {
+        const uint32_t srcFirst = idx + args.minVertexIndex;
+
+        __m128 positions[N], normals[N], texcoords[N];
+        decodeAttribute<N>(position, srcFirst, positions);
+        if (args.hasNormals) {
+          decodeAttribute<N>(normal, srcFirst, normals);
+        }
+        if (args.hasTexcoord) {
+          decodeAttribute<N>(texcoord, srcFirst, texcoords);
+        }
+
+        for (uint32_t i = 0; i < N; i++) {
+          float* out = dst + (idx + i) * args.outputStride;
+          uint32_t writeOffset = 0;
+
+          _mm_storeu_ps(out, positions[i]);
+          writeOffset += 3;
+
+          if (args.hasNormals) {
+            _mm_storeu_ps(out + writeOffset, normals[i]);
+            writeOffset += 3;
+          }
+
+          if (args.hasTexcoord) {
+            _mm_storel_pi(reinterpret_cast<__m64*>(out + writeOffset), texcoords[i]);
+            writeOffset += 2;
+          }
+
+          if (args.hasColor0) {
+            const uint32_t color0 = color0Supported ? src.color0[(srcFirst + i) * args.color0Stride + args.color0Offset] : 1u;
+            memcpy(out + writeOffset, &color0, sizeof(color0));
+          }
+        }
+      }
+
+      CpuGeometryInterleaver::interleaveScalar(idx, end, dst, src, args);
+    }
+
+    using InterleaveThreadPool = WorkerThreadPool<64, true, false>;
+
+    // Note: WorkerThreadPool::Schedule expects a single producer
+    dxvk::mutex s_threadPoolMutex;
+    std::unique_ptr<InterleaveThreadPool> s_threadPool;
+
+    InterleaveThreadPool& getThreadPool() {
+      if (s_threadPool == nullptr) {
+        const uint32_t numThreads = std::clamp(dxvk::thread::hardware_concurrency() / 4, 1u, 4u);
+        s_threadPool = std::make_unique<InterleaveThreadPool>(static_cast<uint8_t>(numThreads), "rtx-cpu-interleave");
+      }
+      return *s_threadPool;
+    }
+
+    uint32_t calibrateMaxCpuVertexCount() {
+      ScopedCpuProfileZone();
+
+      // A common layout for skinned/dynamic draws: float3 position, packed normal, float2 texcoord and a color.
+      struct SourceVertex {
+        float position[3];
+        uint32_t normal;
+        float texcoord[2];
+        uint32_t color;
+      };
+      constexpr uint32_t kNumVertices = CpuGeometryInterleaver::kMaxCpuVertexCount;
+      constexpr uint32_t kSourceStride = sizeof(SourceVertex) / sizeof(float);
+      constexpr uint32_t kOutputStride = 3 + 3 + 2 + 1;
+
+      std::vector<SourceVertex> source(kNumVertices);
+      for (uint32_t i = 0; i < kNumVertices; i++) {
+        source[i] = { { float(i), float(i) * 0.5f, 1.f }, i * 2654435761u, { float(i) / kNumVertices, 0.5f }, 0xff808080u };
+      }
+
+      InterleaveGeometryArgs args = {};
+      args.positionStride = args.normalStride = args.texcoordStride = args.color0Stride = kSourceStride;
+      args.positionFormat = SupportedVkFormats::VK_FORMAT_R32G32B32_SFLOAT;
+      args.hasNormals = 1;
+      args.normalOffset = 3;
+      args.normalFormat = SupportedVkFormats::VK_FORMAT_R8G8B8A8_UNORM;
+      args.hasTexcoord = 1;
+      args.texcoordOffset = 4;
+      args.texcoordFormat = SupportedVkFormats::VK_FORMAT_R32G32_SFLOAT;
+      args.hasColor0 = 1;
+      args.color0Offset = 6;
+      args.color0Format = SupportedVkFormats::VK_FORMAT_B8G8R8A8_UNORM;
+      args.outputStride = kOutputStride;
+      args.vertexCount = kNumVertices;
+
+      CpuGeometryInterleaver::Sources sources;
+      sources.position = sources.normal = sources.texcoord = reinterpret_cast<const float*>(source.data());
+      sources.color0 = reinterpret_cast<const uint32_t*>(source.data());
+
+      // The CPU path also copies its output into a staging buffer, so that is part of its cost
+      std::vector<float> dst(kNumVertices * kOutputStride);
+      std::vector<float> staging(dst.size());
+
+      double bestNs = std::numeric_limits<double>::max();
+      for (uint32_t run = 0; run < 4; run++) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        CpuGeometryInterleaver::interleave(dst.data(), sources, args);
+        memcpy(staging.data(), dst.data(), dst.size() * sizeof(float));
+        const auto end = std::chrono::high_resolution_clock::now();
+        bestNs = std::min(bestNs, static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+      }
+
+      const double nsPerVertex = std::max(bestNs / kNumVertices, 0.01);
+      const double crossover = CpuGeometryInterleaver::gpuInterleaveDispatchCostUs() * 1000.0 / nsPerVertex;
+      const uint32_t maxVertexCount = static_cast<uint32_t>(std::clamp(crossover,
+                                                                       static_cast<double>(CpuGeometryInterleaver::kMinCpuVertexCount),
+                                                                       static_cast<double>(CpuGeometryInterleaver::kMaxCpuVertexCount)));
+
+      Logger::info(str::format("[rtx-interleaver] CPU interleaving measured at ", nsPerVertex, " ns per vertex, interleaving meshes of up to ", maxVertexCount, " vertices on the CPU"));
+      return maxVertexCount;
+    }
+  }
+
+  bool CpuGeometryInterleaver::formatConversionFloatSupported(uint32_t format) {
+    return interleaver::formatConversionFloatSupported(format);
+  }
+
+  bool CpuGeometryInterleaver::formatConversionUintSupported(uint32_t format) {
+    return interleaver::formatConversionUintSupported(format);
+  }
+
+  void CpuGeometryInterleaver::interleaveScalar(uint32_t begin, uint32_t end, float* dst, const Sources& src, const InterleaveGeometryArgs& args) {
+    for (uint32_t i = begin; i < end; i++) {
+      interleaver::interleave(i, dst, src.position, src.normal, src.texcoord, src.color0, args);
+    }
+  }
+
+  void CpuGeometryInterleaver::interleaveBatched(uint32_t begin, uint32_t end, float* dst, const Sources& src, const InterleaveGeometryArgs& args, fast::SIMD simd) {
+    simd = std::min(simd, fast::getSimdSupportLevel());
+
+    // The batched stores rely on attributes being tightly packed (see interleaveRange)
+    const uint32_t packedStride = 3 + (args.hasNormals ? 3 : 0) + (args.hasTexcoord ? 2 : 0) + (args.hasColor0 ? 1 : 0);
+    if (args.outputStride != packedStride) {
+      simd = fast::SIMD::None;
+    }
+
+    if (simd >= fast::SIMD::AVX2) {
+      interleaveRange<8>(begin, end, dst, src, args);
+    } else if (simd >= fast::SIMD::SSE2) {
+      interleaveRange<4>(begin, end, dst, src, args);
+    } else {
+      interleaveScalar(begin, end, dst, src, args);
+    }
+  }
+
+  void CpuGeometryInterleaver::interleave(float* dst, const Sources& src, const InterleaveGeometryArgs& args) {
+    ScopedCpuProfileZone();
+
+    const uint32_t numChunks = (args.vertexCount + kVerticesPerChunk - 1) / kVerticesPerChunk;
+    if (numChunks <= 1) {
+      interleaveBatched(0, args.vertexCount, dst, src, args);
+      return;
+    }
+
+    // The calling thread takes the first chunk, and any chunk the pool had no room for
+    std::vector<Future<void>> futures;
+    std::vector<uint32_t> inlineChunks { 0 };
+    futures.reserve(numChunks - 1);
+    {
+      std::lock_guard<dxvk::mutex> lock(s_threadPoolMutex);
+      InterleaveThreadPool& threadPool = getThreadPool();
+      for (uint32_t chunk = 1; chunk < numChunks; chunk++) {
+        const uint32_t begin = chunk * kVerticesPerChunk;
+        const uint32_t end = std::min(begin + kVerticesPerChunk, args.vertexCount);
+        Future<void> future = threadPool.Schedule([begin, end, dst, src, args]() {
+          interleaveBatched(begin, end, dst, src, args);
+        });
+        if (future.valid()) {
+          futures.push_back(future);
+        } else {
+          inlineChunks.push_back(chunk);
+        }
+      }
+    }
+
+    for (uint32_t chunk : inlineChunks) {
+      const uint32_t begin = chunk * kVerticesPerChunk;
+      interleaveBatched(begin, std::min(begin + kVerticesPerChunk, args.vertexCount), dst, src, args);
+    }
+
+    for (const Future<void>& future : futures) {
+      future.get();
+    }
+  }
+
+  uint32_t CpuGeometryInterleaver::getMaxCpuVertexCount() {
+    if (maxCpuInterleaveVertexCount() != 0) {
+      return maxCpuInterleaveVertexCount();
+    }
+
+    static const uint32_t s_calibratedMaxVertexCount = calibrateMaxCpuVertexCount();
+    return s_calibratedMaxVertexCount;
+  }
+
+} // namespace dxvk
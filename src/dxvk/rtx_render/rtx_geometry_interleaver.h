@@ -0,0 +1,77 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include "rtx_option.h"
+#include "../../util/util_fastops.h"
+#include "rtx/pass/interleave_geometry_indices.h"
+
+namespace dxvk {
+
+  /**
+   * \brief CPU implementation of the interleave_geometry pass
+   *
+   * Produces output bit-identical to the scalar `interleaver::interleave` shared with the compute shader, but
+   * decodes 4 (SSE2) or 8 (AVX2) vertices at a time and splits large meshes into chunks that are processed on
+   * a small worker pool.  Attribute offsets are expected to be applied to the source pointers already (see
+   * GeometryBufferData), and the destination must hold `args.vertexCount * args.outputStride` floats.
+   */
+  class CpuGeometryInterleaver {
+  public:
+    RTX_OPTION("rtx.geometry", uint32_t, maxCpuInterleaveVertexCount, 0, "The largest vertex count for which vertex data is interleaved on the CPU rather than with a compute dispatch.  0 picks the limit from a short CPU benchmark at startup, based on rtx.geometry.gpuInterleaveDispatchCostUs, and caps it at 4096 vertices.");
+    RTX_OPTION("rtx.geometry", float, gpuInterleaveDispatchCostUs, 40.f, "Estimated cost in microseconds of interleaving vertex data with a separate compute dispatch (including the barriers around it), used to pick the CPU interleaving limit when rtx.geometry.maxCpuInterleaveVertexCount is 0.");
+
+    struct Sources {
+      const float* position = nullptr;
+      const float* normal = nullptr;
+      const float* texcoord = nullptr;
+      const uint32_t* color0 = nullptr;
+    };
+
+    static bool formatConversionFloatSupported(uint32_t format);
+    static bool formatConversionUintSupported(uint32_t format);
+
+    // Reference implementation: interleaves vertices [begin, end) one at a time with `interleaver::interleave`.
+    static void interleaveScalar(uint32_t begin, uint32_t end, float* dst, const Sources& src, const InterleaveGeometryArgs& args);
+
+    // Interleaves vertices [begin, end) with the given SIMD level (clamped to what the CPU supports).
+    static void interleaveBatched(uint32_t begin, uint32_t end, float* dst, const Sources& src, const InterleaveGeometryArgs& args,
+                                  fast::SIMD simd = fast::getSimdSupportLevel());
+
+    // Interleaves all `args.vertexCount` vertices, spreading large meshes across the worker pool.
+    static void interleave(float* dst, const Sources& src, const InterleaveGeometryArgs& args);
+
+    // Vertex count up to which interleaving on the CPU is expected to be cheaper than a compute dispatch.
+    static uint32_t getMaxCpuVertexCount();
+
+    static constexpr uint32_t kVerticesPerChunk = 4096;
+    static constexpr uint32_t kMinCpuVertexCount = 1024;
+    // The benchmark reads from cached system memory, while the game's vertex buffers are usually mapped uncached or
+    // write-combined, which is far slower to read.  So the measured crossover is an upper bound, and the automatic
+    // limit stays close to the old fixed limit of 1024.  Keeping it to a single chunk also means that the submitting
+    // thread interleaves inline rather than waiting on the worker pool.
+    static constexpr uint32_t kMaxCpuVertexCount = kVerticesPerChunk;
+  };
+
+} // namespace dxvk
@@ -42,7 +42,8 @@
 #include "rtx/pass/skinning.h"
 #include "rtx/pass/gen_tri_list_index_buffer.h"
 #include "rtx/pass/interleave_geometry_indices.h"
-#include "rtx/pass/interleave_geometry.h"
+#include "rtx_geometry_interleaver.h"
+#include "rtx_uv_tile_size.h"
 
 namespace dxvk {
   static constexpr uint32_t kMaxInterleavedComponents = 3 + 3 + 2 + 1;
@@ -137,87 +138,6 @@ namespace dxvk {
     };
 
     PREWARM_SHADER_PIPELINE(InterleaveGeometryShader);
-
-    float calcUVTileSizeSqr(const Matrix4& objectToWorld, const uint8_t* pVertex, size_t vertexStride, const uint8_t* pTexcoord, size_t texcoordStride, uint32_t vertex1, uint32_t vertex2, uint32_t vertex3) {
-      const Vector4 p1 = objectToWorld * Vector4(*reinterpret_cast<const Vector3* const>(pVertex + vertexStride * vertex1), 1.f);
-      const Vector4 p2 = objectToWorld * Vector4(*reinterpret_cast<const Vector3* const>(pVertex + vertexStride * vertex2), 1.f);
-      const Vector4 p3 = objectToWorld * Vector4(*reinterpret_cast<const Vector3* const>(pVertex + vertexStride * vertex3), 1.f);
-
-      const Vector2& t1 = *reinterpret_cast<const Vector2* const>(pTexcoord + texcoordStride * vertex1);
-      const Vector2& t2 = *reinterpret_cast<const Vector2* const>(pTexcoord + texcoordStride * vertex2);
-      const Vector2& t3 = *reinterpret_cast<const Vector2* const>(pTexcoord + texcoordStride * vertex3);
-      // UV tile size (squared)
-      float len1Sqr = p1 != p2 ? lengthSqr(p1 - p2) / lengthSqr(t1 - t2) : 0.f;
-      float len2Sqr = p1 != p3 ? lengthSqr(p1 - p3) / lengthSqr(t1 - t3) : 0.f;
-      float len3Sqr = p2 != p3 ? lengthSqr(p2 - p3) / lengthSqr(t2 - t3) : 0.f;
-
-      return std::max(len1Sqr, std::max(len2Sqr, len3Sqr));
-    }
-
-
-    float calcMaxUvTileSizeSqrIndexed(uint32_t indexCount, const Matrix4& objectToWorld, const uint8_t* pVertex, size_t vertexStride, const uint8_t* pTexcoord, size_t texcoordStride, const void* pIndexData, size_t indexStride) {
-      float result = 0.f;
-      if (indexStride == 2) {
-        // 16 bit indices
-        const uint16_t* pIndex = static_cast<const uint16_t*>(pIndexData);
-        for (uint32_t i = 0; i < indexCount; i += 3) {
-          uint32_t vertex1 = pIndex[i];
-          uint32_t vertex2 = pIndex[i+1];
-          uint32_t vertex3 = pIndex[i+2];
-
-          result = std::max(result, calcUVTileSizeSqr(objectToWorld, pVertex, vertexStride, pTexcoord, texcoordStride, vertex1, vertex2, vertex3));
-        }
-      } else if (indexStride == 4) {
-        // 32 bit indices
-        const uint32_t* pIndex = static_cast<const uint32_t*>(pIndexData);
-        for (uint32_t i = 0; i + 2 < indexCount; i += 3) {
-          uint32_t vertex1 = pIndex[i];
-          uint32_t vertex2 = pIndex[i+1];
-          uint32_t vertex3 = pIndex[i+2];
-
-          result = std::max(result, calcUVTileSizeSqr(objectToWorld, pVertex, vertexStride, pTexcoord, texcoordStride, vertex1, vertex2, vertex3));
-        }
-      } else {
-        ONCE(Logger::err("calcMaxUvTileSizeSqrIndexed: invalid index stride"));
-      }
-      return result;
-    }
-
-    float calcMaxUvTileSizeSqrTriangles(uint32_t vertexCount, const Matrix4& objectToWorld, const uint8_t* pVertex, size_t vertexStride, const uint8_t* pTexcoord, size_t texcoordStride) {
-      float result = 0.f;
-      for (uint32_t i = 0; i < vertexCount; i += 3) {
-        uint32_t vertex1 = i;
-        uint32_t vertex2 = i+1;
-        uint32_t vertex3 = i+2;
-
-        result = std::max(result, calcUVTileSizeSqr(objectToWorld, pVertex, vertexStride, pTexcoord, texcoordStride, vertex1, vertex2, vertex3));
-      }
-      return result;
-    }
-
-    float calcMaxUvTileSizeSqrTriangleStrip(uint32_t vertexCount, const Matrix4& objectToWorld, const uint8_t* pVertex, size_t vertexStride, const uint8_t* pTexcoord, size_t texcoordStride) {
-      float result = 0.f;
-      for (uint32_t i = 0; i + 2 < vertexCount; ++i) {
-        uint32_t vertex1 = i;
-        uint32_t vertex2 = i+1;
-        uint32_t vertex3 = i+2;
-
-        result = std::max(result, calcUVTileSizeSqr(objectToWorld, pVertex, vertexStride, pTexcoord, texcoordStride, vertex1, vertex2, vertex3));
-      }
-      return result;
-    }
-
-    float calcMaxUvTileSizeSqrTriangleFan(uint32_t vertexCount, const Matrix4& objectToWorld, const uint8_t* pVertex, size_t vertexStride, const uint8_t* pTexcoord, size_t texcoordStride) {
-      float result = 0.f;
-      uint32_t vertex1 = 0;
-      for (uint32_t i = 1; i + 1 < vertexCount; ++i) {
-        uint32_t vertex2 = i+1;
-        uint32_t vertex3 = i+2;
-
-        result = std::max(result, calcUVTileSizeSqr(objectToWorld, pVertex, vertexStride, pTexcoord, texcoordStride, vertex1, vertex2, vertex3));
-      }
-      return result;
-    }
   }
 
   RtxGeometryUtils::RtxGeometryUtils(DxvkDevice* device) : CommonDeviceObject(device) {
@@ -826,7 +746,7 @@ namespace dxvk {
     args.positionOffset = input.positionBuffer.offsetFromSlice() / 4;
     args.positionStride = input.positionBuffer.stride() / 4;
     args.positionFormat = input.positionBuffer.vertexFormat();
-    if (!interleaver::formatConversionFloatSupported(args.positionFormat)) {
+    if (!CpuGeometryInterleaver::formatConversionFloatSupported(args.positionFormat)) {
       ONCE(Logger::err(str::format("[rtx-interleaver] Unsupported position buffer format (", args.positionFormat, ")")));
       return;
     }
@@ -837,7 +757,7 @@ namespace dxvk {
       args.normalOffset = input.normalBuffer.offsetFromSlice() / 4;
       args.normalStride = input.normalBuffer.stride() / 4;
       args.normalFormat = input.normalBuffer.vertexFormat();
-      if (!interleaver::formatConversionFloatSupported(args.normalFormat)) {
+      if (!CpuGeometryInterleaver::formatConversionFloatSupported(args.normalFormat)) {
         ONCE(Logger::warn(str::format("[rtx-interleaver] Unsupported normal buffer format (", args.normalFormat, "), skipping normals")));
       }
     }
@@ -848,7 +768,7 @@ namespace dxvk {
       args.texcoordOffset = input.texcoordBuffer.offsetFromSlice() / 4;
       args.texcoordStride = input.texcoordBuffer.stride() / 4;
       args.texcoordFormat = input.texcoordBuffer.vertexFormat();
-      if (!interleaver::formatConversionFloatSupported(args.texcoordFormat)) {
+      if (!CpuGeometryInterleaver::formatConversionFloatSupported(args.texcoordFormat)) {
         ONCE(Logger::warn(str::format("[rtx-interleaver] Unsupported texcoord buffer format (", args.texcoordFormat, "), skipping texcoord")));
       }
     }
@@ -859,7 +779,7 @@ namespace dxvk {
       args.color0Offset = input.color0Buffer.offsetFromSlice() / 4;
       args.color0Stride = input.color0Buffer.stride() / 4;
       args.color0Format = input.color0Buffer.vertexFormat();
-      if (!interleaver::formatConversionUintSupported(args.color0Format)) {
+      if (!CpuGeometryInterleaver::formatConversionUintSupported(args.color0Format)) {
         ONCE(Logger::warn(str::format("[rtx-interleaver] Unsupported color0 buffer format (", args.color0Format, "), skipping color0")));
       }
     }
@@ -869,8 +789,8 @@ namespace dxvk {
     args.outputStride = output.stride / 4;
     args.vertexCount = input.vertexCount;
 
-    const uint32_t kNumVerticesToProcessOnCPU = 1024;
-    const bool useGPU = input.vertexCount > kNumVerticesToProcessOnCPU || mustUseGPU;
+    // Below the crossover point (measured once at startup) it's cheaper to interleave on the CPU than to record a dispatch
+    const bool useGPU = input.vertexCount > CpuGeometryInterleaver::getMaxCpuVertexCount() || mustUseGPU;
 
     if (useGPU) {
       ctx->bindResourceBuffer(INTERLEAVE_GEOMETRY_BINDING_OUTPUT, DxvkBufferSlice(output.buffer));
@@ -892,7 +812,14 @@ namespace dxvk {
       const VkExtent3D workgroups = util::computeBlockCount(VkExtent3D { input.vertexCount, 1, 1 }, VkExtent3D { 128, 1, 1 });
       ctx->dispatch(workgroups.width, workgroups.height, workgroups.depth);
     } else {
-      float dst[kNumVerticesToProcessOnCPU * kMaxInterleavedComponents];
+      // Small meshes fit on the stack, larger ones (up to the CPU limit) need a heap allocation
+      float stackDst[CpuGeometryInterleaver::kMinCpuVertexCount * kMaxInterleavedComponents];
+      std::vector<float> heapDst;
+      float* dst = stackDst;
+      if (input.vertexCount > CpuGeometryInterleaver::kMinCpuVertexCount) {
+        heapDst.resize(input.vertexCount * args.outputStride);
+        dst = heapDst.data();
+      }
 
       GeometryBufferData inputData(input);
 
@@ -902,9 +829,12 @@ namespace dxvk {
       args.texcoordOffset = 0;
       args.color0Offset = 0;
 
-      for (uint32_t i = 0; i < input.vertexCount; i++) {
-        interleaver::interleave(i, dst, inputData.positionData, inputData.normalData, inputData.texcoordData, inputData.vertexColorData, args);
-      }
+      CpuGeometryInterleaver::Sources sources;
+      sources.position = inputData.positionData;
+      sources.normal = inputData.normalData;
+      sources.texcoord = inputData.texcoordData;
+      sources.color0 = inputData.vertexColorData;
+      CpuGeometryInterleaver::interleave(dst, sources, args);
 
       ctx->writeToBuffer(output.buffer, 0, input.vertexCount * output.stride, dst);
     }
@@ -934,45 +864,25 @@ namespace dxvk {
   }
 
   float RtxGeometryUtils::computeMaxUVTileSize(const RasterGeometry& input, const Matrix4& objectToWorld) {
-    ScopedCpuProfileZone();
-
-    const void* pVertexData = input.positionBuffer.mapPtr((size_t)input.positionBuffer.offsetFromSlice());
-    const uint32_t vertexCount = input.vertexCount;
-    const size_t vertexStride = input.positionBuffer.stride();
-    
-    const void* pTexcoordData = input.texcoordBuffer.mapPtr((size_t)input.texcoordBuffer.offsetFromSlice());
-    const size_t texcoordStride = input.texcoordBuffer.stride();
-
-    const void* pIndexData = input.indexBuffer.mapPtr((size_t)input.indexBuffer.offsetFromSlice());
-    const uint32_t indexCount = input.indexCount;
-    const size_t indexStride = input.indexBuffer.stride();
-
-    if (pVertexData == nullptr || pTexcoordData == nullptr) {
-      return NAN;
-    }
-
-    float maxUvTileSizeSqr = 0.f;
-    const uint8_t* pVertex = static_cast<const uint8_t*>(pVertexData);
-    const uint8_t* pTexcoord = static_cast<const uint8_t*>(pTexcoordData);
-    switch (input.topology) {
-    case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST:
-      if (input.indexCount > 0 && pIndexData != nullptr) {
-        maxUvTileSizeSqr = calcMaxUvTileSizeSqrIndexed(indexCount, objectToWorld, pVertex, vertexStride, pTexcoord, texcoordStride, pIndexData, indexStride);
-      } else {
-        maxUvTileSizeSqr = calcMaxUvTileSizeSqrTriangles(vertexCount, objectToWorld, pVertex, vertexStride, pTexcoord, texcoordStride);
-      }
-      break;
-    case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP:
-      maxUvTileSizeSqr = calcMaxUvTileSizeSqrTriangleStrip(vertexCount, objectToWorld, pVertex, vertexStride, pTexcoord, texcoordStride);
-      break;
-    case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN:
-      maxUvTileSizeSqr = calcMaxUvTileSizeSqrTriangleFan(vertexCount, objectToWorld, pVertex, vertexStride, pTexcoord, texcoordStride);
-      break;
-    default:
-      ONCE(Logger::err("computeMaxUVTileSize: unsupported topology"));
-      return 0;
+    UvTileSizeGeometry geometry;
+    geometry.pVertex = static_cast<const uint8_t*>(input.positionBuffer.mapPtr((size_t)input.positionBuffer.offsetFromSlice()));
+    geometry.vertexStride = input.positionBuffer.stride();
+    geometry.pTexcoord = static_cast<const uint8_t*>(input.texcoordBuffer.mapPtr((size_t)input.texcoordBuffer.offsetFromSlice()));
+    geometry.texcoordStride = input.texcoordBuffer.stride();
+    geometry.pIndex = input.indexBuffer.mapPtr((size_t)input.indexBuffer.offsetFromSlice());
+    geometry.indexStride = input.indexBuffer.stride();
+    geometry.vertexCount = input.vertexCount;
+    geometry.indexCount = input.indexCount;
+    geometry.topology = input.topology;
+
+    // The full geometry hash covers the vertex data, layout and indices.  Only use it when the positions and
+    // texcoords were actually hashed, and mix in the counts and topology the walk depends on.
+    XXH64_hash_t geometryKey = kEmptyHash;
+    if (input.hashes[HashComponents::VertexPosition] != kEmptyHash && input.hashes[HashComponents::VertexTexcoord] != kEmptyHash) {
+      const uint32_t layout[] = { geometry.vertexCount, geometry.indexCount, (uint32_t) geometry.topology };
+      geometryKey = XXH64(layout, sizeof(layout), input.getHashForRule<rules::FullGeometryHash>());
     }
 
-    return std::sqrtf(maxUvTileSizeSqr);
+    return UvTileSizeCalculator::computeMaxUvTileSize(geometry, objectToWorld, geometryKey);
   }
 }
@@ -66,10 +66,13 @@
 #include "../../lssusd/usd_mesh_importer.h"
 #include "../../lssusd/usd_common.h"
 #include "graph/rtx_graph_usd_parser.h"
+#include "rtx_mod_usd_mesh_cache.h"
 
 #include "rtx_lights_data.h"
+#include "../../util/util_threadpool.h"
 #include <filesystem>
 #include <algorithm>
+#include <chrono>
 
 namespace fs = std::filesystem;
 
@@ -101,6 +104,50 @@ private:
     fast_unordered_cache<uint32_t> pathHashToIndexMap;
   };
 
+  // Load-time instrumentation, logged once the mod has finished loading.
+  // Note: times are inclusive, so e.g. the time spent on a point instancer includes the meshes under it.
+  struct LoadStatistics {
+    enum Category : uint32_t {
+      Material,
+      Mesh,
+      MeshDecode,
+      Light,
+      Graph,
+      PointInstancer,
+      Count
+    };
+
+    uint32_t counts[Count] = {};
+    double seconds[Count] = {};
+    double parallelDecodeSeconds = 0.0;
+    uint32_t parallelDecodedMeshes = 0;
+    uint32_t cookedMeshes = 0;
+
+    void reset() {
+      *this = LoadStatistics();
+    }
+
+    void log(const std::string& modPath, double totalSeconds) const;
+  };
+
+  // Accumulates the time between construction and destruction into a LoadStatistics category.
+  class ScopedLoadTimer {
+  public:
+    ScopedLoadTimer(LoadStatistics& stats, LoadStatistics::Category category)
+      : m_stats(stats), m_category(category), m_start(std::chrono::high_resolution_clock::now()) {
+    }
+
+    ~ScopedLoadTimer() {
+      m_stats.counts[m_category]++;
+      m_stats.seconds[m_category] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_start).count();
+    }
+
+  private:
+    LoadStatistics& m_stats;
+    const LoadStatistics::Category m_category;
+    const std::chrono::high_resolution_clock::time_point m_start;
+  };
+
   bool haveFilesChanged();
 
   void processUSD(const Rc<DxvkContext>& context);
@@ -109,7 +156,16 @@ private:
   Rc<ManagedTexture> getTexture(const Args& args, const pxr::UsdPrim& shader, const pxr::TfToken& textureToken, bool forcePreload = false) const;
   MaterialData* processMaterial(Args& args, const pxr::UsdPrim& matPrim);
   MaterialData* processMaterialUser(Args& args, const pxr::UsdPrim& prim);
-  bool processMesh(const pxr::UsdPrim& prim, Args& args);
+  bool processMesh(const pxr::UsdPrim& prim, Args& args, XXH64_hash_t usdOriginHash);
+
+  // Two phase mesh loading: a serial walk over a set of replacement roots collects the mesh prims that still need
+  // decoding, and then the meshes are decoded (read from USD and triangulated) on worker threads.  The decoded
+  // meshes are consumed by processMesh, which still creates the buffers and stores the geometry serially, so the
+  // resulting AssetReplacements are identical to a fully serial load.  Meshes found in the cooked mesh cache are
+  // restored during the walk and skip decoding entirely.
+  void collectMeshesToDecode(const pxr::UsdPrim& prim, std::vector<std::pair<XXH64_hash_t, pxr::UsdPrim>>& meshes, fast_unordered_set& seen);
+  void decodeMeshes(const std::vector<pxr::UsdPrim>& replacementRoots);
+  uint32_t getNumMeshDecodeThreads() const;
   void processPrim(Args& args, const pxr::UsdPrim& prim);
   void processPointInstancer(Args& args, const pxr::UsdPrim& prim);
   std::optional<RtxParticleSystemDesc> processParticleSystem(Args& args, const pxr::UsdPrim& prim);
@@ -133,6 +189,15 @@ private:
 
   Watchdog<1000> m_usdChangeWatchdog;
 
+  GraphTopologyCache m_graphTopologyCache;
+  UsdMeshCookedCache m_meshCookedCache;
+
+  LoadStatistics m_loadStatistics;
+
+  // Meshes that were decoded ahead of processMesh, keyed by the usdOriginHash of the mesh prim.
+  fast_unordered_cache<std::unique_ptr<lss::UsdMeshImporter>> m_decodedMeshes;
+  std::unique_ptr<WorkerThreadPool<4, true, false>> m_meshDecodeThreadPool;
+
   void addReplacementsSync(dxvk::Rc<dxvk::DxvkCommandList> cmdList, XXH64_hash_t hash, std::vector<AssetReplacement>& replacementVec);
   std::unordered_map<dxvk::DxvkCommandList*, std::thread> m_cmdListSyncThreads;
   // Asset replacement vector and hash to add when command list execution is complete
@@ -267,7 +332,7 @@ static std::string resolveTexturePath(
       return resolvedPath.string();
     }
   }
-  Logger::warn(str::format("Unable to resolve full path for ", textureAssetPath));
+  LOG_RATE_LIMITED(LogLevel::Warn, str::format("Unable to resolve full path for ", textureAssetPath));
   return textureAssetPath;
 }
 
@@ -297,7 +362,7 @@ Rc<ManagedTexture> UsdMod::Impl::getTexture(const Args& args, const pxr::UsdPrim
       auto& textureManager = device->getCommon()->getTextureManager();
       return textureManager.preloadTextureAsset(assetData, colorSpace, forcePreload);
     } else if (RtxOptions::Automation::suppressAssetLoadingErrors()) {
-      Logger::warn(str::format("Texture ", resolvedTexturePath, " asset data cannot be found or corrupted."));
+      LOG_RATE_LIMITED(LogLevel::Warn, str::format("Texture ", resolvedTexturePath, " asset data cannot be found or corrupted."));
     } else {
       Logger::err(str::format("Texture ", resolvedTexturePath, " asset data cannot be found or corrupted."));
     }
@@ -309,6 +374,7 @@ Rc<ManagedTexture> UsdMod::Impl::getTexture(const Args& args, const pxr::UsdPrim
 
 MaterialData* UsdMod::Impl::processMaterial(Args& args, const pxr::UsdPrim& matPrim) {
   ScopedCpuProfileZone();
+  ScopedLoadTimer loadTimer(m_loadStatistics, LoadStatistics::Material);
 
   static const pxr::TfToken kShaderToken("Shader");
   static const pxr::TfToken kIgnore("inputs:ignore_material");  // Any draw call or replacement using a material with this flag will be skipped by the SceneManager
@@ -413,7 +479,8 @@ void UsdMod::Impl::processPrim(Args& args, const pxr::UsdPrim& prim) {
   MeshReplacement* pTemp;
   if (!m_owner.m_replacements->getObject(usdOriginHash, pTemp)) {
     // First time seeing this mesh, then process it.
-    if (!processMesh(prim, args)) {
+    ScopedLoadTimer loadTimer(m_loadStatistics, LoadStatistics::Mesh);
+    if (!processMesh(prim, args, usdOriginHash)) {
       return;
     }
   }
@@ -466,6 +533,7 @@ bool hasExplicitTransform(const pxr::UsdPrim& prim) {
 }
 
 void UsdMod::Impl::processLight(Args& args, const pxr::UsdPrim& lightPrim, const bool isRoot) {
+  ScopedLoadTimer loadTimer(m_loadStatistics, LoadStatistics::Light);
   if (args.rootPrim.IsA<pxr::UsdGeomMesh>() && lightPrim.IsA<pxr::UsdLuxDistantLight>()) {
     Logger::err(str::format(
       "A Distant Light detected under ", args.rootPrim.GetName(),
@@ -506,8 +574,9 @@ void UsdMod::Impl::processLight(Args& args, const pxr::UsdPrim& lightPrim, const
 }
 
 void UsdMod::Impl::processGraph(Args& args, const uint32_t meshIndex) {
+  ScopedLoadTimer loadTimer(m_loadStatistics, LoadStatistics::Graph);
   pxr::UsdPrim graphPrim = args.rootPrim.GetStage()->GetPrimAtPath(pxr::SdfPath(args.meshes[meshIndex].primPath));
-  args.meshes[meshIndex].graphState.emplace(GraphUsdParser::parseGraph(*m_owner.m_replacements, graphPrim, args.pathHashToIndexMap));
+  args.meshes[meshIndex].graphState.emplace(GraphUsdParser::parseGraph(*m_owner.m_replacements, graphPrim, args.pathHashToIndexMap, &m_graphTopologyCache));
 }
 
 inline Vector4 toFloat4(const pxr::GfVec4f& v) {
@@ -600,6 +669,7 @@ std::optional<RtxParticleSystemDesc> UsdMod::Impl::processParticleSystem(Args& a
 }
 
 void UsdMod::Impl::processPointInstancer(Args& args, const pxr::UsdPrim& prim) {
+  ScopedLoadTimer loadTimer(m_loadStatistics, LoadStatistics::PointInstancer);
   const pxr::UsdGeomPointInstancer instancer(prim);
   // caching rootPrim, since we need to treat each prototype as having a different rootprim.
   const pxr::UsdPrim rootPrim = args.rootPrim;
@@ -928,6 +998,9 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
   ScopedCpuProfileZone();
   std::string replacementsUsdPath(m_owner.m_filePath.string());
 
+  const auto loadStart = std::chrono::high_resolution_clock::now();
+  m_loadStatistics.reset();
+
   // Open the USD
 
   m_owner.setState(ProgressState::OpeningUSD);
@@ -958,6 +1031,17 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
   // Add stage's base path last.
   AssetDataManager::get().addSearchPath(sublayers.size(), modBaseDirectory);
 
+  // Start from the persisted graph topologies (if any).  Stale entries are never hit, as their keys include the layer modification times.
+  const fs::path graphTopologyCachePath = GraphTopologyCache::getCachePath(replacementsUsdPath);
+  m_graphTopologyCache.clear();
+  if (GraphTopologyCache::persistTopologyCache()) {
+    m_graphTopologyCache.deserialize(graphTopologyCachePath);
+  }
+  const fs::path meshCookedCachePath = modBaseDirectory / UsdMeshCookedCache::kCacheFileName;
+  if (UsdMeshCookedCache::enableCookedMeshCache()) {
+    m_meshCookedCache.open(meshCookedCachePath);
+  }
+
   m_fileModificationTime = fs::last_write_time(fs::path(m_openedFilePath));
   pxr::UsdGeomXformCache xformCache;
 
@@ -1003,26 +1087,47 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
   pxr::UsdPrim meshes = stage->GetPrimAtPath(pxr::SdfPath("/RootNode/meshes"));
   if (meshes.IsValid()) {
     const auto children = meshes.GetFilteredChildren(pxr::UsdPrimIsActive);
+    const std::vector<pxr::UsdPrim> childPrims(children.begin(), children.end());
     std::uint32_t currentMeshCount{ 0U };
 
-    for (pxr::UsdPrim child : children) {
-      const auto hash = getModelHash(child);
+    // Meshes are decoded in parallel a batch of replacements at a time, to bound the memory held by decoded meshes
+    // that haven't been uploaded yet.
+    constexpr size_t kMeshDecodeBatchSize = 256;
+    for (size_t batchStart = 0; batchStart < childPrims.size(); batchStart += kMeshDecodeBatchSize) {
+      const size_t batchEnd = std::min(batchStart + kMeshDecodeBatchSize, childPrims.size());
 
-      if (hash != 0) {
-        std::vector<AssetReplacement> replacementVec;
-        Args args = {context, xformCache, child, replacementVec};
+      std::vector<pxr::UsdPrim> replacementRoots;
+      for (size_t i = batchStart; i < batchEnd; i++) {
+        if (getModelHash(childPrims[i]) != 0) {
+          replacementRoots.push_back(childPrims[i]);
+        }
+      }
+      decodeMeshes(replacementRoots);
 
-        if (processReplacement(args)) {
-          variantCounts[hash]++;
+      for (size_t i = batchStart; i < batchEnd; i++) {
+        const pxr::UsdPrim& child = childPrims[i];
+        const auto hash = getModelHash(child);
 
-          addReplacementsSync(args.context->getCommandList(), hash, replacementVec);
+        if (hash != 0) {
+          std::vector<AssetReplacement> replacementVec;
+          pxr::UsdPrim rootPrim = child;
+          Args args = {context, xformCache, rootPrim, replacementVec};
+
+          if (processReplacement(args)) {
+            variantCounts[hash]++;
+
+            addReplacementsSync(args.context->getCommandList(), hash, replacementVec);
+          }
         }
-      }
 
-      // Note: Update the state progress only every 16 meshes to reduce the number of atomic writes.
-      if ((++currentMeshCount & 0b1111u) == 0u) {
-        m_owner.setStateWithCount(ProgressState::ProcessingMeshes, currentMeshCount);
+        // Note: Update the state progress only every 16 meshes to reduce the number of atomic writes.
+        if ((++currentMeshCount & 0b1111u) == 0u) {
+          m_owner.setStateWithCount(ProgressState::ProcessingMeshes, currentMeshCount);
+        }
       }
+
+      // Anything left over was decoded for a prim that didn't end up needing it.
+      m_decodedMeshes.clear();
     }
   }
 
@@ -1085,6 +1190,22 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
     }
   }
 
+  if (UsdMod::logLoadStatistics()) {
+    m_loadStatistics.log(replacementsUsdPath, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - loadStart).count());
+  }
+
+  if (m_graphTopologyCache.getHitCount() > 0) {
+    Logger::info(str::format("[UsdMod] Reused ", m_graphTopologyCache.getHitCount(), " cached graph topologies."));
+  }
+  if (GraphTopologyCache::persistTopologyCache() && m_graphTopologyCache.isDirty()) {
+    m_graphTopologyCache.serialize(graphTopologyCachePath);
+  }
+  if (UsdMeshCookedCache::enableCookedMeshCache() && m_meshCookedCache.isDirty()) {
+    m_meshCookedCache.write(meshCookedCachePath);
+  }
+  // Release the mapping, so the file can be replaced or deleted while the mod is loaded.
+  m_meshCookedCache.close();
+
   // flush entire cache, kinda a sledgehammer
   context->emitMemoryBarrier(0,
     VK_PIPELINE_STAGE_TRANSFER_BIT,
@@ -1308,18 +1429,39 @@ void UsdMod::Impl::addReplacementsSync(dxvk::Rc<dxvk::DxvkCommandList> cmdList,
   }
 }
 
-bool UsdMod::Impl::processMesh(const pxr::UsdPrim& prim, Args& args) {
+bool UsdMod::Impl::processMesh(const pxr::UsdPrim& prim, Args& args, XXH64_hash_t usdOriginHash) {
   MeshReplacement replacement;
   RasterGeometry& geometryData = replacement.data;
 
   std::unique_ptr<lss::UsdMeshImporter> processedMesh;
 
-  try {
-    processedMesh = std::make_unique<lss::UsdMeshImporter>(prim, RtxOptions::limitedBonesPerVertex());
+  auto decodedMesh = m_decodedMeshes.find(usdOriginHash);
+  if (decodedMesh != m_decodedMeshes.end()) {
+    processedMesh = std::move(decodedMesh->second);
+    m_decodedMeshes.erase(decodedMesh);
   }
-  catch (DxvkError e) {
-    Logger::err(e.message());
-    return false;
+
+  if (processedMesh == nullptr) {
+    // Not decoded ahead of time (or decoding failed, in which case this will report the error).
+    ScopedLoadTimer loadTimer(m_loadStatistics, LoadStatistics::MeshDecode);
+    const XXH64_hash_t cookedKey = UsdMeshCookedCache::enableCookedMeshCache() ? m_meshCookedCache.getMeshKey(prim, RtxOptions::limitedBonesPerVertex()) : kEmptyHash;
+    if (cookedKey != kEmptyHash) {
+      processedMesh = m_meshCookedCache.load(cookedKey, prim);
+    }
+    if (processedMesh == nullptr) {
+      try {
+        processedMesh = std::make_unique<lss::UsdMeshImporter>(prim, RtxOptions::limitedBonesPerVertex());
+      }
+      catch (DxvkError e) {
+        Logger::err(e.message());
+        return false;
+      }
+      if (cookedKey != kEmptyHash) {
+        m_meshCookedCache.store(cookedKey, *processedMesh);
+      }
+    } else {
+      m_loadStatistics.cookedMeshes++;
+    }
   }
 
   geometryData.vertexCount = processedMesh->GetNumVertices();
@@ -1449,6 +1591,143 @@ bool UsdMod::Impl::processMesh(const pxr::UsdPrim& prim, Args& args) {
   return true;
 }
 
+void UsdMod::Impl::collectMeshesToDecode(const pxr::UsdPrim& prim, std::vector<std::pair<XXH64_hash_t, pxr::UsdPrim>>& meshes, fast_unordered_set& seen) {
+  // Note: this must visit the same prims as processReplacementRecursive.  Missing a mesh here is harmless (it will be
+  // decoded serially by processMesh), but visiting extra meshes wastes work.
+  if (prim.IsA<pxr::UsdGeomMesh>()) {
+    const XXH64_hash_t usdOriginHash = getStrongestOpinionatedPathHash(prim);
+    MeshReplacement* existingGeometry;
+    if (seen.insert(usdOriginHash).second && !m_owner.m_replacements->getObject(usdOriginHash, existingGeometry)) {
+      meshes.emplace_back(usdOriginHash, prim);
+    }
+  } else if (prim.IsA<pxr::UsdGeomPointInstancer>()) {
+    pxr::SdfPathVector protoTargets;
+    if (pxr::UsdGeomPointInstancer(prim).GetPrototypesRel().GetForwardedTargets(&protoTargets)) {
+      for (const pxr::SdfPath& protoPath : protoTargets) {
+        pxr::UsdPrim protoPrim = prim.GetStage()->GetPrimAtPath(protoPath);
+        if (protoPrim.IsValid()) {
+          collectMeshesToDecode(protoPrim, meshes, seen);
+        }
+      }
+    }
+    return;
+  }
+
+  for (auto child : prim.GetFilteredChildren(pxr::UsdPrimIsActive)) {
+    collectMeshesToDecode(child, meshes, seen);
+  }
+}
+
+uint32_t UsdMod::Impl::getNumMeshDecodeThreads() const {
+  if (UsdMod::meshDecodeThreads() != 0) {
+    return std::min(UsdMod::meshDecodeThreads(), 255u);
+  }
+  // Leave some cores for the game and the rest of the runtime, which keep running while mods load.
+  return std::clamp(dxvk::thread::hardware_concurrency() / 2, 1u, 16u);
+}
+
+void UsdMod::Impl::decodeMeshes(const std::vector<pxr::UsdPrim>& replacementRoots) {
+  ScopedCpuProfileZone();
+  const uint32_t numThreads = getNumMeshDecodeThreads();
+  const bool useCookedCache = UsdMeshCookedCache::enableCookedMeshCache();
+  if (numThreads <= 1 && !useCookedCache) {
+    return;
+  }
+
+  // Phase 1: serially walk the replacements to find the meshes that still need decoding.
+  std::vector<std::pair<XXH64_hash_t, pxr::UsdPrim>> meshes;
+  fast_unordered_set seen;
+  for (const pxr::UsdPrim& root : replacementRoots) {
+    collectMeshesToDecode(root, meshes, seen);
+  }
+
+  // Restore whatever we can from the cooked mesh cache, the rest is decoded below (or serially by processMesh).
+  std::vector<XXH64_hash_t> cookedKeys(meshes.size(), kEmptyHash);
+  if (useCookedCache) {
+    size_t numToDecode = 0;
+    for (size_t i = 0; i < meshes.size(); i++) {
+      const XXH64_hash_t cookedKey = m_meshCookedCache.getMeshKey(meshes[i].second, RtxOptions::limitedBonesPerVertex());
+      std::unique_ptr<lss::UsdMeshImporter> cookedMesh = cookedKey != kEmptyHash ? m_meshCookedCache.load(cookedKey, meshes[i].second) : nullptr;
+      if (cookedMesh != nullptr) {
+        m_decodedMeshes[meshes[i].first] = std::move(cookedMesh);
+        m_loadStatistics.cookedMeshes++;
+        continue;
+      }
+      meshes[numToDecode] = std::move(meshes[i]);
+      cookedKeys[numToDecode] = cookedKey;
+      numToDecode++;
+    }
+    meshes.resize(numToDecode);
+    cookedKeys.resize(numToDecode);
+  }
+
+  if (numThreads <= 1 || meshes.size() < 2) {
+    return;
+  }
+
+  // Phase 2: decode on worker threads.  Stage reads are safe to do concurrently as nothing edits the stage while
+  // the mod is loading.  Each worker pulls meshes off a shared counter and writes to its own slot, so the results
+  // don't depend on scheduling.
+  const auto start = std::chrono::high_resolution_clock::now();
+  if (m_meshDecodeThreadPool == nullptr) {
+    m_meshDecodeThreadPool = std::make_unique<WorkerThreadPool<4, true, false>>(static_cast<uint8_t>(numThreads), "rtx-usd-mesh-decode");
+  }
+
+  std::vector<std::unique_ptr<lss::UsdMeshImporter>> decoded(meshes.size());
+  std::atomic<size_t> nextMesh = 0;
+  const uint32_t limitedBonesPerVertex = RtxOptions::limitedBonesPerVertex();
+  auto decodeWork = [this, &meshes, &cookedKeys, &decoded, &nextMesh, limitedBonesPerVertex]() {
+    for (size_t i = nextMesh++; i < meshes.size(); i = nextMesh++) {
+      try {
+        decoded[i] = std::make_unique<lss::UsdMeshImporter>(meshes[i].second, limitedBonesPerVertex);
+      } catch (const DxvkError&) {
+        // Leave the slot empty, processMesh will retry on the loading thread and report the error.
+        continue;
+      }
+      if (cookedKeys[i] != kEmptyHash) {
+        m_meshCookedCache.store(cookedKeys[i], *decoded[i]);
+      }
+    }
+  };
+
+  std::vector<Future<void>> futures;
+  for (uint32_t i = 0; i < numThreads; i++) {
+    Future<void> future = m_meshDecodeThreadPool->Schedule([&decodeWork]() { decodeWork(); });
+    if (future.valid()) {
+      futures.push_back(std::move(future));
+    }
+  }
+  // The loading thread helps out too, which also guarantees progress if no work could be scheduled.
+  decodeWork();
+  for (auto& future : futures) {
+    future.get();
+  }
+
+  for (size_t i = 0; i < meshes.size(); i++) {
+    if (decoded[i] != nullptr) {
+      m_decodedMeshes[meshes[i].first] = std::move(decoded[i]);
+      m_loadStatistics.parallelDecodedMeshes++;
+    }
+  }
+  m_loadStatistics.parallelDecodeSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void UsdMod::Impl::LoadStatistics::log(const std::string& modPath, double totalSeconds) const {
+  static const char* kCategoryNames[Count] = { "materials", "meshes", "mesh decodes (serial)", "lights", "graphs", "point instancers" };
+  Logger::info(str::format("[UsdMod] Loaded ", modPath, " in ", totalSeconds, "s"));
+  for (uint32_t i = 0; i < Count; i++) {
+    if (counts[i] > 0) {
+      Logger::info(str::format("[UsdMod]   ", counts[i], " ", kCategoryNames[i], ": ", seconds[i], "s"));
+    }
+  }
+  if (parallelDecodedMeshes > 0) {
+    Logger::info(str::format("[UsdMod]   ", parallelDecodedMeshes, " meshes decoded in parallel: ", parallelDecodeSeconds, "s"));
+  }
+  if (cookedMeshes > 0) {
+    Logger::info(str::format("[UsdMod]   ", cookedMeshes, " meshes restored from the cooked mesh cache"));
+  }
+}
+
 UsdMod::UsdMod(const Mod::Path& usdFilePath)
 : Mod(usdFilePath) {
   m_impl = std::make_unique<Impl>(*this);
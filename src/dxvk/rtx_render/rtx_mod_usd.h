@@ -26,6 +26,7 @@
 #include "rtx_mod_manager.h"
 #include "rtx_asset_replacer.h"
 #include "rtx_utils.h"
+#include "rtx_option.h"
 
 namespace dxvk {
   class DxvkContext;
@@ -37,6 +38,10 @@ namespace dxvk {
    */
   class UsdMod final : public Mod {
   public:
+    RTX_OPTION("rtx.mod", uint32_t, meshDecodeThreads, 0, "The number of worker threads used to decode replacement meshes while a USD mod is loading.\n"
+               "0 picks a thread count based on the number of CPU cores, and 1 decodes the meshes serially on the loading thread.");
+    RTX_OPTION("rtx.mod", bool, logLoadStatistics, true, "Log per prim type counts and timings after a USD mod has finished loading.");
+
     ~UsdMod() override;
 
     void load(const Rc<DxvkContext>& context) override;
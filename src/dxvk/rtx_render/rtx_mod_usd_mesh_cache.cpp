@@ -0,0 +1,596 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <windows.h>
+
+#include "rtx_mod_usd_mesh_cache.h"
+#include "dxvk_scoped_annotation.h"
+#include "../../util/log/log.h"
+#include "../../util/util_math.h"
+#include "../../util/util_string.h"
+
+#include "../../lssusd/usd_include_begin.h"
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/usd/primRange.h>
+#include "../../lssusd/usd_include_end.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace dxvk {
+
+namespace {
+  constexpr uint32_t kCacheMagic = 0x434d5552; // 'RUMC'
+  // Bump this whenever the layout below, or the output of UsdMeshImporter, changes.
+  constexpr uint32_t kCacheVersion = 3;
+  // Sanity limit for any serialized count, to reject corrupted files before allocating.
+  constexpr uint32_t kMaxSerializedCount = 1 << 24;
+  constexpr uint32_t kMaxPathSize = 1 << 15;
+  // Blobs are aligned so that their vertex and index data is suitably aligned within the mapped file.
+  constexpr size_t kBlobAlignment = 16;
+
+  // File layout:
+  //   FileHeader
+  //   numLayers x { uint32_t pathSize, char path[pathSize], int64_t modificationTime, uint64_t fileSize, uint64_t contentHash }
+  //   (aligned to 8) numEntries x FileEntry
+  //   (aligned to kBlobAlignment) mesh blobs, each aligned to kBlobAlignment
+  struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t numLayers;
+    uint32_t numEntries;
+  };
+
+  struct FileEntry {
+    XXH64_hash_t key;
+    uint64_t offset;
+    uint64_t size;
+    XXH64_hash_t blobHash;
+  };
+
+  // Mesh blob layout:
+  //   MeshHeader
+  //   numVertexDecl x VertexDeclRecord
+  //   numSubMeshes x SubMeshRecord, followed by the submesh prim paths
+  //   (aligned to kBlobAlignment) vertex data, followed by the index buffers of all submeshes
+  struct MeshHeader {
+    uint32_t numVertices;
+    uint32_t vertexStride;
+    uint32_t numBonesPerVertex;
+    uint32_t doubleSided;
+    uint32_t isRightHanded;
+    uint32_t numVertexDecl;
+    uint32_t numSubMeshes;
+    uint32_t padding;
+    uint64_t numVertexFloats;
+    float boundingBox[6];
+  };
+
+  struct VertexDeclRecord {
+    uint32_t attribute;
+    uint32_t offset;
+    uint32_t size;
+  };
+
+  struct SubMeshRecord {
+    uint32_t pathSize;
+    uint32_t numIndices;
+  };
+
+  class BlobWriter {
+  public:
+    explicit BlobWriter(std::vector<uint8_t>& data)
+      : m_data(data) {
+    }
+
+    void write(const void* src, size_t size) {
+      const uint8_t* bytes = static_cast<const uint8_t*>(src);
+      m_data.insert(m_data.end(), bytes, bytes + size);
+    }
+
+    template<typename T>
+    void write(const T& value) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      write(&value, sizeof(T));
+    }
+
+    void align(size_t alignment) {
+      m_data.resize(dxvk::align(m_data.size(), alignment), 0);
+    }
+
+  private:
+    std::vector<uint8_t>& m_data;
+  };
+
+  class BlobReader {
+  public:
+    BlobReader(const uint8_t* data, size_t size)
+      : m_data(data), m_size(size) {
+    }
+
+    bool read(void* dst, size_t size) {
+      if (size > m_size - m_offset) {
+        return false;
+      }
+      std::memcpy(dst, m_data + m_offset, size);
+      m_offset += size;
+      return true;
+    }
+
+    template<typename T>
+    bool read(T& value) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      return read(&value, sizeof(T));
+    }
+
+    bool readString(std::string& value, size_t size) {
+      if (size > m_size - m_offset) {
+        return false;
+      }
+      value.assign(reinterpret_cast<const char*>(m_data + m_offset), size);
+      m_offset += size;
+      return true;
+    }
+
+    bool align(size_t alignment) {
+      m_offset = dxvk::align(m_offset, alignment);
+      return m_offset <= m_size;
+    }
+
+  private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset = 0;
+  };
+
+  XXH64_hash_t hashFileContent(const std::string& path) {
+    ScopedCpuProfileZone();
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open()) {
+      return kEmptyHash;
+    }
+
+    XXH3_state_t* state = XXH3_createState();
+    XXH3_64bits_reset(state);
+    std::vector<char> buffer(1 << 20);
+    while (stream) {
+      stream.read(buffer.data(), buffer.size());
+      XXH3_64bits_update(state, buffer.data(), static_cast<size_t>(stream.gcount()));
+    }
+    const XXH64_hash_t hash = XXH3_64bits_digest(state);
+    XXH3_freeState(state);
+    return hash;
+  }
+} // anonymous namespace
+
+UsdMeshCookedCache::~UsdMeshCookedCache() {
+  close();
+}
+
+bool UsdMeshCookedCache::open(const std::filesystem::path& filePath) {
+  ScopedCpuProfileZone();
+  close();
+
+  std::error_code ec;
+  if (!std::filesystem::exists(filePath, ec)) {
+    return false;
+  }
+
+  HANDLE hFile = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE) {
+    Logger::warn(str::format("[UsdMeshCookedCache] Unable to open ", filePath.string(), " (error=", GetLastError(), ")"));
+    return false;
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(FileHeader))) {
+    CloseHandle(hFile);
+    return false;
+  }
+
+  HANDLE hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (hMapping == NULL) {
+    Logger::warn(str::format("[UsdMeshCookedCache] CreateFileMapping fail (error=", GetLastError(), "): ", filePath.string()));
+    CloseHandle(hFile);
+    return false;
+  }
+
+  LPVOID lpBaseAddress = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+  if (lpBaseAddress == NULL) {
+    Logger::warn(str::format("[UsdMeshCookedCache] MapViewOfFile fail (error=", GetLastError(), "): ", filePath.string()));
+    CloseHandle(hMapping);
+    CloseHandle(hFile);
+    return false;
+  }
+
+  m_hFile = hFile;
+  m_hMapping = hMapping;
+  m_mappedData = static_cast<const uint8_t*>(lpBaseAddress);
+  m_mappedSize = static_cast<size_t>(fileSize.QuadPart);
+
+  BlobReader reader(m_mappedData, m_mappedSize);
+  FileHeader header;
+  if (!reader.read(header) || header.magic != kCacheMagic || header.version != kCacheVersion) {
+    Logger::info(str::format("[UsdMeshCookedCache] Ignoring ", filePath.string(), ": unknown format or version."));
+    close();
+    return false;
+  }
+
+  bool success = header.numLayers <= kMaxSerializedCount && header.numEntries <= kMaxSerializedCount;
+  for (uint32_t i = 0; success && i < header.numLayers; i++) {
+    uint32_t pathSize;
+    std::string path;
+    LayerRecord record;
+    success = reader.read(pathSize) && pathSize <= kMaxPathSize && reader.readString(path, pathSize) &&
+              reader.read(record.modificationTime) && reader.read(record.fileSize) && reader.read(record.contentHash);
+    if (success) {
+      m_persistedLayers.emplace(std::move(path), record);
+    }
+  }
+
+  success = success && reader.align(alignof(FileEntry));
+  for (uint32_t i = 0; success && i < header.numEntries; i++) {
+    FileEntry entry;
+    success = reader.read(entry) &&
+              entry.offset % kBlobAlignment == 0 &&
+              entry.offset <= m_mappedSize && entry.size <= m_mappedSize - entry.offset;
+    if (success) {
+      m_mappedEntries.emplace(entry.key, MappedEntry { entry.offset, entry.size, entry.blobHash });
+    }
+  }
+
+  if (!success) {
+    Logger::warn(str::format("[UsdMeshCookedCache] ", filePath.string(), " is corrupted and will be rebuilt."));
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool UsdMeshCookedCache::write(const std::filesystem::path& filePath) {
+  ScopedCpuProfileZone();
+  std::lock_guard<std::mutex> lock(m_storeMutex);
+
+  struct PendingEntry {
+    XXH64_hash_t key;
+    const uint8_t* data;
+    size_t size;
+    XXH64_hash_t blobHash;
+  };
+
+  std::vector<PendingEntry> entries;
+  entries.reserve(m_usedKeys.size());
+  for (const XXH64_hash_t key : m_usedKeys) {
+    auto stored = m_storedEntries.find(key);
+    if (stored != m_storedEntries.end()) {
+      const std::vector<uint8_t>& blob = stored->second;
+      entries.push_back(PendingEntry { key, blob.data(), blob.size(), XXH3_64bits(blob.data(), blob.size()) });
+      continue;
+    }
+    auto mapped = m_mappedEntries.find(key);
+    if (mapped != m_mappedEntries.end()) {
+      entries.push_back(PendingEntry { key, m_mappedData + mapped->second.offset, mapped->second.size, mapped->second.blobHash });
+    }
+  }
+  // Keep the file contents independent of hash map iteration order.
+  std::sort(entries.begin(), entries.end(), [](const PendingEntry& a, const PendingEntry& b) { return a.key < b.key; });
+
+  std::vector<std::pair<std::string, LayerRecord>> layers(m_resolvedLayers.begin(), m_resolvedLayers.end());
+  std::sort(layers.begin(), layers.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  std::vector<uint8_t> tables;
+  BlobWriter writer(tables);
+  writer.write(FileHeader { kCacheMagic, kCacheVersion, static_cast<uint32_t>(layers.size()), static_cast<uint32_t>(entries.size()) });
+  for (const auto& [path, record] : layers) {
+    writer.write(static_cast<uint32_t>(path.size()));
+    writer.write(path.data(), path.size());
+    writer.write(record.modificationTime);
+    writer.write(record.fileSize);
+    writer.write(record.contentHash);
+  }
+  writer.align(alignof(FileEntry));
+
+  uint64_t offset = dxvk::align(tables.size() + entries.size() * sizeof(FileEntry), kBlobAlignment);
+  for (const PendingEntry& entry : entries) {
+    writer.write(FileEntry { entry.key, offset, entry.size, entry.blobHash });
+    offset = dxvk::align(offset + entry.size, kBlobAlignment);
+  }
+  writer.align(kBlobAlignment);
+
+  // Write to a temporary file first, so that a partially written cache is never picked up by the next load.
+  std::filesystem::path tempPath = filePath;
+  tempPath += ".tmp";
+  {
+    std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+    if (!stream.is_open()) {
+      Logger::warn(str::format("[UsdMeshCookedCache] Unable to open ", tempPath.string(), " for writing."));
+      return false;
+    }
+
+    static const char kPadding[kBlobAlignment] = {};
+    stream.write(reinterpret_cast<const char*>(tables.data()), tables.size());
+    for (const PendingEntry& entry : entries) {
+      stream.write(reinterpret_cast<const char*>(entry.data), entry.size);
+      stream.write(kPadding, dxvk::align(entry.size, kBlobAlignment) - entry.size);
+    }
+
+    if (!stream.good()) {
+      Logger::warn(str::format("[UsdMeshCookedCache] Failed to write ", tempPath.string()));
+      return false;
+    }
+  }
+
+  // The old file can't be replaced while it is mapped, and none of the mapped entries are needed anymore.
+  unmap();
+
+  std::error_code ec;
+  std::filesystem::rename(tempPath, filePath, ec);
+  if (ec) {
+    Logger::warn(str::format("[UsdMeshCookedCache] Failed to replace ", filePath.string(), ": ", ec.message()));
+    std::filesystem::remove(tempPath, ec);
+    return false;
+  }
+  m_dirty = false;
+  return true;
+}
+
+void UsdMeshCookedCache::unmap() {
+  if (m_hFile != nullptr) {
+    UnmapViewOfFile(m_mappedData);
+    CloseHandle(m_hMapping);
+    CloseHandle(m_hFile);
+    m_hFile = nullptr;
+    m_hMapping = nullptr;
+    m_mappedData = nullptr;
+    m_mappedSize = 0;
+  }
+  m_mappedEntries.clear();
+}
+
+void UsdMeshCookedCache::close() {
+  unmap();
+
+  std::lock_guard<std::mutex> lock(m_storeMutex);
+  m_persistedLayers.clear();
+  m_resolvedLayers.clear();
+  m_resolvedLayerHashes.clear();
+  m_usedKeys.clear();
+  m_storedEntries.clear();
+  m_dirty = false;
+  m_hits = 0;
+}
+
+XXH64_hash_t UsdMeshCookedCache::getLayerContentHash(const pxr::SdfLayerHandle& layer) {
+  const std::string& identifier = layer->GetIdentifier();
+  auto resolved = m_resolvedLayerHashes.find(identifier);
+  if (resolved != m_resolvedLayerHashes.end()) {
+    return resolved->second;
+  }
+
+  XXH64_hash_t contentHash = kEmptyHash;
+  const std::string& realPath = layer->GetRealPath();
+  if (realPath.empty()) {
+    // In-memory layers have nothing on disk to compare against, so hash their current contents instead.
+    std::string content;
+    if (layer->ExportToString(&content)) {
+      contentHash = XXH3_64bits(content.data(), content.size());
+    }
+  } else if (!layer->IsDirty()) {
+    // Layers with unsaved edits don't match their file on disk, so they can't be safely cached.
+    std::error_code ec;
+    const auto modificationTime = std::filesystem::last_write_time(realPath, ec);
+    const uint64_t fileSize = ec ? 0 : std::filesystem::file_size(realPath, ec);
+    if (!ec) {
+      LayerRecord record { static_cast<int64_t>(modificationTime.time_since_epoch().count()), fileSize, kEmptyHash };
+      auto persisted = m_persistedLayers.find(realPath);
+      if (persisted != m_persistedLayers.end() &&
+          persisted->second.modificationTime == record.modificationTime &&
+          persisted->second.fileSize == record.fileSize) {
+        record.contentHash = persisted->second.contentHash;
+      } else {
+        // Only re-hash layers that were touched since the cache was written.  If the content turns out to be the
+        // same (e.g. the layer was re-saved without changes), the existing entries still apply.
+        record.contentHash = hashFileContent(realPath);
+        m_dirty = true;
+      }
+      contentHash = record.contentHash;
+      if (contentHash != kEmptyHash) {
+        m_resolvedLayers[realPath] = record;
+      }
+    }
+  }
+
+  m_resolvedLayerHashes.emplace(identifier, contentHash);
+  return contentHash;
+}
+
+XXH64_hash_t UsdMeshCookedCache::getMeshKey(const pxr::UsdPrim& meshPrim, uint32_t limitedBonesPerVertex) {
+  ScopedCpuProfileZone();
+  XXH64_hash_t key = XXH3_64bits(&kCacheVersion, sizeof(kCacheVersion));
+  key = XXH3_64bits_withSeed(&limitedBonesPerVertex, sizeof(limitedBonesPerVertex), key);
+
+  // The mesh and its geom subsets.  Absolute paths are included as the submeshes are restored by path.
+  for (const pxr::UsdPrim& prim : pxr::UsdPrimRange(meshPrim)) {
+    const std::string primPath = prim.GetPath().GetString();
+    key = XXH3_64bits_withSeed(primPath.c_str(), primPath.size(), key);
+    for (const pxr::SdfPrimSpecHandle& spec : prim.GetPrimStack()) {
+      const XXH64_hash_t layerHash = getLayerContentHash(spec->GetLayer());
+      if (layerHash == kEmptyHash) {
+        return kEmptyHash;
+      }
+      const std::string specPath = spec->GetPath().GetString();
+      key = XXH3_64bits_withSeed(&layerHash, sizeof(layerHash), key);
+      key = XXH3_64bits_withSeed(specPath.c_str(), specPath.size(), key);
+    }
+  }
+  return key;
+}
+
+std::unique_ptr<lss::UsdMeshImporter> UsdMeshCookedCache::load(XXH64_hash_t key, const pxr::UsdPrim& meshPrim) {
+  ScopedCpuProfileZone();
+  auto mapped = m_mappedEntries.find(key);
+  if (mapped == m_mappedEntries.end()) {
+    return nullptr;
+  }
+
+  const uint8_t* data = m_mappedData + mapped->second.offset;
+  const size_t size = mapped->second.size;
+  lss::UsdMeshImporter::CookedMesh cookedMesh;
+  if (XXH3_64bits(data, size) != mapped->second.blobHash || !deserializeMesh(data, size, cookedMesh)) {
+    Logger::warn(str::format("[UsdMeshCookedCache] Corrupted entry for mesh ", meshPrim.GetPath().GetString(), ", it will be re-processed."));
+    m_mappedEntries.erase(mapped);
+    return nullptr;
+  }
+
+  std::unique_ptr<lss::UsdMeshImporter> mesh;
+  try {
+    mesh = std::make_unique<lss::UsdMeshImporter>(meshPrim, std::move(cookedMesh));
+  } catch (const DxvkError&) {
+    return nullptr;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_storeMutex);
+    m_usedKeys.insert(key);
+  }
+  m_hits++;
+  return mesh;
+}
+
+void UsdMeshCookedCache::store(XXH64_hash_t key, const lss::UsdMeshImporter& mesh) {
+  ScopedCpuProfileZone();
+  std::vector<uint8_t> blob = serializeMesh(mesh.Cook());
+
+  std::lock_guard<std::mutex> lock(m_storeMutex);
+  m_storedEntries.insert_or_assign(key, std::move(blob));
+  m_usedKeys.insert(key);
+  m_dirty = true;
+}
+
+std::vector<uint8_t> UsdMeshCookedCache::serializeMesh(const lss::UsdMeshImporter::CookedMesh& mesh) {
+  size_t numIndices = 0;
+  for (const auto& subMesh : mesh.subMeshes) {
+    numIndices += subMesh.indexBuffer.size();
+  }
+
+  std::vector<uint8_t> data;
+  data.reserve(sizeof(MeshHeader) + 256 + mesh.vertexData.size() * sizeof(float) + numIndices * sizeof(uint32_t));
+  BlobWriter writer(data);
+
+  MeshHeader header {};
+  header.numVertices = mesh.numVertices;
+  header.vertexStride = mesh.vertexStride;
+  header.numBonesPerVertex = mesh.numBonesPerVertex;
+  header.doubleSided = static_cast<uint32_t>(mesh.doubleSided);
+  header.isRightHanded = mesh.isRightHanded ? 1 : 0;
+  header.numVertexDecl = static_cast<uint32_t>(mesh.vertexDecl.size());
+  header.numSubMeshes = static_cast<uint32_t>(mesh.subMeshes.size());
+  header.numVertexFloats = mesh.vertexData.size();
+  for (uint32_t i = 0; i < 3; i++) {
+    header.boundingBox[i] = mesh.boundingBox.minPos[i];
+    header.boundingBox[3 + i] = mesh.boundingBox.maxPos[i];
+  }
+  writer.write(header);
+
+  for (const auto& decl : mesh.vertexDecl) {
+    writer.write(VertexDeclRecord { static_cast<uint32_t>(decl.attribute), static_cast<uint32_t>(decl.offset), static_cast<uint32_t>(decl.size) });
+  }
+  for (const auto& subMesh : mesh.subMeshes) {
+    writer.write(SubMeshRecord { static_cast<uint32_t>(subMesh.primPath.size()), static_cast<uint32_t>(subMesh.indexBuffer.size()) });
+  }
+  for (const auto& subMesh : mesh.subMeshes) {
+    writer.write(subMesh.primPath.data(), subMesh.primPath.size());
+  }
+
+  writer.align(kBlobAlignment);
+  writer.write(mesh.vertexData.data(), mesh.vertexData.size() * sizeof(float));
+  for (const auto& subMesh : mesh.subMeshes) {
+    writer.write(subMesh.indexBuffer.data(), subMesh.indexBuffer.size() * sizeof(uint32_t));
+  }
+  return data;
+}
+
+bool UsdMeshCookedCache::deserializeMesh(const uint8_t* data, size_t size, lss::UsdMeshImporter::CookedMesh& mesh) {
+  BlobReader reader(data, size);
+
+  MeshHeader header;
+  if (!reader.read(header) ||
+      header.vertexStride == 0 || header.vertexStride % sizeof(float) != 0 ||
+      header.doubleSided > lss::UsdMeshImporter::IsDoubleSided ||
+      header.numVertexDecl > lss::UsdMeshImporter::Attributes::Count ||
+      header.numSubMeshes > kMaxSerializedCount ||
+      header.numVertexFloats != static_cast<uint64_t>(header.numVertices) * header.vertexStride / sizeof(float)) {
+    return false;
+  }
+
+  mesh.numVertices = header.numVertices;
+  mesh.vertexStride = header.vertexStride;
+  mesh.numBonesPerVertex = header.numBonesPerVertex;
+  mesh.doubleSided = static_cast<lss::UsdMeshImporter::DoubleSidedState>(header.doubleSided);
+  mesh.isRightHanded = header.isRightHanded != 0;
+  mesh.boundingBox = AxisAlignedBoundingBox {
+    Vector3(header.boundingBox[0], header.boundingBox[1], header.boundingBox[2]),
+    Vector3(header.boundingBox[3], header.boundingBox[4], header.boundingBox[5]) };
+
+  mesh.vertexDecl.resize(header.numVertexDecl);
+  for (auto& decl : mesh.vertexDecl) {
+    VertexDeclRecord record;
+    if (!reader.read(record) ||
+        record.attribute >= lss::UsdMeshImporter::Attributes::Count ||
+        record.offset + record.size > header.vertexStride) {
+      return false;
+    }
+    decl = { static_cast<lss::UsdMeshImporter::Attributes>(record.attribute), record.offset, record.size };
+  }
+
+  std::vector<SubMeshRecord> subMeshRecords(header.numSubMeshes);
+  for (SubMeshRecord& record : subMeshRecords) {
+    if (!reader.read(record) || record.pathSize > kMaxPathSize || record.numIndices > size / sizeof(uint32_t)) {
+      return false;
+    }
+  }
+  mesh.subMeshes.resize(header.numSubMeshes);
+  for (uint32_t i = 0; i < header.numSubMeshes; i++) {
+    if (!reader.readString(mesh.subMeshes[i].primPath, subMeshRecords[i].pathSize)) {
+      return false;
+    }
+  }
+
+  if (!reader.align(kBlobAlignment) || header.numVertexFloats > size / sizeof(float)) {
+    return false;
+  }
+  mesh.vertexData.resize(header.numVertexFloats);
+  if (!reader.read(mesh.vertexData.data(), mesh.vertexData.size() * sizeof(float))) {
+    return false;
+  }
+  for (uint32_t i = 0; i < header.numSubMeshes; i++) {
+    std::vector<uint32_t>& indices = mesh.subMeshes[i].indexBuffer;
+    indices.resize(subMeshRecords[i].numIndices);
+    if (!reader.read(indices.data(), indices.size() * sizeof(uint32_t))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace dxvk
@@ -0,0 +1,125 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rtx_option.h"
+#include "../../util/util_fast_cache.h"
+#include "../../lssusd/usd_mesh_importer.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Cooked mesh cache
+   *
+   * On-disk cache of processed (triangulated and interleaved) replacement meshes, so that loading a mod whose
+   * layers have not changed can skip USD mesh processing.  Entries are keyed by a hash of the content of every
+   * layer contributing to the mesh prim and its subsets, plus the import options.  Layer content hashes are
+   * persisted alongside the file size and modification time, so a layer is only re-hashed when it was touched.
+   *
+   * The file is mapped read-only while a mod loads: the header and tables are parsed once, and mesh blobs are
+   * validated against their stored hash and copied straight out of the mapping when requested.
+   */
+  class UsdMeshCookedCache {
+  public:
+    RTX_OPTION("rtx.mod", bool, enableCookedMeshCache, true, "Write processed replacement meshes to a cache file next to the mod, so that later loads can skip mesh processing for meshes whose source layers have not changed.");
+
+    static constexpr const char* kCacheFileName = "mesh_cooked.cache";
+
+    UsdMeshCookedCache() = default;
+    ~UsdMeshCookedCache();
+
+    UsdMeshCookedCache(const UsdMeshCookedCache&) = delete;
+    UsdMeshCookedCache& operator=(const UsdMeshCookedCache&) = delete;
+
+    // Maps an existing cache file.  Returns false (leaving the cache empty) if the file is missing or invalid.
+    bool open(const std::filesystem::path& filePath);
+
+    // Writes every entry that was looked up or stored since `open`, dropping entries that are no longer used.
+    bool write(const std::filesystem::path& filePath);
+
+    void close();
+
+    // Returns kEmptyHash if the mesh can't be cached, e.g. because one of its layers has unsaved edits.
+    XXH64_hash_t getMeshKey(const pxr::UsdPrim& meshPrim, uint32_t limitedBonesPerVertex);
+
+    // Returns nullptr on a miss.  Must be called on the thread that owns the cache.
+    std::unique_ptr<lss::UsdMeshImporter> load(XXH64_hash_t key, const pxr::UsdPrim& meshPrim);
+
+    // Safe to call from multiple threads.
+    void store(XXH64_hash_t key, const lss::UsdMeshImporter& mesh);
+
+    bool isDirty() const {
+      return m_dirty;
+    }
+
+    size_t getHitCount() const {
+      return m_hits;
+    }
+
+    static std::vector<uint8_t> serializeMesh(const lss::UsdMeshImporter::CookedMesh& mesh);
+    static bool deserializeMesh(const uint8_t* data, size_t size, lss::UsdMeshImporter::CookedMesh& mesh);
+
+  private:
+    struct LayerRecord {
+      int64_t modificationTime = 0;
+      uint64_t fileSize = 0;
+      XXH64_hash_t contentHash = kEmptyHash;
+    };
+
+    struct MappedEntry {
+      uint64_t offset = 0;
+      uint64_t size = 0;
+      XXH64_hash_t blobHash = kEmptyHash;
+    };
+
+    XXH64_hash_t getLayerContentHash(const pxr::SdfLayerHandle& layer);
+    void unmap();
+
+    // Layer records read from the cache file, and the ones resolved during this load, keyed by real path.
+    std::unordered_map<std::string, LayerRecord> m_persistedLayers;
+    std::unordered_map<std::string, LayerRecord> m_resolvedLayers;
+    // Layer hashes resolved during this load, keyed by layer identifier.
+    std::unordered_map<std::string, XXH64_hash_t> m_resolvedLayerHashes;
+
+    fast_unordered_cache<MappedEntry> m_mappedEntries;
+    fast_unordered_set m_usedKeys;
+
+    std::mutex m_storeMutex;
+    fast_unordered_cache<std::vector<uint8_t>> m_storedEntries;
+
+    void* m_hFile = nullptr;
+    void* m_hMapping = nullptr;
+    const uint8_t* m_mappedData = nullptr;
+    size_t m_mappedSize = 0;
+
+    bool m_dirty = false;
+    size_t m_hits = 0;
+  };
+
+} // namespace dxvk
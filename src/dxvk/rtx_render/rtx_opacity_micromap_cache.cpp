@@ -0,0 +1,77 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_opacity_micromap_cache.h"
+
+#include <algorithm>
+
+#include "../util/log/log.h"
+#include "../util/util_once.h"
+#include "../util/util_string.h"
+
+namespace dxvk {
+  OpacityMicromapMemoryBudget::OpacityMicromapMemoryBudget(uint32_t numPendingReleaseFrames)
+    : m_pendingReleaseSize(std::max(numPendingReleaseFrames, 1u), 0) {
+  }
+
+  void OpacityMicromapMemoryBudget::onFrameStart() {
+    uint64_t& pendingReleaseSize = m_pendingReleaseSize[m_nextPendingRelease];
+    const uint64_t sizeToRelease = std::min(pendingReleaseSize, m_used);
+
+    m_pendingReleaseTotalSize -= pendingReleaseSize;
+    pendingReleaseSize = 0;
+    m_nextPendingRelease = (m_nextPendingRelease + 1) % static_cast<uint32_t>(m_pendingReleaseSize.size());
+
+    m_used -= sizeToRelease;
+  }
+
+  bool OpacityMicromapMemoryBudget::allocate(uint64_t size) {
+    if (size > getAvailable()) {
+      ONCE(Logger::info(str::format("[RTX Opacity Micromap] Out of memory budget. Requested: ", size, " bytes. Free: ", getAvailable(), " bytes, Budget: ", getBudget(), " bytes")));
+      return false;
+    }
+
+    m_used += size;
+
+    return true;
+  }
+
+  uint64_t OpacityMicromapMemoryBudget::getAvailable() const {
+    return m_budget - std::min(m_used, m_budget);
+  }
+
+  void OpacityMicromapMemoryBudget::release(uint64_t size) {
+    m_pendingReleaseSize[m_nextPendingRelease] += size;
+    m_pendingReleaseTotalSize += size;
+  }
+
+  void OpacityMicromapMemoryBudget::releaseAll() {
+    release(m_used);
+  }
+
+  float OpacityMicromapMemoryBudget::calculateUsageRatio() const {
+    return m_used / static_cast<float>(m_budget);
+  }
+
+  uint64_t OpacityMicromapMemoryBudget::calculatePendingAvailableSize() const {
+    return std::min(getAvailable() + calculatePendingReleasedSize(), m_budget);
+  }
+}
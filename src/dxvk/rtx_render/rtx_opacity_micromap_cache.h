@@ -0,0 +1,345 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "rtx_constants.h"
+#include "../../util/util_fast_cache.h"
+
+namespace dxvk {
+
+  enum class OpacityMicromapCacheState {
+    eStep0_Unprocessed = 0, // Cache items that use OMMs but yet to have any data generated for them
+    eStep1_Baking,          // Cache items with OMM arrays being baked but not all baking tasks have been submitted
+    eStep2_Baked,           // Cache items with baked OMM arrays
+    eStep3_Built,           // Cache items with built OMMs, but require barrier sync before use in a BLAS build
+    eStep4_Ready,           // Cache items with built OMMs
+
+    eUnknown
+  };
+
+  // Tracks the VRAM budget used by Opacity Micromap data.
+  // Released memory is returned to the budget with a delay accounting for lifetime management of resources in flight.
+  // Budget is set by the owner, which is the only part that needs to query the device.
+  class OpacityMicromapMemoryBudget {
+  public:
+    explicit OpacityMicromapMemoryBudget(uint32_t numPendingReleaseFrames);
+
+    // Returns the memory released the longest time ago back to the budget
+    void onFrameStart();
+
+    bool allocate(uint64_t size);
+    uint64_t getAvailable() const;
+    void release(uint64_t size);
+    void releaseAll();
+
+    uint64_t getBudget() const { return m_budget; }
+    uint64_t getPrevBudget() const { return m_prevBudget; }
+    uint64_t getUsed() const { return m_used; }
+    float calculateUsageRatio() const;
+    uint64_t calculatePendingAvailableSize() const;
+    uint64_t calculatePendingReleasedSize() const { return m_pendingReleaseTotalSize; }
+    uint64_t getNextPendingReleasedSize() const { return m_pendingReleaseSize[m_nextPendingRelease]; }
+
+  protected:
+    uint64_t m_used = 0;
+    uint64_t m_budget = 0;
+    uint64_t m_prevBudget = 0;
+
+  private:
+    // Stores amount of memory released per frame as a ring, with a running total so that
+    // eviction can query the pending size on every iteration for free
+    std::vector<uint64_t> m_pendingReleaseSize;
+    uint32_t m_nextPendingRelease = 0;
+    uint64_t m_pendingReleaseTotalSize = 0;
+  };
+
+  // Pool of Opacity Micromap cache items keyed by their OMM source hash.
+  // Items are constructed in place in fixed size slabs, so they never move, and are addressed by index.
+  // Every item is linked into at most one state list and always into the LRU list with intrusive links,
+  // so state transitions, LRU updates and eviction are O(1) and don't allocate or look up the hash.
+  template<typename T>
+  class OpacityMicromapCachePool {
+  public:
+    typedef uint32_t Index;
+    static constexpr Index kInvalidIndex = UINT32_MAX;
+
+    // Ordered lists starting with oldest and/or smallest inserted items
+    enum class List : uint8_t {
+      Unprocessed = 0,  // OMM data requests that are yet to be baked
+      Baked,            // Items with baked OMM arrays
+      Built,            // Items with built OMMs but require synchronization
+      Count,
+
+      None = Count
+    };
+
+    OpacityMicromapCachePool() = default;
+
+    ~OpacityMicromapCachePool() {
+      clear();
+    }
+
+    OpacityMicromapCachePool(const OpacityMicromapCachePool&) = delete;
+    OpacityMicromapCachePool& operator=(const OpacityMicromapCachePool&) = delete;
+
+    Index find(XXH64_hash_t hash) const {
+      auto iter = m_hashToIndex.find(hash);
+      return iter != m_hashToIndex.end() ? iter->second : kInvalidIndex;
+    }
+
+    // Adds a new item as the most recently used one. It is not linked to any state list.
+    template<typename... Args>
+    Index emplace(XXH64_hash_t hash, Args&&... args) {
+      assert(find(hash) == kInvalidIndex);
+
+      Index index;
+      if (m_freeList != kInvalidIndex) {
+        index = m_freeList;
+        m_freeList = m_nodes[index].state.next;
+      } else {
+        index = static_cast<Index>(m_nodes.size());
+        if ((index >> kSlabSizeLog2) == m_slabs.size())
+          m_slabs.emplace_back(new Slot[kSlabSize]);
+        m_nodes.emplace_back();
+      }
+
+      new (getStorage(index)) T(std::forward<Args>(args)...);
+
+      Node& node = m_nodes[index];
+      node = Node();
+      node.hash = hash;
+      node.isAllocated = true;
+      link(m_lru, &Node::lru, kInvalidIndex, index);
+      m_hashToIndex.emplace(hash, index);
+
+      return index;
+    }
+
+    void erase(Index index) {
+      Node& node = m_nodes[index];
+      assert(node.isAllocated);
+
+      unlink(index);
+      unlink(m_lru, &Node::lru, index);
+      m_hashToIndex.erase(node.hash);
+      std::launder(reinterpret_cast<T*>(getStorage(index)))->~T();
+
+      node.isAllocated = false;
+      node.state.next = m_freeList;
+      m_freeList = index;
+    }
+
+    // Destroys all items. Slab memory is retained for reuse.
+    void clear() {
+      for (Index index = 0; index < m_nodes.size(); index++) {
+        if (m_nodes[index].isAllocated)
+          std::launder(reinterpret_cast<T*>(getStorage(index)))->~T();
+      }
+
+      m_nodes.clear();
+      m_hashToIndex.clear();
+      m_freeList = kInvalidIndex;
+      m_lru = ListHead();
+      for (ListHead& list : m_lists)
+        list = ListHead();
+    }
+
+    T& operator[](Index index) {
+      assert(m_nodes[index].isAllocated);
+      return *std::launder(reinterpret_cast<T*>(getStorage(index)));
+    }
+
+    const T& operator[](Index index) const {
+      assert(m_nodes[index].isAllocated);
+      return *std::launder(reinterpret_cast<const T*>(getStorage(index)));
+    }
+
+    XXH64_hash_t getHash(Index index) const {
+      return m_nodes[index].hash;
+    }
+
+    size_t size() const {
+      return m_hashToIndex.size();
+    }
+
+    // State lists
+
+    List getList(Index index) const {
+      return m_nodes[index].list;
+    }
+
+    // Moves the item to the end of a state list, unlinking it from its current state list first
+    void pushBack(List list, Index index) {
+      insertBefore(list, kInvalidIndex, index);
+    }
+
+    // Moves the item in front of the position item in a state list, or to its end for kInvalidIndex
+    void insertBefore(List list, Index position, Index index) {
+      assert(list != List::None && position != index);
+      assert(position == kInvalidIndex || m_nodes[position].list == list);
+
+      unlink(index);
+      link(m_lists[static_cast<uint32_t>(list)], &Node::state, position, index);
+      m_nodes[index].list = list;
+    }
+
+    // Unlinks the item from its state list, if it's in one
+    void unlink(Index index) {
+      Node& node = m_nodes[index];
+      if (node.list == List::None)
+        return;
+
+      unlink(m_lists[static_cast<uint32_t>(node.list)], &Node::state, index);
+      node.list = List::None;
+    }
+
+    void unlinkAll(List list) {
+      ListHead& head = m_lists[static_cast<uint32_t>(list)];
+      for (Index index = head.first; index != kInvalidIndex; ) {
+        Node& node = m_nodes[index];
+        index = node.state.next;
+        node.state = Link();
+        node.list = List::None;
+      }
+      head = ListHead();
+    }
+
+    Index front(List list) const {
+      return m_lists[static_cast<uint32_t>(list)].first;
+    }
+
+    // Next item in the same state list
+    Index next(Index index) const {
+      return m_nodes[index].state.next;
+    }
+
+    size_t size(List list) const {
+      return m_lists[static_cast<uint32_t>(list)].size;
+    }
+
+    bool empty(List list) const {
+      return size(list) == 0;
+    }
+
+    // LRU list
+
+    // Marks the item as the most recently used one
+    void touch(Index index) {
+      if (m_lru.last == index)
+        return;
+
+      unlink(m_lru, &Node::lru, index);
+      link(m_lru, &Node::lru, kInvalidIndex, index);
+    }
+
+    Index leastRecentlyUsed() const {
+      return m_lru.first;
+    }
+
+    Index nextMoreRecentlyUsed(Index index) const {
+      return m_nodes[index].lru.next;
+    }
+
+  private:
+    static constexpr uint32_t kSlabSizeLog2 = 8;
+    static constexpr uint32_t kSlabSize = 1u << kSlabSizeLog2;
+
+    struct Link {
+      Index prev = kInvalidIndex;
+      Index next = kInvalidIndex;
+    };
+
+    struct Node {
+      XXH64_hash_t hash = kEmptyHash;
+      Link state;         // Free list link for unallocated nodes
+      Link lru;
+      List list = List::None;
+      bool isAllocated = false;
+    };
+
+    struct ListHead {
+      Index first = kInvalidIndex;
+      Index last = kInvalidIndex;
+      size_t size = 0;
+    };
+
+    struct Slot {
+      alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    void* getStorage(Index index) const {
+      return m_slabs[index >> kSlabSizeLog2][index & (kSlabSize - 1)].storage;
+    }
+
+    void link(ListHead& head, Link Node::* member, Index position, Index index) {
+      Link& link = m_nodes[index].*member;
+      link.next = position;
+      link.prev = position != kInvalidIndex ? (m_nodes[position].*member).prev : head.last;
+
+      if (link.prev != kInvalidIndex)
+        (m_nodes[link.prev].*member).next = index;
+      else
+        head.first = index;
+
+      if (position != kInvalidIndex)
+        (m_nodes[position].*member).prev = index;
+      else
+        head.last = index;
+
+      head.size++;
+    }
+
+    void unlink(ListHead& head, Link Node::* member, Index index) {
+      Link& link = m_nodes[index].*member;
+
+      if (link.prev != kInvalidIndex)
+        (m_nodes[link.prev].*member).next = link.next;
+      else
+        head.first = link.next;
+
+      if (link.next != kInvalidIndex)
+        (m_nodes[link.next].*member).prev = link.prev;
+      else
+        head.last = link.prev;
+
+      link = Link();
+      head.size--;
+    }
+
+    std::vector<Node> m_nodes;
+    std::vector<std::unique_ptr<Slot[]>> m_slabs;
+    Index m_freeList = kInvalidIndex;
+
+    ListHead m_lists[static_cast<uint32_t>(List::Count)];
+    ListHead m_lru;   // Starts with the least recently used item
+
+    fast_unordered_cache<Index> m_hashToIndex;
+  };
+
+}
@@ -59,26 +59,14 @@ namespace dxvk {
     opacityMicromapBuffer = nullptr;
   }
 
-  OpacityMicromapCacheItem::OpacityMicromapCacheItem() {
-    // Default constructor is needed for [] access into OMM cache, but it must not be called
-    // for a case when the cache item is not already present in the cache
-    assert(0 && "Invalid state. Default constructor for OpacityMicromapCacheItem should never be called.");
-    Logger::err("[RTX Opacity Micromap] Encountered inconsistent state. Default constructor for OpacityMicromapCacheItem should never be called.");
-  }
-
   OpacityMicromapCacheItem::OpacityMicromapCacheItem(DxvkDevice& device,
                                                      OpacityMicromapCacheState _cacheState,
                                                      const uint32_t inputSubdivisionLevel,
                                                      const bool enableVertexAndTextureOperations,
                                                      uint32_t currentFrameIndex,
-                                                     std::list<XXH64_hash_t>::iterator _leastRecentlyUsedListIter,
-                                                     std::list<XXH64_hash_t>::iterator _cacheStateListIter,
                                                      const OmmRequest& ommRequest)
     : cacheState(_cacheState)
     , lastUseFrameIndex(currentFrameIndex)
-    , leastRecentlyUsedListIter(_leastRecentlyUsedListIter)
-    , cacheStateListIter(_cacheStateListIter)
-    , isUnprocessedCacheStateListIterValid(true)
     , numTriangles(ommRequest.numTriangles)
     , ommFormat(ommRequest.ommFormat) {
     useVertexAndTextureOperations = enableVertexAndTextureOperations;
@@ -98,23 +86,15 @@ namespace dxvk {
     return blasOmmBuffersDeviceSize + arrayBufferDeviceSize;
   }
 
+  // +1 to account for OMMs used in a previous TLAS
+  static uint32_t getMaxFramesOMMResourcesAreUsed() {
+    return kMaxFramesInFlight + (RtxOptions::enablePreviousTLAS() ? 1u : 0u);
+  }
+
   OpacityMicromapMemoryManager::OpacityMicromapMemoryManager(DxvkDevice* device)
     : CommonDeviceObject(device)
+    , OpacityMicromapMemoryBudget(getMaxFramesOMMResourcesAreUsed())
     , m_memoryProperties(device->adapter()->memoryProperties()) {
-    // +1 to account for OMMs used in a previous TLAS
-    const uint32_t kMaxFramesOMMResourcesAreUsed = kMaxFramesInFlight + (RtxOptions::enablePreviousTLAS() ? 1u : 0u);
-
-    for (uint32_t i = 0; i < kMaxFramesOMMResourcesAreUsed; i++) {
-      m_pendingReleaseSize.push_front(0);
-    }
-  }
-
-  void OpacityMicromapMemoryManager::onFrameStart() {
-    VkDeviceSize sizeToRelease = std::min(m_pendingReleaseSize.back(), m_used);
-    m_pendingReleaseSize.pop_back();
-    m_pendingReleaseSize.push_front(0);
-
-    m_used -= sizeToRelease;
   }
 
   void OpacityMicromapMemoryManager::registerVidmemFreeSize() {
@@ -194,53 +174,6 @@ namespace dxvk {
     m_vidmemFreeSize = kInvalidDeviceSize;
   }
 
-  bool OpacityMicromapMemoryManager::allocate(VkDeviceSize size) {
-    if (size > getAvailable()) {
-      ONCE(Logger::info(str::format("[RTX Opacity Micromap] Out of memory budget. Requested: ", size, " bytes. Free: ", getAvailable(), " bytes, Budget: ", getBudget(), " bytes")));
-      return false;
-    }
-
-    m_used += size;
-
-    return true;
-  }
-
-  VkDeviceSize OpacityMicromapMemoryManager::getAvailable() const {
-    return m_budget - std::min(m_used, m_budget);
-  }
-
-  void OpacityMicromapMemoryManager::release(VkDeviceSize size) {
-    m_pendingReleaseSize.back() += size;
-  }
-
-  void OpacityMicromapMemoryManager::releaseAll() {
-    release(m_used);
-  }
-
-  VkDeviceSize OpacityMicromapMemoryManager::getPrevBudget() const {
-    return m_prevBudget;
-  }
-
-  float OpacityMicromapMemoryManager::calculateUsageRatio() const {
-    return m_used / static_cast<float>(m_budget);
-  }
-
-  VkDeviceSize OpacityMicromapMemoryManager::calculatePendingAvailableSize() const {
-    return std::min(getAvailable() + calculatePendingReleasedSize(), m_budget);
-  }
-
-  VkDeviceSize OpacityMicromapMemoryManager::calculatePendingReleasedSize() const {
-    VkDeviceSize totalSizeToRelease = 0;
-    for (auto& sizeToRelease : m_pendingReleaseSize)
-      totalSizeToRelease += sizeToRelease;
-
-    return totalSizeToRelease;
-  }
-
-  VkDeviceSize OpacityMicromapMemoryManager::getNextPendingReleasedSize() const {
-    return m_pendingReleaseSize.back();
-  }
-
   Rc<DxvkBuffer> OpacityMicromapManager::getScratchMemory(const size_t requiredScratchAllocSize) {
     if (m_scratchBuffer == nullptr || m_scratchBuffer->info().size < requiredScratchAllocSize) {
       DxvkBufferCreateInfo bufferCreateInfo {};
@@ -402,49 +335,34 @@ namespace dxvk {
     }
   }
 
-  void OpacityMicromapManager::destroyOmmData(OpacityMicromapCache::iterator ommCacheItemIter, bool destroyParentInstanceOmmRequestContainer) {
-    const XXH64_hash_t ommSrcHash = ommCacheItemIter->first;
-    OpacityMicromapCacheItem& ommCacheItem = ommCacheItemIter->second;
+  void OpacityMicromapManager::destroyOmmData(OpacityMicromapCache::Index ommCacheItemIndex, bool destroyParentInstanceOmmRequestContainer) {
+    const XXH64_hash_t ommSrcHash = m_ommCache.getHash(ommCacheItemIndex);
+    OpacityMicromapCacheItem& ommCacheItem = m_ommCache[ommCacheItemIndex];
     const OpacityMicromapCacheState ommCacheState = ommCacheItem.cacheState;
 
 #ifdef VALIDATION_MODE
     Logger::warn(str::format("[RTX Opacity Micromap] Destroying ", ommSrcHash, " on thread_id ", std::this_thread::get_id()));
 #endif
 
-    switch (ommCacheState) {
-    case OpacityMicromapCacheState::eStep0_Unprocessed:
-    case OpacityMicromapCacheState::eStep1_Baking:
-      // Note the iterator may be invalid if the cache state list element was
-      // already destroyed when source data was unlinked
-      if (ommCacheItem.isUnprocessedCacheStateListIterValid) {
-        m_unprocessedList.erase(ommCacheItem.cacheStateListIter);
-        ommCacheItem.isUnprocessedCacheStateListIterValid = false;
-      }
-      m_numTexelsPerMicroTriangle.erase(ommSrcHash);
-      break;
-    case OpacityMicromapCacheState::eStep2_Baked:
-      m_bakedList.erase(ommCacheItem.cacheStateListIter);
-      break;
-    case OpacityMicromapCacheState::eStep3_Built:
-      m_builtList.erase(ommCacheItem.cacheStateListIter);
-      break;
-    case OpacityMicromapCacheState::eStep4_Ready:
-      break;
-    default:
-      omm_validation_assert(0);
-      break;
-    }
+    // Note: unprocessed or baking items may not be in the unprocessed list anymore
+    // if their source data was unlinked. The pool's state list unlink handles that case
+    if (ommCacheState <= OpacityMicromapCacheState::eStep1_Baking)
+      destroyNumTexelsPerMicroTriangle(ommSrcHash);
+
+    omm_validation_assert(ommCacheState < OpacityMicromapCacheState::eUnknown);
 
     if (ommCacheState <= OpacityMicromapCacheState::eStep2_Baked)
       deleteCachedSourceData(ommSrcHash, ommCacheState, destroyParentInstanceOmmRequestContainer);
 
-    m_leastRecentlyUsedList.erase(ommCacheItemIter->second.leastRecentlyUsedListIter);
-    m_memoryManager.release(ommCacheItemIter->second.getDeviceSize());
-    m_ommCache.erase(ommCacheItemIter);
+    m_memoryManager.release(ommCacheItem.getDeviceSize());
+    // Unlinks the item from its state list and the LRU list
+    m_ommCache.erase(ommCacheItemIndex);
   }
 
   void OpacityMicromapManager::destroyOmmData(XXH64_hash_t ommSrcHash) {
-    destroyOmmData(m_ommCache.find(ommSrcHash));
+    const OpacityMicromapCache::Index ommCacheItemIndex = m_ommCache.find(ommSrcHash);
+    if (ommCacheItemIndex != OpacityMicromapCache::kInvalidIndex)
+      destroyOmmData(ommCacheItemIndex);
   }
 
   void OpacityMicromapManager::destroyInstance(const RtInstance& instance, bool forceDestroy) {
@@ -452,13 +370,13 @@ namespace dxvk {
     const bool destroyParentInstanceOmmRequestContainer = false;
 
     auto destroyCachedData = [&](XXH64_hash_t ommSrcHash) {
-      auto ommCacheIterator = m_ommCache.find(ommSrcHash);
+      const OpacityMicromapCache::Index ommCacheItemIndex = m_ommCache.find(ommSrcHash);
 
       // Unknown element, ignore it
-      if (ommCacheIterator == m_ommCache.end())
+      if (ommCacheItemIndex == OpacityMicromapCache::kInvalidIndex)
         return;
 
-      OpacityMicromapCacheItem& ommCacheItem = ommCacheIterator->second;
+      OpacityMicromapCacheItem& ommCacheItem = m_ommCache[ommCacheItemIndex];
       const OpacityMicromapCacheState ommCacheState = ommCacheItem.cacheState;
 
       if (!forceDestroy) {
@@ -470,9 +388,8 @@ namespace dxvk {
           // If the OMM data has been at least partially baked keep it in the cache
         case OpacityMicromapCacheState::eStep1_Baking:
           // Remove partially baked OMM items from to be baked list until a new instance is linked with it again
-          if (ommCacheItem.isUnprocessedCacheStateListIterValid) {
-            m_unprocessedList.erase(ommCacheItem.cacheStateListIter);
-            ommCacheItem.isUnprocessedCacheStateListIterValid = false;
+          if (m_ommCache.getList(ommCacheItemIndex) == OpacityMicromapCache::List::Unprocessed) {
+            m_ommCache.unlink(ommCacheItemIndex);
             deleteCachedSourceData(ommSrcHash, ommCacheState, destroyParentInstanceOmmRequestContainer);
           }
           return;
@@ -488,8 +405,8 @@ namespace dxvk {
         }
       }
 
-      // Note: invalidates the omm cache iterator
-      destroyOmmData(ommCacheIterator, destroyParentInstanceOmmRequestContainer);
+      // Note: invalidates the omm cache item index
+      destroyOmmData(ommCacheItemIndex, destroyParentInstanceOmmRequestContainer);
     };
 
     m_numTexelsPerMicroTriangleStaging.erase(&instance);
@@ -514,11 +431,6 @@ namespace dxvk {
   }
 
   void OpacityMicromapManager::clear() {
-    m_unprocessedList.clear();
-    m_bakedList.clear();
-    m_builtList.clear();
-
-    m_leastRecentlyUsedList.clear();
     m_ommCache.clear();
 
 #ifdef VALIDATION_MODE
@@ -531,7 +443,9 @@ namespace dxvk {
     m_ommBuildRequestStatistics.clear();
 
     m_numTexelsPerMicroTriangleStaging.clear();
+    retirePendingNumTexelsPerMicroTriangleEstimates(true);
     m_numTexelsPerMicroTriangle.clear();
+    m_numTexelsPerMicroTriangleEstimates.clear();
 
     m_instanceOmmRequests.clear();
 
@@ -559,9 +473,9 @@ namespace dxvk {
       ImGui::Indent();
       ImGui::Text("# Bound/Requested OMMs: %d/%d", m_numBoundOMMs, m_numRequestedOMMBindings);
       ADVANCED(ImGui::Text("# Staged Requested Items: %d", m_ommBuildRequestStatistics.size()));
-      ADVANCED(ImGui::Text("# Unprocessed Items: %d", m_unprocessedList.size()));
-      ADVANCED(ImGui::Text("# Baked Items: %d", m_bakedList.size()));
-      ADVANCED(ImGui::Text("# Built Items: %d", m_builtList.size()));
+      ADVANCED(ImGui::Text("# Unprocessed Items: %d", m_ommCache.size(OpacityMicromapCache::List::Unprocessed)));
+      ADVANCED(ImGui::Text("# Baked Items: %d", m_ommCache.size(OpacityMicromapCache::List::Baked)));
+      ADVANCED(ImGui::Text("# Built Items: %d", m_ommCache.size(OpacityMicromapCache::List::Built)));
       ADVANCED(ImGui::Text("# Cache Items: %d", m_ommCache.size()));
       ADVANCED(ImGui::Text("# Black Listed Items: %d", m_blackListedList.size()));
       ImGui::Text("VRAM usage/budget [MB]: %d/%d", m_memoryManager.getUsed() / (1024 * 1024), m_memoryManager.getBudget() / (1024 * 1024));
@@ -641,9 +555,9 @@ namespace dxvk {
       "[RTX Opacity Micromap] Statistics:\n",
       "\t# Bound/Requested OMMs: ", m_numBoundOMMs, "/", m_numRequestedOMMBindings, "\n",
       "\t# Staged Requested Items: ", m_ommBuildRequestStatistics.size(), "\n",
-      "\t# Unprocessed Items: ", m_unprocessedList.size(), "\n",
-      "\t# Baked Items: ", m_bakedList.size(), "\n",
-      "\t# Built Items: ", m_builtList.size(), "\n",
+      "\t# Unprocessed Items: ", m_ommCache.size(OpacityMicromapCache::List::Unprocessed), "\n",
+      "\t# Baked Items: ", m_ommCache.size(OpacityMicromapCache::List::Baked), "\n",
+      "\t# Built Items: ", m_ommCache.size(OpacityMicromapCache::List::Built), "\n",
       "\t# Cache Items: ", m_ommCache.size(), "\n",
       "\t# Black Listed Items: ", m_blackListedList.size(), "\n",
       "\tVRAM usage/budget [MB]: ", m_memoryManager.getUsed() / (1024 * 1024), "/", m_memoryManager.getBudget() / (1024 * 1024)));
@@ -745,72 +659,34 @@ namespace dxvk {
     }
   }
     
-  // Calculates number of texels that cover a micro triangle in a triangle.
-  // This matches the texcoord span done for conservative opacity estimation during OMM triangle array baking.
-  // Returns UINT32_MAX if number of texels exceeds the maximum allowed value
-  uint32_t OpacityMicromapManager::calculateNumTexelsPerMicroTriangle(
-    Vector2 triangleTexcoords[3],
-    float rcpNumMicroTrianglesAlongEdge,
-    Vector2 textureResolution) {
-
-    // For the sake of simplicity, we only calculate number of texels needed for a first micro triangle in the triangle. 
-    // Even though the micro triangles have the same UV area, the number of texels covering it may be different 
-    // between them depending on how their texcoords fit into texel bounds cutoffs, but the variability should be 
-    // small enough for OMM's purposes of estimating number of texels needed in a micro triangle when calculating baking costs.
-
-    // Calculate micro triangle texcoords
-    Vector2 texcoords[3];
-    texcoords[0] = triangleTexcoords[0];
-    texcoords[1] = triangleTexcoords[0] + rcpNumMicroTrianglesAlongEdge * (triangleTexcoords[1] - triangleTexcoords[0]);
-    texcoords[2] = triangleTexcoords[0] + rcpNumMicroTrianglesAlongEdge * (triangleTexcoords[2] - triangleTexcoords[0]);
-
-    // Find texcoord bbox for the micro triangle
-    Vector2 texcoordsMin(FLT_MAX, FLT_MAX);
-    Vector2 texcoordsMax(-FLT_MAX, -FLT_MAX);
-    for (uint32_t i = 0; i < 3; i++) {
-      texcoordsMin = min(texcoords[i], texcoordsMin);
-      texcoordsMax = max(texcoords[i], texcoordsMax);
-    }
-
-    // Find the sampling index bbox for the micro triangle.
-    // Align the bbox to actual texel centers that fully cover the bbox.
-    // Align with a top left texel relative to the bbox min.
-    // Add epsilon to avoid host underestimating sampling footprint due to float precision errors. 
-    // 0.001 should generally be large enough.
-    // Should the underestimation still occur, the shader will fall back to a conservative value for a micro triangle.
-    const float kEpsilon = 0.001f;
-    const float kHalfTexelOffset = 0.5f + kEpsilon;
-    const Vector2 texcoordsIndexMin = doFloor(texcoordsMin * textureResolution - Vector2{ kHalfTexelOffset });
-    // Align with a bottom right pixel relative to the bbox max
-    const Vector2 texcoordsIndexMax = doFloor(texcoordsMax * textureResolution + Vector2{ kHalfTexelOffset });
-
-    // Calculate number of texels in the given texcoord bbox.
-    // +1: include the end point of the bbox
-    const Vector2 texelSampleDims = texcoordsIndexMax - texcoordsIndexMin + Vector2{ 1.0f };
-    const uint32_t numTexelsPerMicroTriangle =
-      static_cast<uint32_t>(std::min<float>(round(texelSampleDims.x * texelSampleDims.y), static_cast<float>(UINT32_MAX)));
-
-    return numTexelsPerMicroTriangle;
-  }
-
   void OpacityMicromapManager::calculateNumTexelsPerMicroTriangle(
     NumTexelsPerMicroTriangleCalculationData& numTexelsPerMicroTriangle,
     const RtInstance& instance,
-    const uint32_t numTriangles) {
+    const uint32_t numTriangles,
+    const bool allowWorkerThread) {
+
+    // The estimate is still being calculated on a worker thread
+    if (numTexelsPerMicroTriangle.waitsForWorkerThread) {
+      return;
+    }
+
+    auto setUniformResult = [&](uint16_t numTexelsPerMicroTriangleValue) {
+      numTexelsPerMicroTriangle.result = std::make_shared<NumTexelsPerMicroTriangleEstimate>();
+      numTexelsPerMicroTriangle.result->numTexelsPerMicroTriangle.resize(numTriangles, numTexelsPerMicroTriangleValue);
+      numTexelsPerMicroTriangle.status = OmmResult::Success;
+    };
 
     const RasterGeometry& geometryData = instance.getBlas()->input.getGeometryData();
 
     if (geometryData.topology != VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST) {
       ONCE(Logger::info("[RTX Opacity Micromap] Instance has non triangle list topology. This is only partially supported. Falling back to a conservative max value for estimated numTexelsPerMicroTriangle instead."));
-      numTexelsPerMicroTriangle.result.resize(numTriangles, OpacityMicromapOptions::Building::ConservativeEstimation::maxTexelTapsPerMicroTriangle());
-      numTexelsPerMicroTriangle.status = OmmResult::Success;
+      setUniformResult(OpacityMicromapOptions::Building::ConservativeEstimation::maxTexelTapsPerMicroTriangle());
       return;
     }
 
 
     if (!OpacityMicromapOptions::Building::ConservativeEstimation::enable()) {
-      numTexelsPerMicroTriangle.result.resize(numTriangles, 1);
-      numTexelsPerMicroTriangle.status = OmmResult::Success;
+      setUniformResult(1);
       return;
     }
 
@@ -834,84 +710,221 @@ namespace dxvk {
       static_cast<float>(opacityTextureExtent.width),
       static_cast<float>(opacityTextureExtent.height));
 
-    // Calculate number of texel footprint per micro triangle for all triangles
-    {
-      const uint32_t kNumIndicesPerTriangle = 3;
-      const float rcpNumMicroTrianglesPerEdge = 1.f / (1 << subdivisionLevel);
-      const uint32_t kMaxTexelTapsPerMicroTriangle =
-        static_cast<uint32_t>(
-          std::min<int32_t>(
-            OpacityMicromapOptions::Building::ConservativeEstimation::maxTexelTapsPerMicroTriangle(),
-            static_cast<int32_t>(UINT16_MAX)));
-
-      // Check if the required buffers are available
-      if (!bufferData.texcoordData) {
-        ONCE(Logger::warn(str::format("[RTX Opacity Micromap] Texcoord data is unavailable for calculateNumTexelsPerMicroTriangle(). Falling back to a conservative max value for estimated numTexelsPerMicroTriangle instead.")));
-        numTexelsPerMicroTriangle.result.resize(numTriangles, OpacityMicromapOptions::Building::ConservativeEstimation::maxTexelTapsPerMicroTriangle());
-        numTexelsPerMicroTriangle.status = OmmResult::Success;
-        return;
+    // Check if the required buffers are available
+    if (!bufferData.texcoordData) {
+      ONCE(Logger::warn(str::format("[RTX Opacity Micromap] Texcoord data is unavailable for calculateNumTexelsPerMicroTriangle(). Falling back to a conservative max value for estimated numTexelsPerMicroTriangle instead.")));
+      setUniformResult(OpacityMicromapOptions::Building::ConservativeEstimation::maxTexelTapsPerMicroTriangle());
+      return;
+    }
+
+    OpacityMicromapTexelEstimationInput input;
+    input.texcoordData = bufferData.texcoordData;
+    input.texcoordStride = bufferData.texcoordStride;
+    input.numVertices = geometryData.vertexCount;
+    if (usesIndices) {
+      if (has16bitIndices) {
+        input.indices16 = bufferData.indexData;
+      } else {
+        input.indices32 = reinterpret_cast<const uint32_t*>(bufferData.indexData);
       }
-      
-      // Resize the vector to the target size when processing the data for the instance for the first time
-      if (numTexelsPerMicroTriangle.numTrianglesCalculated == 0) {
-        numTexelsPerMicroTriangle.result.resize(numTriangles);
+    }
+    input.textureTransform = hasNonIdentityTextureTransform ? &instance.surface.textureTransform : nullptr;
+    input.textureResolution = opacityTextureResolution;
+    input.rcpNumMicroTrianglesAlongEdge = 1.f / (1 << subdivisionLevel);
+    input.maxTexelTapsPerMicroTriangle =
+      static_cast<uint32_t>(
+        std::min<int32_t>(
+          OpacityMicromapOptions::Building::ConservativeEstimation::maxTexelTapsPerMicroTriangle(),
+          static_cast<int32_t>(UINT16_MAX)));
+
+    // Processing the data for the instance for the first time
+    if (!numTexelsPerMicroTriangle.result) {
+      // Hash everything the estimate depends on, so that it can be shared with other instances.
+      // The texture itself does not matter, only its resolution does
+      XXH64_hash_t estimateHash = XXH64(&instance.getTexcoordHash(), sizeof(XXH64_hash_t), 0);
+      estimateHash = XXH64(&instance.getIndexHash(), sizeof(XXH64_hash_t), estimateHash);
+      estimateHash = XXH64(&numTriangles, sizeof(numTriangles), estimateHash);
+      estimateHash = XXH64(&input.numVertices, sizeof(input.numVertices), estimateHash);
+      estimateHash = XXH64(&instance.surface.textureTransform, sizeof(instance.surface.textureTransform), estimateHash);
+      estimateHash = XXH64(&input.textureResolution, sizeof(input.textureResolution), estimateHash);
+      estimateHash = XXH64(&subdivisionLevel, sizeof(subdivisionLevel), estimateHash);
+      estimateHash = XXH64(&input.maxTexelTapsPerMicroTriangle, sizeof(input.maxTexelTapsPerMicroTriangle), estimateHash);
+      numTexelsPerMicroTriangle.estimateHash = estimateHash;
+
+      // Reuse the estimate if it has already been calculated for another instance
+      auto estimateIter = m_numTexelsPerMicroTriangleEstimates.find(estimateHash);
+      if (estimateIter != m_numTexelsPerMicroTriangleEstimates.end()) {
+        if (std::shared_ptr<NumTexelsPerMicroTriangleEstimate> estimate = estimateIter->second.lock()) {
+          numTexelsPerMicroTriangle.result = std::move(estimate);
+          numTexelsPerMicroTriangle.numTrianglesCalculated = numTriangles;
+          onNumTexelsPerMicroTriangleCalculated(numTexelsPerMicroTriangle);
+          return;
+        }
       }
 
-      // Go over all triangles calculating texel footprint per micro triangle
-      // Note: don't issue "break" from the for loop as the logic depends on the for loop's increment statement executing for every iteration
-      for (uint32_t& iTriangle = numTexelsPerMicroTriangle.numTrianglesCalculated; 
-           iTriangle < numTriangles && m_numTrianglesToCalculateForNumTexelsPerMicroTriangle > 0;
-           iTriangle++, m_numTrianglesToCalculateForNumTexelsPerMicroTriangle--) {
-        Vector2 texcoords[3];
-        uint32_t indexOffset = iTriangle * kNumIndicesPerTriangle;
-
-        // Get triangle's texcoords
-        for (uint32_t i = 0; i < kNumIndicesPerTriangle; i++) {
-          uint32_t index =
-            usesIndices
-            ? has16bitIndices
-              ? bufferData.getIndex(i + indexOffset)
-              : bufferData.getIndex32(i + indexOffset)
-            : i + indexOffset;
-
-          texcoords[i] = bufferData.getTexCoord(index);
-
-          if (hasNonIdentityTextureTransform) {
-            texcoords[i] = (instance.surface.textureTransform * Vector4(texcoords[i].x, texcoords[i].y, 0.f, 1.f)).xy();
-          }
-        }
+      if (allowWorkerThread &&
+          numTriangles >= kMinTrianglesToEstimateOnWorkerThread &&
+          m_pendingNumTexelsPerMicroTriangleEstimates.size() < kMaxPendingNumTexelsPerMicroTriangleEstimates &&
+          scheduleNumTexelsPerMicroTriangleEstimate(numTexelsPerMicroTriangle, input, numTriangles)) {
+        return;
+      }
 
-        uint32_t iNumTexelsPerMicroTriangle = calculateNumTexelsPerMicroTriangle(texcoords, rcpNumMicroTrianglesPerEdge, opacityTextureResolution);
+      numTexelsPerMicroTriangle.result = std::make_shared<NumTexelsPerMicroTriangleEstimate>();
+      numTexelsPerMicroTriangle.result->numTexelsPerMicroTriangle.resize(numTriangles);
+    }
 
-        if (iNumTexelsPerMicroTriangle > kMaxTexelTapsPerMicroTriangle) {
-          iNumTexelsPerMicroTriangle = 0;
-        }
+    // Calculate texel footprint per micro triangle for as many of the remaining triangles as the per frame budget allows
+    {
+      const uint32_t numTrianglesToCalculate =
+        std::min(numTriangles - numTexelsPerMicroTriangle.numTrianglesCalculated, m_numTrianglesToCalculateForNumTexelsPerMicroTriangle);
 
-        numTexelsPerMicroTriangle.result[iTriangle] = static_cast<uint16_t>(iNumTexelsPerMicroTriangle);
+      numTexelsPerMicroTriangle.result->numTrianglesWithinTexelBudget +=
+        estimateNumTexelsPerMicroTriangle(input, numTexelsPerMicroTriangle.numTrianglesCalculated, numTrianglesToCalculate,
+                                          numTexelsPerMicroTriangle.result->numTexelsPerMicroTriangle.data());
 
-        numTexelsPerMicroTriangle.numTrianglesWithinTexelBudget += iNumTexelsPerMicroTriangle != 0;
-      }
+      numTexelsPerMicroTriangle.numTrianglesCalculated += numTrianglesToCalculate;
+      m_numTrianglesToCalculateForNumTexelsPerMicroTriangle -= numTrianglesToCalculate;
     }
 
     // Not all triangles got calculated yet
-    if (numTexelsPerMicroTriangle.numTrianglesCalculated != numTexelsPerMicroTriangle.result.size()) {
+    if (numTexelsPerMicroTriangle.numTrianglesCalculated != numTriangles) {
       return;
     }
 
-    // Check the ratio of how many triangles benefit from OMM triangle arrays
-    {
-      const float percentageOfTrianglesWithinTexelBudget =
-        numTexelsPerMicroTriangle.numTrianglesWithinTexelBudget / static_cast<float>(numTexelsPerMicroTriangle.numTrianglesCalculated);
+    m_numTexelsPerMicroTriangleEstimates[numTexelsPerMicroTriangle.estimateHash] = numTexelsPerMicroTriangle.result;
+    onNumTexelsPerMicroTriangleCalculated(numTexelsPerMicroTriangle);
+  }
 
-      if (percentageOfTrianglesWithinTexelBudget >= OpacityMicromapOptions::Building::ConservativeEstimation::minValidOMMTrianglesInMeshPercentage()) {
-        numTexelsPerMicroTriangle.status = OmmResult::Success;
-      } else {
-        ONCE(Logger::info("[RTX Opacity Micromap] Instance requires more texel taps to resolve opacity than allowed."));
-        numTexelsPerMicroTriangle.status = OmmResult::Rejected;
+  bool OpacityMicromapManager::scheduleNumTexelsPerMicroTriangleEstimate(
+    NumTexelsPerMicroTriangleCalculationData& numTexelsPerMicroTriangle,
+    const OpacityMicromapTexelEstimationInput& input,
+    const uint32_t numTriangles) {
+    ScopedCpuProfileZone();
+
+    // Snapshot the source data, so that the worker thread doesn't need to keep any buffers referenced 
+    // (see onInstanceUpdated() for why that must be avoided).
+    // Copying is much cheaper than calculating the estimate, so that is all that remains on the draw call submission timeline
+    struct EstimationSourceData {
+      std::vector<float> texcoords;
+      std::vector<uint16_t> indices16;
+      std::vector<uint32_t> indices32;
+      Matrix4 textureTransform;
+      OpacityMicromapTexelEstimationInput input;
+    };
+
+    const uint32_t kNumIndicesPerTriangle = 3;
+    std::shared_ptr<EstimationSourceData> sourceData = std::make_shared<EstimationSourceData>();
+    sourceData->input = input;
+
+    sourceData->texcoords.resize(input.numVertices * 2);
+    for (uint32_t i = 0; i < input.numVertices; i++) {
+      sourceData->texcoords[i * 2 + 0] = input.texcoordData[i * input.texcoordStride + 0];
+      sourceData->texcoords[i * 2 + 1] = input.texcoordData[i * input.texcoordStride + 1];
+    }
+    sourceData->input.texcoordData = sourceData->texcoords.data();
+    sourceData->input.texcoordStride = 2;
+
+    if (input.indices16) {
+      sourceData->indices16.assign(input.indices16, input.indices16 + numTriangles * kNumIndicesPerTriangle);
+      sourceData->input.indices16 = sourceData->indices16.data();
+    } else if (input.indices32) {
+      sourceData->indices32.assign(input.indices32, input.indices32 + numTriangles * kNumIndicesPerTriangle);
+      sourceData->input.indices32 = sourceData->indices32.data();
+    }
+
+    if (input.textureTransform) {
+      sourceData->textureTransform = *input.textureTransform;
+      sourceData->input.textureTransform = &sourceData->textureTransform;
+    }
+
+    std::shared_ptr<NumTexelsPerMicroTriangleEstimate> result = std::make_shared<NumTexelsPerMicroTriangleEstimate>();
+    result->numTexelsPerMicroTriangle.resize(numTriangles);
+    result->isPending = true;
+
+    if (m_numTexelsPerMicroTriangleThreadPool == nullptr) {
+      const uint32_t numThreads = std::clamp(dxvk::thread::hardware_concurrency() / 4, 1u, 4u);
+      m_numTexelsPerMicroTriangleThreadPool = std::make_unique<WorkerThreadPool<kMaxPendingNumTexelsPerMicroTriangleEstimates, true, false>>(
+        static_cast<uint8_t>(numThreads), "rtx-omm-texel-estimation");
+    }
+
+    Future<void> future = m_numTexelsPerMicroTriangleThreadPool->Schedule([sourceData, result, numTriangles]() {
+      ScopedCpuProfileZoneN("OMM Texel Estimation");
+      result->numTrianglesWithinTexelBudget =
+        estimateNumTexelsPerMicroTriangle(sourceData->input, 0, numTriangles, result->numTexelsPerMicroTriangle.data());
+    });
+
+    if (!future.valid()) {
+      return false;
+    }
+
+    m_pendingNumTexelsPerMicroTriangleEstimates.push_back({ future, result, numTexelsPerMicroTriangle.estimateHash });
+    numTexelsPerMicroTriangle.result = std::move(result);
+    numTexelsPerMicroTriangle.waitsForWorkerThread = true;
+    return true;
+  }
+
+  void OpacityMicromapManager::retirePendingNumTexelsPerMicroTriangleEstimates(bool wait) {
+    // Retire in scheduling order only, see m_pendingNumTexelsPerMicroTriangleEstimates
+    while (!m_pendingNumTexelsPerMicroTriangleEstimates.empty()) {
+      PendingNumTexelsPerMicroTriangleEstimate& pending = m_pendingNumTexelsPerMicroTriangleEstimates.front();
+
+      if (!wait && !pending.future.ready()) {
+        return;
+      }
+
+      pending.future.get();
+      pending.result->isPending = false;
+
+      // The instances that requested the estimate may be gone already, in which case there's nothing left to share it with
+      if (pending.result.use_count() > 1) {
+        m_numTexelsPerMicroTriangleEstimates[pending.estimateHash] = pending.result;
       }
+
+      m_pendingNumTexelsPerMicroTriangleEstimates.pop_front();
     }
   }
 
+  void OpacityMicromapManager::resolvePendingNumTexelsPerMicroTriangle(
+    NumTexelsPerMicroTriangleCalculationData& numTexelsPerMicroTriangle) {
+
+    if (!numTexelsPerMicroTriangle.waitsForWorkerThread) {
+      return;
+    }
+
+    retirePendingNumTexelsPerMicroTriangleEstimates(false);
+
+    if (numTexelsPerMicroTriangle.result->isPending) {
+      return;
+    }
+
+    numTexelsPerMicroTriangle.waitsForWorkerThread = false;
+    numTexelsPerMicroTriangle.numTrianglesCalculated = static_cast<uint32_t>(numTexelsPerMicroTriangle.result->numTexelsPerMicroTriangle.size());
+    onNumTexelsPerMicroTriangleCalculated(numTexelsPerMicroTriangle);
+  }
+
+  void OpacityMicromapManager::onNumTexelsPerMicroTriangleCalculated(NumTexelsPerMicroTriangleCalculationData& numTexelsPerMicroTriangle) {
+    // Check the ratio of how many triangles benefit from OMM triangle arrays
+    const float percentageOfTrianglesWithinTexelBudget =
+      numTexelsPerMicroTriangle.result->numTrianglesWithinTexelBudget / static_cast<float>(numTexelsPerMicroTriangle.numTrianglesCalculated);
+
+    if (percentageOfTrianglesWithinTexelBudget >= OpacityMicromapOptions::Building::ConservativeEstimation::minValidOMMTrianglesInMeshPercentage()) {
+      numTexelsPerMicroTriangle.status = OmmResult::Success;
+    } else {
+      ONCE(Logger::info("[RTX Opacity Micromap] Instance requires more texel taps to resolve opacity than allowed."));
+      numTexelsPerMicroTriangle.status = OmmResult::Rejected;
+    }
+  }
+
+  void OpacityMicromapManager::destroyNumTexelsPerMicroTriangle(XXH64_hash_t ommSrcHash) {
+    auto numTexelsPerMicroTriangleIter = m_numTexelsPerMicroTriangle.find(ommSrcHash);
+    if (numTexelsPerMicroTriangleIter == m_numTexelsPerMicroTriangle.end()) {
+      return;
+    }
+
+    // A pending worker thread job keeps its own reference to the estimate, and is retired independently
+    m_numTexelsPerMicroTriangle.erase(numTexelsPerMicroTriangleIter);
+  }
+
   void OpacityMicromapManager::calculateNumTexelsPerMicroTriangle(const RtInstance& instance) {
     ScopedCpuProfileZone();
 
@@ -956,12 +969,16 @@ namespace dxvk {
                             "Invalid state. This should not be scheduled to be calculated for an instance that already has the result.");
     }
 
+    resolvePendingNumTexelsPerMicroTriangle(*numTexelsPerMicroTriangle);
+
     // The result has been already calculated for this instance
     if (numTexelsPerMicroTriangle->status != OmmResult::DependenciesUnavailable) {
       return;
     }
 
-    calculateNumTexelsPerMicroTriangle(*numTexelsPerMicroTriangle, instance, numTriangles);
+    // Staging results and billboards seen for the first time need the result within the frame, so they are always calculated inline
+    const bool allowWorkerThread = ommSrcHash != kEmptyHash && !useStagingNumTexelsPerMicroTriangleObject(instance);
+    calculateNumTexelsPerMicroTriangle(*numTexelsPerMicroTriangle, instance, numTriangles, allowWorkerThread);
 
     // The calculation is complete
     if (numTexelsPerMicroTriangle->status != OmmResult::DependenciesUnavailable) {
@@ -1190,26 +1207,20 @@ namespace dxvk {
       }
     }
 
-    std::list<XXH64_hash_t>::iterator cacheStateListIter;
-    if (!insertToUnprocessedList(ommRequest, cacheStateListIter))
-      return false;
+    // New items are placed at the end of the LRU list, and thus marked as most recent
+    const OpacityMicromapCache::Index ommCacheItemIndex = 
+      m_ommCache.emplace(ommSrcHash, *m_device, OpacityMicromapCacheState::eStep0_Unprocessed, OpacityMicromapOptions::Building::subdivisionLevel(), 
+                         OpacityMicromapOptions::Building::enableVertexAndTextureOperations(), m_device->getCurrentFrameId(), ommRequest);
 
-    // Place the element to the end of the LRU list, and thus marking it as most recent 
-    m_leastRecentlyUsedList.emplace_back(ommSrcHash);
-    auto lastElementIterator = std::next(m_leastRecentlyUsedList.end(), -1);
-    m_ommCache.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(ommSrcHash),
-      std::forward_as_tuple(*m_device, OpacityMicromapCacheState::eStep0_Unprocessed, OpacityMicromapOptions::Building::subdivisionLevel(), 
-                            OpacityMicromapOptions::Building::enableVertexAndTextureOperations(), m_device->getCurrentFrameId(),
-                            lastElementIterator, cacheStateListIter, ommRequest));
+    if (!insertToUnprocessedList(ommRequest, ommCacheItemIndex)) {
+      m_ommCache.erase(ommCacheItemIndex);
+      return false;
+    }
 
     return true;
   }
   
-  bool OpacityMicromapManager::insertToUnprocessedList(const OmmRequest& ommRequest, std::list<XXH64_hash_t>::iterator& cacheStateListIter) {
-    XXH64_hash_t ommSrcHash = ommRequest.ommSrcHash;
-
+  bool OpacityMicromapManager::insertToUnprocessedList(const OmmRequest& ommRequest, OpacityMicromapCache::Index ommCacheItemIndex) {
     auto sourceDataIter = registerCachedSourceData(ommRequest);
 
     if (sourceDataIter == m_cachedSourceData.end())
@@ -1222,23 +1233,22 @@ namespace dxvk {
     if (!ommRequest.isBillboardOmmRequest()) {
       // Add the OMM request to the unprocessed list according to the numTriangle count in an ascending order 
       // so that requests with least triangles are processed first and thus with lower overall latency
-      for (auto itemIter = m_unprocessedList.begin(); itemIter != m_unprocessedList.end(); itemIter++) {
-
-        XXH64_hash_t itemOmmSrcHash = *itemIter;
+      for (auto itemIndex = m_ommCache.front(OpacityMicromapCache::List::Unprocessed); 
+           itemIndex != OpacityMicromapCache::kInvalidIndex; 
+           itemIndex = m_ommCache.next(itemIndex)) {
 
-        CachedSourceData& itemSourceData = m_cachedSourceData[itemOmmSrcHash];
+        CachedSourceData& itemSourceData = m_cachedSourceData[m_ommCache.getHash(itemIndex)];
 
         if (sourceData.numTriangles < itemSourceData.numTriangles ||
             // insert in front of any billboard requests
             usesSplitBillboardOpacityMicromap(*itemSourceData.getInstance())) {
-          cacheStateListIter = m_unprocessedList.insert(itemIter, ommSrcHash);
+          m_ommCache.insertBefore(OpacityMicromapCache::List::Unprocessed, itemIndex, ommCacheItemIndex);
           return true;
         }
       }
     }
 
-    m_unprocessedList.emplace_back(ommSrcHash);
-    cacheStateListIter = std::prev(m_unprocessedList.end());
+    m_ommCache.pushBack(OpacityMicromapCache::List::Unprocessed, ommCacheItemIndex);
 
     return true;
   }
@@ -1343,21 +1353,21 @@ namespace dxvk {
       return false;
     }
 
-    auto ommCacheIterator = m_ommCache.find(ommSrcHash);
+    const OpacityMicromapCache::Index ommCacheItemIndex = m_ommCache.find(ommSrcHash);
 
     // OMM request is not yet known
-    if (ommCacheIterator == m_ommCache.end()) {
+    if (ommCacheItemIndex == OpacityMicromapCache::kInvalidIndex) {
       return addNewOmmBuildRequest(instance, ommRequest);
     } else {
 
-      auto& ommCacheItem = ommCacheIterator->second;
+      auto& ommCacheItem = m_ommCache[ommCacheItemIndex];
 
       // Check OMM request's parametrization matches that of the cached omm data
       // in case of an OMM hash collision
       if (!ommCacheItem.isCompatibleWithOmmRequest(ommRequest)) {
         ONCE(Logger::warn("[RTX Opacity Micromap] Found a cached Opacity Micromap with same hash but with incompatible parametrization. Black listing the Opacity Micromap hash."));
         m_blackListedList.insert(ommSrcHash);
-        destroyOmmData(ommSrcHash);
+        destroyOmmData(ommCacheItemIndex);
         return false;
       }
 
@@ -1366,8 +1376,7 @@ namespace dxvk {
 
         // Source data has been unlinked and removed from unprocessed list, try adding it back to the unprocessed list
         if (sourceDataIter == m_cachedSourceData.end()) {
-          ommCacheItem.isUnprocessedCacheStateListIterValid = insertToUnprocessedList(ommRequest, ommCacheItem.cacheStateListIter);
-          return ommCacheItem.isUnprocessedCacheStateListIterValid;
+          return insertToUnprocessedList(ommRequest, ommCacheItemIndex);
         }
       }
     }
@@ -1408,14 +1417,14 @@ namespace dxvk {
       usesSplitBillboardOpacityMicromap(instance) ? billboardIndex : OmmRequest::kInvalidIndex;
     const OmmRequest ommRequest(instance, instanceManager, billboardIndex);
 
-    auto ommCacheItemIter = m_ommCache.find(ommRequest.ommSrcHash);
+    const OpacityMicromapCache::Index ommCacheItemIndex = m_ommCache.find(ommRequest.ommSrcHash);
 
     // OMM is not available in the cache
-    if (ommCacheItemIter == m_ommCache.end())
+    if (ommCacheItemIndex == OpacityMicromapCache::kInvalidIndex)
       return kEmptyHash;
 
     bool boundOMM = false;
-    OpacityMicromapCacheItem& ommCacheItem = ommCacheItemIter->second;
+    OpacityMicromapCacheItem& ommCacheItem = m_ommCache[ommCacheItemIndex];
     const OpacityMicromapCacheState ommCacheState = ommCacheItem.cacheState;
 
     // Check OMM request's parametrization matches that of the cached omm data
@@ -1428,7 +1437,7 @@ namespace dxvk {
     ommCacheItem.lastUseFrameIndex = m_device->getCurrentFrameId();
 
     // Make the item most recently used
-    m_leastRecentlyUsedList.splice(m_leastRecentlyUsedList.end(), m_leastRecentlyUsedList, ommCacheItem.leastRecentlyUsedListIter);
+    m_ommCache.touch(ommCacheItemIndex);
 
     // Bind OMM if the data is ready
     switch (ommCacheState) {
@@ -1479,10 +1488,12 @@ namespace dxvk {
 
       // All built instances have been synchronized, remove them from the built list
       {
-        for (auto& ommSrcHash : m_builtList) {
-          m_ommCache[ommSrcHash].cacheState = OpacityMicromapCacheState::eStep4_Ready;
+        for (auto ommCacheItemIndex = m_ommCache.front(OpacityMicromapCache::List::Built);
+             ommCacheItemIndex != OpacityMicromapCache::kInvalidIndex;
+             ommCacheItemIndex = m_ommCache.next(ommCacheItemIndex)) {
+          m_ommCache[ommCacheItemIndex].cacheState = OpacityMicromapCacheState::eStep4_Ready;
         }
-        m_builtList.clear();
+        m_ommCache.unlinkAll(OpacityMicromapCache::List::Built);
       }
 
       m_boundOmmsRequireSynchronization = false;
@@ -1626,7 +1637,7 @@ namespace dxvk {
 
   OpacityMicromapManager::OmmResult OpacityMicromapManager::getNumTexelsPerMicroTriangle(
     const RtInstance& instance,
-    NumTexelsPerMicroTriangle** numTexelsPerMicroTriangle) {
+    const NumTexelsPerMicroTriangle** numTexelsPerMicroTriangle) {
 
     // Note: this is not expected to be called for non-reference instances which
     // goes along the design choice of non-reference OMM instances not being used for generating OMMs
@@ -1651,9 +1662,14 @@ namespace dxvk {
       }
 
       numTexelsPerMicroTriangleCalculationData = &numTexelsPerMicroTriangleIter->second;
+      resolvePendingNumTexelsPerMicroTriangle(*numTexelsPerMicroTriangleCalculationData);
     }
 
-    *numTexelsPerMicroTriangle = &numTexelsPerMicroTriangleCalculationData->result;
+    if (numTexelsPerMicroTriangleCalculationData->status == OmmResult::DependenciesUnavailable) {
+      return OmmResult::DependenciesUnavailable;
+    }
+
+    *numTexelsPerMicroTriangle = &numTexelsPerMicroTriangleCalculationData->result->numTexelsPerMicroTriangle;
     return numTexelsPerMicroTriangleCalculationData->status;
   }
 
@@ -1672,7 +1688,7 @@ namespace dxvk {
     }
 
     // Check if the data has already been calculated
-    NumTexelsPerMicroTriangle* numTexelsPerMicroTriangle;
+    const NumTexelsPerMicroTriangle* numTexelsPerMicroTriangle;
     const OmmResult texelBudgetCheckResult = getNumTexelsPerMicroTriangle(instance, &numTexelsPerMicroTriangle);
     if (texelBudgetCheckResult != OmmResult::Success) {
       // If the instance hasn't been updated this frame, it means it's kept around by other means 
@@ -1944,17 +1960,8 @@ namespace dxvk {
       return;
 
 #ifdef VALIDATION_MODE
-    for (auto iter0 = m_unprocessedList.begin(); iter0 != m_unprocessedList.end(); iter0++) {
-      auto iter1 = iter0;
-      iter1++;
-      for (; iter1 != m_unprocessedList.end(); iter1++) {
-        if (*iter1 == *iter0) {
-          omm_validation_assert(0 && "Duplicate entries found in a list");
-        }
-      }
-    }
     for (auto iter0 = m_cachedSourceData.begin(); iter0 != m_cachedSourceData.end(); iter0++) {
-      OpacityMicromapCacheItem& ommCacheItem = m_ommCache[iter0->first];
+      OpacityMicromapCacheItem& ommCacheItem = m_ommCache[m_ommCache.find(iter0->first)];
       if ((ommCacheItem.cacheState <= OpacityMicromapCacheState::eStep0_Unprocessed) &&
            iter0->second.getInstance() == nullptr)
         omm_validation_assert(0 && "Instance is null at unexpected stage");
@@ -1967,30 +1974,31 @@ namespace dxvk {
       availableBakingBudget = UINT32_MAX;
     }
 
-    for (auto ommSrcHashIter = m_unprocessedList.begin(); ommSrcHashIter != m_unprocessedList.end() && availableBakingBudget > 0; ) {
-      XXH64_hash_t ommSrcHash = *ommSrcHashIter;
+    for (auto ommCacheItemIndex = m_ommCache.front(OpacityMicromapCache::List::Unprocessed); 
+         ommCacheItemIndex != OpacityMicromapCache::kInvalidIndex && availableBakingBudget > 0; ) {
+      const XXH64_hash_t ommSrcHash = m_ommCache.getHash(ommCacheItemIndex);
+      // Advance before the item is moved to another list or destroyed
+      const auto nextOmmCacheItemIndex = m_ommCache.next(ommCacheItemIndex);
 
 #ifdef VALIDATION_MODE
       Logger::warn(str::format("[RTX Opacity Micromap] Baking ", ommSrcHash, " on thread_id ", std::this_thread::get_id()));
 #endif
 
       auto sourceDataIter = m_cachedSourceData.find(ommSrcHash);
-      auto cacheItemIter = m_ommCache.find(ommSrcHash);
 
-      if (sourceDataIter == m_cachedSourceData.end() || cacheItemIter == m_ommCache.end()) {
+      if (sourceDataIter == m_cachedSourceData.end()) {
         // Note: this shouldn't be hit anymore as it was triggered by destroying an instance
         // on a baking failure and destroying source data for all OMMs associated with that instance.
         // That included OMMs that were still in the unordered list. Now just the failed OMM gets destroyed.
         assert(0 && "OMM inconsistent state");
         ONCE(Logger::err("[RTX Opacity Micromap] Encountered inconsistent state. Opacity Micromap item listed for baking is missing required state data. Skipping it."));
-        // First update the iterator, then destroy any omm data associated with it
-        ommSrcHashIter++;
-        destroyOmmData(ommSrcHash);
+        destroyOmmData(ommCacheItemIndex);
+        ommCacheItemIndex = nextOmmCacheItemIndex;
         continue;
       }
 
       CachedSourceData& sourceData = sourceDataIter->second;
-      OpacityMicromapCacheItem& ommCacheItem = cacheItemIter->second;
+      OpacityMicromapCacheItem& ommCacheItem = m_ommCache[ommCacheItemIndex];
       ommCacheItem.cacheState = OpacityMicromapCacheState::eStep1_Baking;
 
       OmmResult result = bakeOpacityMicromapArray(ctx, ommSrcHash, ommCacheItem, sourceData, textures, availableBakingBudget);
@@ -2002,13 +2010,12 @@ namespace dxvk {
           // Unlink the referenced RtInstance
           sourceData.setInstance(nullptr, m_instanceOmmRequests, *this);
 
-          m_numTexelsPerMicroTriangle.erase(ommSrcHash);
+          destroyNumTexelsPerMicroTriangle(ommSrcHash);
 
           // Move the item from the unprocessed list to the end of the baked list
           ommCacheItem.cacheState = OpacityMicromapCacheState::eStep2_Baked;
-          auto ommSrcHashIterToMove = ommSrcHashIter++;
-          m_bakedList.splice(m_bakedList.end(), m_unprocessedList, ommSrcHashIterToMove);
-          ommCacheItem.isUnprocessedCacheStateListIterValid = false;
+          m_ommCache.pushBack(OpacityMicromapCache::List::Baked, ommCacheItemIndex);
+          ommCacheItemIndex = nextOmmCacheItemIndex;
         }
         else {
           // Do nothing, else path means all the budget has been used up and thus the loop will exit due to availableBakingBudget == 0
@@ -2019,11 +2026,11 @@ namespace dxvk {
         }
       } else if (result == OmmResult::OutOfMemory) {
         // Do nothing, try the next one
-        ommSrcHashIter++;
+        ommCacheItemIndex = nextOmmCacheItemIndex;
         ONCE(Logger::debug("[RTX Opacity Micromap] Baking Opacity Micromap Array failed as ran out of memory."));
       } else if (result == OmmResult::DependenciesUnavailable) {
         // Textures not available - try the next one
-        ommSrcHashIter++;
+        ommCacheItemIndex = nextOmmCacheItemIndex;
       } else if (result == OmmResult::Failure || 
                  result == OmmResult::Rejected) {
         if (result == OmmResult::Failure) {
@@ -2033,13 +2040,12 @@ namespace dxvk {
         Logger::warn(str::format("[RTX Opacity Micromap] Baking Opacity Micromap Array failed for hash ", ommSrcHash, ". Ignoring and black listing the hash."));
 #endif
         // Baking failed, ditch the OMM data
-        // First update the iterator, then remove the element
-        ommSrcHashIter++;
-        destroyOmmData(cacheItemIter);
+        destroyOmmData(ommCacheItemIndex);
         m_blackListedList.insert(ommSrcHash);
+        ommCacheItemIndex = nextOmmCacheItemIndex;
       } else { // OutOfBudget
         omm_validation_assert(0 && "Should not be hit");
-        ommSrcHashIter++;
+        ommCacheItemIndex = nextOmmCacheItemIndex;
       }
 #ifdef VALIDATION_MODE
       Logger::warn(str::format("[RTX Opacity Micromap] ~Baking ", ommSrcHash, " on thread_id ", std::this_thread::get_id()));
@@ -2057,28 +2063,11 @@ namespace dxvk {
     if (!OpacityMicromapOptions::enableBuilding())
       return;
 
-#ifdef VALIDATION_MODE
-    for (auto iter0 = m_bakedList.begin(); iter0 != m_bakedList.end(); iter0++) {
-      auto iter1 = iter0;
-      iter1++;
-      for (; iter1 != m_bakedList.end(); iter1++) {
-        if (*iter1 == *iter0) {
-          omm_validation_assert(0 && "Duplicate entries found in a list");
-        }
-      }
-      for (auto iter2 = m_unprocessedList.begin(); iter2 != m_unprocessedList.end(); iter2++) {
-        if (*iter2 == *iter0) {
-          omm_validation_assert(0 && "Two lists contain same OMM src hash");
-        }
-      }
-    }
-#endif
-
     ScopedGpuProfileZone(ctx, "Build Opacity Micromaps");
 
     // Pre-allocate the arrays because build infos include pointers to usage groups,
     // and reallocating vectors would invalidate these pointers
-    const uint32_t maxBuildItems = m_bakedList.size();
+    const uint32_t maxBuildItems = m_ommCache.size(OpacityMicromapCache::List::Baked);
     std::vector<VkMicromapUsageEXT> micromapUsageGroups(maxBuildItems);
     std::vector<VkMicromapBuildInfoEXT> micromapBuildInfos(maxBuildItems);
     uint32_t buildItemCount = 0;
@@ -2091,22 +2080,23 @@ namespace dxvk {
     // They're cheap regardless, so it should be fine.
     bool forceOmmBuild = maxMicroTrianglesToBuild > 0;  
 
-    for (auto ommSrcHashIter = m_bakedList.begin(); ommSrcHashIter != m_bakedList.end() && maxMicroTrianglesToBuild > 0; ) {
-      XXH64_hash_t ommSrcHash = *ommSrcHashIter;
+    for (auto ommCacheItemIndex = m_ommCache.front(OpacityMicromapCache::List::Baked); 
+         ommCacheItemIndex != OpacityMicromapCache::kInvalidIndex && maxMicroTrianglesToBuild > 0; ) {
+      const XXH64_hash_t ommSrcHash = m_ommCache.getHash(ommCacheItemIndex);
+      // Advance before the item is moved to another list or destroyed
+      const auto nextOmmCacheItemIndex = m_ommCache.next(ommCacheItemIndex);
 #ifdef VALIDATION_MODE
       Logger::warn(str::format("[RTX Opacity Micromap] Building ", ommSrcHash, " on thread_id ", std::this_thread::get_id()));
 #endif
-      auto ommCacheItemIter = m_ommCache.find(ommSrcHash);
-      OpacityMicromapCacheItem& ommCacheItem = ommCacheItemIter->second;
+      OpacityMicromapCacheItem& ommCacheItem = m_ommCache[ommCacheItemIndex];
 
-      OmmResult result = buildOpacityMicromap(ctx, *ommSrcHashIter, ommCacheItem, micromapUsageGroups[buildItemCount],
+      OmmResult result = buildOpacityMicromap(ctx, ommSrcHash, ommCacheItem, micromapUsageGroups[buildItemCount],
                                               micromapBuildInfos[buildItemCount], maxMicroTrianglesToBuild, forceOmmBuild);
       
       if (result == OmmResult::Success) {
         ommCacheItem.cacheState = OpacityMicromapCacheState::eStep3_Built;
         // Move the item from the baked list to the end of the built list
-        auto ommSrcHashIterToMove = ommSrcHashIter++;
-        m_builtList.splice(m_builtList.end(), m_bakedList, ommSrcHashIterToMove);
+        m_ommCache.pushBack(OpacityMicromapCache::List::Built, ommCacheItemIndex);
         ++buildItemCount;
 
         forceOmmBuild = false;
@@ -2116,25 +2106,21 @@ namespace dxvk {
         ONCE(Logger::warn(str::format("[RTX Opacity Micromap] Building Opacity Micromap failed for hash ", ommSrcHash, ".Ignoring and black listing the hash.")));
 #endif
         // Building failed, ditch the OMM data
-        // First update the iterator, then remove the element
-        ommSrcHashIter++;
-        destroyOmmData(ommCacheItemIter);
+        destroyOmmData(ommCacheItemIndex);
         m_blackListedList.insert(ommSrcHash);
       } else if (result == OmmResult::OutOfBudget) {
         // Do nothing, continue onto the next
-        ommSrcHashIter++;
 
         if (OpacityMicromapOptions::Building::enableUnlimitedBakingAndBuildingBudgets()) {
           ONCE(Logger::err("[RTX Opacity Micromap] Failed to fully build an Opacity Micromap due to budget limits even with unlimited budgetting enabled."));
         }
       } else if (result == OmmResult::OutOfMemory) {
         // Do nothing, try the next one
-        ommSrcHashIter++;
         ONCE(Logger::warn("[RTX Opacity Micromap] Building Opacity Micromap Array failed as it ran out of memory."));
       } else {
         omm_validation_assert(0 && "Should not be hit");
-        ommSrcHashIter++;
       }
+      ommCacheItemIndex = nextOmmCacheItemIndex;
 #ifdef VALIDATION_MODE
       Logger::warn(str::format("[RTX Opacity Micromap] ~Building ", ommSrcHash, " on thread_id ", std::this_thread::get_id()));
 #endif
@@ -2233,20 +2219,10 @@ namespace dxvk {
         if (m_amountOfMemoryMissing > 0) {
 
           // Start evicting least recently used items 
-          for (auto lruOmmSrcHashIter = m_leastRecentlyUsedList.begin();
-               lruOmmSrcHashIter != m_leastRecentlyUsedList.end() && m_amountOfMemoryMissing > m_memoryManager.calculatePendingAvailableSize();
+          for (auto ommCacheItemIndex = m_ommCache.leastRecentlyUsed();
+               ommCacheItemIndex != OpacityMicromapCache::kInvalidIndex && m_amountOfMemoryMissing > m_memoryManager.calculatePendingAvailableSize();
                ) {
-            auto cacheItemIter = m_ommCache.find(*lruOmmSrcHashIter);
-            if (cacheItemIter == m_ommCache.end()) {
-              auto iterToDelete = lruOmmSrcHashIter;
-              // Increment the iterator before any deletion
-              lruOmmSrcHashIter++;
-              ONCE(Logger::err("[RTX] Failed to find Opacity Micromap cache entry on LRU eviction"));
-              m_leastRecentlyUsedList.erase(iterToDelete);
-              continue;
-            }
-
-            const uint32_t cacheItemUsageFrameAge = currentFrameIndex - cacheItemIter->second.lastUseFrameIndex;
+            const uint32_t cacheItemUsageFrameAge = currentFrameIndex - m_ommCache[ommCacheItemIndex].lastUseFrameIndex;
 
             // Stop eviction once an item is recent enough
             if (cacheItemUsageFrameAge < OpacityMicromapOptions::Cache::minUsageFrameAgeBeforeEviction() &&
@@ -2254,10 +2230,11 @@ namespace dxvk {
               !hasVRamBudgetDecreased)
               break;
 
-            // Increment the iterator before any deletion
-            lruOmmSrcHashIter++;
+            // Advance before any deletion
+            const auto itemToEvictIndex = ommCacheItemIndex;
+            ommCacheItemIndex = m_ommCache.nextMoreRecentlyUsed(ommCacheItemIndex);
 
-            destroyOmmData(cacheItemIter);
+            destroyOmmData(itemToEvictIndex);
           }
         }
       } else { // budget == 0
@@ -2285,6 +2262,18 @@ namespace dxvk {
     // Staging results are only needed for one frame, so purge them
     m_numTexelsPerMicroTriangleStaging.clear();
 
+    // Release the thread pool slots of finished jobs, even if no instance asks for their results anymore
+    retirePendingNumTexelsPerMicroTriangleEstimates(false);
+
+    // Purge estimates no longer used by any instance
+    for (auto estimateIter = m_numTexelsPerMicroTriangleEstimates.begin(); estimateIter != m_numTexelsPerMicroTriangleEstimates.end();) {
+      if (estimateIter->second.expired()) {
+        estimateIter = m_numTexelsPerMicroTriangleEstimates.erase(estimateIter);
+      } else {
+        ++estimateIter;
+      }
+    }
+
     m_numTrianglesToCalculateForNumTexelsPerMicroTriangle =
       OpacityMicromapOptions::Building::ConservativeEstimation::maxTrianglesToCalculateTexelDensityForPerFrame();
 
@@ -2348,7 +2337,7 @@ namespace dxvk {
     uint32_t numMicroTrianglesToBuildAvailable = fNumMicroTrianglesToBuildAvailable < UINT32_MAX ? static_cast<uint32_t>(fNumMicroTrianglesToBuildAvailable) : UINT32_MAX;
 
     // Generate opacity micromaps
-    if (!m_unprocessedList.empty() || !m_bakedList.empty()) {
+    if (!m_ommCache.empty(OpacityMicromapCache::List::Unprocessed) || !m_ommCache.empty(OpacityMicromapCache::List::Baked)) {
       ScopedGpuProfileZone(ctx, "Process Opacity Micromaps");
 
       bakeOpacityMicromapArrays(ctx, textures, numMicroTrianglesToBakeAvailable);
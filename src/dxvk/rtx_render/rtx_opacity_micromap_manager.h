@@ -27,8 +27,10 @@
 #include "rtx_option.h"
 #include "rtx_common_object.h"
 #include "rtx_staging.h"
+#include "rtx_opacity_micromap_cache.h"
+#include "rtx_opacity_micromap_texel_estimation.h"
+#include <deque>
 #include <vector>
-#include <list>
 #include <unordered_map>
 
 namespace dxvk {
@@ -194,16 +196,6 @@ namespace dxvk {
     Rc<vk::DeviceFn> m_vkd;
   };
 
-  enum class OpacityMicromapCacheState {
-    eStep0_Unprocessed = 0, // Cache items that use OMMs but yet to have any data generated for them
-    eStep1_Baking,          // Cache items with OMM arrays being baked but not all baking tasks have been submitted
-    eStep2_Baked,           // Cache items with baked OMM arrays
-    eStep3_Built,           // Cache items with built OMMs, but require barrier sync before use in a BLAS build
-    eStep4_Ready,           // Cache items with built OMMs
-
-    eUnknown
-  };
-
   // All parameters contributing to an OmmSrcHash
   // Ensure the struct is fully padded and default initialized
   struct OpacityMicromapHashSourceData {
@@ -264,17 +256,6 @@ namespace dxvk {
     uint16_t subdivisionLevel = UINT16_MAX;
     uint32_t numTriangles = UINT32_MAX;
     VkOpacityMicromapFormatEXT ommFormat = VK_OPACITY_MICROMAP_FORMAT_2_STATE_EXT;
-    std::list<XXH64_hash_t>::iterator leastRecentlyUsedListIter;
-
-    // Iterator to a cache state list for the current cacheState.
-    // Since the iterator is moved between the lists, it is initalized only once
-    // and remains valid until it's removed from a list
-    std::list<XXH64_hash_t>::iterator cacheStateListIter;
-
-    // Whether cacheStateListIter is valid when it corresponds to m_unprocessedList.
-    // This is to handle the iterator state when an OMM cache item is in unprocessed or baking state
-    // but the source data has been unlinked and cacheStateList item was removed
-    bool isUnprocessedCacheStateListIterValid = false;  
 
     // Needed during baking
     Rc<DxvkBuffer> ommArrayBuffer;   // Per micro triangle
@@ -284,59 +265,28 @@ namespace dxvk {
     VkDeviceSize blasOmmBuffersDeviceSize = 0;
     VkDeviceSize arrayBufferDeviceSize = 0;
 
-    OpacityMicromapCacheItem();
+    // Items are constructed in place in the cache pool and never copied or moved
     OpacityMicromapCacheItem(DxvkDevice& device, OpacityMicromapCacheState _cacheState, const uint32_t subdivisionLevel, const bool enableVertexAndTextureOperations,     
-                             uint32_t currentFrameIndex, std::list<XXH64_hash_t>::iterator _mostRecentlyUsedListIter, std::list<XXH64_hash_t>::iterator _cacheStateListIter,
-                             const OmmRequest& ommRequest);
-    OpacityMicromapCacheItem(const OpacityMicromapCacheItem& src) 
-    : cacheState(src.cacheState)
-    , blasOmmBuffers(src.blasOmmBuffers)
-    , ommArrayBuffer(src.ommArrayBuffer)
-    , useVertexAndTextureOperations(src.useVertexAndTextureOperations)
-    , subdivisionLevel(src.subdivisionLevel)
-    , ommFormat(src.ommFormat)
-    , leastRecentlyUsedListIter(src.leastRecentlyUsedListIter)
-    , cacheStateListIter(src.cacheStateListIter)
-    , isUnprocessedCacheStateListIterValid(src.isUnprocessedCacheStateListIterValid) { }
+                             uint32_t currentFrameIndex, const OmmRequest& ommRequest);
 
     VkDeviceSize getDeviceSize() const;
 
     bool isCompatibleWithOmmRequest(const OmmRequest& ommRequest);
   };
 
-  class OpacityMicromapMemoryManager : public CommonDeviceObject {
+  // Updates the Opacity Micromap memory budget from runtime vidmem stats
+  class OpacityMicromapMemoryManager : public CommonDeviceObject, public OpacityMicromapMemoryBudget {
   public:
     explicit OpacityMicromapMemoryManager(DxvkDevice* device);
 
-    void onFrameStart();
     void registerVidmemFreeSize();
     void updateMemoryBudget(Rc<DxvkContext> ctx);
 
-    bool allocate(VkDeviceSize size);
-    VkDeviceSize getAvailable() const;
-    void release(VkDeviceSize size);
-    void releaseAll();
-
-    VkDeviceSize getBudget() const { return m_budget; }
-    VkDeviceSize getPrevBudget() const;
-    VkDeviceSize getUsed() const { return m_used; }
-    float calculateUsageRatio() const;
-    VkDeviceSize calculatePendingAvailableSize() const;
-    VkDeviceSize calculatePendingReleasedSize() const;
-    VkDeviceSize getNextPendingReleasedSize() const;
-
   private:
     static const VkDeviceSize kInvalidDeviceSize = -1;
-    VkDeviceSize m_used = 0;
-    VkDeviceSize m_budget = 0;
-    VkDeviceSize m_prevBudget = 0;
     VkDeviceSize m_vidmemFreeSize = kInvalidDeviceSize;
 
     VkPhysicalDeviceMemoryProperties  m_memoryProperties;
-
-    // Stores amount of memory released per frame. The release memory is added back to the pool
-    // with a delay accounting for lifetime management of resources in flight
-    std::list<VkDeviceSize> m_pendingReleaseSize;
   };
 
   // Data stored in RtInstances for quick lookups
@@ -429,7 +379,7 @@ namespace dxvk {
     // Internal use only
     void onInstanceUnlinked(const RtInstance& instance);
   private:
-    typedef fast_unordered_cache<OpacityMicromapCacheItem> OpacityMicromapCache;
+    typedef OpacityMicromapCachePool<OpacityMicromapCacheItem> OpacityMicromapCache;
 
     struct InstanceOmmRequests {
       uint32_t numActiveRequests = 0;
@@ -463,8 +413,8 @@ namespace dxvk {
     fast_unordered_cache<CachedSourceData>::iterator registerCachedSourceData(const OmmRequest& ommRequest);
     void deleteCachedSourceData(fast_unordered_cache<CachedSourceData>::iterator sourceDataIter, OpacityMicromapCacheState ommCacheState, bool destroyParentInstanceOmmRequestContainer);
     void deleteCachedSourceData(XXH64_hash_t ommSrcHash, OpacityMicromapCacheState ommCacheState, bool destroyParentInstanceOmmRequestContainer);
-    bool insertToUnprocessedList(const OmmRequest& ommRequest, std::list<XXH64_hash_t>::iterator& cacheStateListIter);
-    void destroyOmmData(OpacityMicromapCache::iterator ommCacheIterator, bool destroyParentInstanceOmmRequestContainer = true);
+    bool insertToUnprocessedList(const OmmRequest& ommRequest, OpacityMicromapCache::Index ommCacheItemIndex);
+    void destroyOmmData(OpacityMicromapCache::Index ommCacheItemIndex, bool destroyParentInstanceOmmRequestContainer = true);
     void destroyOmmData(XXH64_hash_t ommSrcHash);
     static OpacityMicromapInstanceData& getOmmInstanceData(const RtInstance& instance);
 
@@ -475,20 +425,40 @@ namespace dxvk {
     Rc<DxvkBuffer> getScratchMemory(const size_t requiredScratchAllocSize);
 
     typedef std::vector<uint16_t> NumTexelsPerMicroTriangle;
+
+    // Once calculated, an estimate is shared by all instances with the same geometry and opacity texture resolution
+    struct NumTexelsPerMicroTriangleEstimate {
+      NumTexelsPerMicroTriangle numTexelsPerMicroTriangle;
+      uint32_t numTrianglesWithinTexelBudget = 0;
+      // Set while a worker thread calculates the estimate, cleared once its job has been retired
+      bool isPending = false;
+    };
+
     struct NumTexelsPerMicroTriangleCalculationData {
-      NumTexelsPerMicroTriangle result;
+      std::shared_ptr<NumTexelsPerMicroTriangleEstimate> result;
       OmmResult status = OmmResult::DependenciesUnavailable;
 
+      // Set while the result comes from a worker thread and hasn't been picked up yet
+      bool waitsForWorkerThread = false;
+
       // Note: these variables are calculated in calculateNumTexelsPerMicroTriangle() and carried over.
       //       They must not be used outside of the function as they are not kept up-to-date for all outcomes
+      XXH64_hash_t estimateHash = kEmptyHash;
       uint32_t numTrianglesCalculated = 0;
-      uint32_t numTrianglesWithinTexelBudget = 0;
     };
 
-    static uint32_t calculateNumTexelsPerMicroTriangle(Vector2 triangleTexcoords[3], float rcpNumMicroTrianglesAlongEdge, Vector2 textureResolution);
-    void calculateNumTexelsPerMicroTriangle(NumTexelsPerMicroTriangleCalculationData& numTexelsPerMicroTriangle, const RtInstance& instance, const uint32_t numTriangles);
+    // Meshes with fewer triangles are not worth the snapshot and the dispatch to a worker thread
+    static constexpr uint32_t kMinTrianglesToEstimateOnWorkerThread = 4096;
+    static constexpr uint32_t kMaxPendingNumTexelsPerMicroTriangleEstimates = 16;
+
+    void calculateNumTexelsPerMicroTriangle(NumTexelsPerMicroTriangleCalculationData& numTexelsPerMicroTriangle, const RtInstance& instance, const uint32_t numTriangles, const bool allowWorkerThread);
     void calculateNumTexelsPerMicroTriangle(const RtInstance& instance);
-    OmmResult getNumTexelsPerMicroTriangle(const RtInstance& instance, NumTexelsPerMicroTriangle** numTexelsPerMicroTriangle);
+    bool scheduleNumTexelsPerMicroTriangleEstimate(NumTexelsPerMicroTriangleCalculationData& numTexelsPerMicroTriangle, const OpacityMicromapTexelEstimationInput& input, const uint32_t numTriangles);
+    void retirePendingNumTexelsPerMicroTriangleEstimates(bool wait);
+    void resolvePendingNumTexelsPerMicroTriangle(NumTexelsPerMicroTriangleCalculationData& numTexelsPerMicroTriangle);
+    void onNumTexelsPerMicroTriangleCalculated(NumTexelsPerMicroTriangleCalculationData& numTexelsPerMicroTriangle);
+    void destroyNumTexelsPerMicroTriangle(XXH64_hash_t ommSrcHash);
+    OmmResult getNumTexelsPerMicroTriangle(const RtInstance& instance, const NumTexelsPerMicroTriangle** numTexelsPerMicroTriangle);
 
     // Called whenever a new instance has been added to the database
     void onInstanceAdded(const RtInstance& instance);
@@ -523,15 +493,11 @@ namespace dxvk {
 
     fast_unordered_cache<InstanceOmmRequests> m_instanceOmmRequests;
 
+    // Cache items with their state lists (unprocessed, baked and built) and LRU order
     OpacityMicromapCache m_ommCache; 
     fast_unordered_cache<CachedSourceData> m_cachedSourceData;
     std::vector<Rc<DxvkOpacityMicromap>> m_boundOMMs; // OMMs bound in a frame
 
-    // Ordered lists starting with oldest and/or smallest inserted items 
-    std::list<XXH64_hash_t> m_unprocessedList;   // Contains OMM data requests that are yet to be baked
-    std::list<XXH64_hash_t> m_bakedList;         // Contains OMM items with baked OMM arrays
-    std::list<XXH64_hash_t> m_builtList;         // Contains OMM items with built OMMs but require synchronization
-
     std::unordered_set<XXH64_hash_t> m_blackListedList;// Contains OMM surface hashes that failed to get baked or built (in time)
                                                  // and helps avoid wasting resources for such cases
     
@@ -545,9 +511,6 @@ namespace dxvk {
     uint32_t m_numMicroTrianglesBaked = 0;    // Per frame
     uint32_t m_numMicroTrianglesBuilt = 0;    // Per frame
 
-    // LRU management
-    std::list<XXH64_hash_t> m_leastRecentlyUsedList;  // Items stored in their usage order starting with least recently used item
-
     fast_unordered_cache<OMMBuildRequestStatistics> m_ommBuildRequestStatistics;
 
     VkDeviceSize m_amountOfMemoryMissing = 0;    // Records how much memory was missing in a frame
@@ -571,6 +534,18 @@ namespace dxvk {
     std::unordered_map<const RtInstance*, NumTexelsPerMicroTriangleCalculationData> m_numTexelsPerMicroTriangleStaging;
     // This could be stored in CachedSourceData to avoid an additional unordered_map lookup
     fast_unordered_cache<NumTexelsPerMicroTriangleCalculationData> m_numTexelsPerMicroTriangle;
+    // Calculated estimates still referenced by any calculation data, keyed by a hash of the inputs to the estimation
+    fast_unordered_cache<std::weak_ptr<NumTexelsPerMicroTriangleEstimate>> m_numTexelsPerMicroTriangleEstimates;
+    // Estimates for larger meshes are calculated on worker threads from a snapshot of their texcoord and index data
+    std::unique_ptr<WorkerThreadPool<kMaxPendingNumTexelsPerMicroTriangleEstimates, true, false>> m_numTexelsPerMicroTriangleThreadPool;
+    // Jobs in scheduling order. Their futures are consumed in this order, so every thread pool task slot is released before
+    // it is handed out again: at most kMaxPendingNumTexelsPerMicroTriangleEstimates jobs are pending, and the pool has at least as many slots
+    struct PendingNumTexelsPerMicroTriangleEstimate {
+      Future<void> future;
+      std::shared_ptr<NumTexelsPerMicroTriangleEstimate> result;
+      XXH64_hash_t estimateHash;
+    };
+    std::deque<PendingNumTexelsPerMicroTriangleEstimate> m_pendingNumTexelsPerMicroTriangleEstimates;
     std::vector<const RtInstance*> m_instancesToDestroy;
 
     // Need to give access to CachedSourceData to be able to purge m_numTexelsPerMicroTriangleStaging
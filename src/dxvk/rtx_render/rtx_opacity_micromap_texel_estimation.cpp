@@ -0,0 +1,270 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_opacity_micromap_texel_estimation.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <immintrin.h>
+
+namespace dxvk {
+
+  namespace {
+    // Add epsilon to avoid host underestimating sampling footprint due to float precision errors. 
+    // 0.001 should generally be large enough.
+    // Should the underestimation still occur, the shader will fall back to a conservative value for a micro triangle.
+    const float kEpsilon = 0.001f;
+    const float kHalfTexelOffset = 0.5f + kEpsilon;
+
+    // Retrieves a triangle's texcoords with the texture transform applied.
+    // Returns false if the triangle references a vertex outside of the texcoord data
+    template<typename IndexType>
+    bool fetchTriangleTexcoords(
+      const OpacityMicromapTexelEstimationInput& input,
+      const IndexType* indices,
+      uint32_t triangle,
+      Vector2 texcoords[3]) {
+
+      const uint32_t kNumIndicesPerTriangle = 3;
+      const uint32_t indexOffset = triangle * kNumIndicesPerTriangle;
+
+      for (uint32_t i = 0; i < kNumIndicesPerTriangle; i++) {
+        const uint32_t index = indices ? static_cast<uint32_t>(indices[i + indexOffset]) : i + indexOffset;
+
+        if (index >= input.numVertices) {
+          return false;
+        }
+
+        const float* texcoord = input.texcoordData + index * input.texcoordStride;
+        texcoords[i] = Vector2(texcoord[0], texcoord[1]);
+
+        if (input.textureTransform) {
+          texcoords[i] = (*input.textureTransform * Vector4(texcoords[i].x, texcoords[i].y, 0.f, 1.f)).xy();
+        }
+      }
+
+      return true;
+    }
+
+    template<typename IndexType>
+    uint32_t estimateScalar(
+      const OpacityMicromapTexelEstimationInput& input,
+      const IndexType* indices,
+      uint32_t firstTriangle,
+      uint32_t numTriangles,
+      uint16_t* numTexelsPerMicroTriangle) {
+
+      uint32_t numTrianglesWithinTexelBudget = 0;
+
+      for (uint32_t iTriangle = firstTriangle; iTriangle < firstTriangle + numTriangles; iTriangle++) {
+        Vector2 texcoords[3];
+        uint32_t iNumTexelsPerMicroTriangle = 0;
+
+        if (fetchTriangleTexcoords(input, indices, iTriangle, texcoords)) {
+          iNumTexelsPerMicroTriangle =
+            calculateNumTexelsPerMicroTriangle(texcoords, input.rcpNumMicroTrianglesAlongEdge, input.textureResolution);
+
+          if (iNumTexelsPerMicroTriangle > input.maxTexelTapsPerMicroTriangle) {
+            iNumTexelsPerMicroTriangle = 0;
+          }
+        }
+
+        numTexelsPerMicroTriangle[iTriangle] = static_cast<uint16_t>(iNumTexelsPerMicroTriangle);
+        numTrianglesWithinTexelBudget += iNumTexelsPerMicroTriangle != 0;
+      }
+
+      return numTrianglesWithinTexelBudget;
+    }
+
+    // floor() for SSE2, which has no rounding instruction.
+    // Floats of magnitude 2^23 and above are integral already and, like NaNs, are passed through
+    inline __m128 floorPs(__m128 x) {
+      const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+      // Truncation rounds negative values up, so step those down
+      const __m128 floored = _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.f)));
+      const __m128 isTruncatable = _mm_cmplt_ps(_mm_andnot_ps(_mm_set1_ps(-0.f), x), _mm_set1_ps(8388608.f));
+      return _mm_or_ps(_mm_and_ps(isTruncatable, floored), _mm_andnot_ps(isTruncatable, x));
+    }
+
+    // Mirrors calculateNumTexelsPerMicroTriangle() and the budget check in estimateScalar() for 4 triangles at a time.
+    // The texcoords are gathered per triangle, the rest of the math is done on all 4 triangles with the same operations in the same order,
+    // so the results match the scalar code exactly
+    template<typename IndexType>
+    uint32_t estimateBatched(
+      const OpacityMicromapTexelEstimationInput& input,
+      const IndexType* indices,
+      uint32_t firstTriangle,
+      uint32_t numTriangles,
+      uint16_t* numTexelsPerMicroTriangle) {
+
+      const uint32_t kBatchSize = 4;
+      const uint32_t numBatchedTriangles = numTriangles - numTriangles % kBatchSize;
+
+      const __m128 rcpNumMicroTrianglesAlongEdge = _mm_set1_ps(input.rcpNumMicroTrianglesAlongEdge);
+      const __m128 resolutionX = _mm_set1_ps(input.textureResolution.x);
+      const __m128 resolutionY = _mm_set1_ps(input.textureResolution.y);
+      const __m128 halfTexelOffset = _mm_set1_ps(kHalfTexelOffset);
+      const __m128 one = _mm_set1_ps(1.f);
+      const __m128 fltMax = _mm_set1_ps(FLT_MAX);
+      const __m128 negFltMax = _mm_set1_ps(-FLT_MAX);
+      const __m128 maxTexelTaps = _mm_set1_ps(static_cast<float>(input.maxTexelTapsPerMicroTriangle));
+      const __m128i zero = _mm_setzero_si128();
+      __m128i numTrianglesWithinTexelBudget = _mm_setzero_si128();
+
+      for (uint32_t iTriangle = firstTriangle; iTriangle < firstTriangle + numBatchedTriangles; iTriangle += kBatchSize) {
+        alignas(16) float u[3][kBatchSize];
+        alignas(16) float v[3][kBatchSize];
+        alignas(16) int32_t isValid[kBatchSize];
+
+        for (uint32_t lane = 0; lane < kBatchSize; lane++) {
+          Vector2 texcoords[3] = { Vector2 { 0.f }, Vector2 { 0.f }, Vector2 { 0.f } };
+          isValid[lane] = fetchTriangleTexcoords(input, indices, iTriangle + lane, texcoords) ? -1 : 0;
+
+          for (uint32_t i = 0; i < 3; i++) {
+            u[i][lane] = isValid[lane] ? texcoords[i].x : 0.f;
+            v[i][lane] = isValid[lane] ? texcoords[i].y : 0.f;
+          }
+        }
+
+        // Calculate micro triangle texcoords
+        const __m128 u0 = _mm_load_ps(u[0]);
+        const __m128 v0 = _mm_load_ps(v[0]);
+        const __m128 u1 = _mm_add_ps(u0, _mm_mul_ps(rcpNumMicroTrianglesAlongEdge, _mm_sub_ps(_mm_load_ps(u[1]), u0)));
+        const __m128 v1 = _mm_add_ps(v0, _mm_mul_ps(rcpNumMicroTrianglesAlongEdge, _mm_sub_ps(_mm_load_ps(v[1]), v0)));
+        const __m128 u2 = _mm_add_ps(u0, _mm_mul_ps(rcpNumMicroTrianglesAlongEdge, _mm_sub_ps(_mm_load_ps(u[2]), u0)));
+        const __m128 v2 = _mm_add_ps(v0, _mm_mul_ps(rcpNumMicroTrianglesAlongEdge, _mm_sub_ps(_mm_load_ps(v[2]), v0)));
+
+        // Find texcoord bbox for the micro triangles.
+        // Note: the operand order matches std::min/max in the scalar loop, which matters for non-finite texcoords
+        const __m128 minU = _mm_min_ps(_mm_min_ps(_mm_min_ps(fltMax, u0), u1), u2);
+        const __m128 minV = _mm_min_ps(_mm_min_ps(_mm_min_ps(fltMax, v0), v1), v2);
+        const __m128 maxU = _mm_max_ps(_mm_max_ps(_mm_max_ps(negFltMax, u0), u1), u2);
+        const __m128 maxV = _mm_max_ps(_mm_max_ps(_mm_max_ps(negFltMax, v0), v1), v2);
+
+        // Find the sampling index bbox aligned to texel centers that fully cover the texcoord bbox
+        const __m128 indexMinU = floorPs(_mm_sub_ps(_mm_mul_ps(minU, resolutionX), halfTexelOffset));
+        const __m128 indexMinV = floorPs(_mm_sub_ps(_mm_mul_ps(minV, resolutionY), halfTexelOffset));
+        const __m128 indexMaxU = floorPs(_mm_add_ps(_mm_mul_ps(maxU, resolutionX), halfTexelOffset));
+        const __m128 indexMaxV = floorPs(_mm_add_ps(_mm_mul_ps(maxV, resolutionY), halfTexelOffset));
+
+        // Calculate number of texels in the sampling index bbox.
+        // Both dimensions are integral, so is their product and it needs no rounding
+        const __m128 numTexels = _mm_mul_ps(
+          _mm_add_ps(_mm_sub_ps(indexMaxU, indexMinU), one),
+          _mm_add_ps(_mm_sub_ps(indexMaxV, indexMinV), one));
+
+        // Triangles exceeding the texel budget get 0
+        const __m128 isWithinTexelBudget = _mm_and_ps(
+          _mm_cmple_ps(numTexels, maxTexelTaps),
+          _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(isValid))));
+        const __m128i result = _mm_and_si128(_mm_cvttps_epi32(numTexels), _mm_castps_si128(isWithinTexelBudget));
+
+        // Subtracting 1 for each true (-1) lane
+        numTrianglesWithinTexelBudget = _mm_sub_epi32(numTrianglesWithinTexelBudget, _mm_cmpgt_epi32(result, zero));
+
+        // Pack to 16 bits. The results are at most UINT16_MAX, so bias them into the signed range to avoid the pack's saturation
+        const __m128i bias = _mm_set1_epi32(0x8000);
+        const __m128i packed = _mm_xor_si128(
+          _mm_packs_epi32(_mm_sub_epi32(result, bias), zero),
+          _mm_set1_epi16(static_cast<int16_t>(0x8000)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(numTexelsPerMicroTriangle + iTriangle), packed);
+      }
+
+      alignas(16) uint32_t laneCounts[kBatchSize];
+      _mm_store_si128(reinterpret_cast<__m128i*>(laneCounts), numTrianglesWithinTexelBudget);
+
+      return laneCounts[0] + laneCounts[1] + laneCounts[2] + laneCounts[3] +
+        estimateScalar(input, indices, firstTriangle + numBatchedTriangles, numTriangles - numBatchedTriangles, numTexelsPerMicroTriangle);
+    }
+  }
+
+  uint32_t calculateNumTexelsPerMicroTriangle(
+    const Vector2 triangleTexcoords[3],
+    float rcpNumMicroTrianglesAlongEdge,
+    Vector2 textureResolution) {
+
+    // For the sake of simplicity, we only calculate number of texels needed for a first micro triangle in the triangle. 
+    // Even though the micro triangles have the same UV area, the number of texels covering it may be different 
+    // between them depending on how their texcoords fit into texel bounds cutoffs, but the variability should be 
+    // small enough for OMM's purposes of estimating number of texels needed in a micro triangle when calculating baking costs.
+
+    // Calculate micro triangle texcoords
+    Vector2 texcoords[3];
+    texcoords[0] = triangleTexcoords[0];
+    texcoords[1] = triangleTexcoords[0] + rcpNumMicroTrianglesAlongEdge * (triangleTexcoords[1] - triangleTexcoords[0]);
+    texcoords[2] = triangleTexcoords[0] + rcpNumMicroTrianglesAlongEdge * (triangleTexcoords[2] - triangleTexcoords[0]);
+
+    // Find texcoord bbox for the micro triangle
+    Vector2 texcoordsMin(FLT_MAX, FLT_MAX);
+    Vector2 texcoordsMax(-FLT_MAX, -FLT_MAX);
+    for (uint32_t i = 0; i < 3; i++) {
+      texcoordsMin = min(texcoords[i], texcoordsMin);
+      texcoordsMax = max(texcoords[i], texcoordsMax);
+    }
+
+    // Find the sampling index bbox for the micro triangle.
+    // Align the bbox to actual texel centers that fully cover the bbox.
+    // Align with a top left texel relative to the bbox min.
+    const Vector2 texcoordsIndexMin = doFloor(texcoordsMin * textureResolution - Vector2{ kHalfTexelOffset });
+    // Align with a bottom right pixel relative to the bbox max
+    const Vector2 texcoordsIndexMax = doFloor(texcoordsMax * textureResolution + Vector2{ kHalfTexelOffset });
+
+    // Calculate number of texels in the given texcoord bbox.
+    // +1: include the end point of the bbox
+    const Vector2 texelSampleDims = texcoordsIndexMax - texcoordsIndexMin + Vector2{ 1.0f };
+    const uint32_t numTexelsPerMicroTriangle =
+      static_cast<uint32_t>(std::min<float>(round(texelSampleDims.x * texelSampleDims.y), static_cast<float>(UINT32_MAX)));
+
+    return numTexelsPerMicroTriangle;
+  }
+
+  uint32_t estimateNumTexelsPerMicroTriangle(
+    const OpacityMicromapTexelEstimationInput& input,
+    uint32_t firstTriangle,
+    uint32_t numTriangles,
+    uint16_t* numTexelsPerMicroTriangle) {
+
+    if (input.indices16) {
+      return estimateBatched(input, input.indices16, firstTriangle, numTriangles, numTexelsPerMicroTriangle);
+    } else if (input.indices32) {
+      return estimateBatched(input, input.indices32, firstTriangle, numTriangles, numTexelsPerMicroTriangle);
+    } else {
+      return estimateBatched<uint32_t>(input, nullptr, firstTriangle, numTriangles, numTexelsPerMicroTriangle);
+    }
+  }
+
+  uint32_t estimateNumTexelsPerMicroTriangleScalar(
+    const OpacityMicromapTexelEstimationInput& input,
+    uint32_t firstTriangle,
+    uint32_t numTriangles,
+    uint16_t* numTexelsPerMicroTriangle) {
+
+    if (input.indices16) {
+      return estimateScalar(input, input.indices16, firstTriangle, numTriangles, numTexelsPerMicroTriangle);
+    } else if (input.indices32) {
+      return estimateScalar(input, input.indices32, firstTriangle, numTriangles, numTexelsPerMicroTriangle);
+    } else {
+      return estimateScalar<uint32_t>(input, nullptr, firstTriangle, numTriangles, numTexelsPerMicroTriangle);
+    }
+  }
+
+}  // namespace dxvk
@@ -0,0 +1,74 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../../util/util_matrix.h"
+#include "../../util/util_vector.h"
+
+namespace dxvk {
+
+  // Source data for estimating how many opacity texels cover a micro triangle of each triangle in a mesh.
+  // Index data is tightly packed, with at most one of the index pointers set. Without indices, every 3 consecutive vertices form a triangle.
+  struct OpacityMicromapTexelEstimationInput {
+    const float* texcoordData = nullptr;
+    size_t texcoordStride = 2;              // In floats
+    uint32_t numVertices = 0;               // Triangles referencing vertices past this count are treated as exceeding the texel budget
+
+    const uint16_t* indices16 = nullptr;
+    const uint32_t* indices32 = nullptr;
+
+    const Matrix4* textureTransform = nullptr; // Applied to the texcoords when set
+
+    Vector2 textureResolution { 0.f };
+    float rcpNumMicroTrianglesAlongEdge = 1.f;
+    uint32_t maxTexelTapsPerMicroTriangle = 0; // Must not exceed UINT16_MAX
+  };
+
+  // Calculates number of texels that cover a micro triangle in a triangle.
+  // This matches the texcoord span done for conservative opacity estimation during OMM triangle array baking.
+  // Returns UINT32_MAX if number of texels exceeds the maximum allowed value
+  uint32_t calculateNumTexelsPerMicroTriangle(
+    const Vector2 triangleTexcoords[3],
+    float rcpNumMicroTrianglesAlongEdge,
+    Vector2 textureResolution);
+
+  // Estimates number of texels per micro triangle for triangles [firstTriangle, firstTriangle + numTriangles) and writes them 
+  // to numTexelsPerMicroTriangle[firstTriangle...]. Triangles needing more taps than maxTexelTapsPerMicroTriangle get 0.
+  // Processes 4 triangles at a time with SSE and produces the same results as the scalar variant.
+  // Returns number of the processed triangles within the texel budget
+  uint32_t estimateNumTexelsPerMicroTriangle(
+    const OpacityMicromapTexelEstimationInput& input,
+    uint32_t firstTriangle,
+    uint32_t numTriangles,
+    uint16_t* numTexelsPerMicroTriangle);
+
+  // Scalar reference of estimateNumTexelsPerMicroTriangle()
+  uint32_t estimateNumTexelsPerMicroTriangleScalar(
+    const OpacityMicromapTexelEstimationInput& input,
+    uint32_t firstTriangle,
+    uint32_t numTriangles,
+    uint16_t* numTexelsPerMicroTriangle);
+
+}  // namespace dxvk
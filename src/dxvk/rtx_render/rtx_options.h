@@ -1026,6 +1026,10 @@ namespace dxvk {
                  "While a game is running, if a texture file is modified on a disk, it will be automatically reuploaded to GPU.");
       RTX_OPTION_FLAG_ENV("rtx.texturemanager", uint, hotReloadRateMs, 100, RtxOptionFlags::NoSave, "DXVK_TEXTURES_HOTRELOAD_RATE_MS",
                  "Amount of time to wait between filesystem OS events, for texture hot-reloading. In milliseconds.");
+      RTX_OPTION_FLAG_ENV("rtx.texturemanager", uint, hotReloadDebounceMs, 250, RtxOptionFlags::NoSave, "DXVK_TEXTURES_HOTRELOAD_DEBOUNCE_MS",
+                 "Amount of time without new file changes to wait before hot-reloading textures, so that a burst of writes (e.g. an export of many textures, or a file written in chunks) is reloaded once, in a single batch. In milliseconds.");
+      RTX_OPTION_FLAG_ENV("rtx.texturemanager", bool, hotReloadPolling, false, RtxOptionFlags::NoSave, "DXVK_TEXTURES_HOTRELOAD_POLLING",
+                 "Detect texture file changes by periodically comparing file timestamps and sizes, instead of OS change notifications. Useful for filesystems that don't report changes, e.g. network shares.");
     };
     RTX_OPTION("rtx", bool, reloadTextureWhenResolutionChanged, false, "Reload texture when resolution changed.");
     RTX_OPTION_FLAG_ENV("rtx", bool, alwaysWaitForAsyncTextures, false, RtxOptionFlags::NoSave, "DXVK_WAIT_ASYNC_TEXTURES", 
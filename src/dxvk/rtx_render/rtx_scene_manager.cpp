@@ -514,6 +514,7 @@ namespace dxvk {
 
     // execute graph updates after all garbage collection is complete (to avoid updating graphs that will just be deleted)
     // RtxOptions will still be pending, so any changes to them will apply next frame.
+    buildFrameHashUsage();
     m_graphManager.update(ctx);
 
     // Clear replacement material hashes before the next frame.  These are used by components, so must clear after graphManager updates.
@@ -521,6 +522,11 @@ namespace dxvk {
     
     // Clear mesh hashes before the next frame.  These are used by components, so must clear after graphManager updates.
     clearFrameMeshHashes();
+
+    // Clear the snapshot as well, so that graph instances created during the next frame (which run an initial
+    // update from `addInstance`) see no usage rather than the previous frame's.  They are evaluated against the
+    // complete snapshot of their first frame by the graph update at the end of that frame.
+    clearFrameHashUsage();
   }
 
   void SceneManager::onFrameEndNoRTX() {
@@ -1847,4 +1853,23 @@ namespace dxvk {
     m_currentFrameMeshHashes.clear();
   }
 
+  void SceneManager::buildFrameHashUsage() {
+    ScopedCpuProfileZone();
+    // Only graphs read the snapshot, so skip building it when there are none.
+    if (m_graphManager.getBatches().empty()) {
+      return;
+    }
+    m_frameHashUsage.replacementMaterials.build(m_currentFrameReplacementMaterialHashes);
+    m_frameHashUsage.meshes.build(m_currentFrameMeshHashes);
+    m_frameHashUsage.lights.buildFromKeys(m_lightManager.getLightTable());
+    m_frameHashUsage.fog = m_fog.getHash();
+  }
+
+  void SceneManager::clearFrameHashUsage() {
+    m_frameHashUsage.replacementMaterials.clear();
+    m_frameHashUsage.meshes.clear();
+    m_frameHashUsage.lights.clear();
+    m_frameHashUsage.fog = kEmptyHash;
+  }
+
 }  // namespace nvvk
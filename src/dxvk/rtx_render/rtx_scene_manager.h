@@ -34,6 +34,7 @@
 #include "../dxvk_staging.h"
 #include "../dxvk_bind_mask.h"
 #include "../util/util_hashtable.h"
+#include "../util/util_hash_usage_snapshot.h"
 
 #include "rtx_globals.h"
 #include "rtx_types.h"
@@ -227,6 +228,17 @@ public:
   uint32_t getMeshHashUsageCount(XXH64_hash_t meshHash) const;
   void clearFrameMeshHashes();
 
+  // Read-only view of the hashes used this frame, built once per frame just before graph updates, so that
+  // hash checker components can probe compact sorted arrays instead of the tracking maps above.
+  // It is only valid during those updates, and is empty for the rest of the frame.
+  struct FrameHashUsage {
+    HashUsageSnapshot replacementMaterials;
+    HashUsageSnapshot meshes;
+    HashUsageSnapshot lights;
+    XXH64_hash_t fog = kEmptyHash;
+  };
+  const FrameHashUsage& getFrameHashUsage() const { return m_frameHashUsage; }
+
   Rc<DxvkSampler> patchSampler( const VkFilter filterMode,
                                 const VkSamplerAddressMode addressModeU,
                                 const VkSamplerAddressMode addressModeV,
@@ -361,6 +373,10 @@ private:
 
   // Mesh hash tracking for current frame (hash -> count)
   std::unordered_map<XXH64_hash_t, uint32_t> m_currentFrameMeshHashes;
+
+  FrameHashUsage m_frameHashUsage;
+  void buildFrameHashUsage();
+  void clearFrameHashUsage();
 };
 
 }  // namespace nvvk
@@ -21,9 +21,11 @@
 */
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
 #include <vector>
-#include <queue>
-#include <unordered_map>
 
 namespace dxvk 
 {
@@ -50,6 +52,11 @@ namespace dxvk
 *  This structure is particularly useful for tracking GPU objects, where persistent
 *  indices for large, dynamic arrays are required.  e.g. bindless resources.
 * 
+*  Objects are only stored once, in the linear list.  Lookups go through an open
+*  addressed (linear probing) table of hash and index pairs, which compares against
+*  the object in the list, so objects must not be modified in a way that changes
+*  their hash or equality while they are tracked.
+* 
 *  NOTE: This object does no ref counting - its expected that the user supply T 
    as a ref-counted object if that behavior is desired.
 */
@@ -57,6 +64,11 @@ template<typename T, class HashFn, class KeyEqual = std::equal_to<T>>
 struct SparseUniqueCache
 {
 public:
+  // Default callback for track(), caches the object as is.
+  struct Passthrough {
+    const T& operator()(const T& in) const { return in; }
+  };
+
   SparseUniqueCache(SparseUniqueCache const&) = delete;
   SparseUniqueCache& operator=(SparseUniqueCache const&) = delete;
 
@@ -64,47 +76,46 @@ public:
   ~SparseUniqueCache() {}
 
   void clear() {
-    m_freeBuffers = {};
+    m_freeIndices.clear();
+    m_freeHead = 0;
     m_objects.clear();
-    m_bufferMap.clear();
+    // Keep the table allocated, caches are typically cleared and refilled every frame
+    std::fill(m_table.begin(), m_table.end(), Entry {});
+    m_numEntries = 0;
   }
 
-  uint32_t track(const T& obj, std::function<T(const T&)> onFirstCache = [](const T& in) { return in; }) {
+  // Returns the index of the object, caching the result of onFirstCache(obj) if it isn't tracked yet.
+  template<typename OnFirstCache = Passthrough>
+  uint32_t track(const T& obj, OnFirstCache&& onFirstCache = {}) {
+    const uint32_t hash = foldHash(m_hashFn(obj));
     uint32_t idx;
-    if (!find(obj, idx)) {
-      const T& objectToCache = onFirstCache(obj);
-      if (!m_freeBuffers.empty()) {
-        idx = m_freeBuffers.front();
-        m_freeBuffers.pop();
-        m_objects.at(idx) = objectToCache;
-      } else {
-        idx = m_objects.size();
-        m_objects.push_back(objectToCache);
-      }
-      m_bufferMap.insert({ objectToCache, idx });
+    if (findEntry(obj, hash, idx) != kNotFound) {
+      return idx;
+    }
+
+    if constexpr (std::is_same_v<std::decay_t<OnFirstCache>, Passthrough>) {
+      return insert(obj, hash);
+    } else {
+      const T objectToCache = onFirstCache(obj);
+      return insert(objectToCache, foldHash(m_hashFn(objectToCache)));
     }
-    return idx;
   }
 
   bool find(const T& buf, uint32_t& outIdx) const {
-    const auto& vtxBuffer = m_bufferMap.find(buf);
-    if (vtxBuffer != m_bufferMap.end()) {
-      outIdx = vtxBuffer->second;
-      return true;
-    }
-    return false;
+    return findEntry(buf, foldHash(m_hashFn(buf)), outIdx) != kNotFound;
   }
 
   void free(const T& buf) {
-    auto iter = m_bufferMap.find(buf);
-    if (iter != m_bufferMap.end()) {
-      m_objects.at(iter->second) = T();
-      m_freeBuffers.push(iter->second);
-      m_bufferMap.erase(iter);
+    uint32_t idx;
+    const size_t entry = findEntry(buf, foldHash(m_hashFn(buf)), idx);
+    if (entry != kNotFound) {
+      eraseEntry(entry);
+      m_objects[idx] = T();
+      m_freeIndices.push_back(idx);
     }
   }
 
-  uint32_t getActiveCount() const { return m_objects.size() - m_freeBuffers.size(); }
+  uint32_t getActiveCount() const { return m_numEntries; }
   uint32_t getTotalCount() const { return m_objects.size(); }
 
   T& at(const uint32_t i) { return m_objects[i]; }
@@ -113,10 +124,117 @@ public:
   std::vector<T>& getObjectTable() { return m_objects; }
 
 private:
-  std::queue<uint32_t> m_freeBuffers;
+  static constexpr uint32_t kEmptyIndex = ~0u;
+  static constexpr size_t kNotFound = ~size_t(0);
+  static constexpr size_t kMinTableSize = 16;
+  static constexpr size_t kMinFreeCompaction = 64;
+
+  struct Entry {
+    uint32_t hash = 0;
+    uint32_t index = kEmptyIndex;
+  };
+
+  static uint32_t foldHash(size_t hash) {
+    const uint64_t h = hash;
+    return uint32_t(h ^ (h >> 32));
+  }
+
+  // Fibonacci hashing, so that hash functions with poor low bits still spread over the table
+  size_t homeSlot(uint32_t hash) const {
+    return size_t(uint32_t(hash * 0x9E3779B1u)) >> m_tableShift;
+  }
+
+  size_t findEntry(const T& obj, uint32_t hash, uint32_t& outIdx) const {
+    if (m_numEntries == 0) {
+      return kNotFound;
+    }
+    const size_t mask = m_table.size() - 1;
+    for (size_t slot = homeSlot(hash); ; slot = (slot + 1) & mask) {
+      const Entry& entry = m_table[slot];
+      if (entry.index == kEmptyIndex) {
+        return kNotFound;
+      }
+      if (entry.hash == hash && m_keyEqual(m_objects[entry.index], obj)) {
+        outIdx = entry.index;
+        return slot;
+      }
+    }
+  }
+
+  uint32_t insert(const T& obj, uint32_t hash) {
+    uint32_t idx;
+    if (m_freeHead < m_freeIndices.size()) {
+      idx = m_freeIndices[m_freeHead++];
+      if (m_freeHead == m_freeIndices.size()) {
+        m_freeIndices.clear();
+        m_freeHead = 0;
+      } else if (m_freeHead * 2 >= m_freeIndices.size() && m_freeHead >= kMinFreeCompaction) {
+        // Drop the consumed front of the queue once it dominates, so steady churn doesn't grow it
+        m_freeIndices.erase(m_freeIndices.begin(), m_freeIndices.begin() + m_freeHead);
+        m_freeHead = 0;
+      }
+      m_objects[idx] = obj;
+    } else {
+      idx = m_objects.size();
+      m_objects.push_back(obj);
+    }
+
+    if ((m_numEntries + 1) * 2 > m_table.size()) {
+      rehash(std::max(kMinTableSize, m_table.size() * 2));
+    }
+    insertEntry(hash, idx);
+    m_numEntries++;
+    return idx;
+  }
+
+  void insertEntry(uint32_t hash, uint32_t idx) {
+    const size_t mask = m_table.size() - 1;
+    size_t slot = homeSlot(hash);
+    while (m_table[slot].index != kEmptyIndex) {
+      slot = (slot + 1) & mask;
+    }
+    m_table[slot] = Entry { hash, idx };
+  }
+
+  // Backward shift deletion, so lookups never have to skip over tombstones
+  void eraseEntry(size_t slot) {
+    const size_t mask = m_table.size() - 1;
+    for (size_t next = (slot + 1) & mask; m_table[next].index != kEmptyIndex; next = (next + 1) & mask) {
+      // An entry can fill the hole if the hole lies between its home slot and where it is now
+      if (((next - homeSlot(m_table[next].hash)) & mask) >= ((next - slot) & mask)) {
+        m_table[slot] = m_table[next];
+        slot = next;
+      }
+    }
+    m_table[slot] = Entry {};
+    m_numEntries--;
+  }
+
+  void rehash(size_t tableSize) {
+    std::vector<Entry> oldTable(tableSize);
+    std::swap(oldTable, m_table);
+
+    m_tableShift = 32;
+    for (size_t size = tableSize; size > 1; size >>= 1) {
+      m_tableShift--;
+    }
+
+    for (const Entry& entry : oldTable) {
+      if (entry.index != kEmptyIndex) {
+        insertEntry(entry.hash, entry.index);
+      }
+    }
+  }
+
+  // FIFO queue of free indices, consumed from m_freeHead
+  std::vector<uint32_t> m_freeIndices;
+  size_t m_freeHead = 0;
   std::vector<T> m_objects;
-  std::unordered_map<T, uint32_t, HashFn, KeyEqual> m_bufferMap;
+  std::vector<Entry> m_table;
+  uint32_t m_tableShift = 32;
+  uint32_t m_numEntries = 0;
+  HashFn m_hashFn;
+  KeyEqual m_keyEqual;
 };
 
 }  // namespace dxvk
-
@@ -31,6 +31,7 @@
 #include "rtx_asset_data_manager.h"
 #include "rtx_bindless_resource_manager.h"
 #include "rtx_file_watch.h"
+#include "rtx_asset_mip_cache.h"
 #include "rtx_texture.h"
 #include "rtx_io.h"
 #include "rtx_staging_ring.h"
@@ -983,6 +984,23 @@ namespace dxvk {
     m_hotreloadRequests.insert(tex);
   }
 
+  void RtxTextureManager::requestHotReload(const std::vector<Rc<ManagedTexture>>& textures) {
+    if (!RtxOptions::TextureManager::hotReload()) {
+      return;
+    }
+    if (!m_asyncThread) {
+      ONCE(Logger::err("filewatch: hot reload is not available with RTX IO. Only raw native filesystem is supported."));
+      return;
+    }
+    // insert the whole batch under one lock, so that it's never split across 'processAllHotReloadRequests' calls
+    auto lockRequestsList = std::unique_lock{ m_hotreloadMutex };
+    for (const Rc<ManagedTexture>& tex : textures) {
+      if (tex.ptr()) {
+        m_hotreloadRequests.insert(tex);
+      }
+    }
+  }
+
   namespace {
     struct FileReadLock {
       explicit FileReadLock(const char* filepath) {
@@ -1302,6 +1320,14 @@ namespace dxvk {
         if (usedBytes + byteSize <= budgetBytes) {
           usedBytes += byteSize;
           tex->requestMips(mipc);
+
+          // The next higher resolution mip is the likely next request, read it ahead if it would fit
+          if (mipc < allmipcount) {
+            const uint32_t nextLevel = tex->m_assetData->info().mipLevels - mipc - 1;
+            if (usedBytes + calcSizeForAsset(*tex->m_assetData, nextLevel, nextLevel + 1) <= budgetBytes) {
+              AssetMipCache::get().prefetch(tex->m_assetData, nextLevel, nextLevel + 1);
+            }
+          }
         } else {
           // doesn't fit => demote
           tex->requestMips(0);
@@ -1383,9 +1409,9 @@ namespace dxvk {
     // may cause high pressure on memory and/or cause hitches when loaded at runtime.
     const bool result = (assetData.info().mipLevels == 1) && (extent.width * extent.height >= 512 * 512);
     if (result) {
-      Logger::warn(str::format("A suboptimal replacement texture detected: ",
-                                    assetData.info().filename,
-                                    "! Please make sure all replacement textures have mip-maps."));
+      LOG_RATE_LIMITED(LogLevel::Warn, str::format("A suboptimal replacement texture detected: ",
+                                                   assetData.info().filename,
+                                                   "! Please make sure all replacement textures have mip-maps."));
     }
     return result;
   }
@@ -138,6 +138,7 @@ namespace dxvk {
     }
 
     void requestHotReload(const Rc<ManagedTexture>& tex);
+    void requestHotReload(const std::vector<Rc<ManagedTexture>>& textures);
     void processAllHotReloadRequests();
 
   private:
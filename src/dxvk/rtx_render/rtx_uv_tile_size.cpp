@@ -0,0 +1,513 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_uv_tile_size.h"
+
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+#include <optional>
+
+#include "../../util/log/log.h"
+#include "../../util/thread.h"
+#include "../../util/util_fast_cache.h"
+#include "../../util/util_once.h"
+#include "dxvk_scoped_annotation.h"
+
+namespace dxvk {
+
+  namespace {
+    // Relative tolerance when deciding whether a transform has a uniform scale
+    constexpr float kUniformScaleTolerance = 1e-5f;
+    constexpr size_t kMaxCachedEntries = 16 * 1024;
+
+    enum class TriangleSource {
+      Indexed16,
+      Indexed32,
+      List,
+      Strip,
+      Fan
+    };
+
+    template<TriangleSource Source>
+    inline void getTriangle(const void* pIndex, uint32_t triangle, uint32_t& v0, uint32_t& v1, uint32_t& v2) {
+      if constexpr (Source == TriangleSource::Indexed16) {
+        const uint16_t* pTriangle = static_cast<const uint16_t*>(pIndex) + triangle * 3;
+        v0 = pTriangle[0];
+        v1 = pTriangle[1];
+        v2 = pTriangle[2];
+      } else if constexpr (Source == TriangleSource::Indexed32) {
+        const uint32_t* pTriangle = static_cast<const uint32_t*>(pIndex) + triangle * 3;
+        v0 = pTriangle[0];
+        v1 = pTriangle[1];
+        v2 = pTriangle[2];
+      } else if constexpr (Source == TriangleSource::List) {
+        v0 = triangle * 3;
+        v1 = triangle * 3 + 1;
+        v2 = triangle * 3 + 2;
+      } else if constexpr (Source == TriangleSource::Strip) {
+        v0 = triangle;
+        v1 = triangle + 1;
+        v2 = triangle + 2;
+      } else {
+        v0 = 0;
+        v1 = triangle + 1;
+        v2 = triangle + 2;
+      }
+    }
+
+    // Rows of the linear part of objectToWorld (Matrix4 stores columns)
+    struct EdgeTransform {
+      float m[3][3];
+
+      explicit EdgeTransform(const Matrix4& linear) {
+        for (uint32_t row = 0; row < 3; row++) {
+          for (uint32_t column = 0; column < 3; column++) {
+            m[row][column] = linear[column][row];
+          }
+        }
+      }
+    };
+
+    // Squared UV tile size of one edge, the scalar version of the edge kernels below.  Edges with no length in
+    // world space contribute 0, edges with no length in UV space contribute infinity, as in the reference code.
+    template<bool Transform>
+    inline float edgeTileSizeSqr(const float* pa, const float* pb, const float* ta, const float* tb, const EdgeTransform* xf) {
+      float dx = pa[0] - pb[0];
+      float dy = pa[1] - pb[1];
+      float dz = pa[2] - pb[2];
+      if constexpr (Transform) {
+        const float wx = xf->m[0][0] * dx + xf->m[0][1] * dy + xf->m[0][2] * dz;
+        const float wy = xf->m[1][0] * dx + xf->m[1][1] * dy + xf->m[1][2] * dz;
+        const float wz = xf->m[2][0] * dx + xf->m[2][1] * dy + xf->m[2][2] * dz;
+        dx = wx;
+        dy = wy;
+        dz = wz;
+      }
+      if (dx == 0.f && dy == 0.f && dz == 0.f) {
+        return 0.f;
+      }
+      const float du = ta[0] - tb[0];
+      const float dv = ta[1] - tb[1];
+      return (dx * dx + dy * dy + dz * dz) / (du * du + dv * dv);
+    }
+
+    template<TriangleSource Source, bool Transform>
+    float maxTileSizeSqrScalar(const UvTileSizeGeometry& g, uint32_t triangleCount, const EdgeTransform* xf) {
+      float result = 0.f;
+      for (uint32_t t = 0; t < triangleCount; t++) {
+        uint32_t v[3];
+        getTriangle<Source>(g.pIndex, t, v[0], v[1], v[2]);
+        const float* p[3];
+        const float* uv[3];
+        for (uint32_t k = 0; k < 3; k++) {
+          p[k] = reinterpret_cast<const float*>(g.pVertex + g.vertexStride * v[k]);
+          uv[k] = reinterpret_cast<const float*>(g.pTexcoord + g.texcoordStride * v[k]);
+        }
+        result = std::max(result, edgeTileSizeSqr<Transform>(p[0], p[1], uv[0], uv[1], xf));
+        result = std::max(result, edgeTileSizeSqr<Transform>(p[0], p[2], uv[0], uv[2], xf));
+        result = std::max(result, edgeTileSizeSqr<Transform>(p[1], p[2], uv[1], uv[2], xf));
+      }
+      return result;
+    }
+
+    // SoA corner data of a batch of triangles
+    struct CornersSSE {
+      __m128 x[3], y[3], z[3], u[3], v[3];
+    };
+
+    struct CornersAVX2 {
+      __m256 x[3], y[3], z[3], u[3], v[3];
+    };
+
+    template<bool Transform>
+    inline __m128 edgeTileSizeSqrSSE(const CornersSSE& c, uint32_t a, uint32_t b, const __m128 (&xf)[9]) {
+      __m128 dx = _mm_sub_ps(c.x[a], c.x[b]);
+      __m128 dy = _mm_sub_ps(c.y[a], c.y[b]);
+      __m128 dz = _mm_sub_ps(c.z[a], c.z[b]);
+      if constexpr (Transform) {
+        const __m128 wx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xf[0], dx), _mm_mul_ps(xf[1], dy)), _mm_mul_ps(xf[2], dz));
+        const __m128 wy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xf[3], dx), _mm_mul_ps(xf[4], dy)), _mm_mul_ps(xf[5], dz));
+        const __m128 wz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xf[6], dx), _mm_mul_ps(xf[7], dy)), _mm_mul_ps(xf[8], dz));
+        dx = wx;
+        dy = wy;
+        dz = wz;
+      }
+      const __m128 zero = _mm_setzero_ps();
+      const __m128 hasLength = _mm_or_ps(_mm_or_ps(_mm_cmpneq_ps(dx, zero), _mm_cmpneq_ps(dy, zero)), _mm_cmpneq_ps(dz, zero));
+      const __m128 du = _mm_sub_ps(c.u[a], c.u[b]);
+      const __m128 dv = _mm_sub_ps(c.v[a], c.v[b]);
+      const __m128 lengthSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+      const __m128 uvLengthSqr = _mm_add_ps(_mm_mul_ps(du, du), _mm_mul_ps(dv, dv));
+      return _mm_and_ps(hasLength, _mm_div_ps(lengthSqr, uvLengthSqr));
+    }
+
+    template<bool Transform>
+    inline __m256 edgeTileSizeSqrAVX2(const CornersAVX2& c, uint32_t a, uint32_t b, const __m256 (&xf)[9]) {
+      __m256 dx = _mm256_sub_ps(c.x[a], c.x[b]);
+      __m256 dy = _mm256_sub_ps(c.y[a], c.y[b]);
+      __m256 dz = _mm256_sub_ps(c.z[a], c.z[b]);
+      if constexpr (Transform) {
+        const __m256 wx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(xf[0], dx), _mm256_mul_ps(xf[1], dy)), _mm256_mul_ps(xf[2], dz));
+        const __m256 wy = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(xf[3], dx), _mm256_mul_ps(xf[4], dy)), _mm256_mul_ps(xf[5], dz));
+        const __m256 wz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(xf[6], dx), _mm256_mul_ps(xf[7], dy)), _mm256_mul_ps(xf[8], dz));
+        dx = wx;
+        dy = wy;
+        dz = wz;
+      }
+      const __m256 zero = _mm256_setzero_ps();
+      const __m256 hasLength = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(dx, zero, _CMP_NEQ_UQ), _mm256_cmp_ps(dy, zero, _CMP_NEQ_UQ)),
+                                            _mm256_cmp_ps(dz, zero, _CMP_NEQ_UQ));
+      const __m256 du = _mm256_sub_ps(c.u[a], c.u[b]);
+      const __m256 dv = _mm256_sub_ps(c.v[a], c.v[b]);
+      const __m256 lengthSqr = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+      const __m256 uvLengthSqr = _mm256_add_ps(_mm256_mul_ps(du, du), _mm256_mul_ps(dv, dv));
+      return _mm256_and_ps(hasLength, _mm256_div_ps(lengthSqr, uvLengthSqr));
+    }
+
+    inline float horizontalMax(__m128 v) {
+      v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+      v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+      return _mm_cvtss_f32(v);
+    }
+
+    // Note: the edge value goes first in _mm_max_ps so that a NaN edge keeps the running max, like std::max does.
+    // Lanes past the last triangle repeat it, which doesn't change the max.
+    template<TriangleSource Source, bool Transform>
+    float maxTileSizeSqrSSE(const UvTileSizeGeometry& g, uint32_t triangleCount, const EdgeTransform* xf) {
+      __m128 xfs[9];
+      if constexpr (Transform) {
+        for (uint32_t i = 0; i < 9; i++) {
+          xfs[i] = _mm_set1_ps(xf->m[i / 3][i % 3]);
+        }
+      }
+
+      __m128 result = _mm_setzero_ps();
+      for (uint32_t t = 0; t < triangleCount; t += 4) {
+        uint32_t v[3][4];
+        for (uint32_t i = 0; i < 4; i++) {
+          getTriangle<Source>(g.pIndex, std::min(t + i, triangleCount - 1), v[0][i], v[1][i], v[2][i]);
+        }
+
+        CornersSSE c;
+        for (uint32_t k = 0; k < 3; k++) {
+          const float* p[4];
+          const float* uv[4];
+          for (uint32_t i = 0; i < 4; i++) {
+            p[i] = reinterpret_cast<const float*>(g.pVertex + g.vertexStride * v[k][i]);
+            uv[i] = reinterpret_cast<const float*>(g.pTexcoord + g.texcoordStride * v[k][i]);
+          }
+          c.x[k] = _mm_setr_ps(p[0][0], p[1][0], p[2][0], p[3][0]);
+          c.y[k] = _mm_setr_ps(p[0][1], p[1][1], p[2][1], p[3][1]);
+          c.z[k] = _mm_setr_ps(p[0][2], p[1][2], p[2][2], p[3][2]);
+          c.u[k] = _mm_setr_ps(uv[0][0], uv[1][0], uv[2][0], uv[3][0]);
+          c.v[k] = _mm_setr_ps(uv[0][1], uv[1][1], uv[2][1], uv[3][1]);
+        }
+
+        result = _mm_max_ps(edgeTileSizeSqrSSE<Transform>(c, 0, 1, xfs), result);
+        result = _mm_max_ps(edgeTileSizeSqrSSE<Transform>(c, 0, 2, xfs), result);
+        result = _mm_max_ps(edgeTileSizeSqrSSE<Transform>(c, 1, 2, xfs), result);
+      }
+      return horizontalMax(result);
+    }
+
+    template<TriangleSource Source, bool Transform>
+    float maxTileSizeSqrAVX2(const UvTileSizeGeometry& g, uint32_t triangleCount, const EdgeTransform* xf) {
+      __m256 xfs[9];
+      if constexpr (Transform) {
+        for (uint32_t i = 0; i < 9; i++) {
+          xfs[i] = _mm256_set1_ps(xf->m[i / 3][i % 3]);
+        }
+      }
+
+      const __m256i vertexStride = _mm256_set1_epi32(static_cast<int>(g.vertexStride));
+      const __m256i texcoordStride = _mm256_set1_epi32(static_cast<int>(g.texcoordStride));
+      const float* pX = reinterpret_cast<const float*>(g.pVertex);
+      const float* pY = reinterpret_cast<const float*>(g.pVertex + sizeof(float));
+      const float* pZ = reinterpret_cast<const float*>(g.pVertex + sizeof(float) * 2);
+      const float* pU = reinterpret_cast<const float*>(g.pTexcoord);
+      const float* pV = reinterpret_cast<const float*>(g.pTexcoord + sizeof(float));
+
+      __m256 result = _mm256_setzero_ps();
+      for (uint32_t t = 0; t < triangleCount; t += 8) {
+        alignas(32) uint32_t v[3][8];
+        for (uint32_t i = 0; i < 8; i++) {
+          getTriangle<Source>(g.pIndex, std::min(t + i, triangleCount - 1), v[0][i], v[1][i], v[2][i]);
+        }
+
+        CornersAVX2 c;
+        for (uint32_t k = 0; k < 3; k++) {
+          const __m256i index = _mm256_load_si256(reinterpret_cast<const __m256i*>(v[k]));
+          const __m256i vertexOffset = _mm256_mullo_epi32(index, vertexStride);
+          const __m256i texcoordOffset = _mm256_mullo_epi32(index, texcoordStride);
+          c.x[k] = _mm256_i32gather_ps(pX, vertexOffset, 1);
+          c.y[k] = _mm256_i32gather_ps(pY, vertexOffset, 1);
+          c.z[k] = _mm256_i32gather_ps(pZ, vertexOffset, 1);
+          c.u[k] = _mm256_i32gather_ps(pU, texcoordOffset, 1);
+          c.v[k] = _mm256_i32gather_ps(pV, texcoordOffset, 1);
+        }
+
+        result = _mm256_max_ps(edgeTileSizeSqrAVX2<Transform>(c, 0, 1, xfs), result);
+        result = _mm256_max_ps(edgeTileSizeSqrAVX2<Transform>(c, 0, 2, xfs), result);
+        result = _mm256_max_ps(edgeTileSizeSqrAVX2<Transform>(c, 1, 2, xfs), result);
+      }
+      return horizontalMax(_mm_max_ps(_mm256_castps256_ps128(result), _mm256_extractf128_ps(result, 1)));
+    }
+
+    template<TriangleSource Source, bool Transform>
+    float maxTileSizeSqr(const UvTileSizeGeometry& g, uint32_t triangleCount, const EdgeTransform* xf, fast::SIMD simd) {
+      // Gathers take 32 bit signed byte offsets
+      const uint64_t maxOffset = uint64_t(g.vertexCount) * std::max(g.vertexStride, g.texcoordStride);
+      const bool offsetsFitGather = maxOffset < uint64_t(INT32_MAX);
+
+      if (simd >= fast::SIMD::AVX2 && offsetsFitGather) {
+        return maxTileSizeSqrAVX2<Source, Transform>(g, triangleCount, xf);
+      } else if (simd >= fast::SIMD::SSE2) {
+        return maxTileSizeSqrSSE<Source, Transform>(g, triangleCount, xf);
+      }
+      return maxTileSizeSqrScalar<Source, Transform>(g, triangleCount, xf);
+    }
+
+    template<TriangleSource Source>
+    float maxTileSizeSqr(const UvTileSizeGeometry& g, uint32_t triangleCount, const EdgeTransform* xf, fast::SIMD simd) {
+      return xf ? maxTileSizeSqr<Source, true>(g, triangleCount, xf, simd)
+                : maxTileSizeSqr<Source, false>(g, triangleCount, xf, simd);
+    }
+
+    bool isAffine(const Matrix4& m) {
+      return m[0].w == 0.f && m[1].w == 0.f && m[2].w == 0.f && m[3].w == 1.f;
+    }
+
+    // Reference implementation: the per-triangle code this file replaced
+    float calcUVTileSizeSqr(const Matrix4& objectToWorld, const uint8_t* pVertex, size_t vertexStride, const uint8_t* pTexcoord, size_t texcoordStride, uint32_t vertex1, uint32_t vertex2, uint32_t vertex3) {
+      const Vector4 p1 = objectToWorld * Vector4(*reinterpret_cast<const Vector3* const>(pVertex + vertexStride * vertex1), 1.f);
+      const Vector4 p2 = objectToWorld * Vector4(*reinterpret_cast<const Vector3* const>(pVertex + vertexStride * vertex2), 1.f);
+      const Vector4 p3 = objectToWorld * Vector4(*reinterpret_cast<const Vector3* const>(pVertex + vertexStride * vertex3), 1.f);
+
+      const Vector2& t1 = *reinterpret_cast<const Vector2* const>(pTexcoord + texcoordStride * vertex1);
+      const Vector2& t2 = *reinterpret_cast<const Vector2* const>(pTexcoord + texcoordStride * vertex2);
+      const Vector2& t3 = *reinterpret_cast<const Vector2* const>(pTexcoord + texcoordStride * vertex3);
+      // UV tile size (squared)
+      float len1Sqr = p1 != p2 ? lengthSqr(p1 - p2) / lengthSqr(t1 - t2) : 0.f;
+      float len2Sqr = p1 != p3 ? lengthSqr(p1 - p3) / lengthSqr(t1 - t3) : 0.f;
+      float len3Sqr = p2 != p3 ? lengthSqr(p2 - p3) / lengthSqr(t2 - t3) : 0.f;
+
+      return std::max(len1Sqr, std::max(len2Sqr, len3Sqr));
+    }
+
+    template<TriangleSource Source>
+    float calcMaxUvTileSizeSqrReference(const UvTileSizeGeometry& g, uint32_t triangleCount, const Matrix4& objectToWorld) {
+      float result = 0.f;
+      for (uint32_t t = 0; t < triangleCount; t++) {
+        uint32_t v0, v1, v2;
+        getTriangle<Source>(g.pIndex, t, v0, v1, v2);
+        result = std::max(result, calcUVTileSizeSqr(objectToWorld, g.pVertex, g.vertexStride, g.pTexcoord, g.texcoordStride, v0, v1, v2));
+      }
+      return result;
+    }
+
+    // Resolves where triangles come from for the geometry's topology.  Returns false for unsupported input.
+    bool getTriangleSource(const UvTileSizeGeometry& g, TriangleSource& source, uint32_t& triangleCount) {
+      switch (g.topology) {
+      case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST:
+        if (g.indexCount > 0 && g.pIndex != nullptr) {
+          if (g.indexStride == 2) {
+            source = TriangleSource::Indexed16;
+          } else if (g.indexStride == 4) {
+            source = TriangleSource::Indexed32;
+          } else {
+            ONCE(Logger::err("computeMaxUVTileSize: invalid index stride"));
+            return false;
+          }
+          triangleCount = g.indexCount / 3;
+        } else {
+          source = TriangleSource::List;
+          triangleCount = g.vertexCount / 3;
+        }
+        return true;
+      case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP:
+        source = TriangleSource::Strip;
+        triangleCount = g.vertexCount > 2 ? g.vertexCount - 2 : 0;
+        return true;
+      case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN:
+        source = TriangleSource::Fan;
+        triangleCount = g.vertexCount > 2 ? g.vertexCount - 2 : 0;
+        return true;
+      default:
+        ONCE(Logger::err("computeMaxUVTileSize: unsupported topology"));
+        return false;
+      }
+    }
+
+    struct UvTileSizeCache {
+      dxvk::mutex mutex;
+      // Max squared tile size in object space, keyed by geometry
+      fast_unordered_cache<float> objectSpace;
+      // Max squared tile size under a non-uniform linear transform, keyed by geometry and transform
+      fast_unordered_cache<float> transformed;
+      size_t hitCount = 0;
+    };
+
+    UvTileSizeCache& getCache() {
+      static UvTileSizeCache s_cache;
+      return s_cache;
+    }
+
+    template<typename F>
+    float findOrCompute(fast_unordered_cache<float>& entries, XXH64_hash_t key, F&& compute) {
+      if (key == kEmptyHash) {
+        return compute();
+      }
+
+      UvTileSizeCache& cache = getCache();
+      {
+        std::lock_guard<dxvk::mutex> lock(cache.mutex);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+          ++cache.hitCount;
+          return it->second;
+        }
+      }
+
+      const float value = compute();
+
+      std::lock_guard<dxvk::mutex> lock(cache.mutex);
+      if (entries.size() >= kMaxCachedEntries) {
+        entries.clear();
+      }
+      entries.emplace(key, value);
+      return value;
+    }
+  }
+
+  float UvTileSizeCalculator::computeMaxUvTileSize(const UvTileSizeGeometry& geometry, const Matrix4& objectToWorld, XXH64_hash_t geometryKey) {
+    ScopedCpuProfileZone();
+
+    if (geometry.pVertex == nullptr || geometry.pTexcoord == nullptr) {
+      return NAN;
+    }
+
+    // Projective transforms don't preserve edge vectors, keep those on the reference path
+    if (!isAffine(objectToWorld)) {
+      return std::sqrt(computeMaxUvTileSizeSqrScalar(geometry, objectToWorld));
+    }
+
+    UvTileSizeCache& cache = getCache();
+
+    float scaleSqr;
+    if (getUniformScaleSqr(objectToWorld, scaleSqr)) {
+      const float objectSpaceSqr = findOrCompute(cache.objectSpace, geometryKey, [&]() {
+        return computeMaxUvTileSizeSqr(geometry, nullptr);
+      });
+      return std::sqrt(scaleSqr * objectSpaceSqr);
+    }
+
+    XXH64_hash_t key = geometryKey;
+    if (key != kEmptyHash) {
+      const EdgeTransform xf(objectToWorld);
+      key = XXH64(&xf.m[0][0], sizeof(xf.m), key);
+    }
+    return std::sqrt(findOrCompute(cache.transformed, key, [&]() {
+      return computeMaxUvTileSizeSqr(geometry, &objectToWorld);
+    }));
+  }
+
+  float UvTileSizeCalculator::computeMaxUvTileSizeSqr(const UvTileSizeGeometry& geometry, const Matrix4* linear, fast::SIMD simd) {
+    TriangleSource source;
+    uint32_t triangleCount;
+    if (!getTriangleSource(geometry, source, triangleCount) || triangleCount == 0) {
+      return 0.f;
+    }
+
+    simd = std::min(simd, fast::getSimdSupportLevel());
+
+    std::optional<EdgeTransform> xf;
+    if (linear) {
+      xf.emplace(*linear);
+    }
+    const EdgeTransform* pXf = xf ? &*xf : nullptr;
+
+    switch (source) {
+    case TriangleSource::Indexed16: return maxTileSizeSqr<TriangleSource::Indexed16>(geometry, triangleCount, pXf, simd);
+    case TriangleSource::Indexed32: return maxTileSizeSqr<TriangleSource::Indexed32>(geometry, triangleCount, pXf, simd);
+    case TriangleSource::List: return maxTileSizeSqr<TriangleSource::List>(geometry, triangleCount, pXf, simd);
+    case TriangleSource::Strip: return maxTileSizeSqr<TriangleSource::Strip>(geometry, triangleCount, pXf, simd);
+    case TriangleSource::Fan: return maxTileSizeSqr<TriangleSource::Fan>(geometry, triangleCount, pXf, simd);
+    }
+    return 0.f;
+  }
+
+  float UvTileSizeCalculator::computeMaxUvTileSizeSqrScalar(const UvTileSizeGeometry& geometry, const Matrix4& objectToWorld) {
+    TriangleSource source;
+    uint32_t triangleCount;
+    if (!getTriangleSource(geometry, source, triangleCount)) {
+      return 0.f;
+    }
+
+    switch (source) {
+    case TriangleSource::Indexed16: return calcMaxUvTileSizeSqrReference<TriangleSource::Indexed16>(geometry, triangleCount, objectToWorld);
+    case TriangleSource::Indexed32: return calcMaxUvTileSizeSqrReference<TriangleSource::Indexed32>(geometry, triangleCount, objectToWorld);
+    case TriangleSource::List: return calcMaxUvTileSizeSqrReference<TriangleSource::List>(geometry, triangleCount, objectToWorld);
+    case TriangleSource::Strip: return calcMaxUvTileSizeSqrReference<TriangleSource::Strip>(geometry, triangleCount, objectToWorld);
+    case TriangleSource::Fan: return calcMaxUvTileSizeSqrReference<TriangleSource::Fan>(geometry, triangleCount, objectToWorld);
+    }
+    return 0.f;
+  }
+
+  bool UvTileSizeCalculator::getUniformScaleSqr(const Matrix4& objectToWorld, float& scaleSqr) {
+    if (!isAffine(objectToWorld)) {
+      return false;
+    }
+
+    const Vector3 c0 = objectToWorld[0].xyz();
+    const Vector3 c1 = objectToWorld[1].xyz();
+    const Vector3 c2 = objectToWorld[2].xyz();
+    const float s0 = lengthSqr(c0);
+    const float s1 = lengthSqr(c1);
+    const float s2 = lengthSqr(c2);
+
+    // Columns of equal length that are orthogonal to each other
+    const float tolerance = kUniformScaleTolerance * s0;
+    if (s0 == 0.f ||
+        std::abs(s1 - s0) > tolerance || std::abs(s2 - s0) > tolerance ||
+        std::abs(dot(c0, c1)) > tolerance || std::abs(dot(c0, c2)) > tolerance || std::abs(dot(c1, c2)) > tolerance) {
+      return false;
+    }
+
+    scaleSqr = (s0 + s1 + s2) / 3.f;
+    return true;
+  }
+
+  void UvTileSizeCalculator::clearCache() {
+    UvTileSizeCache& cache = getCache();
+    std::lock_guard<dxvk::mutex> lock(cache.mutex);
+    cache.objectSpace.clear();
+    cache.transformed.clear();
+    cache.hitCount = 0;
+  }
+
+  size_t UvTileSizeCalculator::getCacheHitCount() {
+    UvTileSizeCache& cache = getCache();
+    std::lock_guard<dxvk::mutex> lock(cache.mutex);
+    return cache.hitCount;
+  }
+
+} // namespace dxvk
@@ -0,0 +1,77 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include "vulkan/vulkan_core.h"
+#include "rtx_constants.h"
+#include "../../util/util_fastops.h"
+#include "../../util/util_matrix.h"
+
+namespace dxvk {
+
+  // Mapped vertex, texcoord and (optional) index data of a mesh, as consumed by UvTileSizeCalculator.
+  struct UvTileSizeGeometry {
+    const uint8_t* pVertex = nullptr;
+    size_t vertexStride = 0;
+    const uint8_t* pTexcoord = nullptr;
+    size_t texcoordStride = 0;
+    const void* pIndex = nullptr;
+    size_t indexStride = 0;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  };
+
+  /**
+   * \brief Max UV tile size of a mesh
+   *
+   * The UV tile size of a triangle edge is the world space length covered by one unit of UV along it, and the
+   * result is the max over all edges.  Edges are evaluated 4 (SSE) or 8 (AVX2) triangles at a time.
+   *
+   * Only the linear part of the transform affects edge lengths, and for a rotation with uniform scale it only
+   * scales them.  So the object space result is cached per geometry, and a rigid transform change of the mesh is
+   * answered without walking it again.  Other transforms are cached per geometry and linear part.
+   */
+  class UvTileSizeCalculator {
+  public:
+    // `geometryKey` identifies the vertex, texcoord and index data of the mesh, kEmptyHash disables caching.
+    // Returns NAN if there is no vertex or texcoord data.
+    static float computeMaxUvTileSize(const UvTileSizeGeometry& geometry, const Matrix4& objectToWorld, XXH64_hash_t geometryKey);
+
+    // Max squared UV tile size with the edges transformed by the upper 3x3 of `linear`, or in object space if null.
+    static float computeMaxUvTileSizeSqr(const UvTileSizeGeometry& geometry, const Matrix4* linear,
+                                         fast::SIMD simd = fast::getSimdSupportLevel());
+
+    // Reference implementation, transforming every vertex of every triangle by `objectToWorld`.
+    static float computeMaxUvTileSizeSqrScalar(const UvTileSizeGeometry& geometry, const Matrix4& objectToWorld);
+
+    // True if `objectToWorld` is affine and its linear part is a rotation (or reflection) with a uniform scale.
+    static bool getUniformScaleSqr(const Matrix4& objectToWorld, float& scaleSqr);
+
+    static void clearCache();
+
+    static size_t getCacheHitCount();
+  };
+
+} // namespace dxvk
@@ -22,6 +22,7 @@
 #include "game_exporter.h"
 #include "game_exporter_common.h"
 #include "mdl_helpers.h"
+#include "usd_parallel.h"
 #include "../util/log/log.h"
 #include "../util/util_env.h"
 #include "../util/util_string.h"
@@ -44,6 +45,7 @@
 #include <pxr/usd/usdGeom/camera.h>
 #include <pxr/usd/usdGeom/xform.h>
 #include <pxr/usd/usdGeom/xformCommonAPI.h>
+#include <pxr/usd/sdf/changeBlock.h>
 #include <pxr/usd/usdLux/lightAPI.h>
 #include <pxr/usd/usdLux/sphereLight.h> 
 #include <pxr/usd/usdLux/distantLight.h>
@@ -338,94 +340,59 @@ static std::unordered_map<Enum,AttrDesc> attrDescs{
 }
 }
 
+template<typename T>
+std::vector<std::pair<Id, const T*>> GameExporter::collectEntries(const IdMap<T>& map) {
+  std::vector<std::pair<Id, const T*>> entries;
+  entries.reserve(map.size());
+  for (const auto& [id, value] : map) {
+    entries.emplace_back(id, &value);
+  }
+  return entries;
+}
+
+template<typename Fn>
+void GameExporter::forEachLayer(const Export& exportData, const size_t numLayers, const Fn& fn) {
+  if (!exportData.meta.bParallelExport) {
+    for (size_t i = 0; i < numLayers; i++) {
+      fn(i);
+    }
+    return;
+  }
+  UsdThreadPool::parallelForChunks(static_cast<uint32_t>(numLayers), 1, [&fn](uint32_t first, uint32_t count) {
+    for (uint32_t i = first; i < first + count; i++) {
+      fn(i);
+    }
+  });
+}
+
 void GameExporter::exportMaterials(const Export& exportData, ExportContext& ctx) {
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportMaterials] Begin");
   const std::string matDirPath = exportData.baseExportPath + "/" + commonDirName::matDir;
-  const std::string fullMaterialBasePath = computeLocalPath(matDirPath);
   
   dxvk::env::createDirectory(matDirPath);
-  for(const auto& [matId, matData] : exportData.materials) {
-    // Build material stage
-    const std::string matName = prefix::mat + matData.matName;
-    const std::string matStageName = matName + ctx.extension;
-    const std::string matStagePath = matDirPath + matStageName;
-    pxr::UsdStageRefPtr matStage = findOpenOrCreateStage(matStagePath, true);
-    assert(matStage);
-    setCommonStageMetaData(matStage, exportData);
-
-    // Add Looks + RootPrim prims
-    const auto looksSdfPath = gStageRootPath.AppendChild(gTokLooks);
-    const auto looksScopePrim = matStage->DefinePrim(looksSdfPath, gTokScope);
-    assert(looksScopePrim);
-    matStage->SetDefaultPrim(looksScopePrim);
-
-    // Create material prim
-    const auto matSdfPath = looksSdfPath.AppendElementString(matName);
-    const auto matSchema = pxr::UsdShadeMaterial::Define(matStage, matSdfPath);
-    assert(matSchema);
-    const auto matPrim = matSchema.GetPrim();
-    assert(matPrim);
-
-    // Create shader prim under material prim
-    static const pxr::TfToken kTokShader("Shader");
-    const auto shaderPath = matPrim.GetPath().AppendChild(kTokShader);
-    const auto shader = pxr::UsdShadeShader::Define(matStage, shaderPath);
-    const auto shaderPrim = shader.GetPrim();
-    assert(shaderPrim);
-
-    std::unordered_map<ShaderAttr::Enum, pxr::UsdAttribute> shaderAttrs;
-    for(const auto& [attrEnum, desc] : ShaderAttr::attrDescs) {
-      shaderAttrs[attrEnum] =
-        shaderPrim.CreateAttribute(desc.attrName, desc.typeName, desc.custom, desc.sdfVariability);
-      // Cannot assert. Attr "outputs:out" asserts false, but authoring + Setting works just fine.
-      // assert(shaderAttrs[attrEnum]); 
-    }
-
-    // Create and connect material outputs to shader outputs
-    static const pxr::TfToken kTokOutputsMdlSurface("outputs:mdl:surface");
-    const auto outputsMdlSurfaceAttr =
-      matPrim.CreateAttribute(kTokOutputsMdlSurface, pxr::SdfValueTypeNames->Token, false, pxr::SdfVariabilityVarying);
-    outputsMdlSurfaceAttr.AddConnection(shaderAttrs[ShaderAttr::OutputsOut].GetPath(), pxr::UsdListPositionFrontOfAppendList);
 
-    // Set shader "Kind"
-    static const pxr::TfToken kTokMaterial("Material");
-    pxr::UsdModelAPI(shader).SetKind(kTokMaterial);
+  // Material layers are independent of each other, author them concurrently...
+  const auto materials = collectEntries(exportData.materials);
+  std::vector<Reference> matReferences(materials.size());
+  forEachLayer(exportData, materials.size(), [&](size_t i) {
+    matReferences[i] = exportMaterialStage(exportData, *materials[i].second, matDirPath, ctx.extension);
+  });
 
-    // Create and set textures asset paths on material
-    const auto relToMaterialsTexPath =
-      std::filesystem::relative(computeLocalPath(matData.albedoTexPath), fullMaterialBasePath).string();
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::DiffuseTex].Set(pxr::SdfAssetPath(relToMaterialsTexPath)));
-    shaderAttrs[ShaderAttr::DiffuseTex].SetColorSpace(pxr::TfToken("auto"));
-
-    // Create and set OmniPBR MDL boilerplate attributes on shader
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::ImplSrc].Set(pxr::TfToken("sourceAsset")));
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::MdlSrcAsset].Set(pxr::SdfAssetPath("./AperturePBR_Opacity.mdl")));
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::MdlSrcAssetSubId].Set(pxr::TfToken("AperturePBR_Opacity")));
-
-    // Mark whether to enable varying opacity
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::Opacity].Set(matData.enableOpacity));
-
-    // Sampler State
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::FilterMode].Set((uint32_t)lss::Mdl::Filter::vkToMdl(matData.sampler.filter)));
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::WrapModeU].Set((uint32_t)lss::Mdl::WrapMode::vkToMdl(matData.sampler.addrModeU)));
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::WrapModeV].Set((uint32_t)lss::Mdl::WrapMode::vkToMdl(matData.sampler.addrModeV)));
-
-    matStage->Save();
-    
-    // Cache material reference
-    Reference matLssReference;
-    matLssReference.stagePath = matStagePath;
-    matLssReference.ogSdfPath = matSdfPath;
+  // ...then stitch them into the instance stage
+  for (size_t i = 0; i < materials.size(); i++) {
+    const auto& [matId, pMatData] = materials[i];
+    Reference& matLssReference = matReferences[i];
 
     // Build matSchema prim on instance stage
     if(ctx.instanceStage != nullptr) {
+      const std::string matName = prefix::mat + pMatData->matName;
       const auto matInstanceSdfPath = gRootMaterialsPath.AppendElementString(matName);
       auto matInstanceSchema = pxr::UsdShadeMaterial::Define(ctx.instanceStage, matInstanceSdfPath);
       assert(matInstanceSchema);
       
       const std::string relMeshStagePath = commonDirName::matDir + matName + ctx.extension;
       auto matInstanceUsdReferences = matInstanceSchema.GetPrim().GetReferences();
-      matInstanceUsdReferences.AddReference(relMeshStagePath, matSdfPath);
+      matInstanceUsdReferences.AddReference(relMeshStagePath, matLssReference.ogSdfPath);
       
       matLssReference.instanceSdfPath = matInstanceSdfPath;
     }
@@ -435,71 +402,124 @@ void GameExporter::exportMaterials(const Export& exportData, ExportContext& ctx)
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportMaterials] End");
 }
 
+GameExporter::Reference GameExporter::exportMaterialStage(const Export& exportData,
+                                                          const Material& matData,
+                                                          const std::string& matDirPath,
+                                                          const std::string& extension) {
+  const std::string fullMaterialBasePath = computeLocalPath(matDirPath);
+
+  // Build material stage
+  const std::string matName = prefix::mat + matData.matName;
+  const std::string matStageName = matName + extension;
+  const std::string matStagePath = matDirPath + matStageName;
+  pxr::UsdStageRefPtr matStage = findOpenOrCreateStage(matStagePath, true);
+  assert(matStage);
+  setCommonStageMetaData(matStage, exportData);
+
+  // Add Looks + RootPrim prims
+  const auto looksSdfPath = gStageRootPath.AppendChild(gTokLooks);
+  const auto looksScopePrim = matStage->DefinePrim(looksSdfPath, gTokScope);
+  assert(looksScopePrim);
+  matStage->SetDefaultPrim(looksScopePrim);
+
+  // Create material prim
+  const auto matSdfPath = looksSdfPath.AppendElementString(matName);
+  const auto matSchema = pxr::UsdShadeMaterial::Define(matStage, matSdfPath);
+  assert(matSchema);
+  const auto matPrim = matSchema.GetPrim();
+  assert(matPrim);
+
+  // Create shader prim under material prim
+  static const pxr::TfToken kTokShader("Shader");
+  const auto shaderPath = matPrim.GetPath().AppendChild(kTokShader);
+  const auto shader = pxr::UsdShadeShader::Define(matStage, shaderPath);
+  const auto shaderPrim = shader.GetPrim();
+  assert(shaderPrim);
+
+  std::unordered_map<ShaderAttr::Enum, pxr::UsdAttribute> shaderAttrs;
+  for(const auto& [attrEnum, desc] : ShaderAttr::attrDescs) {
+    shaderAttrs[attrEnum] =
+      shaderPrim.CreateAttribute(desc.attrName, desc.typeName, desc.custom, desc.sdfVariability);
+    // Cannot assert. Attr "outputs:out" asserts false, but authoring + Setting works just fine.
+    // assert(shaderAttrs[attrEnum]); 
+  }
+
+  // Create and connect material outputs to shader outputs
+  static const pxr::TfToken kTokOutputsMdlSurface("outputs:mdl:surface");
+  const auto outputsMdlSurfaceAttr =
+    matPrim.CreateAttribute(kTokOutputsMdlSurface, pxr::SdfValueTypeNames->Token, false, pxr::SdfVariabilityVarying);
+  outputsMdlSurfaceAttr.AddConnection(shaderAttrs[ShaderAttr::OutputsOut].GetPath(), pxr::UsdListPositionFrontOfAppendList);
+
+  // Set shader "Kind"
+  static const pxr::TfToken kTokMaterial("Material");
+  pxr::UsdModelAPI(shader).SetKind(kTokMaterial);
+
+  // Create and set textures asset paths on material
+  const auto relToMaterialsTexPath =
+    std::filesystem::relative(computeLocalPath(matData.albedoTexPath), fullMaterialBasePath).string();
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::DiffuseTex].Set(pxr::SdfAssetPath(relToMaterialsTexPath)));
+  shaderAttrs[ShaderAttr::DiffuseTex].SetColorSpace(pxr::TfToken("auto"));
+
+  // Create and set OmniPBR MDL boilerplate attributes on shader
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::ImplSrc].Set(pxr::TfToken("sourceAsset")));
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::MdlSrcAsset].Set(pxr::SdfAssetPath("./AperturePBR_Opacity.mdl")));
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::MdlSrcAssetSubId].Set(pxr::TfToken("AperturePBR_Opacity")));
+
+  // Mark whether to enable varying opacity
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::Opacity].Set(matData.enableOpacity));
+
+  // Sampler State
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::FilterMode].Set((uint32_t)lss::Mdl::Filter::vkToMdl(matData.sampler.filter)));
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::WrapModeU].Set((uint32_t)lss::Mdl::WrapMode::vkToMdl(matData.sampler.addrModeU)));
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::WrapModeV].Set((uint32_t)lss::Mdl::WrapMode::vkToMdl(matData.sampler.addrModeV)));
+
+  matStage->Save();
+
+  // Cache material reference
+  Reference matLssReference;
+  matLssReference.stagePath = matStagePath;
+  matLssReference.ogSdfPath = matSdfPath;
+  return matLssReference;
+}
+
+const MeshBuffers& GameExporter::getMeshBuffers(const Export& exportData, const Mesh& mesh, MeshBuffers& storage) {
+  if (!mesh.loadBuffers) {
+    return mesh.buffers;
+  }
+  if (!mesh.loadBuffers(storage)) {
+    dxvk::Logger::err("[GameExporter][" + exportData.debugId + "] Failed to load the buffers of mesh " + mesh.meshName + ", its geometry will be missing");
+    storage = MeshBuffers();
+  }
+  return storage;
+}
+
 void GameExporter::exportSkeletons(const Export& exportData, ExportContext& ctx) {
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportSkeletons] Begin");
-  static const pxr::GfMatrix4d identity(1);
   const std::string relDirPath = commonDirName::skeletonDir + "/";
   const std::string dirPath = exportData.baseExportPath + "/" + relDirPath;
-  const std::string fullStagePath = computeLocalPath(dirPath);
   dxvk::env::createDirectory(dirPath);
-  for (const auto& [meshId, mesh] : exportData.meshes) {
-    if (mesh.numBones == 0) {
-      continue;
-    }
-
-    // Build skeleton stage
-    const std::string name = prefix::skeleton + mesh.meshName;
-    const std::string stagePath = dirPath + name + ctx.extension;
-    pxr::UsdStageRefPtr stage = findOpenOrCreateStage(stagePath, true);
-    assert(stage);
-    setCommonStageMetaData(stage, exportData);
 
-    pxr::VtDictionary customLayerData = stage->GetRootLayer()->GetCustomLayerData();
-    for (auto& component : mesh.componentHashes) {
-      customLayerData.SetValueAtPath(component.first, pxr::VtValue(component.second));
+  std::vector<std::pair<Id, const Mesh*>> skinnedMeshes;
+  for (const auto& [meshId, mesh] : exportData.meshes) {
+    if (mesh.numBones > 0) {
+      skinnedMeshes.emplace_back(meshId, &mesh);
     }
-    stage->GetRootLayer()->SetCustomLayerData(customLayerData);
-
-    // Build skel root prim on stage
-    const auto defaultPrimPath = gStageRootPath.AppendElementString(name);
-    pxr::UsdSkelRoot skelRootSchema = pxr::UsdSkelRoot::Define(stage, defaultPrimPath);
-
-    assert(skelRootSchema);
-    stage->SetDefaultPrim(skelRootSchema.GetPrim());
-
-    // Build skeleton prim under above xform
-    const auto skeletonSdfPath = defaultPrimPath.AppendChild(gTokSkel);
-    auto skelSchema = pxr::UsdSkelSkeleton::Define(stage, skeletonSdfPath);
-    assert(skelSchema);
-
-
-    // Set bindTransforms attribute
-    auto bindTransformsAttr = skelSchema.CreateBindTransformsAttr();
-    assert(bindTransformsAttr);
-    ctx.skeletons[meshId] = generateSkeleton(mesh.numBones,
-                                             mesh.bonesPerVertex,
-                                             mesh.buffers.positionBufs.begin()->second,
-                                             mesh.buffers.blendWeightBufs.empty() ? nullptr : &mesh.buffers.blendWeightBufs.begin()->second,
-                                             mesh.buffers.blendIndicesBufs.empty() ? nullptr : &mesh.buffers.blendIndicesBufs.begin()->second);
-    const Skeleton& skel = ctx.skeletons[meshId];
-    // pxr::VtMatrix4dArray identities(mesh.numBones, pxr::GfMatrix4d(1));
-    bindTransformsAttr.Set(skel.bindPose);
-
-    // Set restTransforms attribute
-    auto restTransformsAttr = skelSchema.CreateRestTransformsAttr();
-    assert(restTransformsAttr);
-    restTransformsAttr.Set(skel.restPose);
+  }
 
-    // Set joints attribute on both the skeleton and the pose
-    auto jointsAttr = skelSchema.CreateJointsAttr();
-    assert(jointsAttr);
-    jointsAttr.Set(skel.jointNames);
+  std::vector<Skeleton> skeletons(skinnedMeshes.size());
+  forEachLayer(exportData, skinnedMeshes.size(), [&](size_t i) {
+    exportSkeletonStage(exportData, *skinnedMeshes[i].second, dirPath, ctx.extension, skeletons[i]);
+  });
 
-    stage->Save();
+  for (size_t i = 0; i < skinnedMeshes.size(); i++) {
+    const auto& [meshId, pMesh] = skinnedMeshes[i];
+    ctx.skeletons[meshId] = std::move(skeletons[i]);
 
     // Build meshSchema prim on instance stage
     if (ctx.instanceStage != nullptr) {
-      const std::string mesh_name = prefix::mesh + mesh.meshName;
+      const std::string name = prefix::skeleton + pMesh->meshName;
+      const auto skeletonSdfPath = gStageRootPath.AppendElementString(name).AppendChild(gTokSkel);
+      const std::string mesh_name = prefix::mesh + pMesh->meshName;
       const std::string relSkelStagePath = relDirPath + name + ctx.extension;
       const pxr::SdfPath skelInstancePath = gRootMeshesPath.AppendElementString(mesh_name).AppendElementString(gTokSkel);
 
@@ -511,193 +531,90 @@ void GameExporter::exportSkeletons(const Export& exportData, ExportContext& ctx)
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportSkeletons] End");
 }
 
-void GameExporter::exportMeshes(const Export& exportData, ExportContext& ctx) {
-  dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportMeshes] Begin");
-  static const pxr::GfMatrix4d identity(1);
-  const std::string relMeshDirPath = commonDirName::meshDir + "/";
-  const std::string meshDirPath = exportData.baseExportPath + "/" + relMeshDirPath;
-  const std::string fullMeshStagePath = computeLocalPath(meshDirPath);
-  dxvk::env::createDirectory(meshDirPath);
-  // Determine whether meshes need to be inverted
-  const bool bInvX = (!exportData.camera.view.bInv) && (exportData.camera.proj.bInv || exportData.camera.isLHS());
-  const bool bInvY = (!exportData.camera.view.bInv) && exportData.camera.proj.bInv;
-  for(const auto& [meshId,mesh] : exportData.meshes) {
-    assert(mesh.numVertices > 0);
-    assert(mesh.numIndices > 0);
-
-    const bool isSkeleton = mesh.numBones > 0;
-
-    // Build mesh stage
-    const std::string meshName = prefix::mesh + mesh.meshName;
-    const std::string meshStagePath = meshDirPath + meshName + ctx.extension;
-    pxr::UsdStageRefPtr meshStage = findOpenOrCreateStage(meshStagePath, true);
-    assert(meshStage);
-    setCommonStageMetaData(meshStage, exportData);
-
-    pxr::VtDictionary customLayerData = meshStage->GetRootLayer()->GetCustomLayerData();
-    for (auto& component : mesh.componentHashes) {
-      customLayerData.SetValueAtPath(component.first, pxr::VtValue(component.second));
-    }
-    meshStage->GetRootLayer()->SetCustomLayerData(customLayerData);
-
-    pxr::SdfPath meshXformSdfPath;
-    const bool visualCorrectionReqd = exportData.meta.bCorrectBakedTransforms || bInvX || bInvY;
-    if (visualCorrectionReqd) {
-      const auto correctionXformSdfPath = gStageRootPath.AppendElementString("visual_correction");
-      auto correctionXformSchema = pxr::UsdGeomXform::Define(meshStage, correctionXformSdfPath);
-      auto correctionXformOp = correctionXformSchema.AddTransformOp();
-      assert(correctionXformOp);
-      pxr::GfMatrix4d xform { 1.0 };
-      const pxr::GfVec3d scale{ (bInvX) ? -1.0 : 1.0,
-                                (bInvY) ? -1.0 : 1.0, 1.0};
-      xform.SetScale(scale);
-      const pxr::GfVec3d dOrigin{
-        (bInvX) ? -mesh.origin[0] : mesh.origin[0],
-        (bInvY) ? -mesh.origin[1] : mesh.origin[1],
-        mesh.origin[2]};
-      xform.SetTranslateOnly(-dOrigin);
-      correctionXformOp.Set(xform);
-      meshXformSdfPath = correctionXformSdfPath.AppendElementString(meshName);
-    } else {
-      meshXformSdfPath = gStageRootPath.AppendElementString(meshName);
-    }
+void GameExporter::exportSkeletonStage(const Export& exportData,
+                                       const Mesh& mesh,
+                                       const std::string& dirPath,
+                                       const std::string& extension,
+                                       Skeleton& skel) {
+  // Build skeleton stage
+  const std::string name = prefix::skeleton + mesh.meshName;
+  const std::string stagePath = dirPath + name + extension;
+  pxr::UsdStageRefPtr stage = findOpenOrCreateStage(stagePath, true);
+  assert(stage);
+  setCommonStageMetaData(stage, exportData);
 
-    // Build mesh xform prim on mesh stage, make it visible
-    pxr::UsdGeomXformable meshXformSchema;
-    if (isSkeleton) {
-      meshXformSchema = pxr::UsdSkelRoot::Define(meshStage, meshXformSdfPath);
-    } else {
-      meshXformSchema = pxr::UsdGeomXform::Define(meshStage, meshXformSdfPath);
-    }
-    assert(meshXformSchema);
-    meshStage->SetDefaultPrim(meshXformSchema.GetPrim());
-    auto meshXformVisibilityAttr = meshXformSchema.CreateVisibilityAttr();
-    assert(meshXformVisibilityAttr);
-    meshXformVisibilityAttr.Set(gVisibilityInherited);
-
-    // Build mesh geometry prim under above xform
-    const auto meshSchemaSdfPath = meshXformSdfPath.AppendChild(gTokMesh);
-    pxr::UsdGeomMesh meshSchema = pxr::UsdGeomMesh::Define(meshStage, meshSchemaSdfPath);
-    pxr::UsdGeomPrimvarsAPI primvarsAPI(meshSchema.GetPrim());
-
-    assert(meshSchema);
-    auto meshVisibilityAttr = meshSchema.CreateVisibilityAttr();
-    assert(meshVisibilityAttr);
-    meshVisibilityAttr.Set(gVisibilityInherited);
-
-    auto meshXformOp = meshSchema.AddTransformOp();
-    assert(meshXformOp);
-    pxr::GfMatrix4d xform { 1.0 };
-    xform = mesh.isLhs ? dxvk::swapBasis(xform) : xform;
-    meshXformOp.Set(xform);
-
-    // Set double-sidedness attribute
-    auto doubleSidedAttr = meshSchema.CreateDoubleSidedAttr();
-    assert(doubleSidedAttr);
-    doubleSidedAttr.Set(mesh.isDoubleSided);
-
-    // Set orientation attribute
-    auto orientationAttr = meshSchema.CreateOrientationAttr();
-    assert(orientationAttr);
-    orientationAttr.Set(pxr::VtValue(pxr::UsdGeomTokens->rightHanded));
-
-    // Create corresponding attribute arrays using above populated VtArrays
-    pxr::VtArray<int> faceVertexCounts;
-    faceVertexCounts.assign(mesh.numIndices / 3, 3);
-    auto faceVertexCountsAttr = meshSchema.CreateFaceVertexCountsAttr();
-    assert(faceVertexCountsAttr);
-    faceVertexCountsAttr.Set(faceVertexCounts);
-
-    for (auto& pair : mesh.categoryFlags) {
-      const auto attribute = meshSchema.GetPrim().CreateAttribute(pxr::TfToken(pair.first), pxr::SdfValueTypeNames->Bool, true, pxr::SdfVariabilityUniform);
-      attribute.Set(pxr::VtValue(pair.second));
+  pxr::VtDictionary customLayerData = stage->GetRootLayer()->GetCustomLayerData();
+  for (auto& component : mesh.componentHashes) {
+    customLayerData.SetValueAtPath(component.first, pxr::VtValue(component.second));
+  }
+  stage->GetRootLayer()->SetCustomLayerData(customLayerData);
+
+  // Build skel root prim on stage
+  const auto defaultPrimPath = gStageRootPath.AppendElementString(name);
+  pxr::UsdSkelRoot skelRootSchema = pxr::UsdSkelRoot::Define(stage, defaultPrimPath);
+
+  assert(skelRootSchema);
+  stage->SetDefaultPrim(skelRootSchema.GetPrim());
+
+  // Build skeleton prim under above xform
+  const auto skeletonSdfPath = defaultPrimPath.AppendChild(gTokSkel);
+  auto skelSchema = pxr::UsdSkelSkeleton::Define(stage, skeletonSdfPath);
+  assert(skelSchema);
+
+
+  // Set bindTransforms attribute
+  auto bindTransformsAttr = skelSchema.CreateBindTransformsAttr();
+  assert(bindTransformsAttr);
+  {
+    MeshBuffers loadedBuffers;
+    const MeshBuffers& buffers = getMeshBuffers(exportData, mesh, loadedBuffers);
+    if (!buffers.positionBufs.empty()) {
+      skel = generateSkeleton(mesh.numBones,
+                              mesh.bonesPerVertex,
+                              buffers.positionBufs.begin()->second,
+                              buffers.blendWeightBufs.empty() ? nullptr : &buffers.blendWeightBufs.begin()->second,
+                              buffers.blendIndicesBufs.empty() ? nullptr : &buffers.blendIndicesBufs.begin()->second);
     }
+  }
+  // pxr::VtMatrix4dArray identities(mesh.numBones, pxr::GfMatrix4d(1));
+  bindTransformsAttr.Set(skel.bindPose);
 
-    // Indices
-    const bool reduce = exportData.meta.bReduceMeshBuffers;
-    ReducedIdxBufSet reducedIdxBufSet = reduce ? reduceIdxBufferSet(mesh.buffers.idxBufs) : ReducedIdxBufSet();
-    const BufSet<Index>& idxBufSet = reduce ? reducedIdxBufSet.bufSet : mesh.buffers.idxBufs;
-    auto indexAttr = meshSchema.CreateFaceVertexIndicesAttr();
-    assert(indexAttr);
-    exportBufferSet(idxBufSet, indexAttr);
-    // Vertices
-    const auto& posBufs = mesh.buffers.positionBufs;
-    auto pointsAttr = meshSchema.CreatePointsAttr();
-    assert(pointsAttr);
-    exportBufferSet(reduce ? reduceBufferSet(posBufs, reducedIdxBufSet) : posBufs, pointsAttr);
-    // Normals
-    auto normalsAttr = meshSchema.CreateNormalsAttr();
-    assert(normalsAttr);
-    exportBufferSet(reduce ? reduceBufferSet(mesh.buffers.normalBufs, reducedIdxBufSet) : mesh.buffers.normalBufs, normalsAttr);
-    // Set subdivision scheme to None (USD defaults to catmull clark)
-    auto subdivAttr = meshSchema.CreateSubdivisionSchemeAttr();
-    assert(subdivAttr);
-    subdivAttr.Set(pxr::UsdGeomTokens->none);
-    // Texture Coordinates
-    static const pxr::TfToken kTokSt("st");
-    auto stAttr = primvarsAPI.CreatePrimvar(kTokSt, pxr::SdfValueTypeNames->TexCoord2fArray, pxr::UsdGeomTokens->vertex);
-    assert(stAttr);
-    exportBufferSet(reduce ? reduceBufferSet(mesh.buffers.texcoordBufs, reducedIdxBufSet) : mesh.buffers.texcoordBufs, stAttr);
-
-    // Vertex Colors
-    if (mesh.buffers.colorBufs.size() > 0) {
-      auto displayColorPrimvar = meshSchema.CreateDisplayColorPrimvar(pxr::UsdGeomTokens->vertex);
-      auto displayOpacityPrimvar = meshSchema.CreateDisplayOpacityPrimvar(pxr::UsdGeomTokens->vertex);
-      assert(displayColorPrimvar);
-      assert(displayOpacityPrimvar);
-      if (mesh.buffers.colorBufs.cbegin()->second.size() == 1) {
-        // Constant Color
-        displayColorPrimvar.SetInterpolation(pxr::UsdGeomTokens->constant);
-        displayOpacityPrimvar.SetInterpolation(pxr::UsdGeomTokens->constant);
-      }
-      exportColorOpacityBufferSet(reduce ? reduceBufferSet(mesh.buffers.colorBufs, reducedIdxBufSet) : mesh.buffers.colorBufs, displayColorPrimvar, displayOpacityPrimvar);
-    }
-    
-    if (isSkeleton) {
-      pxr::UsdSkelBindingAPI skelBind = pxr::UsdSkelBindingAPI::Apply(meshSchema.GetPrim());
+  // Set restTransforms attribute
+  auto restTransformsAttr = skelSchema.CreateRestTransformsAttr();
+  assert(restTransformsAttr);
+  restTransformsAttr.Set(skel.restPose);
 
-      auto jointWeightsAttr = skelBind.CreateJointWeightsPrimvar(0, mesh.bonesPerVertex);
-      assert(jointWeightsAttr);
-      exportBufferSet(reduce ? reduceBufferSet(mesh.buffers.blendWeightBufs, reducedIdxBufSet, mesh.bonesPerVertex) : mesh.buffers.blendWeightBufs, jointWeightsAttr);
+  // Set joints attribute on both the skeleton and the pose
+  auto jointsAttr = skelSchema.CreateJointsAttr();
+  assert(jointsAttr);
+  jointsAttr.Set(skel.jointNames);
 
-      auto jointIndicesAttr = skelBind.CreateJointIndicesPrimvar(0, mesh.bonesPerVertex);
-      assert(jointIndicesAttr);
-      if (mesh.buffers.blendIndicesBufs.size() > 0) {
-        exportBufferSet(reduce ? reduceBufferSet(mesh.buffers.blendIndicesBufs, reducedIdxBufSet, mesh.bonesPerVertex) : mesh.buffers.blendIndicesBufs, jointIndicesAttr);
-      } else {
-        // D3D9 allows for default bone indices of "0, 1, ... bonesPerVertex" if no joint indices are set.
-        pxr::VtArray<int> defaultIndices(mesh.bonesPerVertex * mesh.numVertices);
-        for (int i = 0; i < mesh.numVertices; ++i) {
-          for (int j = 0; j < mesh.bonesPerVertex; ++j) {
-            defaultIndices[i * mesh.bonesPerVertex + j] = j;
-          }
-        }
-        jointIndicesAttr.Set(defaultIndices);
-      }
+  stage->Save();
+}
 
-      auto skelRel = skelBind.CreateSkeletonRel();
-      skelRel.AddTarget(meshXformSdfPath.AppendChild(gTokSkel));
-    }
+void GameExporter::exportMeshes(const Export& exportData, ExportContext& ctx) {
+  dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportMeshes] Begin");
+  const std::string relMeshDirPath = commonDirName::meshDir + "/";
+  const std::string meshDirPath = exportData.baseExportPath + "/" + relMeshDirPath;
+  dxvk::env::createDirectory(meshDirPath);
 
+  // Mesh layers only reference the (already saved) material layers, so they can be authored concurrently...
+  const auto meshes = collectEntries(exportData.meshes);
+  std::vector<Reference> meshReferences(meshes.size());
+  forEachLayer(exportData, meshes.size(), [&](size_t i) {
+    meshReferences[i] = exportMeshStage(exportData, *meshes[i].second, ctx.matReferences, meshDirPath, ctx.extension);
+  });
+
+  // ...then stitch them into the instance stage
+  for (size_t i = 0; i < meshes.size(); i++) {
+    const auto& [meshId, pMesh] = meshes[i];
+    const Mesh& mesh = *pMesh;
+    const bool isSkeleton = mesh.numBones > 0;
     const bool bHasMat = mesh.matId != kInvalidId;
-    const Reference& matLssReference = (bHasMat) ? ctx.matReferences[mesh.matId] : Reference();
-    if(bHasMat) {
-      const auto shaderMatSchema = pxr::UsdShadeMaterial::Define(meshStage, matLssReference.ogSdfPath);
-      assert(shaderMatSchema);
-      auto shaderMatUsdReferences = shaderMatSchema.GetPrim().GetReferences();
-      const std::string fullMatStagePath = computeLocalPath(matLssReference.stagePath);
-      const std::string relMatRefStagePath = std::filesystem::relative(fullMatStagePath,fullMeshStagePath).string();
-      shaderMatUsdReferences.AddReference(relMatRefStagePath, matLssReference.ogSdfPath);
-      pxr::UsdShadeMaterialBindingAPI(meshXformSchema.GetPrim()).Bind(shaderMatSchema);
-    }
+    const std::string meshName = prefix::mesh + mesh.meshName;
+    Reference& meshLssReference = meshReferences[i];
+    const pxr::SdfPath meshXformSdfPath = meshLssReference.ogSdfPath;
 
-    meshStage->Save();
-    
-    // Cache material reference
-    Reference meshLssReference;
-    meshLssReference.stagePath = meshStagePath;
-    meshLssReference.ogSdfPath = meshXformSdfPath;
-    
     // Build meshSchema prim on instance stage
     if(ctx.instanceStage != nullptr) {
       const auto meshInstanceXformSdfPath = gRootMeshesPath.AppendElementString(meshName);
@@ -718,6 +635,7 @@ void GameExporter::exportMeshes(const Export& exportData, ExportContext& ctx) {
       meshInstanceXformVisibilityAttr.Set(gVisibilityInvisible);
       
       if(bHasMat) {
+        const Reference& matLssReference = ctx.matReferences[mesh.matId];
         const auto shaderMatInstanceSchema = pxr::UsdShadeMaterial::Get(ctx.instanceStage, matLssReference.instanceSdfPath);
         assert(shaderMatInstanceSchema);
         pxr::UsdShadeMaterialBindingAPI(meshInstanceXformSchema.GetPrim()).Bind(shaderMatInstanceSchema);
@@ -731,6 +649,200 @@ void GameExporter::exportMeshes(const Export& exportData, ExportContext& ctx) {
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportMeshes] End");
 }
 
+GameExporter::Reference GameExporter::exportMeshStage(const Export& exportData,
+                                                      const Mesh& mesh,
+                                                      const IdMap<Reference>& matReferences,
+                                                      const std::string& meshDirPath,
+                                                      const std::string& extension) {
+  static const pxr::GfMatrix4d identity(1);
+  const std::string fullMeshStagePath = computeLocalPath(meshDirPath);
+  // Determine whether meshes need to be inverted
+  const bool bInvX = (!exportData.camera.view.bInv) && (exportData.camera.proj.bInv || exportData.camera.isLHS());
+  const bool bInvY = (!exportData.camera.view.bInv) && exportData.camera.proj.bInv;
+
+  assert(mesh.numVertices > 0);
+  assert(mesh.numIndices > 0);
+
+  const bool isSkeleton = mesh.numBones > 0;
+
+  // Build mesh stage
+  const std::string meshName = prefix::mesh + mesh.meshName;
+  const std::string meshStagePath = meshDirPath + meshName + extension;
+  pxr::UsdStageRefPtr meshStage = findOpenOrCreateStage(meshStagePath, true);
+  assert(meshStage);
+  setCommonStageMetaData(meshStage, exportData);
+
+  pxr::VtDictionary customLayerData = meshStage->GetRootLayer()->GetCustomLayerData();
+  for (auto& component : mesh.componentHashes) {
+    customLayerData.SetValueAtPath(component.first, pxr::VtValue(component.second));
+  }
+  meshStage->GetRootLayer()->SetCustomLayerData(customLayerData);
+
+  pxr::SdfPath meshXformSdfPath;
+  const bool visualCorrectionReqd = exportData.meta.bCorrectBakedTransforms || bInvX || bInvY;
+  if (visualCorrectionReqd) {
+    const auto correctionXformSdfPath = gStageRootPath.AppendElementString("visual_correction");
+    auto correctionXformSchema = pxr::UsdGeomXform::Define(meshStage, correctionXformSdfPath);
+    auto correctionXformOp = correctionXformSchema.AddTransformOp();
+    assert(correctionXformOp);
+    pxr::GfMatrix4d xform { 1.0 };
+    const pxr::GfVec3d scale{ (bInvX) ? -1.0 : 1.0,
+                              (bInvY) ? -1.0 : 1.0, 1.0};
+    xform.SetScale(scale);
+    const pxr::GfVec3d dOrigin{
+      (bInvX) ? -mesh.origin[0] : mesh.origin[0],
+      (bInvY) ? -mesh.origin[1] : mesh.origin[1],
+      mesh.origin[2]};
+    xform.SetTranslateOnly(-dOrigin);
+    correctionXformOp.Set(xform);
+    meshXformSdfPath = correctionXformSdfPath.AppendElementString(meshName);
+  } else {
+    meshXformSdfPath = gStageRootPath.AppendElementString(meshName);
+  }
+
+  // Build mesh xform prim on mesh stage, make it visible
+  pxr::UsdGeomXformable meshXformSchema;
+  if (isSkeleton) {
+    meshXformSchema = pxr::UsdSkelRoot::Define(meshStage, meshXformSdfPath);
+  } else {
+    meshXformSchema = pxr::UsdGeomXform::Define(meshStage, meshXformSdfPath);
+  }
+  assert(meshXformSchema);
+  meshStage->SetDefaultPrim(meshXformSchema.GetPrim());
+  auto meshXformVisibilityAttr = meshXformSchema.CreateVisibilityAttr();
+  assert(meshXformVisibilityAttr);
+  meshXformVisibilityAttr.Set(gVisibilityInherited);
+
+  // Build mesh geometry prim under above xform
+  const auto meshSchemaSdfPath = meshXformSdfPath.AppendChild(gTokMesh);
+  pxr::UsdGeomMesh meshSchema = pxr::UsdGeomMesh::Define(meshStage, meshSchemaSdfPath);
+  pxr::UsdGeomPrimvarsAPI primvarsAPI(meshSchema.GetPrim());
+
+  assert(meshSchema);
+  auto meshVisibilityAttr = meshSchema.CreateVisibilityAttr();
+  assert(meshVisibilityAttr);
+  meshVisibilityAttr.Set(gVisibilityInherited);
+
+  auto meshXformOp = meshSchema.AddTransformOp();
+  assert(meshXformOp);
+  pxr::GfMatrix4d xform { 1.0 };
+  xform = mesh.isLhs ? dxvk::swapBasis(xform) : xform;
+  meshXformOp.Set(xform);
+
+  // Set double-sidedness attribute
+  auto doubleSidedAttr = meshSchema.CreateDoubleSidedAttr();
+  assert(doubleSidedAttr);
+  doubleSidedAttr.Set(mesh.isDoubleSided);
+
+  // Set orientation attribute
+  auto orientationAttr = meshSchema.CreateOrientationAttr();
+  assert(orientationAttr);
+  orientationAttr.Set(pxr::VtValue(pxr::UsdGeomTokens->rightHanded));
+
+  // Create corresponding attribute arrays using above populated VtArrays
+  pxr::VtArray<int> faceVertexCounts;
+  faceVertexCounts.assign(mesh.numIndices / 3, 3);
+  auto faceVertexCountsAttr = meshSchema.CreateFaceVertexCountsAttr();
+  assert(faceVertexCountsAttr);
+  faceVertexCountsAttr.Set(faceVertexCounts);
+
+  for (auto& pair : mesh.categoryFlags) {
+    const auto attribute = meshSchema.GetPrim().CreateAttribute(pxr::TfToken(pair.first), pxr::SdfValueTypeNames->Bool, true, pxr::SdfVariabilityUniform);
+    attribute.Set(pxr::VtValue(pair.second));
+  }
+
+  // Buffers that aren't held by the mesh are only loaded for as long as this layer is authored
+  MeshBuffers loadedBuffers;
+  const MeshBuffers& buffers = getMeshBuffers(exportData, mesh, loadedBuffers);
+
+  // Indices
+  const bool reduce = exportData.meta.bReduceMeshBuffers;
+  ReducedIdxBufSet reducedIdxBufSet = reduce ? reduceIdxBufferSet(buffers.idxBufs) : ReducedIdxBufSet();
+  const BufSet<Index>& idxBufSet = reduce ? reducedIdxBufSet.bufSet : buffers.idxBufs;
+  auto indexAttr = meshSchema.CreateFaceVertexIndicesAttr();
+  assert(indexAttr);
+  exportBufferSet(idxBufSet, indexAttr);
+  // Vertices
+  const auto& posBufs = buffers.positionBufs;
+  auto pointsAttr = meshSchema.CreatePointsAttr();
+  assert(pointsAttr);
+  exportBufferSet(reduce ? reduceBufferSet(posBufs, reducedIdxBufSet) : posBufs, pointsAttr);
+  // Normals
+  auto normalsAttr = meshSchema.CreateNormalsAttr();
+  assert(normalsAttr);
+  exportBufferSet(reduce ? reduceBufferSet(buffers.normalBufs, reducedIdxBufSet) : buffers.normalBufs, normalsAttr);
+  // Set subdivision scheme to None (USD defaults to catmull clark)
+  auto subdivAttr = meshSchema.CreateSubdivisionSchemeAttr();
+  assert(subdivAttr);
+  subdivAttr.Set(pxr::UsdGeomTokens->none);
+  // Texture Coordinates
+  static const pxr::TfToken kTokSt("st");
+  auto stAttr = primvarsAPI.CreatePrimvar(kTokSt, pxr::SdfValueTypeNames->TexCoord2fArray, pxr::UsdGeomTokens->vertex);
+  assert(stAttr);
+  exportBufferSet(reduce ? reduceBufferSet(buffers.texcoordBufs, reducedIdxBufSet) : buffers.texcoordBufs, stAttr);
+
+  // Vertex Colors
+  if (buffers.colorBufs.size() > 0) {
+    auto displayColorPrimvar = meshSchema.CreateDisplayColorPrimvar(pxr::UsdGeomTokens->vertex);
+    auto displayOpacityPrimvar = meshSchema.CreateDisplayOpacityPrimvar(pxr::UsdGeomTokens->vertex);
+    assert(displayColorPrimvar);
+    assert(displayOpacityPrimvar);
+    if (buffers.colorBufs.cbegin()->second.size() == 1) {
+      // Constant Color
+      displayColorPrimvar.SetInterpolation(pxr::UsdGeomTokens->constant);
+      displayOpacityPrimvar.SetInterpolation(pxr::UsdGeomTokens->constant);
+    }
+    exportColorOpacityBufferSet(reduce ? reduceBufferSet(buffers.colorBufs, reducedIdxBufSet) : buffers.colorBufs, displayColorPrimvar, displayOpacityPrimvar);
+  }
+  
+  if (isSkeleton) {
+    pxr::UsdSkelBindingAPI skelBind = pxr::UsdSkelBindingAPI::Apply(meshSchema.GetPrim());
+
+    auto jointWeightsAttr = skelBind.CreateJointWeightsPrimvar(0, mesh.bonesPerVertex);
+    assert(jointWeightsAttr);
+    exportBufferSet(reduce ? reduceBufferSet(buffers.blendWeightBufs, reducedIdxBufSet, mesh.bonesPerVertex) : buffers.blendWeightBufs, jointWeightsAttr);
+
+    auto jointIndicesAttr = skelBind.CreateJointIndicesPrimvar(0, mesh.bonesPerVertex);
+    assert(jointIndicesAttr);
+    if (buffers.blendIndicesBufs.size() > 0) {
+      exportBufferSet(reduce ? reduceBufferSet(buffers.blendIndicesBufs, reducedIdxBufSet, mesh.bonesPerVertex) : buffers.blendIndicesBufs, jointIndicesAttr);
+    } else {
+      // D3D9 allows for default bone indices of "0, 1, ... bonesPerVertex" if no joint indices are set.
+      pxr::VtArray<int> defaultIndices(mesh.bonesPerVertex * mesh.numVertices);
+      for (int i = 0; i < mesh.numVertices; ++i) {
+        for (int j = 0; j < mesh.bonesPerVertex; ++j) {
+          defaultIndices[i * mesh.bonesPerVertex + j] = j;
+        }
+      }
+      jointIndicesAttr.Set(defaultIndices);
+    }
+
+    auto skelRel = skelBind.CreateSkeletonRel();
+    skelRel.AddTarget(meshXformSdfPath.AppendChild(gTokSkel));
+  }
+
+  const bool bHasMat = mesh.matId != kInvalidId;
+  const auto matReferenceIt = bHasMat ? matReferences.find(mesh.matId) : matReferences.end();
+  const Reference matLssReference = (matReferenceIt != matReferences.end()) ? matReferenceIt->second : Reference();
+  if(bHasMat) {
+    const auto shaderMatSchema = pxr::UsdShadeMaterial::Define(meshStage, matLssReference.ogSdfPath);
+    assert(shaderMatSchema);
+    auto shaderMatUsdReferences = shaderMatSchema.GetPrim().GetReferences();
+    const std::string fullMatStagePath = computeLocalPath(matLssReference.stagePath);
+    const std::string relMatRefStagePath = std::filesystem::relative(fullMatStagePath,fullMeshStagePath).string();
+    shaderMatUsdReferences.AddReference(relMatRefStagePath, matLssReference.ogSdfPath);
+    pxr::UsdShadeMaterialBindingAPI(meshXformSchema.GetPrim()).Bind(shaderMatSchema);
+  }
+
+  meshStage->Save();
+
+  // Cache mesh reference
+  Reference meshLssReference;
+  meshLssReference.stagePath = meshStagePath;
+  meshLssReference.ogSdfPath = meshXformSdfPath;
+  return meshLssReference;
+}
+
 GameExporter::ReducedIdxBufSet GameExporter::reduceIdxBufferSet(const BufSet<Index>& idxBufSet) {
   ReducedIdxBufSet reducedIdxBufSet;
   for(const auto& [timeCode, idxBuf] : idxBufSet) {
@@ -1172,16 +1284,48 @@ void GameExporter::setTimeSampledXforms(const pxr::UsdStageRefPtr stage,
   const bool isSingleFrame = meta.numFramesCaptured == 1;
 
   auto geomXformable = pxr::UsdGeomXformable::Get(stage, sdfPath);
-  for(const auto& sampledXform : xforms) {
-    const pxr::UsdTimeCode timeCode = isSingleFrame ? pxr::UsdTimeCode::Default() : pxr::UsdTimeCode(sampledXform.time);
+  // Reuse the prim's transform op if there is one, AddTransformOp only succeeds once per prim
+  static const pxr::TfToken kTokTransformOpName = pxr::UsdGeomXformOp::GetOpName(pxr::UsdGeomXformOp::TypeTransform);
+  pxr::UsdGeomXformOp xformOp;
+  bool resetsXformStack = false;
+  for (const pxr::UsdGeomXformOp& op : geomXformable.GetOrderedXformOps(&resetsXformStack)) {
+    if (op.GetOpName() == kTokTransformOpName) {
+      xformOp = op;
+      break;
+    }
+  }
+  if (!xformOp) {
+    xformOp = geomXformable.AddTransformOp();
+  }
+  assert(xformOp);
 
+  const auto getXform = [&](const SampledXform& sampledXform) {
     auto xform = sampledXform.xform;
     xform *= commonXform;
+    return changeBasis ? dxvk::swapBasis(xform) : xform;
+  };
 
-    xform = changeBasis ? dxvk::swapBasis(xform) : xform;
+  if (isSingleFrame) {
+    for (const auto& sampledXform : xforms) {
+      xformOp.Set(getXform(sampledXform), pxr::UsdTimeCode::Default());
+    }
+    return;
+  }
+
+  // Write all time samples straight to the edit target layer in one change block, rather than notifying the
+  // stage once per sample
+  const pxr::SdfLayerHandle layer = stage->GetEditTarget().GetLayer();
+  const pxr::SdfPath attrPath = xformOp.GetAttr().GetPath();
+  if (!layer || !layer->GetAttributeAtPath(attrPath)) {
+    for (const auto& sampledXform : xforms) {
+      xformOp.Set(getXform(sampledXform), pxr::UsdTimeCode(sampledXform.time));
+    }
+    return;
+  }
 
-    auto xformOp = geomXformable.AddTransformOp();
-    xformOp.Set(xform, timeCode);
+  pxr::SdfChangeBlock changeBlock;
+  for (const auto& sampledXform : xforms) {
+    layer->SetTimeSample(attrPath, static_cast<double>(sampledXform.time), getXform(sampledXform));
   }
 }
 
@@ -32,6 +32,8 @@
 #include "game_exporter_paths.h"
 
 #include <mutex>
+#include <utility>
+#include <vector>
 
 namespace lss {
 
@@ -60,8 +62,26 @@ private:
   static pxr::UsdStageRefPtr createInstanceStage(const Export& exportData);
   static void setCommonStageMetaData(pxr::UsdStageRefPtr stage, const Export& exportData);
   static void createApertureMdls(const std::string& baseExportPath);
+  // Collects pointers to the entries of an IdMap, so they can be processed by index
+  template<typename T>
+  static std::vector<std::pair<Id, const T*>> collectEntries(const IdMap<T>& map);
+  // Calls fn(i) for every layer index, concurrently if parallel export is enabled.  Each call must only author
+  // its own layer; anything that touches the instance stage has to be done after this returns.
+  template<typename Fn>
+  static void forEachLayer(const Export& exportData, const size_t numLayers, const Fn& fn);
   static void exportMaterials(const Export& exportData, ExportContext& ctx);
+  static Reference exportMaterialStage(const Export& exportData,
+                                       const Material& matData,
+                                       const std::string& matDirPath,
+                                       const std::string& extension);
+  // Returns the buffers of the mesh, loading them into 'storage' if the mesh doesn't hold them
+  static const MeshBuffers& getMeshBuffers(const Export& exportData, const Mesh& mesh, MeshBuffers& storage);
   static void exportMeshes(const Export& exportData, ExportContext& ctx);
+  static Reference exportMeshStage(const Export& exportData,
+                                   const Mesh& mesh,
+                                   const IdMap<Reference>& matReferences,
+                                   const std::string& meshDirPath,
+                                   const std::string& extension);
   struct ReducedIdxBufSet {
     BufSet<Index> bufSet;
     // Per-timecode idx mapping
@@ -79,6 +99,11 @@ private:
                                           pxr::UsdAttribute color,
                                           pxr::UsdAttribute opacity);
   static void exportSkeletons(const Export& exportData, ExportContext& ctx);
+  static void exportSkeletonStage(const Export& exportData,
+                                  const Mesh& mesh,
+                                  const std::string& dirPath,
+                                  const std::string& extension,
+                                  Skeleton& skel);
   static void exportInstances(const Export& exportData, ExportContext& ctx);
   static void exportCamera(const Export& exportData, ExportContext& ctx);
   static void exportSphereLights(const Export& exportData, ExportContext& ctx);
@@ -32,6 +32,7 @@
 
 
 #include <stdint.h>
+#include <functional>
 #include <limits>
 #include <map>
 
@@ -183,6 +184,9 @@ struct Mesh {
   uint32_t     bonesPerVertex = 0;
   pxr::VtMatrix4dArray boneXForms;
   bool         isLhs = false;
+  // Set when the buffers are not held in memory, in which case `buffers` is empty and this fills in a copy
+  // of them for as long as the mesh's layers are being authored.  Returns false if the buffers couldn't be loaded.
+  std::function<bool(MeshBuffers&)> loadBuffers;
 };
 
 struct Instance {
@@ -215,6 +219,8 @@ struct Export {
     bool isZUp;
     std::unordered_map<std::string, std::string> renderingSettingsDict;
     bool bCorrectBakedTransforms;
+    // Author independent mesh, material and skeleton layers concurrently
+    bool bParallelExport = false;
   } meta;
   std::string baseExportPath;
   bool bExportInstanceStage;
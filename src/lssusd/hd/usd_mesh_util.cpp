@@ -25,6 +25,7 @@
 //
 
 #include "usd_mesh_util.h"
+#include "../usd_parallel.h"
 
 #include "usd_include_begin.h"
 #include <pxr/base/gf/vec3i.h>
@@ -39,6 +40,9 @@
 using namespace pxr;
 
 namespace lss {
+  // Meshes below this size are triangulated serially, where splitting up the work costs more than it saves.
+  static constexpr int kParallelTriangulationMinTriangles = 1 << 16;
+  static constexpr uint32_t kTriangulationFacesPerChunk = 1 << 14;
 
   //-------------------------------------------------------------------------
   // Triangulation
@@ -84,8 +88,16 @@ namespace lss {
     int numholeIndices = m_holeIndices.size();
     bool invalidTopology = false;
     int holeIndex = 0;
-    for (int i = 0; i < numFaces; ++i) {
+
+    // Prefix sums over the faces, so that faces can be triangulated independently of each other:
+    // faceTriOffsets[i] -> index of the first triangle of face i, or -1 for skipped faces
+    // faceVertOffsets[i] -> index to the first vertex (index) for face i, which is also the number of edges visited
+    std::vector<int> faceTriOffsets(numFaces);
+    std::vector<int> faceVertOffsets(numFaces);
+    for (int i = 0, v = 0; i < numFaces; ++i) {
       int nv = numVertsPtr[i] - 2;
+      faceVertOffsets[i] = v;
+      faceTriOffsets[i] = -1;
       if (nv < 1) {
         // skip degenerated face
         invalidTopology = true;
@@ -93,8 +105,12 @@ namespace lss {
         // skip hole face
         ++holeIndex;
       } else {
+        faceTriOffsets[i] = numTris;
         numTris += nv;
       }
+      // When the face is degenerate and nv > 0, we need to increment the v
+      // pointer to walk past the degenerate verts.
+      v += numVertsPtr[i];
     }
     if (invalidTopology) {
       invalidTopology = false;
@@ -108,21 +124,28 @@ namespace lss {
 
     const bool flip = (m_orientation != TfToken("rightHanded"));
 
-    // reset holeIndex
-    holeIndex = 0;
+    // Get writable pointers up front, VtArray's non-const accessors may detach the storage and aren't thread safe.
+    GfVec3i* indicesPtr = indices->data();
+    int* primitiveParamsPtr = primitiveParams->data();
+    int* edgeIndicesPtr = edgeIndices ? edgeIndices->data() : nullptr;
+
+    // Faces may be triangulated on several threads, so overruns are collected in an atomic.
+    std::atomic<bool> invalidFaceTopology = false;
 
     // i  -> authored face index [0, numFaces)
     // tv -> triangulated face index [0, numTris)
     // v  -> index to the first vertex (index) for face i
     // ev -> edges visited
-    for (int i = 0, tv = 0, v = 0, ev = 0; i < numFaces; ++i) {
-      int nv = numVertsPtr[i];
-      if (nv < 3) {
-        // Skip degenerate faces.
-      } else if (holeIndex < numholeIndices && holeIndicesPtr[holeIndex] == i) {
-        // Skip hole faces.
-        ++holeIndex;
-      } else {
+    auto triangulateFaces = [=, &faceTriOffsets, &faceVertOffsets, &invalidFaceTopology](uint32_t firstFace, uint32_t numFacesInRange) {
+      for (int i = firstFace, end = firstFace + numFacesInRange; i < end; ++i) {
+        int tv = faceTriOffsets[i];
+        if (tv < 0) {
+          // Skip degenerate and hole faces.
+          continue;
+        }
+        int nv = numVertsPtr[i];
+        int v = faceVertOffsets[i];
+        int ev = v;
         // edgeFlag is used for inner-line removal of non-triangle
         // faces on wireframe shading.
         //
@@ -141,8 +164,8 @@ namespace lss {
         int edgeFlag = 0;
         int edgeIndex = ev;
         for (int j = 0; j < nv - 2; ++j) {
-          if (!_FanTriangulate(&(*indices)[tv], vertsPtr, v, j, numVertIndices, flip)) {
-            invalidTopology = true;
+          if (!_FanTriangulate(&indicesPtr[tv], vertsPtr, v, j, numVertIndices, flip)) {
+            invalidFaceTopology.store(true, std::memory_order_relaxed);
           }
 
           if (nv > 3) {
@@ -152,7 +175,7 @@ namespace lss {
                 // 021 instead of 012, and we'd hide edge 0-1
                 // instead of 0-2; so we rotate the indices to
                 // produce triangle 210.
-                GfVec3i& index = (*indices)[tv];
+                GfVec3i& index = indicesPtr[tv];
                 index.Set(index[1], index[2], index[0]);
               }
               edgeFlag = 1;
@@ -162,7 +185,7 @@ namespace lss {
                 // 043 instead of 034, and we'd hide edge 0-4
                 // instead of 0-3; so we rotate the indices to
                 // produce triangle 304.
-                GfVec3i& index = (*indices)[tv];
+                GfVec3i& index = indicesPtr[tv];
                 index.Set(index[2], index[0], index[1]);
               }
               edgeFlag = 2;
@@ -172,19 +195,22 @@ namespace lss {
             ++edgeIndex;
           }
 
-          (*primitiveParams)[tv] = EncodeCoarseFaceParam(i, edgeFlag);
-          if (edgeIndices) {
-            (*edgeIndices)[tv] = edgeIndex;
+          primitiveParamsPtr[tv] = EncodeCoarseFaceParam(i, edgeFlag);
+          if (edgeIndicesPtr) {
+            edgeIndicesPtr[tv] = edgeIndex;
           }
 
           ++tv;
         }
       }
-      // When the face is degenerate and nv > 0, we need to increment the v
-      // pointer to walk past the degenerate verts.
-      v += nv;
-      ev += nv;
+    };
+
+    if (numTris >= kParallelTriangulationMinTriangles) {
+      UsdThreadPool::parallelForChunks(numFaces, kTriangulationFacesPerChunk, triangulateFaces);
+    } else {
+      triangulateFaces(0, numFaces);
     }
+    invalidTopology |= invalidFaceTopology.load();
   }
 
   // Face-varying triangulation helper function, to deal with type polymorphism.
@@ -30,6 +30,7 @@
 #include "hd/usd_mesh_util.h"
 #include "usd_mesh_samplers.h"
 #include "usd_mesh_importer.h"
+#include "usd_parallel.h"
 #include "game_exporter_common.h"
 
 #include "usd_include_begin.h"
@@ -105,7 +106,7 @@ namespace lss {
   }
 
 
-  UsdMeshImporter::UsdMeshImporter(const UsdPrim& meshPrim, const uint32_t limitedNumBonesPerVertex)
+  UsdMeshImporter::UsdMeshImporter(const UsdPrim& meshPrim, const uint32_t limitedNumBonesPerVertex, const ImportPath importPath)
     : m_meshPrim(UsdGeomMesh(meshPrim))
     , m_limitedNumBonesPerVertex(limitedNumBonesPerVertex) {
     ZoneScoped;
@@ -154,7 +155,11 @@ namespace lss {
 
     std::vector<uint32_t> indices;
     FaceToTriangleMap faceToTriangles(geomSubsets.size() > 0 ? faceCounts.size() : 0);
-    triangulate(numTriangles, m_vertexStride / sizeof(float), pMeshSamplers, trianglePrimitiveParams, indices, faceToTriangles);
+    if (importPath == ImportPath::Batched) {
+      triangulateBatched(numTriangles, m_vertexStride / sizeof(float), pMeshSamplers, trianglePrimitiveParams, indices, faceToTriangles);
+    } else {
+      triangulate(numTriangles, m_vertexStride / sizeof(float), pMeshSamplers, trianglePrimitiveParams, indices, faceToTriangles);
+    }
 
     m_numVertices = m_vertexData.size() * sizeof(float) / m_vertexStride;
 
@@ -195,6 +200,48 @@ namespace lss {
   }
 
 
+  UsdMeshImporter::UsdMeshImporter(const UsdPrim& meshPrim, CookedMesh&& cookedMesh)
+    : m_meshPrim(UsdGeomMesh(meshPrim))
+    , m_vertexData(std::move(cookedMesh.vertexData))
+    , m_vertexDecl(std::move(cookedMesh.vertexDecl))
+    , m_vertexStride(cookedMesh.vertexStride)
+    , m_numVertices(cookedMesh.numVertices)
+    , m_actualNumBonesPerVertex(cookedMesh.numBonesPerVertex)
+    , m_limitedNumBonesPerVertex(cookedMesh.numBonesPerVertex)
+    , m_doubleSided(cookedMesh.doubleSided)
+    , m_isRightHanded(cookedMesh.isRightHanded)
+    , m_boundingBox(cookedMesh.boundingBox) {
+    ZoneScoped;
+    const UsdStagePtr stage = meshPrim.GetStage();
+    m_meshes.reserve(cookedMesh.subMeshes.size());
+    for (CookedMesh::SubMesh& subMesh : cookedMesh.subMeshes) {
+      const UsdPrim subMeshPrim = stage->GetPrimAtPath(SdfPath(subMesh.primPath));
+      if (!subMeshPrim.IsValid()) {
+        throw DxvkError(str::format("Tried to restore cooked mesh, but submesh prim no longer exists, id=", subMesh.primPath));
+      }
+      m_meshes.emplace_back(std::move(subMesh.indexBuffer), subMeshPrim);
+    }
+  }
+
+
+  UsdMeshImporter::CookedMesh UsdMeshImporter::Cook() const {
+    CookedMesh cookedMesh;
+    cookedMesh.subMeshes.reserve(m_meshes.size());
+    for (const SubMesh& subMesh : m_meshes) {
+      cookedMesh.subMeshes.push_back(CookedMesh::SubMesh { subMesh.prim.GetPath().GetString(), subMesh.indexBuffer });
+    }
+    cookedMesh.vertexData = m_vertexData;
+    cookedMesh.vertexDecl = m_vertexDecl;
+    cookedMesh.vertexStride = m_vertexStride;
+    cookedMesh.numVertices = m_numVertices;
+    cookedMesh.numBonesPerVertex = m_limitedNumBonesPerVertex;
+    cookedMesh.doubleSided = m_doubleSided;
+    cookedMesh.isRightHanded = m_isRightHanded;
+    cookedMesh.boundingBox = m_boundingBox;
+    return cookedMesh;
+  }
+
+
   uint32_t UsdMeshImporter::generateVertexDeclaration(std::unique_ptr<GeomPrimvarSampler>* ppMeshSamplers) {
     size_t offset = 0;
     const size_t size = sizeof(float) * 3;
@@ -413,6 +460,89 @@ namespace lss {
     }
   }
 
+  uint32_t encodeOctahedralNormal(const GfVec3f& normal) {
+    const float maxMag = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+    const float inverseMag = maxMag == 0.0f ? 0.0f : (1.0f / maxMag);
+    float x = normal[0] * inverseMag;
+    float y = normal[1] * inverseMag;
+
+    if (normal[2] < 0.0f) {
+      const auto originalXSign = signNotZero(x);
+      const auto originalYSign = signNotZero(y);
+      const auto inverseAbsX = 1.0f - std::abs(x);
+      const auto inverseAbsY = 1.0f - std::abs(y);
+
+      x = inverseAbsY * originalXSign;
+      y = inverseAbsX * originalYSign;
+    }
+
+    // Signed->Unsigned octahedral
+    x = x * 0.5f + 0.5f;
+    y = y * 0.5f + 0.5f;
+
+    return f32ToUnorm16(x) | (f32ToUnorm16(y) << 16);
+  }
+
+  uint32_t encodeVertexColor(const GfVec3f& color, const float opacity) {
+    return D3DCOLOR_ARGB(((DWORD) (opacity * 255.f)), (DWORD) ((color[0]) * 255.f), (DWORD) ((color[1]) * 255.f), (DWORD) ((color[2]) * 255.f));
+  }
+
+  const UsdMeshImporter::VertexDeclaration* UsdMeshImporter::findVertexDecl(Attributes attribute) const {
+    for (const VertexDeclaration& decl : m_vertexDecl) {
+      if (decl.attribute == attribute) {
+        return &decl;
+      }
+    }
+    return nullptr;
+  }
+
+  void UsdMeshImporter::writeBlendData(float* vertex, const VertexDeclaration& indicesDecl, const VertexDeclaration& weightsDecl, const uint32_t* blendIndices, const float* blendWeights) const {
+    // Limit the influences
+    uint32_t limitedIndices[MaxSupportedNumBones];
+    float limitedWeights[MaxSupportedNumBones];
+    if (m_actualNumBonesPerVertex != m_limitedNumBonesPerVertex) {
+      limitBoneInfluences<MaxSupportedNumBones>(blendIndices, blendWeights, m_actualNumBonesPerVertex, m_limitedNumBonesPerVertex, limitedIndices, limitedWeights);
+      blendIndices = &limitedIndices[0];
+      blendWeights = &limitedWeights[0];
+    }
+
+    // Encode the limited bone indices into compressed byte form
+    for (int j = 0; j < m_limitedNumBonesPerVertex; j += 4) {
+      uint32_t vertIndices = 0;
+      for (int k = 0; k < 4 && (j + k) < m_limitedNumBonesPerVertex; ++k) {
+        vertIndices |= blendIndices[j + k] << (8 * k);
+      }
+      *(uint32_t*) (&vertex[indicesDecl.offset / 4 + j / 4]) = vertIndices;
+    }
+
+    // Write the weights
+    memcpy(&vertex[weightsDecl.offset / 4], &blendWeights[0], weightsDecl.size);
+  }
+
+  void UsdMeshImporter::buildFaceToTriangleMap(const uint32_t numTriangles, const VtIntArray& trianglePrimitiveParams, FaceToTriangleMap& triangleMapOut) {
+    if (triangleMapOut.empty()) {
+      return;
+    }
+
+    IndexRange currentFaceMapRange;
+    uint32_t prevFaceIdx = 0;
+    for (uint32_t triIdx = 0; triIdx < numTriangles; triIdx++) {
+      const uint32_t faceIdx = UsdMeshUtil::DecodeFaceIndexFromCoarseFaceParam(trianglePrimitiveParams[triIdx]);
+      if (faceIdx != prevFaceIdx) {
+        currentFaceMapRange.end = triIdx * 3;
+        triangleMapOut[prevFaceIdx] = currentFaceMapRange;
+        currentFaceMapRange.start = currentFaceMapRange.end; // restart the count
+        prevFaceIdx = faceIdx;
+      }
+    }
+
+    if (prevFaceIdx != 0xFFFFFFFF) {
+      // Add the last face to mapping
+      currentFaceMapRange.end = numTriangles * 3;
+      triangleMapOut[prevFaceIdx] = currentFaceMapRange;
+    }
+  }
+
   void UsdMeshImporter::triangulate(const uint32_t numTriangles, 
                                     const uint32_t elementStride,
                                     const std::unique_ptr<GeomPrimvarSampler>* ppMeshSamplers,
@@ -427,9 +557,7 @@ namespace lss {
 
     fast_unordered_cache<uint32_t> uniqueVertexToIndex;
 
-    IndexRange currentFaceMapRange;
     uint32_t uniqueVertexIndex = 0;
-    uint32_t prevFaceIdx = 0;
     uint32_t totalOffset = 0;
     for (uint32_t triIdx = 0; triIdx < numTriangles; triIdx++) {
       for (uint32_t vertIdx = 0; vertIdx < 3; vertIdx++) {
@@ -457,38 +585,9 @@ namespace lss {
             // ... and the corresponding blend weights
             ppMeshSamplers[Attributes::BlendWeights]->SampleBuffer(idx, &blendWeightsStorage[0]);
 
-            // Helper to write the blend data to our vertex buffer
-            const auto& writeBlendData = [&](uint32_t* blendIndices, float* blendWeights) {
-              // Encode the limited bone indices into compressed byte form
-              for (int j = 0; j < m_limitedNumBonesPerVertex; j += 4) {
-                uint32_t vertIndices = 0;
-                for (int k = 0; k < 4 && (j + k) < m_limitedNumBonesPerVertex; ++k) {
-                  vertIndices |= blendIndices[j + k] << (8 * k);
-                }
-                *(uint32_t*) (&m_vertexData[vertexOffset + decl.offset / 4 + j / 4]) = vertIndices;
-              }
-
-              // Write the weights
-              const VertexDeclaration* blendWeightsDecl = nullptr;
-              for (const VertexDeclaration& decl : m_vertexDecl) {
-                if (decl.attribute == Attributes::BlendWeights) {
-                  blendWeightsDecl = &decl;
-                  break;
-                }
-              }
-              assert(blendWeightsDecl != nullptr);
-              memcpy(&m_vertexData[vertexOffset + blendWeightsDecl->offset / 4], &blendWeights[0], blendWeightsDecl->size);
-            };
-
-            // Limit the influences
-            if (m_actualNumBonesPerVertex != m_limitedNumBonesPerVertex) {
-              uint32_t limitedIndices[MaxSupportedNumBones];
-              float limitedWeights[MaxSupportedNumBones];
-              limitBoneInfluences<MaxSupportedNumBones>(blendIndicesStorage, blendWeightsStorage, m_actualNumBonesPerVertex, m_limitedNumBonesPerVertex, limitedIndices, limitedWeights);
-              writeBlendData(&limitedIndices[0], &limitedWeights[0]);
-            } else {
-              writeBlendData(&blendIndicesStorage[0], &blendWeightsStorage[0]);
-            }
+            const VertexDeclaration* blendWeightsDecl = findVertexDecl(Attributes::BlendWeights);
+            assert(blendWeightsDecl != nullptr);
+            writeBlendData(&m_vertexData[vertexOffset], decl, *blendWeightsDecl, &blendIndicesStorage[0], &blendWeightsStorage[0]);
             break;
           }
           case Attributes::Colors:
@@ -502,7 +601,7 @@ namespace lss {
             if (ppMeshSamplers[Attributes::Colors]) {
               ppMeshSamplers[Attributes::Colors]->SampleBuffer(idx, &color);
             }
-            vertexColor = D3DCOLOR_ARGB(((DWORD) (opacity * 255.f)), (DWORD) ((color[0]) * 255.f), (DWORD) ((color[1]) * 255.f), (DWORD) ((color[2]) * 255.f));
+            vertexColor = encodeVertexColor(color, opacity);
             break;
           }
           case Attributes::Opacity:
@@ -520,28 +619,7 @@ namespace lss {
             GfVec3f normal(0.0f);
             ppMeshSamplers[decl.attribute]->SampleBuffer(idx, &normal);
             uint32_t& normalStorage = *reinterpret_cast<uint32_t*>(&m_vertexData[vertexOffset + decl.offset / 4]);
-
-            const float maxMag = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
-            const float inverseMag = maxMag == 0.0f ? 0.0f : (1.0f / maxMag);
-            float x = normal[0] * inverseMag;
-            float y = normal[1] * inverseMag;
-
-            if (normal[2] < 0.0f) {
-              const auto originalXSign = signNotZero(x);
-              const auto originalYSign = signNotZero(y);
-              const auto inverseAbsX = 1.0f - std::abs(x);
-              const auto inverseAbsY = 1.0f - std::abs(y);
-
-              x = inverseAbsY * originalXSign;
-              y = inverseAbsX * originalYSign;
-            }
-
-            // Signed->Unsigned octahedral
-            x = x * 0.5f + 0.5f;
-            y = y * 0.5f + 0.5f;
-
-            normalStorage = f32ToUnorm16(x) | (f32ToUnorm16(y) << 16);
-
+            normalStorage = encodeOctahedralNormal(normal);
             break;
           }
           default: {
@@ -568,25 +646,162 @@ namespace lss {
           indicesOut[idx] = existingVertex->second;
         }
       }
+    }
+
+    // Build the face to index mapping for geom subsets
+    buildFaceToTriangleMap(numTriangles, trianglePrimitiveParams, triangleMapOut);
+
+    m_vertexData.resize(uniqueVertexIndex * elementStride);
+  }
+
+  void UsdMeshImporter::triangulateBatched(const uint32_t numTriangles,
+                                           const uint32_t elementStride,
+                                           const std::unique_ptr<GeomPrimvarSampler>* ppMeshSamplers,
+                                           const VtIntArray& trianglePrimitiveParams,
+                                           std::vector<uint32_t>& indicesOut,
+                                           FaceToTriangleMap& triangleMapOut) {
+    ZoneScoped;
+    const uint32_t numIndices = numTriangles * 3;
+    indicesOut.resize(numIndices);
+    m_vertexData.clear();
+
+    // Corners are assembled a batch at a time into scratch storage, where every corner gets its own slot so that
+    // the chunks of a batch can be assembled in any order.  Only unique vertices are kept in m_vertexData.
+    const bool parallel = numIndices >= ParallelAssemblyMinCorners;
+    const uint32_t cornersPerBatch = std::min(numIndices, AssemblyCornersPerChunk * (parallel ? AssemblyChunksPerBatch : 1));
+    std::vector<float> batchVertices(size_t(cornersPerBatch) * elementStride);
+    std::vector<uint64_t> batchHashes(cornersPerBatch);
+
+    fast_unordered_cache<uint32_t> uniqueVertexToIndex;
+    uniqueVertexToIndex.reserve(numIndices / 4);
 
-      // Build the face to index mapping for geom subsets
-      if (triangleMapOut.size() > 0) {
-        const uint32_t faceIdx = UsdMeshUtil::DecodeFaceIndexFromCoarseFaceParam(trianglePrimitiveParams[triIdx]);
-        if (faceIdx != prevFaceIdx) {
-          currentFaceMapRange.end = triIdx * 3;
-          triangleMapOut[prevFaceIdx] = currentFaceMapRange;
-          currentFaceMapRange.start = currentFaceMapRange.end; // restart the count
-          prevFaceIdx = faceIdx;
+    uint32_t uniqueVertexIndex = 0;
+    for (uint32_t batchStart = 0; batchStart < numIndices; batchStart += cornersPerBatch) {
+      const uint32_t numBatchCorners = std::min(cornersPerBatch, numIndices - batchStart);
+      std::fill_n(batchVertices.begin(), size_t(numBatchCorners) * elementStride, 0.0f);
+
+      const auto assemble = [&](uint32_t firstCorner, uint32_t numCorners) {
+        assembleCorners(batchStart + firstCorner, numCorners, ppMeshSamplers,
+                        reinterpret_cast<uint8_t*>(&batchVertices[size_t(firstCorner) * elementStride]), &batchHashes[firstCorner]);
+      };
+      if (parallel) {
+        UsdThreadPool::parallelForChunks(numBatchCorners, AssemblyCornersPerChunk, assemble);
+      } else {
+        assemble(0, numBatchCorners);
+      }
+
+      // Deduplicate serially in corner order, so that indices are assigned exactly as in the reference path.
+      for (uint32_t i = 0; i < numBatchCorners; i++) {
+        const uint32_t idx = batchStart + i;
+        const float* vertex = &batchVertices[size_t(i) * elementStride];
+        const auto [existingVertex, isUnique] = uniqueVertexToIndex.try_emplace(batchHashes[i], uniqueVertexIndex);
+        if (isUnique) {
+          m_vertexData.insert(m_vertexData.end(), vertex, vertex + elementStride);
+          indicesOut[idx] = uniqueVertexIndex++;
+        } else {
+#ifndef NDEBUG
+          // Check for hash collisions
+          assert(memcmp(&m_vertexData[existingVertex->second * elementStride], vertex, m_vertexStride) == 0);
+#endif
+          indicesOut[idx] = existingVertex->second;
         }
       }
     }
 
-    if (triangleMapOut.size() > 0 && prevFaceIdx != 0xFFFFFFFF) {
-      // Add the last face to mapping
-      currentFaceMapRange.end = numTriangles * 3;
-      triangleMapOut[prevFaceIdx] = currentFaceMapRange;
+    // Build the face to index mapping for geom subsets
+    buildFaceToTriangleMap(numTriangles, trianglePrimitiveParams, triangleMapOut);
+  }
+
+  void UsdMeshImporter::assembleCorners(const uint32_t firstCorner,
+                                        const uint32_t numCorners,
+                                        const std::unique_ptr<GeomPrimvarSampler>* ppMeshSamplers,
+                                        uint8_t* corners,
+                                        uint64_t* cornerHashes) {
+    ZoneScoped;
+    const size_t stride = m_vertexStride;
+
+    // Scratch elements are at least a GfVec4f apart, since colors and opacities may be authored with any element size.
+    const auto getScratchStride = [](const GeomPrimvarSampler& sampler) {
+      return dxvk::align(std::max(sampler.GetElementSize(), sizeof(GfVec4f)), sizeof(float));
+    };
+
+    for (const VertexDeclaration& decl : m_vertexDecl) {
+      uint8_t* dst = corners + decl.offset;
+      switch (decl.attribute) {
+      case Attributes::BlendWeights:
+        // Do nothing, we decode the blend weights and indices together below
+        break;
+      case Attributes::BlendIndices:
+      {
+        const VertexDeclaration* blendWeightsDecl = findVertexDecl(Attributes::BlendWeights);
+        assert(ppMeshSamplers[Attributes::BlendWeights] != nullptr && blendWeightsDecl != nullptr);
+        const size_t numBones = m_actualNumBonesPerVertex;
+        std::vector<uint32_t> blendIndices(numCorners * numBones, 0);
+        std::vector<float> blendWeights(numCorners * numBones, 0.0f);
+        ppMeshSamplers[Attributes::BlendIndices]->SampleRange(firstCorner, numCorners, reinterpret_cast<uint8_t*>(blendIndices.data()), numBones * sizeof(uint32_t));
+        ppMeshSamplers[Attributes::BlendWeights]->SampleRange(firstCorner, numCorners, reinterpret_cast<uint8_t*>(blendWeights.data()), numBones * sizeof(float));
+        for (uint32_t i = 0; i < numCorners; i++) {
+          writeBlendData(reinterpret_cast<float*>(corners + i * stride), decl, *blendWeightsDecl, &blendIndices[i * numBones], &blendWeights[i * numBones]);
+        }
+        break;
+      }
+      case Attributes::Colors:
+      {
+        // Default to opaque white
+        std::vector<float> colors;
+        std::vector<float> opacities;
+        size_t colorStride = 0, opacityStride = 0;
+        if (ppMeshSamplers[Attributes::Colors]) {
+          colorStride = getScratchStride(*ppMeshSamplers[Attributes::Colors]);
+          colors.resize(numCorners * colorStride / sizeof(float), 1.0f);
+          ppMeshSamplers[Attributes::Colors]->SampleRange(firstCorner, numCorners, reinterpret_cast<uint8_t*>(colors.data()), colorStride);
+        }
+        if (ppMeshSamplers[Attributes::Opacity]) {
+          opacityStride = getScratchStride(*ppMeshSamplers[Attributes::Opacity]);
+          opacities.resize(numCorners * opacityStride / sizeof(float), 1.0f);
+          ppMeshSamplers[Attributes::Opacity]->SampleRange(firstCorner, numCorners, reinterpret_cast<uint8_t*>(opacities.data()), opacityStride);
+        }
+        for (uint32_t i = 0; i < numCorners; i++) {
+          const float* color = colors.empty() ? nullptr : &colors[i * colorStride / sizeof(float)];
+          const float opacity = opacities.empty() ? 1.0f : opacities[i * opacityStride / sizeof(float)];
+          *reinterpret_cast<uint32_t*>(dst + i * stride) = encodeVertexColor(color ? GfVec3f(color[0], color[1], color[2]) : GfVec3f(1.0f), opacity);
+        }
+        break;
+      }
+      case Attributes::Opacity:
+      {
+        assert(false); // This attribute should never be in the VertexDeclaration.  Presence in the USD leads to Attributes::Colors existing.
+        break;
+      }
+      case Attributes::Texcoords:
+      {
+        ppMeshSamplers[decl.attribute]->SampleRange(firstCorner, numCorners, dst, stride);
+        // Invert texcoord.y for Remix
+        for (uint32_t i = 0; i < numCorners; i++) {
+          float* texcoord = reinterpret_cast<float*>(dst + i * stride);
+          texcoord[1] = 1.f - texcoord[1];
+        }
+        break;
+      }
+      case Attributes::Normals:
+      {
+        std::vector<GfVec3f> normals(numCorners, GfVec3f(0.0f));
+        ppMeshSamplers[decl.attribute]->SampleRange(firstCorner, numCorners, reinterpret_cast<uint8_t*>(normals.data()), sizeof(GfVec3f));
+        for (uint32_t i = 0; i < numCorners; i++) {
+          *reinterpret_cast<uint32_t*>(dst + i * stride) = encodeOctahedralNormal(normals[i]);
+        }
+        break;
+      }
+      default:
+      {
+        ppMeshSamplers[decl.attribute]->SampleRange(firstCorner, numCorners, dst, stride);
+        break;
+      }
+      }
     }
 
-    m_vertexData.resize(uniqueVertexIndex * elementStride);
+    for (uint32_t i = 0; i < numCorners; i++) {
+      cornerHashes[i] = XXH3_64bits(corners + i * stride, stride);
+    }
   }
 }
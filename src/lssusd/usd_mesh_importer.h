@@ -37,7 +37,14 @@ namespace lss {
 
   class UsdMeshImporter {
   public:
-    UsdMeshImporter(const pxr::UsdPrim& meshPrim, const uint32_t limitedNumBonesPerVertex);
+    // Batched assembles triangle corners in chunks (in parallel for large meshes), sampling each primvar once per
+    // chunk.  Reference processes one corner at a time, and is kept to validate the batched path against.
+    enum class ImportPath {
+      Batched,
+      Reference
+    };
+
+    UsdMeshImporter(const pxr::UsdPrim& meshPrim, const uint32_t limitedNumBonesPerVertex, const ImportPath importPath = ImportPath::Batched);
 
     enum Attributes : uint32_t {
       VertexPositions = 0,
@@ -112,6 +119,31 @@ namespace lss {
       return m_boundingBox;
     }
 
+    // Self-contained form of a processed mesh, used to persist the result of an import so that later loads
+    // can skip triangulation and primvar sampling.  Submeshes refer to their prims by path.
+    struct CookedMesh {
+      struct SubMesh {
+        std::string primPath;
+        std::vector<uint32_t> indexBuffer;
+      };
+
+      std::vector<SubMesh> subMeshes;
+      std::vector<float> vertexData;
+      std::vector<VertexDeclaration> vertexDecl;
+      uint32_t vertexStride = 0;
+      uint32_t numVertices = 0;
+      uint32_t numBonesPerVertex = 0;
+      DoubleSidedState doubleSided = Inherit;
+      bool isRightHanded = true;
+      dxvk::AxisAlignedBoundingBox boundingBox;
+    };
+
+    // Rebuilds an importer from a cooked mesh.  Submesh prims are resolved on the stage of the mesh prim,
+    // throws if any of them no longer exists.
+    UsdMeshImporter(const pxr::UsdPrim& meshPrim, CookedMesh&& cookedMesh);
+
+    CookedMesh Cook() const;
+
   private:
     inline static const uint32_t MaxSupportedNumBones = 256;
 
@@ -121,6 +153,13 @@ namespace lss {
 
     using FaceToTriangleMap = std::vector<IndexRange>;
 
+    // Corner counts above which the batched path splits the assembly across threads, and the size of each chunk.
+    // Corners are assembled AssemblyChunksPerBatch chunks at a time, which bounds the scratch memory of a decode
+    // independently of the mesh size.
+    inline static const uint32_t ParallelAssemblyMinCorners = 1 << 16;
+    inline static const uint32_t AssemblyCornersPerChunk = 1 << 12;
+    inline static const uint32_t AssemblyChunksPerBatch = 8;
+
     void triangulate(const uint32_t numTriangles, 
                      const uint32_t elementStride,
                      const std::unique_ptr<GeomPrimvarSampler>* ppMeshSamplers,
@@ -128,6 +167,26 @@ namespace lss {
                      std::vector<uint32_t>& indicesOut,
                      FaceToTriangleMap& triangleMapOut);
 
+    void triangulateBatched(const uint32_t numTriangles,
+                            const uint32_t elementStride,
+                            const std::unique_ptr<GeomPrimvarSampler>* ppMeshSamplers,
+                            const pxr::VtIntArray& trianglePrimitiveParams,
+                            std::vector<uint32_t>& indicesOut,
+                            FaceToTriangleMap& triangleMapOut);
+
+    // Writes the vertices of corners [firstCorner, firstCorner + numCorners) to consecutive slots of m_vertexStride
+    // bytes in corners, and the hash of each vertex to cornerHashes.
+    void assembleCorners(const uint32_t firstCorner,
+                         const uint32_t numCorners,
+                         const std::unique_ptr<GeomPrimvarSampler>* ppMeshSamplers,
+                         uint8_t* corners,
+                         uint64_t* cornerHashes);
+
+    void writeBlendData(float* vertex, const VertexDeclaration& indicesDecl, const VertexDeclaration& weightsDecl, const uint32_t* blendIndices, const float* blendWeights) const;
+    const VertexDeclaration* findVertexDecl(Attributes attribute) const;
+
+    static void buildFaceToTriangleMap(const uint32_t numTriangles, const pxr::VtIntArray& trianglePrimitiveParams, FaceToTriangleMap& triangleMapOut);
+
     static const std::vector<uint32_t> generateSubsetIndices(const pxr::UsdGeomSubset& subset, const std::vector<uint32_t>& indices, const FaceToTriangleMap& triangleMap);
     void generateTriangleSamplers(UsdMeshUtil& meshUtil, const pxr::VtVec3iArray& usdIndices, const pxr::VtIntArray& trianglePrimitiveParams, std::unique_ptr<GeomPrimvarSampler>* ppMeshSamplers);
     uint32_t generateVertexDeclaration(std::unique_ptr<GeomPrimvarSampler>* ppMeshSamplers);
@@ -27,6 +27,7 @@
 
 #include <bitset>
 #include <cstddef>
+#include <cstring>
 
 #include "usd_include_begin.h"
 #include <pxr/pxr.h>
@@ -62,7 +63,40 @@ namespace lss {
       return true;
     }
 
+    // Batched form of Sample: writes element `indexOf(first + i)` to `dst + i * dstStride` for `count` elements.
+    // Elements with an out of range index are left untouched, same as Sample.  Common element sizes are
+    // dispatched to fixed size copies, which compile to plain vector loads and stores.
+    template<typename IndexFn>
+    void Gather(uint32_t first, uint32_t count, size_t size, uint8_t* dst, size_t dstStride, const IndexFn& indexOf) const {
+      switch (size) {
+      case 4:  GatherFixed<4>(first, count, dst, dstStride, indexOf); break;
+      case 8:  GatherFixed<8>(first, count, dst, dstStride, indexOf); break;
+      case 12: GatherFixed<12>(first, count, dst, dstStride, indexOf); break;
+      case 16: GatherFixed<16>(first, count, dst, dstStride, indexOf); break;
+      default:
+        for (uint32_t i = 0; i < count; i++) {
+          const size_t index = indexOf(first + i);
+          if (index < (size_t) m_numElements) {
+            memcpy(dst + i * dstStride, m_buffer.cdata() + size * index, size);
+          }
+        }
+        break;
+      }
+    }
+
   private:
+    template<size_t Size, typename IndexFn>
+    void GatherFixed(uint32_t first, uint32_t count, uint8_t* dst, size_t dstStride, const IndexFn& indexOf) const {
+      const uint8_t* src = m_buffer.cdata();
+      const size_t numElements = (size_t) m_numElements;
+      for (uint32_t i = 0; i < count; i++) {
+        const size_t index = indexOf(first + i);
+        if (index < numElements) {
+          memcpy(dst + i * dstStride, src + Size * index, Size);
+        }
+      }
+    }
+
     pxr::VtArray<uint8_t> const m_buffer;
     int m_numElements;
   };
@@ -74,6 +108,15 @@ namespace lss {
     virtual ~GeomPrimvarSampler() = default;
 
     virtual bool SampleBuffer(int index, void* value) const = 0;
+
+    // Samples `count` consecutive triangle corners starting at `first`, writing each element `dstStride` bytes apart.
+    // One virtual call per range rather than per element, elements that can't be sampled are left untouched.
+    virtual void SampleRange(uint32_t first, uint32_t count, uint8_t* dst, size_t dstStride) const = 0;
+
+    virtual size_t GetElementSize() const = 0;
+
+  protected:
+    static constexpr size_t kInvalidIndex = ~size_t(0);
   };
 
 
@@ -86,6 +129,14 @@ namespace lss {
     bool SampleBuffer(int index, void* value) const override {
       return m_sampler.Sample(0, value, m_elementSize);
     }
+
+    size_t GetElementSize() const override {
+      return m_elementSize;
+    }
+
+    void SampleRange(uint32_t first, uint32_t count, uint8_t* dst, size_t dstStride) const override {
+      m_sampler.Gather(first, count, m_elementSize, dst, dstStride, [](uint32_t) { return size_t(0); });
+    }
   private:
     BufferSampler const m_sampler;
     size_t m_elementSize;
@@ -104,16 +155,32 @@ namespace lss {
       , m_elementSize(elementSize) { }
 
     bool SampleBuffer(int index, void* value) const {
+      const size_t elementIndex = GetElementIndex(index);
+      if (elementIndex == kInvalidIndex) {
+        return false;
+      }
+      return m_sampler.Sample(elementIndex, value, m_elementSize);
+    }
+
+    size_t GetElementSize() const override {
+      return m_elementSize;
+    }
+
+    void SampleRange(uint32_t first, uint32_t count, uint8_t* dst, size_t dstStride) const override {
+      m_sampler.Gather(first, count, m_elementSize, dst, dstStride, [this](uint32_t index) { return GetElementIndex(index); });
+    }
+
+  private:
+    size_t GetElementIndex(uint32_t index) const {
       if (m_primitiveParams.empty()) {
-        return m_sampler.Sample(index, value, m_elementSize);
+        return index;
       }
       if (index >= m_primitiveParams.size()) {
-        return false;
+        return kInvalidIndex;
       }
-      return m_sampler.Sample(UsdMeshUtil::DecodeFaceIndexFromCoarseFaceParam(m_primitiveParams[index]), value, m_elementSize);
+      return UsdMeshUtil::DecodeFaceIndexFromCoarseFaceParam(m_primitiveParams[index]);
     }
 
-  private:
     BufferSampler const m_sampler;
     pxr::VtIntArray const m_primitiveParams;
     size_t m_elementSize;
@@ -131,6 +198,15 @@ namespace lss {
       return m_sampler.Sample(m_indices[index / 3][index % 3], value, m_elementSize);
     }
 
+    size_t GetElementSize() const override {
+      return m_elementSize;
+    }
+
+    void SampleRange(uint32_t first, uint32_t count, uint8_t* dst, size_t dstStride) const override {
+      const int* indices = m_indices.cdata()->data();
+      m_sampler.Gather(first, count, m_elementSize, dst, dstStride, [indices](uint32_t index) { return (size_t) indices[index]; });
+    }
+
   private:
     BufferSampler const m_sampler;
     pxr::VtVec3iArray const m_indices;
@@ -148,6 +224,14 @@ namespace lss {
       return m_sampler.Sample(index, value, m_elementSize);
     }
 
+    size_t GetElementSize() const override {
+      return m_elementSize;
+    }
+
+    void SampleRange(uint32_t first, uint32_t count, uint8_t* dst, size_t dstStride) const override {
+      m_sampler.Gather(first, count, m_elementSize, dst, dstStride, [](uint32_t index) { return (size_t) index; });
+    }
+
   private:
     BufferSampler const m_sampler;
     size_t m_elementSize;
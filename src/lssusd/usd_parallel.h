@@ -0,0 +1,100 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "../util/thread.h"
+#include "../util/util_threadpool.h"
+
+namespace lss {
+
+  // Thread pool shared by the USD import and export code, for splitting up the processing of large meshes and
+  // authoring independent layers concurrently.
+  class UsdThreadPool {
+  public:
+    static uint32_t numThreads() {
+      return getPool().m_numThreads;
+    }
+
+    // Runs fn(first, count) over [0, numItems) in chunks of chunkSize.  The calling thread processes chunks too, so
+    // this always makes progress even if no work could be scheduled, and is safe to call from several threads at
+    // once (e.g. while meshes are decoded in parallel).  Chunks are claimed in any order, so fn must only write to
+    // data owned by its own range for the results to be independent of scheduling.
+    template<typename Fn>
+    static void parallelForChunks(uint32_t numItems, uint32_t chunkSize, const Fn& fn) {
+      const uint32_t numChunks = (numItems + chunkSize - 1) / chunkSize;
+      if (numChunks <= 1) {
+        if (numItems > 0) {
+          fn(0, numItems);
+        }
+        return;
+      }
+
+      std::atomic<uint32_t> nextChunk = 0;
+      auto work = [&nextChunk, numChunks, numItems, chunkSize, &fn]() {
+        for (uint32_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++) {
+          const uint32_t first = chunk * chunkSize;
+          fn(first, std::min(chunkSize, numItems - first));
+        }
+      };
+
+      UsdThreadPool& pool = getPool();
+      std::vector<dxvk::Future<void>> futures;
+      {
+        // The pool's task queues are single producer, so scheduling has to be serialized between callers.
+        std::lock_guard<std::mutex> lock(pool.m_scheduleMutex);
+        const uint32_t numHelpers = std::min(numChunks - 1, pool.m_numThreads);
+        for (uint32_t i = 0; i < numHelpers; i++) {
+          dxvk::Future<void> future = pool.m_workers.Schedule([&work]() { work(); });
+          if (future.valid()) {
+            futures.push_back(std::move(future));
+          }
+        }
+      }
+
+      work();
+      for (auto& future : futures) {
+        future.get();
+      }
+    }
+
+  private:
+    UsdThreadPool()
+      : m_numThreads(std::clamp(dxvk::thread::hardware_concurrency() / 2, 1u, 16u))
+      , m_workers(static_cast<uint8_t>(m_numThreads), "lss-usd-worker") {
+    }
+
+    static UsdThreadPool& getPool() {
+      static UsdThreadPool s_pool;
+      return s_pool;
+    }
+
+    const uint32_t m_numThreads;
+    std::mutex m_scheduleMutex;
+    dxvk::WorkerThreadPool<4, true, false> m_workers;
+  };
+}
@@ -1,7 +1,308 @@
+#include <algorithm>
+#include <cstring>
+
+#include <smmintrin.h>
+
 #include "spirv_compression.h"
 
 namespace dxvk {
 
+  // The code stream relies on little-endian byte order: each
+  // DWORD contributes its low bytes, in order, and each byte of
+  // the mask holds the byte counts of four consecutive DWORDs.
+  // This allows a full group of four DWORDs to be encoded or
+  // decoded with a single byte shuffle.
+  struct SpirvCompressionTables {
+    uint8_t length[256];
+    uint8_t decode[256][16];
+    uint8_t encode[256][16];
+
+    SpirvCompressionTables() {
+      for (uint32_t c = 0; c < 256; c++) {
+        std::memset(decode[c], 0x80, sizeof(decode[c]));
+        std::memset(encode[c], 0x80, sizeof(encode[c]));
+
+        uint32_t offset = 0;
+
+        for (uint32_t w = 0; w < 4; w++) {
+          uint32_t bytes = ((c >> (2 * w)) & 3) + 1;
+
+          for (uint32_t b = 0; b < bytes; b++) {
+            decode[c][4 * w + b] = uint8_t(offset + b);
+            encode[c][offset + b] = uint8_t(4 * w + b);
+          }
+
+          offset += bytes;
+        }
+
+        length[c] = uint8_t(offset);
+      }
+    }
+  };
+
+
+  static const SpirvCompressionTables& getTables() {
+    static const SpirvCompressionTables s_tables;
+    return s_tables;
+  }
+
+
+  static uint32_t getLengthCode(uint32_t word) {
+    return uint32_t(word >= (1u <<  8))
+         + uint32_t(word >= (1u << 16))
+         + uint32_t(word >= (1u << 24));
+  }
+
+
+  static size_t encodeStream(
+    const uint32_t*             src,
+          uint32_t              count,
+          uint8_t*              mask,
+          uint8_t*              dst,
+          fast::SIMD            simd) {
+    uint32_t i = 0;
+    size_t   n = 0;
+
+    if (simd >= fast::SSE4_1) {
+      const SpirvCompressionTables& tables = getTables();
+
+      const __m128i limit8  = _mm_set1_epi32(1 <<  8);
+      const __m128i limit16 = _mm_set1_epi32(1 << 16);
+      const __m128i limit24 = _mm_set1_epi32(1 << 24);
+
+      // Stores always write 16 bytes, but only advance by the
+      // actual group length. The caller provides enough slack.
+      for (; i + 4 <= count; i += 4) {
+        __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i]));
+
+        __m128i lengths = _mm_add_epi32(
+          _mm_add_epi32(
+            _mm_cmpeq_epi32(_mm_min_epu32(words, limit8),  limit8),
+            _mm_cmpeq_epi32(_mm_min_epu32(words, limit16), limit16)),
+            _mm_cmpeq_epi32(_mm_min_epu32(words, limit24), limit24));
+
+        lengths = _mm_sub_epi32(_mm_setzero_si128(), lengths);
+        lengths = _mm_packus_epi32(lengths, lengths);
+        lengths = _mm_packus_epi16(lengths, lengths);
+
+        uint32_t bytes   = uint32_t(_mm_cvtsi128_si32(lengths));
+        uint32_t control = (bytes | (bytes >> 6) | (bytes >> 12) | (bytes >> 18)) & 0xff;
+
+        __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.encode[control]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[n]), _mm_shuffle_epi8(words, shuffle));
+
+        mask[i / 4] = uint8_t(control);
+        n += tables.length[control];
+      }
+    }
+
+    for (; i < count; i++) {
+      uint32_t word   = src[i];
+      uint32_t length = getLengthCode(word);
+
+      mask[i / 4] |= uint8_t(length << (2 * (i & 3)));
+
+      std::memcpy(&dst[n], &word, length + 1);
+      n += length + 1;
+    }
+
+    return n;
+  }
+
+
+  static void decodeStream(
+    const uint8_t*              src,
+          size_t                srcSize,
+    const uint8_t*              mask,
+          uint32_t*             dst,
+          uint32_t              count,
+          fast::SIMD            simd) {
+    uint32_t i = 0;
+    size_t   n = 0;
+
+    if (simd >= fast::SSE4_1) {
+      const SpirvCompressionTables& tables = getTables();
+
+      for (; i + 4 <= count && n + 16 <= srcSize; i += 4) {
+        uint32_t control = mask[i / 4];
+
+        __m128i bytes   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[n]));
+        __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.decode[control]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i]), _mm_shuffle_epi8(bytes, shuffle));
+
+        n += tables.length[control];
+      }
+    }
+
+    for (; i < count; i++) {
+      uint32_t length = ((mask[i / 4] >> (2 * (i & 3))) & 3) + 1;
+      uint32_t word   = 0;
+
+      std::memcpy(&word, &src[n], length);
+      dst[i] = word;
+      n += length;
+    }
+  }
+
+
+  // The dictionary mode runs an LZ77 pass over the code stream,
+  // which mostly catches repeated instruction headers and type
+  // IDs. Sequences are stored as a token byte holding a literal
+  // count and match length, extended with 255-continuation bytes
+  // when either is 15, followed by the literals and a two-byte
+  // match offset. The final sequence only contains literals.
+  constexpr uint32_t LzHashBits   = 14;
+  constexpr size_t   LzMinMatch   = 4;
+  constexpr size_t   LzMaxOffset  = 0xffff;
+
+  static void writeLzLength(std::vector<uint8_t>& dst, size_t length) {
+    for (; length >= 255; length -= 255)
+      dst.push_back(255);
+
+    dst.push_back(uint8_t(length));
+  }
+
+
+  static bool readLzLength(const uint8_t*& src, const uint8_t* srcEnd, size_t& length) {
+    uint8_t next;
+
+    do {
+      if (src == srcEnd)
+        return false;
+
+      next = *(src++);
+      length += next;
+    } while (next == 255);
+
+    return true;
+  }
+
+
+  static void writeLzSequence(
+          std::vector<uint8_t>& dst,
+    const uint8_t*              literals,
+          size_t                literalCount,
+          size_t                matchLength,
+          size_t                matchOffset) {
+    size_t matchCode = matchLength ? matchLength - LzMinMatch : 0;
+
+    dst.push_back(uint8_t((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+
+    if (literalCount >= 15)
+      writeLzLength(dst, literalCount - 15);
+
+    dst.insert(dst.end(), literals, literals + literalCount);
+
+    if (matchLength) {
+      dst.push_back(uint8_t(matchOffset));
+      dst.push_back(uint8_t(matchOffset >> 8));
+
+      if (matchCode >= 15)
+        writeLzLength(dst, matchCode - 15);
+    }
+  }
+
+
+  static std::vector<uint8_t> compressDictionary(
+    const uint8_t*              src,
+          size_t                size) {
+    std::vector<uint8_t> dst;
+    dst.reserve(size / 2 + 16);
+
+    std::vector<uint32_t> table(1u << LzHashBits, ~0u);
+
+    size_t anchor = 0;
+    size_t pos    = 0;
+
+    while (pos + LzMinMatch <= size) {
+      uint32_t sequence;
+      std::memcpy(&sequence, &src[pos], sizeof(sequence));
+
+      uint32_t hash = (sequence * 2654435761u) >> (32 - LzHashBits);
+      uint32_t candidate = table[hash];
+      table[hash] = uint32_t(pos);
+
+      if (candidate != ~0u && pos - candidate <= LzMaxOffset
+       && !std::memcmp(&src[candidate], &src[pos], LzMinMatch)) {
+        size_t length = LzMinMatch;
+
+        while (pos + length < size && src[candidate + length] == src[pos + length])
+          length += 1;
+
+        writeLzSequence(dst, &src[anchor], pos - anchor, length, pos - candidate);
+
+        pos   += length;
+        anchor = pos;
+      } else {
+        pos += 1;
+      }
+    }
+
+    if (anchor < size)
+      writeLzSequence(dst, &src[anchor], size - anchor, 0, 0);
+
+    return dst;
+  }
+
+
+  static bool decompressDictionary(
+    const uint8_t*              src,
+          size_t                srcSize,
+          uint8_t*              dst,
+          size_t                dstSize) {
+    const uint8_t* srcEnd = src + srcSize;
+    size_t n = 0;
+
+    while (n < dstSize) {
+      if (src == srcEnd)
+        return false;
+
+      uint32_t token = *(src++);
+      size_t literalCount = token >> 4;
+
+      if (literalCount == 15 && !readLzLength(src, srcEnd, literalCount))
+        return false;
+
+      if (literalCount > size_t(srcEnd - src) || literalCount > dstSize - n)
+        return false;
+
+      std::memcpy(&dst[n], src, literalCount);
+      src += literalCount;
+      n   += literalCount;
+
+      if (n == dstSize)
+        break;
+
+      if (srcEnd - src < 2)
+        return false;
+
+      size_t matchOffset = size_t(src[0]) | (size_t(src[1]) << 8);
+      size_t matchLength = (token & 0xf) + LzMinMatch;
+      src += 2;
+
+      if ((token & 0xf) == 15 && !readLzLength(src, srcEnd, matchLength))
+        return false;
+
+      if (matchOffset == 0 || matchOffset > n || matchLength > dstSize - n)
+        return false;
+
+      // Matches may overlap the bytes they produce
+      const uint8_t* match = &dst[n - matchOffset];
+
+      if (matchOffset >= matchLength) {
+        std::memcpy(&dst[n], match, matchLength);
+      } else {
+        for (size_t i = 0; i < matchLength; i++)
+          dst[n + i] = match[i];
+      }
+
+      n += matchLength;
+    }
+
+    return true;
+  }
+
+
   SpirvCompressedBuffer::SpirvCompressedBuffer()
   : m_size(0) {
 
@@ -9,8 +310,10 @@ namespace dxvk {
 
 
   SpirvCompressedBuffer::SpirvCompressedBuffer(
-    const SpirvCodeBuffer& code)
-  : m_size(code.dwords()) {
+    const SpirvCodeBuffer&      code,
+          SpirvCompressionMode  mode,
+          fast::SIMD            simd)
+  : m_size(code.dwords()), m_mode(mode) {
     const uint32_t* data = code.data();
 
     // The compression works by eliminating leading null bytes
@@ -19,92 +322,116 @@ namespace dxvk {
     // each DWORD, a two-bit integer is stored which indicates
     // the number of bytes it takes in the compressed buffer.
     // This way, it can achieve a compression ratio of ~50%.
-    m_mask.reserve((m_size + NumMaskWords - 1) / NumMaskWords);
-    m_code.reserve((m_size + 1) / 2);
+    m_mask.resize((m_size + NumMaskWords - 1) / NumMaskWords);
 
-    uint64_t dstWord  = 0;
-    uint32_t dstShift = 0;
+    // Worst case, plus room for one full 16-byte store
+    m_code.resize((size_t(m_size) * 4 + 16 + 7) / 8);
 
-    for (uint32_t i = 0; i < m_size; i += NumMaskWords) {
-      uint64_t byteCounts = 0;
+    size_t size = encodeStream(data, m_size,
+      reinterpret_cast<uint8_t*>(m_mask.data()),
+      reinterpret_cast<uint8_t*>(m_code.data()), simd);
 
-      for (uint32_t w = 0; w < NumMaskWords && i + w < m_size; w++) {
-        uint64_t word = data[i + w];
-        uint64_t bytes = 0;
+    if (m_mode == SpirvCompressionMode::Dictionary) {
+      std::vector<uint8_t> packed = compressDictionary(
+        reinterpret_cast<const uint8_t*>(m_code.data()), size);
 
-        if      (word < (1 <<  8)) bytes = 0;
-        else if (word < (1 << 16)) bytes = 1;
-        else if (word < (1 << 24)) bytes = 2;
-        else                       bytes = 3;
+      m_code.assign((packed.size() + 7) / 8, 0);
 
-        byteCounts |= bytes << (2 * w);
+      if (!packed.empty())
+        std::memcpy(m_code.data(), packed.data(), packed.size());
+    } else {
+      m_code.resize((size + 7) / 8);
+    }
 
-        uint32_t bits = 8 * bytes + 8;
-        uint32_t rem  = bit::pack(dstWord, dstShift, word, bits);
+    m_code.shrink_to_fit();
+  }
 
-        if (unlikely(rem != 0)) {
-          m_code.push_back(dstWord);
 
-          dstWord  = 0;
-          dstShift = 0;
+  SpirvCompressedBuffer::SpirvCompressedBuffer(
+          uint32_t              size,
+          std::vector<uint64_t> mask,
+          std::vector<uint64_t> code,
+          SpirvCompressionMode  mode)
+  : m_size(size), m_mode(mode), m_mask(std::move(mask)), m_code(std::move(code)) {
 
-          bit::pack(dstWord, dstShift, word >> (bits - rem), rem);
-        }
-      }
+  }
 
-      m_mask.push_back(byteCounts);
-    }
 
-    if (dstShift)
-      m_code.push_back(dstWord);
+  SpirvCompressedBuffer::~SpirvCompressedBuffer() {
 
-    m_mask.shrink_to_fit();
-    m_code.shrink_to_fit();
   }
 
-    
-  SpirvCompressedBuffer::~SpirvCompressedBuffer() {
 
+  bool SpirvCompressedBuffer::isValid() const {
+    if (m_mask.size() != (uint64_t(m_size) + NumMaskWords - 1) / NumMaskWords)
+      return false;
+
+    size_t size = getStreamSize();
+
+    switch (m_mode) {
+      case SpirvCompressionMode::Fast:
+        return size <= m_code.size() * sizeof(uint64_t);
+
+      case SpirvCompressionMode::Dictionary: {
+        std::vector<uint8_t> stream(size);
+
+        return decompressDictionary(
+          reinterpret_cast<const uint8_t*>(m_code.data()),
+          m_code.size() * sizeof(uint64_t), stream.data(), size);
+      }
+    }
+
+    return false;
   }
 
 
   SpirvCodeBuffer SpirvCompressedBuffer::decompress() const {
+    return decompress(fast::getSimdSupportLevel());
+  }
+
+
+  SpirvCodeBuffer SpirvCompressedBuffer::decompress(
+          fast::SIMD            simd) const {
     SpirvCodeBuffer code(m_size);
-    uint32_t* data = code.data();
 
     if (m_size == 0)
       return code;
 
-    uint32_t maskIdx = 0;
-    uint32_t codeIdx = 0;
+    const uint8_t* mask = reinterpret_cast<const uint8_t*>(m_mask.data());
+
+    if (m_mode == SpirvCompressionMode::Dictionary) {
+      // Padded so that the vectorized decoder
+      // can process the stream up to the end
+      size_t size = getStreamSize();
+      std::vector<uint8_t> stream(size + 16);
 
-    uint64_t srcWord  = m_code[codeIdx++];
-    uint32_t srcShift = 0;
+      decompressDictionary(
+        reinterpret_cast<const uint8_t*>(m_code.data()),
+        m_code.size() * sizeof(uint64_t), stream.data(), size);
 
-    for (uint32_t i = 0; i < m_size; i += NumMaskWords) {
-      uint64_t srcMask = m_mask[maskIdx++];
+      decodeStream(stream.data(), stream.size(), mask, code.data(), m_size, simd);
+    } else {
+      decodeStream(reinterpret_cast<const uint8_t*>(m_code.data()),
+        m_code.size() * sizeof(uint64_t), mask, code.data(), m_size, simd);
+    }
 
-      for (uint32_t w = 0; w < NumMaskWords && i + w < m_size; w++) {
-        uint32_t bits = 8 * ((srcMask & 3) + 1);
+    return code;
+  }
 
-        uint64_t word = 0;
-        uint32_t rem = bit::unpack(word, srcWord, srcShift, bits);
 
-        if (unlikely(rem != 0)) {
-          srcWord  = m_code[codeIdx++];
-          srcShift = 0;
+  size_t SpirvCompressedBuffer::getStreamSize() const {
+    const SpirvCompressionTables& tables = getTables();
+    const uint8_t* mask = reinterpret_cast<const uint8_t*>(m_mask.data());
 
-          uint64_t tmp = 0;
-          bit::unpack(tmp, srcWord, srcShift, rem);
-          word |= tmp << (bits - rem);
-        }
+    size_t size = 0;
 
-        data[i + w] = word;
-        srcMask >>= 2;
-      }
-    }
+    for (uint32_t i = 0; i < m_size / 4; i++)
+      size += tables.length[mask[i]];
 
-    return code;
+    for (uint32_t i = m_size & ~3u; i < m_size; i++)
+      size += ((mask[i / 4] >> (2 * (i & 3))) & 3) + 1;
+
+    return size;
   }
 
-}
\ No newline at end of file
+}
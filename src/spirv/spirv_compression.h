@@ -25,8 +25,21 @@
 
 #include "spirv_code_buffer.h"
 
+#include "../util/util_fastops.h"
+
 namespace dxvk {
 
+  /**
+   * \brief SPIR-V compression mode
+   */
+  enum class SpirvCompressionMode : uint32_t {
+    /// Leading zero bytes of each DWORD are dropped
+    Fast        = 0,
+    /// Same, followed by an LZ pass over the remaining bytes.
+    /// About 25% smaller, but several times slower to decode.
+    Dictionary  = 1,
+  };
+
   /**
    * \brief Compressed SPIR-V code buffer
    *
@@ -39,13 +52,61 @@ namespace dxvk {
 
     SpirvCompressedBuffer();
 
+    /**
+     * \brief Compresses a code buffer
+     *
+     * \param [in] code The code to compress
+     * \param [in] mode Compression mode
+     * \param [in] simd Highest SIMD level to use, the
+     *        output does not depend on it
+     */
+    SpirvCompressedBuffer(
+      const SpirvCodeBuffer&      code,
+            SpirvCompressionMode  mode = SpirvCompressionMode::Fast,
+            fast::SIMD            simd = fast::getSimdSupportLevel());
+
+    /**
+     * \brief Restores a previously compressed buffer
+     *
+     * Takes the values returned by \ref dwords,
+     * \ref getMask, \ref getCode and \ref mode.
+     * Use \ref isValid before decompressing
+     * untrusted data.
+     */
     SpirvCompressedBuffer(
-      const SpirvCodeBuffer&  code);
+            uint32_t              size,
+            std::vector<uint64_t> mask,
+            std::vector<uint64_t> code,
+            SpirvCompressionMode  mode = SpirvCompressionMode::Fast);
     
     ~SpirvCompressedBuffer();
     
     SpirvCodeBuffer decompress() const;
 
+    /**
+     * \brief Decompresses using at most the given SIMD level
+     */
+    SpirvCodeBuffer decompress(
+            fast::SIMD            simd) const;
+
+    /**
+     * \brief Checks that the mask and code are consistent
+     * \returns \c true if decompressing stays in bounds
+     */
+    bool isValid() const;
+
+    uint32_t dwords() const {
+      return m_size;
+    }
+
+    SpirvCompressionMode mode() const {
+      return m_mode;
+    }
+
+    const std::vector<uint64_t>& getMask() const {
+      return m_mask;
+    }
+
     const std::vector<uint64_t>& getCode() const {
       return m_code;
     }
@@ -53,9 +114,12 @@ namespace dxvk {
   private:
 
     uint32_t              m_size;
+    SpirvCompressionMode  m_mode = SpirvCompressionMode::Fast;
     std::vector<uint64_t> m_mask;
     std::vector<uint64_t> m_code;
 
+    size_t getStreamSize() const;
+
   };
 
 }
\ No newline at end of file
@@ -20,6 +20,9 @@
 * DEALINGS IN THE SOFTWARE.
 */
 #include "log.h"
+// NV-DXVK start: asynchronous logging
+#include "log_writer.h"
+// NV-DXVK end
 
 #include <iostream>
 
@@ -36,28 +39,6 @@ namespace{
     const std::string str = dxvk::env::getEnvVar("DXVK_LOG_NO_DOUBLE_PRINT_STDERR");
     return str.empty();
   }
-
-  template<int N>
-  static inline void getLocalTimeString(char(&timeString)[N]) {
-    // [HH:MM:SS.MS]
-    static const char* format = "[%02d:%02d:%02d.%03d] ";
-
-#ifdef _WIN32
-    SYSTEMTIME lt;
-    GetLocalTime(&lt);
-
-    sprintf_s(timeString, format,
-              lt.wHour, lt.wMinute, lt.wSecond, lt.wMilliseconds);
-#else
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-
-    struct tm* lt = localtime(&tv.tv_sec);
-
-    sprintf_s(timeString, format,
-              lt->tm_hour, lt->tm_min, lt->tm_sec, (tv.tv_usec / 1000) % 1000);
-#endif
-  }
 }
 // NV-DXVK end
 
@@ -68,6 +49,9 @@ namespace dxvk {
   // NV-DXVK start: Don't double print every line
   , m_doublePrintToStdErr(getDoublePrintToStdErr())
   // NV-DXVK end
+  // NV-DXVK start: asynchronous logging
+  , m_writer(std::make_unique<LogWriter>([this] (const std::string& text) { writeBatch(text); }))
+  // NV-DXVK end
   {
     if (m_minLevel != LogLevel::None) {
       const auto path = getFilePath(fileName);
@@ -78,6 +62,13 @@ namespace dxvk {
       }
     }
   }
+
+  // NV-DXVK start: asynchronous logging
+  Logger::~Logger() {
+    // Writes pending messages while the file is still open
+    m_writer = nullptr;
+  }
+  // NV-DXVK end
   
   void Logger::initRtxLog() {
     s_instance = std::move(Logger("remix-dxvk.log"));
@@ -107,40 +98,40 @@ namespace dxvk {
     s_instance.emitMsg(level, message);
   }
 
+  // NV-DXVK start: asynchronous logging
+  void Logger::flush() {
+    s_instance.m_writer->flush();
+  }
+  // NV-DXVK end
+
   void Logger::emitMsg(LogLevel level, const std::string& message) {
     if (level >= m_minLevel) {
-      OutputDebugString((message + '\n').c_str());
-
-      std::lock_guard<dxvk::mutex> lock(m_mutex);
-      
-      constexpr std::array<const char*, 5> s_prefixes{
-        "trace: ",
-        "debug: ",
-        "info:  ",
-        "warn:  ",
-        "err:   ",
-      };
-      const char* prefix = s_prefixes[static_cast<std::uint32_t>(level)];
-
-      std::stringstream stream(message);
-      std::string       line;
-
-      char timeString[64];
-      getLocalTimeString(timeString);
-
-      while (std::getline(stream, line, '\n')) {
-        // NV-DXVK start: Don't double print every line
-        if (m_doublePrintToStdErr) {
-          std::cerr << timeString << prefix << line << std::endl;
-        }
-        // NV-DXVK end
-
-        if (m_fileStream) {
-          m_fileStream << timeString << prefix << line << std::endl;
-        }
-      }
+      // NV-DXVK start: asynchronous logging
+      m_writer->push(level, message);
+
+      // Errors often precede a crash, make sure they reach the file
+      if (level >= LogLevel::Error)
+        m_writer->flush();
+      // NV-DXVK end
     }
   }
+
+  // NV-DXVK start: asynchronous logging
+  void Logger::writeBatch(const std::string& text) {
+    OutputDebugString(text.c_str());
+
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    if (m_doublePrintToStdErr) {
+      std::cerr << text;
+    }
+
+    if (m_fileStream) {
+      m_fileStream << text;
+      m_fileStream.flush();
+    }
+  }
+  // NV-DXVK end
   
   
   LogLevel Logger::getMinLogLevel() {
@@ -181,10 +172,45 @@ namespace dxvk {
   }
   
   Logger& Logger::operator=(Logger&& other) {
+    // NV-DXVK start: asynchronous logging
+    // Pending messages belong to the previous file
+    m_writer->flush();
+    other.m_writer->flush();
+
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    // NV-DXVK end
     m_minLevel = other.m_minLevel;
     m_doublePrintToStdErr = other.m_doublePrintToStdErr;
     std::swap(m_fileStream, other.m_fileStream);
     return *this;
   }
+
+  // NV-DXVK start: rate limited logging
+  bool LogRateLimiter::allow(uint32_t& suppressed) {
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    int64_t windowStart = m_windowStart.load(std::memory_order_relaxed);
+
+    if (now - windowStart >= WindowMs
+     && m_windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+      m_count.store(0, std::memory_order_relaxed);
+
+    if (m_count.fetch_add(1, std::memory_order_relaxed) < MessagesPerWindow) {
+      suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+      return true;
+    }
+
+    m_suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  std::string LogRateLimiter::annotate(std::string message, uint32_t suppressed) {
+    if (suppressed)
+      message += str::format(" (", suppressed, " similar message(s) suppressed)");
+
+    return message;
+  }
+  // NV-DXVK end
   
 }
@@ -23,7 +23,9 @@
 
 #include <cstdint>
 #include <array>
+#include <atomic>
 #include <fstream>
+#include <memory>
 #include <string>
 
 #include "../thread.h"
@@ -39,11 +41,19 @@ namespace dxvk {
     None  = 5,
   };
 
+  // NV-DXVK start: asynchronous logging
+  class LogWriter;
+  // NV-DXVK end
+
   /**
    * \brief Logger
    * 
    * Logger for one DLL. Creates a text file and
    * writes all log messages to that file.
+   *
+   * Messages are queued and written in batches by a background
+   * thread, see \ref LogWriter. Errors are written synchronously,
+   * along with everything that was logged before them.
    */
   class Logger {
     
@@ -52,7 +62,9 @@ namespace dxvk {
     // NV-DXVK start: pass log level as param
     Logger(const std::string& fileName, const LogLevel logLevel = getMinLogLevel());
     // NV-DXVK end
-    ~Logger() = default;
+    // NV-DXVK start: asynchronous logging
+    ~Logger();
+    // NV-DXVK end
     
     // NV-DXVK start: special init pathway for remix logs
     static void initRtxLog();
@@ -64,6 +76,16 @@ namespace dxvk {
     static void warn (const std::string& message);
     static void err  (const std::string& message);
     static void log  (LogLevel level, const std::string& message);
+
+    // NV-DXVK start: asynchronous logging
+    /**
+     * \brief Writes all pending messages
+     *
+     * Call this before terminating the process abnormally,
+     * so that the messages leading up to it are not lost.
+     */
+    static void flush();
+    // NV-DXVK end
     
     static LogLevel logLevel() {
       return s_instance.m_minLevel;
@@ -80,8 +102,16 @@ namespace dxvk {
     
     dxvk::mutex   m_mutex;
     std::ofstream m_fileStream;
+
+    // NV-DXVK start: asynchronous logging
+    std::unique_ptr<LogWriter> m_writer;
+    // NV-DXVK end
     
     void emitMsg(LogLevel level, const std::string& message);
+
+    // NV-DXVK start: asynchronous logging
+    void writeBatch(const std::string& text);
+    // NV-DXVK end
     
     static LogLevel getMinLogLevel();
     static std::string getFilePath(const std::string& fileName);
@@ -89,5 +119,62 @@ namespace dxvk {
     Logger& operator=(Logger&& other);
 
   };
+
+  // NV-DXVK start: rate limited logging
+  /**
+   * \brief Log rate limiter
+   *
+   * Lets a limited number of messages through per time window and
+   * counts the rest, so that a message logged every frame cannot
+   * flood the log. Use \c LOG_RATE_LIMITED, which creates one
+   * limiter per call site. Errors are never rate limited.
+   */
+  class LogRateLimiter {
+
+  public:
+
+    constexpr static uint32_t MessagesPerWindow = 8;
+    constexpr static int64_t  WindowMs = 1000;
+
+    /**
+     * \brief Checks whether a message may be logged
+     *
+     * \param [out] suppressed Messages suppressed since
+     *    the last one that was let through
+     * \returns \c true if the message should be logged
+     */
+    bool allow(uint32_t& suppressed);
+
+    /**
+     * \brief Appends the number of suppressed messages
+     *
+     * \param [in] message Message to log
+     * \param [in] suppressed Suppressed message count
+     * \returns Message to log
+     */
+    static std::string annotate(std::string message, uint32_t suppressed);
+
+  private:
+
+    std::atomic<int64_t>  m_windowStart = { -WindowMs };
+    std::atomic<uint32_t> m_count       = { 0u };
+    std::atomic<uint32_t> m_suppressed  = { 0u };
+
+  };
+  // NV-DXVK end
   
 }
+
+// NV-DXVK start: rate limited logging
+// Logs a message at most LogRateLimiter::MessagesPerWindow times per window from this call site.
+// The message is only evaluated when it is actually logged. Errors always go through.
+#define LOG_RATE_LIMITED(level, message) do {                                                   \
+    static dxvk::LogRateLimiter s_logRateLimiter;                                               \
+    uint32_t logSuppressedCount = 0;                                                            \
+    if ((level) >= dxvk::LogLevel::Error)                                                       \
+      dxvk::Logger::log((level), (message));                                                    \
+    else if ((level) >= dxvk::Logger::logLevel() && s_logRateLimiter.allow(logSuppressedCount)) \
+      dxvk::Logger::log((level),                                                                \
+        dxvk::LogRateLimiter::annotate((message), logSuppressedCount));                         \
+  } while (0)
+// NV-DXVK end
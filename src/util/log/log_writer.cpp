@@ -0,0 +1,407 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "log_writer.h"
+#include "log.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <ctime>
+
+#include "../util_env.h"
+#include "../util_likely.h"
+#include "../util_string.h"
+
+namespace dxvk {
+
+  namespace {
+
+    struct RecordHeader {
+      uint64_t sequence;
+      int64_t  timestamp;
+      uint32_t level;
+      uint32_t size;
+    };
+
+    // Staging buffers of the current thread, one per writer it has logged to.
+    // Buffers are shared with their writer, so that whichever of the two goes
+    // away first does not free a buffer the other one still uses.
+    struct ThreadStagingBuffers {
+      std::vector<std::pair<uint64_t, std::shared_ptr<LogStagingBuffer>>> buffers;
+
+      ~ThreadStagingBuffers();
+    };
+
+    thread_local ThreadStagingBuffers t_stagingBuffers;
+
+    // Set once the buffers above are gone, e.g. when static objects
+    // log from their destructors after thread-local cleanup on exit
+    thread_local bool t_stagingBuffersDestroyed = false;
+
+    ThreadStagingBuffers::~ThreadStagingBuffers() {
+      for (const auto& entry : buffers)
+        entry.second->threadExited.store(true, std::memory_order_release);
+
+      t_stagingBuffersDestroyed = true;
+    }
+
+    std::atomic<uint64_t> g_writerId = { 0u };
+
+    void copyToRing(LogStagingBuffer& buffer, uint64_t pos, const void* src, size_t size) {
+      size_t index = size_t(pos) & buffer.mask;
+      size_t first = std::min(size, buffer.mask + 1 - index);
+
+      std::memcpy(&buffer.data[index], src, first);
+      std::memcpy(&buffer.data[0], reinterpret_cast<const char*>(src) + first, size - first);
+    }
+
+    void copyFromRing(const LogStagingBuffer& buffer, uint64_t pos, void* dst, size_t size) {
+      size_t index = size_t(pos) & buffer.mask;
+      size_t first = std::min(size, buffer.mask + 1 - index);
+
+      std::memcpy(dst, &buffer.data[index], first);
+      std::memcpy(reinterpret_cast<char*>(dst) + first, &buffer.data[0], size - first);
+    }
+
+    size_t getStagingBufferSize(size_t size) {
+      size_t result = 256;
+
+      while (result < size)
+        result *= 2;
+
+      return result;
+    }
+
+    int64_t getTimestamp() {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+  }
+
+
+  LogWriter::LogWriter(
+          Sink                      sink,
+          size_t                    stagingBufferSize,
+          std::chrono::milliseconds flushInterval)
+  : m_sink              (std::move(sink)),
+    m_stagingBufferSize (getStagingBufferSize(stagingBufferSize)),
+    m_flushInterval     (flushInterval),
+    m_writerId          (++g_writerId) {
+
+  }
+
+
+  LogWriter::~LogWriter() {
+    if (m_threadStarted.load()) {
+      { std::lock_guard<dxvk::mutex> lock(m_threadMutex);
+        m_stopped = true;
+      }
+
+      m_threadCond.notify_one();
+
+      // During process shutdown, the flush thread has already been
+      // terminated and may have been stopped while holding the drain
+      // lock, so don't wait for it and only drain if that is safe.
+      if (this_thread::isInModuleDetachment())
+        m_thread.detach();
+      else
+        m_thread.join();
+    }
+
+    std::unique_lock<dxvk::mutex> lock(m_drainMutex, std::try_to_lock);
+
+    if (lock)
+      drain();
+
+    std::lock_guard<dxvk::mutex> bufferLock(m_bufferMutex);
+
+    for (const auto& buffer : m_buffers)
+      buffer->writerExited.store(true, std::memory_order_release);
+  }
+
+
+  bool LogWriter::push(
+          LogLevel                  level,
+    const std::string&              message) {
+    if (unlikely(t_stagingBuffersDestroyed)) {
+      writeDirect(level, message);
+      return true;
+    }
+
+    LogStagingBuffer& buffer = getThreadBuffer();
+
+    if (unlikely(!m_threadStarted.load(std::memory_order_acquire)))
+      startThread();
+
+    size_t capacity = buffer.mask + 1;
+    size_t textSize = message.size();
+
+    // Draining the staging buffers first keeps this in order
+    // with everything the thread has pushed before.
+    if (unlikely(sizeof(RecordHeader) + textSize > capacity)) {
+      writeDirect(level, message);
+      return true;
+    }
+
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    uint64_t tail = buffer.tail.load(std::memory_order_acquire);
+
+    if (capacity - size_t(head - tail) < sizeof(RecordHeader) + textSize) {
+      buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    RecordHeader header;
+    header.sequence  = m_sequence.fetch_add(1, std::memory_order_relaxed);
+    header.timestamp = getTimestamp();
+    header.level     = uint32_t(level);
+    header.size      = uint32_t(textSize);
+
+    copyToRing(buffer, head, &header, sizeof(header));
+    copyToRing(buffer, head + sizeof(header), message.data(), textSize);
+
+    head += sizeof(header) + textSize;
+    buffer.head.store(head, std::memory_order_release);
+
+    // Wake the flush thread early rather than dropping messages
+    // when a thread produces a burst of output.
+    if (size_t(head - tail) > capacity / 2)
+      m_threadCond.notify_one();
+
+    return true;
+  }
+
+
+  void LogWriter::flush() {
+    std::lock_guard<dxvk::mutex> lock(m_drainMutex);
+    drain();
+  }
+
+
+  void LogWriter::writeDirect(
+          LogLevel                  level,
+    const std::string&              message) {
+    std::lock_guard<dxvk::mutex> lock(m_drainMutex);
+    drain();
+
+    Record record = { };
+    record.sequence   = m_sequence.fetch_add(1, std::memory_order_relaxed);
+    record.timestamp  = getTimestamp();
+    record.level      = level;
+    record.textSize   = uint32_t(message.size());
+
+    m_text = message;
+    m_batch.clear();
+
+    formatRecord(record);
+    m_sink(m_batch);
+  }
+
+
+  LogStagingBuffer& LogWriter::getThreadBuffer() {
+    auto& buffers = t_stagingBuffers.buffers;
+
+    for (const auto& entry : buffers) {
+      if (entry.first == m_writerId)
+        return *entry.second;
+    }
+
+    // Forget buffers of writers that no longer exist
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [] (const auto& entry) {
+      return entry.second->writerExited.load(std::memory_order_acquire);
+    }), buffers.end());
+
+    auto buffer = std::make_shared<LogStagingBuffer>(m_stagingBufferSize);
+
+    { std::lock_guard<dxvk::mutex> lock(m_bufferMutex);
+      m_buffers.push_back(buffer);
+    }
+
+    buffers.emplace_back(m_writerId, buffer);
+    return *buffer;
+  }
+
+
+  void LogWriter::startThread() {
+    std::lock_guard<dxvk::mutex> lock(m_threadMutex);
+
+    if (m_threadStarted.load(std::memory_order_relaxed) || m_stopped)
+      return;
+
+    m_thread = dxvk::thread([this] { runThread(); });
+    m_thread.set_priority(ThreadPriority::Lowest);
+
+    m_threadStarted.store(true, std::memory_order_release);
+  }
+
+
+  void LogWriter::runThread() {
+    env::setThreadName("dxvk-log");
+
+    std::unique_lock<dxvk::mutex> lock(m_threadMutex);
+
+    while (!m_stopped) {
+      m_threadCond.wait_for(lock, m_flushInterval);
+
+      lock.unlock();
+      flush();
+      lock.lock();
+    }
+  }
+
+
+  void LogWriter::drain() {
+    { std::lock_guard<dxvk::mutex> lock(m_bufferMutex);
+      m_drainBuffers = m_buffers;
+    }
+
+    m_records.clear();
+    m_text.clear();
+    m_batch.clear();
+
+    uint64_t dropped = 0;
+
+    for (const auto& buffer : m_drainBuffers) {
+      // Check this before reading, so that messages pushed
+      // right before the thread exited are not lost
+      bool retired = buffer->threadExited.load(std::memory_order_acquire);
+
+      readRecords(*buffer);
+      dropped += buffer->dropped.exchange(0, std::memory_order_relaxed);
+
+      if (retired) {
+        std::lock_guard<dxvk::mutex> lock(m_bufferMutex);
+        m_buffers.erase(std::find(m_buffers.begin(), m_buffers.end(), buffer));
+      }
+    }
+
+    m_drainBuffers.clear();
+
+    // Per-thread order is already guaranteed by the staging buffers,
+    // this only restores the order between messages of different threads.
+    std::sort(m_records.begin(), m_records.end(),
+      [] (const Record& a, const Record& b) { return a.sequence < b.sequence; });
+
+    for (const auto& record : m_records)
+      formatRecord(record);
+
+    if (dropped) {
+      m_droppedCount += dropped;
+
+      Record record = { };
+      record.timestamp  = getTimestamp();
+      record.level      = LogLevel::Warn;
+      record.textOffset = uint32_t(m_text.size());
+
+      m_text += str::format(dropped, " log message(s) dropped, staging buffer full");
+      record.textSize   = uint32_t(m_text.size() - record.textOffset);
+
+      formatRecord(record);
+    }
+
+    if (!m_batch.empty())
+      m_sink(m_batch);
+  }
+
+
+  void LogWriter::readRecords(
+          LogStagingBuffer&         buffer) {
+    uint64_t tail = buffer.tail.load(std::memory_order_relaxed);
+    uint64_t head = buffer.head.load(std::memory_order_acquire);
+
+    while (tail < head) {
+      RecordHeader header;
+      copyFromRing(buffer, tail, &header, sizeof(header));
+
+      Record record;
+      record.sequence   = header.sequence;
+      record.timestamp  = header.timestamp;
+      record.level      = LogLevel(header.level);
+      record.textOffset = uint32_t(m_text.size());
+      record.textSize   = header.size;
+
+      m_text.resize(m_text.size() + header.size);
+      copyFromRing(buffer, tail + sizeof(header), &m_text[record.textOffset], header.size);
+
+      m_records.push_back(record);
+      tail += sizeof(header) + header.size;
+    }
+
+    buffer.tail.store(tail, std::memory_order_release);
+  }
+
+
+  void LogWriter::formatRecord(
+    const Record&                   record) {
+    constexpr std::array<const char*, 5> s_prefixes{
+      "trace: ",
+      "debug: ",
+      "info:  ",
+      "warn:  ",
+      "err:   ",
+    };
+
+    // [HH:MM:SS.MS]
+    int64_t second = record.timestamp / 1000;
+
+    if (second != m_cachedSecond) {
+      std::time_t time = std::time_t(second);
+      std::tm lt = { };
+
+#ifdef _WIN32
+      localtime_s(&lt, &time);
+#else
+      localtime_r(&time, &lt);
+#endif
+
+      std::snprintf(m_cachedTime, sizeof(m_cachedTime), "[%02d:%02d:%02d.",
+        lt.tm_hour, lt.tm_min, lt.tm_sec);
+      m_cachedSecond = second;
+    }
+
+    char timeString[32];
+    std::snprintf(timeString, sizeof(timeString), "%s%03d] ",
+      m_cachedTime, int(record.timestamp % 1000));
+
+    const char* prefix = s_prefixes[std::min(uint32_t(record.level), uint32_t(LogLevel::Error))];
+
+    // Same line splitting as std::getline, i.e. a trailing
+    // newline does not produce an additional empty line
+    size_t pos = record.textOffset;
+    size_t end = record.textOffset + record.textSize;
+
+    while (pos < end) {
+      auto newline = reinterpret_cast<const char*>(std::memchr(&m_text[pos], '\n', end - pos));
+      size_t next = newline ? size_t(newline - m_text.data()) : end;
+
+      m_batch.append(timeString);
+      m_batch.append(prefix);
+      m_batch.append(m_text, pos, next - pos);
+      m_batch.push_back('\n');
+
+      pos = next + 1;
+    }
+  }
+
+}
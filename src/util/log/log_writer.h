@@ -0,0 +1,196 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../thread.h"
+#include "../util_math.h"
+
+namespace dxvk {
+
+  enum class LogLevel : std::uint32_t;
+
+  /**
+   * \brief Per-thread log staging buffer
+   *
+   * Single-producer, single-consumer byte ring. The owning thread appends
+   * records, and whoever holds the writer's drain lock consumes them.
+   */
+  struct LogStagingBuffer {
+    LogStagingBuffer(size_t capacity)
+    : data(new char[capacity]), mask(capacity - 1) { }
+
+    std::unique_ptr<char[]> data;
+    size_t                  mask;
+
+    alignas(CACHE_LINE_SIZE)
+    std::atomic<uint64_t>   head          = { 0u };
+    std::atomic<uint64_t>   dropped       = { 0u };
+
+    alignas(CACHE_LINE_SIZE)
+    std::atomic<uint64_t>   tail          = { 0u };
+
+    std::atomic<bool>       threadExited  = { false };
+    std::atomic<bool>       writerExited  = { false };
+  };
+
+
+  /**
+   * \brief Asynchronous log writer
+   *
+   * Logging threads format nothing and take no locks: a message is copied into
+   * a staging buffer owned by the calling thread, and a background thread
+   * periodically collects the messages of all threads, orders them, formats
+   * them and passes them to the sink in one batch.
+   *
+   * Staging buffers have a fixed size. If a thread logs faster than the flush
+   * thread drains its buffer, further messages are dropped and counted, and the
+   * number of dropped messages is reported in the log with the next batch.
+   */
+  class LogWriter {
+
+  public:
+
+    /// Receives a batch of formatted, newline-terminated lines
+    using Sink = std::function<void (const std::string&)>;
+
+    constexpr static size_t DefaultStagingBufferSize = 64u << 10;
+    constexpr static std::chrono::milliseconds DefaultFlushInterval = std::chrono::milliseconds(50);
+
+    /**
+     * \brief Creates a log writer
+     *
+     * The flush thread is only started once the first message is pushed.
+     * \param [in] sink Output for formatted lines
+     * \param [in] stagingBufferSize Staging buffer size per thread, rounded up to a power of two
+     * \param [in] flushInterval Time between two batches
+     */
+    LogWriter(
+            Sink                      sink,
+            size_t                    stagingBufferSize = DefaultStagingBufferSize,
+            std::chrono::milliseconds flushInterval = DefaultFlushInterval);
+
+    /**
+     * \brief Stops the flush thread and writes all pending messages
+     */
+    ~LogWriter();
+
+    LogWriter(const LogWriter&) = delete;
+    LogWriter& operator = (const LogWriter&) = delete;
+
+    /**
+     * \brief Queues a message
+     *
+     * Messages from one thread are always written in the order
+     * they were pushed. Messages that can never fit into the
+     * staging buffer are written synchronously instead.
+     * \param [in] level Log level
+     * \param [in] message Message, may consist of multiple lines
+     * \returns \c false if the message was dropped
+     */
+    bool push(
+            LogLevel                  level,
+      const std::string&              message);
+
+    /**
+     * \brief Writes all pending messages
+     *
+     * Blocks until every message pushed before the call, by any
+     * thread, has been passed to the sink. Does not wait for the
+     * flush thread, so this is safe to use from error handlers.
+     */
+    void flush();
+
+    /**
+     * \brief Number of messages dropped so far
+     *
+     * Only includes drops that have been reported in the log.
+     * \returns Dropped message count
+     */
+    uint64_t droppedCount() const {
+      return m_droppedCount.load();
+    }
+
+  private:
+
+    struct Record {
+      uint64_t  sequence;
+      int64_t   timestamp;
+      LogLevel  level;
+      uint32_t  textOffset;
+      uint32_t  textSize;
+    };
+
+    Sink                      m_sink;
+    size_t                    m_stagingBufferSize;
+    std::chrono::milliseconds m_flushInterval;
+    uint64_t                  m_writerId;
+
+    std::atomic<uint64_t>     m_sequence      = { 0u };
+    std::atomic<uint64_t>     m_droppedCount  = { 0u };
+
+    dxvk::mutex               m_bufferMutex;
+    std::vector<std::shared_ptr<LogStagingBuffer>> m_buffers;
+
+    dxvk::mutex               m_drainMutex;
+    std::vector<std::shared_ptr<LogStagingBuffer>> m_drainBuffers;
+    std::vector<Record>       m_records;
+    std::string               m_text;
+    std::string               m_batch;
+    int64_t                   m_cachedSecond  = -1;
+    char                      m_cachedTime[16] = { };
+
+    dxvk::mutex               m_threadMutex;
+    dxvk::condition_variable  m_threadCond;
+    std::atomic<bool>         m_threadStarted = { false };
+    bool                      m_stopped       = false;
+    dxvk::thread              m_thread;
+
+    void writeDirect(
+            LogLevel                  level,
+      const std::string&              message);
+
+    LogStagingBuffer& getThreadBuffer();
+
+    void startThread();
+
+    void runThread();
+
+    void drain();
+
+    void readRecords(
+            LogStagingBuffer&         buffer);
+
+    void formatRecord(
+      const Record&                   record);
+
+  };
+
+}
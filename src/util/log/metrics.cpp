@@ -28,6 +28,9 @@
 namespace dxvk {
   
   Metrics::Metrics() {
+    for (uint32_t i = 0; i < Metric::kCount; i++)
+      m_gauges[i] = MetricsRegistry::get().registerGauge(m_metricNames[i]);
+
     auto path = getFileName();
 
     if (!path.empty())
@@ -38,20 +41,22 @@ namespace dxvk {
 
   void Metrics::logRollingAverage(Metric metric, const float& value) {
     std::lock_guard<dxvk::mutex> lock(s_instance.m_mutex);
-    const float& oldValue = s_instance.m_data[metric];
+    const MetricGauge& gauge = s_instance.m_gauges[metric];
+    const float oldValue = float(gauge.get());
 
     const uint32_t kRollingAvgWindow = 30;
-    s_instance.m_data[metric] = lerp(oldValue, value, 1.f / kRollingAvgWindow);
+    gauge.set(lerp(oldValue, value, 1.f / kRollingAvgWindow));
   }
 
   void Metrics::logFloat(Metric metric, const float& value) {
-    std::lock_guard<dxvk::mutex> lock(s_instance.m_mutex);
-    s_instance.m_data[metric] = value;
+    s_instance.m_gauges[metric].set(value);
   }
   
   void Metrics::serialize() {
     for(uint32_t i=0 ; i<Metric::kCount ; i++)
-      s_instance.emitMsg((Metric)i, s_instance.m_data[i]);
+      s_instance.emitMsg((Metric)i, float(s_instance.m_gauges[i].get()));
+
+    MetricsRegistry::get().exportSnapshot(std::filesystem::path());
   }
 
   template<typename T>
@@ -30,6 +30,8 @@
 
 #include "../thread.h"
 
+#include "metrics_registry.h"
+
 namespace dxvk {
   enum Metric {
     dxvk_average_frame_time_ms = 0,  // In milliseconds
@@ -47,6 +49,9 @@ namespace dxvk {
    * 
    * Metrics for one DLL. Creates a text file and
    * writes all metrics messages to that file.
+   *
+   * The values are stored as gauges in the \ref MetricsRegistry,
+   * so they are also part of its snapshots.
    */
   class Metrics {
   public:
@@ -71,7 +76,7 @@ namespace dxvk {
 
     static_assert(std::size(m_metricNames) == kCount, "m_metricNames must have an entry for every Metric enum value");
 
-    std::array<float, Metric::kCount> m_data = {};
+    std::array<MetricGauge, Metric::kCount> m_gauges;
 
     static Metrics s_instance;
     
@@ -0,0 +1,559 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "metrics_registry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+#include "log.h"
+#include "../util_env.h"
+#include "../util_filesys.h"
+#include "../util_string.h"
+
+namespace dxvk {
+
+  namespace {
+
+    const char* getTypeName(MetricType type) {
+      switch (type) {
+        case MetricType::Counter:   return "counter";
+        case MetricType::Gauge:     return "gauge";
+        case MetricType::Histogram: return "histogram";
+      }
+
+      return "unknown";
+    }
+
+    void writeJsonNumber(std::ostream& stream, double value) {
+      if (std::isfinite(value))
+        stream << value;
+      else
+        stream << "null";
+    }
+
+    void writeJsonString(std::ostream& stream, const std::string& value) {
+      stream << '"';
+
+      for (char c : value) {
+        if (c == '"' || c == '\\')
+          stream << '\\' << c;
+        else if (uint8_t(c) < 0x20)
+          stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << uint32_t(c) << std::dec << std::setfill(' ');
+        else
+          stream << c;
+      }
+
+      stream << '"';
+    }
+
+    std::chrono::seconds getExportIntervalFromEnv() {
+      const std::string value = env::getEnvVar("DXVK_METRICS_SNAPSHOT_INTERVAL");
+
+      if (value.empty())
+        return std::chrono::seconds(0);
+
+      try {
+        return std::chrono::seconds(std::max(0, std::stoi(value)));
+      } catch (...) {
+        Logger::warn(str::format("Metrics: invalid snapshot interval: ", value));
+        return std::chrono::seconds(0);
+      }
+    }
+
+  }
+
+
+  double MetricBuckets::getLowerBound(uint32_t bucket) {
+    uint32_t index = bucket - 1;
+
+    int32_t exponent = MinExponent + int32_t(index / SubBuckets);
+    uint32_t subBucket = index % SubBuckets;
+
+    return std::ldexp(1.0 + double(subBucket) / double(SubBuckets), exponent);
+  }
+
+
+  void MetricHistogram::add(double value) {
+    min = count ? std::min(min, value) : value;
+    max = count ? std::max(max, value) : value;
+
+    buckets[MetricBuckets::getBucket(value)] += 1;
+    count += 1;
+    sum += value;
+  }
+
+
+  void MetricHistogram::merge(const MetricHistogram& other) {
+    if (!other.count)
+      return;
+
+    min = count ? std::min(min, other.min) : other.min;
+    max = count ? std::max(max, other.max) : other.max;
+
+    for (uint32_t i = 0; i < MetricBuckets::Count; i++)
+      buckets[i] += other.buckets[i];
+
+    count += other.count;
+    sum += other.sum;
+  }
+
+
+  double MetricHistogram::getPercentile(double percentile) const {
+    if (!count)
+      return 0.0;
+
+    uint64_t target = std::max<uint64_t>(1, uint64_t(std::ceil(percentile * double(count))));
+    uint64_t cumulative = 0;
+
+    for (uint32_t i = 0; i < MetricBuckets::Count; i++) {
+      cumulative += buckets[i];
+
+      if (cumulative >= target) {
+        double upperBound = i + 1 < MetricBuckets::Count
+          ? MetricBuckets::getLowerBound(i + 1)
+          : max;
+
+        return std::clamp(upperBound, min, max);
+      }
+    }
+
+    return max;
+  }
+
+
+  void MetricsSnapshot::writeJson(std::ostream& stream) const {
+    const auto flags = stream.flags();
+    const auto precision = stream.precision(9);
+
+    stream << "{\n  \"frameCount\": " << frameCount
+           << ",\n  \"timeSeconds\": ";
+    writeJsonNumber(stream, timeSeconds);
+    stream << ",\n  \"metrics\": [";
+
+    for (size_t i = 0; i < entries.size(); i++) {
+      const Entry& entry = entries[i];
+
+      stream << (i ? ",\n    { \"name\": " : "\n    { \"name\": ");
+      writeJsonString(stream, entry.name);
+      stream << ", \"type\": \"" << getTypeName(entry.type) << "\"";
+
+      if (entry.type != MetricType::Histogram) {
+        stream << ", \"value\": ";
+        writeJsonNumber(stream, entry.value);
+      }
+
+      if (entry.type == MetricType::Counter) {
+        stream << ", \"lastFrame\": ";
+        writeJsonNumber(stream, entry.lastFrame);
+      }
+
+      if (entry.type != MetricType::Gauge) {
+        const MetricHistogram& h = entry.histogram;
+
+        stream << ", \"count\": " << h.count << ", \"sum\": ";
+        writeJsonNumber(stream, h.sum);
+        stream << ", \"min\": ";
+        writeJsonNumber(stream, h.min);
+        stream << ", \"max\": ";
+        writeJsonNumber(stream, h.max);
+        stream << ", \"mean\": ";
+        writeJsonNumber(stream, h.count ? h.sum / double(h.count) : 0.0);
+        stream << ", \"p50\": ";
+        writeJsonNumber(stream, h.getPercentile(0.5));
+        stream << ", \"p90\": ";
+        writeJsonNumber(stream, h.getPercentile(0.9));
+        stream << ", \"p99\": ";
+        writeJsonNumber(stream, h.getPercentile(0.99));
+      }
+
+      stream << " }";
+    }
+
+    stream << (entries.empty() ? "]\n}\n" : "\n  ]\n}\n");
+
+    stream.precision(precision);
+    stream.flags(flags);
+  }
+
+
+  void MetricsSnapshot::writeCsv(std::ostream& stream, bool writeHeader) const {
+    const auto flags = stream.flags();
+    const auto precision = stream.precision(9);
+
+    if (writeHeader)
+      stream << "time_s,frame,name,type,value,last_frame,count,sum,min,max,mean,p50,p90,p99\n";
+
+    for (const Entry& entry : entries) {
+      stream << timeSeconds << ',' << frameCount << ',' << entry.name << ',' << getTypeName(entry.type) << ',';
+
+      if (entry.type != MetricType::Histogram)
+        stream << entry.value;
+
+      stream << ',';
+
+      if (entry.type == MetricType::Counter)
+        stream << entry.lastFrame;
+
+      if (entry.type != MetricType::Gauge) {
+        const MetricHistogram& h = entry.histogram;
+
+        stream << ',' << h.count
+               << ',' << h.sum
+               << ',' << h.min
+               << ',' << h.max
+               << ',' << (h.count ? h.sum / double(h.count) : 0.0)
+               << ',' << h.getPercentile(0.5)
+               << ',' << h.getPercentile(0.9)
+               << ',' << h.getPercentile(0.99) << '\n';
+      } else {
+        stream << ",,,,,,,,\n";
+      }
+    }
+
+    stream.precision(precision);
+    stream.flags(flags);
+  }
+
+
+  struct MetricsRegistry::ThreadShardRef {
+    std::shared_ptr<Shard> shard;
+
+    ~ThreadShardRef() {
+      if (shard)
+        shard->threadExited.store(true, std::memory_order_release);
+
+      s_threadShard = nullptr;
+      s_threadShardReleased = true;
+    }
+  };
+
+
+  thread_local MetricsRegistry::Shard*          MetricsRegistry::s_threadShard = nullptr;
+  thread_local bool                             MetricsRegistry::s_threadShardReleased = false;
+  thread_local MetricsRegistry::ThreadShardRef  MetricsRegistry::s_threadShardRef;
+
+
+  MetricsRegistry::Shard::~Shard() {
+    for (auto& histogram : histograms)
+      delete histogram.load();
+  }
+
+
+  MetricsRegistry& MetricsRegistry::get() {
+    static MetricsRegistry s_registry;
+    return s_registry;
+  }
+
+
+  MetricsRegistry::MetricsRegistry()
+  : m_startTime     (std::chrono::steady_clock::now()),
+    m_lastExport    (m_startTime),
+    m_exportInterval(getExportIntervalFromEnv()) {
+
+  }
+
+
+  MetricsRegistry::~MetricsRegistry() {
+
+  }
+
+
+  MetricCounter MetricsRegistry::registerCounter(const std::string& name) {
+    std::lock_guard<dxvk::mutex> lock(m_registerMutex);
+
+    for (const auto& metric : m_metrics) {
+      if (metric.name == name)
+        return MetricCounter(metric.type == MetricType::Counter ? metric.id : ~0u);
+    }
+
+    if (m_counterCount == MaxCounters) {
+      Logger::warn(str::format("Metrics: too many counters, ignoring ", name));
+      return MetricCounter();
+    }
+
+    m_metrics.push_back({ name, MetricType::Counter, m_counterCount });
+    return MetricCounter(m_counterCount++);
+  }
+
+
+  MetricGauge MetricsRegistry::registerGauge(const std::string& name) {
+    std::lock_guard<dxvk::mutex> lock(m_registerMutex);
+
+    for (const auto& metric : m_metrics) {
+      if (metric.name == name)
+        return MetricGauge(metric.type == MetricType::Gauge ? metric.id : ~0u);
+    }
+
+    if (m_gaugeCount == MaxGauges) {
+      Logger::warn(str::format("Metrics: too many gauges, ignoring ", name));
+      return MetricGauge();
+    }
+
+    m_metrics.push_back({ name, MetricType::Gauge, m_gaugeCount });
+    return MetricGauge(m_gaugeCount++);
+  }
+
+
+  MetricHistogramRecorder MetricsRegistry::registerHistogram(const std::string& name) {
+    std::lock_guard<dxvk::mutex> lock(m_registerMutex);
+
+    for (const auto& metric : m_metrics) {
+      if (metric.name == name)
+        return MetricHistogramRecorder(metric.type == MetricType::Histogram ? metric.id : ~0u);
+    }
+
+    if (m_histogramCount == MaxHistograms) {
+      Logger::warn(str::format("Metrics: too many histograms, ignoring ", name));
+      return MetricHistogramRecorder();
+    }
+
+    m_metrics.push_back({ name, MetricType::Histogram, m_histogramCount });
+    return MetricHistogramRecorder(m_histogramCount++);
+  }
+
+
+  void MetricsRegistry::endFrame() {
+    std::unique_lock<dxvk::mutex> lock(m_mergeMutex);
+
+    uint32_t counterCount;
+    uint32_t histogramCount;
+
+    { std::lock_guard<dxvk::mutex> registerLock(m_registerMutex);
+      counterCount = m_counterCount;
+      histogramCount = m_histogramCount;
+    }
+
+    m_retiredHistograms.resize(histogramCount);
+    m_counterHistograms.resize(counterCount);
+    m_histograms.assign(histogramCount, MetricHistogram());
+
+    std::vector<std::shared_ptr<Shard>> shards;
+
+    { std::lock_guard<dxvk::mutex> shardLock(m_shardMutex);
+      shards = m_shards;
+    }
+
+    // Fold shards of exited threads into the retired totals, their values are final once the exit flag
+    // is visible. The flag is read exactly once per shard, so that a thread exiting during this loop
+    // either has its shard folded and removed, or keeps it live until the next frame.
+    size_t numLiveShards = 0;
+
+    for (size_t n = 0; n < shards.size(); n++) {
+      const std::shared_ptr<Shard>& shard = shards[n];
+
+      if (!shard->threadExited.load(std::memory_order_acquire)) {
+        if (n != numLiveShards)
+          shards[numLiveShards] = shard;
+
+        numLiveShards += 1;
+        continue;
+      }
+
+      for (uint32_t i = 0; i < counterCount; i++)
+        m_retiredCounters[i] += shard->counters[i].load(std::memory_order_relaxed);
+
+      for (uint32_t i = 0; i < histogramCount; i++) {
+        if (auto histogram = shard->histograms[i].load(std::memory_order_acquire))
+          mergeHistogram(m_retiredHistograms[i], *histogram);
+      }
+
+      std::lock_guard<dxvk::mutex> shardLock(m_shardMutex);
+      m_shards.erase(std::find(m_shards.begin(), m_shards.end(), shard));
+    }
+
+    shards.resize(numLiveShards);
+
+    for (uint32_t i = 0; i < counterCount; i++) {
+      uint64_t total = m_retiredCounters[i];
+
+      for (const auto& shard : shards)
+        total += shard->counters[i].load(std::memory_order_relaxed);
+
+      m_counterLastFrame[i] = total - m_counterTotals[i];
+      m_counterTotals[i] = total;
+      m_counterHistograms[i].add(double(m_counterLastFrame[i]));
+    }
+
+    for (uint32_t i = 0; i < histogramCount; i++) {
+      m_histograms[i] = m_retiredHistograms[i];
+
+      for (const auto& shard : shards) {
+        if (auto histogram = shard->histograms[i].load(std::memory_order_acquire))
+          mergeHistogram(m_histograms[i], *histogram);
+      }
+    }
+
+    m_frameCount += 1;
+
+    auto now = std::chrono::steady_clock::now();
+
+    if (m_exportInterval.count() && now - m_lastExport >= m_exportInterval) {
+      m_lastExport = now;
+
+      std::filesystem::path directory = m_exportDirectory;
+      lock.unlock();
+
+      exportSnapshot(directory);
+    }
+  }
+
+
+  MetricsSnapshot MetricsRegistry::getSnapshot() {
+    std::lock_guard<dxvk::mutex> lock(m_mergeMutex);
+    return buildSnapshot();
+  }
+
+
+  MetricsSnapshot MetricsRegistry::buildSnapshot() {
+    MetricsSnapshot snapshot;
+    snapshot.frameCount = m_frameCount;
+    snapshot.timeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+
+    std::lock_guard<dxvk::mutex> lock(m_registerMutex);
+    snapshot.entries.reserve(m_metrics.size());
+
+    for (const auto& metric : m_metrics) {
+      MetricsSnapshot::Entry entry;
+      entry.name = metric.name;
+      entry.type = metric.type;
+
+      switch (metric.type) {
+        case MetricType::Counter:
+          // Counters registered after the last merge have no data yet
+          if (metric.id < m_counterHistograms.size()) {
+            entry.value = double(m_counterTotals[metric.id]);
+            entry.lastFrame = double(m_counterLastFrame[metric.id]);
+            entry.histogram = m_counterHistograms[metric.id];
+          }
+          break;
+
+        case MetricType::Gauge:
+          entry.value = m_gauges[metric.id].load(std::memory_order_relaxed);
+          break;
+
+        case MetricType::Histogram:
+          if (metric.id < m_histograms.size())
+            entry.histogram = m_histograms[metric.id];
+          break;
+      }
+
+      snapshot.entries.push_back(std::move(entry));
+    }
+
+    return snapshot;
+  }
+
+
+  void MetricsRegistry::exportSnapshot(const std::filesystem::path& directory) {
+    MetricsSnapshot snapshot = getSnapshot();
+
+    std::filesystem::path path = directory.empty()
+      ? std::filesystem::path(util::RtxFileSys::path(util::RtxFileSys::Logs))
+      : directory;
+
+    std::error_code ec;
+
+    if (!path.empty())
+      std::filesystem::create_directories(path, ec);
+
+    std::lock_guard<dxvk::mutex> lock(m_exportMutex);
+
+    std::ofstream json(path / "metrics.json", std::ios::trunc);
+
+    if (json)
+      snapshot.writeJson(json);
+
+    // The CSV file collects every snapshot of this process
+    std::ofstream csv(path / "metrics.csv", m_csvHeaderWritten ? std::ios::app : std::ios::trunc);
+
+    if (csv) {
+      snapshot.writeCsv(csv, !m_csvHeaderWritten);
+      m_csvHeaderWritten = true;
+    }
+  }
+
+
+  void MetricsRegistry::setExportInterval(
+          std::chrono::seconds      interval,
+    const std::filesystem::path&    directory) {
+    std::lock_guard<dxvk::mutex> lock(m_mergeMutex);
+    m_exportInterval = interval;
+    m_exportDirectory = directory;
+  }
+
+
+  MetricsRegistry::Shard& MetricsRegistry::createThreadShard() {
+    if (s_threadShardReleased)
+      return m_discardShard;
+
+    auto shard = std::make_shared<Shard>();
+
+    { std::lock_guard<dxvk::mutex> lock(m_shardMutex);
+      m_shards.push_back(shard);
+    }
+
+    s_threadShardRef.shard = shard;
+    s_threadShard = shard.get();
+    return *shard;
+  }
+
+
+  MetricsRegistry::HistogramShard& MetricsRegistry::createHistogramShard(Shard& shard, uint32_t id) {
+    // Only contended for the discard shard, which several exiting threads may share
+    HistogramShard* expected = nullptr;
+    HistogramShard* histogram = new HistogramShard();
+
+    if (!shard.histograms[id].compare_exchange_strong(expected, histogram, std::memory_order_release, std::memory_order_acquire)) {
+      delete histogram;
+      return *expected;
+    }
+
+    return *histogram;
+  }
+
+
+  void MetricsRegistry::mergeHistogram(MetricHistogram& dst, const HistogramShard& src) {
+    MetricHistogram histogram;
+
+    // The count is published last, read it first so
+    // that min, max and sum are at least as recent
+    uint64_t count = src.count.load(std::memory_order_acquire);
+
+    if (!count)
+      return;
+
+    histogram.sum = src.sum.load(std::memory_order_relaxed);
+    histogram.min = src.min.load(std::memory_order_relaxed);
+    histogram.max = src.max.load(std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < MetricBuckets::Count; i++) {
+      histogram.buckets[i] = src.buckets[i].load(std::memory_order_relaxed);
+      histogram.count += histogram.buckets[i];
+    }
+
+    dst.merge(histogram);
+  }
+
+}
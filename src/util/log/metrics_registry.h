@@ -0,0 +1,418 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../thread.h"
+#include "../util_likely.h"
+
+namespace dxvk {
+
+  enum class MetricType : uint32_t {
+    Counter,
+    Gauge,
+    Histogram,
+  };
+
+
+  /**
+   * \brief Log-scale histogram buckets
+   *
+   * Each power of two between \c 2^MinExponent and \c 2^MaxExponent is split
+   * into \c SubBuckets linear buckets, so the bucket of a value is taken
+   * straight from its floating point exponent and top mantissa bits, and
+   * the relative error of a bucket is at most 1 / SubBuckets. Bucket 0
+   * holds all values below the range, including zero and negative values,
+   * and the last bucket holds all values above it.
+   */
+  struct MetricBuckets {
+    constexpr static int32_t  MinExponent = -10;
+    constexpr static int32_t  MaxExponent = 32;
+    constexpr static uint32_t SubBucketBits = 3;
+    constexpr static uint32_t SubBuckets = 1u << SubBucketBits;
+    constexpr static uint32_t Count = uint32_t(MaxExponent - MinExponent) * SubBuckets + 2;
+
+    static uint32_t getBucket(double value) {
+      uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+
+      // Negative values go to the first bucket, infinities and NaNs to the last
+      if (bits >> 63)
+        return 0;
+
+      int32_t exponent = int32_t(bits >> 52) - 1023;
+
+      if (exponent < MinExponent)
+        return 0;
+
+      if (exponent >= MaxExponent)
+        return Count - 1;
+
+      uint32_t subBucket = uint32_t(bits >> (52 - SubBucketBits)) & (SubBuckets - 1);
+      return uint32_t(exponent - MinExponent) * SubBuckets + subBucket + 1;
+    }
+
+    /**
+     * \brief Smallest value that falls into a bucket
+     * \param [in] bucket Bucket index, must not be 0
+     * \returns Lower bound of the bucket
+     */
+    static double getLowerBound(uint32_t bucket);
+  };
+
+
+  /**
+   * \brief Merged histogram
+   */
+  struct MetricHistogram {
+    uint64_t  count = 0;
+    double    sum   = 0.0;
+    double    min   = 0.0;
+    double    max   = 0.0;
+    std::array<uint64_t, MetricBuckets::Count> buckets = { };
+
+    void add(double value);
+
+    void merge(const MetricHistogram& other);
+
+    /**
+     * \brief Estimates a percentile
+     *
+     * Returns the upper bound of the bucket containing the
+     * percentile, clamped to the recorded value range.
+     * \param [in] percentile Percentile, between 0 and 1
+     * \returns Estimated value
+     */
+    double getPercentile(double percentile) const;
+  };
+
+
+  /**
+   * \brief Metrics snapshot
+   *
+   * State of all metrics as of the last merge. For counters, the
+   * histogram holds the distribution of their per-frame increments.
+   */
+  struct MetricsSnapshot {
+    struct Entry {
+      std::string     name;
+      MetricType      type;
+      double          value     = 0.0;
+      double          lastFrame = 0.0;
+      MetricHistogram histogram;
+    };
+
+    uint64_t            frameCount  = 0;
+    double              timeSeconds = 0.0;
+    std::vector<Entry>  entries;
+
+    void writeJson(std::ostream& stream) const;
+
+    void writeCsv(std::ostream& stream, bool writeHeader) const;
+  };
+
+
+  class MetricsRegistry;
+
+  /**
+   * \brief Counter handle
+   *
+   * Counts events. Adding to a counter only
+   * touches memory owned by the calling thread.
+   */
+  class MetricCounter {
+    friend class MetricsRegistry;
+  public:
+    MetricCounter() = default;
+
+    inline void add(uint64_t value = 1) const;
+
+    bool isValid() const {
+      return m_id != ~0u;
+    }
+
+  private:
+    explicit MetricCounter(uint32_t id) : m_id(id) { }
+    uint32_t m_id = ~0u;
+  };
+
+
+  /**
+   * \brief Gauge handle
+   *
+   * Holds the last value that was set.
+   */
+  class MetricGauge {
+    friend class MetricsRegistry;
+  public:
+    MetricGauge() = default;
+
+    inline void set(double value) const;
+
+    inline double get() const;
+
+    bool isValid() const {
+      return m_id != ~0u;
+    }
+
+  private:
+    explicit MetricGauge(uint32_t id) : m_id(id) { }
+    uint32_t m_id = ~0u;
+  };
+
+
+  /**
+   * \brief Histogram handle
+   *
+   * Records a distribution of values, e.g. timings. Like
+   * counters, values are recorded into per-thread shards.
+   */
+  class MetricHistogramRecorder {
+    friend class MetricsRegistry;
+  public:
+    MetricHistogramRecorder() = default;
+
+    inline void record(double value) const;
+
+    bool isValid() const {
+      return m_id != ~0u;
+    }
+
+  private:
+    explicit MetricHistogramRecorder(uint32_t id) : m_id(id) { }
+    uint32_t m_id = ~0u;
+  };
+
+
+  /**
+   * \brief Metrics registry
+   *
+   * Named counters, gauges and histograms for one DLL. Metrics are registered
+   * once, usually into a static handle, and recorded without locks: every
+   * thread writes into its own shard, and the shards are only merged into a
+   * snapshot at the end of a frame. The snapshot can be exported as JSON and
+   * CSV, periodically if \c DXVK_METRICS_SNAPSHOT_INTERVAL is set to a number
+   * of seconds.
+   */
+  class MetricsRegistry {
+    friend class MetricCounter;
+    friend class MetricGauge;
+    friend class MetricHistogramRecorder;
+  public:
+
+    constexpr static uint32_t MaxCounters   = 256;
+    constexpr static uint32_t MaxGauges     = 64;
+    constexpr static uint32_t MaxHistograms = 64;
+
+    static MetricsRegistry& get();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator = (const MetricsRegistry&) = delete;
+
+    /**
+     * \brief Registers a metric
+     *
+     * Registering an existing name returns the existing metric. If the
+     * registry is full, the returned handle is invalid and records nothing.
+     * \param [in] name Metric name, including its unit
+     * \returns Metric handle
+     */
+    MetricCounter registerCounter(const std::string& name);
+    MetricGauge registerGauge(const std::string& name);
+    MetricHistogramRecorder registerHistogram(const std::string& name);
+
+    /**
+     * \brief Merges all shards
+     *
+     * Call once per frame. Updates the snapshot, records the per-frame
+     * increment of every counter, and exports the snapshot if the
+     * export interval has elapsed.
+     */
+    void endFrame();
+
+    /**
+     * \brief Retrieves the state as of the last merge
+     * \returns Snapshot, with current gauge values
+     */
+    MetricsSnapshot getSnapshot();
+
+    /**
+     * \brief Writes the current snapshot
+     *
+     * Overwrites \c metrics.json and appends to \c metrics.csv.
+     * \param [in] directory Output directory
+     */
+    void exportSnapshot(const std::filesystem::path& directory);
+
+    /**
+     * \brief Sets the periodic export interval
+     * \param [in] interval Interval, zero disables periodic export
+     * \param [in] directory Output directory
+     */
+    void setExportInterval(
+            std::chrono::seconds      interval,
+      const std::filesystem::path&    directory);
+
+  private:
+
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    struct HistogramShard {
+      std::array<std::atomic<uint64_t>, MetricBuckets::Count> buckets = { };
+      std::atomic<uint64_t> count = { 0u };
+      std::atomic<double>   sum   = { 0.0 };
+      std::atomic<double>   min   = { 0.0 };
+      std::atomic<double>   max   = { 0.0 };
+    };
+
+    struct Shard {
+      ~Shard();
+
+      std::array<std::atomic<uint64_t>, MaxCounters> counters = { };
+      std::array<std::atomic<HistogramShard*>, MaxHistograms> histograms = { };
+      std::atomic<bool> threadExited = { false };
+    };
+
+    struct Metric {
+      std::string name;
+      MetricType  type;
+      uint32_t    id;
+    };
+
+    dxvk::mutex                         m_registerMutex;
+    std::vector<Metric>                 m_metrics;
+    uint32_t                            m_counterCount   = 0;
+    uint32_t                            m_gaugeCount     = 0;
+    uint32_t                            m_histogramCount = 0;
+
+    std::array<std::atomic<double>, MaxGauges> m_gauges = { };
+
+    dxvk::mutex                         m_shardMutex;
+    std::vector<std::shared_ptr<Shard>> m_shards;
+
+    dxvk::mutex                         m_mergeMutex;
+    std::array<uint64_t, MaxCounters>   m_retiredCounters = { };
+    std::vector<MetricHistogram>        m_retiredHistograms;
+    std::array<uint64_t, MaxCounters>   m_counterTotals = { };
+    std::array<uint64_t, MaxCounters>   m_counterLastFrame = { };
+    std::vector<MetricHistogram>        m_counterHistograms;
+    std::vector<MetricHistogram>        m_histograms;
+    uint64_t                            m_frameCount = 0;
+
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::steady_clock::time_point m_lastExport;
+    std::chrono::seconds                  m_exportInterval = std::chrono::seconds(0);
+    std::filesystem::path                 m_exportDirectory;
+
+    dxvk::mutex                           m_exportMutex;
+    bool                                  m_csvHeaderWritten = false;
+
+    // Written to by threads that record while exiting,
+    // after their own shard has been released. Never merged.
+    Shard                                 m_discardShard;
+
+    static Shard& getThreadShard() {
+      Shard* shard = s_threadShard;
+
+      if (unlikely(!shard))
+        shard = &get().createThreadShard();
+
+      return *shard;
+    }
+
+    Shard& createThreadShard();
+
+    static HistogramShard& createHistogramShard(Shard& shard, uint32_t id);
+
+    static void mergeHistogram(MetricHistogram& dst, const HistogramShard& src);
+
+    struct ThreadShardRef;
+
+    static thread_local Shard*          s_threadShard;
+    static thread_local bool            s_threadShardReleased;
+    static thread_local ThreadShardRef  s_threadShardRef;
+
+    MetricsSnapshot buildSnapshot();
+
+  };
+
+
+  inline void MetricCounter::add(uint64_t value) const {
+    if (unlikely(!isValid()))
+      return;
+
+    // Only the owning thread writes to its shard
+    auto& counter = MetricsRegistry::getThreadShard().counters[m_id];
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+
+  inline void MetricGauge::set(double value) const {
+    if (likely(isValid()))
+      MetricsRegistry::get().m_gauges[m_id].store(value, std::memory_order_relaxed);
+  }
+
+
+  inline double MetricGauge::get() const {
+    return likely(isValid())
+      ? MetricsRegistry::get().m_gauges[m_id].load(std::memory_order_relaxed)
+      : 0.0;
+  }
+
+
+  inline void MetricHistogramRecorder::record(double value) const {
+    if (unlikely(!isValid()))
+      return;
+
+    auto& shard = MetricsRegistry::getThreadShard();
+    auto histogram = shard.histograms[m_id].load(std::memory_order_relaxed);
+
+    if (unlikely(!histogram))
+      histogram = &MetricsRegistry::createHistogramShard(shard, m_id);
+
+    auto& bucket = histogram->buckets[MetricBuckets::getBucket(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    uint64_t count = histogram->count.load(std::memory_order_relaxed);
+
+    if (!count || value < histogram->min.load(std::memory_order_relaxed))
+      histogram->min.store(value, std::memory_order_relaxed);
+    if (!count || value > histogram->max.load(std::memory_order_relaxed))
+      histogram->max.store(value, std::memory_order_relaxed);
+
+    histogram->sum.store(histogram->sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    histogram->count.store(count + 1, std::memory_order_release);
+  }
+
+}
@@ -0,0 +1,99 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "xxHash/xxhash.h"
+
+namespace dxvk {
+  // A blocked bloom filter over 64 bit hashes.  Every key maps to a single 64 byte block, so a query
+  // touches at most one cache line.  Keys are expected to already be well distributed (e.g. XXH64 hashes),
+  // and are not rehashed.
+  class HashBloomFilter {
+  public:
+    // Sizes the filter for the expected number of keys and clears it.
+    void reset(size_t expectedKeys) {
+      size_t numBlocks = 1;
+      while (numBlocks * kBitsPerBlock < expectedKeys * kBitsPerKey) {
+        numBlocks <<= 1;
+      }
+      m_blocks.assign(numBlocks, Block {});
+      m_blockMask = numBlocks - 1;
+    }
+
+    void clear() {
+      m_blocks.clear();
+      m_blockMask = 0;
+    }
+
+    bool empty() const {
+      return m_blocks.empty();
+    }
+
+    void insert(XXH64_hash_t hash) {
+      Block& block = m_blocks[getBlockIndex(hash)];
+      for (uint32_t i = 0; i < kNumProbes; i++) {
+        const uint32_t bit = getBitIndex(hash, i);
+        block.words[bit >> 6] |= 1ull << (bit & 63);
+      }
+    }
+
+    // Returns false if the hash was definitely not inserted.  An empty (never reset) filter contains nothing.
+    bool mayContain(XXH64_hash_t hash) const {
+      if (m_blocks.empty()) {
+        return false;
+      }
+      const Block& block = m_blocks[getBlockIndex(hash)];
+      for (uint32_t i = 0; i < kNumProbes; i++) {
+        const uint32_t bit = getBitIndex(hash, i);
+        if ((block.words[bit >> 6] & (1ull << (bit & 63))) == 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+  private:
+    static constexpr size_t kBitsPerBlock = 512;
+    // Roughly 12 bits per key with 3 probes into one block gives a false positive rate around 1%.
+    static constexpr size_t kBitsPerKey = 12;
+    static constexpr uint32_t kNumProbes = 3;
+
+    struct alignas(64) Block {
+      uint64_t words[kBitsPerBlock / 64] = {};
+    };
+
+    size_t getBlockIndex(XXH64_hash_t hash) const {
+      // The high bits pick the block, the low bits pick the bits within it.
+      return static_cast<size_t>(hash >> 32) & m_blockMask;
+    }
+
+    static uint32_t getBitIndex(XXH64_hash_t hash, uint32_t probe) {
+      return static_cast<uint32_t>(hash >> (probe * 9)) & (kBitsPerBlock - 1);
+    }
+
+    std::vector<Block> m_blocks;
+    size_t m_blockMask = 0;
+  };
+}
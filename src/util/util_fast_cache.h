@@ -21,6 +21,7 @@
 */
 
 #pragma once
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #ifndef DXVK_UTIL_FORCE_MINIMAL
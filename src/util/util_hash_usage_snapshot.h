@@ -0,0 +1,111 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "util_bloom_filter.h"
+
+namespace dxvk {
+  // A read-only snapshot of hash -> usage count, built once and then probed many times.
+  // Keys are stored in a sorted array with a parallel array of counts, and fronted by a small
+  // bloom filter so that the common case (the hash was not used) rarely touches the key array.
+  class HashUsageSnapshot {
+  public:
+    // Rebuild from any range of (hash, count) pairs, such as an std::unordered_map<XXH64_hash_t, uint32_t>.
+    template<typename Map>
+    void build(const Map& usage) {
+      clear();
+      m_entries.reserve(usage.size());
+      for (const auto& [hash, count] : usage) {
+        m_entries.push_back({ hash, static_cast<uint32_t>(count) });
+      }
+      finalize();
+    }
+
+    // Rebuild from the keys of a map, giving each key a count of 1.
+    template<typename Map>
+    void buildFromKeys(const Map& map) {
+      clear();
+      m_entries.reserve(map.size());
+      for (const auto& pair : map) {
+        m_entries.push_back({ pair.first, 1 });
+      }
+      finalize();
+    }
+
+    void clear() {
+      m_entries.clear();
+      m_bloom.clear();
+    }
+
+    size_t size() const {
+      return m_entries.size();
+    }
+
+    uint32_t getUsageCount(XXH64_hash_t hash) const {
+      if (!m_bloom.mayContain(hash)) {
+        return 0;
+      }
+      auto it = std::lower_bound(m_entries.begin(), m_entries.end(), hash,
+                                 [](const Entry& entry, XXH64_hash_t value) { return entry.hash < value; });
+      return (it != m_entries.end() && it->hash == hash) ? it->count : 0;
+    }
+
+    bool isUsed(XXH64_hash_t hash) const {
+      return getUsageCount(hash) > 0;
+    }
+
+    // Probe a batch of hashes, writing the usage count of each into outCounts.
+    void getUsageCounts(const XXH64_hash_t* hashes, size_t numHashes, uint32_t* outCounts) const {
+      if (m_entries.empty()) {
+        std::fill(outCounts, outCounts + numHashes, 0u);
+        return;
+      }
+      for (size_t i = 0; i < numHashes; i++) {
+        outCounts[i] = getUsageCount(hashes[i]);
+      }
+    }
+
+  private:
+    struct Entry {
+      XXH64_hash_t hash;
+      uint32_t count;
+    };
+
+    void finalize() {
+      if (m_entries.empty()) {
+        return;
+      }
+      std::sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+      m_bloom.reset(m_entries.size());
+      for (const Entry& entry : m_entries) {
+        m_bloom.insert(entry.hash);
+      }
+    }
+
+    std::vector<Entry> m_entries;
+    HashBloomFilter m_bloom;
+  };
+}
@@ -113,6 +113,10 @@ namespace dxvk {
       return isDisposed;
     }
 
+    bool ready() const {
+      return hasResult;
+    }
+
   private:
     std::array<uint8_t, Capacity> storage;
     std::atomic_bool hasResult = false;
@@ -182,6 +186,10 @@ namespace dxvk {
       return !result.disposed();
     }
 
+    bool ready() const {
+      return result.ready();
+    }
+
   private:
     template<typename InvocableType>
     static inline void Thunk(void* thunkLambda) {
@@ -227,6 +235,11 @@ namespace dxvk {
       return task != nullptr && task->valid();
     }
 
+    // Returns true once the result can be retrieved without blocking. The future must be valid
+    bool ready() const {
+      return task->ready();
+    }
+
     void cancel() const {
       task->cancel();
       task = nullptr;
@@ -251,6 +264,11 @@ namespace dxvk {
       return task != nullptr && task->valid();
     }
 
+    // Returns true once the result can be retrieved without blocking. The future must be valid
+    bool ready() const {
+      return task->ready();
+    }
+
     void cancel() const {
       task->cancel();
       task = nullptr;
@@ -364,6 +382,10 @@ namespace dxvk {
         // Place task into queue
         m_workerTasks[thread]->push(std::move(taskId));
 
+        // Note: count the task before notifying, a worker woken up before the increment would
+        // otherwise see no tasks and go back to sleep with the task left in its queue.
+        ++m_numTasks;
+
         if constexpr (!LowLatency) {
           std::unique_lock<TaskMutex> lock(m_taskMutex);
           if constexpr (WorkStealing) {
@@ -374,8 +396,6 @@ namespace dxvk {
             m_condOnAdd.notify_all();
           }
         }
-
-        ++m_numTasks;
       }
 
       return future;
@@ -470,6 +490,6 @@ namespace dxvk {
     //  1. Non-circular queue incurs allocation overhead thats unacceptable
     //  2. Use of mutex, and CVs, incur overhead thats unacceptable
     std::vector<QueuePtr> m_workerTasks;
-    std::atomic_uint32_t m_numTasks;
+    std::atomic_uint32_t m_numTasks = 0;
   };
 } //dxvk
\ No newline at end of file
@@ -0,0 +1,210 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "rtx_render/rtx_asset_mip_cache.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_asset_mip_cache.log");
+
+namespace {
+  // An asset with 'numLevels' mips of 'levelSize' bytes each, filled with a per-level pattern
+  class TestAssetData : public AssetData {
+  public:
+    TestAssetData(XXH64_hash_t hash, uint32_t numLevels, size_t levelSize)
+      : m_levelSize { levelSize } {
+      m_hash = hash;
+      m_info.type = AssetType::Image2D;
+      m_info.mipLevels = numLevels;
+      m_info.numLayers = 1;
+    }
+
+    const void* data(int, int) override {
+      return nullptr;
+    }
+
+    void placement(int, int, int, uint64_t& offset, size_t& size) const override {
+      offset = 0;
+      size = 0;
+    }
+
+    void evictCache(int, int) override { }
+
+    void releaseSource() override { }
+
+    bool readSubresource(int layer, int level, std::vector<uint8_t>& data) const override {
+      ++m_reads;
+      data.assign(m_levelSize, uint8_t(level + 1));
+      return true;
+    }
+
+    uint32_t getReadCount() const {
+      return m_reads;
+    }
+
+  private:
+    size_t m_levelSize;
+    mutable std::atomic<uint32_t> m_reads = 0;
+  };
+} // anonymous namespace
+
+void testLruEviction() {
+  Logger::info("Testing mip cache LRU eviction...");
+  // Room for 4 levels of 100 bytes
+  AssetMipCache cache { size_t(400) };
+  Rc<TestAssetData> asset = new TestAssetData(1, 6, 100);
+
+  for (uint32_t level = 0; level < 4; level++) {
+    AssetMipCache::Blob blob = cache.load(*asset, 0, level);
+    if (blob == nullptr || blob->size() != 100 || (*blob)[0] != level + 1) {
+      throw DxvkError(str::format("testLruEviction: unexpected data for level ", level));
+    }
+  }
+  if (cache.getStats().residentBytes != 400 || asset->getReadCount() != 4) {
+    throw DxvkError("testLruEviction: all 4 levels should be resident");
+  }
+
+  // Touch every other level, so that level 1 becomes the least recently used one
+  AssetMipCache::Blob heldBlob = cache.find(*asset, 0, 1);
+  for (uint32_t level : { 0u, 2u, 3u }) {
+    if (cache.find(*asset, 0, level) == nullptr) {
+      throw DxvkError(str::format("testLruEviction: level ", level, " should be a hit"));
+    }
+  }
+  cache.load(*asset, 0, 4);
+
+  const AssetMipCache::Stats stats = cache.getStats();
+  if (stats.evictions != 1 || stats.residentBytes != 400) {
+    throw DxvkError(str::format("testLruEviction: expected 1 eviction, got ", stats.evictions));
+  }
+  if (cache.find(*asset, 0, 1) != nullptr) {
+    throw DxvkError("testLruEviction: the least recently used level should have been evicted");
+  }
+  if (heldBlob == nullptr || (*heldBlob)[0] != 2) {
+    throw DxvkError("testLruEviction: evicting an entry must not invalidate blobs that are still held");
+  }
+
+  // Reloading an evicted level reads it again
+  cache.load(*asset, 0, 1);
+  if (asset->getReadCount() != 6) {
+    throw DxvkError("testLruEviction: an evicted level should be read again");
+  }
+
+  // Entries larger than a quarter of the budget are returned, but not cached
+  Rc<TestAssetData> large = new TestAssetData(2, 1, 200);
+  if (cache.load(*large, 0, 0) == nullptr || cache.find(*large, 0, 0) != nullptr) {
+    throw DxvkError("testLruEviction: oversized entries should bypass the cache");
+  }
+  Logger::info("Mip cache LRU eviction test passed");
+}
+
+void testStats() {
+  Logger::info("Testing mip cache statistics...");
+  AssetMipCache cache { size_t(400) };
+  Rc<TestAssetData> asset = new TestAssetData(10, 8, 100);
+
+  for (uint32_t level = 0; level < 8; level++) {
+    cache.load(*asset, 0, level);
+  }
+  cache.load(*asset, 0, 7);
+
+  const AssetMipCache::Stats stats = cache.getStats();
+  if (stats.misses != 8 || stats.hits != 1) {
+    throw DxvkError(str::format("testStats: expected 8 misses and 1 hit, got ", stats.misses, " and ", stats.hits));
+  }
+  if (stats.evictions != 4 || stats.residentBytes != 400 || stats.budgetBytes != 400) {
+    throw DxvkError("testStats: unexpected eviction or residency counts");
+  }
+
+  cache.clear();
+  if (cache.getStats().residentBytes != 0 || cache.find(*asset, 0, 7) != nullptr) {
+    throw DxvkError("testStats: clear should drop all entries");
+  }
+  Logger::info("Mip cache statistics test passed");
+}
+
+void testPrefetch() {
+  Logger::info("Testing mip cache prefetch...");
+  AssetMipCache cache { size_t(1024 * 1024) };
+  Rc<TestAssetData> asset = new TestAssetData(20, 4, 1024);
+
+  cache.prefetch(asset, 0, 4);
+  // The prefetch thread runs in the background, give it a moment
+  for (uint32_t i = 0; i < 500 && cache.getStats().prefetches < 4; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  if (cache.getStats().prefetches != 4) {
+    throw DxvkError(str::format("testPrefetch: expected 4 prefetched levels, got ", cache.getStats().prefetches));
+  }
+
+  const uint32_t readsAfterPrefetch = asset->getReadCount();
+  for (uint32_t level = 0; level < 4; level++) {
+    if (cache.load(*asset, 0, level) == nullptr) {
+      throw DxvkError("testPrefetch: prefetched level should be resident");
+    }
+  }
+  if (asset->getReadCount() != readsAfterPrefetch) {
+    throw DxvkError("testPrefetch: prefetched levels should not be read again");
+  }
+
+  // Resident levels are not queued again
+  cache.prefetch(asset, 0, 4);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  if (asset->getReadCount() != readsAfterPrefetch) {
+    throw DxvkError("testPrefetch: resident levels should not be prefetched again");
+  }
+  Logger::info("Mip cache prefetch test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_asset_mip_cache...");
+
+  try {
+    dxvk::testLruEviction();
+    dxvk::testStats();
+    dxvk::testPrefetch();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
@@ -0,0 +1,425 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/log/log_writer.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_async_logger.log");
+
+namespace {
+  // "[HH:MM:SS.mmm] " followed by a 7 character level prefix
+  constexpr size_t kLinePrefixSize = 22;
+
+  // Collects batches, and can hold the writer inside the sink to simulate a stalled flush
+  class TestSink {
+  public:
+    LogWriter::Sink get() {
+      return [this] (const std::string& text) {
+        std::unique_lock<dxvk::mutex> lock(m_mutex);
+        m_entered = true;
+        m_cond.notify_all();
+        m_cond.wait(lock, [this] { return !m_blocked; });
+        m_output += text;
+      };
+    }
+
+    void block() {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_blocked = true;
+      m_entered = false;
+    }
+
+    void waitUntilEntered() {
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_cond.wait(lock, [this] { return m_entered; });
+    }
+
+    void unblock() {
+      { std::lock_guard<dxvk::mutex> lock(m_mutex);
+        m_blocked = false;
+      }
+      m_cond.notify_all();
+    }
+
+    // Returns the output lines with their time stamps removed
+    std::vector<std::string> lines() {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      std::vector<std::string> result;
+      std::stringstream stream(m_output);
+      std::string line;
+      while (std::getline(stream, line)) {
+        if (line.size() < kLinePrefixSize || line[0] != '[') {
+          throw DxvkError(str::format("Malformed log line: ", line));
+        }
+        result.push_back(line.substr(kLinePrefixSize - 7));
+      }
+      return result;
+    }
+
+  private:
+    dxvk::mutex m_mutex;
+    dxvk::condition_variable m_cond;
+    bool m_blocked = false;
+    bool m_entered = false;
+    std::string m_output;
+  };
+
+  // The mutex and per-line std::endl path that LogWriter replaced, used as the benchmark baseline
+  class SynchronousLogger {
+  public:
+    explicit SynchronousLogger(const std::filesystem::path& path)
+      : m_fileStream(path) { }
+
+    void emitMsg(const std::string& message) {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+      std::stringstream stream(message);
+      std::string line;
+
+      char timeString[64];
+      const auto now = std::chrono::system_clock::now();
+      const std::time_t time = std::chrono::system_clock::to_time_t(now);
+      const int ms = int(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+      std::tm lt = { };
+#ifdef _WIN32
+      localtime_s(&lt, &time);
+#else
+      localtime_r(&time, &lt);
+#endif
+      std::snprintf(timeString, sizeof(timeString), "[%02d:%02d:%02d.%03d] ", lt.tm_hour, lt.tm_min, lt.tm_sec, ms);
+
+      while (std::getline(stream, line, '\n')) {
+        m_fileStream << timeString << "info:  " << line << std::endl;
+      }
+    }
+
+  private:
+    dxvk::mutex m_mutex;
+    std::ofstream m_fileStream;
+  };
+
+  template<typename Func>
+  double runThreads(uint32_t threadCount, const Func& func) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadCount; t++) {
+      threads.emplace_back([&func, t] { func(t); });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+  }
+} // anonymous namespace
+
+void testPerThreadOrdering() {
+  Logger::info("Testing per-thread message ordering...");
+  constexpr uint32_t kThreadCount = 4;
+  constexpr uint32_t kMessageCount = 5000;
+
+  TestSink sink;
+  {
+    // Large enough to never drop, regardless of how the flush thread is scheduled
+    LogWriter writer(sink.get(), 1u << 20);
+    std::atomic<uint32_t> rejected = { 0u };
+    runThreads(kThreadCount, [&] (uint32_t t) {
+      for (uint32_t i = 0; i < kMessageCount; i++) {
+        if (!writer.push(LogLevel::Info, str::format("thread ", t, " message ", i))) {
+          rejected++;
+        }
+      }
+    });
+    writer.flush();
+
+    if (rejected != 0 || writer.droppedCount() != 0) {
+      throw DxvkError("testPerThreadOrdering: unexpected drops");
+    }
+  }
+
+  std::vector<uint32_t> nextMessage(kThreadCount, 0);
+  for (const auto& line : sink.lines()) {
+    uint32_t t = 0, i = 0;
+    if (std::sscanf(line.c_str(), "info:  thread %u message %u", &t, &i) != 2 || t >= kThreadCount) {
+      throw DxvkError(str::format("testPerThreadOrdering: unexpected line: ", line));
+    }
+    if (i != nextMessage[t]) {
+      throw DxvkError(str::format("testPerThreadOrdering: thread ", t, " expected message ", nextMessage[t], ", got ", i));
+    }
+    nextMessage[t]++;
+  }
+  for (uint32_t t = 0; t < kThreadCount; t++) {
+    if (nextMessage[t] != kMessageCount) {
+      throw DxvkError(str::format("testPerThreadOrdering: thread ", t, " wrote ", nextMessage[t], " messages"));
+    }
+  }
+  Logger::info("Per-thread message ordering test passed");
+}
+
+void testDropAccounting() {
+  Logger::info("Testing dropped message accounting...");
+  constexpr size_t kBufferSize = 4096;
+  constexpr uint32_t kMessageCount = 1000;
+  // 24 byte record header plus 16 characters of text
+  constexpr size_t kRecordSize = 40;
+  constexpr uint32_t kExpectedAccepted = uint32_t(kBufferSize / kRecordSize);
+
+  TestSink sink;
+  LogWriter writer(sink.get(), kBufferSize);
+
+  // Stall the consumer inside the sink. The staging buffer is already empty at that
+  // point, so exactly as many messages fit as the buffer can hold.
+  sink.block();
+  writer.push(LogLevel::Info, "first");
+  std::thread flusher([&] { writer.flush(); });
+  sink.waitUntilEntered();
+
+  uint32_t accepted = 0;
+  for (uint32_t i = 0; i < kMessageCount; i++) {
+    char text[17];
+    std::snprintf(text, sizeof(text), "message %8u", i);
+    accepted += writer.push(LogLevel::Info, text) ? 1 : 0;
+  }
+
+  sink.unblock();
+  flusher.join();
+  writer.flush();
+
+  if (accepted != kExpectedAccepted) {
+    throw DxvkError(str::format("testDropAccounting: expected ", kExpectedAccepted, " accepted messages, got ", accepted));
+  }
+  if (writer.droppedCount() != kMessageCount - accepted) {
+    throw DxvkError(str::format("testDropAccounting: expected ", kMessageCount - accepted, " drops, got ", writer.droppedCount()));
+  }
+
+  const std::vector<std::string> lines = sink.lines();
+  const std::string notice = str::format("warn:  ", kMessageCount - accepted, " log message(s) dropped");
+  if (lines.size() != accepted + 2 || lines.back().compare(0, notice.size(), notice) != 0) {
+    throw DxvkError(str::format("testDropAccounting: expected ", accepted + 1, " messages and a drop notice, got ", lines.size(), " lines"));
+  }
+  // The accepted messages are the first ones, nothing from after the buffer filled up
+  for (uint32_t i = 0; i < accepted; i++) {
+    char expected[32];
+    std::snprintf(expected, sizeof(expected), "info:  message %8u", i);
+    if (lines[i + 1] != expected) {
+      throw DxvkError(str::format("testDropAccounting: unexpected line: ", lines[i + 1]));
+    }
+  }
+  Logger::info("Dropped message accounting test passed");
+}
+
+void testSynchronousFlush() {
+  Logger::info("Testing synchronous flush...");
+  // The flush thread never gets to run on its own in this test
+  const auto kNever = std::chrono::milliseconds(3600000);
+
+  TestSink sink;
+  {
+    LogWriter writer(sink.get(), LogWriter::DefaultStagingBufferSize, kNever);
+
+    // Messages of a thread that already exited must not be lost
+    std::thread([&] {
+      writer.push(LogLevel::Info, "from exited thread");
+    }).join();
+
+    writer.push(LogLevel::Warn, "line a\nline b\n");
+    writer.push(LogLevel::Error, "fatal");
+    writer.flush();
+
+    const std::vector<std::string> expected = {
+      "info:  from exited thread",
+      "warn:  line a",
+      "warn:  line b",
+      "err:   fatal",
+    };
+    if (sink.lines() != expected) {
+      throw DxvkError("testSynchronousFlush: flush did not write all pending messages in order");
+    }
+
+    // Pending at shutdown
+    writer.push(LogLevel::Info, "at shutdown");
+  }
+
+  if (sink.lines().back() != "info:  at shutdown") {
+    throw DxvkError("testSynchronousFlush: pending messages were lost on shutdown");
+  }
+  Logger::info("Synchronous flush test passed");
+}
+
+void testOversizedMessage() {
+  Logger::info("Testing messages larger than the staging buffer...");
+  constexpr size_t kBufferSize = 256;
+  const auto kNever = std::chrono::milliseconds(3600000);
+
+  TestSink sink;
+  LogWriter writer(sink.get(), kBufferSize, kNever);
+
+  const std::string oversized(4 * kBufferSize, 'x');
+  writer.push(LogLevel::Info, "before");
+  if (!writer.push(LogLevel::Warn, oversized)) {
+    throw DxvkError("testOversizedMessage: oversized message was dropped");
+  }
+  writer.push(LogLevel::Info, "after");
+  writer.flush();
+
+  const std::vector<std::string> expected = {
+    "info:  before",
+    "warn:  " + oversized,
+    "info:  after",
+  };
+  if (sink.lines() != expected) {
+    throw DxvkError("testOversizedMessage: oversized message was truncated or reordered");
+  }
+  Logger::info("Oversized message test passed");
+}
+
+void testRateLimiting() {
+  Logger::info("Testing rate limiting...");
+  LogRateLimiter limiter;
+  uint32_t allowed = 0;
+  uint32_t suppressed = 0;
+  for (uint32_t i = 0; i < 100; i++) {
+    allowed += limiter.allow(suppressed) ? 1 : 0;
+  }
+  if (allowed != LogRateLimiter::MessagesPerWindow) {
+    throw DxvkError(str::format("testRateLimiting: expected ", LogRateLimiter::MessagesPerWindow, " messages, got ", allowed));
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(LogRateLimiter::WindowMs + 100));
+  if (!limiter.allow(suppressed) || suppressed != 100 - LogRateLimiter::MessagesPerWindow) {
+    throw DxvkError(str::format("testRateLimiting: expected ", 100 - LogRateLimiter::MessagesPerWindow, " suppressed messages, got ", suppressed));
+  }
+  if (LogRateLimiter::annotate("message", 3) != "message (3 similar message(s) suppressed)") {
+    throw DxvkError("testRateLimiting: unexpected annotation");
+  }
+
+  // Each call site is limited separately, and messages are only built when they are logged
+  uint32_t evaluated[2] = { };
+  for (uint32_t i = 0; i < 100; i++) {
+    LOG_RATE_LIMITED(LogLevel::Info, str::format("rate limited message ", evaluated[0]++));
+    LOG_RATE_LIMITED(LogLevel::Info, str::format("other rate limited message ", evaluated[1]++));
+  }
+  if (evaluated[0] != LogRateLimiter::MessagesPerWindow || evaluated[1] != LogRateLimiter::MessagesPerWindow) {
+    throw DxvkError("testRateLimiting: call sites are not limited separately");
+  }
+
+  // Errors are never suppressed
+  uint32_t errorsEvaluated = 0;
+  for (uint32_t i = 0; i < 2 * LogRateLimiter::MessagesPerWindow; i++) {
+    LOG_RATE_LIMITED(LogLevel::Error, str::format("rate limited error ", errorsEvaluated++));
+  }
+  if (errorsEvaluated != 2 * LogRateLimiter::MessagesPerWindow) {
+    throw DxvkError("testRateLimiting: errors should not be rate limited");
+  }
+  Logger::info("Rate limiting test passed");
+}
+
+void testThroughput() {
+  Logger::info("Measuring logging throughput...");
+  constexpr uint32_t kThreadCount = 4;
+  constexpr uint32_t kMessageCount = 50000;
+  constexpr uint32_t kTotal = kThreadCount * kMessageCount;
+
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "test_async_logger_benchmark.log";
+
+  double syncMs;
+  {
+    SynchronousLogger logger(path);
+    syncMs = runThreads(kThreadCount, [&] (uint32_t t) {
+      for (uint32_t i = 0; i < kMessageCount; i++) {
+        logger.emitMsg(str::format("Benchmark thread ", t, " message ", i, ": some typical payload"));
+      }
+    });
+  }
+
+  double asyncMs, asyncTotalMs;
+  uint64_t dropped;
+  {
+    std::ofstream stream(path);
+    auto t0 = std::chrono::high_resolution_clock::now();
+    LogWriter writer([&stream] (const std::string& text) {
+      stream << text;
+      stream.flush();
+    }, 16u << 20);
+    asyncMs = runThreads(kThreadCount, [&] (uint32_t t) {
+      for (uint32_t i = 0; i < kMessageCount; i++) {
+        writer.push(LogLevel::Info, str::format("Benchmark thread ", t, " message ", i, ": some typical payload"));
+      }
+    });
+    writer.flush();
+    asyncTotalMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+    dropped = writer.droppedCount();
+  }
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+
+  Logger::info(str::format("Mutex logger: ", syncMs * 1e6 / kTotal, " ns per message"));
+  Logger::info(str::format("Async logger: ", asyncMs * 1e6 / kTotal, " ns per message, ",
+                           asyncTotalMs * 1e6 / kTotal, " ns per message until written, ", dropped, " dropped"));
+  Logger::info(str::format("Logging speedup: ", syncMs / asyncMs, "x"));
+  Logger::info("Logging throughput test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_async_logger...");
+
+  try {
+    dxvk::testPerThreadOrdering();
+    dxvk::testDropAccounting();
+    dxvk::testSynchronousFlush();
+    dxvk::testOversizedMessage();
+    dxvk::testRateLimiting();
+    dxvk::testThroughput();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
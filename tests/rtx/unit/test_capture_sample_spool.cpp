@@ -0,0 +1,148 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "rtx_render/rtx_game_capturer_spool.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_capture_sample_spool.log");
+
+void testEncodeDecode() {
+  Logger::info("Testing sample encoding...");
+  uint32_t seed = 1;
+  const auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return seed >> 16; };
+
+  for (uint32_t iteration = 0; iteration < 1000; iteration++) {
+    // Sparse data, so that both zero runs and literals show up
+    std::vector<uint8_t> data(next() % 512);
+    for (uint8_t& byte : data) {
+      byte = (next() % 3 == 0) ? uint8_t(next()) : 0;
+    }
+    std::vector<uint8_t> previous;
+    if (iteration % 2) {
+      previous = data;
+      for (uint8_t& byte : previous) {
+        if (next() % 5 == 0) {
+          byte = uint8_t(next());
+        }
+      }
+    }
+
+    std::vector<uint8_t> encoded, decoded;
+    CaptureSampleSpool::encode(data.data(), data.size(), previous, encoded);
+    if (!CaptureSampleSpool::decode(encoded.data(), encoded.size(), data.size(), previous, decoded) || decoded != data) {
+      throw DxvkError(str::format("testEncodeDecode: round trip failed on iteration ", iteration));
+    }
+    // Truncated samples must be rejected rather than read out of bounds
+    if (!encoded.empty() && !data.empty() &&
+        CaptureSampleSpool::decode(encoded.data(), encoded.size() - 1, data.size(), previous, decoded)) {
+      throw DxvkError(str::format("testEncodeDecode: accepted a truncated sample on iteration ", iteration));
+    }
+  }
+  Logger::info("Sample encoding test passed");
+}
+
+void testSpoolStream() {
+  Logger::info("Testing sample spool stream...");
+  const std::filesystem::path spoolPath = std::filesystem::temp_directory_path() / "test_capture_sample_spool.samples";
+  {
+    CaptureSampleSpool spool(spoolPath);
+    if (!spool.isValid()) {
+      throw DxvkError("testSpoolStream: failed to create the spool file");
+    }
+
+    CaptureSampleSpool::Stream positions;
+    CaptureSampleSpool::Stream indices;
+    std::vector<float> vertices(3000, 1.0f);
+    const std::vector<int> triangles { 0, 1, 2, 2, 1, 3 };
+    std::vector<std::vector<float>> expected;
+    for (uint32_t frame = 0; frame < 10; frame++) {
+      // Only every third frame animates a vertex, the others repeat the previous sample
+      if (frame % 3 == 0) {
+        vertices[frame * 3] = float(frame);
+        expected.push_back(vertices);
+      }
+      const bool stored = spool.append(positions, float(frame), vertices.data(), vertices.size() * sizeof(float));
+      if (stored != (frame % 3 == 0)) {
+        throw DxvkError(str::format("testSpoolStream: unexpected deduplication result on frame ", frame));
+      }
+      spool.append(indices, float(frame), triangles.data(), triangles.size() * sizeof(int));
+    }
+
+    if (positions.samples.size() != expected.size() || indices.samples.size() != 1) {
+      throw DxvkError("testSpoolStream: unexpected number of stored samples");
+    }
+    // Consecutive samples only differ in one vertex, so deltas should be tiny
+    if (spool.getEncodedBytes() * 4 > spool.getRawBytes()) {
+      throw DxvkError(str::format("testSpoolStream: poor compression, ", spool.getEncodedBytes(), " of ", spool.getRawBytes(), " bytes"));
+    }
+
+    size_t sampleIdx = 0;
+    const bool read = spool.readSamples(positions, [&](float time, const std::vector<uint8_t>& sample) {
+      if (time != float(sampleIdx * 3) || sample.size() != expected[sampleIdx].size() * sizeof(float) ||
+          memcmp(sample.data(), expected[sampleIdx].data(), sample.size()) != 0) {
+        throw DxvkError(str::format("testSpoolStream: sample ", sampleIdx, " doesn't match"));
+      }
+      ++sampleIdx;
+    });
+    if (!read || sampleIdx != expected.size()) {
+      throw DxvkError("testSpoolStream: failed to read back all samples");
+    }
+  }
+  if (std::filesystem::exists(spoolPath)) {
+    throw DxvkError("testSpoolStream: spool file should be removed when the spool is destroyed");
+  }
+  Logger::info("Sample spool stream test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_capture_sample_spool...");
+
+  try {
+    dxvk::testEncodeDecode();
+    dxvk::testSpoolStream();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
@@ -0,0 +1,295 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <array>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/d3d9/d3d9_constant_upload_cache.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_d3d9_constant_upload_cache.log");
+
+namespace {
+  // Integer and float constants of one upload, laid out like a hardware VS constant buffer
+  struct ConstantData {
+    std::array<int32_t, 16 * 4> ints = { };
+    std::array<float, 256 * 4> floats = { };
+  };
+
+  XXH64_hash_t hashUpload(const ConstantData& data, uint32_t numFloats = 256) {
+    return D3D9ConstantUploadCache::hashData(data.ints.data(), sizeof(data.ints), data.floats.data(), numFloats * 4 * sizeof(float));
+  }
+
+  ConstantData createConstants(std::mt19937& rng) {
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    ConstantData data;
+    for (auto& value : data.ints) {
+      value = static_cast<int32_t>(rng() % 16);
+    }
+    for (auto& value : data.floats) {
+      value = dist(rng);
+    }
+    return data;
+  }
+
+  // A recorded constant stream: the constant set uploaded for each draw, as an index into a pool of sets
+  struct ConstantStream {
+    const char* name = nullptr;
+    std::vector<ConstantData> sets;
+    std::vector<uint32_t> uploads;
+  };
+
+  // Draws grouped by material, with passes that cycle through a few materials
+  ConstantStream createMaterialStream(std::mt19937& rng) {
+    ConstantStream stream;
+    stream.name = "material cycling";
+    for (uint32_t i = 0; i < 3; i++) {
+      stream.sets.push_back(createConstants(rng));
+    }
+    for (uint32_t i = 0; i < 4096; i++) {
+      stream.uploads.push_back(i % 3);
+    }
+    return stream;
+  }
+
+  // Every object is drawn in a depth, shadow and main pass right after each other, with its own transform
+  ConstantStream createMultiPassStream(std::mt19937& rng) {
+    ConstantStream stream;
+    stream.name = "per-object passes";
+    for (uint32_t object = 0; object < 512; object++) {
+      stream.sets.push_back(createConstants(rng));
+      for (uint32_t pass = 0; pass < 3; pass++) {
+        // A few draws of shared UI/fullscreen constants sneak in between passes
+        if (rng() % 4 == 0) {
+          stream.uploads.push_back(0);
+        }
+        stream.uploads.push_back(object);
+      }
+    }
+    return stream;
+  }
+
+  // Every upload is different, which only costs the hashing
+  ConstantStream createUniqueStream(std::mt19937& rng) {
+    ConstantStream stream;
+    stream.name = "unique";
+    for (uint32_t i = 0; i < 4096; i++) {
+      stream.sets.push_back(createConstants(rng));
+      stream.uploads.push_back(i);
+    }
+    return stream;
+  }
+} // anonymous namespace
+
+void testLookup() {
+  Logger::info("Testing constant upload cache lookup...");
+  D3D9ConstantUploadCache cache;
+
+  // The first upload always lands in entry 0, which is the buffer the device created up front
+  D3D9ConstantUploadCache::Lookup lookup = cache.lookup(1);
+  if (lookup.hit || lookup.entry != 0) {
+    throw DxvkError("testLookup: first upload should miss into entry 0");
+  }
+  lookup = cache.lookup(1);
+  if (!lookup.hit || lookup.entry != 0) {
+    throw DxvkError("testLookup: repeated upload should hit entry 0");
+  }
+
+  for (uint32_t i = 1; i < D3D9ConstantUploadCache::NumEntries; i++) {
+    lookup = cache.lookup(1 + i);
+    if (lookup.hit || lookup.entry != i) {
+      throw DxvkError(str::format("testLookup: upload ", i, " should fill entry ", i));
+    }
+  }
+
+  // Touch the first entry, so that the second one is the least recently used
+  if (!cache.lookup(1).hit) {
+    throw DxvkError("testLookup: first upload should still be cached");
+  }
+  lookup = cache.lookup(100);
+  if (lookup.hit || lookup.entry != 1) {
+    throw DxvkError(str::format("testLookup: expected entry 1 to be evicted, got ", lookup.entry));
+  }
+  if (cache.lookup(2).hit) {
+    throw DxvkError("testLookup: evicted upload should miss");
+  }
+
+  cache.reset();
+  if (cache.lookup(1).hit) {
+    throw DxvkError("testLookup: reset cache should miss");
+  }
+  Logger::info("Constant upload cache lookup test passed");
+}
+
+void testHashing() {
+  Logger::info("Testing constant upload hashing...");
+  std::mt19937 rng(1234);
+  const ConstantData data = createConstants(rng);
+  const XXH64_hash_t hash = hashUpload(data);
+
+  if (hashUpload(data) != hash) {
+    throw DxvkError("testHashing: hash should be stable");
+  }
+
+  // Same bytes, different layout
+  if (hashUpload(data, 255) == hash ||
+      D3D9ConstantUploadCache::hashData(data.ints.data(), 0, data.floats.data(), sizeof(data.floats)) == hash) {
+    throw DxvkError("testHashing: sizes must be part of the hash");
+  }
+
+  ConstantData changed = data;
+  changed.floats.back() += 1.f;
+  if (hashUpload(changed) == hash) {
+    throw DxvkError("testHashing: changing the last float should change the hash");
+  }
+  changed = data;
+  changed.ints.front() += 1;
+  if (hashUpload(changed) == hash) {
+    throw DxvkError("testHashing: changing an integer should change the hash");
+  }
+
+  const float value[4] = { 1.f, 2.f, 3.f, 4.f };
+  const XXH64_hash_t copyHash = D3D9ConstantUploadCache::hashConstantCopy(hash, 7, value);
+  if (copyHash == hash || D3D9ConstantUploadCache::hashConstantCopy(hash, 8, value) == copyHash) {
+    throw DxvkError("testHashing: constant copies and their index must be part of the hash");
+  }
+  Logger::info("Constant upload hashing test passed");
+}
+
+void testBufferContents() {
+  Logger::info("Testing constant upload cache buffer contents...");
+  std::mt19937 rng(4321);
+
+  std::vector<ConstantData> sets;
+  for (uint32_t i = 0; i < 8; i++) {
+    sets.push_back(createConstants(rng));
+  }
+
+  // Mirror what the device does: write the data on a miss, rebind on a hit, and make
+  // sure a hit always binds a buffer that holds exactly the uploaded constants.
+  D3D9ConstantUploadCache cache;
+  std::array<ConstantData, D3D9ConstantUploadCache::NumEntries> buffers;
+  std::geometric_distribution<uint32_t> recentDist(0.3);
+  std::vector<uint32_t> history = { 0 };
+
+  for (uint32_t i = 0; i < 100000; i++) {
+    // Favour recently uploaded sets, like a real stream does
+    const uint32_t back = std::min<uint32_t>(recentDist(rng), uint32_t(history.size()) - 1);
+    const uint32_t set = rng() % 8 == 0 ? rng() % uint32_t(sets.size()) : history[history.size() - 1 - back];
+    history.push_back(set);
+
+    const D3D9ConstantUploadCache::Lookup lookup = cache.lookup(hashUpload(sets[set]));
+    if (lookup.entry >= D3D9ConstantUploadCache::NumEntries) {
+      throw DxvkError("testBufferContents: entry out of range");
+    }
+    if (!lookup.hit) {
+      buffers[lookup.entry] = sets[set];
+    } else if (buffers[lookup.entry].floats != sets[set].floats || buffers[lookup.entry].ints != sets[set].ints) {
+      throw DxvkError(str::format("testBufferContents: upload ", i, " hit a buffer with different contents"));
+    }
+  }
+
+  if (cache.hitCount() + cache.missCount() != 100000 || cache.hitCount() == 0) {
+    throw DxvkError("testBufferContents: unexpected hit and miss counts");
+  }
+  Logger::info(str::format("Buffer contents test hit rate: ", 100.0 * double(cache.hitCount()) / 100000.0, "%"));
+  Logger::info("Constant upload cache buffer contents test passed");
+}
+
+void testHitRate() {
+  Logger::info("Testing constant upload cache hit rate...");
+  std::mt19937 rng(8765);
+
+  std::vector<ConstantStream> streams;
+  streams.push_back(createMaterialStream(rng));
+  streams.push_back(createMultiPassStream(rng));
+  streams.push_back(createUniqueStream(rng));
+
+  for (const ConstantStream& stream : streams) {
+    D3D9ConstantUploadCache cache;
+    XXH64_hash_t lastHash = 0;
+    size_t numLastHits = 0;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (uint32_t set : stream.uploads) {
+      const XXH64_hash_t hash = hashUpload(stream.sets[set]);
+      cache.lookup(hash);
+      numLastHits += hash == lastHash ? 1 : 0;
+      lastHash = hash;
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    // Compare against only skipping uploads that match the previous one
+    if (cache.hitCount() < numLastHits) {
+      throw DxvkError(str::format("testHitRate: ", stream.name, ": cache hits less often than comparing with the last upload"));
+    }
+
+    const double numUploads = double(stream.uploads.size());
+    const double seconds = std::chrono::duration<double>(t1 - t0).count();
+    Logger::info(str::format(stream.name, ": hit rate ", 100.0 * double(cache.hitCount()) / numUploads, "%, last upload only ",
+                             100.0 * double(numLastHits) / numUploads, "%, ",
+                             numUploads * sizeof(ConstantData) / seconds / (1024.0 * 1024.0), " MB/s hashed"));
+  }
+
+  // Three alternating materials fit the cache, so only the first use of each should miss
+  D3D9ConstantUploadCache cache;
+  for (uint32_t set : streams[0].uploads) {
+    cache.lookup(hashUpload(streams[0].sets[set]));
+  }
+  if (cache.missCount() != 3) {
+    throw DxvkError(str::format("testHitRate: expected 3 misses for alternating materials, got ", cache.missCount()));
+  }
+  Logger::info("Constant upload cache hit rate test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_d3d9_constant_upload_cache...");
+
+  try {
+    dxvk::testLookup();
+    dxvk::testHashing();
+    dxvk::testBufferContents();
+    dxvk::testHitRate();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
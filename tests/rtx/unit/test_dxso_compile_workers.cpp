@@ -0,0 +1,331 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxso/dxso_compile_workers.h"
+#include "../../../src/dxso/dxso_module.h"
+#include "../../../src/dxso/dxso_modinfo.h"
+#include "../../../src/dxvk/dxvk_shader.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_dxso_compile_workers.log");
+
+namespace {
+  // SM3 token encoding, see the D3D9 shader bytecode reference
+  constexpr uint32_t kVsVersion = 0xFFFE0300;
+  constexpr uint32_t kPsVersion = 0xFFFF0300;
+  constexpr uint32_t kEnd = 0x0000FFFF;
+
+  constexpr uint32_t kOpMov = 1;
+  constexpr uint32_t kOpMad = 4;
+  constexpr uint32_t kOpDp4 = 9;
+  constexpr uint32_t kOpDcl = 31;
+  constexpr uint32_t kOpTex = 66;
+
+  constexpr uint32_t kRegTemp = 0;
+  constexpr uint32_t kRegInput = 1;
+  constexpr uint32_t kRegConst = 2;
+  constexpr uint32_t kRegOutput = 6;
+  constexpr uint32_t kRegColorOut = 8;
+  constexpr uint32_t kRegSampler = 10;
+
+  constexpr uint32_t kUsagePosition = 0;
+  constexpr uint32_t kUsageTexcoord = 5;
+
+  constexpr uint32_t kSwizzleXYZW = 0xE4;
+  constexpr uint32_t kSwizzleYZWX = 0x39;
+
+  uint32_t instruction(uint32_t opcode, uint32_t length) {
+    return opcode | (length << 24);
+  }
+
+  uint32_t registerBits(uint32_t type, uint32_t num) {
+    return 0x80000000u | ((type & 0x7) << 28) | ((type & 0x18) << 8) | num;
+  }
+
+  uint32_t dst(uint32_t type, uint32_t num, uint32_t mask = 0xF) {
+    return registerBits(type, num) | (mask << 16);
+  }
+
+  uint32_t src(uint32_t type, uint32_t num, uint32_t swizzle = kSwizzleXYZW) {
+    return registerBits(type, num) | (swizzle << 16);
+  }
+
+  uint32_t dclUsage(uint32_t usage, uint32_t index) {
+    return 0x80000000u | usage | (index << 16);
+  }
+
+  // vs_3_0: transforms the position by c0-c3, then runs a chain of
+  // mads over the texcoord whose length depends on the seed
+  std::vector<uint32_t> createVertexShader(uint32_t seed) {
+    std::vector<uint32_t> code = { kVsVersion };
+    const auto emit = [&code] (std::initializer_list<uint32_t> tokens) {
+      code.insert(code.end(), tokens);
+    };
+
+    emit({ instruction(kOpDcl, 2), dclUsage(kUsagePosition, 0), dst(kRegInput, 0) });
+    emit({ instruction(kOpDcl, 2), dclUsage(kUsageTexcoord, 0), dst(kRegInput, 1) });
+    emit({ instruction(kOpDcl, 2), dclUsage(kUsagePosition, 0), dst(kRegOutput, 0) });
+    emit({ instruction(kOpDcl, 2), dclUsage(kUsageTexcoord, 0), dst(kRegOutput, 1) });
+
+    for (uint32_t i = 0; i < 4; i++) {
+      emit({ instruction(kOpDp4, 3), dst(kRegOutput, 0, 1u << i), src(kRegInput, 0), src(kRegConst, i) });
+    }
+
+    emit({ instruction(kOpMov, 2), dst(kRegTemp, 0), src(kRegInput, 1) });
+    for (uint32_t i = 0; i < 16 + seed * 4; i++) {
+      emit({ instruction(kOpMad, 4), dst(kRegTemp, 1), src(kRegTemp, 0, (i & 1) ? kSwizzleYZWX : kSwizzleXYZW),
+             src(kRegConst, 4 + (i + seed) % 200), src(kRegInput, 1) });
+      emit({ instruction(kOpMov, 2), dst(kRegTemp, 0), src(kRegTemp, 1) });
+    }
+    emit({ instruction(kOpMov, 2), dst(kRegOutput, 1), src(kRegTemp, 0) });
+    code.push_back(kEnd);
+    return code;
+  }
+
+  // ps_3_0: samples s0 and runs a chain of mads over the result
+  std::vector<uint32_t> createPixelShader(uint32_t seed) {
+    std::vector<uint32_t> code = { kPsVersion };
+    const auto emit = [&code] (std::initializer_list<uint32_t> tokens) {
+      code.insert(code.end(), tokens);
+    };
+
+    emit({ instruction(kOpDcl, 2), dclUsage(kUsageTexcoord, 0), dst(kRegInput, 0) });
+    // Texture type 2D in bits 27-30
+    emit({ instruction(kOpDcl, 2), 0x80000000u | (2u << 27), dst(kRegSampler, 0) });
+    emit({ instruction(kOpTex, 3), dst(kRegTemp, 0), src(kRegInput, 0), src(kRegSampler, 0) });
+
+    for (uint32_t i = 0; i < 16 + seed * 4; i++) {
+      emit({ instruction(kOpMad, 4), dst(kRegTemp, 0), src(kRegTemp, 0, (i & 1) ? kSwizzleYZWX : kSwizzleXYZW),
+             src(kRegConst, (i + seed) % 200), src(kRegConst, (i * 7 + seed) % 200) });
+    }
+    emit({ instruction(kOpMov, 2), dst(kRegColorOut, 0), src(kRegTemp, 0) });
+    code.push_back(kEnd);
+    return code;
+  }
+
+  DxsoModuleInfo createModuleInfo() {
+    DxsoModuleInfo moduleInfo;
+    DxsoOptions& options = moduleInfo.options;
+    options.useDemoteToHelperInvocation = true;
+    options.useSubgroupOpsForEarlyDiscard = false;
+    options.strictConstantCopies = false;
+    options.d3d9FloatEmulation = D3D9FloatEmulation::Enabled;
+    options.strictPow = true;
+    options.shaderModel = 3;
+    options.invariantPosition = true;
+    options.forceSamplerTypeSpecConstants = false;
+    options.vertexFloatConstantBufferAsSSBO = false;
+    options.longMad = false;
+    options.alphaTestWiggleRoom = false;
+    options.robustness2Supported = true;
+    return moduleInfo;
+  }
+
+  struct CompileResult {
+    std::array<std::vector<uint32_t>, D3D9ShaderPermutations::Count> code;
+  };
+
+  // What D3D9CommonShader does for each shader, minus the device
+  CompileResult compileShader(const DxsoModuleInfo& moduleInfo, const std::vector<uint32_t>& bytecode, uint32_t index) {
+    DxsoReader reader(reinterpret_cast<const char*>(bytecode.data()));
+    DxsoModule module(reader);
+    DxsoAnalysisInfo info = module.analyze();
+
+    const bool vertexShader = module.info().type() == DxsoProgramTypes::VertexShader;
+    const D3D9ConstantLayout layout = vertexShader
+      ? D3D9ConstantLayout { 256, 16, 16, 1 }
+      : D3D9ConstantLayout { 224, 16, 16, 1 };
+
+    const DxsoPermutations shaders = module.compile(moduleInfo, str::format("shader", index), info, layout);
+
+    CompileResult result;
+    for (uint32_t i = 0; i < D3D9ShaderPermutations::Count; i++) {
+      if (shaders[i] == nullptr) {
+        continue;
+      }
+      const SpirvCodeBuffer code = shaders[i]->compressedCode().decompress();
+      result.code[i].assign(code.data(), code.data() + code.dwords());
+    }
+    return result;
+  }
+
+  std::vector<std::vector<uint32_t>> createCorpus(uint32_t count) {
+    std::vector<std::vector<uint32_t>> corpus;
+    for (uint32_t i = 0; i < count; i++) {
+      corpus.push_back((i & 1) ? createPixelShader(i / 2) : createVertexShader(i / 2));
+    }
+    return corpus;
+  }
+
+  double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+  }
+} // anonymous namespace
+
+void testCompileJob() {
+  Logger::info("Testing compile jobs...");
+
+  // A job runs exactly once, no matter how many threads try to run it
+  std::atomic<uint32_t> runCount = 0;
+  Rc<DxsoCompileJob> job = new DxsoCompileJob([&runCount] () { runCount++; });
+  if (job->isDone()) {
+    throw DxvkError("testCompileJob: job finished before running");
+  }
+  if (!job->tryRun() || job->tryRun() || !job->isDone() || runCount != 1) {
+    throw DxvkError("testCompileJob: job didn't run exactly once");
+  }
+  job->wait();
+  if (runCount != 1) {
+    throw DxvkError("testCompileJob: waiting on a finished job ran it again");
+  }
+
+  // Waiting on a job that is stuck behind another one runs it on the calling thread
+  {
+    DxsoCompileWorkers workers(1);
+    std::atomic<bool> release = false;
+    std::atomic<bool> blockerStarted = false;
+    Rc<DxsoCompileJob> blocker = new DxsoCompileJob([&] () {
+      blockerStarted = true;
+      while (!release) {
+        std::this_thread::yield();
+      }
+    });
+    std::atomic<std::thread::id> runThread;
+    Rc<DxsoCompileJob> queued = new DxsoCompileJob([&runThread] () { runThread = std::this_thread::get_id(); });
+
+    workers.submit(blocker);
+    workers.submit(queued);
+    while (!blockerStarted) {
+      std::this_thread::yield();
+    }
+
+    queued->wait();
+    if (!queued->isDone() || runThread.load() != std::this_thread::get_id()) {
+      throw DxvkError("testCompileJob: waiting didn't run the queued job on the calling thread");
+    }
+    release = true;
+    blocker->wait();
+  }
+
+  // Destroying the workers runs the jobs that are still queued
+  runCount = 0;
+  std::vector<Rc<DxsoCompileJob>> jobs;
+  {
+    DxsoCompileWorkers workers(2);
+    for (uint32_t i = 0; i < 64; i++) {
+      jobs.push_back(new DxsoCompileJob([&runCount] () {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        runCount++;
+      }));
+      workers.submit(jobs.back());
+    }
+  }
+  for (const auto& queuedJob : jobs) {
+    if (!queuedJob->isDone()) {
+      throw DxvkError("testCompileJob: queued job was dropped by the workers");
+    }
+  }
+  if (runCount != jobs.size()) {
+    throw DxvkError(str::format("testCompileJob: expected ", jobs.size(), " runs, got ", runCount.load()));
+  }
+  Logger::info("Compile job test passed");
+}
+
+void testParallelCompile() {
+  Logger::info("Testing parallel shader compilation...");
+  const DxsoModuleInfo moduleInfo = createModuleInfo();
+  const std::vector<std::vector<uint32_t>> corpus = createCorpus(96);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  std::vector<CompileResult> serial;
+  for (uint32_t i = 0; i < corpus.size(); i++) {
+    serial.push_back(compileShader(moduleInfo, corpus[i], i));
+  }
+  const double serialMs = elapsedMs(start);
+
+  DxsoCompileWorkers workers(DxsoCompileWorkers::getDefaultWorkerCount());
+  std::vector<CompileResult> parallel(corpus.size());
+  std::vector<Rc<DxsoCompileJob>> jobs;
+
+  start = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < corpus.size(); i++) {
+    jobs.push_back(new DxsoCompileJob([&, i] () {
+      parallel[i] = compileShader(moduleInfo, corpus[i], i);
+    }));
+    workers.submit(jobs.back());
+  }
+  // The jobs are submitted in a burst, so some of them can end up running here
+  for (const auto& job : jobs) {
+    job->wait();
+  }
+  const double parallelMs = elapsedMs(start);
+
+  for (uint32_t i = 0; i < corpus.size(); i++) {
+    for (uint32_t p = 0; p < D3D9ShaderPermutations::Count; p++) {
+      if (serial[i].code[p] != parallel[i].code[p]) {
+        throw DxvkError(str::format("testParallelCompile: SPIR-V of shader ", i, " permutation ", p, " differs"));
+      }
+    }
+    if (serial[i].code[D3D9ShaderPermutations::None].empty()) {
+      throw DxvkError(str::format("testParallelCompile: shader ", i, " produced no SPIR-V"));
+    }
+  }
+
+  Logger::info(str::format("Compiled ", corpus.size(), " shaders: serial ", serialMs, " ms, ",
+                           workers.workerCount(), " workers ", parallelMs, " ms, speedup ", serialMs / parallelMs, "x"));
+  Logger::info("Parallel shader compilation test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_dxso_compile_workers...");
+
+  try {
+    dxvk::testCompileJob();
+    dxvk::testParallelCompile();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
@@ -0,0 +1,434 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxso/dxso_shader_cache.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_dxso_shader_cache.log");
+
+namespace {
+  constexpr size_t kFileHeaderSize = 28;
+  constexpr size_t kEntryHeaderSize = 44;
+
+  // A SPIR-V header followed by instructions with IDs of every encoded width
+  SpirvCodeBuffer createCode(uint32_t seed) {
+    std::vector<uint32_t> words = {
+      spv::MagicNumber, 0x00010300, 0, 0x100 + seed, 0,
+      (2 << 16) | spv::OpCapability, spv::CapabilityShader,
+      (4 << 16) | spv::OpDecorate, 7, spv::DecorationBinding, seed,
+      (4 << 16) | spv::OpDecorate, 0x1234, spv::DecorationSpecId, 0x123456,
+    };
+    for (uint32_t i = 0; i < 40 + seed; i++) {
+      words.push_back((2 << 16) | spv::OpNop);
+      words.push_back(seed * 0x01010101u + i);
+    }
+    return SpirvCodeBuffer(uint32_t(words.size()), words.data());
+  }
+
+  DxsoCachedShader createShader(uint32_t seed, bool pixelShader) {
+    DxsoCachedShader shader;
+    shader.bytecodeByteLength = 256 + seed * 4;
+    shader.usesDerivatives = pixelShader;
+    shader.usesKill = (seed & 1) != 0;
+
+    shader.isgn.elemCount = 2;
+    shader.isgn.elems[0].regNumber = 1;
+    shader.isgn.elems[0].semantic = DxsoSemantic { DxsoUsage::Texcoord, seed };
+    shader.isgn.elems[1].regNumber = 2;
+    shader.isgn.elems[1].centroid = true;
+    shader.osgn.elemCount = 1;
+    shader.osgn.elems[0].slot = 3;
+
+    shader.usedSamplers = 0x5 << seed;
+    shader.usedRTs = 0x1;
+    shader.meta.needsConstantCopies = true;
+    shader.meta.maxConstIndexF = 200 + seed;
+    shader.meta.boolConstantMask = 0xf0;
+    shader.constants.push_back(DxsoDefinedConstant { 4, { 1.f, 2.f, 3.f, float(seed) } });
+    shader.maxDefinedConst = 5;
+
+    const VkShaderStageFlagBits stage = pixelShader ? VK_SHADER_STAGE_FRAGMENT_BIT : VK_SHADER_STAGE_VERTEX_BIT;
+    const uint32_t permutationCount = pixelShader ? 2 : 1;
+    for (uint32_t i = 0; i < permutationCount; i++) {
+      shader.hasPermutation[i] = true;
+      shader.permutations[i].stage = stage;
+      shader.permutations[i].slots.push_back(DxvkResourceSlot(seed + i, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER));
+      shader.permutations[i].iface.inputSlots = 0xff;
+      shader.permutations[i].iface.outputSlots = seed;
+      shader.permutations[i].code = SpirvCompressedBuffer(createCode(seed + i), SpirvCompressionMode::Dictionary);
+    }
+    return shader;
+  }
+
+  bool sameCode(const SpirvCodeBuffer& a, const SpirvCodeBuffer& b) {
+    return a.dwords() == b.dwords() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+  }
+
+  void compareShaders(const char* context, const DxsoCachedShader& a, const DxsoCachedShader& b) {
+    if (a.bytecodeByteLength != b.bytecodeByteLength || a.usesDerivatives != b.usesDerivatives || a.usesKill != b.usesKill) {
+      throw DxvkError(str::format(context, ": analysis info doesn't match"));
+    }
+    for (const auto& [x, y] : { std::make_pair(&a.isgn, &b.isgn), std::make_pair(&a.osgn, &b.osgn) }) {
+      if (x->elemCount != y->elemCount) {
+        throw DxvkError(str::format(context, ": signature size doesn't match"));
+      }
+      for (uint32_t i = 0; i < x->elemCount; i++) {
+        const DxsoIsgnEntry& ex = x->elems[i];
+        const DxsoIsgnEntry& ey = y->elems[i];
+        if (ex.regNumber != ey.regNumber || ex.slot != ey.slot || ex.semantic != ey.semantic || ex.centroid != ey.centroid) {
+          throw DxvkError(str::format(context, ": signature entry ", i, " doesn't match"));
+        }
+      }
+    }
+    if (a.usedSamplers != b.usedSamplers || a.usedRTs != b.usedRTs || a.maxDefinedConst != b.maxDefinedConst ||
+        a.meta.needsConstantCopies != b.meta.needsConstantCopies || a.meta.maxConstIndexF != b.meta.maxConstIndexF ||
+        a.meta.boolConstantMask != b.meta.boolConstantMask) {
+      throw DxvkError(str::format(context, ": shader metadata doesn't match"));
+    }
+    if (a.constants.size() != b.constants.size() ||
+        (!a.constants.empty() && std::memcmp(a.constants.data(), b.constants.data(), sizeof(DxsoDefinedConstant) * a.constants.size()) != 0)) {
+      throw DxvkError(str::format(context, ": defined constants don't match"));
+    }
+    for (uint32_t i = 0; i < D3D9ShaderPermutations::Count; i++) {
+      if (a.hasPermutation[i] != b.hasPermutation[i]) {
+        throw DxvkError(str::format(context, ": permutation ", i, " presence doesn't match"));
+      }
+      if (!a.hasPermutation[i]) {
+        continue;
+      }
+      const DxsoCachedPermutation& pa = a.permutations[i];
+      const DxsoCachedPermutation& pb = b.permutations[i];
+      if (pa.stage != pb.stage || pa.slots.size() != pb.slots.size() ||
+          pa.iface.inputSlots != pb.iface.inputSlots || pa.iface.outputSlots != pb.iface.outputSlots) {
+        throw DxvkError(str::format(context, ": permutation ", i, " interface doesn't match"));
+      }
+      for (size_t s = 0; s < pa.slots.size(); s++) {
+        if (pa.slots[s].slot != pb.slots[s].slot || pa.slots[s].type != pb.slots[s].type) {
+          throw DxvkError(str::format(context, ": permutation ", i, " resource slots don't match"));
+        }
+      }
+      if (!sameCode(pa.code.decompress(), pb.code.decompress())) {
+        throw DxvkError(str::format(context, ": permutation ", i, " SPIR-V doesn't match"));
+      }
+    }
+  }
+
+  Sha1Hash makeKey(uint32_t seed) {
+    return Sha1Hash::compute(seed);
+  }
+
+  std::vector<uint8_t> readFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios_base::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  void writeFile(const std::filesystem::path& path, const std::vector<uint8_t>& data) {
+    std::ofstream file(path, std::ios_base::binary | std::ios_base::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+  }
+} // anonymous namespace
+
+void testSerializeRoundTrip() {
+  Logger::info("Testing shader cache entry round trip...");
+  for (bool pixelShader : { false, true }) {
+    const DxsoCachedShader shader = createShader(3, pixelShader);
+    const std::vector<uint8_t> payload = DxsoShaderCache::serialize(shader);
+
+    DxsoCachedShader restored;
+    if (!DxsoShaderCache::deserialize(payload.data(), payload.size(), restored)) {
+      throw DxvkError("testSerializeRoundTrip: failed to deserialize a freshly serialized shader");
+    }
+    compareShaders("testSerializeRoundTrip", shader, restored);
+
+    // The shader objects are recreated from the stored slots and code
+    const DxsoPermutations shaders = restored.createPermutations();
+    for (uint32_t i = 0; i < D3D9ShaderPermutations::Count; i++) {
+      if ((shaders[i] != nullptr) != shader.hasPermutation[i]) {
+        throw DxvkError(str::format("testSerializeRoundTrip: permutation ", i, " was not recreated"));
+      }
+      if (shaders[i] == nullptr) {
+        continue;
+      }
+      if (shaders[i]->stage() != shader.permutations[i].stage ||
+          shaders[i]->resourceSlots().size() != shader.permutations[i].slots.size() ||
+          !sameCode(shaders[i]->compressedCode().decompress(), shader.permutations[i].code.decompress())) {
+        throw DxvkError(str::format("testSerializeRoundTrip: permutation ", i, " doesn't match the cached data"));
+      }
+    }
+
+    // Capturing the recreated shaders again produces the same entry
+    DxsoCachedShader recaptured = restored;
+    recaptured.setPermutations(shaders);
+    if (DxsoShaderCache::serialize(recaptured) != payload) {
+      throw DxvkError("testSerializeRoundTrip: recaptured shader serializes differently");
+    }
+
+    // Truncated or padded payloads must be rejected rather than read out of bounds
+    for (size_t size = 0; size < payload.size(); size += 7) {
+      DxsoCachedShader truncated;
+      if (DxsoShaderCache::deserialize(payload.data(), size, truncated)) {
+        throw DxvkError(str::format("testSerializeRoundTrip: accepted a payload truncated to ", size, " bytes"));
+      }
+    }
+    std::vector<uint8_t> padded = payload;
+    padded.push_back(0);
+    DxsoCachedShader paddedShader;
+    if (DxsoShaderCache::deserialize(padded.data(), padded.size(), paddedShader)) {
+      throw DxvkError("testSerializeRoundTrip: accepted a payload with trailing data");
+    }
+  }
+
+  // Compressed code whose mask claims more data than there is
+  const SpirvCompressedBuffer code(createCode(1));
+  std::vector<uint64_t> shortCode(code.getCode().begin(), code.getCode().end() - 1);
+  if (!code.isValid() || SpirvCompressedBuffer(code.dwords(), code.getMask(), shortCode).isValid() ||
+      SpirvCompressedBuffer(code.dwords() + 64, code.getMask(), code.getCode()).isValid()) {
+    throw DxvkError("testSerializeRoundTrip: compressed code validation failed");
+  }
+  Logger::info("Shader cache entry round trip test passed");
+}
+
+void testCacheKey() {
+  Logger::info("Testing shader cache keys...");
+  DxsoModuleInfo moduleInfo;
+  DxsoOptions& options = moduleInfo.options;
+  options.useDemoteToHelperInvocation = true;
+  options.useSubgroupOpsForEarlyDiscard = false;
+  options.strictConstantCopies = false;
+  options.d3d9FloatEmulation = D3D9FloatEmulation::Enabled;
+  options.strictPow = true;
+  options.shaderModel = 3;
+  options.invariantPosition = false;
+  options.forceSamplerTypeSpecConstants = false;
+  options.vertexFloatConstantBufferAsSSBO = false;
+  options.longMad = false;
+  options.alphaTestWiggleRoom = false;
+  options.robustness2Supported = true;
+
+  const D3D9ConstantLayout layout = { 256, 16, 16, 1 };
+  const Sha1Hash bytecodeHash = Sha1Hash::compute("shader", 6);
+  const Sha1Hash key = DxsoShaderCache::computeKey(VK_SHADER_STAGE_VERTEX_BIT, bytecodeHash, moduleInfo, layout, 0);
+
+  if (DxsoShaderCache::computeKey(VK_SHADER_STAGE_VERTEX_BIT, bytecodeHash, moduleInfo, layout, 0) != key) {
+    throw DxvkError("testCacheKey: key is not deterministic");
+  }
+
+  DxsoModuleInfo changedOptions = moduleInfo;
+  changedOptions.options.longMad = true;
+  D3D9ConstantLayout changedLayout = layout;
+  changedLayout.floatCount = 8192;
+
+  const Sha1Hash otherKeys[] = {
+    DxsoShaderCache::computeKey(VK_SHADER_STAGE_FRAGMENT_BIT, bytecodeHash, moduleInfo, layout, 0),
+    DxsoShaderCache::computeKey(VK_SHADER_STAGE_VERTEX_BIT, Sha1Hash::compute("shadex", 6), moduleInfo, layout, 0),
+    DxsoShaderCache::computeKey(VK_SHADER_STAGE_VERTEX_BIT, bytecodeHash, changedOptions, layout, 0),
+    DxsoShaderCache::computeKey(VK_SHADER_STAGE_VERTEX_BIT, bytecodeHash, moduleInfo, changedLayout, 0),
+    DxsoShaderCache::computeKey(VK_SHADER_STAGE_VERTEX_BIT, bytecodeHash, moduleInfo, layout, 1),
+  };
+  for (size_t i = 0; i < std::size(otherKeys); i++) {
+    if (otherKeys[i] == key) {
+      throw DxvkError(str::format("testCacheKey: compiler input ", i, " is not part of the key"));
+    }
+  }
+  Logger::info("Shader cache key test passed");
+}
+
+void testCacheFile() {
+  Logger::info("Testing shader cache file...");
+  const std::filesystem::path cachePath = std::filesystem::temp_directory_path() / "test_dxso_shader_cache.dxso-cache";
+  std::error_code ec;
+  std::filesystem::remove(cachePath, ec);
+
+  std::vector<DxsoCachedShader> shaders;
+  for (uint32_t i = 0; i < 3; i++) {
+    shaders.push_back(createShader(i, i != 1));
+  }
+
+  {
+    DxsoShaderCache cache(cachePath.string(), "build-a");
+    if (cache.loadedEntryCount() != 0) {
+      throw DxvkError("testCacheFile: new cache should be empty");
+    }
+    DxsoCachedShader shader;
+    if (cache.lookup(makeKey(0), shader)) {
+      throw DxvkError("testCacheFile: empty cache should miss");
+    }
+    for (uint32_t i = 0; i < shaders.size(); i++) {
+      cache.store(makeKey(i), shaders[i]);
+    }
+    // Duplicates are not written again
+    cache.store(makeKey(0), shaders[0]);
+    cache.flush();
+    // Entries stored during this session aren't handed out, the caller keeps its own copy
+    if (cache.lookup(makeKey(0), shader)) {
+      throw DxvkError("testCacheFile: stored entries should not be returned in the same session");
+    }
+  }
+
+  size_t expectedFileSize = kFileHeaderSize;
+  for (const DxsoCachedShader& shader : shaders) {
+    expectedFileSize += kEntryHeaderSize + DxsoShaderCache::serialize(shader).size();
+  }
+  if (std::filesystem::file_size(cachePath) != expectedFileSize) {
+    throw DxvkError(str::format("testCacheFile: expected a ", expectedFileSize, " byte file, got ", std::filesystem::file_size(cachePath)));
+  }
+
+  {
+    DxsoShaderCache cache(cachePath.string(), "build-a");
+    if (cache.loadedEntryCount() != shaders.size() || cache.rejectedEntryCount() != 0) {
+      throw DxvkError(str::format("testCacheFile: expected ", shaders.size(), " entries, loaded ", cache.loadedEntryCount()));
+    }
+    for (uint32_t i = 0; i < shaders.size(); i++) {
+      DxsoCachedShader shader;
+      if (!cache.lookup(makeKey(i), shader)) {
+        throw DxvkError(str::format("testCacheFile: expected a hit for entry ", i));
+      }
+      compareShaders("testCacheFile", shaders[i], shader);
+    }
+    DxsoCachedShader shader;
+    if (cache.lookup(makeKey(0), shader)) {
+      throw DxvkError("testCacheFile: payloads should be released after a hit");
+    }
+  }
+
+  {
+    // A different build invalidates the whole file
+    DxsoShaderCache cache(cachePath.string(), "build-b");
+    DxsoCachedShader shader;
+    if (cache.loadedEntryCount() != 0 || cache.lookup(makeKey(0), shader)) {
+      throw DxvkError("testCacheFile: entries from another build should be discarded");
+    }
+    if (std::filesystem::file_size(cachePath) != kFileHeaderSize) {
+      throw DxvkError("testCacheFile: stale file should be reset");
+    }
+  }
+
+  std::filesystem::remove(cachePath, ec);
+  Logger::info("Shader cache file test passed");
+}
+
+void testCorruptedCacheFile() {
+  Logger::info("Testing corrupted shader cache files...");
+  const std::filesystem::path cachePath = std::filesystem::temp_directory_path() / "test_dxso_shader_cache_corrupt.dxso-cache";
+  std::error_code ec;
+  std::filesystem::remove(cachePath, ec);
+
+  std::vector<DxsoCachedShader> shaders;
+  std::vector<size_t> payloadSizes;
+  for (uint32_t i = 0; i < 3; i++) {
+    shaders.push_back(createShader(i, true));
+    payloadSizes.push_back(DxsoShaderCache::serialize(shaders.back()).size());
+  }
+
+  {
+    DxsoShaderCache cache(cachePath.string(), "build-a");
+    for (uint32_t i = 0; i < shaders.size(); i++) {
+      cache.store(makeKey(i), shaders[i]);
+    }
+  }
+
+  // Flip a byte in the middle of the second payload
+  std::vector<uint8_t> data = readFile(cachePath);
+  const size_t secondPayload = kFileHeaderSize + kEntryHeaderSize + payloadSizes[0] + kEntryHeaderSize;
+  data[secondPayload + payloadSizes[1] / 2] ^= 0x40;
+  writeFile(cachePath, data);
+
+  {
+    DxsoShaderCache cache(cachePath.string(), "build-a");
+    DxsoCachedShader shader;
+    if (cache.rejectedEntryCount() != 1 || cache.loadedEntryCount() != 2 || cache.lookup(makeKey(1), shader)) {
+      throw DxvkError("testCorruptedCacheFile: corrupted entry should be rejected");
+    }
+    if (!cache.lookup(makeKey(0), shader) || !cache.lookup(makeKey(2), shader)) {
+      throw DxvkError("testCorruptedCacheFile: entries around a corrupted entry should still load");
+    }
+    compareShaders("testCorruptedCacheFile", shaders[2], shader);
+  }
+
+  {
+    // The file was rewritten without the corrupted entry
+    DxsoShaderCache cache(cachePath.string(), "build-a");
+    if (cache.rejectedEntryCount() != 0 || cache.loadedEntryCount() != 2) {
+      throw DxvkError("testCorruptedCacheFile: file should have been rewritten without the corrupted entry");
+    }
+  }
+
+  // A write that was cut short only loses the last entry
+  data = readFile(cachePath);
+  data.resize(data.size() - 10);
+  writeFile(cachePath, data);
+  {
+    DxsoShaderCache cache(cachePath.string(), "build-a");
+    if (cache.rejectedEntryCount() != 1 || cache.loadedEntryCount() != 1) {
+      throw DxvkError("testCorruptedCacheFile: truncated entry should be rejected");
+    }
+  }
+
+  // Garbage instead of a header
+  writeFile(cachePath, std::vector<uint8_t>(100, 0xab));
+  {
+    DxsoShaderCache cache(cachePath.string(), "build-a");
+    if (cache.loadedEntryCount() != 0) {
+      throw DxvkError("testCorruptedCacheFile: file with an invalid header should be discarded");
+    }
+  }
+
+  std::filesystem::remove(cachePath, ec);
+  Logger::info("Corrupted shader cache file test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_dxso_shader_cache...");
+
+  try {
+    dxvk::testSerializeRoundTrip();
+    dxvk::testCacheKey();
+    dxvk::testCacheFile();
+    dxvk::testCorruptedCacheFile();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
@@ -0,0 +1,353 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <atomic>
+#include <chrono>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/dxvk_cs.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_dxvk_cs_queue.log");
+
+namespace {
+  // The mutex and condition variable handoff that DxvkCsQueue replaced, used as the benchmark baseline
+  class MutexChunkQueue {
+  public:
+    uint64_t push(DxvkCsChunkRef&& chunk) {
+      uint64_t seq;
+      { std::unique_lock<dxvk::mutex> lock(m_mutex);
+        seq = ++m_chunksDispatched;
+        m_chunksQueued.push(std::move(chunk));
+      }
+      m_condOnAdd.notify_one();
+      return seq;
+    }
+
+    bool pop(DxvkCsChunkRef& chunk) {
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_condOnAdd.wait(lock, [this] { return !m_chunksQueued.empty() || m_stopped; });
+      if (m_stopped) {
+        return false;
+      }
+      chunk = std::move(m_chunksQueued.front());
+      m_chunksQueued.pop();
+      return true;
+    }
+
+    void retire() {
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_chunksExecuted++;
+      m_condOnSync.notify_one();
+    }
+
+    void wait(uint64_t seq) {
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_condOnSync.wait(lock, [this, seq] { return m_chunksExecuted >= seq; });
+    }
+
+    void stop() {
+      { std::unique_lock<dxvk::mutex> lock(m_mutex);
+        m_stopped = true;
+      }
+      m_condOnAdd.notify_one();
+    }
+
+  private:
+    dxvk::mutex m_mutex;
+    dxvk::condition_variable m_condOnAdd;
+    dxvk::condition_variable m_condOnSync;
+    std::queue<DxvkCsChunkRef> m_chunksQueued;
+    uint64_t m_chunksDispatched = 0;
+    uint64_t m_chunksExecuted = 0;
+    bool m_stopped = false;
+  };
+
+  // Runs the same loop as DxvkCsThread, without a context
+  template<typename Queue>
+  class Consumer {
+  public:
+    explicit Consumer(Queue& queue)
+    : m_queue(queue), m_thread([this] {
+        DxvkCsChunkRef chunk;
+        while (m_queue.pop(chunk)) {
+          chunk->executeAll(nullptr);
+          chunk = DxvkCsChunkRef();
+          m_queue.retire();
+        }
+      }) { }
+
+    ~Consumer() {
+      m_queue.stop();
+      m_thread.join();
+    }
+
+  private:
+    Queue& m_queue;
+    dxvk::thread m_thread;
+  };
+
+  template<typename Fn>
+  DxvkCsChunkRef createChunk(DxvkCsChunkPool& pool, Fn&& fn) {
+    DxvkCsChunkRef chunk(pool.allocChunk(DxvkCsChunkFlag::SingleUse), &pool);
+    chunk->push(fn);
+    return chunk;
+  }
+} // anonymous namespace
+
+void testOrdering() {
+  Logger::info("Testing CS queue ordering...");
+  constexpr uint32_t kChunkCount = 200000;
+  DxvkCsChunkPool pool;
+  DxvkCsQueue queue;
+  std::vector<uint32_t> executed;
+  executed.reserve(kChunkCount);
+  std::mt19937 rng(3);
+
+  {
+    Consumer<DxvkCsQueue> consumer(queue);
+
+    for (uint32_t i = 0; i < kChunkCount; i++) {
+      const uint64_t seq = queue.push(createChunk(pool, [&executed, i] (DxvkContext*) { executed.push_back(i); }));
+      if (seq != i + 1) {
+        throw DxvkError(str::format("testOrdering: chunk ", i, " got sequence number ", seq));
+      }
+
+      // Nothing else is queued, so the consumer is done with the vector once the wait returns
+      if (rng() % 1000 == 0) {
+        queue.wait(seq);
+        if (executed.size() != seq || queue.executed() != seq) {
+          throw DxvkError(str::format("testOrdering: waiting for ", seq, " returned after ", executed.size(), " chunks"));
+        }
+      }
+
+      // Let the consumer park every now and then
+      if (rng() % 20000 == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+    }
+
+    queue.wait(queue.dispatched());
+  }
+
+  for (uint32_t i = 0; i < kChunkCount; i++) {
+    if (executed[i] != i) {
+      throw DxvkError(str::format("testOrdering: chunk ", executed[i], " executed in place of ", i));
+    }
+  }
+  Logger::info("CS queue ordering test passed");
+}
+
+void testSynchronizeAll() {
+  Logger::info("Testing CS queue synchronization...");
+  constexpr uint32_t kRounds = 2000;
+  DxvkCsChunkPool pool;
+  DxvkCsQueue queue;
+  std::atomic<uint64_t> executed = { 0ull };
+  std::atomic<bool> done = { false };
+  std::mt19937 rng(5);
+
+  Consumer<DxvkCsQueue> consumer(queue);
+
+  // Synchronizes with whatever was dispatched at the time, concurrently with the producer
+  std::atomic<uint32_t> waiterErrors = { 0u };
+  dxvk::thread waiter([&] {
+    while (!done.load()) {
+      const uint64_t seq = queue.dispatched();
+      queue.wait(seq);
+      if (executed.load() < seq) {
+        waiterErrors++;
+      }
+    }
+  });
+
+  for (uint32_t round = 0; round < kRounds; round++) {
+    // Some rounds overflow the ring, which moves chunks through the overflow list
+    const uint32_t count = round % 100 == 0 ? 3 * DxvkCsQueue::Capacity : rng() % 64;
+
+    for (uint32_t i = 0; i < count; i++) {
+      queue.push(createChunk(pool, [&executed] (DxvkContext*) { executed++; }));
+    }
+
+    const uint64_t seq = queue.dispatched();
+    queue.wait(seq);
+    if (executed.load() != seq) {
+      throw DxvkError(str::format("testSynchronizeAll: ", executed.load(), " chunks executed after synchronizing with ", seq));
+    }
+  }
+
+  done.store(true);
+  waiter.join();
+  if (waiterErrors.load() != 0) {
+    throw DxvkError("testSynchronizeAll: a concurrent wait returned early");
+  }
+  Logger::info("CS queue synchronization test passed");
+}
+
+void testQueueOverflow() {
+  Logger::info("Testing CS queue overflow...");
+  constexpr uint32_t kChunkCount = 3 * DxvkCsQueue::Capacity;
+  DxvkCsChunkPool pool;
+  DxvkCsQueue queue;
+  std::atomic<bool> release = { false };
+  std::vector<uint32_t> executed;
+  executed.reserve(kChunkCount);
+
+  Consumer<DxvkCsQueue> consumer(queue);
+  queue.push(createChunk(pool, [&release] (DxvkContext*) {
+    while (!release.load()) {
+      std::this_thread::yield();
+    }
+  }));
+
+  // The first chunk is blocked, so most of these go to the overflow list, without waiting for the consumer
+  for (uint32_t i = 0; i < kChunkCount; i++) {
+    queue.push(createChunk(pool, [&executed, i] (DxvkContext*) { executed.push_back(i); }));
+  }
+  if (queue.executed() != 0) {
+    throw DxvkError("testQueueOverflow: push waited for the consumer");
+  }
+
+  release.store(true);
+  queue.wait(queue.dispatched());
+
+  if (executed.size() != kChunkCount) {
+    throw DxvkError(str::format("testQueueOverflow: expected ", kChunkCount, " chunks, executed ", executed.size()));
+  }
+  for (uint32_t i = 0; i < kChunkCount; i++) {
+    if (executed[i] != i) {
+      throw DxvkError(str::format("testQueueOverflow: chunk ", executed[i], " executed in place of ", i));
+    }
+  }
+  Logger::info("CS queue overflow test passed");
+}
+
+void testMultipleProducers() {
+  Logger::info("Testing CS queue with multiple producers...");
+  constexpr uint32_t kThreadCount = 4;
+  constexpr uint32_t kChunkCount = 50000;
+  DxvkCsChunkPool pool;
+  DxvkCsQueue queue;
+  // Only written by the consumer thread
+  std::vector<uint32_t> nextChunk(kThreadCount, 0u);
+  uint32_t orderErrors = 0;
+
+  {
+    Consumer<DxvkCsQueue> consumer(queue);
+
+    // Same as application threads sharing a device that was created without D3DCREATE_MULTITHREADED
+    std::vector<dxvk::thread> producers;
+    for (uint32_t t = 0; t < kThreadCount; t++) {
+      producers.emplace_back([&, t] {
+        for (uint32_t i = 0; i < kChunkCount; i++) {
+          queue.push(createChunk(pool, [&nextChunk, &orderErrors, t, i] (DxvkContext*) {
+            orderErrors += nextChunk[t] != i ? 1 : 0;
+            nextChunk[t] = i + 1;
+          }));
+        }
+      });
+    }
+    for (auto& producer : producers) {
+      producer.join();
+    }
+
+    queue.wait(queue.dispatched());
+    if (queue.dispatched() != kThreadCount * kChunkCount) {
+      throw DxvkError(str::format("testMultipleProducers: ", queue.dispatched(), " chunks dispatched"));
+    }
+  }
+
+  for (uint32_t t = 0; t < kThreadCount; t++) {
+    if (nextChunk[t] != kChunkCount) {
+      throw DxvkError(str::format("testMultipleProducers: thread ", t, " executed ", nextChunk[t], " chunks"));
+    }
+  }
+  if (orderErrors != 0) {
+    throw DxvkError("testMultipleProducers: chunks of a producer executed out of order");
+  }
+  Logger::info("CS queue multiple producers test passed");
+}
+
+template<typename Queue>
+double measureDispatch(const char* name, uint32_t chunkCount) {
+  DxvkCsChunkPool pool;
+  Queue queue;
+  Consumer<Queue> consumer(queue);
+
+  auto t0 = std::chrono::high_resolution_clock::now();
+  uint64_t seq = 0;
+  for (uint32_t i = 0; i < chunkCount; i++) {
+    seq = queue.push(createChunk(pool, [] (DxvkContext*) { }));
+  }
+  auto t1 = std::chrono::high_resolution_clock::now();
+  queue.wait(seq);
+  auto t2 = std::chrono::high_resolution_clock::now();
+
+  const double dispatchNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / chunkCount;
+  const double totalNs = std::chrono::duration<double, std::nano>(t2 - t0).count() / chunkCount;
+  Logger::info(str::format(name, ": ", dispatchNs, " ns per dispatch, ", totalNs, " ns per chunk until synchronized"));
+  return dispatchNs;
+}
+
+void testDispatchThroughput() {
+  Logger::info("Measuring CS chunk dispatch throughput...");
+  constexpr uint32_t kChunkCount = 2000000;
+  const double mutexNs = measureDispatch<MutexChunkQueue>("Mutex queue", kChunkCount);
+  const double ringNs = measureDispatch<DxvkCsQueue>("Lock-free queue", kChunkCount);
+  Logger::info(str::format("Dispatch speedup: ", mutexNs / ringNs, "x"));
+  Logger::info("CS chunk dispatch throughput test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_dxvk_cs_queue...");
+
+  try {
+    dxvk::testOrdering();
+    dxvk::testSynchronizeAll();
+    dxvk::testQueueOverflow();
+    dxvk::testMultipleProducers();
+    dxvk::testDispatchThroughput();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
@@ -0,0 +1,527 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/dxvk_state_cache_file.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_dxvk_state_cache.log");
+
+namespace {
+  // Entries and their pipelines, in the order a game would have recorded them
+  struct CacheContents {
+    std::vector<DxvkStateCacheKey> pipelines;
+    std::vector<DxvkStateCacheEntry> entries;
+  };
+
+  DxvkShaderKey makeShaderKey(VkShaderStageFlagBits stage, uint32_t seed) {
+    const uint32_t data[2] = { uint32_t(stage), seed };
+    return DxvkShaderKey(stage, Sha1Hash::compute(data, sizeof(data)));
+  }
+
+  DxvkStateCacheKey makePipelineKey(uint32_t seed, bool compute) {
+    DxvkStateCacheKey key;
+
+    if (compute) {
+      key.cs = makeShaderKey(VK_SHADER_STAGE_COMPUTE_BIT, seed);
+    } else {
+      key.vs = makeShaderKey(VK_SHADER_STAGE_VERTEX_BIT, seed);
+      key.fs = makeShaderKey(VK_SHADER_STAGE_FRAGMENT_BIT, seed);
+    }
+
+    return key;
+  }
+
+  DxvkStateCacheEntry makeEntry(const DxvkStateCacheKey& shaders, std::mt19937& rng) {
+    DxvkStateCacheEntry entry;
+    entry.shaders = shaders;
+
+    if (!shaders.cs.eq(DxvkShaderKey())) {
+      entry.cpState.bsBindingMask.set(rng() % MaxNumActiveBindings, true);
+      entry.cpState.sc.specConstants[rng() % MaxNumSpecConstants] = rng();
+      return entry;
+    }
+
+    entry.format.depth = { VK_FORMAT_D24_UNORM_S8_UINT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+    entry.format.color[0] = { VK_FORMAT_B8G8R8A8_UNORM, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+
+    DxvkGraphicsPipelineStateInfo& state = entry.gpState;
+    const uint32_t attributeCount = 1 + rng() % 4;
+
+    state.bsBindingMask.set(rng() % MaxNumActiveBindings, true);
+    state.ia = DxvkIaInfo(VkPrimitiveTopology(rng() % 6), VK_FALSE, 0);
+    state.il = DxvkIlInfo(attributeCount, 1);
+
+    for (uint32_t i = 0; i < attributeCount; i++)
+      state.ilAttributes[i] = DxvkIlAttribute(i, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 16 * i);
+
+    state.ilBindings[0] = DxvkIlBinding(0, 16 * attributeCount, VK_VERTEX_INPUT_RATE_VERTEX, 0);
+    state.rs = DxvkRsInfo(VK_TRUE, rng() & 1, VK_POLYGON_MODE_FILL, VkCullModeFlags(rng() % 3),
+      VK_FRONT_FACE_CLOCKWISE, 1, VK_SAMPLE_COUNT_1_BIT, VK_CONSERVATIVE_RASTERIZATION_MODE_DISABLED_EXT);
+    state.ms = DxvkMsInfo(VK_SAMPLE_COUNT_1_BIT, 0xffff, VK_FALSE);
+    state.ds = DxvkDsInfo(VK_TRUE, rng() & 1, VK_FALSE, VK_FALSE, VK_COMPARE_OP_LESS_OR_EQUAL);
+    state.om = DxvkOmInfo(VK_FALSE, VK_LOGIC_OP_COPY);
+    state.omBlend[0] = DxvkOmAttachmentBlend(rng() & 1,
+      VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD,
+      VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, 0xf);
+    state.sc.specConstants[rng() % MaxNumSpecConstants] = rng();
+    return entry;
+  }
+
+  // Pipelines are interleaved, like a game recording states as it goes
+  CacheContents makeContents(uint32_t pipelineCount, uint32_t entryCount, uint32_t seed) {
+    std::mt19937 rng(seed);
+    CacheContents contents;
+
+    for (uint32_t i = 0; i < pipelineCount; i++)
+      contents.pipelines.push_back(makePipelineKey(seed * 100000 + i, i % 8 == 7));
+
+    for (uint32_t i = 0; i < entryCount; i++) {
+      // Every pipeline is used once before any is reused, so first-use order is known
+      const uint32_t pipeline = i < pipelineCount ? i : rng() % pipelineCount;
+      contents.entries.push_back(makeEntry(contents.pipelines[pipeline], rng));
+    }
+
+    return contents;
+  }
+
+  bool sameEntry(const DxvkStateCacheEntry& a, const DxvkStateCacheEntry& b) {
+    return a.shaders.eq(b.shaders)
+        && a.gpState == b.gpState
+        && a.cpState == b.cpState
+        && a.format.eq(b.format);
+  }
+
+  std::string makeHeader(uint32_t version, uint32_t entrySize) {
+    DxvkStateCacheHeader header;
+    header.version = version;
+    header.entrySize = entrySize;
+    return std::string(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+
+  // Fixed-size entries as written by v2 to v7, hashed with a null hash in place
+  template<typename T>
+  void appendLegacyEntry(std::string& file, T entry) {
+    entry.hash = Sha1Hash::compute(nullptr, 0);
+    entry.hash = Sha1Hash::compute(entry);
+    file.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+  }
+
+  std::string makeV7File(const CacheContents& contents) {
+    std::string file = makeHeader(7, sizeof(DxvkStateCacheEntry));
+
+    for (const auto& entry : contents.entries)
+      appendLegacyEntry(file, entry);
+
+    return file;
+  }
+
+  std::string makeV12File(const CacheContents& contents) {
+    std::ostringstream stream;
+    stream << makeHeader(12, 0);
+
+    for (const auto& entry : contents.entries)
+      DxvkStateCacheFile::writeEntry(stream, entry);
+
+    return stream.str();
+  }
+
+  void writeFile(const std::filesystem::path& path, const std::string& data) {
+    std::ofstream file(path, std::ios_base::binary | std::ios_base::trunc);
+    file.write(data.data(), data.size());
+  }
+
+  std::string readFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios_base::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  void appendEntries(const std::filesystem::path& path, const std::vector<DxvkStateCacheEntry>& entries) {
+    std::ofstream file(path, std::ios_base::binary | std::ios_base::app);
+
+    for (const auto& entry : entries)
+      DxvkStateCacheFile::writeEntry(file, entry);
+  }
+
+  // Checks that the file holds exactly the given entries, grouped by pipeline in first-use order
+  void checkContents(const char* context, DxvkStateCacheFile& file, const CacheContents& contents) {
+    if (file.pipelineCount() != contents.pipelines.size() || file.entryCount() != contents.entries.size()) {
+      throw DxvkError(str::format(context, ": expected ", contents.pipelines.size(), " pipelines and ", contents.entries.size(),
+        " entries, got ", file.pipelineCount(), " and ", file.entryCount()));
+    }
+
+    for (uint32_t p = 0; p < contents.pipelines.size(); p++) {
+      if (!file.getPipelineKey(p).eq(contents.pipelines[p]) || file.findPipeline(contents.pipelines[p]) != p) {
+        throw DxvkError(str::format(context, ": pipeline ", p, " is out of first-use order"));
+      }
+
+      const auto& entries = file.getEntries(p);
+      size_t next = 0;
+
+      for (const auto& expected : contents.entries) {
+        if (!expected.shaders.eq(contents.pipelines[p]))
+          continue;
+
+        if (next >= entries.size() || !sameEntry(entries[next], expected)) {
+          throw DxvkError(str::format(context, ": entry ", next, " of pipeline ", p, " doesn't match"));
+        }
+
+        next++;
+      }
+
+      if (next != entries.size()) {
+        throw DxvkError(str::format(context, ": pipeline ", p, " has ", entries.size(), " entries, expected ", next));
+      }
+    }
+
+    if (file.invalidEntryCount() != 0) {
+      throw DxvkError(str::format(context, ": ", file.invalidEntryCount(), " entries failed validation"));
+    }
+  }
+
+  const std::filesystem::path kCachePath = std::filesystem::temp_directory_path() / "test_dxvk_state_cache.dxvk-cache";
+} // anonymous namespace
+
+void testLegacyConversion() {
+  Logger::info("Testing legacy state cache conversion...");
+  const CacheContents contents = makeContents(64, 1000, 1);
+
+  for (uint32_t version : { 7u, 12u }) {
+    const std::string legacyFile = version == 7 ? makeV7File(contents) : makeV12File(contents);
+
+    // Parallel conversion must produce the same result as the serial one
+    for (uint32_t numThreads : { 1u, 8u }) {
+      writeFile(kCachePath, legacyFile);
+
+      DxvkStateCacheFile file;
+
+      if (file.open(kCachePath, numThreads)) {
+        throw DxvkError(str::format("testLegacyConversion: v", version, " file should need a rewrite"));
+      }
+
+      checkContents(str::format("testLegacyConversion: v", version, " with ", numThreads, " threads").c_str(), file, contents);
+    }
+
+    // Rewriting produces an indexed file whose entries are parsed on demand
+    { DxvkStateCacheFile file;
+      file.open(kCachePath, 4);
+
+      if (!file.write(kCachePath)) {
+        throw DxvkError("testLegacyConversion: failed to rewrite the cache file");
+      }
+    }
+
+    DxvkStateCacheFile file;
+
+    if (!file.open(kCachePath, 4) || file.tailEntryCount() != 0) {
+      throw DxvkError(str::format("testLegacyConversion: rewritten v", version, " file should be up to date"));
+    }
+
+    checkContents("testLegacyConversion: rewritten file", file, contents);
+  }
+
+  std::filesystem::remove(kCachePath);
+  Logger::info("Legacy state cache conversion test passed");
+}
+
+void testLegacyStateConversion() {
+  Logger::info("Testing legacy pipeline state conversion...");
+  const DxvkStateCacheKey key = makePipelineKey(7, false);
+
+  DxvkStateCacheEntryV4 v4 = { };
+  v4.shaders = key;
+  v4.gpState.iaPrimitiveTopology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+  v4.gpState.rsDepthClipEnable = VK_TRUE;
+  v4.gpState.rsDepthBiasEnable = VK_TRUE;
+  v4.gpState.rsCullMode = VK_CULL_MODE_BACK_BIT;
+  v4.gpState.dsEnableDepthTest = VK_TRUE;
+  v4.gpState.dsDepthCompareOp = VK_COMPARE_OP_GREATER;
+
+  DxvkStateCacheEntryV6 v6 = { };
+  v6.shaders = makePipelineKey(8, true);
+  v6.cpState.scSpecConstants[3] = 42;
+
+  DxvkStateCacheEntryV6 v6Graphics = { };
+  v6Graphics.shaders = key;
+  v6Graphics.gpState.ilAttributeCount = 1;
+  v6Graphics.gpState.ilAttributes[0] = { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 };
+  v6Graphics.gpState.scSpecConstants[5] = 7;
+
+  // v2 stored depth clamp rather than depth clip, and depth bias is dropped
+  for (uint32_t version : { 2u, 4u }) {
+    std::string data = makeHeader(version, sizeof(DxvkStateCacheEntryV4));
+    appendLegacyEntry(data, v4);
+    writeFile(kCachePath, data);
+
+    DxvkStateCacheFile file;
+    file.open(kCachePath, 1);
+
+    if (file.pipelineCount() != 1 || file.getEntries(0).size() != 1) {
+      throw DxvkError(str::format("testLegacyStateConversion: v", version, " entry was not read"));
+    }
+
+    const DxvkGraphicsPipelineStateInfo& state = file.getEntries(0)[0].gpState;
+    const bool expectClip = version != 2;
+
+    if (state.ia.primitiveTopology() != VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP
+     || bool(state.rs.depthClipEnable()) != expectClip
+     || bool(state.rs.depthBiasEnable()) != expectClip
+     || state.rs.cullMode() != VK_CULL_MODE_BACK_BIT
+     || !state.ds.enableDepthTest()
+     || state.ds.depthCompareOp() != VK_COMPARE_OP_GREATER) {
+      throw DxvkError(str::format("testLegacyStateConversion: v", version, " graphics state was not converted"));
+    }
+  }
+
+  // Spec constants stay with the pipeline type they belong to
+  { std::string data = makeHeader(6, sizeof(DxvkStateCacheEntryV6));
+    appendLegacyEntry(data, v6Graphics);
+    appendLegacyEntry(data, v6);
+
+    // Entries with a bad hash are skipped
+    appendLegacyEntry(data, v6);
+    data[data.size() - sizeof(DxvkStateCacheEntryV6) + 200] ^= 0x55;
+    writeFile(kCachePath, data);
+
+    DxvkStateCacheFile file;
+    file.open(kCachePath, 1);
+
+    if (file.pipelineCount() != 2 || file.getEntries(0).size() != 1 || file.getEntries(1).size() != 1
+     || file.invalidEntryCount() != 1) {
+      throw DxvkError("testLegacyStateConversion: v6 entries were not read");
+    }
+
+    const DxvkStateCacheEntry& graphics = file.getEntries(0)[0];
+    const DxvkStateCacheEntry& compute = file.getEntries(1)[0];
+
+    if (graphics.gpState.sc.specConstants[5] != 7 || graphics.gpState.il.attributeCount() != 1
+     || graphics.gpState.ilAttributes[0].format() != VK_FORMAT_R32G32B32_SFLOAT
+     || compute.cpState.sc.specConstants[3] != 42) {
+      throw DxvkError("testLegacyStateConversion: v6 state was not converted");
+    }
+  }
+
+  std::filesystem::remove(kCachePath);
+  Logger::info("Legacy pipeline state conversion test passed");
+}
+
+void testIndexedFile() {
+  Logger::info("Testing indexed state cache file...");
+  CacheContents contents = makeContents(32, 400, 2);
+  writeFile(kCachePath, makeV12File(contents));
+
+  { DxvkStateCacheFile file;
+    file.open(kCachePath, 2);
+    file.write(kCachePath);
+  }
+
+  // Entries appended by the writer show up without rewriting the file
+  CacheContents appended = makeContents(4, 12, 3);
+  std::mt19937 rng(4);
+
+  for (uint32_t i = 0; i < 4; i++)
+    appended.entries.push_back(makeEntry(contents.pipelines[i], rng));
+
+  appendEntries(kCachePath, appended.entries);
+
+  CacheContents combined = contents;
+  combined.pipelines.insert(combined.pipelines.end(), appended.pipelines.begin(), appended.pipelines.end());
+  combined.entries.insert(combined.entries.end(), appended.entries.begin(), appended.entries.end());
+
+  { DxvkStateCacheFile file;
+
+    if (!file.open(kCachePath, 2) || file.tailEntryCount() != appended.entries.size()) {
+      throw DxvkError("testIndexedFile: a small tail should not require a rewrite");
+    }
+
+    checkContents("testIndexedFile: small tail", file, combined);
+  }
+
+  // A large tail gets folded into the index
+  CacheContents large = makeContents(16, 300, 5);
+  appendEntries(kCachePath, large.entries);
+
+  combined.pipelines.insert(combined.pipelines.end(), large.pipelines.begin(), large.pipelines.end());
+  combined.entries.insert(combined.entries.end(), large.entries.begin(), large.entries.end());
+
+  { DxvkStateCacheFile file;
+
+    if (file.open(kCachePath, 2)) {
+      throw DxvkError("testIndexedFile: a large tail should require a rewrite");
+    }
+
+    checkContents("testIndexedFile: large tail", file, combined);
+    file.write(kCachePath);
+  }
+
+  { DxvkStateCacheFile file;
+
+    if (!file.open(kCachePath, 2) || file.tailEntryCount() != 0) {
+      throw DxvkError("testIndexedFile: reindexed file should have no tail");
+    }
+
+    checkContents("testIndexedFile: reindexed", file, combined);
+  }
+
+  const std::string indexed = readFile(kCachePath);
+  const size_t dataOffset = sizeof(DxvkStateCacheHeader) + sizeof(DxvkStateCacheIndexHeader)
+    + sizeof(DxvkStateCacheIndexEntry) * combined.pipelines.size();
+
+  // Corrupt entries are only noticed, and skipped, when their pipeline is parsed
+  { std::string corrupt = indexed;
+    corrupt[dataOffset + 40] ^= 0x55;
+    writeFile(kCachePath, corrupt);
+
+    DxvkStateCacheFile file;
+
+    if (!file.open(kCachePath, 2) || file.invalidEntryCount() != 0) {
+      throw DxvkError("testIndexedFile: entry data should not be validated on open");
+    }
+
+    size_t total = 0;
+
+    for (uint32_t p = 0; p < file.pipelineCount(); p++)
+      total += file.getEntries(p).size();
+
+    if (file.invalidEntryCount() != 1 || total + 1 != combined.entries.size()) {
+      throw DxvkError("testIndexedFile: corrupt entry should be skipped");
+    }
+  }
+
+  // A corrupt or truncated index invalidates the whole file
+  for (size_t offset : { sizeof(DxvkStateCacheHeader) + sizeof(DxvkStateCacheIndexHeader) + 8, size_t(0) }) {
+    std::string corrupt = indexed;
+
+    if (offset)
+      corrupt[offset] ^= 0x55;
+    else
+      corrupt.resize(dataOffset / 2);
+
+    writeFile(kCachePath, corrupt);
+
+    DxvkStateCacheFile file;
+
+    if (file.open(kCachePath, 2) || file.pipelineCount() != 0) {
+      throw DxvkError("testIndexedFile: corrupt index should be rejected");
+    }
+  }
+
+  std::filesystem::remove(kCachePath);
+
+  DxvkStateCacheFile file;
+
+  if (file.open(kCachePath, 2) || file.pipelineCount() != 0) {
+    throw DxvkError("testIndexedFile: opening a missing file should fail");
+  }
+
+  Logger::info("Indexed state cache file test passed");
+}
+
+void benchmarkLoad() {
+  Logger::info("Benchmarking state cache loading...");
+  const CacheContents contents = makeContents(4000, 40000, 6);
+  const std::string legacyFile = makeV12File(contents);
+  const uint32_t numThreads = std::max(dxvk::thread::hardware_concurrency(), 1u);
+
+  using clock = std::chrono::high_resolution_clock;
+
+  const auto measure = [] (auto&& fn) {
+    const auto t0 = clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+  };
+
+  const uint32_t threadCounts[] = { 1u, numThreads };
+  double legacyMs[2] = { };
+
+  for (uint32_t i = 0; i < 2; i++) {
+    writeFile(kCachePath, legacyFile);
+
+    DxvkStateCacheFile file;
+    legacyMs[i] = measure([&] { file.open(kCachePath, threadCounts[i]); });
+
+    if (file.entryCount() != contents.entries.size()) {
+      throw DxvkError("benchmarkLoad: legacy file was not fully read");
+    }
+
+    if (i == 1)
+      file.write(kCachePath);
+  }
+
+  DxvkStateCacheFile file;
+  const double indexedMs = measure([&] { file.open(kCachePath, numThreads); });
+
+  // Prewarming the first tenth of the pipelines, as a game's first scene would
+  const double firstUseMs = measure([&] {
+    for (uint32_t p = 0; p < file.pipelineCount() / 10; p++)
+      file.getEntries(p);
+  });
+
+  Logger::info(str::format("  ", contents.entries.size(), " entries in ", contents.pipelines.size(), " pipelines, ",
+    legacyFile.size() >> 10, " KiB"));
+  Logger::info(str::format("  v12 full parse, 1 thread:     ", legacyMs[0], " ms"));
+  Logger::info(str::format("  v12 full parse, ", numThreads, " threads:    ", legacyMs[1], " ms"));
+  Logger::info(str::format("  indexed open:                 ", indexedMs, " ms"));
+  Logger::info(str::format("  indexed, first 10% parsed:    ", firstUseMs, " ms"));
+
+  std::filesystem::remove(kCachePath);
+  Logger::info("State cache loading benchmark done");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_dxvk_state_cache...");
+
+  try {
+    dxvk::testLegacyConversion();
+    dxvk::testLegacyStateConversion();
+    dxvk::testIndexedFile();
+    dxvk::benchmarkLoad();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
@@ -0,0 +1,124 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "rtx_render/rtx_file_watch.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_file_watch_coalescer.log");
+
+using namespace std::chrono_literals;
+
+void testQuietPeriod() {
+  Logger::info("Testing file change coalescing...");
+  FileChangeCoalescer coalescer { 100ms, 1000ms };
+  const auto t0 = FileChangeCoalescer::Clock::now();
+
+  if (!coalescer.empty() || !coalescer.flush(t0).empty()) {
+    throw DxvkError("testQuietPeriod: a new coalescer should have nothing to flush");
+  }
+
+  // a burst: the same file is written several times, interleaved with another file
+  coalescer.push("a.dds", t0);
+  coalescer.push("b.dds", t0 + 10ms);
+  coalescer.push("a.dds", t0 + 20ms);
+  coalescer.push("a.dds", t0 + 50ms);
+
+  if (coalescer.pendingNotificationCount() != 4) {
+    throw DxvkError("testQuietPeriod: every notification should be counted");
+  }
+  if (!coalescer.flush(t0 + 149ms).empty()) {
+    throw DxvkError("testQuietPeriod: batch released before the quiet period has passed since the last change");
+  }
+  if (coalescer.timeUntilFlush(t0 + 120ms) != 30ms) {
+    throw DxvkError("testQuietPeriod: unexpected time until flush");
+  }
+
+  const std::vector<std::filesystem::path> batch = coalescer.flush(t0 + 150ms);
+  if (batch.size() != 2 || batch[0] != "a.dds" || batch[1] != "b.dds") {
+    throw DxvkError(str::format("testQuietPeriod: expected 2 deduplicated paths in the order of the first change, got ", batch.size()));
+  }
+  if (!coalescer.empty() || coalescer.pendingNotificationCount() != 0) {
+    throw DxvkError("testQuietPeriod: flush should leave the coalescer empty");
+  }
+  Logger::info("File change coalescing test passed");
+}
+
+void testMaxDelay() {
+  Logger::info("Testing file change coalescing max delay...");
+  FileChangeCoalescer coalescer { 100ms, 300ms };
+  const auto t0 = FileChangeCoalescer::Clock::now();
+
+  // a file that keeps changing without a pause must still be released after 'maxDelay'
+  for (int i = 0; i < 10; i++) {
+    coalescer.push("streamed.dds", t0 + i * 50ms);
+  }
+  if (!coalescer.flush(t0 + 299ms).empty()) {
+    throw DxvkError("testMaxDelay: batch released too early");
+  }
+  if (coalescer.timeUntilFlush(t0 + 250ms) != 50ms) {
+    throw DxvkError("testMaxDelay: time until flush should be bounded by the max delay");
+  }
+  if (coalescer.flush(t0 + 300ms).size() != 1) {
+    throw DxvkError("testMaxDelay: batch should be released once the max delay has passed");
+  }
+
+  // the next change starts a new batch with its own max delay
+  coalescer.push("streamed.dds", t0 + 310ms);
+  if (!coalescer.flush(t0 + 400ms).empty() || coalescer.flush(t0 + 410ms).size() != 1) {
+    throw DxvkError("testMaxDelay: a new batch should wait for its own quiet period");
+  }
+  Logger::info("File change coalescing max delay test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_file_watch_coalescer...");
+
+  try {
+    dxvk::testQuietPeriod();
+    dxvk::testMaxDelay();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
@@ -0,0 +1,237 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "rtx_render/rtx_geometry_interleaver.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_geometry_interleaver.log");
+
+namespace {
+  constexpr uint32_t R8G8B8A8_UNORM = 37;
+  constexpr uint32_t B8G8R8A8_UNORM = 44;
+  constexpr uint32_t A2B10G10R10_SNORM_PACK32 = 65;
+  constexpr uint32_t R32G32_SFLOAT = 103;
+  constexpr uint32_t R32G32B32_SFLOAT = 106;
+  constexpr uint32_t R32G32B32A32_SFLOAT = 109;
+  // Not supported by the interleaver, exercises the fallback values
+  constexpr uint32_t R16G16B16A16_SFLOAT = 97;
+
+  const uint32_t kFloatFormats[] = { R32G32_SFLOAT, R32G32B32_SFLOAT, R32G32B32A32_SFLOAT, R8G8B8A8_UNORM, A2B10G10R10_SNORM_PACK32, R16G16B16A16_SFLOAT };
+
+  uint32_t formatSizeInFloats(uint32_t format) {
+    switch (format) {
+    case R32G32_SFLOAT: return 2;
+    case R32G32B32_SFLOAT: return 3;
+    case R32G32B32A32_SFLOAT: return 4;
+    case R16G16B16A16_SFLOAT: return 2;
+    default: return 1;
+    }
+  }
+
+  // Fills a buffer with values that are valid for the format, or random bits for the packed formats
+  std::vector<float> makeSource(std::mt19937& rng, uint32_t format, uint32_t stride, uint32_t numVertices) {
+    std::vector<float> data(numVertices * stride);
+    std::uniform_real_distribution<float> dist(-100.f, 100.f);
+    for (uint32_t i = 0; i < data.size(); i++) {
+      if (formatSizeInFloats(format) == 1 || format == R16G16B16A16_SFLOAT) {
+        const uint32_t bits = rng();
+        memcpy(&data[i], &bits, sizeof(bits));
+      } else {
+        data[i] = dist(rng);
+      }
+    }
+    return data;
+  }
+
+  struct Layout {
+    uint32_t positionFormat;
+    bool hasNormals;
+    uint32_t normalFormat;
+    bool hasTexcoord;
+    uint32_t texcoordFormat;
+    bool hasColor0;
+    uint32_t color0Format;
+  };
+
+  std::string describe(const Layout& layout, uint32_t vertexCount) {
+    return str::format("position ", layout.positionFormat,
+                       ", normal ", layout.hasNormals ? std::to_string(layout.normalFormat) : "-",
+                       ", texcoord ", layout.hasTexcoord ? std::to_string(layout.texcoordFormat) : "-",
+                       ", color0 ", layout.hasColor0 ? std::to_string(layout.color0Format) : "-",
+                       ", ", vertexCount, " vertices");
+  }
+
+  void checkLayout(std::mt19937& rng, const Layout& layout, uint32_t vertexCount, uint32_t minVertexIndex) {
+    InterleaveGeometryArgs args = {};
+    // Give each attribute its own buffer with some padding between vertices and an offset into the buffer.  Buffers end
+    // right after the last vertex, so reads past the end are caught by sanitizers.
+    const uint32_t numSourceVertices = vertexCount + minVertexIndex;
+    args.positionFormat = layout.positionFormat;
+    args.positionOffset = 1;
+    args.positionStride = formatSizeInFloats(layout.positionFormat) + 2;
+    args.hasNormals = layout.hasNormals;
+    args.normalFormat = layout.normalFormat;
+    args.normalOffset = 2;
+    args.normalStride = formatSizeInFloats(layout.normalFormat) + 3;
+    args.hasTexcoord = layout.hasTexcoord;
+    args.texcoordFormat = layout.texcoordFormat;
+    args.texcoordOffset = 0;
+    args.texcoordStride = formatSizeInFloats(layout.texcoordFormat);
+    args.hasColor0 = layout.hasColor0;
+    args.color0Format = layout.color0Format;
+    args.color0Offset = 3;
+    args.color0Stride = 1;
+    args.minVertexIndex = minVertexIndex;
+    args.outputStride = 3 + (layout.hasNormals ? 3 : 0) + (layout.hasTexcoord ? 2 : 0) + (layout.hasColor0 ? 1 : 0);
+    args.vertexCount = vertexCount;
+
+    const std::vector<float> positions = makeSource(rng, layout.positionFormat, args.positionStride, numSourceVertices);
+    const std::vector<float> normals = makeSource(rng, layout.normalFormat, args.normalStride, numSourceVertices);
+    const std::vector<float> texcoords = makeSource(rng, layout.texcoordFormat, args.texcoordStride, numSourceVertices);
+    const std::vector<float> colors = makeSource(rng, R8G8B8A8_UNORM, args.color0Stride, numSourceVertices + args.color0Offset);
+
+    CpuGeometryInterleaver::Sources sources;
+    sources.position = positions.data();
+    sources.normal = layout.hasNormals ? normals.data() : nullptr;
+    sources.texcoord = layout.hasTexcoord ? texcoords.data() : nullptr;
+    sources.color0 = layout.hasColor0 ? reinterpret_cast<const uint32_t*>(colors.data()) : nullptr;
+
+    const size_t dstSize = size_t(vertexCount) * args.outputStride;
+    std::vector<float> expected(dstSize, 0.f);
+    CpuGeometryInterleaver::interleaveScalar(0, vertexCount, expected.data(), sources, args);
+
+    auto compare = [&](const std::vector<float>& actual, const char* path) {
+      if (memcmp(expected.data(), actual.data(), dstSize * sizeof(float)) != 0) {
+        for (size_t i = 0; i < dstSize; i++) {
+          if (memcmp(&expected[i], &actual[i], sizeof(float)) != 0) {
+            throw DxvkError(str::format("checkLayout: ", path, " output differs from the scalar interleaver at vertex ", i / args.outputStride,
+                                        ", component ", i % args.outputStride, " (", describe(layout, vertexCount), ")"));
+          }
+        }
+      }
+    };
+
+    for (fast::SIMD simd : { fast::SIMD::None, fast::SIMD::SSE2, fast::SIMD::AVX2 }) {
+      std::vector<float> actual(dstSize, 0.f);
+      CpuGeometryInterleaver::interleaveBatched(0, vertexCount, actual.data(), sources, args, simd);
+      compare(actual, simd == fast::SIMD::AVX2 ? "AVX2" : simd == fast::SIMD::SSE2 ? "SSE2" : "scalar fallback");
+    }
+
+    std::vector<float> actual(dstSize, 0.f);
+    CpuGeometryInterleaver::interleave(actual.data(), sources, args);
+    compare(actual, "parallel");
+  }
+} // anonymous namespace
+
+void testAllFormats() {
+  Logger::info("Testing batched interleaver against the scalar interleaver for all formats...");
+  std::mt19937 rng(0x1234);
+
+  uint32_t numLayouts = 0;
+  for (uint32_t positionFormat : kFloatFormats) {
+    for (uint32_t normalFormat : kFloatFormats) {
+      for (uint32_t texcoordFormat : kFloatFormats) {
+        for (uint32_t color0Format : { B8G8R8A8_UNORM, R8G8B8A8_UNORM }) {
+          for (uint32_t attributeMask = 0; attributeMask < 8; attributeMask++) {
+            const Layout layout { positionFormat, (attributeMask & 1) != 0, normalFormat, (attributeMask & 2) != 0, texcoordFormat, (attributeMask & 4) != 0, color0Format };
+            // Sizes around the 4 and 8 vertex batches, so each path has to handle a remainder
+            for (uint32_t vertexCount : { 1u, 4u, 8u, 9u, 23u }) {
+              checkLayout(rng, layout, vertexCount, vertexCount % 3);
+            }
+            ++numLayouts;
+          }
+        }
+      }
+    }
+  }
+
+  Logger::info(str::format("Batched interleaver matched the scalar interleaver for ", numLayouts, " layouts"));
+}
+
+void testLargeMeshes() {
+  Logger::info("Testing parallel interleaving of large meshes...");
+  std::mt19937 rng(0x5678);
+
+  const Layout layouts[] = {
+    { R32G32B32_SFLOAT, true, R8G8B8A8_UNORM, true, R32G32_SFLOAT, true, B8G8R8A8_UNORM },
+    { R32G32B32A32_SFLOAT, true, A2B10G10R10_SNORM_PACK32, false, R32G32_SFLOAT, true, B8G8R8A8_UNORM },
+    { R32G32B32_SFLOAT, false, R32G32B32_SFLOAT, false, R32G32_SFLOAT, false, B8G8R8A8_UNORM },
+  };
+
+  // Chunk boundaries must not leak writes into neighbouring chunks
+  const uint32_t chunk = CpuGeometryInterleaver::kVerticesPerChunk;
+  for (const Layout& layout : layouts) {
+    for (uint32_t vertexCount : { chunk + 1, 3 * chunk, 5 * chunk + 7 }) {
+      checkLayout(rng, layout, vertexCount, 5);
+    }
+  }
+
+  Logger::info("Parallel interleaving test passed");
+}
+
+void testCpuVertexLimit() {
+  Logger::info("Testing CPU interleaving limit...");
+
+  const uint32_t calibrated = CpuGeometryInterleaver::getMaxCpuVertexCount();
+  if (calibrated < CpuGeometryInterleaver::kMinCpuVertexCount || calibrated > CpuGeometryInterleaver::kMaxCpuVertexCount) {
+    throw DxvkError(str::format("testCpuVertexLimit: calibrated limit ", calibrated, " is out of range"));
+  }
+  if (CpuGeometryInterleaver::getMaxCpuVertexCount() != calibrated) {
+    throw DxvkError("testCpuVertexLimit: the calibrated limit should be stable");
+  }
+
+  Logger::info(str::format("CPU interleaving limit test passed (calibrated to ", calibrated, " vertices)"));
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_geometry_interleaver...");
+
+  try {
+    dxvk::testAllFormats();
+    dxvk::testLargeMeshes();
+    dxvk::testCpuVertexLimit();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
@@ -27,6 +27,7 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <filesystem>
 
 #include "../../test_utils.h"
 #include "rtx_render/graph/rtx_graph_usd_parser.h"
@@ -2299,6 +2300,143 @@ void testAllPropertyTypeConnections() {
   Logger::info("testAllPropertyTypeConnections passed - all type combinations verified");
 }
 
+void testGraphTopologyCache() {
+  Logger::info("Testing graph topology cache...");
+
+  GraphUsdParserTest test;
+
+  // A single graph template, referenced by two different "lamps".
+  pxr::SdfPath templatePath("/Templates/lamp");
+  test.m_stage->DefinePrim(templatePath, pxr::TfToken("Xform"));
+  pxr::SdfPath templateGraphPath = templatePath.AppendChild(pxr::TfToken("graph"));
+  test.m_stage->DefinePrim(templateGraphPath, pxr::TfToken("OmniGraph"));
+  pxr::UsdPrim nodeA = test.createTestAllTypesNode(templateGraphPath, "nodeA");
+  test.addInputProperty(nodeA, "inputFloat", "2.5");
+  test.addInputProperty(nodeA, "inputBool", "1");
+  test.addOutputProperty(nodeA, "outputFloat");
+  pxr::UsdPrim nodeB = test.createTestAllTypesNode(templateGraphPath, "nodeB");
+  test.addInputProperty(nodeB, "inputFloat", "1.0");
+  test.addOutputProperty(nodeB, "outputFloat");
+  test.connectNodes(nodeA, "outputFloat", nodeB, "inputFloat");
+
+  // Anonymous layers have no file to validate a persisted entry against, so graphs authored in them are never cached.
+  {
+    GraphTopologyCache anonymousCache;
+    pxr::UsdPrim anonymousGraph = test.m_stage->GetPrimAtPath(templateGraphPath);
+    GraphUsdParser::parseGraph(test.m_replacements, anonymousGraph, test.m_pathToOffsetMap, &anonymousCache);
+    GraphUsdParser::parseGraph(test.m_replacements, anonymousGraph, test.m_pathToOffsetMap, &anonymousCache);
+    if (anonymousCache.getHitCount() != 0) {
+      throw DxvkError("testGraphTopologyCache: graphs from anonymous layers should not hit the cache");
+    }
+  }
+
+  // Save the template to disk, and reference it from the lamps of a new stage.
+  const std::filesystem::path templateFile = std::filesystem::temp_directory_path() / "test_graph_topology_template.usda";
+  if (!test.m_stage->GetRootLayer()->Export(templateFile.string())) {
+    throw DxvkError("testGraphTopologyCache: failed to export the template layer");
+  }
+  test.m_stage = pxr::UsdStage::CreateInMemory("test_graph_instances.usda");
+
+  pxr::UsdPrim lampA = test.m_stage->DefinePrim(pxr::SdfPath("/World/lampA"), pxr::TfToken("Xform"));
+  lampA.GetReferences().AddReference(templateFile.string(), templatePath);
+  pxr::UsdPrim lampB = test.m_stage->DefinePrim(pxr::SdfPath("/World/lampB"), pxr::TfToken("Xform"));
+  lampB.GetReferences().AddReference(templateFile.string(), templatePath);
+
+  pxr::UsdPrim graphA = lampA.GetChild(pxr::TfToken("graph"));
+  pxr::UsdPrim graphB = lampB.GetChild(pxr::TfToken("graph"));
+  if (!graphA.IsValid() || !graphB.IsValid()) {
+    throw DxvkError("testGraphTopologyCache: referenced graph prims should be valid");
+  }
+
+  // Reference result, without the cache.
+  RtGraphState uncachedState = GraphUsdParser::parseGraph(test.m_replacements, graphA, test.m_pathToOffsetMap);
+
+  GraphTopologyCache cache;
+  RtGraphState stateA = GraphUsdParser::parseGraph(test.m_replacements, graphA, test.m_pathToOffsetMap, &cache);
+  if (cache.getHitCount() != 0) {
+    throw DxvkError("testGraphTopologyCache: first parse should not hit the cache");
+  }
+  RtGraphState stateB = GraphUsdParser::parseGraph(test.m_replacements, graphB, test.m_pathToOffsetMap, &cache);
+  if (cache.getHitCount() != 1) {
+    throw DxvkError("testGraphTopologyCache: second instance of the same graph should hit the cache");
+  }
+
+  auto checkMatches = [&uncachedState](const RtGraphState& state, const char* name) {
+    if (state.topology.graphHash != uncachedState.topology.graphHash) {
+      throw DxvkError(str::format("testGraphTopologyCache: ", name, " graphHash mismatch"));
+    }
+    if (state.topology.componentSpecs != uncachedState.topology.componentSpecs ||
+        state.topology.propertyTypes != uncachedState.topology.propertyTypes ||
+        state.topology.propertyIndices != uncachedState.topology.propertyIndices) {
+      throw DxvkError(str::format("testGraphTopologyCache: ", name, " topology mismatch"));
+    }
+    if (state.values != uncachedState.values) {
+      throw DxvkError(str::format("testGraphTopologyCache: ", name, " initial values mismatch"));
+    }
+  };
+  checkMatches(stateA, "stateA");
+  checkMatches(stateB, "stateB");
+
+  // A local override must not share the template's cache entry.
+  pxr::UsdPrim lampC = test.m_stage->DefinePrim(pxr::SdfPath("/World/lampC"), pxr::TfToken("Xform"));
+  lampC.GetReferences().AddReference(templateFile.string(), templatePath);
+  pxr::UsdPrim overrideNode = test.m_stage->GetPrimAtPath(pxr::SdfPath("/World/lampC/graph/nodeA"));
+  test.addInputProperty(overrideNode, "inputFloat", "7.0");
+  RtGraphState stateC = GraphUsdParser::parseGraph(test.m_replacements, lampC.GetChild(pxr::TfToken("graph")), test.m_pathToOffsetMap, &cache);
+  if (cache.getHitCount() != 1) {
+    throw DxvkError("testGraphTopologyCache: a graph with local overrides should not hit the cache");
+  }
+  if (stateC.values == uncachedState.values) {
+    throw DxvkError("testGraphTopologyCache: overridden graph should have different initial values");
+  }
+
+  // Round trip through the on-disk format.
+  const std::filesystem::path cachePath = std::filesystem::temp_directory_path() / "test_graph_topology.cache";
+  if (!cache.serialize(cachePath)) {
+    throw DxvkError("testGraphTopologyCache: serialize failed");
+  }
+  GraphTopologyCache loadedCache;
+  if (!loadedCache.deserialize(cachePath)) {
+    throw DxvkError("testGraphTopologyCache: deserialize failed");
+  }
+  RtGraphState loadedState = GraphUsdParser::parseGraph(test.m_replacements, graphB, test.m_pathToOffsetMap, &loadedCache);
+  if (loadedCache.getHitCount() != 1) {
+    throw DxvkError("testGraphTopologyCache: deserialized cache should be hit");
+  }
+  checkMatches(loadedState, "loadedState");
+
+  // Only the entries used by this load are written back, the overridden graph was not parsed and is pruned.
+  if (!loadedCache.isDirty()) {
+    throw DxvkError("testGraphTopologyCache: unused entries should make the cache dirty");
+  }
+  if (!loadedCache.serialize(cachePath)) {
+    throw DxvkError("testGraphTopologyCache: serialize of the pruned cache failed");
+  }
+  GraphTopologyCache prunedCache;
+  if (!prunedCache.deserialize(cachePath)) {
+    throw DxvkError("testGraphTopologyCache: deserialize of the pruned cache failed");
+  }
+  GraphUsdParser::parseGraph(test.m_replacements, graphA, test.m_pathToOffsetMap, &prunedCache);
+  GraphUsdParser::parseGraph(test.m_replacements, lampC.GetChild(pxr::TfToken("graph")), test.m_pathToOffsetMap, &prunedCache);
+  if (prunedCache.getHitCount() != 1) {
+    throw DxvkError("testGraphTopologyCache: pruned cache should only contain the used template");
+  }
+
+  // Corrupted files must be rejected.
+  {
+    std::ofstream corrupt(cachePath, std::ios::binary | std::ios::trunc);
+    corrupt << "not a graph topology cache";
+  }
+  GraphTopologyCache corruptCache;
+  if (corruptCache.deserialize(cachePath)) {
+    throw DxvkError("testGraphTopologyCache: corrupted cache file should be rejected");
+  }
+  std::filesystem::remove(cachePath);
+  std::filesystem::remove(templateFile);
+
+  Logger::info("testGraphTopologyCache passed");
+}
+
 } // namespace dxvk
 
 int main() {
@@ -2342,6 +2480,7 @@ int main() {
     dxvk::testFlexibleTypeResolutionFromTokenStrings();
     dxvk::testFlexibleTypeResolutionViaConnections();
     dxvk::testAllPropertyTypeConnections();
+    dxvk::testGraphTopologyCache();
     
     dxvk::Logger::info("\n All tests passed successfully!");
     return 0;
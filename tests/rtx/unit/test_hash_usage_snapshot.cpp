@@ -0,0 +1,199 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include "../../test_utils.h"
+#include "../../../src/util/util_hash_usage_snapshot.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_hash_usage_snapshot.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void testEmpty() {
+      HashUsageSnapshot snapshot;
+      if (snapshot.getUsageCount(0x1234) != 0 || snapshot.isUsed(0)) {
+        throw DxvkError("empty snapshot should not contain any hashes");
+      }
+      snapshot.build(std::unordered_map<XXH64_hash_t, uint32_t>{});
+      if (snapshot.size() != 0 || snapshot.isUsed(0x1234)) {
+        throw DxvkError("snapshot built from an empty map should not contain any hashes");
+      }
+    }
+
+    void testMatchesMap() {
+      std::mt19937_64 rng(1234);
+      std::unordered_map<XXH64_hash_t, uint32_t> usage;
+      for (uint32_t i = 0; i < 5000; i++) {
+        usage[rng()] = (i % 7) + 1;
+      }
+      // Include some edge values.
+      usage[0] = 3;
+      usage[~0ull] = 9;
+
+      HashUsageSnapshot snapshot;
+      snapshot.build(usage);
+      if (snapshot.size() != usage.size()) {
+        throw DxvkError(str::format("snapshot size mismatch. expected: ", usage.size(), " got: ", snapshot.size()));
+      }
+
+      for (const auto& [hash, count] : usage) {
+        if (snapshot.getUsageCount(hash) != count) {
+          throw DxvkError(str::format("wrong usage count for hash ", hash, ". expected: ", count, " got: ", snapshot.getUsageCount(hash)));
+        }
+      }
+
+      // Hashes that were not inserted must never be reported, even if they pass the bloom filter.
+      std::vector<XXH64_hash_t> queries;
+      for (uint32_t i = 0; i < 20000; i++) {
+        XXH64_hash_t hash = rng();
+        if (usage.find(hash) == usage.end()) {
+          queries.push_back(hash);
+        }
+      }
+      std::vector<uint32_t> counts(queries.size(), 0xffffffff);
+      snapshot.getUsageCounts(queries.data(), queries.size(), counts.data());
+      for (size_t i = 0; i < counts.size(); i++) {
+        if (counts[i] != 0) {
+          throw DxvkError(str::format("hash ", queries[i], " was reported as used but was never inserted"));
+        }
+      }
+    }
+
+    void testBuildFromKeys() {
+      std::unordered_map<XXH64_hash_t, float> table = { { 10, 0.5f }, { 20, 1.5f }, { 30, 2.5f } };
+      HashUsageSnapshot snapshot;
+      snapshot.buildFromKeys(table);
+      if (!snapshot.isUsed(10) || !snapshot.isUsed(20) || !snapshot.isUsed(30) || snapshot.isUsed(40)) {
+        throw DxvkError("buildFromKeys produced the wrong set of hashes");
+      }
+      if (snapshot.getUsageCount(20) != 1) {
+        throw DxvkError("buildFromKeys should give each key a count of 1");
+      }
+
+      // Rebuilding must drop the previous contents.
+      snapshot.build(std::unordered_map<XXH64_hash_t, uint32_t>{ { 40, 2 } });
+      if (snapshot.isUsed(10) || snapshot.getUsageCount(40) != 2) {
+        throw DxvkError("rebuilding the snapshot kept stale hashes");
+      }
+    }
+
+    void testBloomFilter() {
+      HashBloomFilter filter;
+      if (filter.mayContain(0x1234)) {
+        throw DxvkError("an empty bloom filter should not contain any hashes");
+      }
+
+      std::mt19937_64 rng(91011);
+      std::vector<XXH64_hash_t> keys(10000);
+      filter.reset(keys.size());
+      for (XXH64_hash_t& key : keys) {
+        key = rng();
+        filter.insert(key);
+      }
+      for (XXH64_hash_t key : keys) {
+        if (!filter.mayContain(key)) {
+          throw DxvkError(str::format("bloom filter false negative for hash ", key));
+        }
+      }
+
+      const size_t numQueries = 100000;
+      size_t falsePositives = 0;
+      for (size_t i = 0; i < numQueries; i++) {
+        falsePositives += filter.mayContain(rng()) ? 1 : 0;
+      }
+      const double falsePositiveRate = double(falsePositives) / double(numQueries);
+      Logger::info(str::format("HashBloomFilter: false positive rate ", falsePositiveRate));
+      if (falsePositiveRate > 0.05) {
+        throw DxvkError(str::format("bloom filter false positive rate too high: ", falsePositiveRate));
+      }
+
+      filter.clear();
+      if (filter.mayContain(keys[0])) {
+        throw DxvkError("a cleared bloom filter should not contain any hashes");
+      }
+    }
+
+    void testPerformance() {
+      std::mt19937_64 rng(5678);
+      std::unordered_map<XXH64_hash_t, uint32_t> usage;
+      for (uint32_t i = 0; i < 20000; i++) {
+        usage[rng()] = 1;
+      }
+      HashUsageSnapshot snapshot;
+      snapshot.build(usage);
+
+      // Mostly misses, like thousands of checker components looking for hashes that aren't on screen.
+      std::vector<XXH64_hash_t> queries(100000);
+      for (size_t i = 0; i < queries.size(); i++) {
+        queries[i] = (i % 10 == 0) ? std::next(usage.begin(), i % usage.size())->first : rng();
+      }
+
+      uint64_t mapHits = 0;
+      const auto mapStart = std::chrono::high_resolution_clock::now();
+      for (XXH64_hash_t hash : queries) {
+        auto it = usage.find(hash);
+        mapHits += (it != usage.end()) ? it->second : 0;
+      }
+      const auto mapTime = std::chrono::high_resolution_clock::now() - mapStart;
+
+      uint64_t snapshotHits = 0;
+      const auto snapshotStart = std::chrono::high_resolution_clock::now();
+      for (XXH64_hash_t hash : queries) {
+        snapshotHits += snapshot.getUsageCount(hash);
+      }
+      const auto snapshotTime = std::chrono::high_resolution_clock::now() - snapshotStart;
+
+      if (mapHits != snapshotHits) {
+        throw DxvkError(str::format("snapshot and map disagree. map: ", mapHits, " snapshot: ", snapshotHits));
+      }
+      Logger::info(str::format("HashUsageSnapshot: ", queries.size(), " probes. unordered_map: ",
+                               std::chrono::duration_cast<std::chrono::microseconds>(mapTime).count(), "us, snapshot: ",
+                               std::chrono::duration_cast<std::chrono::microseconds>(snapshotTime).count(), "us"));
+    }
+
+    void run() {
+      testEmpty();
+      testMatchesMap();
+      testBuildFromKeys();
+      testBloomFilter();
+      testPerformance();
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,339 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/util/log/metrics_registry.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_metrics_registry.log");
+
+namespace {
+  const MetricsSnapshot::Entry& findEntry(const MetricsSnapshot& snapshot, const std::string& name) {
+    for (const auto& entry : snapshot.entries) {
+      if (entry.name == name) {
+        return entry;
+      }
+    }
+    throw DxvkError(str::format("Metric not found in snapshot: ", name));
+  }
+
+  void expectNear(const char* context, double expected, double actual, double relativeError) {
+    if (std::abs(actual - expected) > std::abs(expected) * relativeError) {
+      throw DxvkError(str::format(context, ": expected ", expected, ", got ", actual));
+    }
+  }
+} // anonymous namespace
+
+void testBucketBoundaries() {
+  Logger::info("Testing histogram bucket boundaries...");
+  for (uint32_t bucket = 1; bucket < MetricBuckets::Count; bucket++) {
+    const double lower = MetricBuckets::getLowerBound(bucket);
+    if (MetricBuckets::getBucket(lower) != bucket) {
+      throw DxvkError(str::format("testBucketBoundaries: lower bound of bucket ", bucket, " maps to bucket ", MetricBuckets::getBucket(lower)));
+    }
+    if (MetricBuckets::getBucket(std::nextafter(lower, 0.0)) != bucket - 1) {
+      throw DxvkError(str::format("testBucketBoundaries: value below bucket ", bucket, " is not in the previous bucket"));
+    }
+    if (bucket + 1 < MetricBuckets::Count) {
+      const double width = MetricBuckets::getLowerBound(bucket + 1) - lower;
+      if (width > lower / MetricBuckets::SubBuckets * 1.000001) {
+        throw DxvkError(str::format("testBucketBoundaries: bucket ", bucket, " is wider than the relative error bound"));
+      }
+    }
+  }
+
+  if (MetricBuckets::getBucket(0.0) != 0 || MetricBuckets::getBucket(-5.0) != 0 || MetricBuckets::getBucket(1e-9) != 0) {
+    throw DxvkError("testBucketBoundaries: values below the range must go to the first bucket");
+  }
+  if (MetricBuckets::getBucket(1e12) != MetricBuckets::Count - 1 ||
+      MetricBuckets::getBucket(INFINITY) != MetricBuckets::Count - 1) {
+    throw DxvkError("testBucketBoundaries: values above the range must go to the last bucket");
+  }
+  if (MetricBuckets::getLowerBound(MetricBuckets::getBucket(1.0)) != 1.0 ||
+      MetricBuckets::getLowerBound(MetricBuckets::getBucket(16.6)) > 16.6) {
+    throw DxvkError("testBucketBoundaries: unexpected bucket for common values");
+  }
+  Logger::info("Histogram bucket boundaries test passed");
+}
+
+void testPercentiles() {
+  Logger::info("Testing histogram percentiles...");
+  MetricHistogram histogram;
+  if (histogram.getPercentile(0.5) != 0.0) {
+    throw DxvkError("testPercentiles: empty histogram should report 0");
+  }
+
+  for (uint32_t i = 1; i <= 1000; i++) {
+    histogram.add(double(i));
+  }
+  if (histogram.count != 1000 || histogram.min != 1.0 || histogram.max != 1000.0 || histogram.sum != 500500.0) {
+    throw DxvkError("testPercentiles: unexpected histogram statistics");
+  }
+
+  // Percentiles are bucket upper bounds, so they can be off by one bucket width
+  const double error = 1.0 / MetricBuckets::SubBuckets;
+  expectNear("testPercentiles: p50", 500.0, histogram.getPercentile(0.5), error);
+  expectNear("testPercentiles: p90", 900.0, histogram.getPercentile(0.9), error);
+  expectNear("testPercentiles: p99", 990.0, histogram.getPercentile(0.99), error);
+  if (histogram.getPercentile(1.0) != 1000.0 || histogram.getPercentile(0.0) < 1.0) {
+    throw DxvkError("testPercentiles: percentiles must be clamped to the recorded range");
+  }
+
+  MetricHistogram other;
+  other.add(0.5);
+  other.add(5000.0);
+  histogram.merge(other);
+  if (histogram.count != 1002 || histogram.min != 0.5 || histogram.max != 5000.0) {
+    throw DxvkError("testPercentiles: merge did not update the statistics");
+  }
+  Logger::info("Histogram percentiles test passed");
+}
+
+void testShardMerging() {
+  Logger::info("Testing shard merging...");
+  constexpr uint32_t kThreadCount = 4;
+  constexpr uint32_t kIterations = 10000;
+
+  MetricsRegistry& registry = MetricsRegistry::get();
+  const MetricCounter counter = registry.registerCounter("test_merge_events");
+  const MetricHistogramRecorder histogram = registry.registerHistogram("test_merge_values");
+  const MetricGauge gauge = registry.registerGauge("test_merge_gauge");
+
+  if (registry.registerCounter("test_merge_events").isValid() != true ||
+      registry.registerHistogram("test_merge_events").isValid()) {
+    throw DxvkError("testShardMerging: names must map to one metric of one type");
+  }
+
+  // Threads that exit before the merge are folded into the retired totals
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < kThreadCount; t++) {
+    threads.emplace_back([&, t] {
+      for (uint32_t i = 0; i < kIterations; i++) {
+        counter.add();
+        histogram.record(double(t + 1));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // The main thread's shard stays live across merges
+  counter.add(5);
+  histogram.record(100.0);
+  gauge.set(42.0);
+  registry.endFrame();
+
+  MetricsSnapshot snapshot = registry.getSnapshot();
+  const auto& events = findEntry(snapshot, "test_merge_events");
+  const auto& values = findEntry(snapshot, "test_merge_values");
+  const uint64_t expectedEvents = uint64_t(kThreadCount) * kIterations + 5;
+  if (events.type != MetricType::Counter || events.value != double(expectedEvents) || events.lastFrame != double(expectedEvents)) {
+    throw DxvkError(str::format("testShardMerging: expected ", expectedEvents, " events, got ", events.value));
+  }
+  if (values.histogram.count != expectedEvents - 4 || values.histogram.min != 1.0 || values.histogram.max != 100.0 ||
+      values.histogram.sum != double(kIterations) * (1 + 2 + 3 + 4) + 100.0) {
+    throw DxvkError("testShardMerging: histogram shards were not merged correctly");
+  }
+  if (findEntry(snapshot, "test_merge_gauge").value != 42.0) {
+    throw DxvkError("testShardMerging: unexpected gauge value");
+  }
+
+  const uint64_t framesRecorded = events.histogram.count;
+
+  // Counters also record their per-frame increments
+  counter.add(7);
+  registry.endFrame();
+  snapshot = registry.getSnapshot();
+  const auto& nextEvents = findEntry(snapshot, "test_merge_events");
+  if (nextEvents.value != double(expectedEvents + 7) || nextEvents.lastFrame != 7.0 ||
+      nextEvents.histogram.count != framesRecorded + 1 || nextEvents.histogram.min != 7.0) {
+    throw DxvkError("testShardMerging: unexpected per-frame counter values");
+  }
+  if (findEntry(snapshot, "test_merge_values").histogram.count != expectedEvents - 4) {
+    throw DxvkError("testShardMerging: merging twice must not count values twice");
+  }
+  Logger::info("Shard merging test passed");
+}
+
+void testSnapshotSerialization() {
+  Logger::info("Testing snapshot serialization...");
+  MetricsSnapshot snapshot;
+  snapshot.frameCount = 3;
+  snapshot.timeSeconds = 1.5;
+
+  MetricsSnapshot::Entry counter;
+  counter.name = "draws";
+  counter.type = MetricType::Counter;
+  counter.value = 30.0;
+  counter.lastFrame = 12.0;
+  counter.histogram.add(8.0);
+  counter.histogram.add(10.0);
+  counter.histogram.add(12.0);
+  snapshot.entries.push_back(counter);
+
+  MetricsSnapshot::Entry gauge;
+  gauge.name = "memory \"mb\"";
+  gauge.type = MetricType::Gauge;
+  gauge.value = 256.0;
+  snapshot.entries.push_back(gauge);
+
+  MetricsSnapshot::Entry histogram;
+  histogram.name = "frame_ms";
+  histogram.type = MetricType::Histogram;
+  histogram.histogram.add(16.0);
+  snapshot.entries.push_back(histogram);
+
+  std::stringstream json;
+  snapshot.writeJson(json);
+  const std::string expectedJson =
+    "{\n"
+    "  \"frameCount\": 3,\n"
+    "  \"timeSeconds\": 1.5,\n"
+    "  \"metrics\": [\n"
+    "    { \"name\": \"draws\", \"type\": \"counter\", \"value\": 30, \"lastFrame\": 12, \"count\": 3, \"sum\": 30, \"min\": 8, \"max\": 12, \"mean\": 10, \"p50\": 11, \"p90\": 12, \"p99\": 12 },\n"
+    "    { \"name\": \"memory \\\"mb\\\"\", \"type\": \"gauge\", \"value\": 256 },\n"
+    "    { \"name\": \"frame_ms\", \"type\": \"histogram\", \"count\": 1, \"sum\": 16, \"min\": 16, \"max\": 16, \"mean\": 16, \"p50\": 16, \"p90\": 16, \"p99\": 16 }\n"
+    "  ]\n"
+    "}\n";
+  if (json.str() != expectedJson) {
+    throw DxvkError(str::format("testSnapshotSerialization: unexpected JSON:\n", json.str()));
+  }
+
+  std::stringstream csv;
+  snapshot.writeCsv(csv, true);
+  const std::string expectedCsv =
+    "time_s,frame,name,type,value,last_frame,count,sum,min,max,mean,p50,p90,p99\n"
+    "1.5,3,draws,counter,30,12,3,30,8,12,10,11,12,12\n"
+    "1.5,3,memory \"mb\",gauge,256,,,,,,,,,\n"
+    "1.5,3,frame_ms,histogram,,,1,16,16,16,16,16,16,16\n";
+  if (csv.str() != expectedCsv) {
+    throw DxvkError(str::format("testSnapshotSerialization: unexpected CSV:\n", csv.str()));
+  }
+
+  // Exports overwrite the JSON file and append to the CSV file
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / "test_metrics_registry";
+  std::error_code ec;
+  std::filesystem::remove_all(directory, ec);
+
+  MetricsRegistry& registry = MetricsRegistry::get();
+  registry.registerGauge("test_export_gauge").set(1.0);
+  registry.exportSnapshot(directory);
+  registry.exportSnapshot(directory);
+
+  std::ifstream csvFile(directory / "metrics.csv");
+  uint32_t headerCount = 0, rowCount = 0;
+  std::string line;
+  while (std::getline(csvFile, line)) {
+    if (line.rfind("time_s,", 0) == 0) {
+      headerCount++;
+    } else if (line.find(",test_export_gauge,gauge,1,") != std::string::npos) {
+      rowCount++;
+    }
+  }
+  std::ifstream jsonFile(directory / "metrics.json");
+  std::stringstream jsonContent;
+  jsonContent << jsonFile.rdbuf();
+  csvFile.close();
+  jsonFile.close();
+  std::filesystem::remove_all(directory, ec);
+
+  if (headerCount != 1 || rowCount != 2) {
+    throw DxvkError(str::format("testSnapshotSerialization: expected one CSV header and two rows, got ", headerCount, " and ", rowCount));
+  }
+  if (jsonContent.str().find("\"name\": \"test_export_gauge\", \"type\": \"gauge\", \"value\": 1 }") == std::string::npos) {
+    throw DxvkError("testSnapshotSerialization: exported JSON is missing a metric");
+  }
+  Logger::info("Snapshot serialization test passed");
+}
+
+void testRecordingCost() {
+  Logger::info("Measuring recording cost...");
+  constexpr uint32_t kIterations = 10000000;
+
+  MetricsRegistry& registry = MetricsRegistry::get();
+  const MetricCounter counter = registry.registerCounter("test_benchmark_events");
+  const MetricHistogramRecorder histogram = registry.registerHistogram("test_benchmark_values");
+
+  auto t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < kIterations; i++) {
+    counter.add();
+  }
+  auto t1 = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < kIterations; i++) {
+    histogram.record(double(i & 1023) * 0.125);
+  }
+  auto t2 = std::chrono::high_resolution_clock::now();
+  registry.endFrame();
+  auto t3 = std::chrono::high_resolution_clock::now();
+
+  const MetricsSnapshot snapshot = registry.getSnapshot();
+  if (findEntry(snapshot, "test_benchmark_events").value != double(kIterations) ||
+      findEntry(snapshot, "test_benchmark_values").histogram.count != kIterations) {
+    throw DxvkError("testRecordingCost: lost recorded values");
+  }
+
+  Logger::info(str::format("Counter add: ", std::chrono::duration<double, std::nano>(t1 - t0).count() / kIterations, " ns"));
+  Logger::info(str::format("Histogram record: ", std::chrono::duration<double, std::nano>(t2 - t1).count() / kIterations, " ns"));
+  Logger::info(str::format("Frame merge: ", std::chrono::duration<double, std::micro>(t3 - t2).count(), " us"));
+  Logger::info("Recording cost test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_metrics_registry...");
+
+  try {
+    dxvk::testBucketBoundaries();
+    dxvk::testPercentiles();
+    dxvk::testShardMerging();
+    dxvk::testSnapshotSerialization();
+    dxvk::testRecordingCost();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
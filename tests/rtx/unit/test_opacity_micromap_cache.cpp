@@ -0,0 +1,321 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_opacity_micromap_cache.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_opacity_micromap_cache.log");
+
+namespace {
+  // Stands in for an OMM cache item, counting live instances to catch leaks and double destruction
+  struct TestItem {
+    static int s_numLive;
+
+    uint32_t value;
+    uint32_t lastUseFrameIndex;
+
+    TestItem(uint32_t _value, uint32_t _lastUseFrameIndex) : value(_value), lastUseFrameIndex(_lastUseFrameIndex) {
+      s_numLive++;
+    }
+
+    ~TestItem() {
+      s_numLive--;
+    }
+
+    TestItem(const TestItem&) = delete;
+    TestItem& operator=(const TestItem&) = delete;
+  };
+
+  int TestItem::s_numLive = 0;
+
+  typedef OpacityMicromapCachePool<TestItem> TestPool;
+  typedef TestPool::List List;
+
+  // Hashes are arbitrary but must not be kEmptyHash
+  XXH64_hash_t hashOf(uint32_t i) {
+    return 0x9E3779B97F4A7C15ull * (i + 1);
+  }
+
+  std::vector<uint32_t> getListValues(const TestPool& pool, List list) {
+    std::vector<uint32_t> values;
+    for (auto index = pool.front(list); index != TestPool::kInvalidIndex; index = pool.next(index))
+      values.push_back(pool[index].value);
+    return values;
+  }
+
+  std::vector<uint32_t> getLruValues(const TestPool& pool) {
+    std::vector<uint32_t> values;
+    for (auto index = pool.leastRecentlyUsed(); index != TestPool::kInvalidIndex; index = pool.nextMoreRecentlyUsed(index))
+      values.push_back(pool[index].value);
+    return values;
+  }
+
+  void expectValues(const char* context, const std::vector<uint32_t>& actual, const std::vector<uint32_t>& expected) {
+    if (actual != expected) {
+      std::string actualStr, expectedStr;
+      for (uint32_t v : actual)
+        actualStr += str::format(v, " ");
+      for (uint32_t v : expected)
+        expectedStr += str::format(v, " ");
+      throw DxvkError(str::format(context, ": expected [ ", expectedStr, "], got [ ", actualStr, "]"));
+    }
+  }
+
+  // Exposes the budget which is otherwise set from vidmem stats
+  class TestMemoryBudget : public OpacityMicromapMemoryBudget {
+  public:
+    using OpacityMicromapMemoryBudget::OpacityMicromapMemoryBudget;
+
+    void setBudget(uint64_t budget) {
+      m_prevBudget = m_budget;
+      m_budget = budget;
+    }
+  };
+} // anonymous namespace
+
+void testStateTransitions() {
+  Logger::info("Testing cache state transitions...");
+  {
+    TestPool pool;
+    std::vector<TestPool::Index> indices;
+    for (uint32_t i = 0; i < 4; i++)
+      indices.push_back(pool.emplace(hashOf(i), i, 0));
+
+    if (pool.size() != 4 || TestItem::s_numLive != 4)
+      throw DxvkError("testStateTransitions: expected 4 items after emplacing");
+    for (uint32_t i = 0; i < 4; i++) {
+      if (pool.find(hashOf(i)) != indices[i] || pool.getHash(indices[i]) != hashOf(i))
+        throw DxvkError("testStateTransitions: hash lookup doesn't match the emplaced item");
+      if (pool.getList(indices[i]) != List::None)
+        throw DxvkError("testStateTransitions: new items must not be in a state list");
+    }
+    if (pool.find(hashOf(100)) != TestPool::kInvalidIndex)
+      throw DxvkError("testStateTransitions: found an item that was never added");
+
+    // Unprocessed list is kept in insertion order given by the caller
+    pool.pushBack(List::Unprocessed, indices[2]);
+    pool.insertBefore(List::Unprocessed, indices[2], indices[0]);
+    pool.pushBack(List::Unprocessed, indices[3]);
+    pool.insertBefore(List::Unprocessed, indices[3], indices[1]);
+    expectValues("testStateTransitions: unprocessed order", getListValues(pool, List::Unprocessed), { 0, 2, 1, 3 });
+
+    // Moving an item to another list unlinks it from the current one
+    pool.pushBack(List::Baked, indices[2]);
+    pool.pushBack(List::Baked, indices[0]);
+    expectValues("testStateTransitions: unprocessed after baking", getListValues(pool, List::Unprocessed), { 1, 3 });
+    expectValues("testStateTransitions: baked", getListValues(pool, List::Baked), { 2, 0 });
+
+    pool.pushBack(List::Built, indices[0]);
+    if (pool.getList(indices[0]) != List::Built || pool.size(List::Baked) != 1 || pool.size(List::Built) != 1)
+      throw DxvkError("testStateTransitions: failed to move an item to the built list");
+
+    // Source data unlinking takes items out of the unprocessed list while keeping them cached
+    pool.unlink(indices[3]);
+    pool.unlink(indices[3]);
+    if (pool.getList(indices[3]) != List::None || pool.size(List::Unprocessed) != 1 || pool.find(hashOf(3)) != indices[3])
+      throw DxvkError("testStateTransitions: unlinking an item from a state list failed");
+
+    pool.unlinkAll(List::Built);
+    if (!pool.empty(List::Built) || pool.getList(indices[0]) != List::None)
+      throw DxvkError("testStateTransitions: unlinking all built items failed");
+
+    // Erasing an item unlinks it from its state list and releases its slot for reuse
+    pool.erase(indices[2]);
+    if (!pool.empty(List::Baked) || pool.size() != 3 || TestItem::s_numLive != 3 || pool.find(hashOf(2)) != TestPool::kInvalidIndex)
+      throw DxvkError("testStateTransitions: erasing a linked item failed");
+
+    const TestPool::Index reusedIndex = pool.emplace(hashOf(4), 4, 0);
+    if (reusedIndex != indices[2] || pool[reusedIndex].value != 4)
+      throw DxvkError("testStateTransitions: erased slot was not reused");
+
+    pool.pushBack(List::Unprocessed, reusedIndex);
+    expectValues("testStateTransitions: unprocessed with reused slot", getListValues(pool, List::Unprocessed), { 1, 4 });
+  }
+  if (TestItem::s_numLive != 0)
+    throw DxvkError(str::format("testStateTransitions: ", TestItem::s_numLive, " items leaked on destruction"));
+  Logger::info("Cache state transitions test passed");
+}
+
+void testEvictionOrder() {
+  Logger::info("Testing LRU eviction order...");
+  TestPool pool;
+  std::vector<TestPool::Index> indices;
+  for (uint32_t i = 0; i < 5; i++)
+    indices.push_back(pool.emplace(hashOf(i), i, i));
+
+  expectValues("testEvictionOrder: insertion", getLruValues(pool), { 0, 1, 2, 3, 4 });
+
+  // Binding an item makes it the most recently used one, regardless of its state list
+  pool.pushBack(List::Baked, indices[1]);
+  pool.touch(indices[1]);
+  pool[indices[1]].lastUseFrameIndex = 5;
+  pool.touch(indices[0]);
+  pool[indices[0]].lastUseFrameIndex = 6;
+  pool.touch(indices[0]);
+  expectValues("testEvictionOrder: after use", getLruValues(pool), { 2, 3, 4, 1, 0 });
+
+  // Evict the way the manager does: walk from the least recently used item, advancing before erasing,
+  // and stop at the first item used recently enough
+  const uint32_t currentFrameIndex = 7;
+  const uint32_t minUsageFrameAge = 3;
+  std::vector<uint32_t> evicted;
+  for (auto index = pool.leastRecentlyUsed(); index != TestPool::kInvalidIndex; ) {
+    if (currentFrameIndex - pool[index].lastUseFrameIndex < minUsageFrameAge)
+      break;
+
+    const auto indexToEvict = index;
+    index = pool.nextMoreRecentlyUsed(index);
+    evicted.push_back(pool[indexToEvict].value);
+    pool.erase(indexToEvict);
+  }
+  expectValues("testEvictionOrder: evicted", evicted, { 2, 3, 4 });
+  expectValues("testEvictionOrder: remaining", getLruValues(pool), { 1, 0 });
+  expectValues("testEvictionOrder: remaining baked", getListValues(pool, List::Baked), { 1 });
+
+  // Clearing destroys everything, after which the pool is usable again
+  pool.clear();
+  if (pool.size() != 0 || TestItem::s_numLive != 0 || pool.leastRecentlyUsed() != TestPool::kInvalidIndex || !pool.empty(List::Baked))
+    throw DxvkError("testEvictionOrder: clear left items behind");
+
+  pool.emplace(hashOf(0), 10, 0);
+  expectValues("testEvictionOrder: after clear", getLruValues(pool), { 10 });
+  Logger::info("LRU eviction order test passed");
+}
+
+void testManyItems() {
+  Logger::info("Testing a pool spanning many slabs...");
+  const uint32_t kNumItems = 100000;
+  TestPool pool;
+  std::vector<const TestItem*> addresses;
+  for (uint32_t i = 0; i < kNumItems; i++) {
+    const TestPool::Index index = pool.emplace(hashOf(i), i, 0);
+    pool.pushBack(List::Unprocessed, index);
+    addresses.push_back(&pool[index]);
+  }
+
+  // Items must not move as the pool grows
+  for (uint32_t i = 0; i < kNumItems; i++) {
+    if (&pool[pool.find(hashOf(i))] != addresses[i] || addresses[i]->value != i)
+      throw DxvkError(str::format("testManyItems: item ", i, " moved or was corrupted"));
+  }
+
+  // Move every other item through the remaining states and evict the rest
+  for (auto index = pool.front(List::Unprocessed); index != TestPool::kInvalidIndex; ) {
+    const auto nextIndex = pool.next(index);
+    if (pool[index].value % 2 == 0) {
+      pool.pushBack(List::Baked, index);
+      pool.pushBack(List::Built, index);
+    } else {
+      pool.erase(index);
+    }
+    index = nextIndex;
+  }
+
+  if (pool.size() != kNumItems / 2 || pool.size(List::Built) != kNumItems / 2 || !pool.empty(List::Unprocessed) || !pool.empty(List::Baked))
+    throw DxvkError("testManyItems: unexpected list sizes after transitions");
+
+  uint32_t expectedValue = 0;
+  for (auto index = pool.leastRecentlyUsed(); index != TestPool::kInvalidIndex; index = pool.nextMoreRecentlyUsed(index)) {
+    if (pool[index].value != expectedValue)
+      throw DxvkError(str::format("testManyItems: LRU order broken at ", expectedValue));
+    expectedValue += 2;
+  }
+  Logger::info("Pool spanning many slabs test passed");
+}
+
+void testBudgetAccounting() {
+  Logger::info("Testing memory budget accounting...");
+  TestMemoryBudget budget(3);
+  budget.setBudget(1000);
+
+  if (!budget.allocate(600) || !budget.allocate(300) || budget.getUsed() != 900 || budget.getAvailable() != 100)
+    throw DxvkError("testBudgetAccounting: allocations within the budget failed");
+  if (budget.allocate(101))
+    throw DxvkError("testBudgetAccounting: allocation over the budget succeeded");
+
+  // Released memory stays in use until the next frame starts, but counts as pending available for eviction
+  budget.release(600);
+  if (budget.getUsed() != 900 || budget.calculatePendingReleasedSize() != 600 ||
+      budget.getNextPendingReleasedSize() != 600 || budget.calculatePendingAvailableSize() != 700)
+    throw DxvkError("testBudgetAccounting: release must be delayed");
+
+  budget.onFrameStart();
+  if (budget.getUsed() != 300 || budget.calculatePendingReleasedSize() != 0 || budget.getAvailable() != 700)
+    throw DxvkError("testBudgetAccounting: released memory was not returned on frame start");
+
+  // Pending available size is capped by the budget, e.g. when the budget shrank below the used memory
+  budget.setBudget(200);
+  if (budget.getPrevBudget() != 1000 || budget.getAvailable() != 0)
+    throw DxvkError("testBudgetAccounting: budget decrease not accounted for");
+  budget.releaseAll();
+  if (budget.calculatePendingAvailableSize() != 200)
+    throw DxvkError("testBudgetAccounting: pending available size must not exceed the budget");
+
+  // Running total must stay consistent across many frames
+  for (uint32_t frame = 0; frame < 10; frame++)
+    budget.onFrameStart();
+  if (budget.getUsed() != 0 || budget.calculatePendingReleasedSize() != 0)
+    throw DxvkError("testBudgetAccounting: memory was not fully released");
+
+  // Releasing more than used must not underflow
+  budget.setBudget(1000);
+  budget.allocate(100);
+  budget.release(500);
+  budget.onFrameStart();
+  if (budget.getUsed() != 0 || budget.getAvailable() != 1000)
+    throw DxvkError("testBudgetAccounting: over release underflowed");
+  Logger::info("Memory budget accounting test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_opacity_micromap_cache...");
+
+  try {
+    dxvk::testStateTransitions();
+    dxvk::testEvictionOrder();
+    dxvk::testManyItems();
+    dxvk::testBudgetAccounting();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
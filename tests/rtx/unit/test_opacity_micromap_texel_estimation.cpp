@@ -0,0 +1,268 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_opacity_micromap_texel_estimation.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_opacity_micromap_texel_estimation.log");
+
+namespace {
+  struct TestMesh {
+    std::vector<float> texcoords; // Interleaved with a padding float to exercise the stride
+    std::vector<uint16_t> indices16;
+    std::vector<uint32_t> indices32;
+    uint32_t numVertices = 0;
+    uint32_t numTriangles = 0;
+  };
+
+  enum class IndexMode { None, Uint16, Uint32 };
+
+  TestMesh createMesh(std::mt19937& rng, IndexMode indexMode, uint32_t numTriangles, float texcoordRange) {
+    TestMesh mesh;
+    mesh.numTriangles = numTriangles;
+    mesh.numVertices = indexMode == IndexMode::None ? numTriangles * 3 : std::min(numTriangles + 2, 60000u);
+
+    std::uniform_real_distribution<float> texcoordDist(-texcoordRange, texcoordRange);
+    // Mostly small triangles, like in typical content, with the odd large one
+    std::uniform_real_distribution<float> offsetDist(-0.02f, 0.02f);
+    mesh.texcoords.resize(mesh.numVertices * 3);
+    for (uint32_t i = 0; i < mesh.numVertices; i++) {
+      const bool isClustered = i > 0 && rng() % 8 != 0;
+      mesh.texcoords[i * 3 + 0] = isClustered ? mesh.texcoords[(i - 1) * 3 + 0] + offsetDist(rng) : texcoordDist(rng);
+      mesh.texcoords[i * 3 + 1] = isClustered ? mesh.texcoords[(i - 1) * 3 + 1] + offsetDist(rng) : texcoordDist(rng);
+      mesh.texcoords[i * 3 + 2] = 0.f;
+    }
+
+    if (indexMode != IndexMode::None) {
+      for (uint32_t i = 0; i < numTriangles * 3; i++) {
+        // Reference neighbouring vertices, like a strip converted to a list would
+        const uint32_t index = std::min(i / 3 + i % 3 + static_cast<uint32_t>(rng() % 4 == 0 ? rng() % 3 : 0), mesh.numVertices - 1);
+        if (indexMode == IndexMode::Uint16) {
+          mesh.indices16.push_back(static_cast<uint16_t>(index));
+        } else {
+          mesh.indices32.push_back(index);
+        }
+      }
+    }
+    return mesh;
+  }
+
+  OpacityMicromapTexelEstimationInput createInput(const TestMesh& mesh, const Matrix4* textureTransform,
+                                                  Vector2 textureResolution, uint32_t subdivisionLevel, uint32_t maxTexelTaps) {
+    OpacityMicromapTexelEstimationInput input;
+    input.texcoordData = mesh.texcoords.data();
+    input.texcoordStride = 3;
+    input.numVertices = mesh.numVertices;
+    input.indices16 = mesh.indices16.empty() ? nullptr : mesh.indices16.data();
+    input.indices32 = mesh.indices32.empty() ? nullptr : mesh.indices32.data();
+    input.textureTransform = textureTransform;
+    input.textureResolution = textureResolution;
+    input.rcpNumMicroTrianglesAlongEdge = 1.f / (1 << subdivisionLevel);
+    input.maxTexelTapsPerMicroTriangle = maxTexelTaps;
+    return input;
+  }
+
+  void compareEstimates(const char* context, const OpacityMicromapTexelEstimationInput& input,
+                        uint32_t firstTriangle, uint32_t numTriangles, uint32_t numTotalTriangles) {
+    std::vector<uint16_t> scalar(numTotalTriangles, 0xcdcd);
+    std::vector<uint16_t> batched(numTotalTriangles, 0xcdcd);
+
+    const uint32_t numScalarWithinBudget = estimateNumTexelsPerMicroTriangleScalar(input, firstTriangle, numTriangles, scalar.data());
+    const uint32_t numBatchedWithinBudget = estimateNumTexelsPerMicroTriangle(input, firstTriangle, numTriangles, batched.data());
+
+    for (uint32_t i = 0; i < numTotalTriangles; i++) {
+      if (scalar[i] != batched[i]) {
+        throw DxvkError(str::format(context, ": triangle ", i, " estimated ", batched[i], " texels, expected ", scalar[i]));
+      }
+    }
+    if (numScalarWithinBudget != numBatchedWithinBudget) {
+      throw DxvkError(str::format(context, ": ", numBatchedWithinBudget, " triangles within budget, expected ", numScalarWithinBudget));
+    }
+  }
+} // anonymous namespace
+
+void testKnownValues() {
+  Logger::info("Testing known texel estimates...");
+
+  // A triangle covering half of a 64x64 texture
+  const Vector2 triangle[3] = { Vector2 { 0.f, 0.f }, Vector2 { 1.f, 0.f }, Vector2 { 0.f, 1.f } };
+  const Vector2 resolution { 64.f, 64.f };
+
+  // A micro triangle spans [0, 4] texels in both dimensions at subdivision level 4,
+  // which is widened by a half texel (and epsilon) to [-1, 4] texel centers
+  if (calculateNumTexelsPerMicroTriangle(triangle, 1.f / 16, resolution) != 36) {
+    throw DxvkError("testKnownValues: unexpected estimate at subdivision level 4");
+  }
+  if (calculateNumTexelsPerMicroTriangle(triangle, 1.f, resolution) != 66 * 66) {
+    throw DxvkError("testKnownValues: unexpected estimate at subdivision level 0");
+  }
+
+  // Same triangle through the mesh path, indexed and non-indexed, with one triangle over the budget
+  const float texcoords[] = { 0.f, 0.f, 1.f, 0.f, 0.f, 1.f };
+  const uint16_t indices[] = { 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 3 };
+  OpacityMicromapTexelEstimationInput input;
+  input.texcoordData = texcoords;
+  input.numVertices = 3;
+  input.indices16 = indices;
+  input.textureResolution = resolution;
+  input.rcpNumMicroTrianglesAlongEdge = 1.f / 16;
+  input.maxTexelTapsPerMicroTriangle = 64;
+
+  uint16_t result[5] = {};
+  if (estimateNumTexelsPerMicroTriangle(input, 0, 5, result) != 4 ||
+      result[0] != 36 || result[3] != 36 || result[4] != 0) {
+    throw DxvkError("testKnownValues: unexpected indexed estimates");
+  }
+
+  // Out of range vertices are treated as exceeding the budget
+  input.indices16 = nullptr;
+  if (estimateNumTexelsPerMicroTriangle(input, 0, 2, result) != 1 || result[0] != 36 || result[1] != 0) {
+    throw DxvkError("testKnownValues: unexpected non-indexed estimates");
+  }
+
+  input.maxTexelTapsPerMicroTriangle = 35;
+  if (estimateNumTexelsPerMicroTriangle(input, 0, 1, result) != 0 || result[0] != 0) {
+    throw DxvkError("testKnownValues: triangles over the tap budget must be set to 0");
+  }
+  Logger::info("Known texel estimates test passed");
+}
+
+void testEquivalence() {
+  Logger::info("Testing batched and scalar texel estimation equivalence...");
+  std::mt19937 rng(1234);
+
+  Matrix4 textureTransform;
+  textureTransform[0][0] = 2.5f;
+  textureTransform[1][1] = -1.25f;
+  textureTransform[1][0] = 0.3f;
+  textureTransform[3][0] = 0.125f;
+  textureTransform[3][1] = 7.f;
+
+  const Matrix4* kTransforms[] = { nullptr, &textureTransform };
+  const IndexMode kIndexModes[] = { IndexMode::None, IndexMode::Uint16, IndexMode::Uint32 };
+  const Vector2 kResolutions[] = { Vector2 { 1.f, 1.f }, Vector2 { 256.f, 128.f }, Vector2 { 4096.f, 4096.f }, Vector2 { 0.f, 0.f } };
+  const float kTexcoordRanges[] = { 1.f, 16.f, 1e6f };
+
+  for (IndexMode indexMode : kIndexModes) {
+    for (float texcoordRange : kTexcoordRanges) {
+      // Triangle counts that are and aren't multiples of the batch size
+      for (uint32_t numTriangles : { 1u, 3u, 4u, 7u, 1000u, 4099u }) {
+        const TestMesh mesh = createMesh(rng, indexMode, numTriangles, texcoordRange);
+
+        for (const Matrix4* transform : kTransforms) {
+          for (Vector2 resolution : kResolutions) {
+            for (uint32_t subdivisionLevel : { 0u, 3u, 9u }) {
+              for (uint32_t maxTexelTaps : { 1u, 64u, 65535u }) {
+                const OpacityMicromapTexelEstimationInput input = createInput(mesh, transform, resolution, subdivisionLevel, maxTexelTaps);
+                const std::string context = str::format("testEquivalence(indexMode ", static_cast<int>(indexMode), ", range ", texcoordRange,
+                                                        ", triangles ", numTriangles, ", transform ", transform != nullptr, ", resolution ", resolution.x,
+                                                        ", subdivision ", subdivisionLevel, ", maxTaps ", maxTexelTaps, ")");
+                compareEstimates(context.c_str(), input, 0, numTriangles, numTriangles);
+
+                // Partial ranges, as processed under a per-frame triangle budget
+                if (numTriangles >= 8) {
+                  compareEstimates(context.c_str(), input, 1, numTriangles - 2, numTriangles);
+                  compareEstimates(context.c_str(), input, 3, 5, numTriangles);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  Logger::info("Batched and scalar texel estimation equivalence test passed");
+}
+
+void testThroughput() {
+  Logger::info("Testing texel estimation throughput...");
+  std::mt19937 rng(5678);
+
+  const uint32_t kNumTriangles = 1 << 18;
+  const uint32_t kIterations = 8;
+  const IndexMode kIndexModes[] = { IndexMode::None, IndexMode::Uint16, IndexMode::Uint32 };
+  const char* kIndexModeNames[] = { "non-indexed", "16-bit indices", "32-bit indices" };
+
+  for (uint32_t mode = 0; mode < 3; mode++) {
+    const TestMesh mesh = createMesh(rng, kIndexModes[mode], kNumTriangles, 1.f);
+    const OpacityMicromapTexelEstimationInput input = createInput(mesh, nullptr, Vector2 { 1024.f, 1024.f }, 8, 64);
+    std::vector<uint16_t> result(kNumTriangles);
+
+    uint32_t numScalarWithinBudget = 0;
+    uint32_t numBatchedWithinBudget = 0;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (uint32_t iteration = 0; iteration < kIterations; iteration++) {
+      numScalarWithinBudget += estimateNumTexelsPerMicroTriangleScalar(input, 0, kNumTriangles, result.data());
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (uint32_t iteration = 0; iteration < kIterations; iteration++) {
+      numBatchedWithinBudget += estimateNumTexelsPerMicroTriangle(input, 0, kNumTriangles, result.data());
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    if (numScalarWithinBudget != numBatchedWithinBudget) {
+      throw DxvkError("testThroughput: batched and scalar estimates differ");
+    }
+
+    const double millions = double(kNumTriangles) * kIterations / 1e6;
+    const double scalarSeconds = std::chrono::duration<double>(t1 - t0).count();
+    const double batchedSeconds = std::chrono::duration<double>(t2 - t1).count();
+    Logger::info(str::format(kIndexModeNames[mode], ": scalar ", millions / scalarSeconds, " Mtri/s, batched ",
+                             millions / batchedSeconds, " Mtri/s"));
+  }
+  Logger::info("Texel estimation throughput test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_opacity_micromap_texel_estimation...");
+
+  try {
+    dxvk::testKnownValues();
+    dxvk::testEquivalence();
+    dxvk::testThroughput();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
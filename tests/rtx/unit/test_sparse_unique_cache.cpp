@@ -0,0 +1,327 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_sparse_unique_cache.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/xxHash/xxhash.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_sparse_unique_cache.log");
+
+namespace {
+  // The previous map based implementation, which the cache must stay index-compatible with
+  template<typename T, class HashFn, class KeyEqual = std::equal_to<T>>
+  struct ReferenceSparseUniqueCache {
+    void clear() {
+      m_freeBuffers = {};
+      m_objects.clear();
+      m_bufferMap.clear();
+    }
+
+    uint32_t track(const T& obj) {
+      uint32_t idx;
+      if (!find(obj, idx)) {
+        if (!m_freeBuffers.empty()) {
+          idx = m_freeBuffers.front();
+          m_freeBuffers.pop();
+          m_objects.at(idx) = obj;
+        } else {
+          idx = m_objects.size();
+          m_objects.push_back(obj);
+        }
+        m_bufferMap.insert({ obj, idx });
+      }
+      return idx;
+    }
+
+    bool find(const T& buf, uint32_t& outIdx) const {
+      const auto& iter = m_bufferMap.find(buf);
+      if (iter != m_bufferMap.end()) {
+        outIdx = iter->second;
+        return true;
+      }
+      return false;
+    }
+
+    void free(const T& buf) {
+      auto iter = m_bufferMap.find(buf);
+      if (iter != m_bufferMap.end()) {
+        m_objects.at(iter->second) = T();
+        m_freeBuffers.push(iter->second);
+        m_bufferMap.erase(iter);
+      }
+    }
+
+    uint32_t getActiveCount() const { return m_objects.size() - m_freeBuffers.size(); }
+    uint32_t getTotalCount() const { return m_objects.size(); }
+
+    std::queue<uint32_t> m_freeBuffers;
+    std::vector<T> m_objects;
+    std::unordered_map<T, uint32_t, HashFn, KeyEqual> m_bufferMap;
+  };
+
+  struct IdentityHashFn {
+    size_t operator()(uint32_t value) const { return value; }
+  };
+
+  // Only a handful of distinct hashes, so probe chains are long and full of hash collisions
+  struct CollidingHashFn {
+    size_t operator()(uint32_t value) const { return value % 7; }
+  };
+
+  // Sized and compared like RtSurfaceMaterial: texture indices and constants, with equality on a cached hash
+  struct BenchmarkMaterial {
+    uint32_t textureIndices[8] = { };
+    float constants[22] = { };
+    XXH64_hash_t cachedHash = 0;
+
+    bool operator==(const BenchmarkMaterial& other) const {
+      return cachedHash == other.cachedHash;
+    }
+  };
+  static_assert(sizeof(BenchmarkMaterial) == 128);
+
+  struct BenchmarkMaterialHashFn {
+    size_t operator()(const BenchmarkMaterial& material) const {
+      return size_t(material.cachedHash);
+    }
+  };
+
+  BenchmarkMaterial createMaterial(std::mt19937& rng) {
+    BenchmarkMaterial material;
+    for (auto& index : material.textureIndices) {
+      index = rng() % 4096;
+    }
+    for (auto& constant : material.constants) {
+      constant = float(rng() % 1000) / 1000.f;
+    }
+    material.cachedHash = XXH3_64bits(&material, offsetof(BenchmarkMaterial, cachedHash));
+    return material;
+  }
+
+  template<typename Cache>
+  void checkIndex(const char* context, Cache& cache, uint32_t value, uint32_t expected) {
+    uint32_t idx = ~0u;
+    if (!cache.find(value, idx) || idx != expected) {
+      throw DxvkError(str::format(context, ": expected ", value, " at index ", expected, ", found ", idx));
+    }
+  }
+
+  template<typename HashFn>
+  void compareWithReference(const char* context, uint32_t numValues, uint32_t numSteps) {
+    std::mt19937 rng(2468);
+    SparseUniqueCache<uint32_t, HashFn> cache;
+    ReferenceSparseUniqueCache<uint32_t, HashFn> reference;
+
+    for (uint32_t step = 0; step < numSteps; step++) {
+      // Values start at 1, since freed slots hold the default constructed 0
+      const uint32_t value = 1 + rng() % numValues;
+      const uint32_t action = rng() % 8;
+
+      if (action < 4) {
+        const uint32_t idx = cache.track(value);
+        const uint32_t expected = reference.track(value);
+        if (idx != expected) {
+          throw DxvkError(str::format(context, ": step ", step, " tracked ", value, " at ", idx, ", expected ", expected));
+        }
+      } else if (action < 7) {
+        cache.free(value);
+        reference.free(value);
+      } else {
+        uint32_t idx = ~0u, expected = ~0u;
+        const bool found = cache.find(value, idx);
+        if (found != reference.find(value, expected) || idx != expected) {
+          throw DxvkError(str::format(context, ": step ", step, " lookup of ", value, " doesn't match"));
+        }
+      }
+
+      if (cache.getActiveCount() != reference.getActiveCount() || cache.getTotalCount() != reference.getTotalCount()) {
+        throw DxvkError(str::format(context, ": step ", step, " counts don't match"));
+      }
+
+      if (step % 20000 == 19999) {
+        cache.clear();
+        reference.clear();
+      }
+    }
+
+    if (cache.getObjectTable() != reference.m_objects) {
+      throw DxvkError(str::format(context, ": object tables don't match"));
+    }
+  }
+} // anonymous namespace
+
+void testIndexStability() {
+  Logger::info("Testing sparse unique cache index stability...");
+  SparseUniqueCache<uint32_t, IdentityHashFn> cache;
+
+  for (uint32_t value = 1; value <= 100; value++) {
+    if (cache.track(value) != value - 1) {
+      throw DxvkError(str::format("testIndexStability: ", value, " should be tracked at index ", value - 1));
+    }
+  }
+  if (cache.track(42) != 41 || cache.getTotalCount() != 100 || cache.getActiveCount() != 100) {
+    throw DxvkError("testIndexStability: tracking a known object must not add it again");
+  }
+
+  // Freed indices are reused in the order they were freed, and nothing else moves
+  cache.free(10);
+  cache.free(3);
+  cache.free(77);
+  cache.free(1000);
+  if (cache.getActiveCount() != 97 || cache.getTotalCount() != 100 || cache.getObjectTable()[2] != 0) {
+    throw DxvkError("testIndexStability: unexpected counts after freeing");
+  }
+  uint32_t idx;
+  if (cache.find(10, idx)) {
+    throw DxvkError("testIndexStability: freed object should not be found");
+  }
+  for (uint32_t value = 1; value <= 100; value++) {
+    if (value != 10 && value != 3 && value != 77) {
+      checkIndex("testIndexStability", cache, value, value - 1);
+    }
+  }
+
+  const uint32_t expectedReuse[] = { 9, 2, 76, 100 };
+  for (uint32_t i = 0; i < 4; i++) {
+    if (cache.track(200 + i) != expectedReuse[i]) {
+      throw DxvkError(str::format("testIndexStability: new object ", i, " should reuse index ", expectedReuse[i]));
+    }
+  }
+
+  cache.clear();
+  if (cache.find(1, idx) || cache.getTotalCount() != 0 || cache.track(5) != 0) {
+    throw DxvkError("testIndexStability: cleared cache should start over");
+  }
+  Logger::info("Sparse unique cache index stability test passed");
+}
+
+void testChurn() {
+  Logger::info("Testing sparse unique cache under churn...");
+  compareWithReference<IdentityHashFn>("testChurn (identity hash)", 2000, 200000);
+  compareWithReference<CollidingHashFn>("testChurn (colliding hash)", 300, 50000);
+  Logger::info("Sparse unique cache churn test passed");
+}
+
+void testFirstCacheCallback() {
+  Logger::info("Testing sparse unique cache first cache callback...");
+  SparseUniqueCache<uint32_t, IdentityHashFn> cache;
+  uint32_t numCalls = 0;
+  auto onFirstCache = [&numCalls](uint32_t value) {
+    numCalls++;
+    return value;
+  };
+
+  const uint32_t idx = cache.track(7, onFirstCache);
+  if (cache.track(7, onFirstCache) != idx || numCalls != 1) {
+    throw DxvkError("testFirstCacheCallback: callback should only run when an object is first cached");
+  }
+  Logger::info("Sparse unique cache first cache callback test passed");
+}
+
+void testThroughput() {
+  Logger::info("Testing sparse unique cache throughput...");
+  std::mt19937 rng(1357);
+
+  // A frame registers a few thousand materials across many more draw calls, and the caches are cleared every frame
+  const uint32_t kNumMaterials = 3000;
+  const uint32_t kNumDraws = 20000;
+  const uint32_t kNumFrames = 50;
+
+  std::vector<BenchmarkMaterial> materials;
+  for (uint32_t i = 0; i < kNumMaterials; i++) {
+    materials.push_back(createMaterial(rng));
+  }
+  std::vector<uint32_t> draws;
+  for (uint32_t i = 0; i < kNumDraws; i++) {
+    draws.push_back(rng() % kNumMaterials);
+  }
+
+  SparseUniqueCache<BenchmarkMaterial, BenchmarkMaterialHashFn> cache;
+  ReferenceSparseUniqueCache<BenchmarkMaterial, BenchmarkMaterialHashFn> reference;
+  uint64_t cacheChecksum = 0;
+  uint64_t referenceChecksum = 0;
+
+  auto t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t frame = 0; frame < kNumFrames; frame++) {
+    reference.clear();
+    for (uint32_t draw : draws) {
+      referenceChecksum += reference.track(materials[draw]);
+    }
+  }
+  auto t1 = std::chrono::high_resolution_clock::now();
+  for (uint32_t frame = 0; frame < kNumFrames; frame++) {
+    cache.clear();
+    for (uint32_t draw : draws) {
+      cacheChecksum += cache.track(materials[draw]);
+    }
+  }
+  auto t2 = std::chrono::high_resolution_clock::now();
+
+  if (cacheChecksum != referenceChecksum) {
+    throw DxvkError("testThroughput: indices differ from the reference implementation");
+  }
+
+  const double millions = double(kNumDraws) * kNumFrames / 1e6;
+  const double referenceSeconds = std::chrono::duration<double>(t1 - t0).count();
+  const double cacheSeconds = std::chrono::duration<double>(t2 - t1).count();
+  Logger::info(str::format("Material tracking: map based ", millions / referenceSeconds, " M/s, open addressed ",
+                           millions / cacheSeconds, " M/s"));
+  Logger::info("Sparse unique cache throughput test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_sparse_unique_cache...");
+
+  try {
+    dxvk::testIndexStability();
+    dxvk::testChurn();
+    dxvk::testFirstCacheCallback();
+    dxvk::testThroughput();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
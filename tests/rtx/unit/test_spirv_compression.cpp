@@ -0,0 +1,305 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/spirv/spirv_compression.h"
+#include "../../../src/spirv/spirv_module.h"
+#include "../../../src/util/util_bit.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_spirv_compression.log");
+
+namespace {
+  constexpr fast::SIMD kSimdLevels[] = { fast::None, fast::SSE4_1 };
+  constexpr SpirvCompressionMode kModes[] = { SpirvCompressionMode::Fast, SpirvCompressionMode::Dictionary };
+
+  // The original scalar encoder, which defines the compressed format
+  void referenceCompress(const SpirvCodeBuffer& code, std::vector<uint64_t>& mask, std::vector<uint64_t>& packed) {
+    const uint32_t* data = code.data();
+    uint64_t dstWord = 0;
+    uint32_t dstShift = 0;
+
+    for (uint32_t i = 0; i < code.dwords(); i += 32) {
+      uint64_t byteCounts = 0;
+
+      for (uint32_t w = 0; w < 32 && i + w < code.dwords(); w++) {
+        uint64_t word = data[i + w];
+        uint64_t bytes = word < (1 << 8) ? 0 : word < (1 << 16) ? 1 : word < (1 << 24) ? 2 : 3;
+        byteCounts |= bytes << (2 * w);
+
+        uint32_t bits = 8 * bytes + 8;
+        uint32_t rem = bit::pack(dstWord, dstShift, word, bits);
+
+        if (rem != 0) {
+          packed.push_back(dstWord);
+          dstWord = 0;
+          dstShift = 0;
+          bit::pack(dstWord, dstShift, word >> (bits - rem), rem);
+        }
+      }
+
+      mask.push_back(byteCounts);
+    }
+
+    if (dstShift) {
+      packed.push_back(dstWord);
+    }
+  }
+
+  // Mixes small IDs, opcodes and full 32-bit literals, in runs so that the dictionary has something to find
+  SpirvCodeBuffer createRandomCode(std::mt19937& rng, uint32_t dwords) {
+    std::vector<uint32_t> words(dwords);
+    std::uniform_int_distribution<uint32_t> any;
+    uint32_t distribution = any(rng) % 4;
+
+    for (uint32_t i = 0; i < dwords; i++) {
+      uint32_t byteCount = distribution == 3 ? any(rng) % 4 : std::min(distribution, any(rng) % 4);
+      uint32_t value = any(rng);
+      words[i] = byteCount == 3 ? value : value & ((1u << (8 * byteCount + 8)) - 1);
+
+      if (i >= 8 && any(rng) % 4 == 0) {
+        words[i] = words[i - 1 - any(rng) % 8];
+      }
+    }
+
+    return SpirvCodeBuffer(dwords, words.data());
+  }
+
+  // A fragment shader with a long chain of arithmetic, similar in shape to translated D3D9 shaders
+  SpirvCodeBuffer createModule(uint32_t instructionCount) {
+    SpirvModule module(spvVersion(1, 3));
+    module.enableCapability(spv::CapabilityShader);
+    module.setMemoryModel(spv::AddressingModelLogical, spv::MemoryModelGLSL450);
+
+    uint32_t floatType = module.defFloatType(32);
+    uint32_t vec4Type = module.defVectorType(floatType, 4);
+    uint32_t inputVar = module.newVar(module.defPointerType(vec4Type, spv::StorageClassInput), spv::StorageClassInput);
+    uint32_t outputVar = module.newVar(module.defPointerType(vec4Type, spv::StorageClassOutput), spv::StorageClassOutput);
+    module.decorateLocation(inputVar, 0);
+    module.decorateLocation(outputVar, 0);
+
+    uint32_t voidType = module.defVoidType();
+    uint32_t entryPoint = module.allocateId();
+    module.functionBegin(voidType, entryPoint, module.defFunctionType(voidType, 0, nullptr), spv::FunctionControlMaskNone);
+    module.opLabel(module.allocateId());
+
+    uint32_t value = module.opLoad(vec4Type, inputVar);
+    for (uint32_t i = 0; i < instructionCount; i++) {
+      const uint32_t swizzle[4] = { i % 4, (i + 1) % 4, (i + 2) % 4, (i + 3) % 4 };
+      uint32_t constant = module.constvec4f32(float(i), 0.5f, -float(i), 2.0f);
+      value = module.opFAdd(vec4Type, module.opFMul(vec4Type, value, constant), module.opVectorShuffle(vec4Type, value, value, 4, swizzle));
+    }
+
+    module.opStore(outputVar, value);
+    module.opReturn();
+    module.functionEnd();
+
+    const uint32_t interfaces[] = { inputVar, outputVar };
+    module.addEntryPoint(entryPoint, spv::ExecutionModelFragment, "main", 2, interfaces);
+    module.setExecutionMode(entryPoint, spv::ExecutionModeOriginUpperLeft);
+    return module.compile();
+  }
+
+  bool sameCode(const SpirvCodeBuffer& a, const SpirvCodeBuffer& b) {
+    return a.dwords() == b.dwords() && (a.dwords() == 0 || !std::memcmp(a.data(), b.data(), a.size()));
+  }
+} // anonymous namespace
+
+void testRoundTrip() {
+  Logger::info("Testing SPIR-V compression round trip...");
+  std::mt19937 rng(42);
+
+  for (uint32_t iteration = 0; iteration < 2000; iteration++) {
+    // Cover empty buffers and sizes around mask word and SIMD group boundaries
+    const uint32_t dwords = iteration < 80 ? iteration : rng() % 4096;
+    const SpirvCodeBuffer code = createRandomCode(rng, dwords);
+
+    std::vector<uint64_t> referenceMask;
+    std::vector<uint64_t> referenceCode;
+    referenceCompress(code, referenceMask, referenceCode);
+
+    for (SpirvCompressionMode mode : kModes) {
+      for (fast::SIMD encodeSimd : kSimdLevels) {
+        const SpirvCompressedBuffer compressed(code, mode, encodeSimd);
+
+        if (compressed.dwords() != dwords || compressed.mode() != mode || !compressed.isValid()) {
+          throw DxvkError(str::format("testRoundTrip: invalid buffer for ", dwords, " dwords, mode ", uint32_t(mode)));
+        }
+        if (compressed.getMask() != referenceMask ||
+            (mode == SpirvCompressionMode::Fast && compressed.getCode() != referenceCode)) {
+          throw DxvkError(str::format("testRoundTrip: output differs from the reference encoder for ", dwords, " dwords, SIMD level ", uint32_t(encodeSimd)));
+        }
+
+        for (fast::SIMD decodeSimd : kSimdLevels) {
+          if (!sameCode(compressed.decompress(decodeSimd), code)) {
+            throw DxvkError(str::format("testRoundTrip: round trip failed for ", dwords, " dwords, mode ", uint32_t(mode), ", SIMD level ", uint32_t(decodeSimd)));
+          }
+        }
+
+        // Restored buffers must decode the same way
+        const SpirvCompressedBuffer restored(compressed.dwords(), compressed.getMask(), compressed.getCode(), compressed.mode());
+        if (!restored.isValid() || !sameCode(restored.decompress(), code)) {
+          throw DxvkError(str::format("testRoundTrip: restored buffer failed for ", dwords, " dwords"));
+        }
+      }
+    }
+  }
+  Logger::info("SPIR-V compression round trip test passed");
+}
+
+void testValidation() {
+  Logger::info("Testing SPIR-V compression validation...");
+  std::mt19937 rng(7);
+
+  for (uint32_t iteration = 0; iteration < 500; iteration++) {
+    const SpirvCodeBuffer code = createRandomCode(rng, 1 + rng() % 1024);
+
+    for (SpirvCompressionMode mode : kModes) {
+      const SpirvCompressedBuffer compressed(code, mode);
+
+      // Dropping the last word always removes at least one byte of the stream
+      std::vector<uint64_t> shortCode(compressed.getCode().begin(), compressed.getCode().end() - 1);
+      if (SpirvCompressedBuffer(compressed.dwords(), compressed.getMask(), shortCode, mode).isValid()) {
+        throw DxvkError("testValidation: accepted truncated code");
+      }
+      if (SpirvCompressedBuffer(compressed.dwords() + 32, compressed.getMask(), compressed.getCode(), mode).isValid()) {
+        throw DxvkError("testValidation: accepted a mismatched mask");
+      }
+
+      // Corrupted dictionary streams must either be rejected or decode in bounds
+      if (mode == SpirvCompressionMode::Dictionary) {
+        for (uint32_t i = 0; i < 16; i++) {
+          std::vector<uint64_t> corrupted = compressed.getCode();
+          reinterpret_cast<uint8_t*>(corrupted.data())[rng() % (corrupted.size() * 8)] ^= uint8_t(1 + rng() % 255);
+          const SpirvCompressedBuffer buffer(compressed.dwords(), compressed.getMask(), std::move(corrupted), mode);
+
+          if (buffer.isValid() && buffer.decompress().dwords() != compressed.dwords()) {
+            throw DxvkError("testValidation: corrupted buffer decoded to the wrong size");
+          }
+        }
+      }
+    }
+  }
+
+  // A match that points before the start of the stream
+  const uint32_t words[] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88 };
+  const std::vector<uint64_t> mask = { 0 };
+  const std::vector<uint64_t> badOffset = { 0x0000000000080010ull | (0x11ull << 8) };
+  if (SpirvCompressedBuffer(8, mask, badOffset, SpirvCompressionMode::Dictionary).isValid()) {
+    throw DxvkError("testValidation: accepted an out of bounds match offset");
+  }
+  const SpirvCompressedBuffer good(SpirvCodeBuffer(8, words), SpirvCompressionMode::Dictionary);
+  if (!good.isValid() || SpirvCompressedBuffer(8, mask, good.getCode(), SpirvCompressionMode(2)).isValid()) {
+    throw DxvkError("testValidation: compression mode validation failed");
+  }
+  Logger::info("SPIR-V compression validation test passed");
+}
+
+void testThroughput() {
+  Logger::info("Measuring SPIR-V compression throughput...");
+  std::vector<SpirvCodeBuffer> corpus;
+  size_t totalBytes = 0;
+
+  for (uint32_t i = 0; i < 64; i++) {
+    corpus.push_back(createModule(16 + i * 8));
+    totalBytes += corpus.back().size();
+  }
+
+  constexpr uint32_t kIterations = 20;
+
+  for (SpirvCompressionMode mode : kModes) {
+    for (fast::SIMD simd : kSimdLevels) {
+      if (simd > fast::getSimdSupportLevel()) {
+        continue;
+      }
+
+      std::vector<SpirvCompressedBuffer> compressed(corpus.size());
+      size_t compressedBytes = 0;
+
+      auto t0 = std::chrono::high_resolution_clock::now();
+      for (uint32_t iteration = 0; iteration < kIterations; iteration++) {
+        for (size_t i = 0; i < corpus.size(); i++) {
+          compressed[i] = SpirvCompressedBuffer(corpus[i], mode, simd);
+        }
+      }
+      auto t1 = std::chrono::high_resolution_clock::now();
+      for (uint32_t iteration = 0; iteration < kIterations; iteration++) {
+        for (size_t i = 0; i < corpus.size(); i++) {
+          if (compressed[i].decompress(simd).dwords() != corpus[i].dwords()) {
+            throw DxvkError("testThroughput: decompressed size mismatch");
+          }
+        }
+      }
+      auto t2 = std::chrono::high_resolution_clock::now();
+
+      for (size_t i = 0; i < corpus.size(); i++) {
+        compressedBytes += 8 * (compressed[i].getMask().size() + compressed[i].getCode().size());
+        if (!sameCode(compressed[i].decompress(simd), corpus[i])) {
+          throw DxvkError("testThroughput: round trip failed");
+        }
+      }
+
+      const double megabytes = double(totalBytes) * kIterations / (1024.0 * 1024.0);
+      const double encodeSeconds = std::chrono::duration<double>(t1 - t0).count();
+      const double decodeSeconds = std::chrono::duration<double>(t2 - t1).count();
+      Logger::info(str::format(mode == SpirvCompressionMode::Fast ? "Fast" : "Dictionary", simd == fast::None ? " (scalar)" : " (SSE4.1)",
+                               ": encode ", megabytes / encodeSeconds, " MB/s, decode ", megabytes / decodeSeconds,
+                               " MB/s, ratio ", double(compressedBytes) / double(totalBytes)));
+    }
+  }
+  Logger::info("SPIR-V compression throughput test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_spirv_compression...");
+
+  try {
+    dxvk::testRoundTrip();
+    dxvk::testValidation();
+    dxvk::testThroughput();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
@@ -22,6 +22,7 @@
 
 #include <iostream>
 #include <cmath>
+#include <memory>
 #include "../../test_utils.h"
 #include "../../../src/util/util_vector.h"
 #include "../../../src/util/log/log.h"
@@ -3927,6 +3928,99 @@ void testVelocity() {
   Logger::info(str::format("Velocity component passed - all ", variants.size(), " variants tested"));
 }
 
+//=============================================================================
+// GRAPH BATCH STORAGE
+//=============================================================================
+
+void testGraphBatchChunkedStorage() {
+  const RtComponentSpec* addSpec = getComponentVariant("lightspeed.trex.logic.Add", {
+    {"a", RtComponentPropertyType::Float},
+    {"b", RtComponentPropertyType::Float},
+    {"sum", RtComponentPropertyType::Float}
+  });
+  if (!addSpec) {
+    throw DxvkError("GraphBatch: failed to find Add<Float>");
+  }
+
+  // Two chained adds: sum1 = a + b, sum2 = sum1 + c
+  RtGraphTopology topology;
+  topology.propertyTypes = { RtComponentPropertyType::Float, RtComponentPropertyType::Float, RtComponentPropertyType::Float,
+                             RtComponentPropertyType::Float, RtComponentPropertyType::Float };
+  topology.componentSpecs = { addSpec, addSpec };
+  topology.propertyIndices = { { 0, 1, 2 }, { 2, 3, 4 } };
+  topology.graphHash = 0x1234;
+
+  // Enough instances to span several chunks, with a partial chunk at the end.
+  const size_t numInstances = RtGraphBatch::kInstanceChunkSize * 2 + 17;
+  std::vector<std::unique_ptr<RtGraphState>> states;
+  std::vector<std::unique_ptr<GraphInstance>> instances;
+
+  {
+    // Pre-sized for all instances, so the property storage is allocated once.
+    RtGraphBatch batch;
+    batch.Initialize(topology, numInstances);
+    const size_t initialCapacity = batch.getInstanceCapacity();
+    if (initialCapacity < numInstances || initialCapacity % RtGraphBatch::kInstanceChunkSize != 0) {
+      throw DxvkError(str::format("GraphBatch: unexpected initial capacity ", initialCapacity));
+    }
+    const float* initialStorage = std::get<std::vector<float>>(batch.getProperties()[0]).data();
+    for (size_t i = 0; i < numInstances; i++) {
+      states.push_back(std::make_unique<RtGraphState>(RtGraphState {
+        topology, { static_cast<float>(i), 1.0f, 0.0f, 2.0f, 0.0f }, str::format("/instance", i) }));
+      instances.push_back(std::make_unique<GraphInstance>(nullptr, topology.graphHash, 0, i, *states.back()));
+      if (!batch.addInstance(nullptr, *states.back(), instances.back().get())) {
+        throw DxvkError("GraphBatch: addInstance failed");
+      }
+    }
+
+    if (batch.getInstanceCapacity() != initialCapacity || std::get<std::vector<float>>(batch.getProperties()[0]).data() != initialStorage) {
+      throw DxvkError("GraphBatch: a pre-sized batch should not grow");
+    }
+
+    // Swap-remove a few instances, including ones in the middle of a chunk and the last instance.
+    for (size_t removeIndex : { size_t(0), size_t(70), numInstances - 1 }) {
+      batch.removeInstance(instances[removeIndex].get());
+    }
+    if (batch.getNumInstances() != numInstances - 3) {
+      throw DxvkError("GraphBatch: wrong instance count after removal");
+    }
+
+    batch.update(nullptr);
+
+    const auto& aValues = std::get<std::vector<float>>(batch.getProperties()[0]);
+    const auto& sumValues = std::get<std::vector<float>>(batch.getProperties()[4]);
+    for (size_t i = 0; i < batch.getNumInstances(); i++) {
+      const GraphInstance* instance = batch.getInstances()[i];
+      if (instance->getBatchIndex() != i) {
+        throw DxvkError(str::format("GraphBatch: instance at index ", i, " has batch index ", instance->getBatchIndex()));
+      }
+      const float expectedA = static_cast<float>(instance->getId());
+      if (!floatEquals(aValues[i], expectedA) || !floatEquals(sumValues[i], expectedA + 3.0f)) {
+        throw DxvkError(str::format("GraphBatch: wrong values for instance ", instance->getId(), " at index ", i));
+      }
+    }
+  }
+
+  // The destroyed batch's property vectors should be available for the next batch.
+  const size_t pooledAfterDestroy = RtGraphPropertyPool::getNumPooledVectors();
+  if (pooledAfterDestroy < topology.propertyTypes.size()) {
+    throw DxvkError("GraphBatch: property vectors were not returned to the pool");
+  }
+  {
+    RtGraphBatch batch;
+    batch.Initialize(topology);
+    if (RtGraphPropertyPool::getNumPooledVectors() != pooledAfterDestroy - topology.propertyTypes.size()) {
+      throw DxvkError("GraphBatch: property vectors were not reused from the pool");
+    }
+    if (!std::get<std::vector<float>>(batch.getProperties()[0]).empty()) {
+      throw DxvkError("GraphBatch: pooled property vectors should be empty");
+    }
+  }
+  RtGraphPropertyPool::clear();
+
+  Logger::info("GraphBatch chunked storage passed");
+}
+
 //=============================================================================
 // TEST RUNNER
 //=============================================================================
@@ -3984,6 +4078,9 @@ void runAllTests() {
   // Time-based
   testSmooth();
   testVelocity();
+
+  // Batch storage
+  testGraphBatchChunkedStorage();
   
   Logger::info("===========================================");
   Logger::info("All Transform Component Tests Passed!");
@@ -0,0 +1,233 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "rtx_render/rtx_mod_usd.h"
+#include "rtx_render/rtx_mod_usd_mesh_cache.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+#include "../../../src/lssusd/usd_include_begin.h"
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/subset.h>
+#include "../../../src/lssusd/usd_include_end.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_usd_mesh_cooked_cache.log");
+
+namespace {
+  // A quad made of two triangles, split into one subset per triangle.
+  pxr::UsdGeomMesh createQuadMesh(const pxr::UsdStageRefPtr& stage, const char* path) {
+    pxr::UsdGeomMesh mesh = pxr::UsdGeomMesh::Define(stage, pxr::SdfPath(path));
+    mesh.CreatePointsAttr(pxr::VtValue(pxr::VtVec3fArray { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } }));
+    mesh.CreateFaceVertexCountsAttr(pxr::VtValue(pxr::VtIntArray { 3, 3 }));
+    mesh.CreateFaceVertexIndicesAttr(pxr::VtValue(pxr::VtIntArray { 0, 1, 2, 0, 2, 3 }));
+    pxr::UsdGeomSubset::CreateGeomSubset(mesh, pxr::TfToken("first"), pxr::UsdGeomTokens->face, pxr::VtIntArray { 0 });
+    pxr::UsdGeomSubset::CreateGeomSubset(mesh, pxr::TfToken("second"), pxr::UsdGeomTokens->face, pxr::VtIntArray { 1 });
+    return mesh;
+  }
+
+  void compareMeshes(const char* context, const lss::UsdMeshImporter& expected, const lss::UsdMeshImporter& actual) {
+    if (expected.GetNumVertices() != actual.GetNumVertices() ||
+        expected.GetVertexStride() != actual.GetVertexStride() ||
+        expected.GetNumBonesPerVertex() != actual.GetNumBonesPerVertex() ||
+        expected.GetDoubleSidedState() != actual.GetDoubleSidedState() ||
+        expected.IsRightHanded() != actual.IsRightHanded()) {
+      throw DxvkError(str::format(context, ": mesh properties don't match"));
+    }
+    if (expected.GetVertexData() != actual.GetVertexData()) {
+      throw DxvkError(str::format(context, ": vertex data doesn't match"));
+    }
+    if (expected.GetVertexDecl().size() != actual.GetVertexDecl().size()) {
+      throw DxvkError(str::format(context, ": vertex declarations don't match"));
+    }
+    for (size_t i = 0; i < expected.GetVertexDecl().size(); i++) {
+      const auto& a = expected.GetVertexDecl()[i];
+      const auto& b = actual.GetVertexDecl()[i];
+      if (a.attribute != b.attribute || a.offset != b.offset || a.size != b.size) {
+        throw DxvkError(str::format(context, ": vertex declaration ", i, " doesn't match"));
+      }
+    }
+    if (expected.GetSubMeshes().size() != actual.GetSubMeshes().size()) {
+      throw DxvkError(str::format(context, ": submesh count doesn't match"));
+    }
+    for (size_t i = 0; i < expected.GetSubMeshes().size(); i++) {
+      const auto& a = expected.GetSubMeshes()[i];
+      const auto& b = actual.GetSubMeshes()[i];
+      if (a.indexBuffer != b.indexBuffer || a.prim != b.prim) {
+        throw DxvkError(str::format(context, ": submesh ", i, " doesn't match"));
+      }
+    }
+    const AxisAlignedBoundingBox& boxA = expected.GetBoundingBox();
+    const AxisAlignedBoundingBox& boxB = actual.GetBoundingBox();
+    for (uint32_t i = 0; i < 3; i++) {
+      if (boxA.minPos[i] != boxB.minPos[i] || boxA.maxPos[i] != boxB.maxPos[i]) {
+        throw DxvkError(str::format(context, ": bounding box doesn't match"));
+      }
+    }
+  }
+} // anonymous namespace
+
+void testCookedMeshRoundTrip() {
+  Logger::info("Testing cooked mesh round trip...");
+  pxr::UsdStageRefPtr stage = pxr::UsdStage::CreateInMemory("test_cooked_mesh.usda");
+  pxr::UsdGeomMesh mesh = createQuadMesh(stage, "/World/quad");
+
+  lss::UsdMeshImporter imported(mesh.GetPrim(), 4);
+  if (imported.GetSubMeshes().size() != 2) {
+    throw DxvkError(str::format("testCookedMeshRoundTrip: expected 2 submeshes, got ", imported.GetSubMeshes().size()));
+  }
+
+  const std::vector<uint8_t> blob = UsdMeshCookedCache::serializeMesh(imported.Cook());
+  lss::UsdMeshImporter::CookedMesh cookedMesh;
+  if (!UsdMeshCookedCache::deserializeMesh(blob.data(), blob.size(), cookedMesh)) {
+    throw DxvkError("testCookedMeshRoundTrip: failed to deserialize a freshly serialized mesh");
+  }
+  lss::UsdMeshImporter restored(mesh.GetPrim(), std::move(cookedMesh));
+  compareMeshes("testCookedMeshRoundTrip", imported, restored);
+
+  // Truncated blobs must be rejected rather than read out of bounds.
+  for (size_t size : { size_t(0), size_t(16), blob.size() / 2, blob.size() - 1 }) {
+    lss::UsdMeshImporter::CookedMesh truncated;
+    if (UsdMeshCookedCache::deserializeMesh(blob.data(), size, truncated)) {
+      throw DxvkError(str::format("testCookedMeshRoundTrip: accepted a blob truncated to ", size, " bytes"));
+    }
+  }
+
+  // Submeshes are restored by path, so a cooked mesh whose subsets have since been removed must fail to restore.
+  lss::UsdMeshImporter::CookedMesh stale = imported.Cook();
+  stage->RemovePrim(pxr::SdfPath("/World/quad/second"));
+  bool threw = false;
+  try {
+    lss::UsdMeshImporter invalid(mesh.GetPrim(), std::move(stale));
+  } catch (const DxvkError&) {
+    threw = true;
+  }
+  if (!threw) {
+    throw DxvkError("testCookedMeshRoundTrip: restoring a mesh with a missing subset should throw");
+  }
+  Logger::info("Cooked mesh round trip test passed");
+}
+
+void testCookedMeshCacheFile() {
+  Logger::info("Testing cooked mesh cache file...");
+  pxr::UsdStageRefPtr stage = pxr::UsdStage::CreateInMemory("test_cooked_mesh_cache.usda");
+  pxr::UsdGeomMesh mesh = createQuadMesh(stage, "/World/quad");
+  lss::UsdMeshImporter imported(mesh.GetPrim(), 4);
+
+  const std::filesystem::path cachePath = std::filesystem::temp_directory_path() / "test_usd_mesh_cooked_cache.cache";
+  std::error_code ec;
+  std::filesystem::remove(cachePath, ec);
+
+  XXH64_hash_t key;
+  {
+    UsdMeshCookedCache cache;
+    if (cache.open(cachePath)) {
+      throw DxvkError("testCookedMeshCacheFile: opening a missing cache file should fail");
+    }
+    key = cache.getMeshKey(mesh.GetPrim(), 4);
+    if (key == kEmptyHash) {
+      throw DxvkError("testCookedMeshCacheFile: in-memory meshes should be cacheable");
+    }
+    if (cache.getMeshKey(mesh.GetPrim(), 3) == key) {
+      throw DxvkError("testCookedMeshCacheFile: import options must be part of the key");
+    }
+    if (cache.load(key, mesh.GetPrim()) != nullptr) {
+      throw DxvkError("testCookedMeshCacheFile: empty cache should miss");
+    }
+    cache.store(key, imported);
+    if (!cache.isDirty() || !cache.write(cachePath)) {
+      throw DxvkError("testCookedMeshCacheFile: failed to write the cache");
+    }
+  }
+
+  {
+    UsdMeshCookedCache cache;
+    if (!cache.open(cachePath)) {
+      throw DxvkError("testCookedMeshCacheFile: failed to open the written cache");
+    }
+    if (cache.getMeshKey(mesh.GetPrim(), 4) != key) {
+      throw DxvkError("testCookedMeshCacheFile: key should be stable for unchanged layers");
+    }
+    std::unique_ptr<lss::UsdMeshImporter> restored = cache.load(key, mesh.GetPrim());
+    if (restored == nullptr || cache.getHitCount() != 1) {
+      throw DxvkError("testCookedMeshCacheFile: expected a cache hit");
+    }
+    compareMeshes("testCookedMeshCacheFile", imported, *restored);
+    cache.close();
+  }
+
+  {
+    // Editing the mesh changes the content of its layer, and so its key.
+    UsdMeshCookedCache cache;
+    cache.open(cachePath);
+    mesh.GetPointsAttr().Set(pxr::VtVec3fArray { { 0, 0, 0 }, { 2, 0, 0 }, { 2, 2, 0 }, { 0, 2, 0 } });
+    if (cache.getMeshKey(mesh.GetPrim(), 4) == key) {
+      throw DxvkError("testCookedMeshCacheFile: key should change when the layer content changes");
+    }
+    cache.close();
+  }
+
+  {
+    // A corrupted file must be rejected, not partially used.
+    std::filesystem::resize_file(cachePath, std::filesystem::file_size(cachePath) / 2);
+    UsdMeshCookedCache cache;
+    if (cache.open(cachePath) && cache.load(key, mesh.GetPrim()) != nullptr) {
+      throw DxvkError("testCookedMeshCacheFile: truncated cache file should not produce hits");
+    }
+  }
+
+  std::filesystem::remove(cachePath, ec);
+  Logger::info("Cooked mesh cache file test passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_usd_mesh_cooked_cache...");
+  dxvk::UsdMod::loadUsdPlugins();
+
+  try {
+    dxvk::testCookedMeshRoundTrip();
+    dxvk::testCookedMeshCacheFile();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
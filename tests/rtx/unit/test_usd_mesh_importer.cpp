@@ -0,0 +1,251 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "rtx_render/rtx_mod_usd.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+#include "../../../src/lssusd/usd_mesh_importer.h"
+
+#include "../../../src/lssusd/usd_include_begin.h"
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/primvarsAPI.h>
+#include <pxr/usd/usdGeom/subset.h>
+#include <pxr/usd/usdSkel/bindingAPI.h>
+#include "../../../src/lssusd/usd_include_end.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_usd_mesh_importer.log");
+
+namespace {
+  struct SyntheticMeshDesc {
+    uint32_t gridSize = 0;
+    // Every fifth face is a triangle and every seventh a pentagon, to exercise the fan triangulation offsets.
+    bool mixedFaces = false;
+    bool skinned = false;
+    // Interpolation of displayColor, or an empty token for no color.
+    pxr::TfToken colorInterpolation;
+    uint32_t numSubsets = 0;
+  };
+
+  // A grid of faces in the XY plane with per-vertex normals, face varying UVs and optional colors, skinning and subsets.
+  pxr::UsdGeomMesh createSyntheticMesh(const pxr::UsdStageRefPtr& stage, const char* path, const SyntheticMeshDesc& desc) {
+    const uint32_t n = desc.gridSize;
+    const auto vertexIndex = [n](uint32_t x, uint32_t y) { return int(y * (n + 1) + x); };
+
+    pxr::VtVec3fArray points;
+    pxr::VtVec3fArray normals;
+    for (uint32_t y = 0; y <= n; y++) {
+      for (uint32_t x = 0; x <= n; x++) {
+        // Displace the grid so that normals and positions aren't trivially repeating
+        const float height = std::sin(float(x) * 0.37f) * std::cos(float(y) * 0.21f);
+        points.push_back(pxr::GfVec3f(float(x), float(y), height));
+        normals.push_back(pxr::GfVec3f(-height, 0.5f * height, 1.0f).GetNormalized());
+      }
+    }
+
+    pxr::VtIntArray faceVertexCounts;
+    pxr::VtIntArray faceVertexIndices;
+    pxr::VtVec2fArray uvs;
+    for (uint32_t y = 0; y < n; y++) {
+      for (uint32_t x = 0; x < n; x++) {
+        const uint32_t face = y * n + x;
+        std::vector<int> corners { vertexIndex(x, y), vertexIndex(x + 1, y), vertexIndex(x + 1, y + 1), vertexIndex(x, y + 1) };
+        if (desc.mixedFaces && face % 5 == 0) {
+          corners.pop_back();
+        } else if (desc.mixedFaces && face % 7 == 0 && x + 2 <= n) {
+          corners.insert(corners.begin() + 2, vertexIndex(x + 2, y));
+        }
+        faceVertexCounts.push_back(int(corners.size()));
+        for (int corner : corners) {
+          faceVertexIndices.push_back(corner);
+          // Seams every 8 faces, so that some corners share a vertex and others don't
+          const pxr::GfVec3f& p = points[corner];
+          uvs.push_back(pxr::GfVec2f(p[0] / 8.0f + float(x / 8), p[1] / float(n)));
+        }
+      }
+    }
+
+    pxr::UsdGeomMesh mesh = pxr::UsdGeomMesh::Define(stage, pxr::SdfPath(path));
+    mesh.CreatePointsAttr(pxr::VtValue(points));
+    mesh.CreateNormalsAttr(pxr::VtValue(normals));
+    mesh.SetNormalsInterpolation(pxr::UsdGeomTokens->vertex);
+    mesh.CreateFaceVertexCountsAttr(pxr::VtValue(faceVertexCounts));
+    mesh.CreateFaceVertexIndicesAttr(pxr::VtValue(faceVertexIndices));
+
+    pxr::UsdGeomPrimvarsAPI primvars(mesh.GetPrim());
+    primvars.CreatePrimvar(pxr::TfToken("st"), pxr::SdfValueTypeNames->TexCoord2fArray, pxr::UsdGeomTokens->faceVarying).Set(uvs);
+
+    if (!desc.colorInterpolation.IsEmpty()) {
+      const size_t numColors = desc.colorInterpolation == pxr::UsdGeomTokens->constant ? 1 : faceVertexCounts.size();
+      pxr::VtVec3fArray colors;
+      for (size_t i = 0; i < numColors; i++) {
+        colors.push_back(pxr::GfVec3f(float(i % 3) * 0.5f, float(i % 5) * 0.25f, 1.0f));
+      }
+      pxr::UsdGeomPrimvar displayColor = mesh.CreateDisplayColorPrimvar(desc.colorInterpolation);
+      displayColor.Set(colors);
+    }
+
+    if (desc.skinned) {
+      // Six influences per vertex, so that the importer has to limit them to the requested count.
+      constexpr int kInfluences = 6;
+      pxr::VtIntArray jointIndices;
+      pxr::VtFloatArray jointWeights;
+      for (size_t v = 0; v < points.size(); v++) {
+        float total = 0.0f;
+        for (int i = 0; i < kInfluences; i++) {
+          jointIndices.push_back(int((v + i * 7) % 64));
+          const float weight = float((v * 13 + i * 5) % 17 + 1);
+          jointWeights.push_back(weight);
+          total += weight;
+        }
+        for (int i = 0; i < kInfluences; i++) {
+          jointWeights[v * kInfluences + i] /= total;
+        }
+      }
+      pxr::UsdSkelBindingAPI binding = pxr::UsdSkelBindingAPI::Apply(mesh.GetPrim());
+      binding.CreateJointIndicesPrimvar(false, kInfluences).Set(jointIndices);
+      binding.CreateJointWeightsPrimvar(false, kInfluences).Set(jointWeights);
+    }
+
+    for (uint32_t s = 0; s < desc.numSubsets; s++) {
+      pxr::VtIntArray faces;
+      for (int face = int(s); face < int(faceVertexCounts.size()); face += int(desc.numSubsets)) {
+        faces.push_back(face);
+      }
+      pxr::UsdGeomSubset::CreateGeomSubset(mesh, pxr::TfToken(str::format("subset", s)), pxr::UsdGeomTokens->face, faces);
+    }
+    return mesh;
+  }
+
+  void compareMeshes(const char* context, const lss::UsdMeshImporter& expected, const lss::UsdMeshImporter& actual) {
+    if (expected.GetNumVertices() != actual.GetNumVertices() ||
+        expected.GetVertexStride() != actual.GetVertexStride() ||
+        expected.GetNumBonesPerVertex() != actual.GetNumBonesPerVertex()) {
+      throw DxvkError(str::format(context, ": mesh properties don't match"));
+    }
+    if (expected.GetVertexDecl().size() != actual.GetVertexDecl().size()) {
+      throw DxvkError(str::format(context, ": vertex declarations don't match"));
+    }
+    if (expected.GetVertexData() != actual.GetVertexData()) {
+      throw DxvkError(str::format(context, ": vertex data doesn't match"));
+    }
+    if (expected.GetSubMeshes().size() != actual.GetSubMeshes().size()) {
+      throw DxvkError(str::format(context, ": submesh count doesn't match"));
+    }
+    for (size_t i = 0; i < expected.GetSubMeshes().size(); i++) {
+      if (expected.GetSubMeshes()[i].indexBuffer != actual.GetSubMeshes()[i].indexBuffer) {
+        throw DxvkError(str::format(context, ": indices of submesh ", i, " don't match"));
+      }
+    }
+    const AxisAlignedBoundingBox& boxA = expected.GetBoundingBox();
+    const AxisAlignedBoundingBox& boxB = actual.GetBoundingBox();
+    for (uint32_t i = 0; i < 3; i++) {
+      if (boxA.minPos[i] != boxB.minPos[i] || boxA.maxPos[i] != boxB.maxPos[i]) {
+        throw DxvkError(str::format(context, ": bounding box doesn't match"));
+      }
+    }
+  }
+
+  double importMs(const pxr::UsdPrim& prim, uint32_t limitedBones, lss::UsdMeshImporter::ImportPath importPath, std::unique_ptr<lss::UsdMeshImporter>& out) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    out = std::make_unique<lss::UsdMeshImporter>(prim, limitedBones, importPath);
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+  }
+
+  // Imports the mesh through both paths, checks that the output is identical and logs the timings.
+  void importAndCompare(const char* name, const SyntheticMeshDesc& desc, uint32_t limitedBones) {
+    pxr::UsdStageRefPtr stage = pxr::UsdStage::CreateInMemory(str::format("test_usd_mesh_importer_", name, ".usda"));
+    pxr::UsdGeomMesh mesh = createSyntheticMesh(stage, "/World/mesh", desc);
+
+    std::unique_ptr<lss::UsdMeshImporter> reference;
+    std::unique_ptr<lss::UsdMeshImporter> batched;
+    const double referenceMs = importMs(mesh.GetPrim(), limitedBones, lss::UsdMeshImporter::ImportPath::Reference, reference);
+    const double batchedMs = importMs(mesh.GetPrim(), limitedBones, lss::UsdMeshImporter::ImportPath::Batched, batched);
+
+    compareMeshes(name, *reference, *batched);
+    if (desc.numSubsets != 0 && batched->GetSubMeshes().size() != desc.numSubsets) {
+      throw DxvkError(str::format(name, ": expected ", desc.numSubsets, " submeshes, got ", batched->GetSubMeshes().size()));
+    }
+
+    size_t numIndices = 0;
+    for (const auto& subMesh : batched->GetSubMeshes()) {
+      numIndices += subMesh.indexBuffer.size();
+    }
+    Logger::info(str::format(name, ": ", numIndices / 3, " triangles, ", batched->GetNumVertices(), " vertices, reference ",
+                             referenceMs, " ms, batched ", batchedMs, " ms"));
+  }
+} // anonymous namespace
+
+void testSmallMeshes() {
+  Logger::info("Testing batched import of small meshes...");
+  importAndCompare("quad", SyntheticMeshDesc { 1 }, 4);
+  importAndCompare("mixedFaces", SyntheticMeshDesc { 9, true }, 4);
+  importAndCompare("constantColor", SyntheticMeshDesc { 8, false, false, pxr::UsdGeomTokens->constant }, 4);
+  importAndCompare("uniformColor", SyntheticMeshDesc { 8, true, false, pxr::UsdGeomTokens->uniform, 3 }, 4);
+  importAndCompare("skinned", SyntheticMeshDesc { 8, false, true }, 4);
+  importAndCompare("skinnedUnlimited", SyntheticMeshDesc { 8, false, true }, 8);
+  Logger::info("Small mesh tests passed");
+}
+
+void testLargeMeshes() {
+  // Large enough to take the parallel triangulation and assembly paths.
+  Logger::info("Testing batched import of large meshes...");
+  importAndCompare("largeGrid", SyntheticMeshDesc { 512, false, false, pxr::TfToken(), 4 }, 4);
+  importAndCompare("largeMixed", SyntheticMeshDesc { 384, true, false, pxr::UsdGeomTokens->uniform, 2 }, 4);
+  importAndCompare("largeSkinned", SyntheticMeshDesc { 256, true, true, pxr::UsdGeomTokens->constant }, 4);
+  Logger::info("Large mesh tests passed");
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_usd_mesh_importer...");
+  dxvk::UsdMod::loadUsdPlugins();
+
+  try {
+    dxvk::testSmallMeshes();
+    dxvk::testLargeMeshes();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}
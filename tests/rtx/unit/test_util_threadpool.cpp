@@ -151,6 +151,28 @@ private:
       throw DxvkError("Result didnt match");
     }
 
+    // Polling a future must not block
+    std::atomic<bool> finishTask = false;
+    auto pollFuture = threadPool->Schedule([&finishTask]() {
+      while (!finishTask) {
+        std::this_thread::yield();
+      }
+      return 3u;
+    });
+
+    if (!pollFuture.valid() || pollFuture.ready()) {
+      throw DxvkError("Future reported a result before the task finished");
+    }
+
+    finishTask = true;
+    while (!pollFuture.ready()) {
+      std::this_thread::yield();
+    }
+
+    if (pollFuture.get() != 3u) {
+      throw DxvkError("Result didnt match");
+    }
+
     class DestuctorTester {
       // Using unique ptr to emulate a destructive move
       std::unique_ptr<uint32_t> param;
@@ -0,0 +1,366 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "rtx_render/rtx_uv_tile_size.h"
+#include "../../../src/util/util_string.h"
+#include "../../../src/util/log/log.h"
+#include "../../../src/util/util_error.h"
+
+namespace dxvk {
+
+// Note: Logger needed by some shared code used in this Unit Test.
+Logger Logger::s_instance("test_uv_tile_size.log");
+
+namespace {
+  // Positions and texcoords live in separate, padded streams to exercise the strides
+  constexpr size_t kVertexStride = 20;
+  constexpr size_t kTexcoordStride = 12;
+
+  struct TestMesh {
+    std::vector<uint8_t> vertices;
+    std::vector<uint8_t> texcoords;
+    std::vector<uint16_t> indices16;
+    std::vector<uint32_t> indices32;
+    uint32_t vertexCount = 0;
+
+    void setPosition(uint32_t vertex, const Vector3& position) {
+      memcpy(vertices.data() + kVertexStride * vertex, &position, sizeof(position));
+    }
+
+    void setTexcoord(uint32_t vertex, const Vector2& texcoord) {
+      memcpy(texcoords.data() + kTexcoordStride * vertex, &texcoord, sizeof(texcoord));
+    }
+
+    UvTileSizeGeometry getGeometry(VkPrimitiveTopology topology, size_t indexStride) const {
+      UvTileSizeGeometry geometry;
+      geometry.pVertex = vertices.data();
+      geometry.vertexStride = kVertexStride;
+      geometry.pTexcoord = texcoords.data();
+      geometry.texcoordStride = kTexcoordStride;
+      geometry.vertexCount = vertexCount;
+      geometry.topology = topology;
+      if (indexStride == 2) {
+        geometry.pIndex = indices16.data();
+        geometry.indexStride = 2;
+        geometry.indexCount = (uint32_t) indices16.size();
+      } else if (indexStride == 4) {
+        geometry.pIndex = indices32.data();
+        geometry.indexStride = 4;
+        geometry.indexCount = (uint32_t) indices32.size();
+      }
+      return geometry;
+    }
+  };
+
+  TestMesh createMesh(uint32_t vertexCount, uint32_t indexCount, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> position(-1.f, 1.f);
+    std::uniform_real_distribution<float> texcoord(-2.f, 2.f);
+
+    TestMesh mesh;
+    mesh.vertexCount = vertexCount;
+    // Sized exactly, so that reads past the last vertex are caught by sanitizers
+    mesh.vertices.resize(kVertexStride * vertexCount, 0xcd);
+    mesh.texcoords.resize(kTexcoordStride * vertexCount, 0xcd);
+    for (uint32_t i = 0; i < vertexCount; i++) {
+      mesh.setPosition(i, Vector3(position(rng), position(rng), position(rng)));
+      mesh.setTexcoord(i, Vector2(texcoord(rng), texcoord(rng)));
+    }
+
+    if (vertexCount > 0) {
+      std::uniform_int_distribution<uint32_t> index(0, vertexCount - 1);
+      for (uint32_t i = 0; i < indexCount; i++) {
+        mesh.indices32.push_back(index(rng));
+      }
+      if (vertexCount <= 0x10000) {
+        mesh.indices16.assign(mesh.indices32.begin(), mesh.indices32.end());
+      }
+    }
+    return mesh;
+  }
+
+  Matrix4 createTransform(const Vector3& axis, float angle, const Vector3& scale, const Vector3& translation) {
+    const Vector3 n = normalize(axis);
+    const float s = std::sin(angle * 0.5f);
+    Matrix4 m(Vector4(n.x * s, n.y * s, n.z * s, std::cos(angle * 0.5f)), translation);
+    for (uint32_t i = 0; i < 3; i++) {
+      m[i] = Vector4(m[i].x * scale[i], m[i].y * scale[i], m[i].z * scale[i], 0.f);
+    }
+    return m;
+  }
+
+  bool nearlyEqual(float a, float b, float tolerance) {
+    if (std::isinf(a) || std::isinf(b)) {
+      return a == b;
+    }
+    return std::abs(a - b) <= tolerance * std::max(std::abs(a), std::abs(b));
+  }
+
+  const fast::SIMD kSimdLevels[] = { fast::SIMD::None, fast::SIMD::SSE2, fast::SIMD::AVX2 };
+
+  const char* simdName(fast::SIMD simd) {
+    switch (simd) {
+    case fast::SIMD::None: return "scalar";
+    case fast::SIMD::SSE2: return "SSE2";
+    case fast::SIMD::AVX2: return "AVX2";
+    default: return "other";
+    }
+  }
+} // anonymous namespace
+
+void testKernelsMatchReference() {
+  Logger::info("Testing UV tile size kernels against the reference implementation...");
+
+  const Matrix4 transforms[] = {
+    Matrix4(),
+    createTransform(Vector3(1.f, 2.f, 3.f), 0.7f, Vector3(1.f), Vector3(10.f, -5.f, 3.f)),
+    createTransform(Vector3(-1.f, 0.5f, 0.f), 2.1f, Vector3(3.5f), Vector3(0.f, 7.f, 0.f)),
+    createTransform(Vector3(0.f, 1.f, 1.f), -1.2f, Vector3(0.25f, 4.f, 1.5f), Vector3(1.f, 1.f, 1.f)),
+  };
+
+  struct Layout {
+    VkPrimitiveTopology topology;
+    size_t indexStride;
+  };
+  const Layout layouts[] = {
+    { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 2 },
+    { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 4 },
+    { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0 },
+    { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP, 0 },
+    { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN, 0 },
+  };
+
+  // Sizes around the 4 and 8 wide batches, including counts that don't make whole triangles
+  const uint32_t sizes[] = { 0, 1, 2, 3, 4, 5, 8, 9, 10, 17, 24, 25, 31, 100, 1001 };
+
+  uint32_t numCases = 0;
+  for (uint32_t size : sizes) {
+    const TestMesh mesh = createMesh(size, size + size / 2 + 1, size);
+    for (const Layout& layout : layouts) {
+      const UvTileSizeGeometry geometry = mesh.getGeometry(layout.topology, layout.indexStride);
+      for (const Matrix4& transform : transforms) {
+        const float expected = UvTileSizeCalculator::computeMaxUvTileSizeSqrScalar(geometry, transform);
+        for (fast::SIMD simd : kSimdLevels) {
+          const float actual = UvTileSizeCalculator::computeMaxUvTileSizeSqr(geometry, &transform, simd);
+          if (!nearlyEqual(expected, actual, 1e-4f)) {
+            throw DxvkError(str::format("testKernelsMatchReference: ", simdName(simd), " kernel returned ", actual, " instead of ", expected,
+                                        " (topology ", (uint32_t) layout.topology, ", index stride ", layout.indexStride, ", ", size, " vertices)"));
+          }
+          numCases++;
+        }
+
+        // The uncached entry point, which takes the object space path for rigid and uniformly scaled transforms
+        const float tileSize = UvTileSizeCalculator::computeMaxUvTileSize(geometry, transform, kEmptyHash);
+        if (geometry.pVertex == nullptr) {
+          if (!std::isnan(tileSize)) {
+            throw DxvkError("testKernelsMatchReference: geometry without vertices should return NAN");
+          }
+        } else if (!nearlyEqual(std::sqrt(expected), tileSize, 1e-4f)) {
+          throw DxvkError(str::format("testKernelsMatchReference: computeMaxUvTileSize returned ", tileSize, " instead of ", std::sqrt(expected)));
+        }
+      }
+    }
+  }
+  Logger::info(str::format("UV tile size kernels matched the reference implementation in ", numCases, " cases"));
+}
+
+void testDegenerateEdges() {
+  Logger::info("Testing UV tile size of degenerate edges...");
+  TestMesh mesh = createMesh(12, 0, 1);
+  const UvTileSizeGeometry geometry = mesh.getGeometry(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0);
+  const Matrix4 identity;
+
+  // Collapsing a triangle in position space removes it from the max, even though its UVs are still spread out
+  mesh.setPosition(0, Vector3(0.f));
+  mesh.setPosition(1, Vector3(0.f));
+  mesh.setPosition(2, Vector3(0.f));
+  for (fast::SIMD simd : kSimdLevels) {
+    const float expected = UvTileSizeCalculator::computeMaxUvTileSizeSqrScalar(geometry, identity);
+    const float actual = UvTileSizeCalculator::computeMaxUvTileSizeSqr(geometry, nullptr, simd);
+    if (!nearlyEqual(expected, actual, 1e-4f) || std::isinf(actual)) {
+      throw DxvkError(str::format("testDegenerateEdges: ", simdName(simd), " collapsed triangle returned ", actual, " instead of ", expected));
+    }
+  }
+
+  // An edge with length in position space but none in UV space has an infinite tile size
+  mesh.setTexcoord(7, Vector2(0.5f, 0.5f));
+  mesh.setTexcoord(8, Vector2(0.5f, 0.5f));
+  for (fast::SIMD simd : kSimdLevels) {
+    const float actual = UvTileSizeCalculator::computeMaxUvTileSizeSqr(geometry, nullptr, simd);
+    if (!std::isinf(actual) || !std::isinf(UvTileSizeCalculator::computeMaxUvTileSizeSqrScalar(geometry, identity))) {
+      throw DxvkError(str::format("testDegenerateEdges: ", simdName(simd), " edge without UV length returned ", actual));
+    }
+  }
+
+  UvTileSizeGeometry missingTexcoords = geometry;
+  missingTexcoords.pTexcoord = nullptr;
+  if (!std::isnan(UvTileSizeCalculator::computeMaxUvTileSize(missingTexcoords, identity, kEmptyHash))) {
+    throw DxvkError("testDegenerateEdges: geometry without texcoords should return NAN");
+  }
+  Logger::info("Degenerate edge test passed");
+}
+
+void testUniformScale() {
+  Logger::info("Testing uniform scale detection...");
+  float scaleSqr = 0.f;
+  if (!UvTileSizeCalculator::getUniformScaleSqr(createTransform(Vector3(1.f, 1.f, 0.f), 1.f, Vector3(2.f), Vector3(5.f)), scaleSqr) ||
+      !nearlyEqual(scaleSqr, 4.f, 1e-5f)) {
+    throw DxvkError("testUniformScale: rotation with uniform scale not detected");
+  }
+  // Mirrored instances are common, a reflection doesn't change edge lengths either
+  if (!UvTileSizeCalculator::getUniformScaleSqr(createTransform(Vector3(0.f, 0.f, 1.f), 0.3f, Vector3(-1.f, 1.f, 1.f), Vector3(0.f)), scaleSqr) ||
+      !nearlyEqual(scaleSqr, 1.f, 1e-5f)) {
+    throw DxvkError("testUniformScale: reflection not detected");
+  }
+  if (UvTileSizeCalculator::getUniformScaleSqr(createTransform(Vector3(0.f, 0.f, 1.f), 0.3f, Vector3(1.f, 1.1f, 1.f), Vector3(0.f)), scaleSqr)) {
+    throw DxvkError("testUniformScale: non-uniform scale detected as uniform");
+  }
+  Matrix4 shear;
+  shear[1] = Vector4(0.5f, 1.f, 0.f, 0.f);
+  shear[2] = Vector4(0.f, 0.f, std::sqrt(1.25f), 0.f);
+  shear[0] = Vector4(std::sqrt(1.25f), 0.f, 0.f, 0.f);
+  if (UvTileSizeCalculator::getUniformScaleSqr(shear, scaleSqr)) {
+    throw DxvkError("testUniformScale: shear with equal column lengths detected as uniform");
+  }
+  Matrix4 projective;
+  projective[2].w = 1.f;
+  if (UvTileSizeCalculator::getUniformScaleSqr(projective, scaleSqr)) {
+    throw DxvkError("testUniformScale: projective transform detected as uniform");
+  }
+  Logger::info("Uniform scale test passed");
+}
+
+void testCache() {
+  Logger::info("Testing UV tile size cache...");
+  UvTileSizeCalculator::clearCache();
+
+  const TestMesh mesh = createMesh(300, 900, 7);
+  const UvTileSizeGeometry geometry = mesh.getGeometry(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 2);
+  const XXH64_hash_t key = 0x1234567890abcdefull;
+
+  const auto check = [&](const char* context, const Matrix4& transform, size_t expectedHits) {
+    const float expected = std::sqrt(UvTileSizeCalculator::computeMaxUvTileSizeSqrScalar(geometry, transform));
+    const float actual = UvTileSizeCalculator::computeMaxUvTileSize(geometry, transform, key);
+    if (!nearlyEqual(expected, actual, 1e-4f)) {
+      throw DxvkError(str::format("testCache: ", context, " returned ", actual, " instead of ", expected));
+    }
+    if (UvTileSizeCalculator::getCacheHitCount() != expectedHits) {
+      throw DxvkError(str::format("testCache: ", context, " expected ", expectedHits, " cache hits, got ", UvTileSizeCalculator::getCacheHitCount()));
+    }
+  };
+
+  check("first rigid transform", createTransform(Vector3(1.f, 0.f, 0.f), 0.5f, Vector3(1.f), Vector3(1.f, 2.f, 3.f)), 0);
+  // Moving or rotating the mesh must not walk it again
+  check("second rigid transform", createTransform(Vector3(0.f, 1.f, 0.f), 2.5f, Vector3(1.f), Vector3(-8.f, 0.f, 4.f)), 1);
+  check("uniform scale", createTransform(Vector3(0.f, 1.f, 1.f), 1.5f, Vector3(3.f), Vector3(0.f)), 2);
+
+  const Matrix4 stretched = createTransform(Vector3(0.f, 1.f, 1.f), 1.5f, Vector3(1.f, 3.f, 1.f), Vector3(0.f));
+  check("first non-uniform scale", stretched, 2);
+  check("repeated non-uniform scale", stretched, 3);
+  // Only the translation changed
+  Matrix4 stretchedMoved = stretched;
+  stretchedMoved[3] = Vector4(100.f, 0.f, 0.f, 1.f);
+  check("translated non-uniform scale", stretchedMoved, 4);
+
+  // A different key is a different mesh
+  const TestMesh other = createMesh(300, 900, 8);
+  const UvTileSizeGeometry otherGeometry = other.getGeometry(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 2);
+  const float expected = std::sqrt(UvTileSizeCalculator::computeMaxUvTileSizeSqrScalar(otherGeometry, Matrix4()));
+  if (!nearlyEqual(UvTileSizeCalculator::computeMaxUvTileSize(otherGeometry, Matrix4(), key + 1), expected, 1e-4f) ||
+      UvTileSizeCalculator::getCacheHitCount() != 4) {
+    throw DxvkError("testCache: different geometry keys must not share entries");
+  }
+
+  UvTileSizeCalculator::clearCache();
+  Logger::info("UV tile size cache test passed");
+}
+
+void benchmarkUvTileSize() {
+  Logger::info("Benchmarking UV tile size...");
+  UvTileSizeCalculator::clearCache();
+
+  const uint32_t vertexCount = 256 * 1024;
+  const TestMesh mesh = createMesh(vertexCount, vertexCount * 6, 42);
+  const UvTileSizeGeometry geometry = mesh.getGeometry(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 4);
+  const Matrix4 transform = createTransform(Vector3(1.f, 1.f, 1.f), 0.9f, Vector3(2.f), Vector3(3.f, 4.f, 5.f));
+
+  const auto time = [](auto&& function) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    const float result = function();
+    const auto end = std::chrono::high_resolution_clock::now();
+    return std::make_pair(result, std::chrono::duration<double, std::milli>(end - start).count());
+  };
+
+  const auto reference = time([&]() { return UvTileSizeCalculator::computeMaxUvTileSizeSqrScalar(geometry, transform); });
+  Logger::info(str::format("  reference: ", reference.second, " ms"));
+  for (fast::SIMD simd : kSimdLevels) {
+    const auto kernel = time([&]() { return UvTileSizeCalculator::computeMaxUvTileSizeSqr(geometry, &transform, simd); });
+    if (!nearlyEqual(reference.first, kernel.first, 1e-4f)) {
+      throw DxvkError(str::format("benchmarkUvTileSize: ", simdName(simd), " kernel returned ", kernel.first, " instead of ", reference.first));
+    }
+    Logger::info(str::format("  ", simdName(simd), " kernel: ", kernel.second, " ms"));
+  }
+
+  const auto uncached = time([&]() { return UvTileSizeCalculator::computeMaxUvTileSize(geometry, transform, 1); });
+  const Matrix4 moved = createTransform(Vector3(1.f, 0.f, 1.f), 0.2f, Vector3(2.f), Vector3(-3.f, 4.f, 5.f));
+  const auto cached = time([&]() { return UvTileSizeCalculator::computeMaxUvTileSize(geometry, moved, 1); });
+  if (UvTileSizeCalculator::getCacheHitCount() != 1 || !nearlyEqual(uncached.first, cached.first, 1e-5f)) {
+    throw DxvkError("benchmarkUvTileSize: rigid transform change should hit the cache");
+  }
+  Logger::info(str::format("  first call: ", uncached.second, " ms, after a rigid transform change: ", cached.second, " ms"));
+
+  UvTileSizeCalculator::clearCache();
+}
+
+} // namespace dxvk
+
+int main() {
+  dxvk::Logger::info("Starting test_uv_tile_size...");
+
+  try {
+    dxvk::testKernelsMatchReference();
+    dxvk::testDegenerateEdges();
+    dxvk::testUniformScale();
+    dxvk::testCache();
+    dxvk::benchmarkUvTileSize();
+
+    dxvk::Logger::info("\n All tests passed successfully!");
+    return 0;
+  } catch (const std::exception& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.what()));
+    return 1;
+  } catch (dxvk::DxvkError& e) {
+    dxvk::Logger::err(dxvk::str::format("Test failed with exception: ", e.message()));
+    return 1;
+  } catch (...) {
+    dxvk::Logger::err("Test failed with unknown exception");
+    return 1;
+  }
+}